@@ -0,0 +1,320 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/collective/gradient_compression_hook.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <numeric>
+
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+// The bytes a rank sends in the ring allreduce of a buffer of bytes, and in
+// the ring allgather of buffers of bytes from every rank.
+int64_t AllReduceBytes(int64_t bytes, int nranks) {
+  return 2 * (nranks - 1) * bytes / nranks;
+}
+
+int64_t AllGatherBytes(int64_t bytes, int nranks) {
+  return (nranks - 1) * bytes;
+}
+
+phi::DenseTensor NewCPUTensor(phi::DataType dtype, int64_t numel) {
+  phi::DenseTensor tensor;
+  tensor.Resize({numel});
+  tensor.mutable_data(phi::CPUPlace(), dtype);
+  return tensor;
+}
+
+template <typename T>
+void CompressToHalf(const float *grad, float *residual, T *out, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    const float value = grad[i] + residual[i];
+    const T half = static_cast<T>(value);
+    out[i] = half;
+    residual[i] = value - static_cast<float>(half);
+  }
+}
+
+template <typename T>
+void DecompressFromHalf(const T *in, float *grad, int64_t n) {
+  for (int64_t i = 0; i < n; ++i) {
+    grad[i] = static_cast<float>(in[i]);
+  }
+}
+
+// Sums the (index, value) pairs CompressTopK writes of every rank into grad.
+void DecompressTopK(
+    const int32_t *gathered, int nranks, int64_t k, float *grad, int64_t n) {
+  std::fill(grad, grad + n, 0.0f);
+  for (int rank = 0; rank < nranks; ++rank) {
+    const int32_t *indices = gathered + rank * 2 * k;
+    const int32_t *values = indices + k;
+    for (int64_t i = 0; i < k; ++i) {
+      float value;
+      std::memcpy(&value, values + i, sizeof(float));
+      grad[indices[i]] += value;
+    }
+  }
+}
+
+int64_t TopKNumel(int64_t numel, double ratio) {
+  return std::min(
+      numel,
+      std::max(static_cast<int64_t>(1),
+               static_cast<int64_t>(std::ceil(ratio * numel))));
+}
+
+}  // namespace
+
+GradientCompression ParseGradientCompression(const std::string &name) {
+  static const std::map<std::string, GradientCompression> compressions = {
+      {"none", GradientCompression::kNone},
+      {"fp16", GradientCompression::kFP16},
+      {"bf16", GradientCompression::kBF16},
+      {"topk", GradientCompression::kTopK},
+  };
+  auto it = compressions.find(name);
+  PADDLE_ENFORCE_NE(
+      it,
+      compressions.end(),
+      platform::errors::InvalidArgument(
+          "The gradient compression must be one of none, fp16, bf16 and "
+          "topk, but got %s.",
+          name));
+  return it->second;
+}
+
+GradientCompressionHook::GradientCompressionHook(
+    std::shared_ptr<ProcessGroup> process_group,
+    GradientCompression compression,
+    double topk_ratio)
+    : process_group_(process_group),
+      compression_(compression),
+      topk_ratio_(topk_ratio),
+      nranks_(process_group->GetSize()),
+      rng_(2023) {
+  PADDLE_ENFORCE_EQ(
+      topk_ratio > 0.0 && topk_ratio <= 1.0,
+      true,
+      platform::errors::InvalidArgument(
+          "The topk_ratio must be in (0, 1], but got %f.", topk_ratio));
+  worker_thread_ = std::thread(&GradientCompressionHook::WorkLoop, this);
+}
+
+GradientCompressionHook::~GradientCompressionHook() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_consume_.wait(lock, [&] { return pending_ == 0; });
+  stop_ = true;
+  lock.unlock();
+  queue_produce_.notify_all();
+
+  worker_thread_.join();
+}
+
+void GradientCompressionHook::Schedule(size_t group_index,
+                                       const phi::DenseTensor &bucket) {
+  const int64_t numel = bucket.numel();
+  const int64_t bytes =
+      numel * static_cast<int64_t>(phi::SizeOf(bucket.dtype()));
+  raw_bytes_ += AllReduceBytes(bytes, nranks_);
+
+  Job job;
+  job.compression = bucket.dtype() == phi::DataType::FLOAT32
+                        ? compression_
+                        : GradientCompression::kNone;
+  job.bucket = bucket;
+  if (job.compression == GradientCompression::kNone) {
+    job.payload = bucket;
+    wire_bytes_ += AllReduceBytes(bytes, nranks_);
+  } else {
+    std::vector<float> &residual = residuals_[group_index];
+    if (static_cast<int64_t>(residual.size()) != numel) {
+      residual.assign(numel, 0.0f);
+    }
+    const float *grad = bucket.data<float>();
+    if (job.compression == GradientCompression::kTopK) {
+      PADDLE_ENFORCE_LE(numel,
+                        std::numeric_limits<int32_t>::max(),
+                        platform::errors::InvalidArgument(
+                            "The buckets of topk compression must have less "
+                            "than 2^31 elements, but got %d.",
+                            numel));
+      const int64_t k = TopKNumel(numel, topk_ratio_);
+      job.payload = NewCPUTensor(phi::DataType::INT32, 2 * k);
+      job.gathered = NewCPUTensor(phi::DataType::INT32, 2 * k * nranks_);
+      CompressTopK(
+          grad, residual.data(), numel, k, job.payload.data<int32_t>());
+      wire_bytes_ += AllGatherBytes(2 * k * sizeof(int32_t), nranks_);
+    } else {
+      if (job.compression == GradientCompression::kFP16) {
+        job.payload = NewCPUTensor(phi::DataType::FLOAT16, numel);
+        CompressToHalf(grad,
+                       residual.data(),
+                       job.payload.data<phi::dtype::float16>(),
+                       numel);
+      } else {
+        job.payload = NewCPUTensor(phi::DataType::BFLOAT16, numel);
+        CompressToHalf(grad,
+                       residual.data(),
+                       job.payload.data<phi::dtype::bfloat16>(),
+                       numel);
+      }
+      wire_bytes_ += AllReduceBytes(numel * 2, nranks_);
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_.push_back(std::move(job));
+  ++pending_;
+  lock.unlock();
+  queue_produce_.notify_one();
+}
+
+void GradientCompressionHook::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_consume_.wait(lock, [&] { return pending_ == 0; });
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void GradientCompressionHook::WorkLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (!stop_) {
+    if (queue_.empty()) {
+      queue_produce_.wait(lock);
+      continue;
+    }
+
+    Job job = std::move(queue_.front());
+    queue_.pop_front();
+    const bool failed = error_ != nullptr;
+    lock.unlock();
+
+    // After an error the ranks no longer agree on the collectives, the
+    // remaining jobs are dropped.
+    std::exception_ptr error;
+    if (!failed) {
+      try {
+        RunJob(&job);
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+
+    lock.lock();
+    if (error) {
+      error_ = error;
+    }
+    --pending_;
+    queue_consume_.notify_all();
+  }
+}
+
+void GradientCompressionHook::RunJob(Job *job) {
+  std::vector<phi::DenseTensor> in = {job->payload};
+  if (job->compression == GradientCompression::kTopK) {
+    std::vector<phi::DenseTensor> out = {job->gathered};
+    process_group_->AllGather(in, out)->Synchronize();
+    DecompressTopK(job->gathered.data<int32_t>(),
+                   nranks_,
+                   job->payload.numel() / 2,
+                   job->bucket.data<float>(),
+                   job->bucket.numel());
+    return;
+  }
+
+  distributed::AllreduceOptions opts;
+  opts.reduce_op = ReduceOp::SUM;
+  process_group_->AllReduce(in, in, opts)->Synchronize();
+  if (job->compression == GradientCompression::kFP16) {
+    DecompressFromHalf(job->payload.data<phi::dtype::float16>(),
+                       job->bucket.data<float>(),
+                       job->bucket.numel());
+  } else if (job->compression == GradientCompression::kBF16) {
+    DecompressFromHalf(job->payload.data<phi::dtype::bfloat16>(),
+                       job->bucket.data<float>(),
+                       job->bucket.numel());
+  }
+}
+
+void GradientCompressionHook::CompressTopK(const float *grad,
+                                           float *residual,
+                                           int64_t numel,
+                                           int64_t k,
+                                           int32_t *out) {
+  for (int64_t i = 0; i < numel; ++i) {
+    residual[i] += grad[i];
+  }
+
+  // The magnitude above which about 2k of the elements are, estimated from a
+  // sample, leaves few candidates for the exact selection. When the sample
+  // misses and less than k are above it, all the elements are candidates.
+  constexpr int64_t kSamples = 4096;
+  float threshold = 0.0f;
+  if (numel > 4 * kSamples) {
+    std::vector<float> sample(kSamples);
+    for (auto &value : sample) {
+      value = std::abs(residual[rng_() % numel]);
+    }
+    const int64_t above = std::max(
+        static_cast<int64_t>(1),
+        std::min(kSamples, 2 * k * kSamples / numel));
+    std::nth_element(
+        sample.begin(), sample.begin() + kSamples - above, sample.end());
+    threshold = sample[kSamples - above];
+  }
+  candidates_.clear();
+  for (int64_t i = 0; i < numel; ++i) {
+    if (std::abs(residual[i]) >= threshold) {
+      candidates_.push_back(static_cast<int32_t>(i));
+    }
+  }
+  if (static_cast<int64_t>(candidates_.size()) < k) {
+    candidates_.resize(numel);
+    std::iota(candidates_.begin(), candidates_.end(), 0);
+  }
+
+  std::nth_element(candidates_.begin(),
+                   candidates_.begin() + k - 1,
+                   candidates_.end(),
+                   [residual](int32_t a, int32_t b) {
+                     return std::abs(residual[a]) > std::abs(residual[b]);
+                   });
+  // In order of the indices, for the decompression to write forward.
+  std::sort(candidates_.begin(), candidates_.begin() + k);
+  for (int64_t i = 0; i < k; ++i) {
+    const int32_t index = candidates_[i];
+    out[i] = index;
+    std::memcpy(out + k + i, residual + index, sizeof(float));
+    residual[index] = 0.0f;
+  }
+}
+
+}  //  namespace distributed
+}  //  namespace paddle
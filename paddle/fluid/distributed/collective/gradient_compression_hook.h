@@ -0,0 +1,126 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/distributed/collective/process_group.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace distributed {
+
+enum class GradientCompression {
+  // The buckets as they are.
+  kNone,
+  // The buckets cast to float16 or bfloat16 for the allreduce.
+  kFP16,
+  kBF16,
+  // The largest topk_ratio of the bucket by magnitude, as (index, value)
+  // pairs allgathered from the ranks.
+  kTopK,
+};
+
+// "none", "fp16", "bf16" or "topk".
+GradientCompression ParseGradientCompression(const std::string &name);
+
+// Allreduces the dense buckets of EagerReducer on a thread of its own, so the
+// backward pass, and the compression of the buckets ready next, go on during
+// the transfers. ProcessGroupGloo blocks in every collective, without the
+// hook the backward pass waits for every bucket.
+//
+// Only float32 buckets on CPU are compressed, the others are allreduced as
+// they are. What the compression drops of a bucket is added to the bucket of
+// the next step (error feedback), so no part of the gradients is lost, only
+// delayed.
+class GradientCompressionHook {
+ public:
+  GradientCompressionHook(std::shared_ptr<ProcessGroup> process_group,
+                          GradientCompression compression,
+                          double topk_ratio);
+
+  ~GradientCompressionHook();
+
+  // Compresses bucket, the gradients of the group group_index divided by the
+  // number of ranks, and queues its allreduce. bucket holds the sum over the
+  // ranks once Wait returns, and must not be used before.
+  void Schedule(size_t group_index, const phi::DenseTensor &bucket);
+
+  // Waits for the queued buckets, and throws the error of any of them.
+  void Wait();
+
+  // The bytes this rank has sent for the buckets in ring allreduces and
+  // allgathers, and the bytes the allreduces of the buckets as they are
+  // would have sent.
+  int64_t wire_bytes() const { return wire_bytes_; }
+  int64_t raw_bytes() const { return raw_bytes_; }
+
+ private:
+  struct Job {
+    GradientCompression compression;
+    phi::DenseTensor bucket;
+    // What is sent, the bucket itself for kNone.
+    phi::DenseTensor payload;
+    // The payloads of all the ranks, for kTopK.
+    phi::DenseTensor gathered;
+  };
+
+  void WorkLoop();
+  void RunJob(Job *job);
+
+  // Writes the indices, and the bits of the values, of the k elements of the
+  // largest magnitude of grad + residual to out, and keeps the others in
+  // residual.
+  void CompressTopK(const float *grad,
+                    float *residual,
+                    int64_t numel,
+                    int64_t k,
+                    int32_t *out);
+
+  std::shared_ptr<ProcessGroup> process_group_;
+  GradientCompression compression_;
+  double topk_ratio_;
+  int nranks_;
+
+  // The error feedback of the groups.
+  std::unordered_map<size_t, std::vector<float>> residuals_;
+  std::vector<int32_t> candidates_;
+  std::minstd_rand rng_;
+
+  int64_t wire_bytes_{0};
+  int64_t raw_bytes_{0};
+
+  bool stop_{false};
+  // The jobs queued or running.
+  size_t pending_{0};
+  std::exception_ptr error_;
+  std::mutex mutex_;
+  std::deque<Job> queue_;
+  std::condition_variable queue_produce_;
+  std::condition_variable queue_consume_;
+  std::thread worker_thread_;
+};
+
+}  //  namespace distributed
+}  //  namespace paddle
@@ -648,7 +648,7 @@ void EagerReducer::TraverseBackwardGraph(const std::vector<Tensor> &outputs) {
   while (!queue.empty()) {
     egr::GradNodeBase *node = queue.front();
     queue.pop();
-    const paddle::small_vector<std::vector<egr::GradSlotMeta>,
+    const paddle::small_vector<egr::GradSlotMetaVector,
                                egr::kSlotSmallVectorSize> &metas =
         node->OutputMeta();
     for (size_t i = 0; i < metas.size(); i++) {
@@ -1024,10 +1024,15 @@ void EagerReducer::ProcessUnusedDenseVars() {
 void EagerReducer::FinalizeBackward() {
   groups_need_finalize_ = false;
   grad_need_hooks_ = false;
+  if (comm_hook_) {
+    comm_hook_->Wait();
+  }
   for (auto &group : groups_) {
     if (!group.is_sparse_) {
-      group.task->Synchronize();
-      if (!IsStreamSafeAllocator()) {
+      if (group.task) {
+        group.task->Synchronize();
+      }
+      if (!IsStreamSafeAllocator() || comm_hook_) {
         auto *default_ctx =
             platform::DeviceContextPool::Instance().Get(inner_place_);
         group.SplitTensors(*default_ctx);
@@ -1045,6 +1050,39 @@ void EagerReducer::FinalizeBackward() {
   VLOG(3) << "In the batch, Reducer is finished.";
 }
 
+void EagerReducer::SetCommHook(const std::string &compression,
+                               double topk_ratio) {
+  PADDLE_ENFORCE_EQ(
+      platform::is_cpu_place(inner_place_),
+      true,
+      platform::errors::Unimplemented(
+          "The communication hook of EagerReducer only supports gradients "
+          "on CPU, but the gradients are on %s.",
+          inner_place_));
+  PADDLE_ENFORCE_EQ(grad_need_hooks_,
+                    false,
+                    platform::errors::PreconditionNotMet(
+                        "The communication hook can not be changed during "
+                        "the backward pass."));
+  ClearCommHook();
+  comm_hook_ = std::make_unique<GradientCompressionHook>(
+      process_group_, ParseGradientCompression(compression), topk_ratio);
+}
+
+void EagerReducer::ClearCommHook() {
+  if (comm_hook_) {
+    comm_hook_->Wait();
+    comm_hook_.reset();
+  }
+}
+
+std::pair<int64_t, int64_t> EagerReducer::CommHookBytes() const {
+  if (!comm_hook_) {
+    return {0, 0};
+  }
+  return {comm_hook_->wire_bytes(), comm_hook_->raw_bytes()};
+}
+
 void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
                                           const int curr_group_index) {
   // The overall timeline: concat > div_nranks > allreduce > split
@@ -1060,6 +1098,16 @@ void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
   paddle::experimental::scale_(
       group->dense_contents_, 1.0 / nranks_, 0.0, false);
 
+  if (comm_hook_) {
+    // The hook allreduces the bucket on its own thread, the split waits for
+    // it in FinalizeBackward.
+    group->task.reset();
+    comm_hook_->Schedule(curr_group_index,
+                         *std::dynamic_pointer_cast<phi::DenseTensor>(
+                             group->dense_contents_.impl()));
+    return;
+  }
+
   // all_reduce
   std::vector<Tensor> reduce_tensors = {group->dense_contents_};
   std::vector<phi::DenseTensor> in_out;
@@ -1082,6 +1130,12 @@ void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
 
 void EagerReducer::AllReduceSparse(EagerGroup *group,
                                    const int curr_group_index) {
+  // The collectives must be issued in the same order on all the ranks, the
+  // ones the hook has queued go first.
+  if (comm_hook_) {
+    comm_hook_->Wait();
+  }
+
   // div nranks
   Tensor sparse_tensor(group->sparse_contents_);
   paddle::experimental::scale_(sparse_tensor, 1.0 / nranks_, 0.0, false);
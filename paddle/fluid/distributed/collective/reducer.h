@@ -15,8 +15,12 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "paddle/fluid/distributed/collective/gradient_compression_hook.h"
 #include "paddle/fluid/distributed/collective/process_group.h"
 #include "paddle/fluid/eager/accumulation/accumulation_node.h"
 #include "paddle/fluid/eager/api/utils/hook_utils.h"
@@ -114,6 +118,14 @@ class EagerReducer {
   void ProcessUnusedDenseVars();
   bool HasGrad(size_t var_index);
 
+  // Allreduces the dense buckets through a GradientCompressionHook of
+  // compression, "none", "fp16", "bf16" or "topk", from the next backward
+  // pass on. Only for gradients on CPU.
+  void SetCommHook(const std::string &compression, double topk_ratio);
+  void ClearCommHook();
+  // The wire_bytes and raw_bytes of the hook, see GradientCompressionHook.
+  std::pair<int64_t, int64_t> CommHookBytes() const;
+
  private:
   std::vector<Tensor> tensors_;
   std::vector<std::vector<size_t>> group_indices_;
@@ -140,6 +152,8 @@ class EagerReducer {
   bool find_unused_vars_once_{true};
   bool groups_need_finalize_{false};
   Tensor global_used_vars_;
+
+  std::unique_ptr<GradientCompressionHook> comm_hook_;
 };
 
 }  //  namespace distributed
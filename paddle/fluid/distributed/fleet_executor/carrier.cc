@@ -21,6 +21,7 @@
 #include "paddle/fluid/distributed/fleet_executor/global.h"
 #include "paddle/fluid/distributed/fleet_executor/interceptor.h"
 #include "paddle/fluid/distributed/fleet_executor/message_bus.h"
+#include "paddle/fluid/distributed/fleet_executor/pipeline_schedule.h"
 #include "paddle/fluid/distributed/fleet_executor/runtime_graph.h"
 #include "paddle/fluid/distributed/fleet_executor/task_node.h"
 #include "paddle/fluid/framework/garbage_collector.h"
@@ -67,7 +68,8 @@ void Carrier::Init(
     int64_t num_micro_batches,
     const platform::Place& place,
     const std::vector<std::string>& inference_root_scope_vars,
-    const std::vector<framework::Scope*>& micro_scope_list) {
+    const std::vector<framework::Scope*>& micro_scope_list,
+    const PipelineScheduleDesc& pipeline_schedule) {
   rank_ = rank;
   interceptor_id_to_rank_ = interceptor_id_to_rank;
   interceptor_id_to_node_ = interceptor_id_to_node;
@@ -103,6 +105,10 @@ void Carrier::Init(
   thread_pool_.SetThreadNum(thread_num_);
   thread_pool_.Start();
 
+  if (!pipeline_schedule.mode().empty()) {
+    pipeline_schedule_ = std::make_unique<PipelineSchedule>(
+        pipeline_schedule, num_micro_batches);
+  }
   CreateInterceptors(inference_root_scope_vars);
   is_init_ = true;
 }
@@ -393,6 +399,22 @@ void Carrier::CreateInterceptors(
       interceptor->SetGC(gc);
     }
 
+    if (pipeline_schedule_ &&
+        task_node->pipeline_pass() != PipelinePass::NONE) {
+      PADDLE_ENFORCE_EQ(
+          task_node->type() == "Amplifier" || task_node->type() == "Compute",
+          true,
+          platform::errors::InvalidArgument(
+              "Only Compute and Amplifier nodes run the steps of a pipeline "
+              "schedule, but node %ld is a %s one.",
+              interceptor_id,
+              task_node->type()));
+      pipeline_schedule_->RegisterInterceptor(task_node->pipeline_pass(),
+                                              task_node->pipeline_chunk(),
+                                              interceptor_id);
+      interceptor->SetPipelineSchedule(pipeline_schedule_.get());
+    }
+
     SetInterceptor(interceptor_id, std::move(interceptor));
     VLOG(3) << "Create Interceptor with interceptor id: " << interceptor_id
             << " with type: " << task_node->type() << ".";
@@ -22,6 +22,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "paddle/fluid/distributed/fleet_executor/fleet_executor_desc.pb.h"
 #include "paddle/fluid/distributed/fleet_executor/interceptor.h"
 #include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
 #include "paddle/fluid/distributed/fleet_executor/task_loop_thread_pool.h"
@@ -44,6 +45,7 @@ class TaskNode;
 class InterceptorMessageServiceImpl;
 class RuntimeGraph;
 class MessageBus;
+class PipelineSchedule;
 
 // TODO(liyurui): Add CarrierId instead of std::string
 
@@ -62,7 +64,8 @@ class Carrier final {
       int64_t num_micro_batches,
       const platform::Place& place,
       const std::vector<std::string>& inference_root_scope_vars = {},
-      const std::vector<framework::Scope*>& micro_scope_list = {});
+      const std::vector<framework::Scope*>& micro_scope_list = {},
+      const PipelineScheduleDesc& pipeline_schedule = PipelineScheduleDesc());
 
   void CopyParameters(
       int microbatch_id,
@@ -119,6 +122,8 @@ class Carrier final {
   int thread_num_;
   TaskLoopThreadPool thread_pool_;
   std::unordered_set<int64_t> interceptor_ids_;
+  // the schedule of the forward and backward nodes, if any
+  std::unique_ptr<PipelineSchedule> pipeline_schedule_;
 };
 
 }  // namespace distributed
@@ -15,6 +15,7 @@
 #include "paddle/fluid/distributed/fleet_executor/compute_interceptor.h"
 
 #include "paddle/fluid/distributed/fleet_executor/carrier.h"
+#include "paddle/fluid/distributed/fleet_executor/pipeline_schedule.h"
 #include "paddle/fluid/distributed/fleet_executor/task_node.h"
 #include "paddle/fluid/framework/executor_gc_helper.h"
 #include "paddle/fluid/framework/operator.h"
@@ -157,7 +158,31 @@ void ComputeInterceptor::DecreaseBuff(int64_t down_id) {
   it->second.second = used_size;
 }
 
+bool ComputeInterceptor::IsScheduled() const {
+  return pipeline_schedule_ != nullptr &&
+         node_->pipeline_pass() != PipelinePass::NONE;
+}
+
 bool ComputeInterceptor::IsInputReady() {
+  if (IsScheduled()) {
+    int64_t micro_batch = pipeline_schedule_->NextMicroBatch(
+        node_->pipeline_pass(), node_->pipeline_chunk());
+    if (micro_batch < 0) {
+      VLOG(3) << "Interceptor " << GetInterceptorId()
+              << " waits for its turn in the pipeline schedule.";
+      return false;
+    }
+    for (auto& ins : in_readys_) {
+      if (ins.second.second.at(micro_batch) == 0) {
+        VLOG(3) << "Interceptor " << GetInterceptorId() << " in scope "
+                << micro_batch << "'s upstreams aren't all ready.";
+        return false;
+      }
+    }
+    cur_scope_id_ = micro_batch;
+    return true;
+  }
+
   std::map<int64_t, bool> scope_id_to_finish_flag;
   if (!gen_step_to_scope_id_to_finish_flag_.empty()) {
     scope_id_to_finish_flag =
@@ -323,6 +348,10 @@ void ComputeInterceptor::Run() {
     VLOG(3) << "id=" << GetInterceptorId()
             << " ComputeInterceptor running in scope " << cur_scope_id_;
 
+    bool scheduled = IsScheduled();
+    if (scheduled) {
+      pipeline_schedule_->BeginStep();
+    }
     RunOps();
 
     if (!gen_step_to_scope_id_to_finish_flag_.empty()) {
@@ -346,6 +375,17 @@ void ComputeInterceptor::Run() {
     SendDataReadyToDownStream();
     // reply to upstream and decrease ready data
     ReplyCompletedToUpStream();
+
+    if (scheduled) {
+      // hand the turn to the interceptor of the next step, which may have
+      // had its inputs ready for a while
+      int64_t next_id = pipeline_schedule_->EndStep();
+      if (next_id >= 0 && next_id != interceptor_id_) {
+        InterceptorMessage next_msg;
+        next_msg.set_message_type(SCHEDULE_NEXT);
+        Send(next_id, next_msg);
+      }
+    }
   }
 }
 
@@ -382,6 +422,10 @@ void ComputeInterceptor::Compute(const InterceptorMessage& msg) {
     gen_step_to_scope_id_to_finish_flag_[gen_step].emplace(msg.scope_idx(),
                                                            false);
     Run();
+  } else if (msg.message_type() == SCHEDULE_NEXT) {
+    VLOG(3) << "Compute interceptor " << interceptor_id_
+            << " receive schedule_next " << msg.src_id();
+    Run();
   }
 }
 
@@ -50,6 +50,9 @@ class ComputeInterceptor : public Interceptor {
   InterceptorMessage PrepareVarsMsg();
   void DecodeMsgVars(const InterceptorMessage& msg);
 
+  // Whether the node runs the steps of a pipeline schedule, which picks the
+  // micro batch it is to run next.
+  bool IsScheduled() const;
   bool IsInputReady();
   bool CanWriteOutput();
   std::map<int64_t, std::map<int64_t, bool>>
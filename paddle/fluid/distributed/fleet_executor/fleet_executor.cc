@@ -151,7 +151,8 @@ void FleetExecutor::Init(
     const std::vector<TaskNode*>& task_nodes,
     const std::unordered_map<int64_t, int64_t>& task_id_to_rank,
     const std::vector<std::string>& inference_root_scope_vars,
-    const std::vector<framework::Scope*>& micro_scope_list) {
+    const std::vector<framework::Scope*>& micro_scope_list,
+    const std::string& pipeline_schedule_str) {
   PADDLE_ENFORCE_GT(task_nodes.size(),
                     0,
                     platform::errors::InvalidArgument(
@@ -209,6 +210,12 @@ void FleetExecutor::Init(
   }
   runtime_graph_->SetInterceptorIdToRank(task_id_to_rank);
   runtime_graph_->SetInterceptorIdToNode(interceptor_id_to_task);
+  PipelineScheduleDesc pipeline_schedule;
+  bool parse_flag = pipeline_schedule.ParseFromString(pipeline_schedule_str);
+  PADDLE_ENFORCE(parse_flag,
+                 platform::errors::PreconditionNotMet(
+                     "Error occurs while parsing string to proto"));
+  runtime_graph_->SetPipelineSchedule(pipeline_schedule);
 
   VLOG(5) << runtime_graph_->DebugString();
   Carrier* carrier =
@@ -242,7 +249,8 @@ void FleetExecutor::InitCarrier(
                 num_micro_batches,
                 place,
                 inference_root_scope_vars,
-                micro_scope_list);
+                micro_scope_list,
+                runtime_graph_->pipeline_schedule());
 }
 
 void FleetExecutor::InitMessageBus() {
@@ -47,7 +47,8 @@ class FleetExecutor final {
             const std::vector<TaskNode*>& task_nodes,
             const std::unordered_map<int64_t, int64_t>& task_id_to_rank,
             const std::vector<std::string>& inference_root_scope_vars = {},
-            const std::vector<framework::Scope*>& micro_scope_list = {});
+            const std::vector<framework::Scope*>& micro_scope_list = {},
+            const std::string& pipeline_schedule_str = "");
   void Run(const std::string& carrier_id);
 
  private:
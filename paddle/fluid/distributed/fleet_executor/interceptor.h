@@ -40,6 +40,7 @@ namespace distributed {
 class TaskNode;
 class Carrier;
 class TaskLoop;
+class PipelineSchedule;
 
 using InterpreterCore = framework::InterpreterCore;
 
@@ -85,6 +86,9 @@ class Interceptor {
   void SetGC(const std::shared_ptr<framework::GarbageCollector>& gc) {
     gc_ = gc;
   }
+  void SetPipelineSchedule(PipelineSchedule* schedule) {
+    pipeline_schedule_ = schedule;
+  }
   void RegisterCarrier(Carrier* carrier) { carrier_ = carrier; }
   void RegisterTaskLoop(TaskLoop* loop) { loop_ = loop; }
 
@@ -109,6 +113,8 @@ class Interceptor {
   std::vector<framework::Scope*> microbatch_scopes_{};
   std::vector<std::shared_ptr<InterpreterCore>> cores_{};
   std::shared_ptr<framework::GarbageCollector> gc_{nullptr};
+  // the order of the steps of the stage, owned by the carrier
+  PipelineSchedule* pipeline_schedule_{nullptr};
 
   Carrier* carrier_;
   TaskLoop* loop_;
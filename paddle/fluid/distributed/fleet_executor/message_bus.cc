@@ -22,6 +22,9 @@
 #include "paddle/fluid/distributed/fleet_executor/carrier.h"
 #include "paddle/fluid/distributed/fleet_executor/global.h"
 #include "paddle/fluid/platform/gen_comm_id_helper.h"
+#include "paddle/phi/core/flags.h"
+
+PHI_DECLARE_int64(fleet_executor_shm_ring_bytes);
 
 namespace paddle {
 namespace distributed {
@@ -67,12 +70,24 @@ void MessageBus::Init(
 #endif
 
   ListenPort();
+
+  if (addr_ != "" && FLAGS_fleet_executor_shm_ring_bytes > 0 &&
+      ShmTransport::IsSupported()) {
+    shm_transport_ = std::make_unique<ShmTransport>(
+        rank_,
+        rank_to_addr_,
+        FLAGS_fleet_executor_shm_ring_bytes,
+        [this](const InterceptorMessage& interceptor_message) {
+          DispatchMsgToCarrier(interceptor_message);
+        });
+  }
 }
 
 bool MessageBus::IsInit() const { return is_init_; }
 
 MessageBus::~MessageBus() {
   VLOG(3) << "Message bus releases resource.";
+  shm_transport_.reset();
 #if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
   server_.Stop(1000);
   server_.Join();
@@ -94,6 +109,14 @@ bool MessageBus::Send(int64_t dst_rank,
       true,
       platform::errors::PreconditionNotMet(
           "Using message bus since it has not been initialized."));
+  // The barrier stays on brpc, the rings of the peers are opened after it.
+  if (shm_transport_ && !interceptor_message.ctrl_message() &&
+      shm_transport_->IsLocal(dst_rank)) {
+    VLOG(3) << "Message bus sends to rank " << dst_rank
+            << " through shared memory.";
+    shm_transport_->Send(dst_rank, interceptor_message);
+    return true;
+  }
 #if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
   int retry_time = 0;  // message bus will retry sending for 10 times
   while (retry_time < 10) {
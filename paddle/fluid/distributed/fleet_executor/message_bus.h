@@ -15,6 +15,7 @@
 #pragma once
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -27,6 +28,7 @@
 #endif
 
 #include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
+#include "paddle/fluid/distributed/fleet_executor/shm_transport.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/errors.h"
 #include "paddle/fluid/platform/macros.h"
@@ -48,7 +50,8 @@ class MessageBus final {
 
   bool IsInit() const;
 
-  // called by Interceptor, send InterceptorMessage to dst
+  // called by Interceptor, send InterceptorMessage to dst, through shared
+  // memory when dst is on the host of this rank
   bool Send(int64_t dst_rank, const InterceptorMessage& interceptor_message);
 
   void IncreaseBarrierCount();
@@ -79,6 +82,9 @@ class MessageBus final {
   // the ip needs to be listened
   std::string addr_;
 
+  // for the messages to the ranks on the host of this rank
+  std::unique_ptr<ShmTransport> shm_transport_;
+
 #if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
   MessageServiceImpl message_service_;
   // brpc server
@@ -0,0 +1,333 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/fleet_executor/pipeline_schedule.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/errors.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+int64_t NowMicroseconds() {
+  // The clock of the system, for the traces of the stages to line up.
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+std::vector<PipelineStep> GPipeSteps(int64_t num_micro_batches) {
+  std::vector<PipelineStep> steps;
+  for (int64_t i = 0; i < num_micro_batches; ++i) {
+    steps.push_back({PipelinePass::FORWARD, 0, i});
+  }
+  for (int64_t i = 0; i < num_micro_batches; ++i) {
+    steps.push_back({PipelinePass::BACKWARD, 0, i});
+  }
+  return steps;
+}
+
+std::vector<PipelineStep> OneFOneBSteps(int64_t num_stages,
+                                        int64_t stage,
+                                        int64_t num_micro_batches) {
+  std::vector<PipelineStep> steps;
+  int64_t num_warmup = std::min(num_stages - stage - 1, num_micro_batches);
+  for (int64_t i = 0; i < num_warmup; ++i) {
+    steps.push_back({PipelinePass::FORWARD, 0, i});
+  }
+  for (int64_t i = 0; i < num_micro_batches - num_warmup; ++i) {
+    steps.push_back({PipelinePass::FORWARD, 0, num_warmup + i});
+    steps.push_back({PipelinePass::BACKWARD, 0, i});
+  }
+  for (int64_t i = num_micro_batches - num_warmup; i < num_micro_batches;
+       ++i) {
+    steps.push_back({PipelinePass::BACKWARD, 0, i});
+  }
+  return steps;
+}
+
+// The schedule of Megatron-LM: the k-th forward step of a stage runs the
+// chunk (k mod (num_stages * num_chunks)) / num_stages, and every chunk
+// takes the micro batches num_stages at a time.
+std::vector<PipelineStep> InterleavedSteps(int64_t num_stages,
+                                           int64_t stage,
+                                           int64_t num_micro_batches,
+                                           int64_t num_chunks) {
+  const int64_t group = num_stages * num_chunks;
+  auto step_of = [&](PipelinePass pass, int64_t k) -> PipelineStep {
+    int64_t chunk = (k % group) / num_stages;
+    if (pass == PipelinePass::BACKWARD) {
+      chunk = num_chunks - chunk - 1;
+    }
+    return {pass, chunk, k / group * num_stages + k % num_stages};
+  };
+
+  const int64_t num_total = num_micro_batches * num_chunks;
+  int64_t num_warmup = num_total;
+  if (num_micro_batches != num_stages) {
+    num_warmup = std::min(
+        (num_stages - stage - 1) * 2 + (num_chunks - 1) * num_stages,
+        num_total);
+  }
+  std::vector<PipelineStep> steps;
+  for (int64_t k = 0; k < num_warmup; ++k) {
+    steps.push_back(step_of(PipelinePass::FORWARD, k));
+  }
+  for (int64_t k = 0; k < num_total - num_warmup; ++k) {
+    steps.push_back(step_of(PipelinePass::FORWARD, num_warmup + k));
+    steps.push_back(step_of(PipelinePass::BACKWARD, k));
+  }
+  for (int64_t k = num_total - num_warmup; k < num_total; ++k) {
+    steps.push_back(step_of(PipelinePass::BACKWARD, k));
+  }
+  return steps;
+}
+
+}  // namespace
+
+std::vector<PipelineStep> PipelineSchedule::BuildSteps(
+    const std::string& mode,
+    int64_t num_stages,
+    int64_t stage,
+    int64_t num_micro_batches,
+    int64_t num_virtual_stages) {
+  PADDLE_ENFORCE_GE(num_stages,
+                    1,
+                    platform::errors::InvalidArgument(
+                        "The pipeline must have at least one stage, but "
+                        "num_stages is %ld.",
+                        num_stages));
+  PADDLE_ENFORCE_EQ(
+      stage >= 0 && stage < num_stages,
+      true,
+      platform::errors::InvalidArgument(
+          "The stage %ld is out of the %ld stages.", stage, num_stages));
+  PADDLE_ENFORCE_GE(num_micro_batches,
+                    1,
+                    platform::errors::InvalidArgument(
+                        "The pipeline must run at least one micro batch, "
+                        "but num_micro_batches is %ld.",
+                        num_micro_batches));
+  PADDLE_ENFORCE_GE(num_virtual_stages,
+                    1,
+                    platform::errors::InvalidArgument(
+                        "A stage must have at least one virtual stage, but "
+                        "num_virtual_stages is %ld.",
+                        num_virtual_stages));
+  if (mode == "Interleaved1F1B") {
+    if (num_virtual_stages == 1) {
+      return OneFOneBSteps(num_stages, stage, num_micro_batches);
+    }
+    PADDLE_ENFORCE_EQ(num_micro_batches % num_stages,
+                      0,
+                      platform::errors::InvalidArgument(
+                          "The interleaved 1F1B schedule needs the micro "
+                          "batches to be a multiple of the %ld stages, but "
+                          "num_micro_batches is %ld.",
+                          num_stages,
+                          num_micro_batches));
+    return InterleavedSteps(
+        num_stages, stage, num_micro_batches, num_virtual_stages);
+  }
+  PADDLE_ENFORCE_EQ(num_virtual_stages,
+                    1,
+                    platform::errors::InvalidArgument(
+                        "Only the Interleaved1F1B schedule has more than one "
+                        "virtual stage, but the %s one has %ld.",
+                        mode,
+                        num_virtual_stages));
+  if (mode == "GPipe") {
+    return GPipeSteps(num_micro_batches);
+  } else if (mode == "1F1B") {
+    return OneFOneBSteps(num_stages, stage, num_micro_batches);
+  }
+  PADDLE_THROW(platform::errors::InvalidArgument(
+      "The pipeline schedule must be GPipe, 1F1B or Interleaved1F1B, but "
+      "received %s.",
+      mode));
+}
+
+PipelineSchedule::PipelineSchedule(const PipelineScheduleDesc& desc,
+                                   int64_t num_micro_batches)
+    : desc_(desc),
+      num_micro_batches_(num_micro_batches),
+      steps_(BuildSteps(desc.mode(),
+                        desc.num_stages(),
+                        desc.stage(),
+                        num_micro_batches,
+                        desc.num_virtual_stages())) {
+  times_.reserve(steps_.size());
+}
+
+void PipelineSchedule::RegisterInterceptor(PipelinePass pass,
+                                           int64_t chunk,
+                                           int64_t interceptor_id) {
+  PADDLE_ENFORCE_EQ(pass != PipelinePass::NONE,
+                    true,
+                    platform::errors::InvalidArgument(
+                        "Interceptor %ld runs no pass of the pipeline.",
+                        interceptor_id));
+  PADDLE_ENFORCE_EQ(
+      chunk >= 0 && chunk < desc_.num_virtual_stages(),
+      true,
+      platform::errors::InvalidArgument(
+          "Interceptor %ld runs the chunk %ld, but the stage has %ld.",
+          interceptor_id,
+          chunk,
+          desc_.num_virtual_stages()));
+  bool inserted =
+      interceptor_ids_.emplace(std::make_pair(pass, chunk), interceptor_id)
+          .second;
+  PADDLE_ENFORCE_EQ(inserted,
+                    true,
+                    platform::errors::AlreadyExists(
+                        "Interceptor %ld runs a pass of chunk %ld another "
+                        "interceptor already runs.",
+                        interceptor_id,
+                        chunk));
+}
+
+int64_t PipelineSchedule::NextMicroBatch(PipelinePass pass,
+                                         int64_t chunk) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const PipelineStep& step = steps_[next_step_];
+  if (step.pass != pass || step.chunk != chunk) {
+    return -1;
+  }
+  return step.micro_batch;
+}
+
+void PipelineSchedule::BeginStep() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (steps_[next_step_].pass == PipelinePass::FORWARD) {
+    peak_in_flight_ = std::max(peak_in_flight_, ++in_flight_);
+  }
+  times_.emplace_back(NowMicroseconds(), 0);
+}
+
+int64_t PipelineSchedule::EndStep() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PADDLE_ENFORCE_EQ(times_.size(),
+                      next_step_ + 1,
+                      platform::errors::PreconditionNotMet(
+                          "EndStep is called without BeginStep."));
+    times_.back().second = NowMicroseconds();
+    if (steps_[next_step_].pass == PipelinePass::BACKWARD) {
+      --in_flight_;
+    }
+    if (++next_step_ < steps_.size()) {
+      const PipelineStep& step = steps_[next_step_];
+      auto iter =
+          interceptor_ids_.find(std::make_pair(step.pass, step.chunk));
+      PADDLE_ENFORCE_NE(
+          iter,
+          interceptor_ids_.end(),
+          platform::errors::NotFound(
+              "No interceptor runs the %s pass of chunk %ld of stage %ld.",
+              step.pass == PipelinePass::FORWARD ? "forward" : "backward",
+              step.chunk,
+              desc_.stage()));
+      return iter->second;
+    }
+    // The next run starts over.
+    next_step_ = 0;
+    last_times_.swap(times_);
+    times_.clear();
+  }
+  FinishRun();
+  return -1;
+}
+
+void PipelineSchedule::FinishRun() {
+  VLOG(1) << Summary();
+  if (!desc_.trace_file().empty()) {
+    std::string path =
+        desc_.trace_file() + "." + std::to_string(desc_.stage());
+    std::ofstream out(path);
+    PADDLE_ENFORCE_EQ(out.good(),
+                      true,
+                      platform::errors::Unavailable(
+                          "Cannot open the pipeline trace file %s.", path));
+    out << TraceJson();
+  }
+}
+
+int64_t PipelineSchedule::peak_in_flight() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return peak_in_flight_;
+}
+
+double PipelineSchedule::last_bubble_ratio() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (last_times_.empty()) {
+    return 0.0;
+  }
+  int64_t busy = 0;
+  for (const auto& time : last_times_) {
+    busy += time.second - time.first;
+  }
+  int64_t span = last_times_.back().second - last_times_.front().first;
+  return span > 0 ? 1.0 - static_cast<double>(busy) / span : 0.0;
+}
+
+std::string PipelineSchedule::TraceJson() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostringstream os;
+  os << "{\"traceEvents\":[\n";
+  os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << desc_.stage()
+     << ",\"args\":{\"name\":\"" << desc_.mode() << " stage "
+     << desc_.stage() << "\"}}";
+  for (size_t i = 0; i < last_times_.size(); ++i) {
+    const PipelineStep& step = steps_[i];
+    bool forward = step.pass == PipelinePass::FORWARD;
+    os << ",\n{\"name\":\"" << (forward ? "F" : "B") << step.micro_batch;
+    if (desc_.num_virtual_stages() > 1) {
+      os << "." << step.chunk;
+    }
+    os << "\",\"cat\":\"" << (forward ? "forward" : "backward")
+       << "\",\"ph\":\"X\",\"pid\":" << desc_.stage()
+       << ",\"tid\":0,\"ts\":" << last_times_[i].first
+       << ",\"dur\":" << last_times_[i].second - last_times_[i].first
+       << ",\"args\":{\"micro_batch\":" << step.micro_batch
+       << ",\"chunk\":" << step.chunk << "}}";
+  }
+  os << "\n]}\n";
+  return os.str();
+}
+
+std::string PipelineSchedule::Summary() const {
+  double bubble_ratio = last_bubble_ratio();
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostringstream os;
+  os << desc_.mode() << " schedule of stage " << desc_.stage() << " of "
+     << desc_.num_stages() << " over " << num_micro_batches_
+     << " micro batches";
+  if (!last_times_.empty()) {
+    os << ": " << (last_times_.back().second - last_times_.front().first)
+       << " us, bubble " << bubble_ratio * 100 << "%";
+  }
+  os << ", at most " << peak_in_flight_ << " micro batches in flight";
+  return os.str();
+}
+
+}  // namespace distributed
+}  // namespace paddle
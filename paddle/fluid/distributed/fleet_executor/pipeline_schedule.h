@@ -0,0 +1,110 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/distributed/fleet_executor/fleet_executor_desc.pb.h"
+#include "paddle/fluid/distributed/fleet_executor/task_node.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace distributed {
+
+struct PipelineStep {
+  PipelinePass pass;
+  int64_t chunk;
+  int64_t micro_batch;
+};
+
+// The order of the forward and backward steps of a pipeline stage, which
+// the compute interceptors of the stage keep to instead of running whatever
+// micro batch is ready:
+//   GPipe: all the forward passes, then all the backward passes, which keeps
+//     the activations of every micro batch.
+//   1F1B: num_stages - stage - 1 forward passes, then one forward and one
+//     backward in turn, which keeps the activations of at most
+//     num_stages - stage micro batches.
+//   Interleaved1F1B: 1F1B over num_virtual_stages model chunks of a stage,
+//     chunk c of stage s being the stage c * num_stages + s of the model,
+//     which divides the bubble by num_virtual_stages. The micro batches must
+//     be a multiple of num_stages.
+// The schedule bounds the micro batches in flight, so the buffers between
+// the scheduled nodes must hold all the micro batches for them not to block
+// a step of the schedule.
+class PipelineSchedule final {
+ public:
+  PipelineSchedule(const PipelineScheduleDesc& desc,
+                   int64_t num_micro_batches);
+
+  static std::vector<PipelineStep> BuildSteps(const std::string& mode,
+                                              int64_t num_stages,
+                                              int64_t stage,
+                                              int64_t num_micro_batches,
+                                              int64_t num_virtual_stages);
+
+  void RegisterInterceptor(PipelinePass pass,
+                           int64_t chunk,
+                           int64_t interceptor_id);
+
+  // The micro batch the interceptor of pass and chunk is to run, or -1 while
+  // the current step is another one.
+  int64_t NextMicroBatch(PipelinePass pass, int64_t chunk) const;
+
+  // Called by the interceptor of the current step around running it.
+  // EndStep returns the interceptor of the next step, to be woken up, or -1
+  // after the last step of the run, the schedule starting over.
+  void BeginStep();
+  int64_t EndStep();
+
+  const std::vector<PipelineStep>& steps() const { return steps_; }
+  // The most forward steps run without their backward ones, the
+  // activations held at once, over the runs so far.
+  int64_t peak_in_flight() const;
+  // The share of the time of the last run the stage was not running steps.
+  double last_bubble_ratio() const;
+  // A chrome trace of the steps of the last run, the bubbles being the gaps.
+  std::string TraceJson() const;
+  std::string Summary() const;
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(PipelineSchedule);
+
+  // Logs the run just finished and writes its trace.
+  void FinishRun();
+
+  PipelineScheduleDesc desc_;
+  int64_t num_micro_batches_;
+  std::vector<PipelineStep> steps_;
+  // (pass, chunk) -> interceptor id
+  std::map<std::pair<PipelinePass, int64_t>, int64_t> interceptor_ids_;
+
+  mutable std::mutex mutex_;
+  size_t next_step_{0};
+  int64_t in_flight_{0};
+  int64_t peak_in_flight_{0};
+  // The (begin, end) in microseconds of the steps of the current run, and
+  // of the last one finished.
+  std::vector<std::pair<int64_t, int64_t>> times_;
+  std::vector<std::pair<int64_t, int64_t>> last_times_;
+};
+
+}  // namespace distributed
+}  // namespace paddle
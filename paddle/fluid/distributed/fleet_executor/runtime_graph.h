@@ -44,12 +44,19 @@ class RuntimeGraph final {
       const std::unordered_map<int64_t, TaskNode*>& interceptor_id_to_node) {
     interceptor_id_to_node_ = interceptor_id_to_node;
   }
+  const PipelineScheduleDesc& pipeline_schedule() const {
+    return pipeline_schedule_;
+  }
+  void SetPipelineSchedule(const PipelineScheduleDesc& pipeline_schedule) {
+    pipeline_schedule_ = pipeline_schedule;
+  }
   std::string DebugString() const;
 
  private:
   DISABLE_COPY_AND_ASSIGN(RuntimeGraph);
   std::unordered_map<int64_t, TaskNode*> interceptor_id_to_node_;
   std::unordered_map<int64_t, int64_t> interceptor_id_to_rank_;
+  PipelineScheduleDesc pipeline_schedule_;
 };
 
 }  // namespace distributed
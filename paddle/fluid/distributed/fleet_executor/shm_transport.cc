@@ -0,0 +1,498 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/fleet_executor/shm_transport.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace distributed {
+
+#ifdef __linux__
+
+namespace {
+
+// A ring of a peer is waited for this long to be created at the first Send,
+// and a full ring this long to be read, as the brpc timeouts of SendInterRank.
+constexpr auto kOpenTimeout = std::chrono::seconds(100);
+constexpr auto kFullTimeout = std::chrono::seconds(100);
+// The reader spins this long on an empty ring before sleeping on the futex,
+// which keeps the wake up of the futex off the latency of a busy exchange.
+// Not on one CPU, where the spin only delays the writer.
+const auto kSpinTime = std::thread::hardware_concurrency() > 1
+                           ? std::chrono::microseconds(20)
+                           : std::chrono::microseconds(0);
+constexpr uint32_t kRingReady = 0x474e4952;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2 &&
+                  sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+                  sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "The rings need the atomics to work across processes.");
+
+// At the start of the segment of a ring, its bytes following. head and tail
+// count the bytes written and read, and are on lines of their own for the
+// writer and the reader not to share a cache line.
+struct ShmRingHeader {
+  std::atomic<uint32_t> ready;
+  uint64_t capacity;
+  alignas(64) std::atomic<uint64_t> head;
+  alignas(64) std::atomic<uint64_t> tail;
+  // The futex the reader sleeps on when consumer_waiting is set.
+  alignas(64) std::atomic<uint32_t> signal;
+  std::atomic<uint32_t> consumer_waiting;
+};
+
+void FutexWait(std::atomic<uint32_t>* word, uint32_t value, int timeout_ms) {
+  ::timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+  // Not FUTEX_PRIVATE, the word is shared with another process.
+  ::syscall(SYS_futex,
+            reinterpret_cast<uint32_t*>(word),
+            FUTEX_WAIT,
+            value,
+            &timeout,
+            nullptr,
+            0);
+}
+
+void FutexWake(std::atomic<uint32_t>* word) {
+  ::syscall(SYS_futex,
+            reinterpret_cast<uint32_t*>(word),
+            FUTEX_WAKE,
+            INT_MAX,
+            nullptr,
+            nullptr,
+            0);
+}
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+std::string HostOf(const std::string& addr) {
+  return addr.substr(0, addr.rfind(':'));
+}
+
+// The ring of the rank at dst_addr that src_rank writes to.
+std::string RingName(const std::string& dst_addr, int64_t src_rank) {
+  std::string name =
+      "/paddle_fleet_executor_" + dst_addr + "_" + std::to_string(src_rank);
+  std::replace_if(
+      name.begin() + 1,
+      name.end(),
+      [](char c) { return !std::isalnum(static_cast<unsigned char>(c)); },
+      '_');
+  return name;
+}
+
+}  // namespace
+
+class ShmRing {
+ public:
+  // Creates the ring of a reader, replacing the one a crashed run left.
+  static std::unique_ptr<ShmRing> Create(const std::string& name,
+                                         size_t capacity);
+  // Opens the ring of a writer, or returns null while it is not created.
+  static std::unique_ptr<ShmRing> Open(const std::string& name);
+  ~ShmRing();
+
+  // Writes the bytes as one message. Called from any thread.
+  void Write(const std::string& bytes);
+  // Reads the next message into bytes, or returns false once stop is set.
+  // Called from the thread of the reader.
+  bool Read(std::string* bytes, const std::atomic<bool>& stop);
+  // Wakes up the reader.
+  void Wake();
+
+ private:
+  ShmRing(const std::string& name, bool owner, void* addr, size_t size);
+  void WriteBytes(const char* bytes, size_t n);
+  bool ReadBytes(char* bytes, size_t n, const std::atomic<bool>& stop);
+  bool WaitForData(const std::atomic<bool>& stop);
+
+  std::string name_;
+  bool owner_;
+  void* addr_;
+  size_t size_;
+  ShmRingHeader* header_;
+  char* data_;
+  uint64_t mask_;
+  std::mutex write_mutex_;
+};
+
+ShmRing::ShmRing(const std::string& name, bool owner, void* addr, size_t size)
+    : name_(name),
+      owner_(owner),
+      addr_(addr),
+      size_(size),
+      header_(reinterpret_cast<ShmRingHeader*>(addr)),
+      data_(reinterpret_cast<char*>(addr) + sizeof(ShmRingHeader)),
+      mask_(header_->capacity - 1) {}
+
+std::unique_ptr<ShmRing> ShmRing::Create(const std::string& name,
+                                         size_t capacity) {
+  // A power of two, for the positions in the ring to be masks of head and
+  // tail.
+  size_t ring_bytes = 4096;
+  while (ring_bytes < capacity) {
+    ring_bytes *= 2;
+  }
+  const size_t size = sizeof(ShmRingHeader) + ring_bytes;
+
+  ::shm_unlink(name.c_str());
+  int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  PADDLE_ENFORCE_NE(fd,
+                    -1,
+                    platform::errors::Unavailable(
+                        "Creating the shared memory %s failed: %s.",
+                        name,
+                        std::strerror(errno)));
+  if (::ftruncate(fd, size) != 0) {
+    const int error = errno;
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    PADDLE_THROW(platform::errors::Unavailable(
+        "Truncating the shared memory %s to %d bytes failed: %s.",
+        name,
+        size,
+        std::strerror(error)));
+  }
+  void* addr =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    ::shm_unlink(name.c_str());
+    PADDLE_THROW(platform::errors::Unavailable(
+        "Memory map of the shared memory %s failed.", name));
+  }
+
+  auto* header = new (addr) ShmRingHeader();
+  header->capacity = ring_bytes;
+  header->ready.store(kRingReady, std::memory_order_release);
+  return std::unique_ptr<ShmRing>(new ShmRing(name, true, addr, size));
+}
+
+std::unique_ptr<ShmRing> ShmRing::Open(const std::string& name) {
+  int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd == -1) {
+    return nullptr;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(ShmRingHeader)) {
+    ::close(fd);
+    return nullptr;
+  }
+  const size_t size = st.st_size;
+  void* addr =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  PADDLE_ENFORCE_NE(addr,
+                    MAP_FAILED,
+                    platform::errors::Unavailable(
+                        "Memory map of the shared memory %s failed.", name));
+  auto* header = reinterpret_cast<ShmRingHeader*>(addr);
+  if (header->ready.load(std::memory_order_acquire) != kRingReady ||
+      sizeof(ShmRingHeader) + header->capacity != size) {
+    ::munmap(addr, size);
+    return nullptr;
+  }
+  return std::unique_ptr<ShmRing>(new ShmRing(name, false, addr, size));
+}
+
+ShmRing::~ShmRing() {
+  ::munmap(addr_, size_);
+  if (owner_) {
+    ::shm_unlink(name_.c_str());
+  }
+}
+
+void ShmRing::Write(const std::string& bytes) {
+  PADDLE_ENFORCE_LE(bytes.size(),
+                    std::numeric_limits<uint32_t>::max(),
+                    platform::errors::InvalidArgument(
+                        "The messages through shared memory must be less "
+                        "than 4GB, but got %d bytes.",
+                        bytes.size()));
+  const uint32_t n = bytes.size();
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  WriteBytes(reinterpret_cast<const char*>(&n), sizeof(n));
+  WriteBytes(bytes.data(), n);
+}
+
+void ShmRing::WriteBytes(const char* bytes, size_t n) {
+  const uint64_t capacity = mask_ + 1;
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  auto last_progress = std::chrono::steady_clock::now();
+  int retries = 0;
+  while (n > 0) {
+    const uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    const uint64_t space = capacity - (head - tail);
+    if (space == 0) {
+      // The reader is behind, which is rare for rings much larger than the
+      // messages. The messages larger than a ring go through in parts.
+      if (++retries < 64) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+      PADDLE_ENFORCE_LT(
+          std::chrono::steady_clock::now() - last_progress,
+          kFullTimeout,
+          platform::errors::Unavailable(
+              "The shared memory %s has been full for %d seconds, the "
+              "receiving rank may have exited.",
+              name_,
+              kFullTimeout.count()));
+      continue;
+    }
+    const uint64_t offset = head & mask_;
+    const size_t chunk = std::min<uint64_t>(
+        std::min<uint64_t>(n, space), capacity - offset);
+    std::memcpy(data_ + offset, bytes, chunk);
+    head += chunk;
+    bytes += chunk;
+    n -= chunk;
+    // seq_cst, with the load of consumer_waiting after it and the ones of
+    // the reader in WaitForData, for a reader going to sleep to either see
+    // the bytes or be woken up.
+    header_->head.store(head, std::memory_order_seq_cst);
+    if (header_->consumer_waiting.load(std::memory_order_seq_cst)) {
+      Wake();
+    }
+    last_progress = std::chrono::steady_clock::now();
+    retries = 0;
+  }
+}
+
+void ShmRing::Wake() {
+  header_->signal.fetch_add(1, std::memory_order_seq_cst);
+  FutexWake(&header_->signal);
+}
+
+bool ShmRing::Read(std::string* bytes, const std::atomic<bool>& stop) {
+  uint32_t n;
+  if (!ReadBytes(reinterpret_cast<char*>(&n), sizeof(n), stop)) {
+    return false;
+  }
+  bytes->resize(n);
+  return ReadBytes(&(*bytes)[0], n, stop);
+}
+
+bool ShmRing::ReadBytes(char* bytes,
+                        size_t n,
+                        const std::atomic<bool>& stop) {
+  const uint64_t capacity = mask_ + 1;
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  while (n > 0) {
+    if (!WaitForData(stop)) {
+      return false;
+    }
+    const uint64_t head = header_->head.load(std::memory_order_acquire);
+    const uint64_t offset = tail & mask_;
+    const size_t chunk = std::min<uint64_t>(
+        std::min<uint64_t>(n, head - tail), capacity - offset);
+    std::memcpy(bytes, data_ + offset, chunk);
+    tail += chunk;
+    bytes += chunk;
+    n -= chunk;
+    header_->tail.store(tail, std::memory_order_release);
+  }
+  return true;
+}
+
+bool ShmRing::WaitForData(const std::atomic<bool>& stop) {
+  const uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  const auto spin_end = std::chrono::steady_clock::now() + kSpinTime;
+  for (;;) {
+    if (header_->head.load(std::memory_order_acquire) != tail) {
+      return true;
+    }
+    if (std::chrono::steady_clock::now() >= spin_end) {
+      break;
+    }
+    CpuRelax();
+  }
+
+  while (!stop.load()) {
+    const uint32_t signal = header_->signal.load(std::memory_order_seq_cst);
+    header_->consumer_waiting.store(1, std::memory_order_seq_cst);
+    if (header_->head.load(std::memory_order_seq_cst) != tail) {
+      header_->consumer_waiting.store(0, std::memory_order_relaxed);
+      return true;
+    }
+    // With a timeout, for a writer to have no way to keep the reader asleep
+    // whatever it does.
+    FutexWait(&header_->signal, signal, 100);
+    header_->consumer_waiting.store(0, std::memory_order_relaxed);
+    if (header_->head.load(std::memory_order_acquire) != tail) {
+      return true;
+    }
+  }
+  return false;
+}
+
+ShmTransport::ShmTransport(
+    int64_t rank,
+    const std::unordered_map<int64_t, std::string>& rank_to_addr,
+    size_t ring_bytes,
+    Handler handler)
+    : rank_(rank), ring_bytes_(ring_bytes), handler_(std::move(handler)) {
+  auto iter = rank_to_addr.find(rank_);
+  PADDLE_ENFORCE_NE(
+      iter,
+      rank_to_addr.end(),
+      platform::errors::NotFound("Cannot find addr rank id %lld.", rank_));
+  const std::string& addr = iter->second;
+  const std::string host = HostOf(addr);
+  for (const auto& pair : rank_to_addr) {
+    if (pair.first == rank_ || HostOf(pair.second) != host) {
+      continue;
+    }
+    local_rank_to_ring_name_[pair.first] = RingName(pair.second, rank_);
+    recv_rings_.emplace_back(
+        ShmRing::Create(RingName(addr, pair.first), ring_bytes_));
+  }
+  for (auto& ring : recv_rings_) {
+    recv_threads_.emplace_back(&ShmTransport::ReceiveLoop, this, ring.get());
+  }
+  VLOG(3) << "Shared memory transport of rank " << rank_ << " reaches "
+          << local_rank_to_ring_name_.size() << " ranks on host " << host
+          << ".";
+}
+
+ShmTransport::~ShmTransport() {
+  stop_ = true;
+  for (auto& ring : recv_rings_) {
+    ring->Wake();
+  }
+  for (auto& thread : recv_threads_) {
+    thread.join();
+  }
+}
+
+bool ShmTransport::IsSupported() { return true; }
+
+bool ShmTransport::IsLocal(int64_t dst_rank) const {
+  return local_rank_to_ring_name_.count(dst_rank) > 0;
+}
+
+void ShmTransport::Send(int64_t dst_rank,
+                        const InterceptorMessage& interceptor_message) {
+  ShmRing* ring = GetSendRing(dst_rank);
+  std::string bytes;
+  PADDLE_ENFORCE_EQ(interceptor_message.SerializeToString(&bytes),
+                    true,
+                    platform::errors::InvalidArgument(
+                        "Serializing the interceptor message failed."));
+  ring->Write(bytes);
+}
+
+ShmRing* ShmTransport::GetSendRing(int64_t dst_rank) {
+  std::lock_guard<std::mutex> lock(send_rings_mutex_);
+  auto iter = send_rings_.find(dst_rank);
+  if (iter != send_rings_.end()) {
+    return iter->second.get();
+  }
+  auto name_iter = local_rank_to_ring_name_.find(dst_rank);
+  PADDLE_ENFORCE_NE(name_iter,
+                    local_rank_to_ring_name_.end(),
+                    platform::errors::InvalidArgument(
+                        "Rank %lld is not on the host of rank %lld.",
+                        dst_rank,
+                        rank_));
+  const auto begin = std::chrono::steady_clock::now();
+  std::unique_ptr<ShmRing> ring;
+  while (!(ring = ShmRing::Open(name_iter->second))) {
+    PADDLE_ENFORCE_LT(
+        std::chrono::steady_clock::now() - begin,
+        kOpenTimeout,
+        platform::errors::Unavailable(
+            "The shared memory %s of rank %lld has not been created in %d "
+            "seconds.",
+            name_iter->second,
+            dst_rank,
+            kOpenTimeout.count()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return (send_rings_[dst_rank] = std::move(ring)).get();
+}
+
+void ShmTransport::ReceiveLoop(ShmRing* ring) {
+  std::string bytes;
+  while (ring->Read(&bytes, stop_)) {
+    InterceptorMessage interceptor_message;
+    if (!interceptor_message.ParseFromString(bytes)) {
+      LOG(ERROR) << "Shared memory transport of rank " << rank_
+                 << " received a message it cannot parse.";
+      continue;
+    }
+    try {
+      handler_(interceptor_message);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Shared memory transport of rank " << rank_
+                 << " failed to handle a message: " << e.what();
+    }
+  }
+}
+
+#else
+
+class ShmRing {};
+
+ShmTransport::ShmTransport(
+    int64_t rank,
+    const std::unordered_map<int64_t, std::string>& rank_to_addr,
+    size_t ring_bytes,
+    Handler handler) {
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The shared memory transport of the message bus is only on Linux."));
+}
+
+ShmTransport::~ShmTransport() {}
+
+bool ShmTransport::IsSupported() { return false; }
+
+bool ShmTransport::IsLocal(int64_t dst_rank) const { return false; }
+
+void ShmTransport::Send(int64_t dst_rank,
+                        const InterceptorMessage& interceptor_message) {
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The shared memory transport of the message bus is only on Linux."));
+}
+
+#endif
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,85 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace distributed {
+
+class ShmRing;
+
+// Sends the InterceptorMessages between the ranks on one host through shared
+// memory instead of brpc. Each rank owns a ring for every other rank on its
+// host to write into, a single producer single consumer queue of bytes in a
+// segment of /dev/shm, which one thread of the rank reads. The ranks are on
+// one host when their addresses in rank_to_addr have the same ip.
+//
+// The rings of a rank are created by its constructor, and those of the peers
+// opened at the first Send to them, which is to come after a barrier of the
+// ranks for the rings not to be stale ones of an earlier run. Only on Linux.
+class ShmTransport final {
+ public:
+  using Handler = std::function<void(const InterceptorMessage&)>;
+
+  // The messages received are passed to handler on the reading threads.
+  ShmTransport(int64_t rank,
+               const std::unordered_map<int64_t, std::string>& rank_to_addr,
+               size_t ring_bytes,
+               Handler handler);
+  ~ShmTransport();
+
+  static bool IsSupported();
+
+  // Whether dst_rank is on the host of this rank, and so reached by Send.
+  bool IsLocal(int64_t dst_rank) const;
+
+  // Blocks while the ring to dst_rank is full.
+  void Send(int64_t dst_rank, const InterceptorMessage& interceptor_message);
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ShmTransport);
+
+  void ReceiveLoop(ShmRing* ring);
+
+  ShmRing* GetSendRing(int64_t dst_rank);
+
+  int64_t rank_;
+  size_t ring_bytes_;
+  Handler handler_;
+
+  // rank on this host -> the name of the ring this rank writes to it
+  std::unordered_map<int64_t, std::string> local_rank_to_ring_name_;
+
+  std::vector<std::unique_ptr<ShmRing>> recv_rings_;
+  std::vector<std::thread> recv_threads_;
+  std::atomic<bool> stop_{false};
+
+  std::mutex send_rings_mutex_;
+  std::unordered_map<int64_t, std::unique_ptr<ShmRing>> send_rings_;
+};
+
+}  // namespace distributed
+}  // namespace paddle
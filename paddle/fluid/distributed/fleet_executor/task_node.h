@@ -33,6 +33,9 @@ namespace distributed {
 
 enum class DependType { NORMAL, LOOP, STOP_LOOP };
 
+// The pass of the model chunk a task node runs in a pipeline schedule.
+enum class PipelinePass { NONE, FORWARD, BACKWARD };
+
 class TaskNode final {
  public:
   using OperatorBase = paddle::framework::OperatorBase;
@@ -68,6 +71,8 @@ class TaskNode final {
   int64_t reply_up_per_steps() const { return reply_up_per_steps_; }
   int64_t send_down_per_steps() const { return send_down_per_steps_; }
   const std::string& cond_var() const { return cond_var_; }
+  PipelinePass pipeline_pass() const { return pipeline_pass_; }
+  int64_t pipeline_chunk() const { return pipeline_chunk_; }
   const std::unordered_map<int64_t, int64_t>& upstream() const {
     return upstream_;
   }
@@ -99,6 +104,11 @@ class TaskNode final {
   void SetReplyUpPerSteps(int64_t value);
   void SetSendDownPerSteps(int64_t value);
   void SetType(const std::string& type) { type_ = type; }
+  // The steps of the node in the pipeline schedule of its rank.
+  void SetPipelinePass(PipelinePass pass, int64_t chunk = 0) {
+    pipeline_pass_ = pass;
+    pipeline_chunk_ = chunk;
+  }
   void SetUnusedVars(
       const std::unordered_map<const OperatorBase*, std::vector<std::string>>&
           unused_vars) {
@@ -156,6 +166,9 @@ class TaskNode final {
   // one output need multi times input
   int64_t send_down_per_steps_{1};
 
+  PipelinePass pipeline_pass_{PipelinePass::NONE};
+  int64_t pipeline_chunk_{0};
+
   std::string type_;
   std::map<std::string, std::string> vars_to_dtype_;
   std::map<std::string, std::vector<int64_t>> vars_to_shape_;
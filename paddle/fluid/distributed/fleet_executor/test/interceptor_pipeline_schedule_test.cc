@@ -0,0 +1,288 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/fleet_executor/carrier.h"
+#include "paddle/fluid/distributed/fleet_executor/compute_interceptor.h"
+#include "paddle/fluid/distributed/fleet_executor/global.h"
+#include "paddle/fluid/distributed/fleet_executor/interceptor.h"
+#include "paddle/fluid/distributed/fleet_executor/message_bus.h"
+#include "paddle/fluid/distributed/fleet_executor/pipeline_schedule.h"
+#include "paddle/fluid/distributed/fleet_executor/task_node.h"
+
+namespace paddle {
+namespace distributed {
+
+const int64_t kNumStages = 4;
+const int64_t kNumMicroBatches = 8;
+// The activations a whole stage keeps for the backward of a micro batch.
+const size_t kActivationBytes = 1 << 20;
+
+// The activations of this rank, kept from the forward pass of a model chunk
+// to its backward one, and the steps the rank ran in order.
+struct Activations {
+  std::map<std::pair<int64_t, int64_t>, std::string> chunk_and_step_to_data;
+  size_t bytes{0};
+  size_t peak_bytes{0};
+  std::vector<PipelineStep> steps;
+};
+
+Activations* GetActivations() {
+  static Activations activations;
+  return &activations;
+}
+
+// Keeps the activations of a stage in place of running its ops.
+class StageInterceptor : public ComputeInterceptor {
+ public:
+  StageInterceptor(int64_t interceptor_id, TaskNode* node)
+      : ComputeInterceptor(interceptor_id, node) {}
+
+  static int64_t num_chunks;
+
+ private:
+  void RunOps() override {
+    auto* activations = GetActivations();
+    auto key = std::make_pair(node_->pipeline_chunk(), cur_scope_id_);
+    size_t bytes = kActivationBytes / num_chunks;
+    activations->steps.push_back(
+        {node_->pipeline_pass(), node_->pipeline_chunk(), cur_scope_id_});
+    if (node_->pipeline_pass() == PipelinePass::FORWARD) {
+      activations->chunk_and_step_to_data[key] = std::string(bytes, 'a');
+      activations->bytes += bytes;
+      activations->peak_bytes =
+          std::max(activations->peak_bytes, activations->bytes);
+    } else {
+      ASSERT_EQ(activations->chunk_and_step_to_data.erase(key), 1UL);
+      activations->bytes -= bytes;
+    }
+  }
+};
+
+int64_t StageInterceptor::num_chunks = 1;
+
+REGISTER_INTERCEPTOR(Stage, StageInterceptor);
+
+int FreePort() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = 0;
+  bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+  socklen_t len = sizeof(address);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&address), &len);
+  close(fd);
+  return ntohs(address.sin_port);
+}
+
+struct StageResult {
+  // Whether the steps of both runs were those of the schedule, in order.
+  bool steps_in_order;
+  int64_t peak_in_flight;
+  size_t peak_bytes;
+};
+
+// Runs stage `rank` of a pipeline of kNumStages ranks twice. Chunk c of a
+// stage is the stage c * kNumStages + rank of the model, with the
+// interceptors 2 * model_stage for its forward pass and 2 * model_stage + 1
+// for its backward one.
+StageResult RunStage(int64_t rank,
+                     const std::unordered_map<int64_t, std::string>& addrs,
+                     const std::string& mode,
+                     int64_t num_chunks) {
+  StageInterceptor::num_chunks = num_chunks;
+  const int64_t num_model_stages = kNumStages * num_chunks;
+  const int64_t m = kNumMicroBatches;
+  std::unordered_map<int64_t, int64_t> interceptor_id_to_rank;
+  for (int64_t model_stage = 0; model_stage < num_model_stages;
+       ++model_stage) {
+    interceptor_id_to_rank[2 * model_stage] = model_stage % kNumStages;
+    interceptor_id_to_rank[2 * model_stage + 1] = model_stage % kNumStages;
+  }
+  interceptor_id_to_rank[SOURCE_ID] = rank;
+  interceptor_id_to_rank[SINK_ID] = rank;
+
+  std::string carrier_id = "0";
+  Carrier* carrier =
+      GlobalMap<std::string, Carrier>::Create(carrier_id, carrier_id);
+  GlobalVal<std::string>::Set(new std::string(carrier_id));
+  MessageBus* msg_bus = GlobalVal<MessageBus>::Create();
+  msg_bus->Init(rank, addrs, addrs.at(rank));
+  carrier->Init(rank, interceptor_id_to_rank);
+
+  PipelineScheduleDesc desc;
+  desc.set_mode(mode);
+  desc.set_num_stages(kNumStages);
+  desc.set_stage(rank);
+  desc.set_num_virtual_stages(num_chunks);
+  PipelineSchedule schedule(desc, m);
+
+  // NOTE: don't delete, otherwise interceptor will use undefined node
+  // The buffers hold all the micro batches, the schedule bounding those in
+  // flight. The sink of a rank tells it the backward passes of its first
+  // chunk are done.
+  TaskNode* source = new TaskNode(rank, SOURCE_ID, m);
+  TaskNode* sink = new TaskNode(rank, SINK_ID, m);
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    int64_t model_stage = chunk * kNumStages + rank;
+    int64_t forward_id = 2 * model_stage;
+    int64_t backward_id = forward_id + 1;
+    TaskNode* forward = new TaskNode(0, rank, forward_id, m);
+    TaskNode* backward = new TaskNode(0, rank, backward_id, m);
+    forward->SetPipelinePass(PipelinePass::FORWARD, chunk);
+    backward->SetPipelinePass(PipelinePass::BACKWARD, chunk);
+
+    if (model_stage == 0) {
+      source->AddDownstreamTask(forward_id, m);
+      forward->AddUpstreamTask(SOURCE_ID, m);
+    } else {
+      forward->AddUpstreamTask(forward_id - 2, m);
+    }
+    forward->AddDownstreamTask(backward_id, m);
+    backward->AddUpstreamTask(forward_id, m);
+    if (model_stage + 1 < num_model_stages) {
+      forward->AddDownstreamTask(forward_id + 2, m);
+      backward->AddUpstreamTask(backward_id + 2, m);
+    }
+    if (model_stage > 0) {
+      backward->AddDownstreamTask(backward_id - 2, m);
+    }
+    if (chunk == 0) {
+      backward->AddDownstreamTask(SINK_ID, m);
+      sink->AddUpstreamTask(backward_id, m);
+    }
+
+    for (TaskNode* node : {forward, backward}) {
+      Interceptor* interceptor = carrier->SetInterceptor(
+          node->task_id(),
+          InterceptorFactory::Create("Stage", node->task_id(), node));
+      interceptor->SetPipelineSchedule(&schedule);
+      schedule.RegisterInterceptor(
+          node->pipeline_pass(), chunk, node->task_id());
+    }
+  }
+  if (rank == 0) {
+    carrier->SetInterceptor(
+        SOURCE_ID, InterceptorFactory::Create("Source", SOURCE_ID, source));
+  }
+  carrier->SetInterceptor(SINK_ID,
+                          InterceptorFactory::Create("Sink", SINK_ID, sink));
+
+  for (int run = 0; run < 2; ++run) {
+    msg_bus->Barrier();
+    if (rank == 0) {
+      InterceptorMessage msg;
+      msg.set_message_type(START);
+      msg.set_dst_id(SOURCE_ID);
+      carrier->EnqueueInterceptorMessage(msg);
+    }
+    carrier->Wait();
+  }
+  // Keep the ranks up until none sends to another.
+  msg_bus->Barrier();
+
+  const auto& steps = GetActivations()->steps;
+  const auto& expected = schedule.steps();
+  StageResult result;
+  result.steps_in_order = steps.size() == 2 * expected.size();
+  for (size_t i = 0; result.steps_in_order && i < steps.size(); ++i) {
+    const PipelineStep& step = steps[i];
+    const PipelineStep& expected_step = expected[i % expected.size()];
+    result.steps_in_order = step.pass == expected_step.pass &&
+                            step.chunk == expected_step.chunk &&
+                            step.micro_batch == expected_step.micro_batch;
+  }
+  result.peak_in_flight = schedule.peak_in_flight();
+  result.peak_bytes = GetActivations()->peak_bytes;
+  return result;
+}
+
+// Runs the stages in processes of their own, returning what they saw.
+std::vector<StageResult> RunPipeline(const std::string& mode,
+                                     int64_t num_chunks) {
+  std::unordered_map<int64_t, std::string> addrs;
+  for (int64_t rank = 0; rank < kNumStages; ++rank) {
+    addrs[rank] = "127.0.0.1:" + std::to_string(FreePort());
+  }
+  std::vector<pid_t> pids;
+  std::vector<int> read_fds;
+  for (int64_t rank = 0; rank < kNumStages; ++rank) {
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(fds[0]);
+      StageResult result = RunStage(rank, addrs, mode, num_chunks);
+      bool written = write(fds[1], &result, sizeof(result)) == sizeof(result);
+      _exit(written && !testing::Test::HasFailure() ? 0 : 1);
+    }
+    close(fds[1]);
+    pids.push_back(pid);
+    read_fds.push_back(fds[0]);
+  }
+
+  std::vector<StageResult> results(kNumStages);
+  for (int64_t rank = 0; rank < kNumStages; ++rank) {
+    EXPECT_EQ(read(read_fds[rank], &results[rank], sizeof(StageResult)),
+              static_cast<ssize_t>(sizeof(StageResult)));
+    close(read_fds[rank]);
+    int status = 0;
+    EXPECT_EQ(waitpid(pids[rank], &status, 0), pids[rank]);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+  return results;
+}
+
+TEST(InterceptorTest, PipelineSchedules) {
+  std::map<std::string, std::vector<StageResult>> mode_to_results;
+  for (const auto& mode_and_chunks :
+       std::vector<std::pair<std::string, int64_t>>{
+           {"GPipe", 1}, {"1F1B", 1}, {"Interleaved1F1B", 2}}) {
+    const std::string& mode = mode_and_chunks.first;
+    auto results = RunPipeline(mode, mode_and_chunks.second);
+    for (int64_t rank = 0; rank < kNumStages; ++rank) {
+      EXPECT_TRUE(results[rank].steps_in_order)
+          << mode << " stage " << rank << " ran out of the schedule order";
+    }
+    mode_to_results[mode] = results;
+  }
+
+  for (int64_t rank = 0; rank < kNumStages; ++rank) {
+    EXPECT_EQ(mode_to_results["GPipe"][rank].peak_in_flight,
+              kNumMicroBatches);
+    EXPECT_EQ(mode_to_results["GPipe"][rank].peak_bytes,
+              kNumMicroBatches * kActivationBytes);
+    EXPECT_EQ(mode_to_results["1F1B"][rank].peak_in_flight, kNumStages - rank);
+    EXPECT_EQ(mode_to_results["1F1B"][rank].peak_bytes,
+              (kNumStages - rank) * kActivationBytes);
+    EXPECT_LT(mode_to_results["Interleaved1F1B"][rank].peak_bytes,
+              mode_to_results["GPipe"][rank].peak_bytes);
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,203 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/fleet_executor/pipeline_schedule.h"
+
+namespace paddle {
+namespace distributed {
+
+std::string StepsString(const std::vector<PipelineStep>& steps) {
+  std::string str;
+  for (const auto& step : steps) {
+    if (!str.empty()) {
+      str += " ";
+    }
+    str += step.pass == PipelinePass::FORWARD ? "F" : "B";
+    str += std::to_string(step.micro_batch);
+    if (step.chunk > 0) {
+      str += "." + std::to_string(step.chunk);
+    }
+  }
+  return str;
+}
+
+TEST(PipelineSchedule, Steps) {
+  EXPECT_EQ(StepsString(PipelineSchedule::BuildSteps("GPipe", 4, 1, 4, 1)),
+            "F0 F1 F2 F3 B0 B1 B2 B3");
+  EXPECT_EQ(StepsString(PipelineSchedule::BuildSteps("1F1B", 4, 0, 6, 1)),
+            "F0 F1 F2 F3 B0 F4 B1 F5 B2 B3 B4 B5");
+  EXPECT_EQ(StepsString(PipelineSchedule::BuildSteps("1F1B", 4, 3, 6, 1)),
+            "F0 B0 F1 B1 F2 B2 F3 B3 F4 B4 F5 B5");
+  // Fewer micro batches than stages.
+  EXPECT_EQ(StepsString(PipelineSchedule::BuildSteps("1F1B", 4, 0, 2, 1)),
+            "F0 F1 B0 B1");
+  // The two chunks of a stage take the micro batches two at a time.
+  EXPECT_EQ(
+      StepsString(PipelineSchedule::BuildSteps("Interleaved1F1B", 2, 0, 4, 2)),
+      "F0 F1 F0.1 F1.1 F2 B0.1 F3 B1.1 F2.1 B0 F3.1 B1 B2.1 B3.1 B2 B3");
+  EXPECT_EQ(
+      StepsString(PipelineSchedule::BuildSteps("Interleaved1F1B", 2, 1, 4, 2)),
+      "F0 F1 F0.1 B0.1 F1.1 B1.1 F2 B0 F3 B1 F2.1 B2.1 F3.1 B3.1 B2 B3");
+
+  EXPECT_ANY_THROW(PipelineSchedule::BuildSteps("Interleaved1F1B", 4, 0, 6, 2));
+  EXPECT_ANY_THROW(PipelineSchedule::BuildSteps("1F1B", 4, 0, 8, 2));
+  EXPECT_ANY_THROW(PipelineSchedule::BuildSteps("1F1B", 4, 4, 8, 1));
+  EXPECT_ANY_THROW(PipelineSchedule::BuildSteps("FThenB", 4, 0, 8, 1));
+}
+
+TEST(PipelineSchedule, Run) {
+  PipelineScheduleDesc desc;
+  desc.set_mode("1F1B");
+  desc.set_num_stages(3);
+  desc.set_stage(0);
+  PipelineSchedule schedule(desc, 4);
+  schedule.RegisterInterceptor(PipelinePass::FORWARD, 0, 10);
+  schedule.RegisterInterceptor(PipelinePass::BACKWARD, 0, 11);
+  EXPECT_ANY_THROW(schedule.RegisterInterceptor(PipelinePass::FORWARD, 0, 12));
+
+  // F0 F1 F2 B0 F3 B1 B2 B3, twice.
+  for (int run = 0; run < 2; ++run) {
+    std::vector<int64_t> next_ids;
+    for (const auto& step : schedule.steps()) {
+      EXPECT_EQ(schedule.NextMicroBatch(step.pass, 0), step.micro_batch);
+      PipelinePass other = step.pass == PipelinePass::FORWARD
+                               ? PipelinePass::BACKWARD
+                               : PipelinePass::FORWARD;
+      EXPECT_EQ(schedule.NextMicroBatch(other, 0), -1);
+      schedule.BeginStep();
+      next_ids.push_back(schedule.EndStep());
+    }
+    EXPECT_EQ(next_ids,
+              std::vector<int64_t>({10, 10, 11, 10, 11, 11, 11, -1}));
+  }
+  EXPECT_EQ(schedule.peak_in_flight(), 3);
+  std::string trace = schedule.TraceJson();
+  EXPECT_NE(trace.find("\"name\":\"F3\""), std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"B3\""), std::string::npos);
+}
+
+struct SimulatedRun {
+  double makespan;
+  // the time a stage waits, and its share of the makespan
+  double idle;
+  double bubble;
+  // the most activations a stage holds, in those of one stage for one micro
+  // batch
+  std::vector<double> peak_activations;
+};
+
+// Runs the steps of every stage as soon as their inputs are there, a forward
+// step of a model chunk taking 1 / num_chunks and a backward one twice that.
+// Chunk c of stage s is the stage c * num_stages + s of the model.
+SimulatedRun Simulate(const std::string& mode,
+                      int64_t num_stages,
+                      int64_t num_micro_batches,
+                      int64_t num_chunks) {
+  const int64_t num_model_stages = num_stages * num_chunks;
+  const double forward_cost = 1.0 / num_chunks;
+  const double backward_cost = 2.0 / num_chunks;
+
+  std::vector<std::vector<PipelineStep>> steps;
+  for (int64_t s = 0; s < num_stages; ++s) {
+    steps.push_back(PipelineSchedule::BuildSteps(
+        mode, num_stages, s, num_micro_batches, num_chunks));
+  }
+  // (pass, model stage, micro batch) -> finish time
+  std::map<std::tuple<PipelinePass, int64_t, int64_t>, double> finish;
+  std::vector<size_t> next(num_stages, 0);
+  std::vector<double> clock(num_stages, 0.0);
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (int64_t s = 0; s < num_stages; ++s) {
+      while (next[s] < steps[s].size()) {
+        const PipelineStep& step = steps[s][next[s]];
+        int64_t model_stage = step.chunk * num_stages + s;
+        auto dep = std::make_tuple(step.pass, model_stage, step.micro_batch);
+        if (step.pass == PipelinePass::FORWARD) {
+          std::get<1>(dep) = model_stage - 1;
+        } else if (model_stage + 1 < num_model_stages) {
+          std::get<1>(dep) = model_stage + 1;
+        } else {
+          dep = std::make_tuple(
+              PipelinePass::FORWARD, model_stage, step.micro_batch);
+        }
+        double ready = 0.0;
+        if (std::get<1>(dep) >= 0) {
+          auto iter = finish.find(dep);
+          if (iter == finish.end()) {
+            break;
+          }
+          ready = iter->second;
+        }
+        double cost = step.pass == PipelinePass::FORWARD ? forward_cost
+                                                         : backward_cost;
+        clock[s] = std::max(clock[s], ready) + cost;
+        finish[std::make_tuple(step.pass, model_stage, step.micro_batch)] =
+            clock[s];
+        ++next[s];
+        progress = true;
+      }
+    }
+  }
+
+  SimulatedRun run;
+  run.makespan = *std::max_element(clock.begin(), clock.end());
+  for (int64_t s = 0; s < num_stages; ++s) {
+    EXPECT_EQ(next[s], steps[s].size())
+        << mode << " deadlocks at stage " << s;
+    int64_t in_flight = 0, peak = 0;
+    for (const auto& step : steps[s]) {
+      in_flight += step.pass == PipelinePass::FORWARD ? 1 : -1;
+      peak = std::max(peak, in_flight);
+    }
+    run.peak_activations.push_back(static_cast<double>(peak) / num_chunks);
+  }
+  run.idle = run.makespan - 3.0 * num_micro_batches;
+  run.bubble = run.idle / run.makespan;
+  return run;
+}
+
+TEST(PipelineSchedule, Simulation) {
+  const int64_t kStages = 4;
+  for (int64_t num_micro_batches : {4, 8, 16}) {
+    SimulatedRun gpipe = Simulate("GPipe", kStages, num_micro_batches, 1);
+    SimulatedRun one_f_one_b = Simulate("1F1B", kStages, num_micro_batches, 1);
+    SimulatedRun interleaved =
+        Simulate("Interleaved1F1B", kStages, num_micro_batches, 2);
+    // 1F1B takes as long as GPipe, holding the activations of at most
+    // num_stages - stage micro batches instead of all of them.
+    EXPECT_DOUBLE_EQ(one_f_one_b.makespan, gpipe.makespan);
+    for (int64_t s = 0; s < kStages; ++s) {
+      EXPECT_EQ(gpipe.peak_activations[s], num_micro_batches);
+      EXPECT_LE(one_f_one_b.peak_activations[s],
+                std::min(kStages - s, num_micro_batches));
+    }
+    // The stages wait for the forward and the backward passes of the
+    // num_stages - 1 others, and two chunks a stage halve that.
+    EXPECT_DOUBLE_EQ(gpipe.idle, (kStages - 1) * 3.0);
+    EXPECT_DOUBLE_EQ(one_f_one_b.idle, (kStages - 1) * 3.0);
+    EXPECT_DOUBLE_EQ(interleaved.idle, (kStages - 1) * 3.0 / 2);
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
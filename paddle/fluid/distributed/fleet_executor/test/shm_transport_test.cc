@@ -0,0 +1,166 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/fleet_executor/shm_transport.h"
+
+namespace paddle {
+namespace distributed {
+
+// The messages a transport received, for the test to wait on.
+class Inbox {
+ public:
+  void Push(const InterceptorMessage& msg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(msg);
+    cv_.notify_one();
+  }
+
+  InterceptorMessage Pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !queue_.empty(); });
+    InterceptorMessage msg = std::move(queue_.front());
+    queue_.pop_front();
+    return msg;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<InterceptorMessage> queue_;
+};
+
+double MicrosecondsSince(std::chrono::steady_clock::time_point begin) {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - begin)
+      .count();
+}
+
+InterceptorMessage DataMessage(int64_t step, size_t bytes) {
+  InterceptorMessage msg;
+  msg.set_src_id(0);
+  msg.set_dst_id(1);
+  msg.set_message_type(DATA_WITH_VARS);
+  msg.set_scope_idx(step);
+  if (bytes > 0) {
+    auto* var = msg.add_vars_list();
+    var->set_name("x");
+    std::string data(bytes, '\0');
+    for (size_t i = 0; i < bytes; ++i) {
+      data[i] = static_cast<char>('a' + (i * 131 + step) % 26);
+    }
+    var->set_stensor(data);
+  }
+  return msg;
+}
+
+TEST(ShmTransportTest, PingPong) {
+  // Rings smaller than the large messages, which go through in parts.
+  const size_t kRingBytes = 64 * 1024;
+  // The names of the rings come from the addresses, unique to this test.
+  const std::string port = std::to_string(getpid());
+  std::unordered_map<int64_t, std::string> rank_to_addr = {
+      {0, "127.0.0.1:" + port + "0"},
+      {1, "127.0.0.1:" + port + "1"},
+      {2, "10.0.0.2:" + port + "2"}};
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    // Rank 1 sends back what it receives until STOP.
+    {
+      Inbox inbox;
+      ShmTransport transport(
+          1, rank_to_addr, kRingBytes, [&](const InterceptorMessage& msg) {
+            inbox.Push(msg);
+          });
+      while (true) {
+        InterceptorMessage msg = inbox.Pop();
+        if (msg.message_type() == STOP) {
+          break;
+        }
+        transport.Send(0, msg);
+      }
+    }
+    _exit(0);
+  }
+
+  Inbox inbox;
+  ShmTransport transport(
+      0, rank_to_addr, kRingBytes, [&](const InterceptorMessage& msg) {
+        inbox.Push(msg);
+      });
+  EXPECT_TRUE(transport.IsLocal(1));
+  EXPECT_FALSE(transport.IsLocal(2));
+
+  // The messages come back whole and in order.
+  for (size_t bytes : {0, 100, 3 * 1024 * 1024 + 7}) {
+    for (int64_t step = 0; step < 3; ++step) {
+      transport.Send(1, DataMessage(step, bytes));
+    }
+    for (int64_t step = 0; step < 3; ++step) {
+      InterceptorMessage msg = inbox.Pop();
+      EXPECT_EQ(msg.SerializeAsString(),
+                DataMessage(step, bytes).SerializeAsString());
+    }
+  }
+
+  const int kRoundTrips = 20000;
+  InterceptorMessage ping = DataMessage(0, 0);
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRoundTrips; ++i) {
+    transport.Send(1, ping);
+    inbox.Pop();
+  }
+  std::cout << "Ping pong through shared memory: "
+            << MicrosecondsSince(begin) / kRoundTrips << " us per round trip"
+            << std::endl;
+
+  for (size_t bytes : {64, 4096, 256 * 1024}) {
+    const int kMessages = bytes > 4096 ? 2000 : 50000;
+    InterceptorMessage msg = DataMessage(0, bytes);
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < kMessages; ++i) {
+      transport.Send(1, msg);
+    }
+    for (int i = 0; i < kMessages; ++i) {
+      inbox.Pop();
+    }
+    const double seconds = MicrosecondsSince(begin) / 1e6;
+    std::cout << "Throughput of messages of " << bytes
+              << " bytes sent back: " << kMessages / seconds
+              << " messages/s, " << kMessages * bytes / seconds / 1e6
+              << " MB/s each way" << std::endl;
+  }
+
+  InterceptorMessage stop;
+  stop.set_message_type(STOP);
+  transport.Send(1, stop);
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+}  // namespace distributed
+}  // namespace paddle
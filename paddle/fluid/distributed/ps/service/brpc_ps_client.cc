@@ -14,11 +14,14 @@
 
 #include "paddle/fluid/distributed/ps/service/brpc_ps_client.h"
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "paddle/fluid/distributed/ps/service/coordinator_client.h"
+#include "paddle/fluid/distributed/ps/service/sparse_wire_format.h"
 #include "paddle/fluid/framework/archive.h"
 #include "paddle/fluid/string/split.h"
 
@@ -78,6 +81,19 @@ DEFINE_int32(pserver_sparse_table_shard_num,
              1000,
              "sparse table shard for save & load");
 
+DEFINE_bool(pserver_sparse_compact_wire_format,
+            false,
+            "send the keys of pull_sparse & push_sparse delta varint encoded "
+            "and the values in the attachment, see sparse_wire_format.h");
+
+DEFINE_int32(pserver_sparse_value_codec,
+             0,
+             "values of the compact sparse wire format, fp32:0 fp16:1 int8:2");
+
+DEFINE_int32(pserver_sparse_value_exact_dim,
+             3,
+             "leading values of a row the fp16 & int8 codecs keep as fp32");
+
 inline size_t get_sparse_shard(uint32_t shard_num,
                                uint32_t server_num,
                                uint64_t key) {
@@ -87,6 +103,87 @@ inline size_t get_sparse_shard(uint32_t shard_num,
   return (key % shard_num) / local_shard_num;
 }
 
+inline SparseWireFormat get_sparse_wire_format() {
+  SparseWireFormat format;
+  format.codec = FLAGS_pserver_sparse_value_codec;
+  format.exact_dim = FLAGS_pserver_sparse_value_exact_dim;
+  return format;
+}
+
+// Hands a buffer of new char[] over to the IOBuf, which deletes it once sent
+// instead of copying it into blocks of its own.
+inline void append_owned_buffer(butil::IOBuf *buf, char *data, size_t size) {
+  buf->append_user_data(
+      data, size, [](void *data) { delete[] static_cast<char *>(data); });
+}
+
+// Appends the keys of kvs, sorted, and their update values to buf in the
+// compact wire format.
+void append_compact_push_sparse(
+    std::vector<std::pair<uint64_t, const float *>> *kvs,
+    size_t value_size,
+    const SparseWireFormat &format,
+    butil::IOBuf *buf) {
+  size_t kv_size = kvs->size();
+  if (kv_size == 0) {
+    return;
+  }
+  std::sort(kvs->begin(),
+            kvs->end(),
+            [](const std::pair<uint64_t, const float *> &k1,
+               const std::pair<uint64_t, const float *> &k2) {
+              return k1.first < k2.first;
+            });
+  std::vector<uint64_t> keys(kv_size);
+  for (size_t i = 0; i < kv_size; ++i) {
+    keys[i] = kvs->at(i).first;
+  }
+  size_t dim = value_size / sizeof(float);
+  size_t encoded_value_size = EncodedValueSize(format, dim);
+  char *buffer =
+      new char[MaxEncodedKeysSize(kv_size) + kv_size * encoded_value_size];
+  size_t size = EncodeSortedKeys(keys.data(), kv_size, buffer);
+  for (size_t i = 0; i < kv_size; ++i) {
+    EncodeValue(format, kvs->at(i).second, dim, buffer + size);
+    size += encoded_value_size;
+  }
+  append_owned_buffer(buf, buffer, size);
+}
+
+// Writes the keys and the update values of a push_sparse request in the
+// wire format the flags choose, sorting them by key for the compact one.
+void serialize_push_sparse(std::vector<std::pair<uint64_t, const float *>> *kvs,
+                           size_t value_size,
+                           PsRequestMessage *request,
+                           brpc::Controller *cntl) {
+  uint32_t kv_size = kvs->size();
+  request->add_params(reinterpret_cast<char *>(&kv_size), sizeof(uint32_t));
+  if (!FLAGS_pserver_sparse_compact_wire_format) {
+    /*
+    Push Content:
+    |---keysData---|---valuesData---|
+    |---8*{num}B---|----------------|
+    */
+    auto *push_data = request->mutable_data();
+    push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
+    char *push_data_ptr = const_cast<char *>(push_data->data());
+    for (size_t i = 0; i < kv_size; ++i) {
+      memcpy(push_data_ptr, &kvs->at(i).first, sizeof(uint64_t));
+      push_data_ptr += sizeof(uint64_t);
+    }
+    for (size_t i = 0; i < kv_size; ++i) {
+      memcpy(push_data_ptr, kvs->at(i).second, value_size);
+      push_data_ptr += value_size;
+    }
+    return;
+  }
+
+  auto format = get_sparse_wire_format();
+  request->add_params(reinterpret_cast<char *>(&format), sizeof(format));
+  append_compact_push_sparse(
+      kvs, value_size, format, &cntl->request_attachment());
+}
+
 void DownpourPsClientService::service(
     ::google::protobuf::RpcController *controller,
     const PsRequestMessage *request,
@@ -1014,10 +1111,8 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
   std::future<int> fut = promise->get_future();
 
   size_t request_call_num = _server_channels.size();
-  std::vector<std::vector<uint64_t>> ids;
-  std::vector<std::vector<const float *>> value_ptrs;
-  ids.resize(request_call_num);
-  value_ptrs.resize(request_call_num);
+  std::vector<std::vector<std::pair<uint64_t, const float *>>> shard_kvs(
+      request_call_num);
 
   const auto &server_param = _config.server_param().downpour_server_param();
   uint64_t shard_num = FLAGS_pserver_sparse_table_shard_num;
@@ -1031,15 +1126,10 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
 
   for (size_t i = 0; i < num; ++i) {
     size_t pserver_idx = get_sparse_shard(shard_num, request_call_num, keys[i]);
-    ids[pserver_idx].push_back(keys[i]);
-    value_ptrs[pserver_idx].push_back(update_values[i]);
+    shard_kvs[pserver_idx].push_back({keys[i], update_values[i]});
   }
 
   for (size_t shard_idx = 0; shard_idx < request_call_num; ++shard_idx) {
-    auto kvs = ids[shard_idx];
-    auto value_ptr = value_ptrs[shard_idx];
-
-    size_t kv_size = kvs.size();
     uint32_t value_size = accessor->GetAccessorInfo().update_size;
 
     // 发送RPC请求
@@ -1047,16 +1137,119 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     push_request->set_cmd_id(PS_PUSH_SPARSE_TABLE);
     push_request->set_table_id(table_id);
     push_request->set_client_id(_client_id);
-    push_request->add_params((char *)&kv_size, sizeof(uint32_t));  // NOLINT
-    auto *push_data = push_request->mutable_data();
-    push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, kvs.data(), kv_size * sizeof(uint64_t));
-    push_data_ptr += kv_size * sizeof(uint64_t);
+    serialize_push_sparse(&shard_kvs[shard_idx],
+                          value_size,
+                          push_request,
+                          closure->cntl(shard_idx));
+    PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
+    closure->cntl(shard_idx)->set_request_compress_type(
+        (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
+    rpc_stub.service(closure->cntl(shard_idx),
+                     closure->request(shard_idx),
+                     closure->response(shard_idx),
+                     closure);
+  }
+  return fut;
+}
 
-    for (size_t i = 0; i < kv_size; ++i) {
-      memcpy(push_data_ptr, value_ptr[i], value_size);
-      push_data_ptr += value_size;
+std::future<int32_t> BrpcPsClient::PushSparseRawGradients(
+    const std::vector<size_t> &table_ids,
+    const std::vector<const uint64_t *> &keys,
+    const std::vector<const float **> &update_values,
+    const std::vector<size_t> &nums) {
+  auto timer = std::make_shared<CostTimer>("pserver_client_push_sparse");
+  size_t request_call_num = _server_channels.size();
+  DownpourBrpcClosure *closure = new DownpourBrpcClosure(
+      request_call_num, [request_call_num](void *done) {
+        int ret = 0;
+        auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
+        for (size_t i = 0; i < request_call_num; ++i) {
+          if (closure->check_response(i, PS_PUSH_SPARSE_TABLES) != 0) {
+            ret = -1;
+            break;
+          }
+        }
+        closure->set_promise_value(ret);
+      });
+  closure->add_timer(timer);
+  auto promise = std::make_shared<std::promise<int32_t>>();
+  closure->add_promise(promise);
+  std::future<int> fut = promise->get_future();
+
+  for (size_t shard_idx = 0; shard_idx < request_call_num; ++shard_idx) {
+    auto *push_request = closure->request(shard_idx);
+    push_request->set_cmd_id(PS_PUSH_SPARSE_TABLES);
+    push_request->set_table_id(table_ids.empty() ? 0 : table_ids[0]);
+    push_request->set_client_id(_client_id);
+  }
+
+  // The compact wire format puts the sections in the attachment, unpadded,
+  // and adds the SparseWireFormat as the last param.
+  bool compact = FLAGS_pserver_sparse_compact_wire_format;
+  SparseWireFormat format = get_sparse_wire_format();
+  const auto &server_param = _config.server_param().downpour_server_param();
+  std::vector<std::vector<std::pair<uint64_t, const float *>>> shard_kvs(
+      request_call_num);
+  for (size_t t = 0; t < table_ids.size(); ++t) {
+    uint64_t shard_num = FLAGS_pserver_sparse_table_shard_num;
+    for (int i = 0; i < server_param.downpour_table_param_size(); ++i) {
+      const auto &table_param = server_param.downpour_table_param(i);
+      if (table_param.table_id() == table_ids[t]) {
+        shard_num = table_param.shard_num();
+        break;
+      }
+    }
+    for (auto &kvs : shard_kvs) {
+      kvs.clear();
+    }
+    for (size_t i = 0; i < nums[t]; ++i) {
+      size_t pserver_idx =
+          get_sparse_shard(shard_num, request_call_num, keys[t][i]);
+      shard_kvs[pserver_idx].push_back({keys[t][i], update_values[t][i]});
+    }
+
+    // Appends the section of the table, padded to 8 bytes for the keys of
+    // the next one.
+    size_t value_size = GetTableAccessor(table_ids[t])
+                            ->GetAccessorInfo()
+                            .update_size;
+    for (size_t shard_idx = 0; shard_idx < request_call_num; ++shard_idx) {
+      auto &kvs = shard_kvs[shard_idx];
+      uint32_t table_id = table_ids[t];
+      uint32_t kv_size = kvs.size();
+      auto *push_request = closure->request(shard_idx);
+      push_request->add_params(reinterpret_cast<char *>(&table_id),
+                               sizeof(uint32_t));
+      push_request->add_params(reinterpret_cast<char *>(&kv_size),
+                               sizeof(uint32_t));
+      if (compact) {
+        append_compact_push_sparse(
+            &kvs,
+            value_size,
+            format,
+            &closure->cntl(shard_idx)->request_attachment());
+        continue;
+      }
+      auto *push_data = push_request->mutable_data();
+      size_t offset = push_data->size();
+      size_t section_size = kv_size * (sizeof(uint64_t) + value_size);
+      push_data->resize(offset + (section_size + 7) / 8 * 8);
+      char *push_data_ptr = const_cast<char *>(push_data->data()) + offset;
+      for (size_t i = 0; i < kv_size; ++i) {
+        memcpy(push_data_ptr, &kvs[i].first, sizeof(uint64_t));
+        push_data_ptr += sizeof(uint64_t);
+      }
+      for (size_t i = 0; i < kv_size; ++i) {
+        memcpy(push_data_ptr, kvs[i].second, value_size);
+        push_data_ptr += value_size;
+      }
+    }
+  }
+
+  for (size_t shard_idx = 0; shard_idx < request_call_num; ++shard_idx) {
+    if (compact) {
+      closure->request(shard_idx)->add_params(
+          reinterpret_cast<char *>(&format), sizeof(format));
     }
     PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
     closure->cntl(shard_idx)->set_request_compress_type(
@@ -1164,11 +1357,21 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
   auto *accessor = GetTableAccessor(table_id);
 
   size_t value_size = accessor->GetAccessorInfo().select_size;
+  // The plain format answers with fp32 values as the compact one does with
+  // the fp32 codec.
+  bool compact = FLAGS_pserver_sparse_compact_wire_format;
+  SparseWireFormat format = get_sparse_wire_format();
+  if (!compact) {
+    format.codec = kSparseValueFp32;
+  }
 
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
-      request_call_num, [shard_sorted_kvs, value_size](void *done) {
+      request_call_num, [shard_sorted_kvs, value_size, format](void *done) {
         int ret = 0;
         auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
+        size_t dim = value_size / sizeof(float);
+        size_t encoded_value_size = EncodedValueSize(format, dim);
+        std::vector<char> encoded_value(encoded_value_size);
         for (size_t i = 0; i < shard_sorted_kvs->size(); ++i) {
           if (closure->check_response(i, PS_PULL_SPARSE_TABLE) != 0) {
             ret = -1;
@@ -1187,16 +1390,23 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
               memcpy(reinterpret_cast<void *>(kv_pair->second),
                      reinterpret_cast<void *>(last_value_data),
                      value_size);
-            } else {
-              last_key = kv_pair->first;
-              last_value_data = kv_pair->second;
-              if (value_size !=
-                  io_buffer_itr.copy_and_forward(
-                      reinterpret_cast<void *>(last_value_data), value_size)) {
-                LOG(WARNING) << "res data is lack or not in format";
-                ret = -1;
-                break;
-              }
+              continue;
+            }
+            last_key = kv_pair->first;
+            last_value_data = kv_pair->second;
+            // fp32 values go straight to the caller, the others through a
+            // row of their own
+            void *dst = format.codec == kSparseValueFp32
+                            ? reinterpret_cast<void *>(last_value_data)
+                            : reinterpret_cast<void *>(encoded_value.data());
+            if (encoded_value_size !=
+                io_buffer_itr.copy_and_forward(dst, encoded_value_size)) {
+              LOG(WARNING) << "res data is lack or not in format";
+              ret = -1;
+              break;
+            }
+            if (format.codec != kSparseValueFp32) {
+              DecodeValue(format, encoded_value.data(), dim, last_value_data);
             }
           }
         }
@@ -1216,21 +1426,20 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
                 return k1.first < k2.first;
               });
 
-    uint64_t last_key = UINT64_MAX;
     uint32_t kv_request_count = 0;
     size_t sorted_kv_size = sorted_kvs.size();
     auto &request_buffer = closure->cntl(i)->request_attachment();
 
-    request_buffer.append(reinterpret_cast<void *>(&is_training), sizeof(bool));
+    std::vector<uint64_t> unique_keys;
     std::vector<uint32_t> keys_counter;
+    unique_keys.reserve(sorted_kv_size);
     keys_counter.reserve(sorted_kv_size);
 
     for (size_t kv_idx = 0; kv_idx < sorted_kv_size; ++kv_idx) {
       ++kv_request_count;
       uint32_t keys = 1;
-      last_key = sorted_kvs[kv_idx].first;
-      request_buffer.append(reinterpret_cast<void *>(&last_key),
-                            sizeof(uint64_t));
+      uint64_t last_key = sorted_kvs[kv_idx].first;
+      unique_keys.push_back(last_key);
       while (kv_idx < sorted_kv_size - 1 &&
              last_key == sorted_kvs[kv_idx + 1].first) {
         ++kv_idx;
@@ -1239,8 +1448,24 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
       keys_counter.push_back(keys);
     }
 
-    request_buffer.append(reinterpret_cast<void *>(keys_counter.data()),
-                          sizeof(uint32_t) * keys_counter.size());
+    if (compact) {
+      char *buffer =
+          new char[sizeof(bool) + 2 * MaxEncodedKeysSize(kv_request_count)];
+      buffer[0] = is_training;
+      size_t size = sizeof(bool);
+      size += EncodeSortedKeys(
+          unique_keys.data(), kv_request_count, buffer + size);
+      size +=
+          EncodeVarints(keys_counter.data(), kv_request_count, buffer + size);
+      append_owned_buffer(&request_buffer, buffer, size);
+    } else {
+      request_buffer.append(reinterpret_cast<void *>(&is_training),
+                            sizeof(bool));
+      request_buffer.append(reinterpret_cast<void *>(unique_keys.data()),
+                            sizeof(uint64_t) * unique_keys.size());
+      request_buffer.append(reinterpret_cast<void *>(keys_counter.data()),
+                            sizeof(uint32_t) * keys_counter.size());
+    }
 
     if (kv_request_count == 0) {
       closure->Run();
@@ -1250,6 +1475,10 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
       closure->request(i)->set_client_id(_client_id);
       closure->request(i)->add_params((char *)&kv_request_count,  // NOLINT
                                       sizeof(uint32_t));
+      if (compact) {
+        closure->request(i)->add_params(reinterpret_cast<char *>(&format),
+                                        sizeof(format));
+      }
       PsService_Stub rpc_stub(GetCmdChannel(i));
       closure->cntl(i)->set_log_id(butil::gettimeofday_ms());
       rpc_stub.service(
@@ -1855,24 +2084,15 @@ int BrpcPsClient::PushSparseAsyncShardPush(
   push_request->set_cmd_id(PS_PUSH_SPARSE_TABLE);
   push_request->set_table_id(table_id);
   push_request->set_client_id(_client_id);
-  push_request->add_params(reinterpret_cast<char *>(&merged_kv_count),
-                           sizeof(uint32_t));  // NOLINT
-  auto *push_data = push_request->mutable_data();
   int update_size = accessor->GetAccessorInfo().update_size;
-  push_data->resize(merged_kv_count * (sizeof(uint64_t) + update_size));
-  char *push_data_ptr = const_cast<char *>(push_data->data());
-  memcpy(push_data_ptr,
-         merged_key_list.data(),
-         merged_kv_count * sizeof(uint64_t));
-  push_data_ptr += merged_kv_count * sizeof(uint64_t);
+  std::vector<std::pair<uint64_t, const float *>> merged_kvs(merged_kv_count);
   for (size_t i = 0; i < merged_kv_count; ++i) {
-    const char *task_data_ptr = merged_value_list[i].data();
-
-    memcpy(push_data_ptr,
-           (float *)(task_data_ptr),  // NOLINT
-           update_size);
-    push_data_ptr += update_size;
+    merged_kvs[i] = {
+        merged_key_list[i],
+        reinterpret_cast<const float *>(merged_value_list[i].data())};
   }
+  serialize_push_sparse(
+      &merged_kvs, update_size, push_request, closure->cntl(shard_idx));
   PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
   closure->cntl(shard_idx)->set_request_compress_type(
       (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
@@ -397,6 +397,12 @@ class BrpcPsClient : public PSClient {
                                              size_t num,
                                              void *done) override;
 
+  std::future<int32_t> PushSparseRawGradients(
+      const std::vector<size_t> &table_ids,
+      const std::vector<const uint64_t *> &keys,
+      const std::vector<const float **> &update_values,
+      const std::vector<size_t> &nums) override;
+
   std::future<int32_t> PushSparseRawGradientPartial(size_t table_id,
                                                     const uint64_t *keys,
                                                     const float **update_values,
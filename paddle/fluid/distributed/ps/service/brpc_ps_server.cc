@@ -18,6 +18,7 @@
 
 #include "butil/object_pool.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
+#include "paddle/fluid/distributed/ps/service/sparse_wire_format.h"
 #include "paddle/fluid/distributed/ps/table/depends/sparse_utils.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/framework/archive.h"
@@ -193,6 +194,8 @@ int32_t BrpcPsService::Initialize() {
   _service_handler_map[PS_PUSH_DENSE_TABLE] = &BrpcPsService::PushDense;
   _service_handler_map[PS_PULL_SPARSE_TABLE] = &BrpcPsService::PullSparse;
   _service_handler_map[PS_PUSH_SPARSE_TABLE] = &BrpcPsService::PushSparse;
+  _service_handler_map[PS_PUSH_SPARSE_TABLES] =
+      &BrpcPsService::PushSparseTables;
   _service_handler_map[PS_SAVE_ONE_TABLE] = &BrpcPsService::SaveOneTable;
   _service_handler_map[PS_SAVE_ALL_TABLE] = &BrpcPsService::SaveAllTable;
   _service_handler_map[PS_SHRINK_TABLE] = &BrpcPsService::ShrinkTable;
@@ -224,6 +227,7 @@ int32_t BrpcPsService::Initialize() {
   profiler.register_profiler("pserver_server_push_dense");
   profiler.register_profiler("pserver_server_pull_sparse");
   profiler.register_profiler("pserver_server_push_sparse");
+  profiler.register_profiler("pserver_server_push_sparse_tables");
 
   // shard初始化,server启动后才可从env获取到server_list的shard信息
   InitializeShardInfo();
@@ -524,6 +528,10 @@ int32_t BrpcPsService::PullSparse(Table *table,
       *(reinterpret_cast<const uint32_t *>(request.params(0).c_str()));
   auto dim = table->ValueAccesor()->GetAccessorInfo().select_dim;
 
+  if (request.params_size() > 1) {
+    return PullSparseCompact(table, request, response, cntl, num, dim);
+  }
+
   thread_local std::string req_buffer;
   req_buffer.reserve(req_buffer_size);
 
@@ -557,7 +565,7 @@ int32_t BrpcPsService::PushSparse(Table *table,
       "PsService->PushSparse", platform::TracerEventType::Communication, 1);
   CHECK_TABLE_EXIST(table, request, response)
   auto &push_data = request.data();
-  if (push_data.size() < 1) {
+  if (push_data.size() < 1 && cntl->request_attachment().size() < 1) {
     // set_response_code(response, 0, "push sparse data is empty");
     return 0;
   }
@@ -571,6 +579,9 @@ int32_t BrpcPsService::PushSparse(Table *table,
   CostTimer timer("pserver_server_push_sparse");
   const uint32_t num =
       *(reinterpret_cast<const uint32_t *>(request.params(0).c_str()));
+  if (request.params_size() > 1) {
+    return PushSparseCompact(table, request, response, cntl, num);
+  }
   /*
   Push Content:
   |---keysData---|---valuesData---|
@@ -592,6 +603,249 @@ int32_t BrpcPsService::PushSparse(Table *table,
   return 0;
 }
 
+// Decodes the num keys and the update values of dim floats of a compact
+// push_sparse section. Returns the bytes read, 0 if the section is not in
+// format or empty.
+static size_t DecodeCompactPushSparse(const SparseWireFormat &format,
+                                      const char *data,
+                                      size_t size,
+                                      uint32_t num,
+                                      size_t dim,
+                                      std::vector<uint64_t> *keys,
+                                      std::vector<float> *values) {
+  keys->resize(num);
+  values->resize(num * dim);
+  size_t offset = DecodeSortedKeys(data, size, num, keys->data());
+  size_t encoded_value_size = EncodedValueSize(format, dim);
+  if (offset == 0 || size - offset < num * encoded_value_size) {
+    return 0;
+  }
+  for (size_t i = 0; i < num; ++i) {
+    DecodeValue(format,
+                data + offset + i * encoded_value_size,
+                dim,
+                values->data() + i * dim);
+  }
+  return offset + num * encoded_value_size;
+}
+
+int32_t BrpcPsService::PushSparseTables(Table *table,
+                                        const PsRequestMessage &request,
+                                        PsResponseMessage &response,
+                                        brpc::Controller *cntl) {
+  platform::RecordEvent record_event("PsService->PushSparseTables",
+                                     platform::TracerEventType::Communication,
+                                     1);
+  CHECK_TABLE_EXIST(table, request, response)
+  // The params are pairs of table_id and num of sparse_key, and in the
+  // compact wire format a SparseWireFormat last.
+  const bool compact = request.params_size() % 2 != 0;
+  const int num_params = request.params_size() - (compact ? 1 : 0);
+  SparseWireFormat format;
+  if (compact) {
+    if (request.params(num_params).size() != sizeof(SparseWireFormat)) {
+      set_response_code(response, -1, "sparse wire format is invalid");
+      return 0;
+    }
+    memcpy(&format, request.params(num_params).data(), sizeof(format));
+  }
+  CostTimer timer("pserver_server_push_sparse_tables");
+  /*
+  Push Content, a section a table padded to 8 bytes:
+  |---keysData---|---valuesData---|---keysData---|---valuesData---|...
+  |---8*{num}B---|----------------|---8*{num}B---|----------------|...
+  or in the attachment, in the compact wire format:
+  |---varint key deltas---|---encoded values---|---varint key deltas---|...
+  */
+  auto &push_data = request.data();
+  thread_local std::string req_buffer;
+  thread_local std::vector<uint64_t> keys;
+  thread_local std::vector<float> values;
+  if (compact) {
+    req_buffer.resize(cntl->request_attachment().size());
+    cntl->request_attachment().copy_to(&req_buffer[0], req_buffer.size());
+  }
+  size_t offset = 0;
+  for (int i = 0; i < num_params; i += 2) {
+    const uint32_t table_id =
+        *(reinterpret_cast<const uint32_t *>(request.params(i).c_str()));
+    const uint32_t num =
+        *(reinterpret_cast<const uint32_t *>(request.params(i + 1).c_str()));
+    auto *section_table = _server->GetTable(table_id);
+    if (section_table == NULL) {
+      std::string err_msg("table not found with table_id:");
+      err_msg.append(std::to_string(table_id));
+      set_response_code(response, -1, err_msg.c_str());
+      return 0;
+    }
+    size_t update_size =
+        section_table->ValueAccesor()->GetAccessorInfo().update_size;
+    if (compact) {
+      if (num == 0) {
+        continue;
+      }
+      size_t read = DecodeCompactPushSparse(format,
+                                            req_buffer.data() + offset,
+                                            req_buffer.size() - offset,
+                                            num,
+                                            update_size / sizeof(float),
+                                            &keys,
+                                            &values);
+      if (read == 0) {
+        set_response_code(response, -1, "push sparse data is not in format");
+        return 0;
+      }
+      TableContext table_context;
+      table_context.value_type = Sparse;
+      table_context.push_context.keys = keys.data();
+      table_context.push_context.values = values.data();
+      table_context.num = num;
+      if (section_table->Push(table_context) != 0) {
+        set_response_code(response, -1, "PushSparseTables error");
+        return 0;
+      }
+      offset += read;
+      continue;
+    }
+    size_t section_size = num * (sizeof(uint64_t) + update_size);
+    if (offset + section_size > push_data.size()) {
+      set_response_code(response, -1, "push sparse data is not in format");
+      return 0;
+    }
+    TableContext table_context;
+    table_context.value_type = Sparse;
+    table_context.push_context.keys =
+        reinterpret_cast<const uint64_t *>(push_data.data() + offset);
+    table_context.push_context.values = reinterpret_cast<const float *>(
+        push_data.data() + offset + sizeof(uint64_t) * num);
+    table_context.num = num;
+    if (section_table->Push(table_context) != 0) {
+      set_response_code(response, -1, "PushSparseTables error");
+      return 0;
+    }
+    offset += (section_size + 7) / 8 * 8;
+  }
+  return 0;
+}
+
+int32_t BrpcPsService::PullSparseCompact(Table *table,
+                                         const PsRequestMessage &request,
+                                         PsResponseMessage &response,
+                                         brpc::Controller *cntl,
+                                         uint32_t num,
+                                         size_t dim) {
+  if (request.params(1).size() != sizeof(SparseWireFormat)) {
+    set_response_code(response, -1, "sparse wire format is invalid");
+    return 0;
+  }
+  SparseWireFormat format;
+  memcpy(&format, request.params(1).data(), sizeof(SparseWireFormat));
+
+  /*
+  Pull Content:
+  |---isTraining---|---varint key deltas---|---varint frequencies---|
+  */
+  thread_local std::string req_buffer;
+  thread_local std::vector<uint64_t> keys;
+  thread_local std::vector<uint32_t> frequencies;
+  if (cntl->request_attachment().size() < sizeof(bool)) {
+    set_response_code(response, -1, "pull sparse keys are not in format");
+    return 0;
+  }
+  req_buffer.resize(cntl->request_attachment().size());
+  cntl->request_attachment().copy_to(&req_buffer[0], req_buffer.size());
+  keys.resize(num);
+  frequencies.resize(num);
+  size_t offset = sizeof(bool);
+  size_t read = DecodeSortedKeys(req_buffer.data() + offset,
+                                 req_buffer.size() - offset,
+                                 num,
+                                 keys.data());
+  offset += read;
+  if (read == 0 || DecodeVarints(req_buffer.data() + offset,
+                                 req_buffer.size() - offset,
+                                 num,
+                                 frequencies.data()) == 0) {
+    set_response_code(response, -1, "pull sparse keys are not in format");
+    return 0;
+  }
+
+  PullSparseValue value(keys, frequencies, dim);
+  value.is_training_ = req_buffer[0];
+
+  // The response goes to the IOBuf without a copy, fp32 values being
+  // pulled straight into it.
+  size_t encoded_value_size = EncodedValueSize(format, dim);
+  char *res_data = new char[num * encoded_value_size];
+  std::vector<float> *pull_values = nullptr;
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = value;
+  if (format.codec == kSparseValueFp32) {
+    table_context.pull_context.values = reinterpret_cast<float *>(res_data);
+  } else {
+    pull_values = butil::get_object<std::vector<float>>();
+    pull_values->resize(num * dim);
+    table_context.pull_context.values = pull_values->data();
+  }
+  table->Pull(table_context);
+  if (pull_values != nullptr) {
+    for (size_t i = 0; i < num; ++i) {
+      EncodeValue(format,
+                  pull_values->data() + i * dim,
+                  dim,
+                  res_data + i * encoded_value_size);
+    }
+    butil::return_object(pull_values);
+  }
+  cntl->response_attachment().append_user_data(
+      res_data, num * encoded_value_size, [](void *data) {
+        delete[] static_cast<char *>(data);
+      });
+  return 0;
+}
+
+int32_t BrpcPsService::PushSparseCompact(Table *table,
+                                         const PsRequestMessage &request,
+                                         PsResponseMessage &response,
+                                         brpc::Controller *cntl,
+                                         uint32_t num) {
+  if (request.params(1).size() != sizeof(SparseWireFormat)) {
+    set_response_code(response, -1, "sparse wire format is invalid");
+    return 0;
+  }
+  SparseWireFormat format;
+  memcpy(&format, request.params(1).data(), sizeof(SparseWireFormat));
+  auto update_size = table->ValueAccesor()->GetAccessorInfo().update_size;
+  size_t dim = update_size / sizeof(float);
+
+  /*
+  Push Content:
+  |---varint key deltas---|---encoded values---|
+  */
+  thread_local std::string req_buffer;
+  thread_local std::vector<uint64_t> keys;
+  thread_local std::vector<float> values;
+  req_buffer.resize(cntl->request_attachment().size());
+  cntl->request_attachment().copy_to(&req_buffer[0], req_buffer.size());
+  size_t read = DecodeCompactPushSparse(
+      format, req_buffer.data(), req_buffer.size(), num, dim, &keys, &values);
+  if (read == 0 || read != req_buffer.size()) {
+    set_response_code(response, -1, "push sparse data is not in format");
+    return 0;
+  }
+
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.push_context.keys = keys.data();
+  table_context.push_context.values = values.data();
+  table_context.num = num;
+  if (table->Push(table_context) != 0) {
+    set_response_code(response, -1, "PushSparse error");
+  }
+  return 0;
+}
+
 int32_t BrpcPsService::PrintTableStat(Table *table,
                                       const PsRequestMessage &request,
                                       PsResponseMessage &response,
@@ -121,6 +121,25 @@ class BrpcPsService : public PsBaseService {
                      const PsRequestMessage &request,
                      PsResponseMessage &response,  // NOLINT
                      brpc::Controller *cntl);
+  // push_sparse of several tables, params holding the table_id and the num
+  // of sparse_key of each.
+  int32_t PushSparseTables(Table *table,
+                           const PsRequestMessage &request,
+                           PsResponseMessage &response,  // NOLINT
+                           brpc::Controller *cntl);
+  // PullSparse & PushSparse in the compact wire format, params(1) holding
+  // the SparseWireFormat.
+  int32_t PullSparseCompact(Table *table,
+                            const PsRequestMessage &request,
+                            PsResponseMessage &response,  // NOLINT
+                            brpc::Controller *cntl,
+                            uint32_t num,
+                            size_t dim);
+  int32_t PushSparseCompact(Table *table,
+                            const PsRequestMessage &request,
+                            PsResponseMessage &response,  // NOLINT
+                            brpc::Controller *cntl,
+                            uint32_t num);
   int32_t LoadOneTable(Table *table,
                        const PsRequestMessage &request,
                        PsResponseMessage &response,  // NOLINT
@@ -489,6 +489,9 @@ void AsyncCommunicator::RecvNoBarrier() {
 }
 
 void AsyncCommunicator::SendByCommunicator() {
+  std::call_once(first_send_flag_, [this] {
+    first_send_begin_ = std::chrono::steady_clock::now();
+  });
   std::vector<std::future<void>> tasks;
   tasks.reserve(send_varname_to_ctx_.size());
 
@@ -524,6 +527,8 @@ void AsyncCommunicator::SendByCommunicator() {
         }
       }
       if (merged_var_num == 0) return;
+      send_num_.fetch_add(1, std::memory_order_relaxed);
+      merged_grad_num_.fetch_add(merged_var_num, std::memory_order_relaxed);
 
       for (size_t i = 0; i < var_nums; i++) {
         auto &var_name = varnames[i];
@@ -563,6 +568,167 @@ void AsyncCommunicator::SendByCommunicator() {
   return;
 }
 
+void AsyncCommunicator::SendByCommunicatorAdaptive() {
+  auto send_begin = std::chrono::steady_clock::now();
+  std::call_once(first_send_flag_, [this, send_begin] {
+    first_send_begin_ = send_begin;
+    last_send_begin_ = send_begin;
+  });
+  std::vector<std::future<void>> tasks;
+  tasks.reserve(send_varname_to_ctx_.size());
+
+  for (auto &iter : send_varname_to_ctx_) {
+    auto &ctx = iter.second;
+
+    auto send_recv_task = [this, &ctx] {
+      auto &varnames = ctx.origin_varnames;
+      auto &table_id = ctx.table_id;
+      size_t var_nums = varnames.size();
+      auto &check_queue = send_varname_to_queue_[varnames[0]];
+      auto &controller = merge_controllers_.at(varnames[0]);
+      size_t merge_target = controller.MergeTarget(check_queue->Size());
+      auto deadline = std::chrono::steady_clock::now() +
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::duration<double>(
+                              controller.WaitSeconds()));
+      std::vector<std::vector<std::shared_ptr<Variable>>> vars;
+      vars.resize(var_nums);
+      size_t merged_var_num = 0;
+      while (merged_var_num < merge_target) {
+        if (check_queue->Size() == 0) {
+          if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          continue;
+        }
+        if (ctx.is_sparse) {
+          auto var = send_varname_to_queue_[varnames[0]]->Pop();
+          sparse_grad_mergers_.at(varnames[0]).Add(
+              var->Get<phi::SelectedRows>());
+        } else {
+          for (size_t i = 0; i < var_nums; i++) {
+            auto &var_name = varnames[i];
+            auto &var_queue = send_varname_to_queue_[var_name];
+            vars[i].push_back(var_queue->Pop());
+          }
+        }
+        merged_var_num++;
+      }
+      merged_var_nums_.at(varnames[0]) = merged_var_num;
+      if (merged_var_num == 0 || ctx.is_sparse) return;
+
+      for (size_t i = 0; i < var_nums; i++) {
+        auto &var_name = varnames[i];
+        if (var_name == STEP_COUNTER) {
+          MergeVars<int64_t>(var_name, vars[i], send_scope_.get(), 1);
+        } else {
+          MergeVars<float>(var_name, vars[i], send_scope_.get(), 1);
+        }
+      }
+
+      auto rpc_begin = std::chrono::steady_clock::now();
+      if (ctx.is_tensor_table) {
+        SendGlobalStep(ctx, merged_var_num, send_scope_.get());
+      } else {
+        RpcSendDense(ctx, *send_scope_);
+        if (!independent_recv_ &&
+            recv_varname_to_ctx_.find(table_id) != recv_varname_to_ctx_.end()) {
+          auto recv_varnames = recv_varname_to_ctx_.at(table_id);
+          RpcRecvDense(recv_varnames, table_id, recv_scope_);
+        }
+      }
+      std::chrono::duration<double> rtt =
+          std::chrono::steady_clock::now() - rpc_begin;
+      std::chrono::duration<double> interval = rpc_begin - last_send_begin_;
+      controller.OnSend(merged_var_num, interval.count(), rtt.count());
+      send_num_.fetch_add(1, std::memory_order_relaxed);
+      merged_grad_num_.fetch_add(merged_var_num, std::memory_order_relaxed);
+      if (independent_recv_) {
+        grad_num_.fetch_add(1, std::memory_order_relaxed);
+      }
+    };
+    tasks.emplace_back(send_threadpool_->enqueue(std::move(send_recv_task)));
+  }
+  for (auto &task : tasks) {
+    task.wait();
+  }
+
+  // Push the merged gradients of all the sparse tables at once, a request
+  // to each pserver instead of one per table.
+  std::vector<const CommContext *> sparse_ctxs;
+  std::vector<size_t> table_ids;
+  std::vector<const uint64_t *> keys;
+  std::vector<const float **> update_values;
+  std::vector<size_t> nums;
+  for (auto &iter : send_varname_to_ctx_) {
+    auto &ctx = iter.second;
+    if (!ctx.is_sparse || merged_var_nums_[ctx.origin_varnames[0]] == 0) {
+      continue;
+    }
+    PADDLE_ENFORCE_EQ(
+        ctx.origin_varnames.size(),
+        1,
+        platform::errors::InvalidArgument(
+            "sparse variables can only be merged by one variables"));
+    auto &merger = sparse_grad_mergers_[ctx.origin_varnames[0]];
+    sparse_ctxs.push_back(&ctx);
+    table_ids.push_back(ctx.table_id);
+    keys.push_back(merger.Keys().data());
+    update_values.push_back(
+        const_cast<const float **>(merger.Values().data()));
+    nums.push_back(merger.Size());
+  }
+  if (!sparse_ctxs.empty()) {
+    platform::RecordEvent record_event(
+        "Communicator->PushSparseRawGradients",
+        platform::TracerEventType::Communication,
+        1);
+    auto rpc_begin = std::chrono::steady_clock::now();
+    ++_async_call_num;
+    auto status = _worker_ptr->PushSparseRawGradients(
+        table_ids, keys, update_values, nums);
+    status.wait();
+    --_async_call_num;
+    auto ret = status.get();
+    if (ret != 0) {
+      LOG(ERROR) << "fleet push sparse of " << table_ids.size()
+                 << " tables failed, status[" << ret << "]";
+    }
+    std::chrono::duration<double> rtt =
+        std::chrono::steady_clock::now() - rpc_begin;
+    std::chrono::duration<double> interval = rpc_begin - last_send_begin_;
+    send_num_.fetch_add(1, std::memory_order_relaxed);
+    for (auto *ctx : sparse_ctxs) {
+      auto &var_name = ctx->origin_varnames[0];
+      size_t merged_var_num = merged_var_nums_[var_name];
+      merge_controllers_.at(var_name).OnSend(
+          merged_var_num, interval.count(), rtt.count());
+      sparse_grad_mergers_[var_name].Clear();
+      merged_grad_num_.fetch_add(merged_var_num, std::memory_order_relaxed);
+      if (independent_recv_) {
+        grad_num_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+  last_send_begin_ = send_begin;
+}
+
+std::map<std::string, double> AsyncCommunicator::GetSendMetrics() {
+  std::map<std::string, double> metrics;
+  uint64_t send_num = send_num_.load();
+  uint64_t merged_grad_num = merged_grad_num_.load();
+  std::chrono::duration<double> seconds =
+      std::chrono::steady_clock::now() - first_send_begin_;
+  metrics["send_num"] = send_num;
+  metrics["merged_grad_num"] = merged_grad_num;
+  metrics["send_rate"] =
+      send_num > 0 ? merged_grad_num / seconds.count() : 0.0;
+  metrics["merge_ratio"] =
+      send_num > 0 ? static_cast<double>(merged_grad_num) / send_num : 0.0;
+  return metrics;
+}
+
 void AsyncCommunicator::PushDensePostProcessing() {
   if (independent_recv_) {
     grad_num_.fetch_add(1, std::memory_order_relaxed);
@@ -579,7 +745,11 @@ void AsyncCommunicator::MainThread() {
   }
 
   while (running_) {
-    SendByCommunicator();
+    if (adaptive_merge_) {
+      SendByCommunicatorAdaptive();
+    } else {
+      SendByCommunicator();
+    }
     RpcProfilerControl();
   }
   VLOG(1) << "communicator stopped, send thread exit";
@@ -807,6 +977,15 @@ void AsyncCommunicator::InitImpl(const RpcCtxMap &send_varname_to_ctx,
           std::make_shared<BlockingQueue<std::shared_ptr<Variable>>>(
               send_queue_size_);
     }
+    if (adaptive_merge_) {
+      // Create them all here, the send tasks looking them up concurrently.
+      sparse_grad_mergers_[varnames[0]];
+      merge_controllers_.emplace(
+          varnames[0],
+          AdaptiveMergeController(send_queue_size_,
+                                  send_wait_times_ * 0.01));
+      merged_var_nums_[varnames[0]] = 0;
+    }
   }
   send_threadpool_.reset(new ::ThreadPool(thread_pool_size_));
 }
@@ -17,7 +17,10 @@ limitations under the License. */
 #include <ThreadPool.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <deque>
 #include <map>
 #include <memory>
@@ -228,6 +231,127 @@ inline void MergeVars(const std::string &var_name,
   }
 }
 
+// Sums the SelectedRows gradients of a sparse variable into buffers kept
+// from a send to the next, as MergeVars with merge_add does, without
+// building a merged tensor and copying its rows for every send.
+class SparseGradMerger {
+ public:
+  void Add(const phi::SelectedRows &slr) {
+    auto &rows = slr.rows();
+    if (rows.empty()) {
+      return;
+    }
+    auto &value = slr.value();
+    int64_t dim = value.dims()[1];
+    if (keys_.empty()) {
+      dim_ = dim;
+    }
+    PADDLE_ENFORCE_EQ(dim,
+                      dim_,
+                      platform::errors::InvalidArgument(
+                          "The width of the merged SelectedRows should be "
+                          "%d, but got %d.",
+                          dim_,
+                          dim));
+    const float *data = value.data<float>();
+    for (size_t i = 0; i < rows.size(); ++i) {
+      const float *row = data + i * dim;
+      uint64_t key = static_cast<uint64_t>(rows[i]);
+      auto result = key_to_index_.emplace(key, keys_.size());
+      if (result.second) {
+        keys_.push_back(key);
+        values_.insert(values_.end(), row, row + dim);
+      } else {
+        float *merged = values_.data() + result.first->second * dim;
+        for (int64_t j = 0; j < dim; ++j) {
+          merged[j] += row[j];
+        }
+      }
+    }
+  }
+
+  size_t Size() const { return keys_.size(); }
+
+  const std::vector<uint64_t> &Keys() const { return keys_; }
+
+  // The merged row of every key, valid until the next Add or Clear.
+  const std::vector<const float *> &Values() {
+    value_ptrs_.resize(keys_.size());
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      value_ptrs_[i] = values_.data() + i * dim_;
+    }
+    return value_ptrs_;
+  }
+
+  void Clear() {
+    key_to_index_.clear();
+    keys_.clear();
+    values_.clear();
+  }
+
+ private:
+  int64_t dim_ = 0;
+  std::unordered_map<uint64_t, size_t> key_to_index_;
+  std::vector<uint64_t> keys_;
+  std::vector<float> values_;
+  std::vector<const float *> value_ptrs_;
+};
+
+// Picks how many gradients of a variable a send merges from the rate they
+// arrive at and the time a send takes. Merging rate * rtt of them leaves
+// the queue about as long as it was, so the merge grows with the load
+// instead of being fixed at max_merge_var_num, and a send waits at most an
+// rtt for the gradients it still lacks.
+class AdaptiveMergeController {
+ public:
+  AdaptiveMergeController(size_t max_merge_num, double max_wait_seconds)
+      : max_merge_num_(std::max<size_t>(max_merge_num, 1)),
+        max_wait_seconds_(max_wait_seconds) {}
+
+  // Records a send of merged_num gradients, interval_seconds after the one
+  // before it, that took rtt_seconds.
+  void OnSend(size_t merged_num, double interval_seconds, double rtt_seconds) {
+    if (interval_seconds <= 0) {
+      return;
+    }
+    double rate = merged_num / interval_seconds;
+    if (!has_sample_) {
+      rate_ = rate;
+      rtt_ = rtt_seconds;
+      has_sample_ = true;
+    } else {
+      rate_ = kDecay * rate_ + (1 - kDecay) * rate;
+      rtt_ = kDecay * rtt_ + (1 - kDecay) * rtt_seconds;
+    }
+  }
+
+  // The gradients the next send merges, queue_size being queued already.
+  size_t MergeTarget(size_t queue_size) const {
+    size_t target = queue_size;
+    if (has_sample_) {
+      target = std::max(target, static_cast<size_t>(std::ceil(rate_ * rtt_)));
+    }
+    return std::min(std::max<size_t>(target, 1), max_merge_num_);
+  }
+
+  double WaitSeconds() const {
+    return has_sample_ ? std::min(rtt_, max_wait_seconds_) : max_wait_seconds_;
+  }
+
+  double Rate() const { return rate_; }
+
+  double Rtt() const { return rtt_; }
+
+ private:
+  static constexpr double kDecay = 0.8;
+
+  const size_t max_merge_num_;
+  const double max_wait_seconds_;
+  bool has_sample_ = false;
+  double rate_ = 0;
+  double rtt_ = 0;
+};
+
 using RpcCtxMap = std::unordered_map<std::string, CommContext>;
 using RecvCtxMap = std::unordered_map<uint64_t, std::vector<std::string>>;
 using SparseValue = std::unordered_map<int64_t, std::vector<float>>;
@@ -286,6 +410,10 @@ class Communicator {
   virtual std::unordered_map<uint32_t, std::string> QueryFLClientsInfo() {
     return {};
   }
+
+  // The gradients sent per second, send_rate, and merged per send,
+  // merge_ratio, since the first send.
+  virtual std::map<std::string, double> GetSendMetrics() { return {}; }
   virtual void SaveFLStrategy(
       const std::unordered_map<uint32_t, std::string> &fl_strategy UNUSED) {}
   virtual void StartCoordinator(
@@ -444,6 +572,10 @@ class AsyncCommunicator : public Communicator {
     send_queue_size_ = std::stoi(envs.at("communicator_send_queue_size"));
     need_global_step_ =
         static_cast<bool>(std::stoi(envs.at("need_global_step")));
+    if (envs.count("communicator_adaptive_merge") > 0) {
+      adaptive_merge_ = static_cast<bool>(
+          std::stoi(envs.at("communicator_adaptive_merge")));
+    }
   }
 
   void Start() override;
@@ -465,6 +597,12 @@ class AsyncCommunicator : public Communicator {
 
   virtual void SendByCommunicator();
 
+  // Merges as many gradients as AdaptiveMergeController picks, and sends
+  // those of all the sparse tables in one push.
+  void SendByCommunicatorAdaptive();
+
+  std::map<std::string, double> GetSendMetrics() override;
+
   virtual void RecvByCommunicator();
 
   virtual void RecvNoBarrier();
@@ -518,6 +656,17 @@ class AsyncCommunicator : public Communicator {
 
   std::unique_ptr<Scope> send_scope_;  // an independent scope
   std::atomic_uint grad_num_{0};  // the num of gradient sent since last recv
+
+  bool adaptive_merge_ = false;
+  std::unordered_map<std::string, SparseGradMerger> sparse_grad_mergers_;
+  std::unordered_map<std::string, AdaptiveMergeController> merge_controllers_;
+  std::unordered_map<std::string, size_t> merged_var_nums_;
+  std::chrono::steady_clock::time_point last_send_begin_;
+
+  std::atomic<uint64_t> send_num_{0};
+  std::atomic<uint64_t> merged_grad_num_{0};
+  std::chrono::steady_clock::time_point first_send_begin_;
+  std::once_flag first_send_flag_;
 };
 
 class HalfAsyncCommunicator : public AsyncCommunicator {
@@ -255,6 +255,21 @@ class PSClient {
       size_t num,
       void *done) = 0;
 
+  // push_sparse of the gradients of several tables at once, a server
+  // getting those of every table in one request, in the wire format
+  // push_sparse uses.
+  virtual std::future<int32_t> PushSparseRawGradients(
+      const std::vector<size_t> &table_ids UNUSED,
+      const std::vector<const uint64_t *> &keys UNUSED,
+      const std::vector<const float **> &update_values UNUSED,
+      const std::vector<size_t> &nums UNUSED) {
+    VLOG(0) << "Did not implement";
+    std::promise<int32_t> promise;
+    std::future<int> fut = promise.get_future();
+    promise.set_value(-1);
+    return fut;
+  }
+
   virtual std::future<int32_t> PushSparseRawGradientPartial(
       size_t table_id,
       const uint64_t *keys,
@@ -297,6 +297,23 @@ int32_t PsLocalClient::Initialize() {
   return done();
 }
 
+::std::future<int32_t> PsLocalClient::PushSparseRawGradients(
+    const std::vector<size_t>& table_ids,
+    const std::vector<const uint64_t*>& keys,
+    const std::vector<const float**>& update_values,
+    const std::vector<size_t>& nums) {
+  for (size_t i = 0; i < table_ids.size(); ++i) {
+    TableContext table_context;
+    table_context.value_type = Sparse;
+    table_context.push_context.keys = keys[i];
+    table_context.push_context.ptr_values = update_values[i];
+    table_context.num = nums[i];
+    table_context.use_ptr = true;
+    GetTable(table_ids[i])->Push(table_context);
+  }
+  return done();
+}
+
 ::std::future<int32_t> PsLocalClient::PushSparse(size_t table_id,
                                                  const uint64_t* keys,
                                                  const float** update_values,
@@ -174,6 +174,12 @@ class PsLocalClient : public PSClient {
       size_t num,
       void* callback);
 
+  virtual std::future<int32_t> PushSparseRawGradients(
+      const std::vector<size_t>& table_ids,
+      const std::vector<const uint64_t*>& keys,
+      const std::vector<const float**>& update_values,
+      const std::vector<size_t>& nums);
+
   virtual std::future<int32_t> PushSparseRawGradientPartial(
       size_t table_id UNUSED,
       const uint64_t* keys UNUSED,
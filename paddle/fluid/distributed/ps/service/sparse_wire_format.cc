@@ -0,0 +1,191 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_wire_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "paddle/phi/common/float16.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+size_t ExactDim(const SparseWireFormat& format, size_t dim) {
+  return std::min(static_cast<size_t>(format.exact_dim), dim);
+}
+
+template <typename T>
+size_t EncodeVarint(T value, char* out) {
+  size_t size = 0;
+  while (value >= 0x80) {
+    out[size++] = static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  out[size++] = static_cast<char>(value);
+  return size;
+}
+
+// Returns the bytes read, or 0 if data ends within the varint or it is too
+// long for T.
+template <typename T>
+size_t DecodeVarint(const char* data, size_t size, T* value) {
+  const size_t max_size = (sizeof(T) * 8 + 6) / 7;
+  T result = 0;
+  for (size_t i = 0; i < size && i < max_size; ++i) {
+    uint8_t byte = static_cast<uint8_t>(data[i]);
+    result |= static_cast<T>(byte & 0x7f) << (7 * i);
+    if (byte < 0x80) {
+      *value = result;
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+size_t EncodedValueSize(const SparseWireFormat& format, size_t dim) {
+  size_t exact_dim = ExactDim(format, dim);
+  size_t rest = dim - exact_dim;
+  switch (format.codec) {
+    case kSparseValueFp16:
+      return exact_dim * sizeof(float) + rest * sizeof(uint16_t);
+    case kSparseValueInt8:
+      return (exact_dim + 1) * sizeof(float) + rest * sizeof(int8_t);
+    default:
+      return dim * sizeof(float);
+  }
+}
+
+void EncodeValue(const SparseWireFormat& format,
+                 const float* value,
+                 size_t dim,
+                 char* out) {
+  if (format.codec != kSparseValueFp16 && format.codec != kSparseValueInt8) {
+    memcpy(out, value, dim * sizeof(float));
+    return;
+  }
+  size_t exact_dim = ExactDim(format, dim);
+  memcpy(out, value, exact_dim * sizeof(float));
+  out += exact_dim * sizeof(float);
+  if (format.codec == kSparseValueFp16) {
+    for (size_t i = exact_dim; i < dim; ++i) {
+      uint16_t x = phi::dtype::float16(value[i]).x;
+      memcpy(out, &x, sizeof(uint16_t));
+      out += sizeof(uint16_t);
+    }
+    return;
+  }
+  float max_abs = 0;
+  for (size_t i = exact_dim; i < dim; ++i) {
+    max_abs = std::max(max_abs, std::fabs(value[i]));
+  }
+  float scale = max_abs / 127;
+  memcpy(out, &scale, sizeof(float));
+  out += sizeof(float);
+  for (size_t i = exact_dim; i < dim; ++i) {
+    float q = scale > 0 ? std::round(value[i] / scale) : 0;
+    q = std::min(127.f, std::max(-127.f, q));
+    out[i - exact_dim] = static_cast<char>(static_cast<int8_t>(q));
+  }
+}
+
+void DecodeValue(const SparseWireFormat& format,
+                 const char* data,
+                 size_t dim,
+                 float* value) {
+  if (format.codec != kSparseValueFp16 && format.codec != kSparseValueInt8) {
+    memcpy(value, data, dim * sizeof(float));
+    return;
+  }
+  size_t exact_dim = ExactDim(format, dim);
+  memcpy(value, data, exact_dim * sizeof(float));
+  data += exact_dim * sizeof(float);
+  if (format.codec == kSparseValueFp16) {
+    for (size_t i = exact_dim; i < dim; ++i) {
+      phi::dtype::float16 x;
+      memcpy(&x.x, data, sizeof(uint16_t));
+      value[i] = static_cast<float>(x);
+      data += sizeof(uint16_t);
+    }
+    return;
+  }
+  float scale = 0;
+  memcpy(&scale, data, sizeof(float));
+  data += sizeof(float);
+  for (size_t i = exact_dim; i < dim; ++i) {
+    value[i] = static_cast<int8_t>(data[i - exact_dim]) * scale;
+  }
+}
+
+size_t MaxEncodedKeysSize(size_t num) { return num * 10; }
+
+size_t EncodeSortedKeys(const uint64_t* keys, size_t num, char* out) {
+  size_t size = 0;
+  uint64_t last_key = 0;
+  for (size_t i = 0; i < num; ++i) {
+    size += EncodeVarint(keys[i] - last_key, out + size);
+    last_key = keys[i];
+  }
+  return size;
+}
+
+size_t EncodeVarints(const uint32_t* values, size_t num, char* out) {
+  size_t size = 0;
+  for (size_t i = 0; i < num; ++i) {
+    size += EncodeVarint(values[i], out + size);
+  }
+  return size;
+}
+
+size_t DecodeSortedKeys(const char* data,
+                        size_t size,
+                        size_t num,
+                        uint64_t* keys) {
+  size_t offset = 0;
+  uint64_t last_key = 0;
+  for (size_t i = 0; i < num; ++i) {
+    uint64_t delta = 0;
+    size_t read = DecodeVarint(data + offset, size - offset, &delta);
+    if (read == 0) {
+      return 0;
+    }
+    offset += read;
+    last_key += delta;
+    keys[i] = last_key;
+  }
+  return offset;
+}
+
+size_t DecodeVarints(const char* data,
+                     size_t size,
+                     size_t num,
+                     uint32_t* values) {
+  size_t offset = 0;
+  for (size_t i = 0; i < num; ++i) {
+    size_t read = DecodeVarint(data + offset, size - offset, &values[i]);
+    if (read == 0) {
+      return 0;
+    }
+    offset += read;
+  }
+  return offset;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,82 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace paddle {
+namespace distributed {
+
+/*
+The compact wire format of PullSparse and PushSparse, sent in the request
+attachment instead of the PsRequestMessage data:
+  pull request:  |isTraining|varint key deltas|varint frequencies|
+  pull response: |encoded values|
+  push request:  |varint key deltas|encoded values|
+The keys of a request are sorted, so the deltas mostly take a byte or two
+instead of eight. PsRequestMessage.params(1) holds the SparseWireFormat,
+its absence meaning the plain format.
+*/
+enum SparseValueCodec : uint32_t {
+  kSparseValueFp32 = 0,
+  // the values but the exact ones as fp16
+  kSparseValueFp16 = 1,
+  // the values but the exact ones as int8, scaled by their largest
+  // magnitude in the row
+  kSparseValueInt8 = 2,
+};
+
+struct SparseWireFormat {
+  uint32_t codec;
+  // the leading values of a row kept as fp32 whatever the codec, as the
+  // slot, show and click of the ctr accessors are
+  uint32_t exact_dim;
+};
+
+// The bytes a row of dim values takes in the format.
+size_t EncodedValueSize(const SparseWireFormat& format, size_t dim);
+
+// Writes EncodedValueSize(format, dim) bytes to out.
+void EncodeValue(const SparseWireFormat& format,
+                 const float* value,
+                 size_t dim,
+                 char* out);
+void DecodeValue(const SparseWireFormat& format,
+                 const char* data,
+                 size_t dim,
+                 float* value);
+
+// The most bytes EncodeSortedKeys and EncodeVarints write for num values.
+size_t MaxEncodedKeysSize(size_t num);
+
+// Write the varint of every key minus the one before it, the keys being
+// sorted ascending, and of every value. Return the bytes written.
+size_t EncodeSortedKeys(const uint64_t* keys, size_t num, char* out);
+size_t EncodeVarints(const uint32_t* values, size_t num, char* out);
+
+// Read num > 0 keys or values from data, returning the bytes read, or 0 if
+// data does not hold them.
+size_t DecodeSortedKeys(const char* data,
+                        size_t size,
+                        size_t num,
+                        uint64_t* keys);
+size_t DecodeVarints(const char* data,
+                     size_t size,
+                     size_t num,
+                     uint32_t* values);
+
+}  // namespace distributed
+}  // namespace paddle
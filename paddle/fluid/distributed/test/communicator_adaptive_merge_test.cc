@@ -0,0 +1,364 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <unistd.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_client.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_server.h"
+#include "paddle/fluid/distributed/ps/service/communicator/communicator.h"
+#include "paddle/fluid/distributed/ps/service/env.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace distributed {
+
+DECLARE_bool(pserver_sparse_compact_wire_format);
+
+double Time(const std::function<void()>& func) {
+  auto begin = std::chrono::steady_clock::now();
+  func();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       begin)
+      .count();
+}
+
+// Merges the gradients of a send, many of their rows being hot ones, with
+// SparseGradMerger and with MergeVars, which must sum them alike.
+TEST(AdaptiveMerge, SparseGradMerger) {
+  const int kNumVars = 32;
+  const int kNumRows = 4096;
+  const int64_t kDim = 12;
+  const int kRounds = 10;
+  std::mt19937_64 rng(0);
+  std::normal_distribution<float> dist(0, 0.01);
+  std::vector<std::shared_ptr<framework::Variable>> vars;
+  for (int v = 0; v < kNumVars; ++v) {
+    auto var = std::make_shared<framework::Variable>();
+    auto* slr = var->GetMutable<phi::SelectedRows>();
+    slr->set_height(1 << 30);
+    for (int i = 0; i < kNumRows; ++i) {
+      slr->mutable_rows()->push_back(i % 2 ? rng() % 1024 : rng() % (1 << 30));
+    }
+    float* data = slr->mutable_value()->mutable_data<float>(
+        phi::make_ddim({kNumRows, kDim}), platform::CPUPlace());
+    for (int64_t i = 0; i < kNumRows * kDim; ++i) {
+      data[i] = dist(rng);
+    }
+    vars.push_back(var);
+  }
+
+  framework::Scope scope;
+  double merge_vars_seconds = Time([&] {
+    for (int round = 0; round < kRounds; ++round) {
+      MergeVars<float>("grad", vars, &scope, true);
+    }
+  });
+  SparseGradMerger merger;
+  double merger_seconds = Time([&] {
+    for (int round = 0; round < kRounds; ++round) {
+      merger.Clear();
+      for (auto& var : vars) {
+        merger.Add(var->Get<phi::SelectedRows>());
+      }
+      merger.Values();
+    }
+  });
+  std::cout << "MergeVars " << kNumVars * kRounds / merge_vars_seconds
+            << " vars/s, SparseGradMerger "
+            << kNumVars * kRounds / merger_seconds << " vars/s" << std::endl;
+
+  auto& merged = scope.FindVar("grad")->Get<phi::SelectedRows>();
+  const float* merged_data = merged.value().data<float>();
+  std::unordered_map<uint64_t, const float*> key_to_row;
+  for (size_t i = 0; i < merged.rows().size(); ++i) {
+    key_to_row[merged.rows()[i]] = merged_data + i * kDim;
+  }
+  ASSERT_EQ(merger.Size(), key_to_row.size());
+  auto& values = merger.Values();
+  for (size_t i = 0; i < merger.Size(); ++i) {
+    ASSERT_EQ(key_to_row.count(merger.Keys()[i]), 1UL);
+    const float* row = key_to_row[merger.Keys()[i]];
+    for (int64_t j = 0; j < kDim; ++j) {
+      ASSERT_FLOAT_EQ(values[i][j], row[j]);
+    }
+  }
+
+  merger.Clear();
+  EXPECT_EQ(merger.Size(), 0UL);
+}
+
+TEST(AdaptiveMerge, Controller) {
+  AdaptiveMergeController controller(64, 0.05);
+  // Sends what is queued until it knows the rate, waiting for a gradient
+  // at most max_wait_seconds.
+  EXPECT_EQ(controller.MergeTarget(0), 1UL);
+  EXPECT_EQ(controller.MergeTarget(10), 10UL);
+  EXPECT_EQ(controller.MergeTarget(100), 64UL);
+  EXPECT_DOUBLE_EQ(controller.WaitSeconds(), 0.05);
+
+  // 1000 gradients a second and sends of 20ms merge 20 of them.
+  controller.OnSend(10, 0.01, 0.02);
+  EXPECT_DOUBLE_EQ(controller.Rate(), 1000);
+  EXPECT_EQ(controller.MergeTarget(0), 20UL);
+  EXPECT_EQ(controller.MergeTarget(30), 30UL);
+  EXPECT_DOUBLE_EQ(controller.WaitSeconds(), 0.02);
+
+  // Follows the load as it rises, up to max_merge_num.
+  for (int i = 0; i < 50; ++i) {
+    controller.OnSend(100, 0.01, 0.1);
+  }
+  EXPECT_NEAR(controller.Rate(), 10000, 1);
+  EXPECT_NEAR(controller.Rtt(), 0.1, 1e-4);
+  EXPECT_EQ(controller.MergeTarget(0), 64UL);
+  EXPECT_DOUBLE_EQ(controller.WaitSeconds(), 0.05);
+
+  // And as it falls.
+  for (int i = 0; i < 50; ++i) {
+    controller.OnSend(1, 0.1, 0.001);
+  }
+  EXPECT_EQ(controller.MergeTarget(0), 1UL);
+  EXPECT_NEAR(controller.WaitSeconds(), 0.001, 1e-4);
+}
+
+/*-------------------------------------------------------------------------*/
+
+const int kNumTables = 2;
+
+void GetSparseTableProto(TableParameter* sparse_table_proto,
+                         uint32_t table_id) {
+  sparse_table_proto->set_table_id(table_id);
+  sparse_table_proto->set_table_class("MemorySparseTable");
+  sparse_table_proto->set_shard_num(10);
+  TableAccessorParameter* accessor_config =
+      sparse_table_proto->mutable_accessor();
+  accessor_config->set_accessor_class("SparseAccessor");
+  accessor_config->set_fea_dim(10);
+  accessor_config->set_embedx_dim(9);
+  accessor_config->set_embedx_threshold(0);
+  for (auto* sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto* naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    // The keys start from zeros, to pull the same values from the keys the
+    // same gradients were pushed to.
+    naive_param->set_initial_range(0);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+}
+
+void SetServiceProto(ServerServiceParameter* server_service_proto) {
+  server_service_proto->set_service_class("BrpcPsService");
+  server_service_proto->set_server_class("BrpcPsServer");
+  server_service_proto->set_client_class("BrpcPsClient");
+  server_service_proto->set_start_server_port(0);
+  server_service_proto->set_server_thread_num(12);
+}
+
+PSParameter GetServerProto() {
+  PSParameter server_fleet_desc;
+  auto* downpour_server_proto =
+      server_fleet_desc.mutable_server_param()->mutable_downpour_server_param();
+  SetServiceProto(downpour_server_proto->mutable_service_param());
+  for (int t = 0; t < kNumTables; ++t) {
+    GetSparseTableProto(downpour_server_proto->add_downpour_table_param(), t);
+  }
+  return server_fleet_desc;
+}
+
+PSParameter GetWorkerProto() {
+  PSParameter worker_fleet_desc;
+  auto* downpour_worker_proto =
+      worker_fleet_desc.mutable_worker_param()->mutable_downpour_worker_param();
+  auto* downpour_server_proto =
+      worker_fleet_desc.mutable_server_param()->mutable_downpour_server_param();
+  SetServiceProto(downpour_server_proto->mutable_service_param());
+  for (int t = 0; t < kNumTables; ++t) {
+    GetSparseTableProto(downpour_worker_proto->add_downpour_table_param(), t);
+    GetSparseTableProto(downpour_server_proto->add_downpour_table_param(), t);
+  }
+  return worker_fleet_desc;
+}
+
+std::string ip_ = "127.0.0.1";  // NOLINT
+uint32_t port_ = 4229;
+std::vector<std::string> host_sign_list_;
+std::shared_ptr<PSServer> pserver_ptr_;
+std::shared_ptr<PSClient> worker_ptr_;
+
+void RunServer() {
+  PSParameter server_proto = GetServerProto();
+  auto _ps_env = PaddlePSEnvironment();
+  _ps_env.SetPsServers(&host_sign_list_, 1);
+  pserver_ptr_ =
+      std::shared_ptr<PSServer>(PSServerFactory::Create(server_proto));
+  std::vector<framework::ProgramDesc> empty_vec;
+  empty_vec.push_back(framework::ProgramDesc());
+  pserver_ptr_->Configure(server_proto, _ps_env, 0, empty_vec);
+  pserver_ptr_->Start(ip_, port_);
+}
+
+void RunClient() {
+  PSParameter worker_proto = GetWorkerProto();
+  PaddlePSEnvironment _ps_env;
+  _ps_env.SetPsServers(&host_sign_list_, host_sign_list_.size());
+  worker_ptr_ =
+      std::shared_ptr<PSClient>(PSClientFactory::Create(worker_proto));
+  std::map<uint64_t, std::vector<Region>> dense_regions;
+  dense_regions[0] = {};
+  worker_ptr_->Configure(worker_proto, dense_regions, _ps_env, 0);
+}
+
+int32_t PushSparseGrad(size_t table_id,
+                       const std::vector<uint64_t>& keys,
+                       const std::vector<const float*>& grads) {
+  DownpourBrpcClosure* closure =
+      new DownpourBrpcClosure(1, [](void* done) {
+        auto* closure = reinterpret_cast<DownpourBrpcClosure*>(done);
+        closure->set_promise_value(
+            closure->check_response(0, PS_PUSH_SPARSE_TABLE));
+      });
+  return worker_ptr_
+      ->PushSparseRawGradient(table_id,
+                              keys.data(),
+                              const_cast<const float**>(grads.data()),
+                              keys.size(),
+                              closure)
+      .get();
+}
+
+// Pushes the gradients of both tables to a set of keys in one request and
+// to another set in a request a table, which must update them alike, and
+// times both over loopback brpc, in the plain and the compact wire formats.
+TEST(AdaptiveMerge, PushSparseRawGradients) {
+  setenv("http_proxy", "", 1);
+  setenv("https_proxy", "", 1);
+  host_sign_list_.push_back(PSHost(ip_, port_, 0).SerializeToString());
+  std::thread server_thread(RunServer);
+  sleep(1);
+  RunClient();
+
+  const size_t kNumKeys = 1 << 14;
+  const int kRounds = 10;
+  auto info = worker_ptr_->GetTableAccessor(0)->GetAccessorInfo();
+  std::mt19937_64 rng(0);
+  std::normal_distribution<float> dist(0, 0.01);
+  // Keys [0, kNumKeys) take the grouped pushes, the rest the others.
+  std::vector<uint64_t> keys(2 * kNumKeys);
+  for (auto& key : keys) {
+    key = rng();
+  }
+  std::vector<uint64_t> grouped_keys(keys.begin(), keys.begin() + kNumKeys);
+  std::vector<uint64_t> table_keys(keys.begin() + kNumKeys, keys.end());
+  std::vector<std::vector<float>> grads(kNumTables);
+  std::vector<std::vector<const float*>> grad_ptrs(kNumTables);
+  for (int t = 0; t < kNumTables; ++t) {
+    grads[t].resize(kNumKeys * info.update_dim);
+    for (size_t i = 0; i < kNumKeys; ++i) {
+      float* grad = grads[t].data() + i * info.update_dim;
+      // slot, show, click and the gradients
+      grad[0] = 100 + i % 7;
+      grad[1] = 1;
+      grad[2] = i % 2;
+      for (size_t j = 3; j < info.update_dim; ++j) {
+        grad[j] = dist(rng);
+      }
+      grad_ptrs[t].push_back(grad);
+    }
+  }
+  std::vector<float> values(keys.size() * info.select_dim);
+  std::vector<float*> value_ptrs(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    value_ptrs[i] = values.data() + i * info.select_dim;
+  }
+  for (int t = 0; t < kNumTables; ++t) {
+    ASSERT_EQ(worker_ptr_
+                  ->PullSparse(
+                      value_ptrs.data(), t, keys.data(), keys.size(), true)
+                  .get(),
+              0);
+  }
+
+  std::vector<size_t> table_ids;
+  std::vector<const uint64_t*> tables_keys;
+  std::vector<const float**> tables_grads;
+  std::vector<size_t> nums;
+  for (int t = 0; t < kNumTables; ++t) {
+    table_ids.push_back(t);
+    tables_keys.push_back(grouped_keys.data());
+    tables_grads.push_back(grad_ptrs[t].data());
+    nums.push_back(kNumKeys);
+  }
+  for (bool compact : {false, true}) {
+    FLAGS_pserver_sparse_compact_wire_format = compact;
+    double grouped_seconds = 0;
+    double table_seconds = 0;
+    for (int round = 0; round < kRounds; ++round) {
+      int32_t ret = -1;
+      grouped_seconds += Time([&] {
+        ret = worker_ptr_
+                  ->PushSparseRawGradients(
+                      table_ids, tables_keys, tables_grads, nums)
+                  .get();
+      });
+      ASSERT_EQ(ret, 0);
+      table_seconds += Time([&] {
+        ret = 0;
+        for (int t = 0; t < kNumTables; ++t) {
+          ret |= PushSparseGrad(t, table_keys, grad_ptrs[t]);
+        }
+      });
+      ASSERT_EQ(ret, 0);
+    }
+    std::cout << (compact ? "compact" : "plain") << ", a request for "
+              << kNumTables << " tables: " << kRounds / grouped_seconds
+              << " pushes/s, a request a table: " << kRounds / table_seconds
+              << " pushes/s" << std::endl;
+  }
+  FLAGS_pserver_sparse_compact_wire_format = false;
+
+  for (int t = 0; t < kNumTables; ++t) {
+    std::fill(values.begin(), values.end(), 0);
+    ASSERT_EQ(worker_ptr_
+                  ->PullSparse(
+                      value_ptrs.data(), t, keys.data(), keys.size(), false)
+                  .get(),
+              0);
+    for (size_t i = 0; i < kNumKeys; ++i) {
+      for (size_t j = 0; j < info.select_dim; ++j) {
+        ASSERT_EQ(value_ptrs[i][j], value_ptrs[i + kNumKeys][j]);
+      }
+    }
+  }
+
+  worker_ptr_->StopServer();
+  worker_ptr_->FinalizeWorker();
+  server_thread.join();
+}
+
+}  // namespace distributed
+}  // namespace paddle
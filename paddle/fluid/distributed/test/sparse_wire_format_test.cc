@@ -0,0 +1,368 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_wire_format.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_client.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_server.h"
+#include "paddle/fluid/distributed/ps/service/env.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace distributed {
+
+DECLARE_bool(pserver_sparse_compact_wire_format);
+DECLARE_int32(pserver_sparse_value_codec);
+DECLARE_int32(pserver_sparse_value_exact_dim);
+
+TEST(SparseWireFormat, Keys) {
+  std::mt19937_64 rng(0);
+  std::vector<uint64_t> keys(10000);
+  for (auto& key : keys) {
+    key = rng() >> (rng() % 64);
+  }
+  keys.push_back(0);
+  keys.push_back(UINT64_MAX);
+  keys.push_back(UINT64_MAX);
+  std::sort(keys.begin(), keys.end());
+  std::vector<uint32_t> counts(keys.size());
+  for (auto& count : counts) {
+    count = rng() >> (rng() % 32 + 32);
+  }
+
+  std::vector<char> data(2 * MaxEncodedKeysSize(keys.size()));
+  size_t keys_size = EncodeSortedKeys(keys.data(), keys.size(), data.data());
+  size_t size = keys_size + EncodeVarints(counts.data(),
+                                          counts.size(),
+                                          data.data() + keys_size);
+  EXPECT_LT(keys_size, keys.size() * sizeof(uint64_t));
+
+  std::vector<uint64_t> decoded_keys(keys.size());
+  std::vector<uint32_t> decoded_counts(counts.size());
+  EXPECT_EQ(
+      DecodeSortedKeys(data.data(), size, keys.size(), decoded_keys.data()),
+      keys_size);
+  EXPECT_EQ(DecodeVarints(data.data() + keys_size,
+                          size - keys_size,
+                          counts.size(),
+                          decoded_counts.data()),
+            size - keys_size);
+  EXPECT_EQ(decoded_keys, keys);
+  EXPECT_EQ(decoded_counts, counts);
+
+  // Truncated data.
+  EXPECT_EQ(DecodeSortedKeys(
+                data.data(), keys_size - 1, keys.size(), decoded_keys.data()),
+            0UL);
+  EXPECT_EQ(DecodeVarints(data.data() + keys_size,
+                          size - keys_size - 1,
+                          counts.size(),
+                          decoded_counts.data()),
+            0UL);
+}
+
+TEST(SparseWireFormat, Values) {
+  const size_t dim = 12;
+  std::mt19937 rng(0);
+  std::normal_distribution<float> dist(0, 0.1);
+  std::vector<float> value(dim);
+  // slot, show and click
+  value[0] = 10086;
+  value[1] = 3;
+  value[2] = 1;
+  for (size_t i = 3; i < dim; ++i) {
+    value[i] = dist(rng);
+  }
+  float max_abs = 0;
+  for (size_t i = 3; i < dim; ++i) {
+    max_abs = std::max(max_abs, std::fabs(value[i]));
+  }
+
+  for (uint32_t codec :
+       {kSparseValueFp32, kSparseValueFp16, kSparseValueInt8}) {
+    SparseWireFormat format{codec, 3};
+    std::vector<char> data(EncodedValueSize(format, dim));
+    std::vector<float> decoded(dim);
+    EncodeValue(format, value.data(), dim, data.data());
+    DecodeValue(format, data.data(), dim, decoded.data());
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(decoded[i], value[i]);
+    }
+    for (size_t i = 3; i < dim; ++i) {
+      if (codec == kSparseValueFp32) {
+        EXPECT_EQ(decoded[i], value[i]);
+      } else if (codec == kSparseValueFp16) {
+        EXPECT_NEAR(
+            decoded[i], value[i], std::fabs(value[i]) / 1024 + 1e-7);
+      } else {
+        EXPECT_NEAR(decoded[i], value[i], max_abs / 127 / 2 * 1.001);
+      }
+    }
+  }
+  EXPECT_EQ(EncodedValueSize({kSparseValueFp32, 3}, dim), 48UL);
+  EXPECT_EQ(EncodedValueSize({kSparseValueFp16, 3}, dim), 30UL);
+  EXPECT_EQ(EncodedValueSize({kSparseValueInt8, 3}, dim), 25UL);
+  // More exact values than values.
+  EXPECT_EQ(EncodedValueSize({kSparseValueFp16, 3}, 2), 8UL);
+
+  // A row of zeros does not divide by its scale.
+  std::vector<float> zeros(dim, 0);
+  SparseWireFormat format{kSparseValueInt8, 0};
+  std::vector<char> data(EncodedValueSize(format, dim));
+  std::vector<float> decoded(dim, 1);
+  EncodeValue(format, zeros.data(), dim, data.data());
+  DecodeValue(format, data.data(), dim, decoded.data());
+  EXPECT_EQ(decoded, zeros);
+}
+
+/*-------------------------------------------------------------------------*/
+
+void GetSparseTableProto(TableParameter* sparse_table_proto) {
+  sparse_table_proto->set_table_id(0);
+  sparse_table_proto->set_table_class("MemorySparseTable");
+  sparse_table_proto->set_shard_num(10);
+  TableAccessorParameter* accessor_config =
+      sparse_table_proto->mutable_accessor();
+  accessor_config->set_accessor_class("SparseAccessor");
+  accessor_config->set_fea_dim(10);
+  accessor_config->set_embedx_dim(9);
+  accessor_config->set_embedx_threshold(0);
+  for (auto* sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto* naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+}
+
+void SetServiceProto(ServerServiceParameter* server_service_proto) {
+  server_service_proto->set_service_class("BrpcPsService");
+  server_service_proto->set_server_class("BrpcPsServer");
+  server_service_proto->set_client_class("BrpcPsClient");
+  server_service_proto->set_start_server_port(0);
+  server_service_proto->set_server_thread_num(12);
+}
+
+PSParameter GetServerProto() {
+  PSParameter server_fleet_desc;
+  auto* downpour_server_proto =
+      server_fleet_desc.mutable_server_param()->mutable_downpour_server_param();
+  SetServiceProto(downpour_server_proto->mutable_service_param());
+  GetSparseTableProto(downpour_server_proto->add_downpour_table_param());
+  return server_fleet_desc;
+}
+
+PSParameter GetWorkerProto() {
+  PSParameter worker_fleet_desc;
+  GetSparseTableProto(worker_fleet_desc.mutable_worker_param()
+                          ->mutable_downpour_worker_param()
+                          ->add_downpour_table_param());
+  auto* downpour_server_proto =
+      worker_fleet_desc.mutable_server_param()->mutable_downpour_server_param();
+  SetServiceProto(downpour_server_proto->mutable_service_param());
+  GetSparseTableProto(downpour_server_proto->add_downpour_table_param());
+  return worker_fleet_desc;
+}
+
+std::string ip_ = "127.0.0.1";  // NOLINT
+uint32_t port_ = 4219;
+std::vector<std::string> host_sign_list_;
+std::shared_ptr<PSServer> pserver_ptr_;
+std::shared_ptr<PSClient> worker_ptr_;
+
+void RunServer() {
+  PSParameter server_proto = GetServerProto();
+  auto _ps_env = PaddlePSEnvironment();
+  _ps_env.SetPsServers(&host_sign_list_, 1);
+  pserver_ptr_ =
+      std::shared_ptr<PSServer>(PSServerFactory::Create(server_proto));
+  std::vector<framework::ProgramDesc> empty_vec;
+  empty_vec.push_back(framework::ProgramDesc());
+  pserver_ptr_->Configure(server_proto, _ps_env, 0, empty_vec);
+  pserver_ptr_->Start(ip_, port_);
+}
+
+void RunClient() {
+  PSParameter worker_proto = GetWorkerProto();
+  PaddlePSEnvironment _ps_env;
+  _ps_env.SetPsServers(&host_sign_list_, host_sign_list_.size());
+  worker_ptr_ =
+      std::shared_ptr<PSClient>(PSClientFactory::Create(worker_proto));
+  std::map<uint64_t, std::vector<Region>> dense_regions;
+  dense_regions[0] = {};
+  worker_ptr_->Configure(worker_proto, dense_regions, _ps_env, 0);
+}
+
+int32_t PushSparseGrad(const std::vector<uint64_t>& keys,
+                       const std::vector<float*>& grads) {
+  DownpourBrpcClosure* closure =
+      new DownpourBrpcClosure(1, [](void* done) {
+        auto* closure = reinterpret_cast<DownpourBrpcClosure*>(done);
+        closure->set_promise_value(
+            closure->check_response(0, PS_PUSH_SPARSE_TABLE));
+      });
+  return worker_ptr_
+      ->PushSparseRawGradient(0,
+                              keys.data(),
+                              const_cast<const float**>(grads.data()),
+                              keys.size(),
+                              closure)
+      .get();
+}
+
+// Pulls and pushes a batch of hashed keys, a fifth of them twice, over
+// loopback brpc in the plain format and in the compact one with every
+// codec, which must pull the same values but for the precision of the
+// codec.
+TEST(SparseWireFormat, PullPushBenchmark) {
+  setenv("http_proxy", "", 1);
+  setenv("https_proxy", "", 1);
+  host_sign_list_.push_back(PSHost(ip_, port_, 0).SerializeToString());
+  std::thread server_thread(RunServer);
+  sleep(1);
+  RunClient();
+
+  const size_t kNumKeys = 1 << 16;
+  const int kRounds = 5;
+  auto info = worker_ptr_->GetTableAccessor(0)->GetAccessorInfo();
+  std::mt19937_64 rng(0);
+  std::vector<uint64_t> keys(kNumKeys);
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    keys[i] = i % 5 == 4 ? keys[rng() % i] : rng();
+  }
+  std::vector<float> values(kNumKeys * info.select_dim);
+  std::vector<float*> value_ptrs(kNumKeys);
+  std::vector<float> grads(kNumKeys * info.update_dim);
+  std::vector<float*> grad_ptrs(kNumKeys);
+  std::normal_distribution<float> dist(0, 0.01);
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    value_ptrs[i] = values.data() + i * info.select_dim;
+    grad_ptrs[i] = grads.data() + i * info.update_dim;
+    // slot, show, click and the gradients
+    grad_ptrs[i][0] = 100 + i % 7;
+    grad_ptrs[i][1] = 1;
+    grad_ptrs[i][2] = i % 2;
+    for (size_t j = 3; j < info.update_dim; ++j) {
+      grad_ptrs[i][j] = dist(rng);
+    }
+  }
+  // Creates the keys and their embedx, the benchmark pulling them
+  // afterwards.
+  FLAGS_pserver_sparse_value_exact_dim = 3;
+  ASSERT_EQ(worker_ptr_
+                ->PullSparse(value_ptrs.data(), 0, keys.data(), kNumKeys, true)
+                .get(),
+            0);
+  ASSERT_EQ(PushSparseGrad(keys, grad_ptrs), 0);
+  ASSERT_EQ(worker_ptr_
+                ->PullSparse(value_ptrs.data(), 0, keys.data(), kNumKeys, true)
+                .get(),
+            0);
+  const std::vector<float> created_values = values;
+
+  struct Format {
+    const char* name;
+    bool compact;
+    uint32_t codec;
+  };
+  const std::vector<Format> formats = {
+      {"plain", false, kSparseValueFp32},
+      {"compact fp32", true, kSparseValueFp32},
+      {"compact fp16", true, kSparseValueFp16},
+      {"compact int8", true, kSparseValueInt8}};
+  auto time = [](const std::function<void()>& func) {
+    auto begin = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         begin)
+        .count();
+  };
+
+  std::vector<double> pull_seconds(formats.size(), 0);
+  for (size_t f = 0; f < formats.size(); ++f) {
+    FLAGS_pserver_sparse_compact_wire_format = formats[f].compact;
+    FLAGS_pserver_sparse_value_codec = formats[f].codec;
+    for (int round = 0; round < kRounds; ++round) {
+      std::fill(values.begin(), values.end(), 0);
+      int32_t ret = -1;
+      pull_seconds[f] += time([&] {
+        ret = worker_ptr_
+                  ->PullSparse(
+                      value_ptrs.data(), 0, keys.data(), kNumKeys, false)
+                  .get();
+      });
+      ASSERT_EQ(ret, 0);
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (formats[f].codec == kSparseValueFp32) {
+        ASSERT_EQ(values[i], created_values[i]);
+      } else {
+        ASSERT_NEAR(values[i], created_values[i], 0.3 / 100);
+      }
+    }
+  }
+
+  std::vector<double> push_seconds(formats.size(), 0);
+  for (size_t f = 0; f < formats.size(); ++f) {
+    FLAGS_pserver_sparse_compact_wire_format = formats[f].compact;
+    FLAGS_pserver_sparse_value_codec = formats[f].codec;
+    for (int round = 0; round < kRounds; ++round) {
+      int32_t ret = -1;
+      push_seconds[f] += time([&] { ret = PushSparseGrad(keys, grad_ptrs); });
+      ASSERT_EQ(ret, 0);
+    }
+  }
+
+  std::vector<uint64_t> sorted_keys = keys;
+  std::sort(sorted_keys.begin(), sorted_keys.end());
+  std::vector<char> encoded_keys(MaxEncodedKeysSize(kNumKeys));
+  size_t compact_keys_size =
+      EncodeSortedKeys(sorted_keys.data(), kNumKeys, encoded_keys.data());
+  for (size_t f = 0; f < formats.size(); ++f) {
+    SparseWireFormat wire_format{formats[f].codec, 3};
+    size_t push_bytes =
+        (formats[f].compact ? compact_keys_size
+                            : kNumKeys * sizeof(uint64_t)) +
+        kNumKeys * EncodedValueSize(wire_format, info.update_dim);
+    std::cout << formats[f].name << ": pull "
+              << kNumKeys * kRounds / pull_seconds[f] << " keys/s, push "
+              << kNumKeys * kRounds / push_seconds[f] << " keys/s of "
+              << push_bytes << " bytes" << std::endl;
+  }
+
+  worker_ptr_->StopServer();
+  worker_ptr_->FinalizeWorker();
+  server_thread.join();
+}
+
+}  // namespace distributed
+}  // namespace paddle
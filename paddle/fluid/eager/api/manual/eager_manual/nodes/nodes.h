@@ -40,8 +40,7 @@ class Conv2dGradNodeFinal : public egr::GradNodeBase {
   }
 
   std::shared_ptr<GradNodeBase> Copy() const override {
-    auto copied_node =
-        std::shared_ptr<Conv2dGradNodeFinal>(new Conv2dGradNodeFinal(*this));
+    auto copied_node = egr::MakePooled<Conv2dGradNodeFinal>(*this);
     VLOG(3) << "Copy Conv2dGradNodeFinal: " << this
             << " to: " << copied_node.get();
     return copied_node;
@@ -111,8 +110,7 @@ class Conv2dDoubleGradNodeFinal : public egr::GradNodeBase {
   }
 
   std::shared_ptr<GradNodeBase> Copy() const override {
-    auto copied_node = std::shared_ptr<Conv2dDoubleGradNodeFinal>(
-        new Conv2dDoubleGradNodeFinal(*this));
+    auto copied_node = egr::MakePooled<Conv2dDoubleGradNodeFinal>(*this);
     return copied_node;
   }
 
@@ -184,8 +182,7 @@ class AddNGradNodeFinal : public egr::GradNodeBase {
   }
 
   std::shared_ptr<GradNodeBase> Copy() const override {
-    auto copied_node =
-        std::shared_ptr<AddNGradNodeFinal>(new AddNGradNodeFinal(*this));
+    auto copied_node = egr::MakePooled<AddNGradNodeFinal>(*this);
     return copied_node;
   }
 
@@ -232,8 +229,7 @@ class SyncBatchNormGradNode : public egr::GradNodeBase {
   }
 
   std::shared_ptr<GradNodeBase> Copy() const override {
-    auto copied_node = std::shared_ptr<SyncBatchNormGradNode>(
-        new SyncBatchNormGradNode(*this));
+    auto copied_node = egr::MakePooled<SyncBatchNormGradNode>(*this);
     return copied_node;
   }
 
@@ -317,8 +313,7 @@ class SyncBatchNormGradNode : public egr::GradNodeBase {
   }
 
   std::shared_ptr<GradNodeBase> Copy() const override {
-    auto copied_node = std::shared_ptr<SyncBatchNormGradNode>(
-        new SyncBatchNormGradNode(*this));
+    auto copied_node = egr::MakePooled<SyncBatchNormGradNode>(*this);
     return copied_node;
   }
 
@@ -48,7 +48,7 @@ paddle::Tensor CreateTensorWithValue(const phi::DDim& ddim,
 
   auto meta = EagerUtils::autograd_meta(&out);
   if (is_leaf) {
-    auto accumulation_node = std::make_shared<GradNodeAccumulation>(meta);
+    auto accumulation_node = MakePooled<GradNodeAccumulation>(meta);
     meta->SetGradNode(accumulation_node);
     meta->SetStopGradient(false);
   }
@@ -1177,12 +1177,9 @@ static std::string GenerateGradNodeCreationContent(
   size_t bwd_in_slot_num = out_vars.size();
   size_t bwd_out_slot_num = in_vars.size();
   const char* GRAD_OP_NODE_TEMPLATE =
-      "      auto grad_node = std::shared_ptr<%sGradNodeCompat>(new "
-      "%sGradNodeCompat(%d, "
-      "%d));\n";
+      "      auto grad_node = egr::MakePooled<%sGradNodeCompat>(%d, %d);\n";
   grad_node_creation_str += "    // Create GradOpNode\n";
   grad_node_creation_str += paddle::string::Sprintf(GRAD_OP_NODE_TEMPLATE,
-                                                    op_type,
                                                     op_type,
                                                     bwd_in_slot_num,
                                                     bwd_out_slot_num);
@@ -2818,8 +2815,7 @@ static std::string GenerateGradNodeHeaderContents(
       "  std::string name() override { return \"%sGradNodeCompat\"; }\n"
       "\n"
       "std::shared_ptr<GradNodeBase> Copy() const override {{\n"
-      "    auto copied_node = std::shared_ptr<%sGradNodeCompat>(new "
-      "%sGradNodeCompat(*this));\n"
+      "    auto copied_node = egr::MakePooled<%sGradNodeCompat>(*this);\n"
       "    return copied_node;\n"
       "}}\n"
       "\n"
@@ -2955,7 +2951,6 @@ static std::string GenerateGradNodeHeaderContents(
                               clear_tensor_wrappers_str,
                               op_type,
                               op_type,
-                              op_type,
                               set_tensor_wrappers_str,
                               set_attr_map_str,
                               tensor_wrapper_members_str,
@@ -154,7 +154,7 @@ class {} : public egr::GradNodeBase {{
   }}
 
   std::shared_ptr<GradNodeBase> Copy() const override {{
-    auto copied_node = std::shared_ptr<{}>(new {}(*this));
+    auto copied_node = egr::MakePooled<{}>(*this);
     return copied_node;
   }}
 
@@ -944,7 +944,9 @@ class DygraphFunctionGeneratorBase(FunctionGeneratorBase):
         # request MEMALIGN for allocation (Maybe).
         # See https://stackoverflow.com/questions/31228656/how-can-shared-ptr-disrupt-alignment
         # and https://github.com/MRtrix3/mrtrix3/issues/957
-        node_construction_str = f"{indent}auto grad_node = std::shared_ptr<{grad_node_name}>(new {grad_node_name}({num_backward_inputs}, {num_backward_outputs}));"
+        # egr::MakePooled allocates the node and its control block from the
+        # per-thread pool with the alignment of the node, so it is fine.
+        node_construction_str = f"{indent}auto grad_node = egr::MakePooled<{grad_node_name}>({num_backward_inputs}, {num_backward_outputs});"
 
         # SetAttributes
         set_attributes_list = []
@@ -2025,7 +2027,6 @@ class DygraphNodeGenerator(DygraphFunctionGeneratorBase):
             grad_node_name,
             clear_tensor_wrapper_str,
             grad_node_name,
-            grad_node_name,
             set_tensor_wrapper_methods_str,
             set_attribute_methods_str,
             tensor_wrapper_members_str,
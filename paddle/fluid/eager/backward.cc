@@ -46,7 +46,7 @@ std::unordered_map<GradNodeBase*, int> getInDegreeMap(
             "We got null node when we traverse the backward graph, and this "
             "should not happened please check your code and contact us."));
     // Find and append next nodes
-    const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+    const paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
         metas = node->OutputMeta();
     for (const auto& meta_list : metas) {
       for (const GradSlotMeta& meta : meta_list) {
@@ -294,7 +294,7 @@ std::vector<paddle::Tensor> RunBackward(
     node_input_buffers_dict.erase(node_input_buffer_iter);
 
     // Prepare GradTensorHolder for next node
-    const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+    const paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
         metas = node->OutputMeta();
     PADDLE_ENFORCE(metas.size() == grad_output_tensors.size() || metas.empty(),
                    paddle::platform::errors::Fatal(
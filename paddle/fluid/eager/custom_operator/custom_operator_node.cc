@@ -259,7 +259,7 @@ RunCustomOpNode::operator()(paddle::small_vector<std::vector<paddle::Tensor>,
                 "`paddle::Optional` to decorate this output",
                 i));
         // We can also consider using `autograd_meta` to tolerant nullptr.
-        out_tensor->set_autograd_meta(std::make_shared<egr::AutogradMeta>());
+        out_tensor->set_autograd_meta(egr::MakePooled<egr::AutogradMeta>());
       }
     }
   }
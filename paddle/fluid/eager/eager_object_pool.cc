@@ -0,0 +1,252 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/eager_object_pool.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+namespace egr {
+
+namespace {
+
+constexpr size_t kNumSizeClasses =
+    EagerObjectPool::kMaxPooledSize / EagerObjectPool::kAlignment;
+constexpr size_t kChunkSize = 256 * 1024;
+// A thread cache gives half of a free list back to the global one when it
+// holds more blocks than this, and takes up to kRefillBlocks at once from it.
+constexpr size_t kMaxCachedBlocks = 1024;
+constexpr size_t kRefillBlocks = 64;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct FreeList {
+  FreeBlock* head = nullptr;
+  size_t size = 0;
+
+  void Push(void* ptr) {
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = head;
+    head = block;
+    ++size;
+  }
+
+  void* Pop() {
+    FreeBlock* block = head;
+    head = block->next;
+    --size;
+    return block;
+  }
+
+  // Moves up to n blocks of this list to the front of other.
+  void MoveTo(FreeList* other, size_t n) {
+    while (n-- > 0 && head != nullptr) {
+      other->Push(Pop());
+    }
+  }
+};
+
+size_t SizeClass(size_t size) {
+  return (size + EagerObjectPool::kAlignment - 1) /
+             EagerObjectPool::kAlignment -
+         1;
+}
+
+bool IsPooled(size_t size, size_t alignment) {
+  return size > 0 && size <= EagerObjectPool::kMaxPooledSize &&
+         alignment <= EagerObjectPool::kAlignment;
+}
+
+// The blocks too large for the pool. operator new aligns them for any
+// fundamental type, the more aligned ones come from posix_memalign, the
+// aligned operator new being C++17.
+void* AllocateUnpooled(size_t size, size_t alignment) {
+  if (alignment <= alignof(std::max_align_t)) {
+    return ::operator new(size);
+  }
+  void* ptr = nullptr;
+#ifdef _WIN32
+  ptr = _aligned_malloc(size, alignment);
+#else
+  if (posix_memalign(&ptr, std::max(alignment, sizeof(void*)), size) != 0) {
+    ptr = nullptr;
+  }
+#endif
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void DeallocateUnpooled(void* ptr, size_t alignment) {
+  if (alignment <= alignof(std::max_align_t)) {
+    ::operator delete(ptr);
+    return;
+  }
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+// The blocks given back by the thread caches, and the chunks they are carved
+// from. It is never destroyed, the objects it serves may outlive the static
+// ones.
+class GlobalPool {
+ public:
+  static GlobalPool& Instance() {
+    static GlobalPool* pool = new GlobalPool();
+    return *pool;
+  }
+
+  void Take(size_t size_class, FreeList* list, size_t n) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    lists_[size_class].MoveTo(list, n);
+  }
+
+  void Give(size_t size_class, FreeList* list, size_t n) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    list->MoveTo(&lists_[size_class], n);
+  }
+
+  char* NewChunk(size_t size) {
+    reserved_bytes_.fetch_add(static_cast<int64_t>(size),
+                              std::memory_order_relaxed);
+    return static_cast<char*>(::operator new(size));
+  }
+
+  int64_t ReservedBytes() const {
+    return reserved_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::mutex mutex_;
+  FreeList lists_[kNumSizeClasses];
+  std::atomic<int64_t> reserved_bytes_{0};
+};
+
+class ThreadCache {
+ public:
+  ~ThreadCache() {
+    for (size_t i = 0; i < kNumSizeClasses; ++i) {
+      GlobalPool::Instance().Give(i, &lists_[i], lists_[i].size);
+    }
+  }
+
+  void* Allocate(size_t size_class) {
+    FreeList& list = lists_[size_class];
+    if (list.head == nullptr) {
+      GlobalPool::Instance().Take(size_class, &list, kRefillBlocks);
+    }
+    if (list.head != nullptr) {
+      return list.Pop();
+    }
+    const size_t block_size = (size_class + 1) * EagerObjectPool::kAlignment;
+    if (static_cast<size_t>(chunk_end_ - chunk_ptr_) < block_size) {
+      // The rest of the current chunk is lost, it is smaller than the
+      // largest size class.
+      chunk_ptr_ = GlobalPool::Instance().NewChunk(kChunkSize);
+      chunk_end_ = chunk_ptr_ + kChunkSize;
+    }
+    void* ptr = chunk_ptr_;
+    chunk_ptr_ += block_size;
+    return ptr;
+  }
+
+  void Deallocate(void* ptr, size_t size_class) {
+    FreeList& list = lists_[size_class];
+    list.Push(ptr);
+    if (list.size > kMaxCachedBlocks) {
+      GlobalPool::Instance().Give(size_class, &list, kMaxCachedBlocks / 2);
+    }
+  }
+
+ private:
+  FreeList lists_[kNumSizeClasses];
+  char* chunk_ptr_ = nullptr;
+  char* chunk_end_ = nullptr;
+};
+
+// The objects destroyed after the thread cache, by the thread local or static
+// destructors run later on the thread, go straight to the global pool.
+thread_local ThreadCache* tls_cache = nullptr;
+thread_local bool tls_cache_destroyed = false;
+
+struct ThreadCacheHolder {
+  ThreadCacheHolder() { tls_cache = &cache; }
+  ~ThreadCacheHolder() {
+    tls_cache = nullptr;
+    tls_cache_destroyed = true;
+  }
+  ThreadCache cache;
+};
+
+ThreadCache* GetThreadCache() {
+  if (tls_cache == nullptr && !tls_cache_destroyed) {
+    thread_local ThreadCacheHolder holder;
+  }
+  return tls_cache;
+}
+
+}  // namespace
+
+void* EagerObjectPool::Allocate(size_t size, size_t alignment) {
+  if (!IsPooled(size, alignment)) {
+    return AllocateUnpooled(size, alignment);
+  }
+  const size_t size_class = SizeClass(size);
+  ThreadCache* cache = GetThreadCache();
+  if (cache != nullptr) {
+    return cache->Allocate(size_class);
+  }
+  FreeList list;
+  GlobalPool::Instance().Take(size_class, &list, 1);
+  if (list.head != nullptr) {
+    return list.Pop();
+  }
+  return GlobalPool::Instance().NewChunk((size_class + 1) * kAlignment);
+}
+
+void EagerObjectPool::Deallocate(void* ptr, size_t size, size_t alignment) {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (!IsPooled(size, alignment)) {
+    DeallocateUnpooled(ptr, alignment);
+    return;
+  }
+  const size_t size_class = SizeClass(size);
+  ThreadCache* cache = GetThreadCache();
+  if (cache != nullptr) {
+    cache->Deallocate(ptr, size_class);
+    return;
+  }
+  FreeList list;
+  list.Push(ptr);
+  GlobalPool::Instance().Give(size_class, &list, 1);
+}
+
+int64_t EagerObjectPool::ReservedBytes() {
+  return GlobalPool::Instance().ReservedBytes();
+}
+
+}  // namespace egr
@@ -0,0 +1,93 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace egr {
+
+/**
+ * EagerObjectPool serves the small objects that eager mode allocates for every
+ * op requiring grad: the grad nodes, with the TensorWrappers they hold, the
+ * AutogradMetas of their outputs and the tensor metas of their slots.
+ *
+ * Blocks are grouped in size classes of kAlignment bytes, and each thread
+ * keeps a free list per class, so that an allocation is most of the time the
+ * pop of a thread local list. The blocks are carved from chunks which are
+ * never returned to the system: the pool grows to the peak number of live
+ * objects and then recycles them. A block may be freed by another thread than
+ * the one that allocated it, it then goes to the free list of that thread.
+ * Thread caches holding too many blocks, and those of the exiting threads,
+ * give them back to a global list shared by all the threads.
+ **/
+class EagerObjectPool {
+ public:
+  static constexpr size_t kAlignment = 16;
+  // Larger blocks, or more aligned ones, are taken from the heap.
+  static constexpr size_t kMaxPooledSize = 4096;
+
+  static void* Allocate(size_t size, size_t alignment = kAlignment);
+  static void Deallocate(void* ptr, size_t size, size_t alignment = kAlignment);
+
+  // Bytes the pool took from the system, over all threads.
+  static int64_t ReservedBytes();
+};
+
+/**
+ * Standard allocator over EagerObjectPool, meant for std::allocate_shared so
+ * that the object and its control block are one pooled block.
+ **/
+template <typename T>
+class EagerPoolAllocator {
+ public:
+  using value_type = T;
+
+  EagerPoolAllocator() = default;
+  template <typename U>
+  EagerPoolAllocator(const EagerPoolAllocator<U>&) {}  // NOLINT
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(
+        EagerObjectPool::Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* ptr, size_t n) {
+    EagerObjectPool::Deallocate(ptr, n * sizeof(T), alignof(T));
+  }
+
+  template <typename U>
+  bool operator==(const EagerPoolAllocator<U>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const EagerPoolAllocator<U>&) const {
+    return false;
+  }
+};
+
+/**
+ * Pooled std::make_shared. The block is aligned for the control block and T
+ * together, so it is also fine for the grad nodes holding manually aligned
+ * attributes such as complex128 scalars.
+ **/
+template <typename T, typename... Args>
+std::shared_ptr<T> MakePooled(Args&&... args) {
+  return std::allocate_shared<T>(EagerPoolAllocator<T>(),
+                                 std::forward<Args>(args)...);
+}
+
+}  // namespace egr
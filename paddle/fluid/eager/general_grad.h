@@ -186,9 +186,8 @@ class GeneralGrad {
       visited.insert(node);
 
       // Find and append next nodes
-      const paddle::small_vector<std::vector<GradSlotMeta>,
-                                 kSlotSmallVectorSize>& metas =
-          node->OutputMeta();
+      const paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
+          metas = node->OutputMeta();
       for (const auto& meta_list : metas) {
         for (const GradSlotMeta& meta : meta_list) {
           const auto& edge = meta.GetEdge();
@@ -324,7 +323,7 @@ class GeneralGrad {
       // Find precedding_nodes of current node.
       auto precedding_nodes = (depending_nodes_)[node];
       for (auto pre_nodes : precedding_nodes) {
-        paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+        paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
             pre_nodes_edges = pre_nodes->MutableOutputMeta();
         for (size_t i = 0; i < pre_nodes_edges.size(); i++) {
           for (size_t j = 0; j < pre_nodes_edges[i].size(); j++) {
@@ -338,7 +337,7 @@ class GeneralGrad {
               } else {
                 auto autograd_meta = egr::AutogradMeta(edge_);
                 std::shared_ptr<GradNodeBase> shared_grad_node_accumulation =
-                    std::make_shared<egr::GradNodeAccumulation>(&autograd_meta);
+                    egr::MakePooled<egr::GradNodeAccumulation>(&autograd_meta);
                 pre_node_edge.SetGradNode(shared_grad_node_accumulation);
                 copied_node_to_endding_node_map_[node] =
                     shared_grad_node_accumulation;
@@ -389,7 +388,7 @@ class GeneralGrad {
         continue;
       }
 
-      paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+      paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
           meta = node->MutableOutputMeta();
       for (size_t i = 0; i < meta.size(); i++) {
         for (size_t j = 0; j < meta[i].size(); j++) {
@@ -538,10 +537,9 @@ class GeneralGrad {
               "unable to find copied target for certain grad node."));
       GradNodeBase* copied_node = orig_to_copied_node_map_[orig_node].get();
 
-      const paddle::small_vector<std::vector<GradSlotMeta>,
-                                 kSlotSmallVectorSize>& orig_meta =
-          orig_node->OutputMeta();
-      paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+      const paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
+          orig_meta = orig_node->OutputMeta();
+      paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
           copied_edges = copied_node->MutableOutputMeta();
       for (size_t i = 0; i < orig_meta.size(); i++) {
         for (size_t j = 0; j < orig_meta[i].size(); j++) {
@@ -66,17 +66,53 @@ GradNodeBase::GradNodeBase(size_t bwd_in_slot_num, size_t bwd_out_slot_num) {
   bwd_out_meta_.resize(bwd_out_slot_num);
 }
 
-const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+// The grad nodes whose release is pending in the outermost ~GradNodeBase of
+// this thread, if any.
+static thread_local std::vector<std::shared_ptr<GradNodeBase>>*
+    pending_grad_nodes = nullptr;
+
+GradNodeBase::~GradNodeBase() {
+  VLOG(7) << "Destruct GradNodeBase";
+  // Destroying the edges with the node would destroy the next nodes from
+  // within this destructor, as deep as the graph is. Instead the outermost
+  // destructor collects the next nodes and releases them one after the
+  // other, so that a whole graph is released in one flat pass, and a long
+  // one, e.g. an unrolled RNN, does not overflow the stack.
+  std::vector<std::shared_ptr<GradNodeBase>> pending;
+  auto* nodes = pending_grad_nodes ? pending_grad_nodes : &pending;
+  for (auto& metas : bwd_out_meta_) {
+    for (auto& meta : metas) {
+      Edge& edge = meta.GetMutableEdge();
+      if (edge.IsInitialized()) {
+        nodes->emplace_back(edge.GetMutableGradNode());
+        edge.Clear();
+      }
+    }
+  }
+  if (nodes != &pending || pending.empty()) {
+    return;
+  }
+  pending_grad_nodes = &pending;
+  while (!pending.empty()) {
+    // The node is destroyed here if this was its last reference, and appends
+    // its own next nodes to pending.
+    std::shared_ptr<GradNodeBase> node = std::move(pending.back());
+    pending.pop_back();
+  }
+  pending_grad_nodes = nullptr;
+}
+
+const paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
 GradNodeBase::InputMeta() const {
   return bwd_in_meta_;
 }
 
-const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+const paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
 GradNodeBase::OutputMeta() const {
   return bwd_out_meta_;
 }
 
-paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
 GradNodeBase::MutableOutputMeta() {
   return bwd_out_meta_;
 }
@@ -233,7 +269,7 @@ void GradNodeBase::SetGradOutMeta(const paddle::Tensor& fwd_in,
     auto node = fwd_in_meta->GetMutableGradNode();
     if (!node || !node.get()) {
       fwd_in_meta->SetGradNode(
-          std::make_shared<egr::GradNodeAccumulation>(fwd_in_meta));
+          egr::MakePooled<egr::GradNodeAccumulation>(fwd_in_meta));
     }
     VLOG(3) << "Add Edges for slot: " << slot_rank << ", the Edge is from "
             << this->name() << " (addr: " << this << ") "
@@ -296,7 +332,7 @@ void GradNodeBase::SetGradOutMeta(const paddle::Tensor& fwd_in,
     auto node = fwd_in_meta->GetMutableGradNode();
     if (!node || !node.get()) {
       fwd_in_meta->SetGradNode(
-          std::make_shared<egr::GradNodeAccumulation>(fwd_in_meta));
+          egr::MakePooled<egr::GradNodeAccumulation>(fwd_in_meta));
     }
     VLOG(3) << "Add Edges for slot: " << slot_rank << ", the Edge is from "
             << this->name() << " (addr: " << this << ") "
@@ -354,7 +390,7 @@ void GradNodeBase::SetGradOutMeta(const std::vector<paddle::Tensor>& fwd_in,
       auto node = fwd_in_meta->GetMutableGradNode();
       if (!node || !node.get()) {
         fwd_in_meta->SetGradNode(
-            std::make_shared<egr::GradNodeAccumulation>(fwd_in_meta));
+            egr::MakePooled<egr::GradNodeAccumulation>(fwd_in_meta));
       }
       VLOG(3) << "Add Edges for slot: " << slot_rank << ", the Edge is from "
               << this->name() << " (addr: " << this << ") "
@@ -415,7 +451,7 @@ void GradNodeBase::SetGradOutMeta(
       auto node = fwd_in_meta->GetMutableGradNode();
       if (!node || !node.get()) {
         fwd_in_meta->SetGradNode(
-            std::make_shared<egr::GradNodeAccumulation>(fwd_in_meta));
+            egr::MakePooled<egr::GradNodeAccumulation>(fwd_in_meta));
       }
       VLOG(3) << "Add Edges for slot: " << slot_rank << ", the Edge is from "
               << this->name() << " (addr: " << this << ") "
@@ -17,6 +17,7 @@
 #include <memory>
 
 #include "paddle/fluid/eager/api/utils/global_utils.h"
+#include "paddle/fluid/eager/eager_object_pool.h"
 #include "paddle/fluid/eager/eager_tensor.h"
 #include "paddle/fluid/eager/hooks.h"
 #include "paddle/phi/api/all.h"
@@ -132,7 +133,7 @@ class GradSlotMeta {
   }
 
   void SetTensorMeta(const phi::DenseTensorMeta& meta) {
-    meta_ = std::make_shared<phi::DenseTensorMeta>(meta);
+    meta_ = MakePooled<phi::DenseTensorMeta>(meta);
   }
   bool HasTensorMeta() const { return meta_ && meta_.get(); }
   const phi::DenseTensorMeta& GetTensorMeta() const {
@@ -165,12 +166,22 @@ class GradSlotMeta {
   Edge adj_edge_;
 };
 
+/**
+ * The metas of one slot, one per tensor of the slot. Almost all the slots
+ * hold a single tensor, whose meta is then stored inline rather than in a
+ * heap allocated vector.
+ **/
+using GradSlotMetaVector =
+    paddle::small_vector<GradSlotMeta, kSlotMetaSmallVectorSize>;
+
 class GradNodeBase {
  public:
   GradNodeBase() { VLOG(7) << "Construct GradNodeBase"; }
   GradNodeBase(size_t bwd_in_slot_num, size_t bwd_out_slot_num);
   // TODO(jiabin): Should we have other constructor here?
-  virtual ~GradNodeBase() { VLOG(7) << "Destruct GradNodeBase"; }
+  // Releases the nodes reachable from this one without recursion, see
+  // grad_node_info.cc.
+  virtual ~GradNodeBase();
 
   /**
    * operator() designed to contain the real backward execution logic, it should
@@ -203,14 +214,14 @@ class GradNodeBase {
 
   /**
    * Get Input Meta of current Grad node**/
-  const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+  const paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
   InputMeta() const;
   /**
    * Get Output Meta of current Grad node**/
-  const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+  const paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
   OutputMeta() const;
 
-  paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+  paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>&
   MutableOutputMeta();
   /**
    * Set bwd ins and outs info with forward vars
@@ -298,11 +309,11 @@ class GradNodeBase {
 
  private:
   // bwd_out_meta_ is used to record Grad output info for backward
-  paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>
+  paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>
       bwd_out_meta_;
 
   // bwd_in_meta_ used to record Grad input info for backward
-  paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>
+  paddle::small_vector<GradSlotMetaVector, kSlotSmallVectorSize>
       bwd_in_meta_;
   // Gradient Hooks
   // Customer may register a list of hooks which will be called in order during
@@ -27,7 +27,7 @@ namespace egr {
 class GradTensorHolder {
  public:
   explicit GradTensorHolder(
-      const paddle::small_vector<std::vector<GradSlotMeta>,
+      const paddle::small_vector<GradSlotMetaVector,
                                  kSlotSmallVectorSize>& metas) {
     VLOG(7) << "Init GradTensorHolder with meta size: " << metas.size();
     buffer_.resize(metas.size());
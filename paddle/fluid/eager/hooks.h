@@ -102,14 +102,25 @@ class SavedTensorsHooks {
     is_enable_ = true;
   }
 
+  // Hooks implemented in C++, which only pack the tensors saved by
+  // TensorWrapper. The containers saved by PyLayer are left as they are.
+  void SetNativeHooks(std::shared_ptr<PackHookBase> pack_hook,
+                      std::shared_ptr<UnPackHookBase> unpack_hook) {
+    SetHooks(pack_hook, unpack_hook);
+    is_native_ = true;
+  }
+
   void ResetHooks() {
     pack_hook_ = nullptr;
     unpack_hook_ = nullptr;
     is_enable_ = false;
+    is_native_ = false;
   }
 
   bool IsEnable() { return is_enable_; }
 
+  bool IsNative() { return is_native_; }
+
   std::shared_ptr<PackHookBase> GetPackHook() { return pack_hook_; }
   std::shared_ptr<UnPackHookBase> GetUnPackHook() { return unpack_hook_; }
 
@@ -122,6 +133,7 @@ class SavedTensorsHooks {
   std::shared_ptr<PackHookBase> pack_hook_;
   std::shared_ptr<UnPackHookBase> unpack_hook_;
   bool is_enable_{false};
+  bool is_native_{false};
 };
 
 }  // namespace egr
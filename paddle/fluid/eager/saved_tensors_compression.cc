@@ -0,0 +1,480 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/saved_tensors_compression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/data_type.h"
+
+namespace egr {
+
+namespace {
+
+using Codec = CompressedTensorHolder::Codec;
+
+int64_t TensorBytes(const phi::DenseTensor& tensor) {
+  return tensor.numel() * static_cast<int64_t>(phi::SizeOf(tensor.dtype()));
+}
+
+// One bit per element of a tensor whose values are all 0 or 1.
+template <typename T>
+void BitPack(const T* x, int64_t n, std::vector<uint8_t>* bytes) {
+  bytes->assign((n + 7) / 8, 0);
+  for (int64_t i = 0; i < n; ++i) {
+    if (x[i]) {
+      (*bytes)[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+    }
+  }
+}
+
+template <typename T>
+void BitUnpack(const std::vector<uint8_t>& bytes, int64_t n, T* x) {
+  for (int64_t i = 0; i < n; ++i) {
+    x[i] = static_cast<T>((bytes[i / 8] >> (i % 8)) & 1);
+  }
+}
+
+template <typename T, typename NarrowT>
+void Narrow(const T* x, int64_t n, std::vector<uint8_t>* bytes) {
+  bytes->resize(n * sizeof(NarrowT));
+  auto* y = reinterpret_cast<NarrowT*>(bytes->data());
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = static_cast<NarrowT>(x[i]);
+  }
+}
+
+template <typename T, typename NarrowT>
+void Widen(const std::vector<uint8_t>& bytes, int64_t n, T* x) {
+  const auto* y = reinterpret_cast<const NarrowT*>(bytes.data());
+  for (int64_t i = 0; i < n; ++i) {
+    x[i] = static_cast<T>(y[i]);
+  }
+}
+
+// Integers are stored in one bit when they are all 0 or 1, which covers
+// masks, otherwise in the narrowest signed type holding their range.
+template <typename T>
+Codec EncodeInteger(const T* x, int64_t n, std::vector<uint8_t>* bytes) {
+  if (n == 0) {
+    return Codec::kNone;
+  }
+  const auto minmax = std::minmax_element(x, x + n);
+  const int64_t min = static_cast<int64_t>(*minmax.first);
+  const int64_t max = static_cast<int64_t>(*minmax.second);
+  auto fits = [&](int64_t lo, int64_t hi) { return min >= lo && max <= hi; };
+  if (fits(0, 1)) {
+    BitPack(x, n, bytes);
+    return Codec::kBitPack;
+  }
+  if (sizeof(T) > 1 && fits(std::numeric_limits<int8_t>::min(),
+                            std::numeric_limits<int8_t>::max())) {
+    Narrow<T, int8_t>(x, n, bytes);
+    return Codec::kNarrow8;
+  }
+  if (sizeof(T) > 2 && fits(std::numeric_limits<int16_t>::min(),
+                            std::numeric_limits<int16_t>::max())) {
+    Narrow<T, int16_t>(x, n, bytes);
+    return Codec::kNarrow16;
+  }
+  if (sizeof(T) > 4 && fits(std::numeric_limits<int32_t>::min(),
+                            std::numeric_limits<int32_t>::max())) {
+    Narrow<T, int32_t>(x, n, bytes);
+    return Codec::kNarrow32;
+  }
+  return Codec::kNone;
+}
+
+template <typename T>
+void DecodeInteger(Codec codec,
+                   const std::vector<uint8_t>& bytes,
+                   int64_t n,
+                   T* x) {
+  switch (codec) {
+    case Codec::kBitPack:
+      BitUnpack(bytes, n, x);
+      break;
+    case Codec::kNarrow8:
+      Widen<T, int8_t>(bytes, n, x);
+      break;
+    case Codec::kNarrow16:
+      Widen<T, int16_t>(bytes, n, x);
+      break;
+    case Codec::kNarrow32:
+      Widen<T, int32_t>(bytes, n, x);
+      break;
+    default:
+      PADDLE_THROW(paddle::platform::errors::Fatal(
+          "Unexpected codec of a saved integer tensor."));
+  }
+}
+
+// Whether a codec may make the tensor smaller. Strided views are kept as they
+// are, the codecs reading the elements as contiguous.
+bool MayEncode(const phi::DenseTensor& tensor,
+               const SavedTensorsCompressionOptions& options) {
+  if (!tensor.is_contiguous()) {
+    return false;
+  }
+  switch (tensor.dtype()) {
+    case phi::DataType::BOOL:
+    case phi::DataType::UINT8:
+    case phi::DataType::INT8:
+    case phi::DataType::INT16:
+    case phi::DataType::INT32:
+    case phi::DataType::INT64:
+      return true;
+    case phi::DataType::FLOAT32:
+      return options.float_to_bfloat16 &&
+             tensor.numel() >= options.min_float_numel;
+    default:
+      return false;
+  }
+}
+
+// A contiguous copy of the tensor, for the worker to encode while forward
+// may write the tensor in place.
+std::shared_ptr<phi::DenseTensor> Snapshot(const phi::DenseTensor& tensor) {
+  auto snapshot = std::make_shared<phi::DenseTensor>();
+  phi::DenseTensorMeta meta = tensor.meta();
+  meta.offset = 0;
+  snapshot->set_meta(meta);
+  void* data = snapshot->mutable_data(phi::CPUPlace(), meta.dtype);
+  std::memcpy(data, tensor.data(), TensorBytes(tensor));
+  return snapshot;
+}
+
+Codec Encode(const phi::DenseTensor& tensor,
+             const SavedTensorsCompressionOptions& options,
+             std::vector<uint8_t>* bytes) {
+  const int64_t n = tensor.numel();
+  switch (tensor.dtype()) {
+    case phi::DataType::BOOL:
+      BitPack(tensor.data<bool>(), n, bytes);
+      return Codec::kBitPack;
+    case phi::DataType::UINT8:
+      return EncodeInteger(tensor.data<uint8_t>(), n, bytes);
+    case phi::DataType::INT8:
+      return EncodeInteger(tensor.data<int8_t>(), n, bytes);
+    case phi::DataType::INT16:
+      return EncodeInteger(tensor.data<int16_t>(), n, bytes);
+    case phi::DataType::INT32:
+      return EncodeInteger(tensor.data<int32_t>(), n, bytes);
+    case phi::DataType::INT64:
+      return EncodeInteger(tensor.data<int64_t>(), n, bytes);
+    case phi::DataType::FLOAT32:
+      if (options.float_to_bfloat16 && n >= options.min_float_numel) {
+        Narrow<float, phi::dtype::bfloat16>(tensor.data<float>(), n, bytes);
+        return Codec::kBF16;
+      }
+      return Codec::kNone;
+    default:
+      return Codec::kNone;
+  }
+}
+
+std::shared_ptr<phi::DenseTensor> Decode(const phi::DenseTensorMeta& meta,
+                                         Codec codec,
+                                         const std::vector<uint8_t>& bytes) {
+  auto tensor = std::make_shared<phi::DenseTensor>();
+  phi::DenseTensorMeta decoded_meta = meta;
+  decoded_meta.offset = 0;
+  tensor->set_meta(decoded_meta);
+  void* data = tensor->mutable_data(phi::CPUPlace(), meta.dtype);
+  const int64_t n = tensor->numel();
+  switch (meta.dtype) {
+    case phi::DataType::BOOL:
+      BitUnpack(bytes, n, static_cast<bool*>(data));
+      break;
+    case phi::DataType::UINT8:
+      DecodeInteger(codec, bytes, n, static_cast<uint8_t*>(data));
+      break;
+    case phi::DataType::INT8:
+      DecodeInteger(codec, bytes, n, static_cast<int8_t*>(data));
+      break;
+    case phi::DataType::INT16:
+      DecodeInteger(codec, bytes, n, static_cast<int16_t*>(data));
+      break;
+    case phi::DataType::INT32:
+      DecodeInteger(codec, bytes, n, static_cast<int32_t*>(data));
+      break;
+    case phi::DataType::INT64:
+      DecodeInteger(codec, bytes, n, static_cast<int64_t*>(data));
+      break;
+    case phi::DataType::FLOAT32:
+      Widen<float, phi::dtype::bfloat16>(bytes, n, static_cast<float*>(data));
+      break;
+    default:
+      PADDLE_THROW(paddle::platform::errors::Fatal(
+          "Unexpected data type %s of a compressed saved tensor.",
+          meta.dtype));
+  }
+  return tensor;
+}
+
+}  // namespace
+
+CompressedTensorHolder::CompressedTensorHolder(
+    uint64_t id,
+    const paddle::Tensor& tensor,
+    const std::shared_ptr<SavedTensorsCompressionContext>& context)
+    : id_(id), context_(context), raw_(tensor.impl()) {
+  auto* dense_tensor = static_cast<phi::DenseTensor*>(tensor.impl().get());
+  meta_ = dense_tensor->meta();
+  original_bytes_ = TensorBytes(*dense_tensor);
+  version_.ShareInplaceVersionCounterWith(*dense_tensor);
+  inplace_version_ = version_.InplaceVersionCounter().CurrentVersion();
+  context->UpdateBytes(original_bytes_, original_bytes_);
+}
+
+CompressedTensorHolder::~CompressedTensorHolder() {
+  if (auto context = context_.lock()) {
+    context->UpdateBytes(-original_bytes_, -StoredBytes());
+    context->Forget(id_);
+  }
+}
+
+int64_t CompressedTensorHolder::StoredBytes() const {
+  int64_t stored = codec_ == Codec::kNone
+                       ? original_bytes_
+                       : static_cast<int64_t>(bytes_.size());
+  if (prefetched_) {
+    stored += original_bytes_;
+  }
+  return stored;
+}
+
+void CompressedTensorHolder::Compress(
+    const std::shared_ptr<phi::DenseTensor>& snapshot) {
+  auto context = context_.lock();
+  if (!context) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!raw_.initialized()) {
+    return;
+  }
+  std::vector<uint8_t> bytes;
+  const phi::DenseTensor* dense_tensor =
+      snapshot ? snapshot.get()
+               : static_cast<phi::DenseTensor*>(raw_.impl().get());
+  Codec codec = Encode(*dense_tensor, context->options(), &bytes);
+  if (codec == Codec::kNone ||
+      static_cast<int64_t>(bytes.size()) >= original_bytes_) {
+    return;
+  }
+  const int64_t stored = StoredBytes();
+  codec_ = codec;
+  bytes_ = std::move(bytes);
+  raw_.reset();
+  context->UpdateBytes(0, StoredBytes() - stored);
+}
+
+void CompressedTensorHolder::Prefetch() {
+  auto context = context_.lock();
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (codec_ == Codec::kNone || prefetched_) {
+    return;
+  }
+  prefetched_ = Decode(meta_, codec_, bytes_);
+  if (context) {
+    context->UpdateBytes(0, original_bytes_);
+  }
+}
+
+paddle::Tensor CompressedTensorHolder::Unpack() {
+  auto context = context_.lock();
+  // Also reported once the tensor is compressed, the counter outlives it.
+  const uint32_t version = version_.InplaceVersionCounter().CurrentVersion();
+  PADDLE_ENFORCE_EQ(
+      version,
+      inplace_version_,
+      paddle::platform::errors::PermissionDenied(
+          "A tensor used in gradient computation has been modified by an "
+          "inplace operation. Its version is %d but the expected version "
+          "is %d.",
+          version,
+          inplace_version_));
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::shared_ptr<phi::DenseTensor> tensor;
+  if (codec_ == Codec::kNone) {
+    // TensorWrapper takes the holder of the returned tensor, so share it
+    // rather than handing out the saved tensor itself.
+    tensor = std::make_shared<phi::DenseTensor>();
+    tensor->ShareDataWith(*static_cast<phi::DenseTensor*>(raw_.impl().get()));
+  } else if (prefetched_) {
+    tensor = std::move(prefetched_);
+    prefetched_.reset();
+    if (context) {
+      context->UpdateBytes(0, -original_bytes_);
+    }
+  } else {
+    tensor = Decode(meta_, codec_, bytes_);
+  }
+  return paddle::Tensor(tensor);
+}
+
+SavedTensorsCompressionContext::SavedTensorsCompressionContext(
+    const SavedTensorsCompressionOptions& options)
+    : options_(options) {
+  if (options_.async) {
+    worker_.reset(new phi::ThreadPool(1));
+  }
+}
+
+SavedTensorsCompressionContext::~SavedTensorsCompressionContext() {
+  // Joins the worker, which may still hold holders.
+  worker_.reset();
+}
+
+SavedTensorsCompressionStats SavedTensorsCompressionContext::stats() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  SavedTensorsCompressionStats stats;
+  stats.original_bytes = original_bytes_;
+  stats.stored_bytes = stored_bytes_;
+  stats.peak_stored_bytes = peak_stored_bytes_;
+  return stats;
+}
+
+void SavedTensorsCompressionContext::ResetPeak() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  peak_stored_bytes_ = stored_bytes_;
+}
+
+void SavedTensorsCompressionContext::UpdateBytes(int64_t original_delta,
+                                                 int64_t stored_delta) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  original_bytes_ += original_delta;
+  stored_bytes_ += stored_delta;
+  peak_stored_bytes_ = std::max(peak_stored_bytes_, stored_bytes_);
+}
+
+void SavedTensorsCompressionContext::Forget(uint64_t id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  holders_.erase(id);
+}
+
+std::shared_ptr<CompressedTensorHolder> SavedTensorsCompressionContext::Pack(
+    const paddle::Tensor& tensor) {
+  uint64_t id;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    id = next_id_++;
+  }
+  auto holder = std::make_shared<CompressedTensorHolder>(
+      id, tensor, shared_from_this());
+  const auto& dense_tensor =
+      *static_cast<phi::DenseTensor*>(tensor.impl().get());
+  if (!tensor.is_cpu() || !MayEncode(dense_tensor, options_)) {
+    return holder;
+  }
+  if (worker_) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      holders_[id] = holder;
+    }
+    // The snapshot is stored bytes too until the worker has encoded it. The
+    // worker does not outlive the context, which joins it.
+    auto snapshot = Snapshot(dense_tensor);
+    const int64_t snapshot_bytes = TensorBytes(*snapshot);
+    UpdateBytes(0, snapshot_bytes);
+    worker_->Run([this, holder, snapshot, snapshot_bytes] {
+      holder->Compress(snapshot);
+      UpdateBytes(0, -snapshot_bytes);
+    });
+  } else {
+    holder->Compress();
+  }
+  return holder;
+}
+
+paddle::Tensor SavedTensorsCompressionContext::Unpack(
+    CompressedTensorHolder* holder) {
+  if (worker_) {
+    Prefetch(holder->id());
+  }
+  return holder->Unpack();
+}
+
+void SavedTensorsCompressionContext::Prefetch(uint64_t id) {
+  // Backward mostly runs the ops in reverse, so the tensors needed next are
+  // the ones saved just before this one.
+  std::vector<std::shared_ptr<CompressedTensorHolder>> next;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = holders_.lower_bound(id);
+    while (it != holders_.begin() &&
+           static_cast<int>(next.size()) < options_.prefetch_depth) {
+      --it;
+      if (auto holder = it->second.lock()) {
+        next.push_back(std::move(holder));
+      }
+    }
+    // Already prefetched or taken, either way not to be prefetched again.
+    holders_.erase(holders_.lower_bound(id), holders_.end());
+    for (auto& holder : next) {
+      holders_.erase(holder->id());
+    }
+  }
+  for (auto& holder : next) {
+    worker_->Run([holder] { holder->Prefetch(); });
+  }
+}
+
+std::shared_ptr<PyObjectHolderBase> CompressPackHook::operator()(
+    const paddle::Tensor& tensor) {
+  return context_->Pack(tensor);
+}
+
+void* CompressPackHook::operator()(void* py_tensor UNUSED) {
+  PADDLE_THROW(paddle::platform::errors::Unimplemented(
+      "The compressing saved tensors hooks do not pack Python objects."));
+}
+
+paddle::Tensor DecompressUnPackHook::operator()(
+    std::shared_ptr<PyObjectHolderBase> packed_value) {
+  auto* holder = dynamic_cast<CompressedTensorHolder*>(packed_value.get());
+  PADDLE_ENFORCE_NOT_NULL(
+      holder,
+      paddle::platform::errors::InvalidArgument(
+          "The value to unpack was not packed by the compressing saved "
+          "tensors hooks."));
+  return context_->Unpack(holder);
+}
+
+void* DecompressUnPackHook::operator()(void* packed_value UNUSED,
+                                       void* other UNUSED) {
+  PADDLE_THROW(paddle::platform::errors::Unimplemented(
+      "The compressing saved tensors hooks do not unpack Python objects."));
+}
+
+std::shared_ptr<SavedTensorsCompressionContext> EnableSavedTensorsCompression(
+    const SavedTensorsCompressionOptions& options) {
+  auto context = std::make_shared<SavedTensorsCompressionContext>(options);
+  SavedTensorsHooks::GetInstance().SetNativeHooks(
+      std::make_shared<CompressPackHook>(context),
+      std::make_shared<DecompressUnPackHook>(context));
+  return context;
+}
+
+void DisableSavedTensorsCompression() {
+  SavedTensorsHooks::GetInstance().ResetHooks();
+}
+
+}  // namespace egr
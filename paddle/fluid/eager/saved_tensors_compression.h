@@ -0,0 +1,176 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "paddle/fluid/eager/hooks.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/macros.h"
+#include "paddle/phi/core/threadpool.h"
+
+namespace egr {
+
+struct SavedTensorsCompressionOptions {
+  // Saves the float32 tensors of at least min_float_numel elements as
+  // bfloat16, which is lossy. Bool and integer tensors are always compressed
+  // losslessly.
+  bool float_to_bfloat16 = false;
+  int64_t min_float_numel = 4096;
+  // Compresses on a background thread instead of in the forward op. Each
+  // unpack then decompresses ahead the prefetch_depth tensors saved before
+  // the unpacked one, the next ones that backward is going to need.
+  bool async = false;
+  int prefetch_depth = 2;
+};
+
+// Bytes of the saved tensors that are alive, as saved by the forward ops and
+// as kept by the hooks.
+struct SavedTensorsCompressionStats {
+  int64_t original_bytes = 0;
+  int64_t stored_bytes = 0;
+  int64_t peak_stored_bytes = 0;
+};
+
+class CompressedTensorHolder;
+
+// State shared by the pack and unpack hooks: the options, the byte counters,
+// the background thread and the holders that may be prefetched.
+class SavedTensorsCompressionContext
+    : public std::enable_shared_from_this<SavedTensorsCompressionContext> {
+ public:
+  explicit SavedTensorsCompressionContext(
+      const SavedTensorsCompressionOptions& options);
+  ~SavedTensorsCompressionContext();
+
+  const SavedTensorsCompressionOptions& options() const { return options_; }
+
+  SavedTensorsCompressionStats stats();
+  void ResetPeak();
+
+  std::shared_ptr<CompressedTensorHolder> Pack(const paddle::Tensor& tensor);
+  paddle::Tensor Unpack(CompressedTensorHolder* holder);
+
+  // Called by the holders.
+  void UpdateBytes(int64_t original_delta, int64_t stored_delta);
+  void Forget(uint64_t id);
+
+ private:
+  void Prefetch(uint64_t id);
+
+  SavedTensorsCompressionOptions options_;
+
+  std::mutex mutex_;
+  int64_t original_bytes_{0};
+  int64_t stored_bytes_{0};
+  int64_t peak_stored_bytes_{0};
+  uint64_t next_id_{0};
+  // The holders still packed in async mode, in pack order.
+  std::map<uint64_t, std::weak_ptr<CompressedTensorHolder>> holders_;
+
+  std::unique_ptr<phi::ThreadPool> worker_;
+};
+
+// A saved tensor as kept by the compressing hooks: the tensor itself until
+// it is compressed, then its encoded bytes, plus the decompressed tensor
+// between a prefetch and the unpack that takes it.
+class CompressedTensorHolder : public PyObjectHolderBase {
+ public:
+  enum class Codec { kNone, kBitPack, kNarrow8, kNarrow16, kNarrow32, kBF16 };
+
+  CompressedTensorHolder(
+      uint64_t id,
+      const paddle::Tensor& tensor,
+      const std::shared_ptr<SavedTensorsCompressionContext>& context);
+  ~CompressedTensorHolder() override;
+
+  // The holder is owned through std::shared_ptr, so there is no reference to
+  // count by hand.
+  void* get() override { return this; }
+  void reset(void* ptr UNUSED) override {}
+  void inc_ref() override {}
+  void dec_ref() override {}
+
+  uint64_t id() const { return id_; }
+
+  // Encodes the tensor if it is still raw, from its snapshot if given, which
+  // the worker thread reads instead of the tensor forward may write in place.
+  // Tensors that no codec makes smaller are kept as they are.
+  void Compress(const std::shared_ptr<phi::DenseTensor>& snapshot = nullptr);
+  // Decodes into the prefetch slot if the tensor is encoded.
+  void Prefetch();
+  paddle::Tensor Unpack();
+
+ private:
+  int64_t StoredBytes() const;
+
+  const uint64_t id_;
+  std::weak_ptr<SavedTensorsCompressionContext> context_;
+  std::mutex mutex_;
+  phi::DenseTensorMeta meta_;
+  int64_t original_bytes_{0};
+  // The inplace version of the tensor when it was saved, and an empty tensor
+  // sharing its counter. Only forward and backward read the counter, the
+  // worker thread does not.
+  uint32_t inplace_version_{0};
+  phi::DenseTensor version_;
+  // The saved tensor without its autograd meta, as TensorWrapper keeps it,
+  // since the grad node of the tensor may own this holder.
+  paddle::Tensor raw_;
+  Codec codec_{Codec::kNone};
+  std::vector<uint8_t> bytes_;
+  std::shared_ptr<phi::DenseTensor> prefetched_;
+};
+
+class CompressPackHook : public PackHookBase {
+ public:
+  explicit CompressPackHook(
+      const std::shared_ptr<SavedTensorsCompressionContext>& context)
+      : context_(context) {}
+
+  std::shared_ptr<PyObjectHolderBase> operator()(
+      const paddle::Tensor& tensor) override;
+  void* operator()(void* py_tensor) override;
+
+ private:
+  std::shared_ptr<SavedTensorsCompressionContext> context_;
+};
+
+class DecompressUnPackHook : public UnPackHookBase {
+ public:
+  explicit DecompressUnPackHook(
+      const std::shared_ptr<SavedTensorsCompressionContext>& context)
+      : context_(context) {}
+
+  paddle::Tensor operator()(
+      std::shared_ptr<PyObjectHolderBase> packed_value) override;
+  void* operator()(void* packed_value, void* other) override;
+
+ private:
+  std::shared_ptr<SavedTensorsCompressionContext> context_;
+};
+
+// Installs the compressing hooks as the saved tensors hooks, and returns
+// their context to read the statistics from. Disable resets the hooks, the
+// tensors saved meanwhile stay compressed until backward.
+std::shared_ptr<SavedTensorsCompressionContext> EnableSavedTensorsCompression(
+    const SavedTensorsCompressionOptions& options);
+void DisableSavedTensorsCompression();
+
+}  // namespace egr
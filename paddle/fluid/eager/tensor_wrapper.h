@@ -63,10 +63,9 @@ class TensorWrapper {
             static_cast<phi::DenseTensor*>(tensor.impl().get());
         // TODO(jiabin): It's not a good idea to set memory size to zero, find
         // another way and change this.
-        intermidiate_tensor_.set_impl(
-            std::move(std::make_shared<phi::DenseTensor>(
-                std::make_shared<phi::Allocation>(nullptr, 0, tensor.place()),
-                std::move(dense_tensor->meta()))));
+        intermidiate_tensor_.set_impl(std::move(MakePooled<phi::DenseTensor>(
+            MakePooled<phi::Allocation>(nullptr, 0, tensor.place()),
+            std::move(dense_tensor->meta()))));
       } else {
         PADDLE_THROW(paddle::platform::errors::Fatal(
             "Unrecognized tensor type for no_need_buffer feature"));
@@ -98,8 +97,7 @@ class TensorWrapper {
     }
 
     if (tensor_autograd_meta) {
-      auto autograd_meta =
-          std::make_shared<AutogradMeta>(*tensor_autograd_meta);
+      auto autograd_meta = MakePooled<AutogradMeta>(*tensor_autograd_meta);
       autograd_meta->ResetGradNode();
       intermidiate_tensor_.set_autograd_meta(autograd_meta);
       weak_grad_node_ = tensor_autograd_meta->GetMutableGradNode();
@@ -145,8 +143,15 @@ class TensorWrapper {
       auto tensor_unpacked = (*unpack_hook_)(packed_value_);
       auto src_dense_tensor =
           static_cast<phi::DenseTensor*>(tensor_unpacked.impl().get());
-      static_cast<phi::DenseTensor*>(intermidiate_tensor_.impl().get())
-          ->ResetHolder(src_dense_tensor->MoveMemoryHolder());
+      auto* dst_dense_tensor =
+          static_cast<phi::DenseTensor*>(intermidiate_tensor_.impl().get());
+      // The unpacked tensor may lay out its data in its holder unlike the
+      // saved one, as the decompressed ones do from offset 0.
+      phi::DenseTensorMeta meta = dst_dense_tensor->meta();
+      meta.offset = src_dense_tensor->meta().offset;
+      meta.strides = src_dense_tensor->meta().strides;
+      dst_dense_tensor->set_meta(meta);
+      dst_dense_tensor->ResetHolder(src_dense_tensor->MoveMemoryHolder());
     } else {
 #endif
       check_inplace_version();
@@ -168,7 +173,7 @@ class TensorWrapper {
 
     if (intermediate_autograd_meta) {
       auto p_ab_autograd_meta =
-          std::make_shared<AutogradMeta>(*intermediate_autograd_meta);
+          MakePooled<AutogradMeta>(*intermediate_autograd_meta);
       if (new_grad_node) {
         p_ab_autograd_meta->SetGradNode(new_grad_node);
       }
@@ -17,5 +17,6 @@
 namespace egr {
 
 constexpr size_t kSlotSmallVectorSize = 15U;
+constexpr size_t kSlotMetaSmallVectorSize = 1U;
 
 }  // namespace egr
@@ -35,7 +35,7 @@ namespace egr {
 AutogradMeta* EagerUtils::autograd_meta(paddle::Tensor* target) {
   auto* p_autograd_meta = target->get_autograd_meta();
   if (!p_autograd_meta) {
-    auto p_autograd_meta_ptr = std::make_shared<AutogradMeta>();
+    auto p_autograd_meta_ptr = MakePooled<AutogradMeta>();
     p_autograd_meta = p_autograd_meta_ptr.get();
     target->set_autograd_meta(p_autograd_meta_ptr);
   }
@@ -429,7 +429,7 @@ std::shared_ptr<egr::GradNodeBase> EagerUtils::GetGradAccumulationNode(
     if (!autograd_ptr->StopGradient()) {
       VLOG(6) << "Add GradNodeAccumulation for tensor: " << tensor.name();
       autograd_ptr->SetGradNode(
-          std::make_shared<egr::GradNodeAccumulation>(autograd_ptr));
+          egr::MakePooled<egr::GradNodeAccumulation>(autograd_ptr));
       return autograd_ptr->GetMutableGradNode();
     } else {
       return nullptr;
@@ -439,7 +439,7 @@ std::shared_ptr<egr::GradNodeBase> EagerUtils::GetGradAccumulationNode(
 
 void EagerUtils::FillZeroForEmptyOptionalGradInput(
     std::vector<paddle::Tensor>* in_grads,
-    const std::vector<GradSlotMeta>& grad_in_metas) {
+    const GradSlotMetaVector& grad_in_metas) {
   for (size_t i = 0; i < in_grads->size(); i++) {
     paddle::Tensor& grad = (*in_grads)[i];
     if (!grad.initialized() && grad_in_metas[i].HasTensorMeta()) {
@@ -485,7 +485,7 @@ void EagerUtils::FillZeroForEmptyOptionalGradInput(
 
 void EagerUtils::FillZeroForEmptyGradInput(
     std::vector<paddle::Tensor>* in_grads,
-    const std::vector<GradSlotMeta>& grad_in_metas) {
+    const GradSlotMetaVector& grad_in_metas) {
   for (size_t i = 0; i < in_grads->size(); i++) {
     FillZeroForEmptyGradInput(&in_grads->at(i), grad_in_metas[i]);
   }
@@ -222,14 +222,14 @@ class EagerUtils {
    * **/
   static void FillZeroForEmptyOptionalGradInput(
       std::vector<paddle::Tensor>* in_grads,
-      const std::vector<GradSlotMeta>& grad_in_metas);
+      const GradSlotMetaVector& grad_in_metas);
   static void FillZeroForEmptyGradInput(paddle::Tensor* in_grad,
                                         const GradSlotMeta& grad_in_meta);
   static void FillZeroForEmptyOptionalGradInput(
       paddle::Tensor* in_grad, const GradSlotMeta& grad_in_meta);
   static void FillZeroForEmptyGradInput(
       std::vector<paddle::Tensor>* in_grads,
-      const std::vector<GradSlotMeta>& grad_in_metas);
+      const GradSlotMetaVector& grad_in_metas);
   /**
    * Print Input Output (level 0 means least info, level 2 means most info)
    * **/
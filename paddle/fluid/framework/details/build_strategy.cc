@@ -186,8 +186,7 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
                         "fuse_relu_depthwise_conv_pass");
     AppendPassWithCheck(strategy_.fuse_bn_act_ops_, "fuse_bn_act_pass");
     AppendPassWithCheck(strategy_.fuse_bn_add_act_ops_, "fuse_bn_add_act_pass");
-#if (defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)) && \
-    !defined(_WIN32) && !defined(__APPLE__)
+#if !defined(_WIN32) && !defined(__APPLE__)
     AppendPassWithCheck(strategy_.enable_auto_fusion_, "fusion_group_pass");
 #endif
 
@@ -459,8 +458,9 @@ ir::Graph *BuildStrategy::Apply(ir::Graph *graph,
       }
     } else if (pass->Type() == "fusion_group_pass") {
       pass->Set<bool>("use_gpu", new bool((use_device == p::kCUDA)));
-      if (use_device != p::kCUDA) {
-        VLOG(1) << "fusion_group_pass is only supported on GPU, skipped.";
+      if (use_device != p::kCUDA && use_device != p::kCPU) {
+        VLOG(1) << "fusion_group_pass is only supported on GPU and CPU, "
+                   "skipped.";
         continue;
       }
     } else if (pass->Type() == "fuse_bn_act_pass") {
@@ -545,8 +545,7 @@ USE_PASS(fused_feedforward_pass);
 #ifdef PADDLE_WITH_MKLDNN
 USE_PASS(mkldnn_placement_pass);
 #endif
-#if (defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)) && \
-    !defined(_WIN32) && !defined(__APPLE__)
+#if !defined(_WIN32) && !defined(__APPLE__)
 USE_PASS(fusion_group_pass);
 #endif
 #if (defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 11060)
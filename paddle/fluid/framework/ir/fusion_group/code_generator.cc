@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/ir/fusion_group/code_generator.h"
 
 #include "paddle/fluid/framework/ir/fusion_group/code_generator_helper.h"
+#include "paddle/fluid/framework/ir/fusion_group/cpu_resources.h"
 #include "paddle/fluid/framework/ir/fusion_group/cuda_resources.h"
 
 namespace paddle {
@@ -43,11 +44,12 @@ std::string ExtractDataType(const std::vector<Node*>& nodes) {
   return dtype_str;
 }
 
-CodeGenerator::CodeGenerator() {
+CodeGenerator::CodeGenerator(bool use_gpu) : use_gpu_(use_gpu) {
   // Only support elementwise operations now.
   code_templates_.resize(1);
 
-  CodeTemplate elementwise_t(cuda_kernel_template_1d);
+  CodeTemplate elementwise_t(use_gpu ? cuda_kernel_template_1d
+                                     : cpu_kernel_template_1d);
   code_templates_[0] = elementwise_t;
 }
 
@@ -193,6 +195,15 @@ std::string CodeGenerator::Generate(
   for (const auto& type : dtypes) {
     all_dtype.insert(type.second);
   }
+  if (!use_gpu_) {
+    PADDLE_ENFORCE_EQ(all_dtype.count("__half"),
+                      0,
+                      platform::errors::Unimplemented(
+                          "Float16 is not supported by the CPU kernel of "
+                          "fusion group %s.",
+                          func_name));
+    return predefined_cpu_functions + code_templates_[0].Format(template_var);
+  }
   std::string predefined_cuda_functions = "";
   if (all_dtype.find("float") != all_dtype.end() &&
       all_dtype.find("__half") == all_dtype.end()) {
@@ -283,6 +294,10 @@ std::string CodeGenerator::EmitParameters(
     const std::set<int>& output_ids,
     const std::set<int>& intermediate_ids,
     const std::unordered_map<int, std::string>& dtypes) const {
+  if (!use_gpu_) {
+    return EmitCPUParameters(input_ids, output_ids, intermediate_ids, dtypes);
+  }
+
   std::stringstream ret;
   ret << "int N, ";
 
@@ -313,6 +328,32 @@ std::string CodeGenerator::EmitParameters(
   return ret.str();
 }
 
+// The CPU function takes the data pointers in an array, in the order of the
+// parameters of the CUDA kernel, and unpacks them into typed pointers.
+std::string CodeGenerator::EmitCPUParameters(
+    const std::set<int>& input_ids,
+    const std::set<int>& output_ids,
+    const std::set<int>& intermediate_ids,
+    const std::unordered_map<int, std::string>& dtypes) const {
+  std::stringstream ret;
+  int index = 0;
+  for (auto id : input_ids) {
+    if (output_ids.find(id) == output_ids.end()) {
+      std::string type = "const " + dtypes.at(id) + "*";
+      ret << type << " __restrict__ " << ArgName(id) << " = static_cast<"
+          << type << ">(args[" << index++ << "]);";
+    }
+  }
+  for (auto id : output_ids) {
+    if (intermediate_ids.find(id) == intermediate_ids.end()) {
+      std::string type = dtypes.at(id) + "*";
+      ret << type << " " << ArgName(id) << " = static_cast<" << type
+          << ">(args[" << index++ << "]);";
+    }
+  }
+  return ret.str();
+}
+
 std::string CodeGenerator::EmitComputeBody(
     const std::vector<OperationExpression>& expressions,
     const std::set<int>& input_ids,
@@ -331,9 +372,14 @@ std::string CodeGenerator::EmitComputeBody(
   for (auto id : input_ids) {
     if (output_ids.find(id) == output_ids.end() &&
         used.find(id) != used.end()) {
-      load << dtypes.at(id) << " " << TmpName(id) << " = "
-           << "__ldg(&" << VarName(id) << ")"
-           << ";";
+      if (use_gpu_) {
+        load << dtypes.at(id) << " " << TmpName(id) << " = "
+             << "__ldg(&" << VarName(id) << ")"
+             << ";";
+      } else {
+        load << dtypes.at(id) << " " << TmpName(id) << " = " << VarName(id)
+             << ";";
+      }
     }
   }
   // Store temporal variables to memory.
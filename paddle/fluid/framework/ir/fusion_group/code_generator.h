@@ -32,7 +32,8 @@ class SubGraph;
 
 class CodeGenerator {
  public:
-  CodeGenerator();
+  // Generates CUDA kernels for GPU, or C++ functions for CPU.
+  explicit CodeGenerator(bool use_gpu = true);
 
   std::string Generate(std::string func_name,
                        const std::vector<OperationExpression>& expressions);
@@ -58,6 +59,12 @@ class CodeGenerator {
       const std::set<int>& intermediate_ids,
       const std::unordered_map<int, std::string>& dtypes) const;
 
+  std::string EmitCPUParameters(
+      const std::set<int>& input_ids,
+      const std::set<int>& output_ids,
+      const std::set<int>& intermediate_ids,
+      const std::unordered_map<int, std::string>& dtypes) const;
+
   std::string EmitComputeBody(
       const std::vector<OperationExpression>& expressions,
       const std::set<int>& input_ids,
@@ -69,6 +76,7 @@ class CodeGenerator {
   std::unordered_map<Node*, int> EncodeVarNodes(SubGraph* subgraph);
 
  private:
+  bool use_gpu_;
   std::vector<CodeTemplate> code_templates_;
 };
 
@@ -0,0 +1,219 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+#include "paddle/fluid/framework/ir/fusion_group/code_generator.h"
+#include "paddle/fluid/framework/ir/fusion_group/operation.h"
+#include "paddle/fluid/platform/place.h"
+#include "paddle/phi/backends/device_code.h"
+
+namespace fusion_group = paddle::framework::ir::fusion_group;
+
+namespace {
+
+template <typename T>
+T Compute(const std::string& op_type, T x, T y) {
+  if (op_type == "relu") {
+    return x > 0 ? x : 0;
+  } else if (op_type == "sigmoid") {
+    return 1.0 / (1.0 + std::exp(-x));
+  } else if (op_type == "tanh") {
+    return 2.0 / (1.0 + std::exp(-2.0 * x)) - 1.0;
+  } else if (op_type == "sqrt") {
+    return std::sqrt(x);
+  } else if (op_type == "elementwise_add") {
+    return x + y;
+  } else if (op_type == "elementwise_sub") {
+    return x - y;
+  } else if (op_type == "elementwise_mul") {
+    return x * y;
+  } else if (op_type == "elementwise_div") {
+    return x / y;
+  }
+  ADD_FAILURE() << "Unexpected op " << op_type;
+  return 0;
+}
+
+// The buffers of the vars, of n elements each.
+template <typename T>
+using Buffers = std::map<int, std::vector<T>>;
+
+std::unique_ptr<phi::CPUDeviceCode> Compile(
+    const std::string& func_name,
+    const std::vector<fusion_group::OperationExpression>& expressions) {
+  fusion_group::OperationMap::Init();
+  fusion_group::CodeGenerator code_generator(false);
+  std::string code_str = code_generator.Generate(func_name, expressions);
+  VLOG(3) << code_str;
+
+  std::unique_ptr<phi::CPUDeviceCode> device_code(new phi::CPUDeviceCode(
+      paddle::platform::CPUPlace(), func_name, code_str));
+  EXPECT_TRUE(device_code->Compile());
+  return device_code;
+}
+
+// The arguments are the inputs which are not outputs, and the outputs which
+// are not intermediate, in the order of the ids.
+template <typename T>
+void Launch(const phi::CPUDeviceCode& device_code,
+            const std::vector<fusion_group::OperationExpression>& expressions,
+            Buffers<T>* buffers,
+            size_t n) {
+  std::set<int> input_ids, output_ids, intermediate_ids;
+  for (const auto& expression : expressions) {
+    for (auto id : expression.GetInputIds()) {
+      if (id >= 0) {
+        input_ids.insert(id);
+      }
+    }
+    for (auto id : expression.GetOutputIds()) {
+      output_ids.insert(id);
+    }
+    for (auto id : expression.GetIntermediateOutputIds()) {
+      intermediate_ids.insert(id);
+    }
+  }
+  std::vector<void*> ptrs;
+  for (auto id : input_ids) {
+    if (output_ids.count(id) == 0) {
+      ptrs.push_back((*buffers)[id].data());
+    }
+  }
+  for (auto id : output_ids) {
+    if (intermediate_ids.count(id) == 0) {
+      (*buffers)[id].resize(n);
+      ptrs.push_back((*buffers)[id].data());
+    }
+  }
+  std::vector<void*> args;
+  args.push_back(&n);
+  for (auto& ptr : ptrs) {
+    args.push_back(&ptr);
+  }
+  device_code.Launch(n, &args);
+}
+
+template <typename T>
+void SetupRandomBuffers(const std::vector<int>& input_ids,
+                        size_t n,
+                        Buffers<T>* buffers) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<double> uniform_dist(-0.5, 0.5);
+  for (auto id : input_ids) {
+    auto& buffer = (*buffers)[id];
+    buffer.resize(n);
+    for (auto& value : buffer) {
+      value = static_cast<T>(uniform_dist(rng));
+    }
+  }
+}
+
+template <typename T>
+void CheckOutput(
+    const std::vector<fusion_group::OperationExpression>& expressions,
+    const Buffers<T>& buffers,
+    const std::vector<int>& output_ids,
+    size_t n,
+    double eps) {
+  for (size_t i = 0; i < n; ++i) {
+    std::map<int, T> var;
+    for (const auto& kv : buffers) {
+      var[kv.first] = kv.second[i];
+    }
+    for (const auto& expression : expressions) {
+      auto input_ids = expression.GetInputIds();
+      T x = var[input_ids[0]];
+      T y = input_ids.size() > 1 ? var[input_ids[1]] : 0;
+      var[expression.GetOutputIds()[0]] =
+          Compute<T>(expression.GetOpType(), x, y);
+    }
+    for (auto id : output_ids) {
+      T actual = buffers.at(id)[i];
+      T expect = var[id];
+      ASSERT_NEAR(actual, expect, eps * std::max<T>(1, std::fabs(expect)))
+          << "var " << id << ", element " << i;
+    }
+  }
+}
+
+template <typename T>
+void TestElementwise(const std::string& dtype) {
+  // t2 = t0 * t1
+  // t4 = t2 + t3
+  // t6 = t4 - t5
+  // t7 = relu(t6)
+  // t8 = sigmoid(t7)
+  // t10 = tanh(t8)
+  // t9 = t10 / t1
+  std::vector<fusion_group::OperationExpression> expressions = {
+      fusion_group::OperationExpression(
+          "elementwise_mul", {0, 1}, {2}, dtype, dtype),
+      fusion_group::OperationExpression(
+          "elementwise_add", {2, 3}, {4}, dtype, dtype),
+      fusion_group::OperationExpression(
+          "elementwise_sub", {4, 5}, {6}, dtype, dtype),
+      fusion_group::OperationExpression("relu", {6}, {7}, dtype, dtype),
+      fusion_group::OperationExpression("sigmoid", {7}, {8}, dtype, dtype),
+      fusion_group::OperationExpression("tanh", {8}, {10}, dtype, dtype),
+      fusion_group::OperationExpression(
+          "elementwise_div", {10, 1}, {9}, dtype, dtype)};
+  auto device_code = Compile("cpu_elementwise_" + dtype, expressions);
+
+  // Not a multiple of the vector width, and large enough to be split among
+  // the threads.
+  size_t n = 256 * 1024 + 7;
+  Buffers<T> buffers;
+  SetupRandomBuffers<T>({0, 1, 3, 5}, n, &buffers);
+  Launch(*device_code, expressions, &buffers, n);
+  CheckOutput(expressions, buffers, {2, 4, 6, 7, 8, 9, 10}, n, 1e-5);
+}
+
+}  // namespace
+
+TEST(code_generator_cpu, elementwise) {
+  TestElementwise<float>("float");
+  TestElementwise<double>("double");
+}
+
+TEST(code_generator_cpu, elementwise_intermediate_out) {
+  // t2 = sqrt(t0 * t0 + t1), where t0 * t0 and the sum are not saved.
+  std::string dtype = "float";
+  std::vector<fusion_group::OperationExpression> expressions = {
+      fusion_group::OperationExpression(
+          "elementwise_mul", {0, 0}, {3}, dtype, dtype, {3}),
+      fusion_group::OperationExpression(
+          "elementwise_add", {3, 1}, {4}, dtype, dtype, {4}),
+      fusion_group::OperationExpression("sqrt", {4}, {2}, dtype, dtype)};
+  auto device_code = Compile("cpu_elementwise_intermediate", expressions);
+
+  size_t n = 1000;
+  Buffers<float> buffers;
+  SetupRandomBuffers<float>({0}, n, &buffers);
+  buffers[1].assign(n, 1.0f);
+  Launch(*device_code, expressions, &buffers, n);
+  EXPECT_EQ(buffers.count(3), 0U);
+  EXPECT_EQ(buffers.count(4), 0U);
+  for (size_t i = 0; i < n; ++i) {
+    float x = buffers[0][i];
+    ASSERT_NEAR(buffers[2][i], std::sqrt(x * x + 1.0f), 1e-6);
+  }
+}
@@ -0,0 +1,67 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+namespace paddle {
+namespace framework {
+namespace ir {
+namespace fusion_group {
+
+static constexpr char predefined_cpu_functions[] = R"(
+#include <cmath>
+#include <cstdint>
+
+// The vector variants in libmvec, so that the loops calling them are
+// vectorized. math.h only declares them under -ffast-math.
+#if defined(PADDLE_WITH_LIBMVEC) && defined(__GNUC__) && !defined(__clang__)
+extern "C" {
+__attribute__((simd("notinbranch"))) float expf(float);
+__attribute__((simd("notinbranch"))) float logf(float);
+__attribute__((simd("notinbranch"))) double exp(double);
+__attribute__((simd("notinbranch"))) double log(double);
+}
+#endif
+
+static inline float Max(float x, float y) { return x > y ? x : y; }
+static inline float Exp(float x) { return expf(x); }
+static inline float Log(float x) { return logf(x); }
+static inline float Sqrt(float x) { return std::sqrt(x); }
+
+static inline double Max(double x, double y) { return x > y ? x : y; }
+static inline double Exp(double x) { return exp(x); }
+static inline double Log(double x) { return log(x); }
+static inline double Sqrt(double x) { return std::sqrt(x); }
+
+)";
+
+// Computes the elements [begin, end), the threads are managed by
+// CPUDeviceCode. The loop has no branch nor aliasing, so that the compiler
+// vectorizes it.
+static constexpr char cpu_kernel_template_1d[] = R"(
+extern "C" void $func_name(int64_t begin, int64_t end, void** args) {
+  $parameters
+#pragma omp simd
+  for(int64_t idx = begin;
+      idx < end;
+      ++idx) {
+    $compute_body
+  }
+}
+)";
+
+}  // namespace fusion_group
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
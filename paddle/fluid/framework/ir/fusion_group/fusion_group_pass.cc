@@ -30,28 +30,52 @@ namespace ir {
 
 class Node;
 
+static platform::Place GetFusionGroupPlace(bool use_gpu) {
+  // TODO(liuyiqun): supported different places
+  if (use_gpu) {
+    return platform::CUDAPlace(0);
+  }
+  return platform::CPUPlace();
+}
+
+// The CPU kernels are compiled from C++, which has no float16.
+static bool HasFP16Var(const fusion_group::SubGraph& subgraph) {
+  for (auto* n : subgraph.Nodes()) {
+    if (n && n->IsVar() && n->Var() &&
+        n->Var()->GetDataType() == proto::VarType::FP16) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void FusionGroupPass::ApplyImpl(ir::Graph* graph) const {
   FusePassBase::Init("fusion_group_pass", graph);
-  if (Get<bool>("use_gpu")) {
-    // TODO(liuyiqun): open this check.
-    // if (!phi::GPUDeviceCode::IsAvailable()) {
-    //   LOG(WARNING)
-    //       << "Disable fusion_group because CUDA Driver or NVRTC is not
-    //       avaiable.";
-    //   return 0;
-    // }
-
-    fusion_group::OperationMap::Init();
-    int num_elementwise_groups = DetectFusionGroup(graph, 0);
-    AddStatis(num_elementwise_groups);
-    LOG(INFO) << "Detect " << num_elementwise_groups
-              << " elementwise fusion groups.";
+  bool use_gpu = Get<bool>("use_gpu");
+  // TODO(liuyiqun): open this check.
+  // if (use_gpu && !phi::GPUDeviceCode::IsAvailable()) {
+  //   LOG(WARNING)
+  //       << "Disable fusion_group because CUDA Driver or NVRTC is not
+  //       avaiable.";
+  //   return 0;
+  // }
+  if (!use_gpu && !phi::CPUDeviceCode::IsAvailable()) {
+    LOG(WARNING) << "Disable fusion_group because the host compiler is not "
+                    "available.";
+    return;
   }
+
+  fusion_group::OperationMap::Init();
+  int num_elementwise_groups = DetectFusionGroup(graph, use_gpu, 0);
+  AddStatis(num_elementwise_groups);
+  LOG(INFO) << "Detect " << num_elementwise_groups
+            << " elementwise fusion groups.";
 }
 
-int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
-  // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
+int FusionGroupPass::DetectFusionGroup(Graph* graph,
+                                       bool use_gpu,
+                                       int type) const {
+  platform::Place place = GetFusionGroupPlace(use_gpu);
   int index = phi::DeviceCodePool::Init({place}).size(place);
 
   std::vector<std::vector<Node*>> subgraphs =
@@ -68,9 +92,13 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
         std::unordered_set<Node*>(vec.begin(), vec.end()));
     VLOG(3) << "subgraph: {\n" << DebugString(subgraph.SortedNodes()) << "}\n";
 
+    if (!use_gpu && HasFP16Var(subgraph)) {
+      VLOG(2) << "Skip the subgraph of float16 on CPU.";
+      continue;
+    }
     if (subgraph.IsValid(min_subgraph_size)) {
       subgraph.SetFuncName("fused_elementwise_" + std::to_string(index++));
-      if (GenerateCode(&subgraph)) {
+      if (GenerateCode(&subgraph, use_gpu)) {
         InsertFusionGroupOp(graph, &subgraph);
         num_subgraphs++;
       }
@@ -79,15 +107,25 @@ int FusionGroupPass::DetectFusionGroup(Graph* graph, int type) const {
   return num_subgraphs;
 }
 
-bool FusionGroupPass::GenerateCode(fusion_group::SubGraph* subgraph) const {
-  fusion_group::CodeGenerator code_generator;
+bool FusionGroupPass::GenerateCode(fusion_group::SubGraph* subgraph,
+                                   bool use_gpu) const {
+  fusion_group::CodeGenerator code_generator(use_gpu);
   std::string code_str = code_generator.Generate(subgraph);
   VLOG(4) << code_str;
 
-  // TODO(liuyiqun): supported different places
-  platform::CUDAPlace place = platform::CUDAPlace(0);
-  std::unique_ptr<phi::GPUDeviceCode> device_code(
-      new phi::GPUDeviceCode(place, subgraph->GetFuncName(), code_str));
+  platform::Place place = GetFusionGroupPlace(use_gpu);
+  std::unique_ptr<phi::DeviceCode> device_code;
+  if (use_gpu) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    device_code.reset(
+        new phi::GPUDeviceCode(place, subgraph->GetFuncName(), code_str));
+#else
+    return false;
+#endif
+  } else {
+    device_code.reset(
+        new phi::CPUDeviceCode(place, subgraph->GetFuncName(), code_str));
+  }
   bool is_compiled = device_code->Compile();
   if (is_compiled) {
     phi::DeviceCodePool& pool = phi::DeviceCodePool::Init({place});
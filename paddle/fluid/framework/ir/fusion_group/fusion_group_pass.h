@@ -35,8 +35,8 @@ class FusionGroupPass : public FusePassBase {
   void ApplyImpl(Graph* graph) const override;
 
  private:
-  int DetectFusionGroup(Graph* graph, int type = 0) const;
-  bool GenerateCode(fusion_group::SubGraph* subgraph) const;
+  int DetectFusionGroup(Graph* graph, bool use_gpu, int type = 0) const;
+  bool GenerateCode(fusion_group::SubGraph* subgraph, bool use_gpu) const;
   void InsertFusionGroupOp(Graph* graph,
                            fusion_group::SubGraph* subgraph) const;
 
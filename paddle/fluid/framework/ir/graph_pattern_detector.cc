@@ -14,6 +14,9 @@
 
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "paddle/fluid/framework/ir/graph_traits.h"
 #include "paddle/fluid/framework/ir/graph_viz_pass.h"
 #include "paddle/fluid/framework/operator.h"
@@ -109,15 +112,44 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
   if (graph.Nodes().empty()) return false;
 
+  // Index the PDNodes by the op types they are restricted to, so that a graph
+  // node only runs the tellers of the PDNodes it can possibly match. Most
+  // patterns pin every op PDNode to one or a few op types, which turns the
+  // marking from |nodes| x |pdnodes| teller calls into roughly one per node.
+  std::unordered_map<std::string, std::vector<PDNode *>> op_type2pdnodes;
+  std::vector<PDNode *> generic_pdnodes;
+  for (const auto &pdnode : pattern_.nodes()) {
+    auto *op_types = pdnode->candidate_op_types();
+    if (op_types == nullptr) {
+      generic_pdnodes.push_back(pdnode.get());
+      continue;
+    }
+    for (const auto &op_type : *op_types) {
+      op_type2pdnodes[op_type].push_back(pdnode.get());
+    }
+  }
+
+  auto mark = [&](PDNode *pdnode, Node *node) {
+    if (pdnode->Tell(node)) {
+      VLOG(4) << "Node " << node->Name() << "(" << node->id() << ")"
+              << " marked as " << pdnode->name();
+      pdnodes2nodes_[pdnode].insert(node);
+    }
+  };
+
   for (auto &node : GraphTraits::DFS(graph)) {
     if (node.Name().rfind("__control_var") == 0) continue;
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
-        VLOG(4) << "Node " << node.Name() << "(" << node.id() << ")"
-                << " marked as " << pdnode->name();
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+    if (node.IsOp() && node.Op() && !op_type2pdnodes.empty()) {
+      auto it = op_type2pdnodes.find(node.Op()->Type());
+      if (it != op_type2pdnodes.end()) {
+        for (auto *pdnode : it->second) {
+          mark(pdnode, &node);
+        }
       }
     }
+    for (auto *pdnode : generic_pdnodes) {
+      mark(pdnode, &node);
+    }
   }
   // Check to early stop if some PDNode can't find matched Node.
   for (auto &pdnode : pattern_.nodes()) {
@@ -190,16 +222,6 @@ struct HitGroup {
   std::set<Node *> nodes_;
 };
 
-// Tell whether Node a links to b.
-bool IsNodesLink(Node *a, Node *b) {
-  for (auto *node : a->outputs) {
-    if (b == node) {
-      return true;
-    }
-  }
-  return false;
-}
-
 std::vector<GraphPatternDetector::subgraph_t>
 GraphPatternDetector::DetectPatterns() {
   // Init empty subgraphs.
@@ -209,6 +231,16 @@ GraphPatternDetector::DetectPatterns() {
   auto *first_pnode = pattern_.edges().empty() ? pattern().nodes().front().get()
                                                : pattern_.edges().front().first;
   if (!pdnodes2nodes_.count(first_pnode)) return result;
+  // Every PDNode on an edge must be matched, stop early if one of them has no
+  // candidate at all.
+  for (const auto &edge : pattern_.edges()) {
+    if (!pdnodes2nodes_.count(edge.first) ||
+        !pdnodes2nodes_.count(edge.second)) {
+      VLOG(4) << "edge " << edge.first->name() << " -> "
+              << edge.second->name() << " has no candidate, early stop";
+      return result;
+    }
+  }
   for (auto *node : pdnodes2nodes_[first_pnode]) {
     HitGroup group;
     group.roles[first_pnode] = node;
@@ -229,23 +261,67 @@ GraphPatternDetector::DetectPatterns() {
     auto &cur_groups = bi_records[1 - (step++ % 2)];
     cur_groups.clear();
     if (pre_groups.empty()) break;
+
+    // Index the groups by the node they already bind to edge.first. A source
+    // can only extend the groups bound to itself and the groups that have not
+    // bound edge.first yet.
+    std::unordered_map<Node *, std::vector<size_t>> bound_groups;
+    std::vector<size_t> unbound_groups;
+    for (size_t i = 0; i < pre_groups.size(); ++i) {
+      auto it = pre_groups[i].roles.find(edge.first);
+      if (it == pre_groups[i].roles.end()) {
+        unbound_groups.push_back(i);
+      } else {
+        bound_groups[it->second].push_back(i);
+      }
+    }
+
+    const auto &targets = pdnodes2nodes_[edge.second];
+    std::vector<size_t> candidate_groups;
+    std::vector<Node *> linked_targets;
     // source -> target
     for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
+      // Only the outputs of source can be linked targets, visit them in the
+      // same (node id) order as the marked candidates.
+      linked_targets.clear();
+      for (auto *target : source->outputs) {
+        if (targets.count(target)) {
+          linked_targets.push_back(target);
+        }
+      }
+      if (linked_targets.empty()) continue;
+      std::sort(linked_targets.begin(), linked_targets.end(), NodeIdCompare());
+      linked_targets.erase(
+          std::unique(linked_targets.begin(), linked_targets.end()),
+          linked_targets.end());
+
+      // Keep the groups in their original order.
+      candidate_groups.clear();
+      auto bound_it = bound_groups.find(source);
+      if (bound_it == bound_groups.end()) {
+        candidate_groups = unbound_groups;
+      } else {
+        std::merge(bound_it->second.begin(),
+                   bound_it->second.end(),
+                   unbound_groups.begin(),
+                   unbound_groups.end(),
+                   std::back_inserter(candidate_groups));
+      }
+      if (candidate_groups.empty()) continue;
+
+      for (Node *target : linked_targets) {
         VLOG(8) << "check " << source->Name() << "(" << source->id() << ")"
                 << " -- " << target->Name() << "(" << target->id() << ")";
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
-            }
+        for (size_t group_idx : candidate_groups) {
+          const auto &group = pre_groups[group_idx];
+          HitGroup new_group = group;
+          bool flag = new_group.Match(source, edge.first) &&
+                      new_group.Match(target, edge.second);
+          if (flag) {
+            new_group.Register(source, edge.first);
+            new_group.Register(target, edge.second);
+            cur_groups.push_back(new_group);
+            // TODO(Superjomn) need to unique
           }
         }
       }
@@ -420,9 +496,26 @@ PDNode *PDNode::assert_is_op(const std::string &op_type) {
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
+  RestrictOpTypes({op_type});
   return this;
 }
 
+void PDNode::RestrictOpTypes(const std::unordered_set<std::string> &op_types) {
+  if (!restricted_to_op_types_) {
+    op_types_ = op_types;
+    restricted_to_op_types_ = true;
+    return;
+  }
+  // Several op type assertions on one PDNode must all hold.
+  for (auto it = op_types_.begin(); it != op_types_.end();) {
+    if (op_types.count(*it)) {
+      ++it;
+    } else {
+      it = op_types_.erase(it);
+    }
+  }
+}
+
 PDNode *PDNode::assert_is_not_op_type(const std::string &op_type) {
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() != op_type;
@@ -600,6 +693,7 @@ PDNode *PDNode::assert_is_ops(const std::unordered_set<std::string> &op_types) {
   asserts_.emplace_back([op_types](Node *x) {
     return x && x->IsOp() && op_types.count(x->Op()->Type());
   });
+  RestrictOpTypes(op_types);
   return this;
 }
 
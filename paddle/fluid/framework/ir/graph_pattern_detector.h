@@ -77,6 +77,13 @@ struct PDNode {
     return true;
   }
 
+  // The op types a matched node must have, derived from assert_is_op(type)
+  // and assert_is_ops(types). Returns nullptr if this PDNode is not restricted
+  // to known op types, or if it is decided by a custom teller.
+  const std::unordered_set<std::string>* candidate_op_types() const {
+    return (teller_ || !restricted_to_op_types_) ? nullptr : &op_types_;
+  }
+
   bool IsOp() const { return type_ == Type::kOp; }
   bool IsVar() const { return type_ == Type::kVar; }
 
@@ -188,6 +195,10 @@ struct PDNode {
 
   PDNode(PDNode&& other) = default;
 
+  // Narrow the op types this PDNode can match, used by
+  // GraphPatternDetector to index candidates by op type.
+  void RestrictOpTypes(const std::unordered_set<std::string>& op_types);
+
   friend class PDPattern;
 
   // Will removed latter.
@@ -197,6 +208,8 @@ struct PDNode {
   std::string name_;
   Type type_;
   Role role_{Role::kUnknown};
+  bool restricted_to_op_types_{false};
+  std::unordered_set<std::string> op_types_;
 };
 
 /*
@@ -207,6 +207,60 @@ TEST(GraphPatternDetector, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+TEST(GraphPatternDetector, OpTypeIndex) {
+  // mul(a, w1) -> b -> elementwise_add(b, bias) -> c
+  // mul(c, w2) -> d -> relu(d) -> e
+  ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  for (auto name : {"a", "w1", "b", "bias", "c", "w2", "d", "e"}) {
+    block->Var(name);
+  }
+  auto append_op = [&](const std::string& type,
+                       const std::vector<std::string>& inputs,
+                       const std::string& output) {
+    auto* op = block->AppendOp();
+    op->SetType(type);
+    op->SetInput("X", {inputs[0]});
+    if (inputs.size() > 1) op->SetInput("Y", {inputs[1]});
+    op->SetOutput("Out", {output});
+  };
+  append_op("mul", {"a", "w1"}, "b");
+  append_op("elementwise_add", {"b", "bias"}, "c");
+  append_op("mul", {"c", "w2"}, "d");
+  append_op("relu", {"d"}, "e");
+  Graph graph(program);
+
+  GraphPatternDetector detector;
+  auto* pattern = detector.mutable_pattern();
+  auto* mul = pattern->NewNode("mul")->assert_is_op("mul");
+  auto* mul_out = pattern->NewNode("mul_out")
+                      ->assert_is_op_output("mul")
+                      ->assert_is_op_input("elementwise_add")
+                      ->AsIntermediate();
+  auto* add =
+      pattern->NewNode("add")->assert_is_ops({"elementwise_add", "relu"});
+  add->assert_is_op("elementwise_add");
+  mul->LinksTo({mul_out});
+  add->LinksFrom({mul_out});
+
+  ASSERT_TRUE(mul->candidate_op_types());
+  ASSERT_EQ(mul->candidate_op_types()->size(), 1UL);
+  ASSERT_TRUE(add->candidate_op_types());
+  ASSERT_EQ(add->candidate_op_types()->size(), 1UL);
+  ASSERT_EQ(add->candidate_op_types()->count("elementwise_add"), 1UL);
+  ASSERT_FALSE(mul_out->candidate_op_types());
+
+  int count = 0;
+  detector(&graph,
+           [&](const GraphPatternDetector::subgraph_t& g, Graph* graph) {
+             EXPECT_EQ(g.at(mul)->Name(), "mul");
+             EXPECT_EQ(g.at(mul_out)->Name(), "b");
+             EXPECT_EQ(g.at(add)->Name(), "elementwise_add");
+             ++count;
+           });
+  EXPECT_EQ(count, 1);
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
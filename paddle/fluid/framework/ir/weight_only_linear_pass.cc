@@ -0,0 +1,184 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/weight_only_linear_pass.h"
+
+#include <vector>
+
+#include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_version_registry.h"
+#include "paddle/phi/kernels/funcs/weight_only_gemm.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+Node* FindInputNode(Node* op, const std::string& name) {
+  for (auto* input : op->inputs) {
+    if (input->IsVar() && input->Name() == name) {
+      return input;
+    }
+  }
+  return nullptr;
+}
+
+// Updates both the var node and the var in the block, as the program is
+// rebuilt from the block.
+void SetVarDesc(Node* var_node,
+                BlockDesc* block,
+                const phi::DenseTensor& tensor) {
+  for (auto* var_desc : {var_node->Var(), block->Var(var_node->Name())}) {
+    var_desc->SetPersistable(true);
+    var_desc->SetShape(phi::vectorize(tensor.dims()));
+    var_desc->SetDataType(framework::TransToProtoVarType(tensor.dtype()));
+  }
+}
+
+}  // namespace
+
+void WeightOnlyLinearPass::ApplyImpl(ir::Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::PreconditionNotMet("graph should not be null."));
+  FusePassBase::Init(name_scope_, graph);
+  auto* scope = param_scope();
+  const int weight_bits = Has("weight_bits") ? Get<int>("weight_bits") : 8;
+  const int group_size = Has("group_size") ? Get<int>("group_size") : -1;
+  PADDLE_ENFORCE_EQ(weight_bits == 8 || weight_bits == 4,
+                    true,
+                    platform::errors::InvalidArgument(
+                        "The weight_bits of weight_only_linear_pass should be "
+                        "8 or 4, but received %d.",
+                        weight_bits));
+
+  int found_count = 0;
+  for (auto* node : TopologySortOperations(*graph)) {
+    auto* op = node->Op();
+    if (op->GetAttrIfExists<bool>("use_mkldnn")) continue;
+    std::string x_name, w_name, bias_name;
+    if (op->Type() == "fc") {
+      if (!op->GetAttrIfExists<std::string>("activation_type").empty() ||
+          op->GetAttrIfExists<bool>("padding_weights")) {
+        continue;
+      }
+      x_name = op->Input("Input")[0];
+      w_name = op->Input("W")[0];
+      if (op->HasInput("Bias") && !op->Input("Bias").empty()) {
+        bias_name = op->Input("Bias")[0];
+      }
+    } else if (op->Type() == "matmul_v2") {
+      if (op->GetAttrIfExists<bool>("trans_x") ||
+          op->GetAttrIfExists<bool>("trans_y")) {
+        continue;
+      }
+      x_name = op->Input("X")[0];
+      w_name = op->Input("Y")[0];
+    } else {
+      continue;
+    }
+
+    // The weight is rewritten in place, so it must not be shared.
+    Node* x_node = FindInputNode(node, x_name);
+    Node* w_node = FindInputNode(node, w_name);
+    if (!x_node || !w_node || !w_node->Var()->Persistable() ||
+        w_node->outputs.size() != 1 || !scope->FindVar(w_name)) {
+      continue;
+    }
+    auto* w_tensor = scope->FindVar(w_name)->GetMutable<phi::DenseTensor>();
+    if (w_tensor->dtype() != phi::DataType::FLOAT32 ||
+        w_tensor->dims().size() != 2) {
+      continue;
+    }
+    // fc flattens its input at in_num_col_dims, weight_only_linear at the
+    // last dim.
+    if (op->Type() == "fc" &&
+        op->GetAttrIfExists<int>("in_num_col_dims") !=
+            static_cast<int>(x_node->Var()->GetShape().size()) - 1) {
+      continue;
+    }
+    const int k = w_tensor->dims()[0];
+    const int n = w_tensor->dims()[1];
+    const int group = group_size > 0 ? group_size : k;
+    if (k % group != 0 || (weight_bits == 4 && group % 2 != 0)) {
+      VLOG(3) << "Skip " << op->Type() << " with weight " << w_name
+              << ", its input size " << k
+              << " does not fit the group size " << group;
+      continue;
+    }
+
+    phi::DenseTensor qweight, scale;
+    qweight.Resize({n, k * weight_bits / 8});
+    if (group_size > 0) {
+      scale.Resize({k / group_size, n});
+    } else {
+      scale.Resize({n});
+    }
+    phi::funcs::WeightOnlyQuantize(
+        w_tensor->data<float>(),
+        k,
+        n,
+        weight_bits,
+        group_size,
+        qweight.mutable_data<int8_t>(platform::CPUPlace()),
+        scale.mutable_data<float>(platform::CPUPlace()));
+    *w_tensor = qweight;
+    auto* block = op->Block();
+    SetVarDesc(w_node, block, qweight);
+
+    const std::string scale_name = w_name + "_weight_only_scale";
+    VarDesc scale_desc(scale_name);
+    auto* scale_node = graph->CreateVarNode(&scale_desc);
+    SetVarDesc(scale_node, block, scale);
+    *scope->Var(scale_name)->GetMutable<phi::DenseTensor>() = scale;
+
+    OpDesc desc(block);
+    desc.SetType("weight_only_linear");
+    desc.SetInput("x", {x_name});
+    desc.SetInput("weight", {w_name});
+    if (!bias_name.empty()) {
+      desc.SetInput("bias", {bias_name});
+    }
+    desc.SetInput("weight_scale", {scale_name});
+    desc.SetOutput("out", op->Output("Out"));
+    desc.SetAttr("weight_dtype",
+                 std::string(weight_bits == 4 ? "int4" : "int8"));
+    desc.SetAttr("group_size", group_size);
+    auto* new_node = graph->CreateOpNode(&desc);
+    for (auto* input : node->inputs) {
+      IR_NODE_LINK_TO(input, new_node);
+    }
+    IR_NODE_LINK_TO(scale_node, new_node);
+    for (auto* output : node->outputs) {
+      IR_NODE_LINK_TO(new_node, output);
+    }
+    GraphSafeRemoveNodes(graph, {node});
+    ++found_count;
+  }
+  AddStatis(found_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(weight_only_linear_pass,
+              paddle::framework::ir::WeightOnlyLinearPass);
+REGISTER_PASS_CAPABILITY(weight_only_linear_pass)
+    .AddCombination(
+        paddle::framework::compatible::OpVersionComparatorCombination()
+            .EQ("fc", 0)
+            .EQ("matmul_v2", 0));
@@ -0,0 +1,46 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+class Graph;
+
+// Rewrites fc (without activation) and matmul_v2 ops whose weight is a
+// persistable 2-D fp32 tensor into weight_only_linear, quantizing the weight
+// in the parameter scope. The pass attributes weight_bits (8 or 4, default 8)
+// and group_size (-1 for per-channel scales, default -1) select the format.
+// As the program and the parameters are both rewritten, a model saved after
+// this pass stores the quantized weights.
+class WeightOnlyLinearPass : public FusePassBase {
+ public:
+  virtual ~WeightOnlyLinearPass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph* graph) const override;
+
+ private:
+  const std::string name_scope_{"weight_only_linear_pass"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
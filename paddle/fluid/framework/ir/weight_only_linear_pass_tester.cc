@@ -0,0 +1,114 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/framework/ir/weight_only_linear_pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void AddVarToScope(Scope* param_scope,
+                   const std::string& name,
+                   const DDim& dims) {
+  auto* tensor = param_scope->Var(name)->GetMutable<phi::DenseTensor>();
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>(i % 17) - 8.f;
+  }
+}
+
+Scope* CreateParamScope() {
+  auto param_scope = new Scope();
+  AddVarToScope(param_scope, "fc_w", {64, 32});
+  AddVarToScope(param_scope, "fc_bias", {32});
+  AddVarToScope(param_scope, "matmul_w", {32, 16});
+  AddVarToScope(param_scope, "shared_w", {16, 16});
+  return param_scope;
+}
+
+std::unique_ptr<ir::Graph> BuildGraph() {
+  // inputs                  operator         output
+  // ----------------------------------------------------------
+  // (x, fc_w, fc_bias)      fc            -> fc_out
+  // (fc_out, matmul_w)      matmul_v2     -> matmul_out
+  // (matmul_out, shared_w)  matmul_v2 x2  -> kept, shared weight
+  Layers layers;
+  auto* x = layers.data("x", {4, 64});
+  auto* fc_w = layers.data("fc_w", {64, 32}, true);
+  auto* fc_bias = layers.data("fc_bias", {32}, true);
+  auto* matmul_w = layers.data("matmul_w", {32, 16}, true);
+  auto* shared_w = layers.data("shared_w", {16, 16}, true);
+  auto* fc_out = layers.fc(x, fc_w, fc_bias);
+  auto* matmul_out = layers.matmul_v2(fc_out, matmul_w);
+  layers.matmul_v2(matmul_out, shared_w);
+  layers.matmul_v2(matmul_out, shared_w);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  graph->Set("__param_scope__", CreateParamScope());
+  return graph;
+}
+
+TEST(WeightOnlyLinearPass, int8_per_channel) {
+  auto graph = BuildGraph();
+  auto pass = PassRegistry::Instance().Get("weight_only_linear_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "weight_only_linear"), 2);
+  EXPECT_EQ(GetNumOpNodes(graph, "fc"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "matmul_v2"), 2);
+
+  auto& scope = graph->Get<Scope>("__param_scope__");
+  auto& fc_w = scope.FindVar("fc_w")->Get<phi::DenseTensor>();
+  EXPECT_EQ(fc_w.dtype(), phi::DataType::INT8);
+  EXPECT_EQ(fc_w.dims(), phi::make_ddim({32, 64}));
+  auto& fc_scale =
+      scope.FindVar("fc_w_weight_only_scale")->Get<phi::DenseTensor>();
+  EXPECT_EQ(fc_scale.dims(), phi::make_ddim({32}));
+  // Column 0 of fc_w holds (32 * i) % 17 - 8, whose abs max is 8.
+  EXPECT_FLOAT_EQ(fc_scale.data<float>()[0], 8.f / 127.f);
+  EXPECT_EQ(scope.FindVar("shared_w")->Get<phi::DenseTensor>().dtype(),
+            phi::DataType::FLOAT32);
+}
+
+TEST(WeightOnlyLinearPass, int4_group_wise) {
+  auto graph = BuildGraph();
+  auto pass = PassRegistry::Instance().Get("weight_only_linear_pass");
+  pass->Set("weight_bits", new int(4));
+  pass->Set("group_size", new int(16));
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "weight_only_linear"), 2);
+  auto& scope = graph->Get<Scope>("__param_scope__");
+  auto& matmul_w = scope.FindVar("matmul_w")->Get<phi::DenseTensor>();
+  EXPECT_EQ(matmul_w.dims(), phi::make_ddim({16, 16}));
+  auto& matmul_scale =
+      scope.FindVar("matmul_w_weight_only_scale")->Get<phi::DenseTensor>();
+  EXPECT_EQ(matmul_scale.dims(), phi::make_ddim({2, 16}));
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "weight_only_linear") {
+      EXPECT_EQ(node->Op()->GetAttrIfExists<std::string>("weight_dtype"),
+                "int4");
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(weight_only_linear_pass);
@@ -27,6 +27,7 @@
 #include "paddle/fluid/platform/os_info.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/fluid/platform/profiler/supplement_tracing.h"
+#include "paddle/phi/api/profiler/perf_counters.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/kernel_context.h"
 #ifdef PADDLE_WITH_MKLDNN
@@ -996,6 +997,7 @@ void InterpreterCore::RunInstruction(const Instruction& instr_node) {
   auto* op = instr_node.OpBase();
   platform::RecordEvent instruction_event(
       op->Type(), platform::TracerEventType::Operator, 1);
+  phi::RecordPerfCounters instruction_perf_counters(op->Type().c_str());
 
   SetDeviceId(instr_node.DeviceContext().GetPlace());
 
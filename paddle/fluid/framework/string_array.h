@@ -17,6 +17,7 @@ limitations under the License. */
 #include <codecvt>
 #include <iostream>
 #include <locale>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -45,6 +46,7 @@ class Vocab : public phi::ExtendedTensor,
   Vocab& operator=(
       const std::unordered_map<std::wstring, std::int32_t>& other) {
     this->data_ = other;
+    ResetCache();
     return *this;
   }
 
@@ -58,10 +60,14 @@ class Vocab : public phi::ExtendedTensor,
 
   size_t size() const { return data_.size(); }
 
-  void clear() { data_.clear(); }
+  void clear() {
+    data_.clear();
+    ResetCache();
+  }
 
   void emplace(const std::wstring& key, std::int32_t value) {
     data_.emplace(key, value);
+    ResetCache();
   }
 
   std::int32_t at(const std::wstring& key) { return data_.at(key); }
@@ -70,6 +76,7 @@ class Vocab : public phi::ExtendedTensor,
 
   std::unordered_map<std::wstring, std::int32_t>::iterator find(
       const std::wstring& key) {
+    ResetCache();
     return data_.find(key);
   }
 
@@ -79,6 +86,7 @@ class Vocab : public phi::ExtendedTensor,
   }
 
   std::unordered_map<std::wstring, std::int32_t>::iterator begin() {
+    ResetCache();
     return data_.begin();
   }
 
@@ -87,6 +95,7 @@ class Vocab : public phi::ExtendedTensor,
   }
 
   std::unordered_map<std::wstring, std::int32_t>::iterator end() {
+    ResetCache();
     return data_.end();
   }
 
@@ -94,8 +103,25 @@ class Vocab : public phi::ExtendedTensor,
     return data_.end();
   }
 
+  /// \brief Returns the data built from the vocab by its users, e.g. the
+  /// tries of faster_tokenizer_op, or nullptr. It is dropped once the vocab
+  /// may be modified.
+  std::shared_ptr<const void> cache() const {
+    return std::atomic_load(&cache_);
+  }
+
+  /// \brief Sets the cache, which can be shared by the threads.
+  void set_cache(std::shared_ptr<const void> cache) const {
+    std::atomic_store(&cache_, std::move(cache));
+  }
+
  private:
+  void ResetCache() {
+    std::atomic_store(&cache_, std::shared_ptr<const void>());
+  }
+
   std::unordered_map<std::wstring, std::int32_t> data_;
+  mutable std::shared_ptr<const void> cache_;
 };
 
 // Note(YuanRisheng): PhiVector is essentially a vector that only used for PHI
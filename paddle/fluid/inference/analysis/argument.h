@@ -336,6 +336,12 @@ struct Argument {
                       CpuMathLibraryNumThreads,
                       int);
 
+  // CPU weight-only quantization related.
+  DECL_ARGUMENT_FIELD(cpu_weight_only_quant_bits, CpuWeightOnlyQuantBits, int);
+  DECL_ARGUMENT_FIELD(cpu_weight_only_quant_group_size,
+                      CpuWeightOnlyQuantGroupSize,
+                      int);
+
   // ipu related
   DECL_ARGUMENT_FIELD(use_ipu, UseIpu, bool);
   DECL_ARGUMENT_FIELD(ipu_device_num, IpuDeviceNum, int);
@@ -320,6 +320,11 @@ void IRPassManager::CreatePasses(Argument *argument,
         pass->Set("quant_weight_bits",
                   new int(argument->xpu_quant_post_dynamic_weight_bits()));
       }
+    } else if (pass_name == "weight_only_linear_pass") {
+      pass->Set("weight_bits",
+                new int(argument->cpu_weight_only_quant_bits()));
+      pass->Set("group_size",
+                new int(argument->cpu_weight_only_quant_group_size()));
     }
     pre_pass = pass_name;
 
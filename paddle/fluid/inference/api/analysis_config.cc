@@ -523,6 +523,8 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(specify_input_name_);
 
   CP_MEMBER(cpu_math_library_num_threads_);
+  CP_MEMBER(cpu_weight_only_quant_bits_);
+  CP_MEMBER(cpu_weight_only_quant_group_size_);
 
   CP_MEMBER(serialized_info_cache_);
 
@@ -968,6 +970,22 @@ void AnalysisConfig::Update() {
 #endif
   }
 
+  // Runs after the fc fusions so that the fused weights are quantized.
+  if (cpu_weight_only_quant_bits_ > 0) {
+    if (use_gpu() || use_xpu() || use_ipu() || use_custom_device()) {
+      LOG(ERROR) << "EnableCpuWeightOnlyQuant() only works on CPU.";
+    } else if (!enable_ir_optim_) {
+      LOG(ERROR) << "EnableCpuWeightOnlyQuant() only works when IR "
+                    "optimization is enabled.";
+    } else {
+      const auto &passes = pass_builder()->AllPasses();
+      if (std::find(passes.begin(), passes.end(), "weight_only_linear_pass") ==
+          passes.end()) {
+        pass_builder()->AppendPass("weight_only_linear_pass");
+      }
+    }
+  }
+
   if (enable_memory_optim_) {
     pass_builder()->AppendAnalysisPass("memory_optimize_pass");
   }
@@ -1073,6 +1091,8 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << specify_input_name_;
   ss << cpu_math_library_num_threads_;
+  ss << cpu_weight_only_quant_bits_;
+  ss << cpu_weight_only_quant_group_size_;
 
   ss << use_lite_;
   ss << use_xpu_;
@@ -1117,6 +1137,20 @@ void AnalysisConfig::SetCpuMathLibraryNumThreads(
   Update();
 }
 
+void AnalysisConfig::EnableCpuWeightOnlyQuant(int weight_bits,
+                                              int group_size) {
+  PADDLE_ENFORCE_EQ(weight_bits == 8 || weight_bits == 4,
+                    true,
+                    platform::errors::InvalidArgument(
+                        "The weight bits of the CPU weight-only quantization "
+                        "should be 8 or 4, but received %d.",
+                        weight_bits));
+  cpu_weight_only_quant_bits_ = weight_bits;
+  cpu_weight_only_quant_group_size_ = group_size;
+
+  Update();
+}
+
 float AnalysisConfig::fraction_of_gpu_memory_for_pool() const {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   // Get the GPU memory details and calculate the fraction of memory for the
@@ -1236,6 +1270,12 @@ std::string AnalysisConfig::Summary() {
   os.InsertRow({"enable_mkldnn", use_mkldnn_ ? "true" : "false"});
   os.InsertRow(
       {"mkldnn_cache_capacity", std::to_string(mkldnn_cache_capacity_)});
+  if (cpu_weight_only_quant_bits_ > 0) {
+    os.InsertRow({"cpu_weight_only_quant_bits",
+                  std::to_string(cpu_weight_only_quant_bits_)});
+    os.InsertRow({"cpu_weight_only_quant_group_size",
+                  std::to_string(cpu_weight_only_quant_group_size_)});
+  }
   os.InsetDivider();
 
   // gpu info
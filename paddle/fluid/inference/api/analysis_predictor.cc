@@ -1340,6 +1340,9 @@ void AnalysisPredictor::PrepareArgument() {
   argument_->SetUseGPU(config_.use_gpu());
   argument_->SetUseCutlass(config_.use_cutlass_);
   argument_->SetUseFcPadding(config_.use_fc_padding());
+  argument_->SetCpuWeightOnlyQuantBits(config_.cpu_weight_only_quant_bits_);
+  argument_->SetCpuWeightOnlyQuantGroupSize(
+      config_.cpu_weight_only_quant_group_size_);
   argument_->SetGPUDeviceId(config_.gpu_device_id());
   argument_->SetEnableIrOptim(config_.enable_ir_optim_);
   argument_->SetEnableMemoryOptim(config_.enable_memory_optim());
@@ -1596,6 +1599,8 @@ void AnalysisPredictor::PrepareArgument() {
 
 // NOTE All the members in AnalysisConfig should be copied to Argument.
 void AnalysisPredictor::OptimizeInferenceProgram() {
+  inference::Timer optimize_timer;
+  optimize_timer.tic();
   PrepareArgument();
 #ifdef PADDLE_WITH_TENSORRT
   if (config_.tensorrt_engine_enabled()) {
@@ -1657,7 +1662,8 @@ void AnalysisPredictor::OptimizeInferenceProgram() {
     argument_.reset(nullptr);
   }
 #endif
-  LOG(INFO) << "======= optimize end =======";
+  LOG(INFO) << "======= optimize end (" << optimize_timer.toc()
+            << " ms) =======";
 }
 
 template <>
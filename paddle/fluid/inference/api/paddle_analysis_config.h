@@ -842,6 +842,27 @@ struct PD_INFER_DECL AnalysisConfig {
     return cpu_math_library_num_threads_;
   }
 
+  ///
+  /// \brief Turn on weight-only quantization of the fc and matmul_v2
+  /// weights for CPU inference. The weights are quantized to int8 or int4
+  /// when the model is optimized and dequantized on the fly by the
+  /// weight_only_linear kernel, while the activations stay in fp32.
+  ///
+  /// \param weight_bits The bits of the quantized weights, 8 or 4.
+  /// \param group_size The number of input rows sharing a scale, -1 for one
+  /// scale per output channel.
+  ///
+  void EnableCpuWeightOnlyQuant(int weight_bits = 8, int group_size = -1);
+  ///
+  /// \brief A boolean state telling whether the CPU weight-only
+  /// quantization is turned on.
+  ///
+  /// \return bool Whether the CPU weight-only quantization is turned on.
+  ///
+  bool cpu_weight_only_quant_enabled() const {
+    return cpu_weight_only_quant_bits_ > 0;
+  }
+
   ///
   /// \brief Transform the AnalysisConfig to NativeConfig.
   ///
@@ -1170,6 +1191,8 @@ struct PD_INFER_DECL AnalysisConfig {
   bool specify_input_name_{false};
 
   int cpu_math_library_num_threads_{1};
+  int cpu_weight_only_quant_bits_{-1};
+  int cpu_weight_only_quant_group_size_{-1};
 
   bool with_profile_{false};
 
@@ -304,8 +304,14 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
   // not be damaged by smaller ones.
   passes_.assign({"simplify_with_basic_ops_pass",  //
                   "layer_norm_fuse_pass",
-                  "attention_lstm_fuse_pass",       //
-                  "seqconv_eltadd_relu_fuse_pass",  //
+                  "embedding_eltwise_layernorm_fuse_pass",          //
+                  "multihead_matmul_fuse_pass_v2",                  //
+                  "fused_multi_transformer_encoder_pass",           //
+                  "fused_multi_transformer_decoder_pass",           //
+                  "fused_multi_transformer_encoder_fuse_qkv_pass",  //
+                  "fused_multi_transformer_decoder_fuse_qkv_pass",  //
+                  "attention_lstm_fuse_pass",                       //
+                  "seqconv_eltadd_relu_fuse_pass",                  //
                   // "seqpool_concat_fuse_pass",    //
                   "seqpool_cvm_concat_fuse_pass",  //
                   // "embedding_fc_lstm_fuse_pass", //
@@ -322,8 +328,11 @@ CpuPassStrategy::CpuPassStrategy() : PassStrategy({}) {
                   "gpu_cpu_map_matmul_v2_to_mul_pass",       //
                   "gpu_cpu_map_matmul_v2_to_matmul_pass",    //
                   "matmul_scale_fuse_pass",                  //
+                  "multihead_matmul_fuse_pass_v3",           //
                   "gpu_cpu_map_matmul_to_mul_pass",          //
                   "fc_fuse_pass",                            //
+                  "fc_elementwise_layernorm_fuse_pass",      //
+                  "skip_layernorm_fuse_pass",                //
                   "repeated_fc_relu_fuse_pass",              //
                   "squared_mat_sub_fuse_pass",               //
                   "conv_bn_fuse_pass",                       //
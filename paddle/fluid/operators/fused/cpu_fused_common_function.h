@@ -0,0 +1,334 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/jit/kernels.h"
+
+// Building blocks shared by the CPU kernels of the transformer fusion ops
+// (multihead_matmul, skip_layernorm, fused_embedding_eltwise_layernorm,
+// fused_fc_elementwise_layernorm and fused_multi_transformer).
+
+namespace paddle {
+namespace operators {
+
+// x = act(x + bias) on every row of a [rows, cols] matrix. bias may be null,
+// act_method is one of "gelu", "relu", "none" or "".
+template <typename T>
+void CPUAddBiasAct(T *x,
+                   const T *bias,
+                   int rows,
+                   int cols,
+                   const std::string &act_method) {
+  using phi::CPUPlace;
+  namespace jit = phi::jit;
+  auto vadd = jit::KernelFuncs<jit::VAddTuple<T>, CPUPlace>::Cache().At(cols);
+  typename jit::XYNTuple<T>::func_type act = nullptr;
+  if (act_method == "gelu") {
+    // The exact erf form, as the gelu op in the unfused graph.
+    act = jit::KernelFuncs<jit::VGeluErfTuple<T>, CPUPlace>::Cache().At(cols);
+  } else if (act_method == "relu") {
+    act = jit::KernelFuncs<jit::VReluTuple<T>, CPUPlace>::Cache().At(cols);
+  } else {
+    PADDLE_ENFORCE_EQ(
+        act_method.empty() || act_method == "none",
+        true,
+        phi::errors::Unimplemented(
+            "Activation %s is not supported on CPU, only gelu, relu and "
+            "none are supported.",
+            act_method));
+  }
+  if (!bias && !act) {
+    return;
+  }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < rows; ++i) {
+    T *row = x + static_cast<int64_t>(i) * cols;
+    if (bias) {
+      vadd(row, bias, row, cols);
+    }
+    if (act) {
+      act(row, row, cols);
+    }
+  }
+}
+
+// out = LayerNorm(x + residual + bias) over the rows of a [rows, cols]
+// matrix. residual, bias, ln_scale and ln_bias may be null. When sum is not
+// null it receives the values before normalization, which is the residual of
+// the next sublayer. mean and var may be null if they are not needed. Any of
+// sum and out may alias x or residual.
+template <typename T>
+void CPUResidualLayerNorm(const phi::CPUContext &dev_ctx,
+                          const T *x,
+                          const T *residual,
+                          const T *bias,
+                          const T *ln_scale,
+                          const T *ln_bias,
+                          T *sum,
+                          T *out,
+                          T *mean,
+                          T *var,
+                          int rows,
+                          int cols,
+                          float epsilon) {
+  using phi::CPUPlace;
+  namespace jit = phi::jit;
+  auto vadd = jit::KernelFuncs<jit::VAddTuple<T>, CPUPlace>::Cache().At(cols);
+  T *dst = sum ? sum : out;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < rows; ++i) {
+    const int64_t offset = static_cast<int64_t>(i) * cols;
+    if (residual) {
+      vadd(x + offset, residual + offset, dst + offset, cols);
+    } else if (dst != x) {
+      std::memcpy(dst + offset, x + offset, cols * sizeof(T));
+    }
+    if (bias) {
+      vadd(dst + offset, bias, dst + offset, cols);
+    }
+  }
+  if (dst != out) {
+    std::memcpy(out, dst, static_cast<int64_t>(rows) * cols * sizeof(T));
+  }
+
+  phi::DenseTensor mean_var;
+  if (!mean || !var) {
+    mean_var.Resize({2 * rows});
+    T *mean_var_data = dev_ctx.template Alloc<T>(&mean_var);
+    mean = mean ? mean : mean_var_data;
+    var = var ? var : mean_var_data + rows;
+  }
+  auto layer_norm =
+      jit::KernelFuncs<jit::LayerNormTuple<T>, CPUPlace>::Cache().At(cols);
+  layer_norm(out, out, mean, var, ln_scale, ln_bias, rows, epsilon, cols);
+}
+
+// x = x + residual + bias over the rows of a [rows, cols] matrix, used after
+// the last sublayer of a pre-LayerNorm transformer.
+template <typename T>
+void CPUResidualBias(
+    T *x, const T *residual, const T *bias, int rows, int cols) {
+  auto vadd = phi::jit::KernelFuncs<phi::jit::VAddTuple<T>,
+                                    phi::CPUPlace>::Cache()
+                  .At(cols);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < rows; ++i) {
+    const int64_t offset = static_cast<int64_t>(i) * cols;
+    vadd(x + offset, residual + offset, x + offset, cols);
+    if (bias) {
+      vadd(x + offset, bias, x + offset, cols);
+    }
+  }
+}
+
+// Scaled dot-product attention of a single head:
+//   out = softmax(scale * q * k^T + mask) * v
+// q is [q_len, head_dim], k and v are [kv_len, head_dim] and mask is
+// [q_len, kv_len], each addressed with its own leading dimension so that the
+// operands can be read in place from a fused QKV projection or a KV cache,
+// and out is written in place into a [seq_len, num_head, head_dim] result.
+// A zero ldm broadcasts one mask row to every query. qk is a scratch buffer
+// of q_len * kv_len elements.
+template <typename T>
+void CPUHeadAttention(const phi::funcs::BlasT<phi::CPUContext, T> &blas,
+                      const T *q,
+                      int ldq,
+                      const T *k,
+                      int ldk,
+                      const T *v,
+                      int ldv,
+                      const T *mask,
+                      int ldm,
+                      T *out,
+                      int ldo,
+                      T *qk,
+                      int q_len,
+                      int kv_len,
+                      int head_dim,
+                      T scale) {
+  if (mask) {
+    for (int i = 0; i < q_len; ++i) {
+      std::memcpy(qk + static_cast<int64_t>(i) * kv_len,
+                  mask + static_cast<int64_t>(i) * ldm,
+                  kv_len * sizeof(T));
+    }
+  }
+  // The mask is accumulated by the GEMM itself through beta.
+  blas.GEMM(CblasNoTrans,
+            CblasTrans,
+            q_len,
+            kv_len,
+            head_dim,
+            scale,
+            q,
+            ldq,
+            k,
+            ldk,
+            static_cast<T>(mask ? 1 : 0),
+            qk,
+            kv_len);
+  auto softmax = phi::jit::KernelFuncs<phi::jit::SoftmaxTuple<T>,
+                                       phi::CPUPlace>::Cache()
+                     .At(kv_len);
+  softmax(qk, qk, kv_len, q_len, 1);
+  blas.GEMM(CblasNoTrans,
+            CblasNoTrans,
+            q_len,
+            head_dim,
+            kv_len,
+            static_cast<T>(1),
+            qk,
+            kv_len,
+            v,
+            ldv,
+            static_cast<T>(0),
+            out,
+            ldo);
+}
+
+// CPUHeadAttention over keys and values stored in a paged cache. The
+// kv_len keys are split into blocks of block_size rows, block j lives at
+// k_pool + block_table[j] * block_stride (and likewise in v_pool), and the
+// rows of a block are head_dim elements apart. A single query, the common
+// case of incremental decoding, is computed with one GEMV per block instead
+// of a GEMM.
+template <typename T>
+void CPUPagedHeadAttention(const phi::funcs::BlasT<phi::CPUContext, T> &blas,
+                           const T *q,
+                           int ldq,
+                           const T *k_pool,
+                           const T *v_pool,
+                           const int *block_table,
+                           int64_t block_stride,
+                           int block_size,
+                           const T *mask,
+                           int ldm,
+                           T *out,
+                           int ldo,
+                           T *qk,
+                           int q_len,
+                           int kv_len,
+                           int head_dim,
+                           T scale) {
+  const int num_blocks = (kv_len + block_size - 1) / block_size;
+  if (mask) {
+    for (int i = 0; i < q_len; ++i) {
+      std::memcpy(qk + static_cast<int64_t>(i) * kv_len,
+                  mask + static_cast<int64_t>(i) * ldm,
+                  kv_len * sizeof(T));
+    }
+  }
+  const T beta = static_cast<T>(mask ? 1 : 0);
+  for (int j = 0; j < num_blocks; ++j) {
+    const T *k = k_pool + block_table[j] * block_stride;
+    const int rows = std::min(block_size, kv_len - j * block_size);
+    T *logits = qk + j * block_size;
+    if (q_len == 1) {
+      blas.GEMV(false, rows, head_dim, scale, k, q, beta, logits);
+    } else {
+      blas.GEMM(CblasNoTrans,
+                CblasTrans,
+                q_len,
+                rows,
+                head_dim,
+                scale,
+                q,
+                ldq,
+                k,
+                head_dim,
+                beta,
+                logits,
+                kv_len);
+    }
+  }
+  auto softmax = phi::jit::KernelFuncs<phi::jit::SoftmaxTuple<T>,
+                                       phi::CPUPlace>::Cache()
+                     .At(kv_len);
+  softmax(qk, qk, kv_len, q_len, 1);
+  for (int j = 0; j < num_blocks; ++j) {
+    const T *v = v_pool + block_table[j] * block_stride;
+    const int rows = std::min(block_size, kv_len - j * block_size);
+    const T *probs = qk + j * block_size;
+    const T beta = static_cast<T>(j > 0 ? 1 : 0);
+    if (q_len == 1) {
+      blas.GEMV(true, rows, head_dim, static_cast<T>(1), v, probs, beta, out);
+    } else {
+      blas.GEMM(CblasNoTrans,
+                CblasNoTrans,
+                q_len,
+                head_dim,
+                rows,
+                static_cast<T>(1),
+                probs,
+                kv_len,
+                v,
+                head_dim,
+                beta,
+                out,
+                ldo);
+    }
+  }
+}
+
+// Rotary position embedding applied in place to the [seq_len, head_dim]
+// rows of one head, whose rows are ld elements apart. rotary_emb holds cos
+// followed by sin, each [batch_size, seq_len, head_dim], and cos/sin point to
+// the first row of the current batch. Rows at or after seq_limit are skipped.
+template <typename T>
+void CPURotaryEmb(T *x,
+                  int ld,
+                  const T *cos,
+                  const T *sin,
+                  int seq_len,
+                  int seq_limit,
+                  int head_dim,
+                  int rotary_emb_dims) {
+  const int last_dim = head_dim / rotary_emb_dims;
+  const int half_last_dim = last_dim / 2;
+  for (int s = 0; s < seq_len && s < seq_limit; ++s) {
+    T *row = x + static_cast<int64_t>(s) * ld;
+    for (int r = 0; r < rotary_emb_dims; ++r) {
+      T *left = row + r * last_dim;
+      T *right = left + half_last_dim;
+      const int64_t emb_offset =
+          static_cast<int64_t>(s) * head_dim + r * last_dim;
+      for (int i = 0; i < half_last_dim; ++i) {
+        const T cos_v = cos[emb_offset + i];
+        const T sin_v = sin[emb_offset + i];
+        const T left_v = left[i];
+        const T right_v = right[i];
+        left[i] = left_v * cos_v - right_v * sin_v;
+        right[i] = right_v * cos_v + left_v * sin_v;
+      }
+    }
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
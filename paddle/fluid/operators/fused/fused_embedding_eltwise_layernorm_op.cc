@@ -15,6 +15,7 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/fused/cpu_fused_common_function.h"
 #include "paddle/fluid/platform/errors.h"
 
 namespace paddle {
@@ -167,6 +168,63 @@ Not suggest to use in other case except has same structure as ernie.
   }
 };
 
+template <typename T, typename DeviceContext>
+class EmbeddingEltWiseLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto ids = context.MultiInput<phi::DenseTensor>("Ids");
+    auto embs = context.MultiInput<phi::DenseTensor>("Embs");
+    auto* bias = context.Input<phi::DenseTensor>("Bias");
+    auto* scale = context.Input<phi::DenseTensor>("Scale");
+    auto* out = context.Output<phi::DenseTensor>("Out");
+    float eps = context.Attr<float>("epsilon");
+
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    auto* out_data = dev_ctx.template Alloc<T>(out);
+
+    int input_num = static_cast<int>(ids.size());
+    int hidden = embs[0]->dims()[1];
+    int64_t tokens = ids[0]->numel();
+    auto vadd = phi::jit::KernelFuncs<phi::jit::VAddTuple<T>,
+                                      phi::CPUPlace>::Cache()
+                    .At(hidden);
+
+    // Gather and sum the embedding rows of every token, then normalize all
+    // of them with one LayerNorm call.
+    for (int64_t i = 0; i < tokens; ++i) {
+      T* dst = out_data + i * hidden;
+      for (int j = 0; j < input_num; ++j) {
+        int64_t id = ids[j]->data<int64_t>()[i];
+        int64_t rows = embs[j]->dims()[0];
+        PADDLE_ENFORCE_EQ(
+            id >= 0 && id < rows,
+            true,
+            platform::errors::InvalidArgument(
+                "The id (%d) of Ids[%d] should be in [0, %d).", id, j, rows));
+        const T* src = embs[j]->data<T>() + id * hidden;
+        if (j == 0) {
+          std::memcpy(dst, src, hidden * sizeof(T));
+        } else {
+          vadd(dst, src, dst, hidden);
+        }
+      }
+    }
+    CPUResidualLayerNorm<T>(dev_ctx,
+                            out_data,
+                            nullptr,
+                            nullptr,
+                            scale->data<T>(),
+                            bias->data<T>(),
+                            nullptr,
+                            out_data,
+                            nullptr,
+                            nullptr,
+                            static_cast<int>(tokens),
+                            hidden,
+                            eps);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -174,3 +232,9 @@ namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(fused_embedding_eltwise_layernorm,
                              ops::EmbeddingEltWiseLayerNormOp,
                              ops::EmbeddingEltWiseLayerNormOpMaker);
+
+PD_REGISTER_STRUCT_KERNEL(fused_embedding_eltwise_layernorm,
+                          CPU,
+                          ALL_LAYOUT,
+                          ops::EmbeddingEltWiseLayerNormCPUKernel,
+                          float) {}
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/fused/cpu_fused_common_function.h"
+#include "paddle/phi/kernels/funcs/fc_functor.h"
 
 namespace paddle {
 namespace operators {
@@ -282,6 +284,61 @@ add_out <= elementwise_add(fc_out, Y)
   }
 };
 
+template <typename T, typename DeviceContext>
+class FusedFCElementwiseLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *x = ctx.Input<phi::DenseTensor>("X");
+    auto *w = ctx.Input<phi::DenseTensor>("W");
+    auto *y = ctx.Input<phi::DenseTensor>("Y");
+    auto *bias_0 = ctx.Input<phi::DenseTensor>("Bias0");
+    auto *bias_1 = ctx.Input<phi::DenseTensor>("Bias1");
+    auto *scale = ctx.Input<phi::DenseTensor>("Scale");
+    auto *out = ctx.Output<phi::DenseTensor>("Out");
+    auto *mean = ctx.Output<phi::DenseTensor>("Mean");
+    auto *variance = ctx.Output<phi::DenseTensor>("Variance");
+
+    auto w_dims = w->dims();
+    int N = w_dims[1];
+    int K = w_dims[0];
+    int M = phi::product(x->dims()) / K;
+
+    auto &dev_ctx = ctx.template device_context<DeviceContext>();
+    auto *out_data = dev_ctx.template Alloc<T>(out);
+    T *mean_data = mean ? dev_ctx.template Alloc<T>(mean) : nullptr;
+    T *variance_data = variance ? dev_ctx.template Alloc<T>(variance) : nullptr;
+
+    bool with_relu = ctx.Attr<std::string>("activation_type") == "relu";
+    phi::funcs::FCFunctor<DeviceContext, T> fc;
+    fc(dev_ctx,
+       M,
+       N,
+       K,
+       x->data<T>(),
+       w->data<T>(),
+       out_data,
+       bias_0 ? bias_0->data<T>() : nullptr,
+       with_relu && bias_0);
+    if (with_relu && !bias_0) {
+      CPUAddBiasAct<T>(out_data, nullptr, M, N, "relu");
+    }
+
+    CPUResidualLayerNorm<T>(dev_ctx,
+                            out_data,
+                            y->data<T>(),
+                            nullptr,
+                            scale ? scale->data<T>() : nullptr,
+                            bias_1 ? bias_1->data<T>() : nullptr,
+                            nullptr,
+                            out_data,
+                            mean_data,
+                            variance_data,
+                            M,
+                            N,
+                            ctx.Attr<float>("epsilon"));
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -292,3 +349,9 @@ REGISTER_OPERATOR(
     ops::FusedFCElementwiseLayerNormOpMaker,
     paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
     paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+
+PD_REGISTER_STRUCT_KERNEL(fused_fc_elementwise_layernorm,
+                          CPU,
+                          ALL_LAYOUT,
+                          ops::FusedFCElementwiseLayerNormCPUKernel,
+                          float) {}
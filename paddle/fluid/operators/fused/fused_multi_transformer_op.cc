@@ -12,11 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <cmath>
 #include <memory>
 #include <string>
 
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/op_version_registry.h"
+#include "paddle/fluid/operators/fused/cpu_fused_common_function.h"
 
 namespace paddle {
 namespace operators {
@@ -106,13 +108,30 @@ class FusedMultiTransformerOp : public framework::OperatorWithKernel {
                         paddle::platform::errors::InvalidArgument(
                             "The first dim of CacheKV must be 2, but got %d",
                             c_dim[0]));  // 2
-      PADDLE_ENFORCE_EQ(c_dim[1],
-                        x_dim[0],
-                        paddle::platform::errors::InvalidArgument(
-                            "The second dim of CacheKV must be equal with "
-                            "batch size %d, but got %d",
-                            x_dim[0],
-                            c_dim[1]));  // batch_size
+      if (ctx->HasInput("BlockTables")) {
+        // [2, num_blocks, num_head, block_size, head_size]
+        const auto &t_dim = ctx->GetInputDim("BlockTables");
+        PADDLE_ENFORCE_EQ(t_dim.size(),
+                          2,
+                          paddle::platform::errors::InvalidArgument(
+                              "The BlockTables must be 2 dims, but got %d",
+                              t_dim.size()));
+        PADDLE_ENFORCE_EQ(t_dim[0],
+                          x_dim[0],
+                          paddle::platform::errors::InvalidArgument(
+                              "The first dim of BlockTables must be equal "
+                              "with batch size %d, but got %d",
+                              x_dim[0],
+                              t_dim[0]));  // batch_size
+      } else {
+        PADDLE_ENFORCE_EQ(c_dim[1],
+                          x_dim[0],
+                          paddle::platform::errors::InvalidArgument(
+                              "The second dim of CacheKV must be equal with "
+                              "batch size %d, but got %d",
+                              x_dim[0],
+                              c_dim[1]));  // batch_size
+      }
       PADDLE_ENFORCE_EQ(c_dim[2],
                         trans_qkvw ? y_dim[1] : y_dim[2],
                         paddle::platform::errors::InvalidArgument(
@@ -143,7 +162,7 @@ class FusedMultiTransformerOp : public framework::OperatorWithKernel {
       const std::string &var_name,
       const phi::DenseTensor &tensor,
       const phi::KernelKey &expected_kernel_type) const override {
-    if (var_name == "TimeStep") {
+    if (var_name == "TimeStep" || var_name == "BlockTables") {
       VLOG(10) << "var_name:" << var_name << " need not to transform";
       return phi::KernelKey(phi::Backend::ALL_BACKEND,
                             expected_kernel_type.layout(),
@@ -184,6 +203,13 @@ class FusedMultiTransformerOpOpMaker
         .AsDispensable();
     AddInput("SeqLengths", "(optional) The sequence length tensor of inputs.")
         .AsDispensable();
+    AddInput("BlockTables",
+             "(optional, int) The block tables of a paged CacheKV, "
+             "[batch_size, max_blocks_per_seq]. Row i maps the logical blocks "
+             "of the i-th sequence to blocks of CacheKV, which is then "
+             "[2, num_blocks, num_head, block_size, head_size]. Only the CPU "
+             "kernel supports it.")
+        .AsDispensable();
     AddInput("SrcMask", "(optional) The attention mask tensor in fmha.")
         .AsDispensable();
     AddInput("OutLinearW", "The out_linear weight tensor.").AsDuplicable();
@@ -294,6 +320,526 @@ class FusedMultiTransformerOpOpMaker
   }
 };
 
+// CPU inference kernel. Dropout is not applied and tensor model parallel
+// (ring_id != -1) is not supported. Q, K and V are consumed in place from the
+// fused QKV projection, and every residual add is fused with the LayerNorm
+// that follows it.
+template <typename T, typename DeviceContext>
+class FusedMultiTransformerCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto &dev_ctx = ctx.template device_context<DeviceContext>();
+    auto blas = phi::funcs::GetBlas<DeviceContext, T>(dev_ctx);
+
+    // 0. input
+    auto *input_x = ctx.Input<phi::DenseTensor>("X");
+    const auto input_x_dims = input_x->dims();
+    int bsz = input_x_dims[0];
+    int seq_len = input_x_dims[1];
+    int dim_embed = input_x_dims[2];
+    int token_num = bsz * seq_len;
+
+    const bool pre_layer_norm = ctx.Attr<bool>("pre_layer_norm");
+    const float epsilon = ctx.Attr<float>("epsilon");
+    const std::string act_method = ctx.Attr<std::string>("act_method");
+    const bool trans_qkvw = ctx.Attr<bool>("trans_qkvw");
+    PADDLE_ENFORCE_EQ(ctx.Attr<int>("ring_id"),
+                      -1,
+                      platform::errors::Unimplemented(
+                          "Tensor model parallel of fused_multi_transformer "
+                          "is not supported on CPU."));
+
+    auto ln_scales = ctx.MultiInput<phi::DenseTensor>("LnScale");
+    auto ln_biases = ctx.MultiInput<phi::DenseTensor>("LnBias");
+    auto qkv_weights = ctx.MultiInput<phi::DenseTensor>("QKVW");
+    auto qkv_biases = ctx.MultiInput<phi::DenseTensor>("QKVBias");
+    auto out_linear_weights = ctx.MultiInput<phi::DenseTensor>("OutLinearW");
+    auto out_linear_biases = ctx.MultiInput<phi::DenseTensor>("OutLinearBias");
+    auto ffn_ln_scales = ctx.MultiInput<phi::DenseTensor>("FFNLnScale");
+    auto ffn_ln_biases = ctx.MultiInput<phi::DenseTensor>("FFNLnBias");
+    auto ffn1_weights = ctx.MultiInput<phi::DenseTensor>("FFN1Weight");
+    auto ffn1_biases = ctx.MultiInput<phi::DenseTensor>("FFN1Bias");
+    auto ffn2_weights = ctx.MultiInput<phi::DenseTensor>("FFN2Weight");
+    auto ffn2_biases = ctx.MultiInput<phi::DenseTensor>("FFN2Bias");
+
+    const auto qkv_w_dims = qkv_weights[0]->dims();
+    AttnShape shape;
+    shape.bsz = bsz;
+    shape.seq_len = seq_len;
+    shape.num_head = trans_qkvw ? qkv_w_dims[1] : qkv_w_dims[2];
+    shape.dim_head = trans_qkvw ? qkv_w_dims[2] : qkv_w_dims[3];
+    int hidden_size = shape.num_head * shape.dim_head;
+    int qkv_size = 3 * hidden_size;
+    int dim_ffn = ffn1_weights[0]->dims()[1];
+
+    auto *time_step = ctx.Input<phi::DenseTensor>("TimeStep");
+    auto pre_caches = ctx.MultiInput<phi::DenseTensor>("PreCaches");
+    if (time_step) {
+      PADDLE_ENFORCE_EQ(time_step->place(),
+                        platform::CPUPlace(),
+                        platform::errors::PreconditionNotMet(
+                            "The place of input(TimeStep) must be CPUPlace."));
+      shape.time_step = time_step->data<int>()[0];
+      PADDLE_ENFORCE_GT(shape.time_step,
+                        0,
+                        platform::errors::PreconditionNotMet(
+                            "The value of time_step must > 0, but now is %d",
+                            shape.time_step));
+      PADDLE_ENFORCE_EQ(
+          seq_len,
+          1,
+          platform::errors::PreconditionNotMet(
+              "In decode stage, the seq_len of input must be 1, but now is %d",
+              seq_len));
+      shape.kv_len = shape.time_step + 1;
+    } else {
+      shape.cache_offset = pre_caches.size() > 0 ? pre_caches[0]->dims()[3] : 0;
+      shape.kv_len = seq_len + shape.cache_offset;
+    }
+
+    // 1. buffers, the residual stream lives in Out
+    auto *out = ctx.Output<phi::DenseTensor>("Out");
+    auto *hidden_data = dev_ctx.template Alloc<T>(out);
+    std::memcpy(hidden_data,
+                input_x->data<T>(),
+                static_cast<int64_t>(token_num) * dim_embed * sizeof(T));
+
+    phi::DenseTensor ln_out, qkv_out, fmha_out, linear_out, ffn1_out, qk_out;
+    ln_out.Resize({token_num, dim_embed});
+    auto *ln_out_data = dev_ctx.template Alloc<T>(&ln_out);
+    qkv_out.Resize({token_num, qkv_size});
+    auto *qkv_out_data = dev_ctx.template Alloc<T>(&qkv_out);
+    fmha_out.Resize({token_num, hidden_size});
+    auto *fmha_out_data = dev_ctx.template Alloc<T>(&fmha_out);
+    linear_out.Resize({token_num, dim_embed});
+    auto *linear_out_data = dev_ctx.template Alloc<T>(&linear_out);
+    ffn1_out.Resize({token_num, dim_ffn});
+    auto *ffn1_out_data = dev_ctx.template Alloc<T>(&ffn1_out);
+    qk_out.Resize({bsz * shape.num_head, seq_len * shape.kv_len});
+    auto *qk_out_data = dev_ctx.template Alloc<T>(&qk_out);
+
+    auto cache_kvs = ctx.MultiInput<phi::DenseTensor>("CacheKV");
+    auto cache_kv_outs = ctx.MultiOutput<phi::DenseTensor>("CacheKVOut");
+    auto get_data = [](const std::vector<const phi::DenseTensor *> &tensors,
+                       int i) -> const T * {
+      return tensors.size() > 0 ? tensors[i]->data<T>() : nullptr;
+    };
+
+    int layers = qkv_weights.size();
+    for (int i = 0; i < layers; ++i) {
+      // step1. layer_norm, for the later layers of pre_layer_norm it has been
+      // fused into the last residual add of the previous layer.
+      const T *attn_in = hidden_data;
+      if (pre_layer_norm) {
+        if (i == 0) {
+          CPUResidualLayerNorm<T>(dev_ctx,
+                                  hidden_data,
+                                  nullptr,
+                                  nullptr,
+                                  ln_scales[i]->data<T>(),
+                                  ln_biases[i]->data<T>(),
+                                  nullptr,
+                                  ln_out_data,
+                                  nullptr,
+                                  nullptr,
+                                  token_num,
+                                  dim_embed,
+                                  epsilon);
+        }
+        attn_in = ln_out_data;
+      }
+
+      // step2. qkv
+      blas.GEMM(CblasNoTrans,
+                trans_qkvw ? CblasTrans : CblasNoTrans,
+                token_num,
+                qkv_size,
+                dim_embed,
+                static_cast<T>(1),
+                attn_in,
+                qkv_weights[i]->data<T>(),
+                static_cast<T>(0),
+                qkv_out_data);
+      CPUAddBiasAct<T>(
+          qkv_out_data, get_data(qkv_biases, i), token_num, qkv_size, "none");
+
+      // step3. fmha
+      // CacheKVOut is inplace with CacheKV.
+      phi::DenseTensor *cache_kv_out =
+          cache_kvs.size() > 0 ? cache_kv_outs[i] : nullptr;
+      ComputeAttention(ctx,
+                       blas,
+                       shape,
+                       qkv_out_data,
+                       pre_caches.size() > 0 ? pre_caches[i] : nullptr,
+                       cache_kv_out,
+                       qk_out_data,
+                       fmha_out_data);
+
+      // step4. out_linear
+      blas.MatMul(token_num,
+                  dim_embed,
+                  hidden_size,
+                  fmha_out_data,
+                  out_linear_weights[i]->data<T>(),
+                  linear_out_data);
+
+      // step5. ln(residual + bias)
+      const T *ffn_in = hidden_data;
+      if (pre_layer_norm) {
+        CPUResidualLayerNorm<T>(dev_ctx,
+                                linear_out_data,
+                                hidden_data,
+                                get_data(out_linear_biases, i),
+                                ffn_ln_scales[i]->data<T>(),
+                                ffn_ln_biases[i]->data<T>(),
+                                hidden_data,
+                                ln_out_data,
+                                nullptr,
+                                nullptr,
+                                token_num,
+                                dim_embed,
+                                epsilon);
+        ffn_in = ln_out_data;
+      } else {
+        CPUResidualLayerNorm<T>(dev_ctx,
+                                linear_out_data,
+                                hidden_data,
+                                get_data(out_linear_biases, i),
+                                ln_scales[i]->data<T>(),
+                                ln_biases[i]->data<T>(),
+                                nullptr,
+                                hidden_data,
+                                nullptr,
+                                nullptr,
+                                token_num,
+                                dim_embed,
+                                epsilon);
+      }
+
+      // step6. ffn1 matmul + bias + act
+      blas.MatMul(token_num,
+                  dim_ffn,
+                  dim_embed,
+                  ffn_in,
+                  ffn1_weights[i]->data<T>(),
+                  ffn1_out_data);
+      CPUAddBiasAct<T>(ffn1_out_data,
+                       get_data(ffn1_biases, i),
+                       token_num,
+                       dim_ffn,
+                       act_method);
+
+      // step7. ffn2 matmul
+      blas.MatMul(token_num,
+                  dim_embed,
+                  dim_ffn,
+                  ffn1_out_data,
+                  ffn2_weights[i]->data<T>(),
+                  linear_out_data);
+
+      // step8. layer norm + bias_add + residual
+      if (pre_layer_norm) {
+        if (i < layers - 1) {
+          CPUResidualLayerNorm<T>(dev_ctx,
+                                  linear_out_data,
+                                  hidden_data,
+                                  get_data(ffn2_biases, i),
+                                  ln_scales[i + 1]->data<T>(),
+                                  ln_biases[i + 1]->data<T>(),
+                                  hidden_data,
+                                  ln_out_data,
+                                  nullptr,
+                                  nullptr,
+                                  token_num,
+                                  dim_embed,
+                                  epsilon);
+        } else {
+          CPUResidualBias<T>(hidden_data,
+                             linear_out_data,
+                             get_data(ffn2_biases, i),
+                             token_num,
+                             dim_embed);
+        }
+      } else {
+        CPUResidualLayerNorm<T>(dev_ctx,
+                                linear_out_data,
+                                hidden_data,
+                                get_data(ffn2_biases, i),
+                                ffn_ln_scales[i]->data<T>(),
+                                ffn_ln_biases[i]->data<T>(),
+                                nullptr,
+                                hidden_data,
+                                nullptr,
+                                nullptr,
+                                token_num,
+                                dim_embed,
+                                epsilon);
+      }
+    }
+  }
+
+ private:
+  struct AttnShape {
+    int bsz{0};
+    int seq_len{0};
+    int num_head{0};
+    int dim_head{0};
+    // Number of keys every query attends to.
+    int kv_len{0};
+    // Decoding step, 0 in the encoder and context stages.
+    int time_step{0};
+    // Sequence length of PreCaches.
+    int cache_offset{0};
+  };
+
+  // Attention of every (batch, head) pair on the [token_num, 3, num_head,
+  // dim_head] projection qkv, written into fmha_out [token_num, num_head,
+  // dim_head]. Without a cache the keys and values are read in place from
+  // qkv; otherwise the new keys and values are appended to cache_kv_out,
+  // contiguous or paged by BlockTables, and attention reads them back from
+  // there.
+  void ComputeAttention(const framework::ExecutionContext &ctx,
+                        const phi::funcs::BlasT<DeviceContext, T> &blas,
+                        const AttnShape &shape,
+                        T *qkv,
+                        const phi::DenseTensor *pre_cache,
+                        phi::DenseTensor *cache_kv_out,
+                        T *qk,
+                        T *fmha_out) const {
+    auto *rotary_tensor = ctx.Input<phi::DenseTensor>("RotaryPosEmb");
+    auto *sequence_lengths = ctx.Input<phi::DenseTensor>("SeqLengths");
+    auto *src_mask = ctx.Input<phi::DenseTensor>("SrcMask");
+    const int rotary_emb_dims = ctx.Attr<int>("rotary_emb_dims");
+
+    const int bsz = shape.bsz;
+    const int seq_len = shape.seq_len;
+    const int num_head = shape.num_head;
+    const int dim_head = shape.dim_head;
+    const int hidden_size = num_head * dim_head;
+    const int qkv_size = 3 * hidden_size;
+    const int *seq_lens_data =
+        sequence_lengths ? sequence_lengths->data<int>() : nullptr;
+    const T scale = static_cast<T>(1. / std::sqrt(dim_head));
+
+    // SrcMask is [bsz or 1, num_head or 1, seq_len, kv_len].
+    const T *mask_data = src_mask ? src_mask->data<T>() : nullptr;
+    int64_t mask_batch_stride = 0;
+    int64_t mask_head_stride = 0;
+    int mask_ld = 0;
+    if (src_mask) {
+      auto mask_dims = src_mask->dims();
+      mask_ld = mask_dims[mask_dims.size() - 1];
+      if (mask_dims[0] > 1) {
+        mask_batch_stride = src_mask->numel() / mask_dims[0];
+      }
+      if (mask_dims.size() == 4 && mask_dims[1] > 1) {
+        mask_head_stride = mask_dims[2] * mask_dims[3];
+      }
+    }
+
+    const T *rotary_emb =
+        rotary_emb_dims != 0 ? rotary_tensor->data<T>() : nullptr;
+    int64_t rotary_sin_offset =
+        static_cast<int64_t>(bsz) * seq_len * dim_head;
+
+    if (shape.time_step > 0 && seq_lens_data) {
+      for (int b = 0; b < bsz; ++b) {
+        PADDLE_ENFORCE_EQ(
+            seq_lens_data[b] >= 0 && seq_lens_data[b] <= shape.time_step,
+            true,
+            platform::errors::InvalidArgument(
+                "SeqLengths[%d] (%d) should be in [0, %d] when decoding.",
+                b,
+                seq_lens_data[b],
+                shape.time_step));
+      }
+    }
+    // Number of cached tokens of the b-th sequence after this step.
+    auto cache_len_of = [&](int b) {
+      if (shape.time_step > 0) {
+        return (seq_lens_data ? seq_lens_data[b] : shape.time_step) + 1;
+      }
+      return shape.cache_offset + seq_len;
+    };
+
+    // CacheKV is [2, bsz, num_head, max_seq_len, dim_head], or
+    // [2, num_blocks, num_head, block_size, dim_head] when it is paged by
+    // BlockTables [bsz, max_blocks_per_seq]. A contiguous cache is handled
+    // as a paged one whose sequences own a single block of max_seq_len rows.
+    auto *block_tables = ctx.Input<phi::DenseTensor>("BlockTables");
+    const int *block_tables_data = nullptr;
+    int max_blocks = 1;
+    int block_size = 0;
+    T *cache_k = nullptr;
+    T *cache_v = nullptr;
+    if (cache_kv_out) {
+      const auto cache_dims = cache_kv_out->dims();
+      const int num_blocks = cache_dims[1];
+      block_size = cache_dims[3];
+      if (block_tables) {
+        PADDLE_ENFORCE_EQ(
+            block_tables->place(),
+            platform::CPUPlace(),
+            platform::errors::PreconditionNotMet(
+                "The place of input(BlockTables) must be CPUPlace."));
+        block_tables_data = block_tables->data<int>();
+        max_blocks = block_tables->dims()[1];
+      }
+      for (int b = 0; b < bsz; ++b) {
+        const int cache_len = cache_len_of(b);
+        PADDLE_ENFORCE_LE(
+            cache_len,
+            max_blocks * block_size,
+            platform::errors::InvalidArgument(
+                "The sequence length to cache (%d) exceeds the capacity of "
+                "CacheKV (%d).",
+                cache_len,
+                max_blocks * block_size));
+        for (int j = 0; block_tables_data && j * block_size < cache_len;
+             ++j) {
+          const int block = block_tables_data[b * max_blocks + j];
+          PADDLE_ENFORCE_EQ(
+              block >= 0 && block < num_blocks,
+              true,
+              platform::errors::InvalidArgument(
+                  "BlockTables[%d][%d] (%d) should be a block of CacheKV in "
+                  "[0, %d).",
+                  b,
+                  j,
+                  block,
+                  num_blocks));
+        }
+      }
+      cache_k = cache_kv_out->data<T>();
+      cache_v = cache_k + cache_kv_out->numel() / 2;
+    }
+    const int64_t block_stride =
+        static_cast<int64_t>(num_head) * block_size * dim_head;
+    const int64_t head_stride = static_cast<int64_t>(block_size) * dim_head;
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < bsz * num_head; ++i) {
+      const int b = i / num_head;
+      const int h = i % num_head;
+      T *q = qkv + static_cast<int64_t>(b) * seq_len * qkv_size + h * dim_head;
+      T *k = q + hidden_size;
+      const T *v = q + 2 * hidden_size;
+      const T *mask = mask_data ? mask_data + b * mask_batch_stride +
+                                      h * mask_head_stride
+                                : nullptr;
+      T *head_qk = qk + static_cast<int64_t>(i) * seq_len * shape.kv_len;
+      T *out =
+          fmha_out + static_cast<int64_t>(b) * seq_len * hidden_size +
+          h * dim_head;
+
+      if (rotary_emb) {
+        const T *cos =
+            rotary_emb + static_cast<int64_t>(b) * seq_len * dim_head;
+        const T *sin = cos + rotary_sin_offset;
+        // Padded tokens of the encoder are skipped, as the GPU kernel does.
+        int seq_limit =
+            seq_lens_data && shape.time_step == 0 ? seq_lens_data[b] : seq_len;
+        CPURotaryEmb<T>(q,
+                        qkv_size,
+                        cos,
+                        sin,
+                        seq_len,
+                        seq_limit,
+                        dim_head,
+                        rotary_emb_dims);
+        CPURotaryEmb<T>(k,
+                        qkv_size,
+                        cos,
+                        sin,
+                        seq_len,
+                        seq_limit,
+                        dim_head,
+                        rotary_emb_dims);
+      }
+
+      if (!cache_kv_out) {
+        CPUHeadAttention<T>(blas,
+                            q,
+                            qkv_size,
+                            k,
+                            qkv_size,
+                            v,
+                            qkv_size,
+                            mask,
+                            mask_ld,
+                            out,
+                            hidden_size,
+                            head_qk,
+                            seq_len,
+                            seq_len,
+                            dim_head,
+                            scale);
+        continue;
+      }
+
+      // The blocks of this sequence, a contiguous cache has one per head.
+      const int contiguous_block = b;
+      const int *block_table = block_tables_data
+                                   ? block_tables_data + b * max_blocks
+                                   : &contiguous_block;
+      const T *head_cache_k = cache_k + h * head_stride;
+      const T *head_cache_v = cache_v + h * head_stride;
+      // Offset of the cached row at pos of this head.
+      auto cache_row = [&](int pos) {
+        return block_table[pos / block_size] * block_stride +
+               h * head_stride + (pos % block_size) * dim_head;
+      };
+
+      int write_pos = shape.cache_offset;
+      if (shape.time_step > 0) {
+        // generation decoder stage, the new token goes after the cached ones
+        write_pos = seq_lens_data ? seq_lens_data[b] : shape.time_step;
+      } else if (pre_cache) {
+        // generation context stage, PreCaches is
+        // [2, bsz, num_head, cache_offset, dim_head]
+        const int64_t pre_size = static_cast<int64_t>(i) * shape.cache_offset *
+                                 dim_head;
+        const T *pre_k = pre_cache->data<T>() + pre_size;
+        const T *pre_v = pre_k + static_cast<int64_t>(bsz) * num_head *
+                                     shape.cache_offset * dim_head;
+        for (int s = 0; s < shape.cache_offset; ++s) {
+          const int64_t src = static_cast<int64_t>(s) * dim_head;
+          std::memcpy(
+              cache_k + cache_row(s), pre_k + src, dim_head * sizeof(T));
+          std::memcpy(
+              cache_v + cache_row(s), pre_v + src, dim_head * sizeof(T));
+        }
+      }
+      for (int s = 0; s < seq_len; ++s) {
+        const int64_t src = static_cast<int64_t>(s) * qkv_size;
+        const int64_t dst = cache_row(write_pos + s);
+        std::memcpy(cache_k + dst, k + src, dim_head * sizeof(T));
+        std::memcpy(cache_v + dst, v + src, dim_head * sizeof(T));
+      }
+      CPUPagedHeadAttention<T>(blas,
+                               q,
+                               qkv_size,
+                               head_cache_k,
+                               head_cache_v,
+                               block_table,
+                               block_stride,
+                               block_size,
+                               mask,
+                               mask_ld,
+                               out,
+                               hidden_size,
+                               head_qk,
+                               seq_len,
+                               cache_len_of(b),
+                               dim_head,
+                               scale);
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -305,6 +851,12 @@ REGISTER_OPERATOR(
     paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
     paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
 
+PD_REGISTER_STRUCT_KERNEL(fused_multi_transformer,
+                          CPU,
+                          ALL_LAYOUT,
+                          ops::FusedMultiTransformerCPUKernel,
+                          float) {}
+
 REGISTER_OP_VERSION(fused_multi_transformer)
     .AddCheckpoint(
         R"ROC(
@@ -27,6 +27,11 @@ class FusedMultiTransformerOpKernel : public framework::OpKernel<T> {
     auto &dev_ctx = ctx.cuda_device_context();
 
     auto *time_step = ctx.Input<phi::DenseTensor>("TimeStep");
+    PADDLE_ENFORCE_EQ(ctx.HasInput("BlockTables"),
+                      false,
+                      platform::errors::Unimplemented(
+                          "The paged CacheKV (input BlockTables) of "
+                          "fused_multi_transformer is only supported on CPU."));
     // 0. input
     auto *input_x = ctx.Input<phi::DenseTensor>("X");
     const auto input_x_dims = input_x->dims();
@@ -693,6 +698,11 @@ class FusedMultiTransformerOpKernel : public framework::OpKernel<T> {
     auto &dev_ctx = ctx.cuda_device_context();
 
     auto *time_step = ctx.Input<phi::DenseTensor>("TimeStep");
+    PADDLE_ENFORCE_EQ(ctx.HasInput("BlockTables"),
+                      false,
+                      platform::errors::Unimplemented(
+                          "The paged CacheKV (input BlockTables) of "
+                          "fused_multi_transformer is only supported on CPU."));
     // 0. input
     auto *input_x = ctx.Input<phi::DenseTensor>("X");
     const auto input_x_dims = input_x->dims();
@@ -26,8 +26,14 @@ class FusionGroupOp : public framework::OperatorWithKernel {
  protected:
   phi::KernelKey GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
+    // The code is only compiled for CUDAPlace(0) on GPU, see
+    // fusion_group_pass.
+    if (platform::is_gpu_place(ctx.GetPlace())) {
+      return phi::KernelKey(framework::proto::VarType::FP32,
+                            platform::CUDAPlace(0));
+    }
     return phi::KernelKey(framework::proto::VarType::FP32,
-                          platform::CUDAPlace(0));
+                          platform::CPUPlace());
   };
 };
 
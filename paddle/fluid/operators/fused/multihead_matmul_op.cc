@@ -15,6 +15,7 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/fused/cpu_fused_common_function.h"
 #include "paddle/fluid/platform/errors.h"
 
 namespace paddle {
@@ -107,6 +108,118 @@ Example of matrix multiplication with head_number of B
   }
 };
 
+template <typename T, typename DeviceContext>
+class MultiHeadMatMulV2CPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *input = context.Input<phi::DenseTensor>("Input");
+    auto *w = context.Input<phi::DenseTensor>("W");
+    auto *bias = context.Input<phi::DenseTensor>("Bias");
+    auto *bias_qk = context.Input<phi::DenseTensor>("BiasQK");
+    auto *out = context.Output<phi::DenseTensor>("Out");
+    T scale = static_cast<T>(context.Attr<float>("alpha"));
+    int head_number = context.Attr<int>("head_number");
+
+    auto &dev_ctx = context.template device_context<DeviceContext>();
+    auto blas = phi::funcs::GetBlas<DeviceContext, T>(dev_ctx);
+
+    // Input: (B, S, hidden), W: (hidden, 3, N * H)
+    auto input_dims = input->dims();
+    int batch = input_dims[0];
+    int seq_len = input_dims[1];
+    int hidden = input_dims[2];
+    int all_head_size = w->dims()[2];
+    int head_size = all_head_size / head_number;
+    int qkv_size = 3 * all_head_size;
+
+    out->Resize({batch, seq_len, all_head_size});
+    auto *out_data = dev_ctx.template Alloc<T>(out);
+
+    // (B * S, hidden) * (hidden, 3 * N * H) + Bias -> (B, S, 3, N, H)
+    phi::DenseTensor qkv;
+    qkv.Resize({batch * seq_len, qkv_size});
+    auto *qkv_data = dev_ctx.template Alloc<T>(&qkv);
+    blas.MatMul(batch * seq_len,
+                qkv_size,
+                hidden,
+                input->data<T>(),
+                w->data<T>(),
+                qkv_data);
+    CPUAddBiasAct<T>(
+        qkv_data, bias->data<T>(), batch * seq_len, qkv_size, "none");
+
+    // BiasQK is [B or 1, N or 1, S or 1, S], e.g. [B, N, S, S], [B, 1, 1, S]
+    // or [1, 1, S, S], with the leading dims of size 1 possibly left out.
+    // The broadcast is done through the offsets and the leading dimension
+    // instead of materializing the full tensor.
+    const T *bias_qk_data = bias_qk ? bias_qk->data<T>() : nullptr;
+    int64_t bias_qk_batch_stride = 0;
+    int64_t bias_qk_head_stride = 0;
+    int bias_qk_ld = seq_len;
+    if (bias_qk) {
+      auto bias_qk_dims = bias_qk->dims();
+      const int rank = bias_qk_dims.size();
+      PADDLE_ENFORCE_EQ(
+          rank >= 1 && rank <= 4 && bias_qk_dims[rank - 1] == seq_len,
+          true,
+          platform::errors::InvalidArgument(
+              "Input(BiasQK) of MultiHeadMatMul should be at most 4-D with "
+              "the last dim of seq_len %d, but received dims [%s].",
+              seq_len,
+              bias_qk_dims));
+      auto dim = [&](int i) {
+        return i + rank >= 4 ? bias_qk_dims[i + rank - 4] : 1;
+      };
+      if (dim(2) == 1) {
+        bias_qk_ld = 0;
+      }
+      if (dim(1) > 1) {
+        bias_qk_head_stride = dim(2) * seq_len;
+      }
+      if (dim(0) > 1) {
+        bias_qk_batch_stride = dim(1) * dim(2) * seq_len;
+      }
+    }
+
+    phi::DenseTensor qk;
+    qk.Resize({batch * head_number, seq_len * seq_len});
+    auto *qk_data = dev_ctx.template Alloc<T>(&qk);
+    // Q, K and V of every head are read in place from the (B, S, 3, N, H)
+    // projection and the result is written in place into (B, S, N, H).
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < batch * head_number; ++i) {
+      int b = i / head_number;
+      int h = i % head_number;
+      const T *q = qkv_data + static_cast<int64_t>(b) * seq_len * qkv_size +
+                   h * head_size;
+      const T *mask = bias_qk_data ? bias_qk_data + b * bias_qk_batch_stride +
+                                         h * bias_qk_head_stride
+                                   : nullptr;
+      CPUHeadAttention<T>(blas,
+                          q,
+                          qkv_size,
+                          q + all_head_size,
+                          qkv_size,
+                          q + 2 * all_head_size,
+                          qkv_size,
+                          mask,
+                          bias_qk_ld,
+                          out_data +
+                              static_cast<int64_t>(b) * seq_len *
+                                  all_head_size +
+                              h * head_size,
+                          all_head_size,
+                          qk_data + static_cast<int64_t>(i) * seq_len * seq_len,
+                          seq_len,
+                          seq_len,
+                          head_size,
+                          scale);
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -114,3 +227,9 @@ namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(multihead_matmul,
                              ops::MultiHeadMatMulV2Op,
                              ops::MultiHeadMatMulV2OpMaker);
+
+PD_REGISTER_STRUCT_KERNEL(multihead_matmul,
+                          CPU,
+                          ALL_LAYOUT,
+                          ops::MultiHeadMatMulV2CPUKernel,
+                          float) {}
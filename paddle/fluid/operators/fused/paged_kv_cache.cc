@@ -0,0 +1,163 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/fused/paged_kv_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/enforce.h"
+
+namespace paddle {
+namespace operators {
+
+PagedKVCacheManager::PagedKVCacheManager(int num_blocks, int block_size)
+    : num_blocks_(num_blocks), block_size_(block_size) {
+  PADDLE_ENFORCE_GT(num_blocks,
+                    0,
+                    phi::errors::InvalidArgument(
+                        "The number of cache blocks must be positive, but "
+                        "received %d.",
+                        num_blocks));
+  PADDLE_ENFORCE_GT(
+      block_size,
+      0,
+      phi::errors::InvalidArgument(
+          "The block size must be positive, but received %d.", block_size));
+  Reset(0);
+}
+
+void PagedKVCacheManager::Reset(int batch_size) {
+  ref_counts_.assign(num_blocks_, 0);
+  free_blocks_.resize(num_blocks_);
+  // Hand out the low blocks first.
+  for (int i = 0; i < num_blocks_; ++i) {
+    free_blocks_[i] = num_blocks_ - 1 - i;
+  }
+  block_tables_.assign(batch_size, std::vector<int>());
+  seq_lens_.assign(batch_size, 0);
+}
+
+int PagedKVCacheManager::AllocateBlock() {
+  PADDLE_ENFORCE_EQ(free_blocks_.empty(),
+                    false,
+                    phi::errors::ResourceExhausted(
+                        "All %d blocks of the paged KV cache are in use.",
+                        num_blocks_));
+  int block = free_blocks_.back();
+  free_blocks_.pop_back();
+  ref_counts_[block] = 1;
+  return block;
+}
+
+void PagedKVCacheManager::ReleaseBlock(int block) {
+  if (--ref_counts_[block] == 0) {
+    free_blocks_.push_back(block);
+  }
+}
+
+void PagedKVCacheManager::CopyBlock(
+    int src, int dst, const std::vector<phi::DenseTensor *> &cache_kvs) const {
+  for (auto *cache_kv : cache_kvs) {
+    PADDLE_ENFORCE_EQ(cache_kv->dims().size() == 5 &&
+                          cache_kv->dims()[1] == num_blocks_ &&
+                          cache_kv->dims()[3] == block_size_,
+                      true,
+                      phi::errors::InvalidArgument(
+                          "The paged CacheKV should be [2, %d, num_head, %d, "
+                          "head_size], but received [%s].",
+                          num_blocks_,
+                          block_size_,
+                          cache_kv->dims()));
+    const int64_t block_bytes = cache_kv->numel() / (2 * num_blocks_) *
+                                phi::SizeOf(cache_kv->dtype());
+    auto *data = static_cast<uint8_t *>(cache_kv->data());
+    for (int kv = 0; kv < 2; ++kv) {
+      uint8_t *base = data + kv * num_blocks_ * block_bytes;
+      std::memcpy(
+          base + dst * block_bytes, base + src * block_bytes, block_bytes);
+    }
+  }
+}
+
+void PagedKVCacheManager::Append(
+    int num_tokens, const std::vector<phi::DenseTensor *> &cache_kvs) {
+  for (size_t i = 0; i < seq_lens_.size(); ++i) {
+    auto &table = block_tables_[i];
+    const int begin = seq_lens_[i];
+    const int end = begin + num_tokens;
+    for (int j = begin / block_size_; j * block_size_ < end; ++j) {
+      if (j == static_cast<int>(table.size())) {
+        table.push_back(AllocateBlock());
+      } else if (ref_counts_[table[j]] > 1) {
+        // copy on write of a block shared with other beams
+        int block = AllocateBlock();
+        CopyBlock(table[j], block, cache_kvs);
+        ReleaseBlock(table[j]);
+        table[j] = block;
+      }
+    }
+    seq_lens_[i] = end;
+  }
+}
+
+void PagedKVCacheManager::Reorder(const phi::DenseTensor &parent_idx) {
+  const int *parents = parent_idx.data<int>();
+  const int batch_size = static_cast<int>(parent_idx.numel());
+  std::vector<std::vector<int>> block_tables(batch_size);
+  std::vector<int> seq_lens(batch_size);
+  for (int i = 0; i < batch_size; ++i) {
+    PADDLE_ENFORCE_EQ(parents[i] >= 0 && parents[i] < BatchSize(),
+                      true,
+                      phi::errors::InvalidArgument(
+                          "parent_idx[%d] (%d) should be in [0, %d).",
+                          i,
+                          parents[i],
+                          BatchSize()));
+    block_tables[i] = block_tables_[parents[i]];
+    seq_lens[i] = seq_lens_[parents[i]];
+    for (int block : block_tables[i]) {
+      ++ref_counts_[block];
+    }
+  }
+  for (const auto &table : block_tables_) {
+    for (int block : table) {
+      ReleaseBlock(block);
+    }
+  }
+  block_tables_.swap(block_tables);
+  seq_lens_.swap(seq_lens);
+}
+
+void PagedKVCacheManager::GetBlockTables(
+    phi::DenseTensor *block_tables) const {
+  size_t max_blocks = 1;
+  for (const auto &table : block_tables_) {
+    max_blocks = std::max(max_blocks, table.size());
+  }
+  int *data = block_tables->mutable_data<int>(
+      phi::make_ddim({BatchSize(), static_cast<int64_t>(max_blocks)}),
+      phi::CPUPlace());
+  std::fill(data, data + BatchSize() * max_blocks, -1);
+  for (int i = 0; i < BatchSize(); ++i) {
+    std::copy(block_tables_[i].begin(),
+              block_tables_[i].end(),
+              data + i * max_blocks);
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
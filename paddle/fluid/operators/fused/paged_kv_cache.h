@@ -0,0 +1,78 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace operators {
+
+// Host side bookkeeping of the paged CacheKV of fused_multi_transformer.
+//
+// The caches of all layers share the block pool layout
+// [2, num_blocks, num_head, block_size, head_size] and one set of block
+// tables, so a block id names the same slot in every layer. The sequences are
+// the rows of the running batch. Blocks are reference counted: after a beam
+// search step Reorder lets every beam share the blocks of its parent, and a
+// shared block is only copied when a beam is about to write into it.
+//
+// A decoding loop calls Append(1, caches) and GetBlockTables before each run
+// of the op, with TimeStep (or SeqLengths) set to the length before Append,
+// and Reorder with the parent_idx output of beam_search after it.
+class PagedKVCacheManager {
+ public:
+  PagedKVCacheManager(int num_blocks, int block_size);
+
+  // Starts a batch of batch_size empty sequences, releasing every block.
+  void Reset(int batch_size);
+
+  // Reserves num_tokens more tokens for every sequence. New blocks are taken
+  // from the pool, and shared blocks that the new tokens go into are copied
+  // in each cache of cache_kvs first.
+  void Append(int num_tokens,
+              const std::vector<phi::DenseTensor *> &cache_kvs);
+
+  // Replaces the i-th sequence by the parent_idx[i]-th one. parent_idx is an
+  // int32 tensor such as the parent_idx output of beam_search, and its size
+  // becomes the new batch size.
+  void Reorder(const phi::DenseTensor &parent_idx);
+
+  // Writes the int32 block tables [batch_size, max_blocks_per_seq] of the
+  // batch on CPU, unused entries are -1.
+  void GetBlockTables(phi::DenseTensor *block_tables) const;
+
+  int BatchSize() const { return static_cast<int>(seq_lens_.size()); }
+  int SeqLength(int i) const { return seq_lens_[i]; }
+  int NumFreeBlocks() const { return static_cast<int>(free_blocks_.size()); }
+
+ private:
+  int AllocateBlock();
+  void ReleaseBlock(int block);
+  void CopyBlock(int src,
+                 int dst,
+                 const std::vector<phi::DenseTensor *> &cache_kvs) const;
+
+  int num_blocks_;
+  int block_size_;
+  std::vector<int> ref_counts_;
+  std::vector<int> free_blocks_;
+  std::vector<std::vector<int>> block_tables_;
+  std::vector<int> seq_lens_;
+};
+
+}  // namespace operators
+}  // namespace paddle
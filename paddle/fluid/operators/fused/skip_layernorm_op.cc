@@ -15,6 +15,7 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/fused/cpu_fused_common_function.h"
 #include "paddle/fluid/platform/errors.h"
 
 namespace paddle {
@@ -89,6 +90,39 @@ This op is used for skip_layernorm_fuse_pass, which fuse op pattern as followed.
   }
 };
 
+template <typename T, typename DeviceContext>
+class SkipLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *x = context.Input<phi::DenseTensor>("X");
+    auto *y = context.Input<phi::DenseTensor>("Y");
+    auto *scale = context.Input<phi::DenseTensor>("Scale");
+    auto *bias = context.Input<phi::DenseTensor>("Bias");
+    auto *out = context.Output<phi::DenseTensor>("Out");
+    float epsilon = context.Attr<float>("epsilon");
+
+    auto &dev_ctx = context.template device_context<DeviceContext>();
+    out->Resize(x->dims());
+    auto *out_data = dev_ctx.template Alloc<T>(out);
+
+    int hidden = x->dims()[x->dims().size() - 1];
+    int rows = static_cast<int>(x->numel() / hidden);
+    CPUResidualLayerNorm<T>(dev_ctx,
+                            x->data<T>(),
+                            y->data<T>(),
+                            nullptr,
+                            scale->data<T>(),
+                            bias->data<T>(),
+                            nullptr,
+                            out_data,
+                            nullptr,
+                            nullptr,
+                            rows,
+                            hidden,
+                            epsilon);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -96,3 +130,6 @@ namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(skip_layernorm,
                              ops::SkipLayerNormOp,
                              ops::SkipLayerNormOpMaker);
+
+PD_REGISTER_STRUCT_KERNEL(
+    skip_layernorm, CPU, ALL_LAYOUT, ops::SkipLayerNormCPUKernel, float) {}
@@ -18,7 +18,9 @@ limitations under the License. */
 #include <codecvt>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <numeric>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -83,42 +85,311 @@ inline bool IsPunctuation(const wchar_t& ch) {
   return false;
 }
 
-BasicTokenizer::BasicTokenizer(bool do_lower_case /* = true */)
-    : do_lower_case_(do_lower_case) {}
+namespace {
+
+// What BasicTokenizer does with a character.
+enum class CharAction : uint8_t {
+  kSkip,
+  // Ends the current token.
+  kSplit,
+  // Ends the current token, and is a token by itself.
+  kSingleCharToken,
+  // Is appended to the current token.
+  kAppend,
+};
 
-wchar_t BasicTokenizer::do_lower_case(wchar_t ch) const {
-  wchar_t new_ch = utf8proc_tolower(ch);
-  return new_ch;
+// Sets ch to the character to output, lowercased if needed.
+CharAction GetCharAction(bool do_lower_case, wchar_t* ch) {
+  if (*ch == 0 || *ch == 0xfffd || IsControl(*ch)) {
+    return CharAction::kSkip;
+  }
+  if (do_lower_case) {
+    *ch = utf8proc_tolower(*ch);
+  }
+  if (IsChineseChar(*ch) || IsPunctuation(*ch)) {
+    return CharAction::kSingleCharToken;
+  } else if (IsWhiteSpace(*ch)) {
+    return CharAction::kSplit;
+  }
+  return CharAction::kAppend;
 }
 
-void BasicTokenizer::Tokenize(const string& text, vector<wstring>* res) const {
-  std::wstring unicode_text;
-  bool status = framework::ConvertStrToWstr(text, &unicode_text);
-  if (!status) {
-    // String is converted into wstring failedly.
-    return;
+// The actions of the ASCII characters, which make up most of the text, so
+// that they are not looked up in the unicode tables one by one.
+struct AsciiCharTable {
+  explicit AsciiCharTable(bool do_lower_case) {
+    for (int i = 0; i < 128; ++i) {
+      wchar_t ch = i;
+      actions[i] = GetCharAction(do_lower_case, &ch);
+      // The lowercase of an ASCII character is ASCII.
+      chars[i] = static_cast<char>(ch);
+    }
   }
-  std::wstring cache_text = L"";
-  auto PushCacheText = [&]() {
-    if (cache_text != L"") {
-      res->emplace_back(cache_text);
-      cache_text = L"";
+
+  CharAction actions[128];
+  char chars[128];
+};
+
+const AsciiCharTable& GetAsciiCharTable(bool do_lower_case) {
+  static const AsciiCharTable lower_table(true);
+  static const AsciiCharTable table(false);
+  return do_lower_case ? lower_table : table;
+}
+
+void AppendUtf8(wchar_t ch, string* str) {
+  uint32_t c = ch;
+  if (c < 0x80) {
+    str->push_back(static_cast<char>(c));
+  } else if (c < 0x800) {
+    str->push_back(static_cast<char>(0xC0 | (c >> 6)));
+    str->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  } else if (c < 0x10000) {
+    str->push_back(static_cast<char>(0xE0 | (c >> 12)));
+    str->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+    str->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  } else {
+    str->push_back(static_cast<char>(0xF0 | (c >> 18)));
+    str->push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+    str->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+    str->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  }
+}
+
+inline bool IsUtf8Continuation(uint8_t c) { return (c & 0xC0) == 0x80; }
+
+// Decodes the character at the start of str, exactly as the
+// std::codecvt_utf8 of ConvertStrToWstr, so that the tokens do not change:
+// the surrogates are accepted, and a character cut at the end of the text
+// ends it. Returns its length, 0 if it is cut, or -1 if it is not valid.
+int DecodeUtf8(const uint8_t* str, size_t len, wchar_t* ch) {
+  uint8_t c1 = str[0];
+  if (c1 < 0x80) {
+    *ch = c1;
+    return 1;
+  } else if (c1 < 0xC2) {
+    return -1;
+  } else if (c1 < 0xE0) {
+    if (len < 2) return 0;
+    if (!IsUtf8Continuation(str[1])) return -1;
+    *ch = ((c1 & 0x1F) << 6) | (str[1] & 0x3F);
+    return 2;
+  } else if (c1 < 0xF0) {
+    if (len < 3) return 0;
+    if (!IsUtf8Continuation(str[1]) || (c1 == 0xE0 && str[1] < 0xA0) ||
+        !IsUtf8Continuation(str[2])) {
+      return -1;
+    }
+    *ch = ((c1 & 0x0F) << 12) | ((str[1] & 0x3F) << 6) | (str[2] & 0x3F);
+    return 3;
+  } else if (c1 < 0xF5) {
+    if (len < 4) return 0;
+    if (!IsUtf8Continuation(str[1]) || (c1 == 0xF0 && str[1] < 0x90) ||
+        (c1 == 0xF4 && str[1] >= 0x90) || !IsUtf8Continuation(str[2]) ||
+        !IsUtf8Continuation(str[3])) {
+      return -1;
     }
+    *ch = ((c1 & 0x07) << 18) | ((str[1] & 0x3F) << 12) |
+          ((str[2] & 0x3F) << 6) | (str[3] & 0x3F);
+    return 4;
+  }
+  return -1;
+}
+
+// The number of characters of the valid UTF-8 string str.
+size_t NumUtf8Chars(const string& str) {
+  size_t num_chars = 0;
+  for (char c : str) {
+    num_chars += (static_cast<uint8_t>(c) & 0xC0) != 0x80;
+  }
+  return num_chars;
+}
+
+}  // namespace
+
+// Bound by reference in assign and resize, so it needs a definition before
+// C++17.
+constexpr int DoubleArrayTrie::kNoValue;
+
+void DoubleArrayTrie::Build(const vector<std::pair<string, int>>& keys) {
+  base_.assign(1, 0);
+  check_.assign(1, -1);
+  values_.assign(1, kNoValue);
+  // The nodes to place the children of, with the keys [begin, end) sharing
+  // their first depth bytes.
+  struct Range {
+    int node;
+    size_t depth;
+    size_t begin;
+    size_t end;
   };
-  for (auto& ch : unicode_text) {
-    if (ch == 0 || ch == 0xfffd || IsControl(ch)) {
+  vector<Range> ranges{{0, 0, 0, keys.size()}};
+  vector<uint8_t> labels;
+  vector<size_t> label_begins;
+  // The slots before it are all used.
+  size_t first_free = 1;
+  while (!ranges.empty()) {
+    Range range = ranges.back();
+    ranges.pop_back();
+    if (range.begin < range.end &&
+        keys[range.begin].first.size() == range.depth) {
+      values_[range.node] = keys[range.begin].second;
+      ++range.begin;
+    }
+    if (range.begin == range.end) {
       continue;
     }
-    if (do_lower_case_) {
-      ch = do_lower_case(ch);
+    labels.clear();
+    label_begins.clear();
+    for (size_t i = range.begin; i < range.end; ++i) {
+      uint8_t label = keys[i].first[range.depth];
+      if (labels.empty() || labels.back() != label) {
+        labels.push_back(label);
+        label_begins.push_back(i);
+      }
+    }
+    label_begins.push_back(range.end);
+
+    size_t base = std::max<size_t>(first_free, labels[0] + 1) - labels[0];
+    for (;; ++base) {
+      if (base + labels.back() >= check_.size()) {
+        check_.resize(base + 256, -1);
+      }
+      bool fits = true;
+      for (uint8_t label : labels) {
+        if (check_[base + label] != -1) {
+          fits = false;
+          break;
+        }
+      }
+      if (fits) {
+        break;
+      }
+    }
+    check_.resize(std::max(check_.size(), base + 256), -1);
+    base_.resize(check_.size(), 0);
+    values_.resize(check_.size(), kNoValue);
+    base_[range.node] = static_cast<int>(base);
+    for (size_t i = 0; i < labels.size(); ++i) {
+      int child = static_cast<int>(base + labels[i]);
+      check_[child] = range.node;
+      ranges.push_back(
+          {child, range.depth + 1, label_begins[i], label_begins[i + 1]});
+    }
+    while (first_free < check_.size() && check_[first_free] != -1) {
+      ++first_free;
+    }
+  }
+  // Drops the unused slots at the end.
+  size_t size = check_.size();
+  while (size > 1 && check_[size - 1] == -1) {
+    --size;
+  }
+  base_.resize(size);
+  check_.resize(size);
+  values_.resize(size);
+}
+
+int DoubleArrayTrie::ExactMatch(const char* str, size_t len) const {
+  int node = 0;
+  for (size_t i = 0; i < len; ++i) {
+    if (!Next(static_cast<uint8_t>(str[i]), &node)) {
+      return kNoValue;
+    }
+  }
+  return values_[node];
+}
+
+size_t DoubleArrayTrie::LongestPrefix(const char* str,
+                                      size_t len,
+                                      int* value) const {
+  int node = 0;
+  size_t matched = 0;
+  for (size_t i = 0; i < len && Next(static_cast<uint8_t>(str[i]), &node);
+       ++i) {
+    if (values_[node] != kNoValue) {
+      matched = i + 1;
+      *value = values_[node];
     }
-    if (IsChineseChar(ch) || IsPunctuation(ch)) {
-      PushCacheText();
-      res->emplace_back(std::wstring{ch});
-    } else if (IsWhiteSpace(ch)) {
-      PushCacheText();
+  }
+  return matched;
+}
+
+WordPieceTries::WordPieceTries(const framework::Vocab& vocab) {
+  vector<std::pair<string, int>> keys;
+  vector<std::pair<string, int>> suffix_keys;
+  keys.reserve(vocab.size());
+  for (const auto& kv : vocab) {
+    string key;
+    try {
+      framework::ConvertWstrToStr(kv.first, &key);
+    } catch (std::range_error& e) {
+      // Not a unicode string, no valid UTF-8 text can match it.
+      continue;
+    }
+    if (key.size() > 2 && key.compare(0, 2, "##") == 0) {
+      suffix_keys.emplace_back(key.substr(2), kv.second);
+    }
+    keys.emplace_back(std::move(key), kv.second);
+  }
+  std::sort(keys.begin(), keys.end());
+  std::sort(suffix_keys.begin(), suffix_keys.end());
+  word_start.Build(keys);
+  suffix.Build(suffix_keys);
+}
+
+BasicTokenizer::BasicTokenizer(bool do_lower_case /* = true */)
+    : do_lower_case_(do_lower_case) {}
+
+void BasicTokenizer::Tokenize(const string& text, vector<string>* res) const {
+  const AsciiCharTable& ascii_table = GetAsciiCharTable(do_lower_case_);
+  size_t num_tokens = res->size();
+  string cache_text;
+  auto PushCacheText = [&]() {
+    if (!cache_text.empty()) {
+      res->emplace_back(std::move(cache_text));
+      cache_text.clear();
+    }
+  };
+  const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+  size_t size = text.size();
+  size_t i = 0;
+  while (i < size) {
+    CharAction action;
+    wchar_t ch;
+    if (data[i] < 0x80) {
+      action = ascii_table.actions[data[i]];
+      ch = ascii_table.chars[data[i]];
+      ++i;
     } else {
-      cache_text += ch;
+      int len = DecodeUtf8(data + i, size - i, &ch);
+      if (len < 0) {
+        // Not valid UTF-8.
+        res->resize(num_tokens);
+        return;
+      } else if (len == 0) {
+        break;
+      }
+      i += len;
+      action = GetCharAction(do_lower_case_, &ch);
+    }
+    switch (action) {
+      case CharAction::kSingleCharToken:
+        PushCacheText();
+        res->emplace_back();
+        AppendUtf8(ch, &res->back());
+        break;
+      case CharAction::kSplit:
+        PushCacheText();
+        break;
+      case CharAction::kAppend:
+        if (ch < 0x80) {
+          cache_text.push_back(static_cast<char>(ch));
+        } else {
+          AppendUtf8(ch, &cache_text);
+        }
+        break;
+      default:
+        break;
     }
   }
   PushCacheText();
@@ -132,52 +403,39 @@ WordPieceTokenizer::WordPieceTokenizer(
       unk_token_(unk_token),
       max_input_chars_per_word_(max_input_chars_per_word) {
   unk_token_id_ = vocab_->at(unk_token_);
+  tries_ = std::static_pointer_cast<const WordPieceTries>(vocab_->cache());
+  if (tries_ == nullptr) {
+    // Built once per vocab rather than per run of the op.
+    tries_ = std::make_shared<const WordPieceTries>(*vocab_);
+    vocab_->set_cache(tries_);
+  }
 }
 
-void WordPieceTokenizer::Tokenize(const wstring& text,
+// The greedy longest match first of the original WordPiece: the longest token
+// prefixing the rest of the word is found by a single walk down the trie,
+// instead of looking up every shorter substring in the vocab.
+void WordPieceTokenizer::Tokenize(const string& text,
                                   vector<int64_t>* token_ids) const {
-  size_t len = text.size();
-  if (len > max_input_chars_per_word_) {
-    token_ids->emplace_back(std::move(unk_token_id_));
-    return;
-  }
-
-  auto it = vocab_->find(text);
-  if (it != vocab_->end()) {
-    token_ids->emplace_back(std::move(it->second));
+  if (NumUtf8Chars(text) > max_input_chars_per_word_) {
+    token_ids->emplace_back(unk_token_id_);
     return;
   }
 
+  size_t num_token_ids = token_ids->size();
   size_t start = 0;
-  vector<int64_t> wordpiece_ids;
-  while (start < len) {
-    size_t end = len;
-    std::wstring cur_substr;
-    int64_t cur_substr_id;
-    while (start < end) {
-      std::wstring sub = text.substr(start, end - start);
-      if (start > 0) {
-        sub = L"##" + sub;
-      }
-      auto it = vocab_->find(sub);
-      if (it != vocab_->end()) {
-        cur_substr = sub;
-        cur_substr_id = it->second;
-        break;
-      }
-      end -= 1;
-    }
-
-    if (cur_substr.empty()) {
-      token_ids->emplace_back(std::move(unk_token_id_));
+  while (start < text.size()) {
+    const DoubleArrayTrie& trie =
+        start == 0 ? tries_->word_start : tries_->suffix;
+    int token_id = DoubleArrayTrie::kNoValue;
+    size_t len =
+        trie.LongestPrefix(text.data() + start, text.size() - start, &token_id);
+    if (len == 0) {
+      token_ids->resize(num_token_ids);
+      token_ids->emplace_back(unk_token_id_);
       return;
-    } else {
-      start = end;
-      wordpiece_ids.emplace_back(std::move(cur_substr_id));
     }
-  }
-  for (auto& token_id : wordpiece_ids) {
-    token_ids->emplace_back(std::move(token_id));
+    token_ids->emplace_back(token_id);
+    start += len;
   }
 }
 
@@ -216,28 +474,14 @@ BertTokenizer::BertTokenizer(const framework::Vocab* vocab,
 
 void BertTokenizer::Tokenize(const string& text,
                              vector<int64_t>* split_token_ids) const {
-  std::vector<std::wstring> tmp_tokens;
+  std::vector<std::string> tmp_tokens;
   basic_tokenizer_.Tokenize(text, &tmp_tokens);
   if (tmp_tokens.empty()) return;
   split_token_ids->reserve(tmp_tokens.size());
-  for (auto& w_token : tmp_tokens) {
-    const auto& vec_size = w_token.size();
-    if (vec_size == 1) {
-      if (IsChineseChar(w_token[0])) {
-        auto vocab_it = vocab_->find(w_token);
-        if (vocab_it != vocab_->end()) {
-          split_token_ids->emplace_back(std::move(vocab_it->second));
-        } else {
-          split_token_ids->emplace_back(std::move(unk_token_id_));
-        }
-      } else {
-        word_piece_tokenizer_.Tokenize(w_token, split_token_ids);
-      }
-    } else if (vec_size > 1) {
-      word_piece_tokenizer_.Tokenize(w_token, split_token_ids);
-    } else {
-      continue;
-    }
+  // A single chinese character is looked up as a whole word first too, so it
+  // needs no special case.
+  for (auto& token : tmp_tokens) {
+    word_piece_tokenizer_.Tokenize(token, split_token_ids);
   }
 }
 
@@ -331,19 +575,24 @@ int BertTokenizer::Encode(
       if (pair_ids.empty()) return 0;
     }
   } else {
-    std::wstring unicode_text;
-    bool status_a = framework::ConvertStrToWstr(text, &unicode_text);
-    if (!status_a) {
-      return 0;
-    }
-    for (size_t i = 0; i < unicode_text.size(); i++) {
-      wstring token = unicode_text.substr(i, 1);
-      auto it = vocab_->find(token);
-      if (it != vocab_->end()) {
-        ids.emplace_back(std::move(it->second));
+    const DoubleArrayTrie& trie = word_piece_tokenizer_.WordStartTrie();
+    const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+    size_t i = 0;
+    while (i < text.size()) {
+      wchar_t ch;
+      int len = DecodeUtf8(data + i, text.size() - i, &ch);
+      if (len < 0) {
+        return 0;
+      } else if (len == 0) {
+        break;
+      }
+      int token_id = trie.ExactMatch(text.data() + i, len);
+      if (token_id != DoubleArrayTrie::kNoValue) {
+        ids.emplace_back(token_id);
       } else {
-        ids.emplace_back(std::move(unk_token_id_));
+        ids.emplace_back(unk_token_id_);
       }
+      i += len;
     }
   }
 
@@ -418,8 +667,9 @@ void BertTokenizer::BatchEncode(
   }
 
   size_t batch_size = batch_text.size();
+  // The lengths of the texts vary a lot, they are handed out dynamically.
 #ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 8)
 #endif
   for (size_t i = 0; i < batch_size; i++) {
     unordered_map<string, vector<int64_t>> res;
@@ -13,9 +13,12 @@ limitations under the License. */
 
 #include <utf8proc.h>
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
@@ -42,14 +45,55 @@ inline bool IsWhiteSpace(const wchar_t& ch);
 using Vocab = unordered_map<wstring, int>;
 using InvVocab = unordered_map<int, wstring>;
 
+// A double-array trie over the UTF-8 bytes of the tokens: the child of the
+// node s by the byte c is t = base[s] + c if check[t] == s.
+class DoubleArrayTrie {
+ public:
+  // The keys should be sorted and unique.
+  void Build(const vector<std::pair<string, int>>& keys);
+
+  // Moves node to its child by the byte c, returns false if there is none.
+  bool Next(uint8_t c, int* node) const {
+    size_t next = static_cast<size_t>(base_[*node]) + c;
+    if (next >= check_.size() || check_[next] != *node) {
+      return false;
+    }
+    *node = static_cast<int>(next);
+    return true;
+  }
+
+  // Returns the value of the key str, or kNoValue.
+  int ExactMatch(const char* str, size_t len) const;
+
+  // Returns the length of the longest key prefixing str, 0 if there is none,
+  // and sets value to its value.
+  size_t LongestPrefix(const char* str, size_t len, int* value) const;
+
+  static constexpr int kNoValue = -1;
+
+ private:
+  vector<int> base_{0};
+  vector<int> check_{-1};
+  vector<int> values_{kNoValue};
+};
+
+// The tries of the WordPiece tokens, built once per vocab.
+struct WordPieceTries {
+  explicit WordPieceTries(const framework::Vocab& vocab);
+
+  // All the tokens, matched at the start of a word.
+  DoubleArrayTrie word_start;
+  // The tokens prefixed by "##" without it, matched in the middle of a word.
+  DoubleArrayTrie suffix;
+};
+
 class BasicTokenizer {
  public:
   explicit BasicTokenizer(bool do_lower_case = true);
-  void Tokenize(const string& text, vector<wstring>* res) const;
+  // Splits the UTF-8 text into UTF-8 tokens, no tokens if it is not valid.
+  void Tokenize(const string& text, vector<string>* res) const;
 
  private:
-  wchar_t do_lower_case(wchar_t ch) const;
-
   bool do_lower_case_;
 };
 
@@ -58,10 +102,13 @@ class WordPieceTokenizer {
   explicit WordPieceTokenizer(const framework::Vocab* vocab,
                               const wstring& unk_token = L"[UNK]",
                               const size_t max_input_chars_per_word = 100);
-  void Tokenize(const wstring& text, vector<int64_t>* output) const;
+  void Tokenize(const string& text, vector<int64_t>* output) const;
+
+  const DoubleArrayTrie& WordStartTrie() const { return tries_->word_start; }
 
  private:
   const framework::Vocab* vocab_;
+  shared_ptr<const WordPieceTries> tries_;
   wstring unk_token_{L"[UNK]"};
   int64_t unk_token_id_;
   size_t max_input_chars_per_word_;
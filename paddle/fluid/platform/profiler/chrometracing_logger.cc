@@ -708,6 +708,45 @@ void ChromeTracingLogger::LogExtraInfo(
   })JSON");
 }
 
+void ChromeTracingLogger::LogPerfCounters(
+    const std::map<std::string, phi::PerfCounterStats>& perf_counters) {
+  if (perf_counters.empty()) {
+    return;
+  }
+  // Appended to the top level object, after ExtraInfo.
+  output_file_stream_ << std::string(R"JSON(,
+  "PerfCounters": {)JSON");
+  size_t count = perf_counters.size();
+  for (const auto& kv : perf_counters) {
+    const phi::PerfCounterStats& stats = kv.second;
+    output_file_stream_ << string_format(
+        std::string(
+            R"JSON(
+    "%s": {
+      "calls": %llu, "time_ns": %llu,
+      "cycles": %llu, "instructions": %llu, "ipc": %.3f,
+      "cache_references": %llu, "cache_misses": %llu,
+      "branch_instructions": %llu, "branch_misses": %llu,
+      "estimated_memory_bandwidth": "%.3f GB/s"
+    }%s)JSON"),
+        kv.first.c_str(),
+        stats.calls,
+        stats.time_ns,
+        stats.Get(phi::PerfCounterType::kCycles),
+        stats.Get(phi::PerfCounterType::kInstructions),
+        stats.Ipc(),
+        stats.Get(phi::PerfCounterType::kCacheReferences),
+        stats.Get(phi::PerfCounterType::kCacheMisses),
+        stats.Get(phi::PerfCounterType::kBranchInstructions),
+        stats.Get(phi::PerfCounterType::kBranchMisses),
+        stats.EstimatedMemoryBandwidth() / 1e9,
+        count > 1 ? "," : "");
+    count--;
+  }
+  output_file_stream_ << std::string(R"JSON(
+  })JSON");
+}
+
 void ChromeTracingLogger::RefineDisplayName(
     std::unordered_map<std::string, std::string> extra_info) {
   for (auto it = pid_tid_set_.begin(); it != pid_tid_set_.end(); ++it) {
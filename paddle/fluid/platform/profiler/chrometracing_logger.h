@@ -20,6 +20,7 @@ limitations under the License. */
 
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
 #include "paddle/fluid/platform/profiler/output_logger.h"
+#include "paddle/phi/api/profiler/perf_counters.h"
 
 namespace paddle {
 namespace platform {
@@ -39,6 +40,8 @@ class ChromeTracingLogger : public BaseLogger {
   void LogRuntimeTraceEventNode(const CudaRuntimeTraceEventNode&) override;
   void LogNodeTrees(const NodeTrees&) override;
   void LogExtraInfo(const std::unordered_map<std::string, std::string>);
+  void LogPerfCounters(
+      const std::map<std::string, phi::PerfCounterStats>& perf_counters);
   void LogMemTraceEventNode(const MemTraceEventNode&) override;
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void LogDeviceProperty(
@@ -144,6 +144,30 @@ std::unique_ptr<ProfilerResult> DeserializationReader::Parse() {
   ProfilerResult* profiler_result_ptr =
       new ProfilerResult(std::move(tree), extrainfo);
 #endif
+  // restore perf counters, version 1.0.3
+  std::map<std::string, phi::PerfCounterStats> perf_counters;
+  for (auto indx = 0; indx < node_trees_proto_->perf_counters_size(); indx++) {
+    const PerfCounterStatsProto& stats_proto =
+        node_trees_proto_->perf_counters(indx);
+    phi::PerfCounterStats& stats = perf_counters[stats_proto.op_type()];
+    stats.calls = stats_proto.calls();
+    stats.time_ns = stats_proto.time_ns();
+    stats.values[static_cast<size_t>(phi::PerfCounterType::kCycles)] =
+        stats_proto.cycles();
+    stats.values[static_cast<size_t>(phi::PerfCounterType::kInstructions)] =
+        stats_proto.instructions();
+    stats.values[static_cast<size_t>(
+        phi::PerfCounterType::kCacheReferences)] =
+        stats_proto.cache_references();
+    stats.values[static_cast<size_t>(phi::PerfCounterType::kCacheMisses)] =
+        stats_proto.cache_misses();
+    stats.values[static_cast<size_t>(
+        phi::PerfCounterType::kBranchInstructions)] =
+        stats_proto.branch_instructions();
+    stats.values[static_cast<size_t>(phi::PerfCounterType::kBranchMisses)] =
+        stats_proto.branch_misses();
+  }
+  profiler_result_ptr->SetPerfCounters(perf_counters);
   // restore version and span indx
   profiler_result_ptr->SetVersion(node_trees_proto_->version());
   profiler_result_ptr->SetSpanIndx(node_trees_proto_->span_indx());
@@ -372,6 +372,28 @@ void SerializationLogger::LogExtraInfo(
   }
 }
 
+void SerializationLogger::LogPerfCounters(
+    const std::map<std::string, phi::PerfCounterStats>& perf_counters) {
+  for (const auto& kv : perf_counters) {
+    const phi::PerfCounterStats& stats = kv.second;
+    PerfCounterStatsProto* stats_proto = node_trees_proto_->add_perf_counters();
+    stats_proto->set_op_type(kv.first);
+    stats_proto->set_calls(stats.calls);
+    stats_proto->set_time_ns(stats.time_ns);
+    stats_proto->set_cycles(stats.Get(phi::PerfCounterType::kCycles));
+    stats_proto->set_instructions(
+        stats.Get(phi::PerfCounterType::kInstructions));
+    stats_proto->set_cache_references(
+        stats.Get(phi::PerfCounterType::kCacheReferences));
+    stats_proto->set_cache_misses(
+        stats.Get(phi::PerfCounterType::kCacheMisses));
+    stats_proto->set_branch_instructions(
+        stats.Get(phi::PerfCounterType::kBranchInstructions));
+    stats_proto->set_branch_misses(
+        stats.Get(phi::PerfCounterType::kBranchMisses));
+  }
+}
+
 void SerializationLogger::LogMetaInfo(const std::string& version,
                                       uint32_t span_indx) {
   node_trees_proto_->set_version(version);
@@ -174,6 +174,15 @@ TEST(SerializationLoggerTest, dump_case0) {
   }
   tree.LogMe(&logger);
   logger.LogExtraInfo(std::unordered_map<std::string, std::string>());
+  std::map<std::string, phi::PerfCounterStats> perf_counters;
+  perf_counters["op1"].calls = 2;
+  perf_counters["op1"].time_ns = 3000;
+  perf_counters["op1"]
+      .values[static_cast<size_t>(phi::PerfCounterType::kCycles)] = 8000;
+  perf_counters["op1"]
+      .values[static_cast<size_t>(phi::PerfCounterType::kInstructions)] =
+      12000;
+  logger.LogPerfCounters(perf_counters);
 }
 
 TEST(SerializationLoggerTest, dump_case1) {
@@ -292,6 +301,13 @@ TEST(DeserializationReaderTest, restore_case0) {
       EXPECT_EQ((*it)->GetRuntimeTraceEventNodes().size(), 2u);
     }
   }
+  auto perf_counters = profiler_result->GetPerfCounters();
+  EXPECT_EQ(perf_counters.size(), 1u);
+  EXPECT_EQ(perf_counters["op1"].calls, 2u);
+  EXPECT_EQ(perf_counters["op1"].time_ns, 3000u);
+  EXPECT_EQ(perf_counters["op1"].Get(phi::PerfCounterType::kCycles), 8000u);
+  EXPECT_DOUBLE_EQ(perf_counters["op1"].Ipc(), 1.5);
+  EXPECT_EQ(perf_counters["op1"].Get(phi::PerfCounterType::kCacheMisses), 0u);
 }
 
 TEST(DeserializationReaderTest, restore_case1) {
@@ -184,6 +184,7 @@ void ProfilerResult::Save(const std::string& file_name,
 #endif
     tree_->LogMe(&logger);
     logger.LogExtraInfo(GetExtraInfo());
+    logger.LogPerfCounters(perf_counters_);
   } else if (format == std::string("pb")) {
     SerializationLogger logger(file_name);
     logger.LogMetaInfo(version_, span_indx_);
@@ -192,6 +193,7 @@ void ProfilerResult::Save(const std::string& file_name,
 #endif
     tree_->LogMe(&logger);
     logger.LogExtraInfo(GetExtraInfo());
+    logger.LogPerfCounters(perf_counters_);
   }
   return;
 }
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
 #include "paddle/fluid/platform/profiler/event_node.h"
 #include "paddle/fluid/platform/profiler/extra_info.h"
+#include "paddle/phi/api/profiler/perf_counters.h"
 
 namespace paddle {
 namespace platform {
@@ -164,6 +165,15 @@ class ProfilerResult {
 
   void SetSpanIndx(uint32_t span_indx) { span_indx_ = span_indx; }
 
+  void SetPerfCounters(
+      const std::map<std::string, phi::PerfCounterStats>& perf_counters) {
+    perf_counters_ = perf_counters;
+  }
+
+  const std::map<std::string, phi::PerfCounterStats>& GetPerfCounters() {
+    return perf_counters_;
+  }
+
   std::string GetVersion() { return version_; }
   uint32_t GetSpanIndx() { return span_indx_; }
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -179,6 +189,8 @@ class ProfilerResult {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   std::map<uint32_t, gpuDeviceProp> device_property_map_;
 #endif
+  // hardware performance counters per op type
+  std::map<std::string, phi::PerfCounterStats> perf_counters_;
   std::string version_;
   uint32_t span_indx_;
   HostPythonNode* CopyTree(HostTraceEventNode* root);
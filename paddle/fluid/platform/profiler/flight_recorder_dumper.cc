@@ -0,0 +1,319 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/profiler/flight_recorder_dumper.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/os_info.h"
+#include "paddle/fluid/platform/profiler/event_node.h"
+#include "paddle/fluid/platform/profiler/event_python.h"
+#include "paddle/fluid/platform/profiler/extra_info.h"
+#include "paddle/fluid/platform/profiler/profiler.h"
+#include "paddle/fluid/platform/profiler/trace_event_collector.h"
+#include "paddle/fluid/platform/profiler/utils.h"
+#include "paddle/phi/api/profiler/flight_recorder.h"
+#include "paddle/phi/core/os_info.h"
+
+namespace paddle {
+namespace platform {
+
+namespace {
+
+#if !defined(_WIN32)
+// The signal handler can only write a byte to this pipe, a watcher thread
+// reads it and wakes the dump thread up.
+int g_signal_pipe[2] = {-1, -1};
+
+void HandleDumpSignal(int) {
+  int saved_errno = errno;
+  char byte = 1;
+  // The pipe is non-blocking, the signals sent while it is full are merged.
+  ssize_t ret = write(g_signal_pipe[1], &byte, 1);
+  (void)ret;
+  errno = saved_errno;
+}
+#endif
+
+class FlightRecorderDumper {
+ public:
+  static FlightRecorderDumper& GetInstance() {
+    // Never destroyed, the dump thread is stopped by Disable.
+    static FlightRecorderDumper* instance = new FlightRecorderDumper();
+    return *instance;
+  }
+
+  void Enable(const FlightRecorderOptions& options) {
+    Disable();
+    PADDLE_ENFORCE_GT(options.window_seconds,
+                      0.0,
+                      platform::errors::InvalidArgument(
+                          "The window_seconds of the flight recorder should "
+                          "be positive, but received %f.",
+                          options.window_seconds));
+    std::lock_guard<std::mutex> guard(mutex_);
+    // First, so that nothing is left enabled if it fails.
+    if (options.dump_signal != 0) {
+      InstallSignalHandler(options.dump_signal);
+    }
+    options_ = options;
+    phi::FlightRecorderOptions recorder_options;
+    recorder_options.events_per_thread = options.events_per_thread;
+    recorder_options.trace_level = options.trace_level;
+    recorder_options.exited_threads = options.exited_threads;
+    phi::FlightRecorder::GetInstance().Enable(recorder_options);
+    last_step_ns_.store(0, std::memory_order_relaxed);
+    slow_step_threshold_ns_.store(
+        options.slow_step_threshold_ms > 0
+            ? static_cast<uint64_t>(options.slow_step_threshold_ms * 1e6)
+            : 0,
+        std::memory_order_relaxed);
+    last_auto_dump_ns_ = 0;
+    dump_requested_ = false;
+    signal_dump_requested_ = false;
+    stop_ = false;
+    dump_thread_ = std::thread([this] { DumpLoop(); });
+  }
+
+  void Disable() {
+    int dump_signal = 0;
+    std::thread dump_thread;
+    std::thread signal_thread;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (!dump_thread_.joinable()) {
+        return;
+      }
+      phi::FlightRecorder::GetInstance().Disable();
+      slow_step_threshold_ns_.store(0, std::memory_order_relaxed);
+      stop_ = true;
+      dump_signal = options_.dump_signal;
+      dump_thread = std::move(dump_thread_);
+      signal_thread = std::move(signal_thread_);
+    }
+    cv_.notify_all();
+    dump_thread.join();
+    if (dump_signal != 0) {
+      UninstallSignalHandler(dump_signal, &signal_thread);
+    }
+  }
+
+  void Step() {
+    uint64_t threshold_ns =
+        slow_step_threshold_ns_.load(std::memory_order_relaxed);
+    if (threshold_ns == 0) {
+      return;
+    }
+    uint64_t now = PosixInNsec();
+    uint64_t last = last_step_ns_.exchange(now, std::memory_order_relaxed);
+    if (last != 0 && now - last > threshold_ns) {
+      VLOG(1) << "Flight recorder: step took " << (now - last) / 1e6
+              << " ms, over " << threshold_ns / 1e6 << " ms";
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        dump_requested_ = true;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  std::string Dump(const std::string& file_path) {
+    std::string path = file_path;
+    double window_seconds = 0;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (path.empty()) {
+        path = string_format(std::string("%s/flight_recorder_%u_%llu.json"),
+                             options_.dump_dir.c_str(),
+                             phi::GetProcessId(),
+                             PosixInNsec());
+      }
+      window_seconds = options_.window_seconds;
+    }
+    uint64_t now = PosixInNsec();
+    uint64_t window_ns = static_cast<uint64_t>(window_seconds * 1e9);
+    uint64_t since = now > window_ns ? now - window_ns : 0;
+
+    TraceEventCollector collector;
+    uint64_t process_id = phi::GetProcessId();
+    for (auto& thread_events :
+         phi::FlightRecorder::GetInstance().Snapshot(since)) {
+      collector.AddThreadName(thread_events.thread_id,
+                              thread_events.thread_name);
+      for (const auto& event : thread_events.events) {
+        collector.AddHostEvent(HostTraceEvent(event.name,
+                                              event.type,
+                                              event.start_ns,
+                                              event.end_ns,
+                                              process_id,
+                                              thread_events.thread_id));
+      }
+    }
+    std::unique_ptr<NodeTrees> tree(
+        new NodeTrees(collector.HostEvents(),
+                      collector.RuntimeEvents(),
+                      collector.DeviceEvents(),
+                      collector.MemEvents(),
+                      collector.OperatorSupplementEvents()));
+    ExtraInfo extrainfo;
+    for (const auto& kv : collector.ThreadNames()) {
+      extrainfo.AddExtraInfo(string_format(std::string("%llu"), kv.first),
+                             std::string("%s"),
+                             kv.second.c_str());
+    }
+    ProfilerResult result(std::move(tree), extrainfo);
+    result.SetVersion(std::string(Profiler::version));
+    result.Save(path, "json");
+    VLOG(1) << "Flight recorder: dumped the last " << window_seconds
+            << " seconds into " << path;
+    return path;
+  }
+
+ private:
+  FlightRecorderDumper() = default;
+
+#if !defined(_WIN32)
+  void InstallSignalHandler(int dump_signal) {
+    PADDLE_ENFORCE_EQ(pipe(g_signal_pipe),
+                      0,
+                      platform::errors::External(
+                          "Failed to create the pipe of the flight recorder "
+                          "signal handler."));
+    fcntl(g_signal_pipe[1], F_SETFL, O_NONBLOCK);
+    previous_handler_ = std::signal(dump_signal, HandleDumpSignal);
+    if (previous_handler_ == SIG_ERR) {
+      close(g_signal_pipe[0]);
+      close(g_signal_pipe[1]);
+      g_signal_pipe[0] = g_signal_pipe[1] = -1;
+    }
+    PADDLE_ENFORCE_NE(previous_handler_,
+                      SIG_ERR,
+                      platform::errors::InvalidArgument(
+                          "Failed to install the flight recorder handler "
+                          "of signal %d.",
+                          dump_signal));
+    signal_thread_ = std::thread([this] { SignalLoop(); });
+  }
+
+  void UninstallSignalHandler(int dump_signal, std::thread* signal_thread) {
+    std::signal(dump_signal, previous_handler_);
+    // The watcher sees the end of the pipe.
+    close(g_signal_pipe[1]);
+    signal_thread->join();
+    close(g_signal_pipe[0]);
+    g_signal_pipe[0] = g_signal_pipe[1] = -1;
+  }
+
+  void SignalLoop() {
+    char byte = 0;
+    while (true) {
+      ssize_t ret = read(g_signal_pipe[0], &byte, 1);
+      if (ret < 0 && errno == EINTR) {
+        continue;
+      }
+      if (ret <= 0) {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        signal_dump_requested_ = true;
+      }
+      cv_.notify_all();
+    }
+  }
+#else
+  void InstallSignalHandler(int dump_signal) {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The flight recorder dump signal is not supported on Windows, but "
+        "received %d.",
+        dump_signal));
+  }
+
+  void UninstallSignalHandler(int, std::thread*) {}
+#endif
+
+  void DumpLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this] {
+        return stop_ || dump_requested_ || signal_dump_requested_;
+      });
+      if (stop_) {
+        return;
+      }
+      bool signaled = signal_dump_requested_;
+      dump_requested_ = false;
+      signal_dump_requested_ = false;
+      uint64_t now = PosixInNsec();
+      // The signals are explicit requests, they are not rate limited.
+      if (!signaled && last_auto_dump_ns_ != 0 &&
+          now - last_auto_dump_ns_ <
+              static_cast<uint64_t>(options_.min_dump_interval_seconds * 1e9)) {
+        continue;
+      }
+      last_auto_dump_ns_ = now;
+      lock.unlock();
+      try {
+        std::string path = Dump("");
+        LOG(INFO) << "Flight recorder trace dumped into " << path;
+      } catch (const std::exception& e) {
+        LOG(WARNING) << "Flight recorder failed to dump: " << e.what();
+      }
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  FlightRecorderOptions options_;
+  std::thread dump_thread_;
+  std::thread signal_thread_;
+  bool stop_{false};
+  bool dump_requested_{false};
+  bool signal_dump_requested_{false};
+  uint64_t last_auto_dump_ns_{0};
+  std::atomic<uint64_t> last_step_ns_{0};
+  std::atomic<uint64_t> slow_step_threshold_ns_{0};
+  void (*previous_handler_)(int){SIG_DFL};
+};
+
+}  // namespace
+
+void EnableFlightRecorder(const FlightRecorderOptions& options) {
+  FlightRecorderDumper::GetInstance().Enable(options);
+}
+
+void DisableFlightRecorder() { FlightRecorderDumper::GetInstance().Disable(); }
+
+std::string DumpFlightRecorder(const std::string& file_path) {
+  return FlightRecorderDumper::GetInstance().Dump(file_path);
+}
+
+void FlightRecorderStep() { FlightRecorderDumper::GetInstance().Step(); }
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,60 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace paddle {
+namespace platform {
+
+struct FlightRecorderOptions {
+  // Events kept per thread, the older ones are overwritten.
+  size_t events_per_thread = 16384;
+  uint32_t trace_level = 1;
+  // The events of the last exited threads kept, see
+  // phi::FlightRecorderOptions.
+  size_t exited_threads = 16;
+  // Directory of the chrome tracing files dumped without an explicit path.
+  std::string dump_dir = ".";
+  // Only the events ended in the last window_seconds are dumped.
+  double window_seconds = 10.0;
+  // A step slower than this triggers a dump, see FlightRecorderStep. Slow
+  // steps are not detected if it is not positive.
+  double slow_step_threshold_ms = 0.0;
+  // The automatic dumps closer than this to the previous one are skipped.
+  double min_dump_interval_seconds = 60.0;
+  // A signal triggering a dump, e.g. SIGUSR2. No handler is installed if it
+  // is 0. Not supported on Windows.
+  int dump_signal = 0;
+};
+
+// Starts recording the host events of all threads continuously, see
+// phi::FlightRecorder. The slow step and signal triggered dumps are written by
+// a background thread, so that the training is never stopped.
+void EnableFlightRecorder(const FlightRecorderOptions& options);
+
+void DisableFlightRecorder();
+
+// Dumps the events of the last window into a chrome tracing file, file_path
+// or a new file of the dump directory if it is empty, and returns its path.
+std::string DumpFlightRecorder(const std::string& file_path = "");
+
+// Marks the end of a training step: a background dump is requested if the
+// step took more than slow_step_threshold_ms.
+void FlightRecorderStep();
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,175 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+#include "paddle/fluid/platform/profiler/flight_recorder_dumper.h"
+#include "paddle/phi/api/profiler/flight_recorder.h"
+#include "paddle/phi/core/os_info.h"
+
+namespace {
+
+using paddle::platform::RecordEvent;
+using paddle::platform::TracerEventType;
+
+size_t CountEvents(const std::vector<phi::FlightRecorderThreadEvents>& threads,
+                   const std::string& name) {
+  size_t count = 0;
+  for (const auto& thread_events : threads) {
+    for (const auto& event : thread_events.events) {
+      count += name == event.name;
+    }
+  }
+  return count;
+}
+
+// Something like a small op, so that the overhead is measured against
+// a realistic amount of work per event.
+double Work(int n) {
+  double sum = 0;
+  for (int i = 0; i < n; ++i) {
+    sum += static_cast<double>(i) * 0.5;
+  }
+  return sum;
+}
+
+double RunSteps(int steps, int events_per_step, int work) {
+  volatile double sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int step = 0; step < steps; ++step) {
+    RecordEvent step_event(
+        "FlightRecorderTest_step", TracerEventType::ProfileStep, 1);
+    for (int i = 0; i < events_per_step; ++i) {
+      RecordEvent op_event(
+          "FlightRecorderTest_op", TracerEventType::Operator, 1);
+      sink = sink + Work(work);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // namespace
+
+TEST(FlightRecorderTest, KeepsLastEventsOfAllThreads) {
+  phi::FlightRecorderOptions options;
+  options.events_per_thread = 100;  // rounded up to 128
+  options.trace_level = 1;
+  phi::FlightRecorder::GetInstance().Enable(options);
+  {
+    RecordEvent ignored(
+        "FlightRecorderTest_level", TracerEventType::Operator, 2);
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([] {
+      for (int i = 0; i < 1000; ++i) {
+        RecordEvent event(std::string("FlightRecorderTest_thread"),
+                          TracerEventType::UserDefined,
+                          1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // The buffers of the exited threads are still there, each keeps its last
+  // 128 events.
+  auto snapshot = phi::FlightRecorder::GetInstance().Snapshot(0);
+  EXPECT_EQ(CountEvents(snapshot, "FlightRecorderTest_thread"), 4u * 128u);
+  EXPECT_EQ(CountEvents(snapshot, "FlightRecorderTest_level"), 0u);
+  for (const auto& thread_events : snapshot) {
+    for (size_t i = 1; i < thread_events.events.size(); ++i) {
+      EXPECT_LE(thread_events.events[i - 1].end_ns,
+                thread_events.events[i].end_ns);
+    }
+  }
+  // Only the events of the window.
+  uint64_t since = phi::PosixInNsec();
+  {
+    RecordEvent event(
+        "FlightRecorderTest_late", TracerEventType::Operator, 1);
+  }
+  snapshot = phi::FlightRecorder::GetInstance().Snapshot(since);
+  EXPECT_EQ(CountEvents(snapshot, "FlightRecorderTest_late"), 1u);
+  EXPECT_EQ(CountEvents(snapshot, "FlightRecorderTest_thread"), 0u);
+
+  phi::FlightRecorder::GetInstance().Disable();
+  {
+    RecordEvent event("FlightRecorderTest_off", TracerEventType::Operator, 1);
+  }
+  snapshot = phi::FlightRecorder::GetInstance().Snapshot(0);
+  EXPECT_EQ(CountEvents(snapshot, "FlightRecorderTest_off"), 0u);
+}
+
+TEST(FlightRecorderTest, DumpChromeTracing) {
+  paddle::platform::FlightRecorderOptions options;
+  options.window_seconds = 60;
+  paddle::platform::EnableFlightRecorder(options);
+  // Snapshotted while another thread keeps recording.
+  std::atomic<bool> stop{false};
+  std::thread worker([&stop] {
+    while (!stop) {
+      RecordEvent event(
+          "FlightRecorderTest_worker", TracerEventType::Operator, 1);
+    }
+  });
+  {
+    RecordEvent outer(
+        "FlightRecorderTest_outer", TracerEventType::Forward, 1);
+    RecordEvent inner(
+        "FlightRecorderTest_inner", TracerEventType::Operator, 1);
+  }
+  std::string path =
+      paddle::platform::DumpFlightRecorder("flight_recorder_test.json");
+  stop = true;
+  worker.join();
+  paddle::platform::DisableFlightRecorder();
+
+  EXPECT_EQ(path, "flight_recorder_test.json");
+  std::ifstream file(path);
+  ASSERT_TRUE(file.is_open());
+  std::stringstream content;
+  content << file.rdbuf();
+  EXPECT_NE(content.str().find("FlightRecorderTest_outer"), std::string::npos);
+  EXPECT_NE(content.str().find("FlightRecorderTest_inner"), std::string::npos);
+  EXPECT_NE(content.str().find("FlightRecorderTest_worker"),
+            std::string::npos);
+}
+
+TEST(FlightRecorderTest, Overhead) {
+  const int steps = 200;
+  const int events_per_step = 500;
+  const int work = 200;
+  RunSteps(steps / 10, events_per_step, work);  // warm up
+  double off_ms = RunSteps(steps, events_per_step, work);
+  phi::FlightRecorderOptions options;
+  phi::FlightRecorder::GetInstance().Enable(options);
+  double on_ms = RunSteps(steps, events_per_step, work);
+  phi::FlightRecorder::GetInstance().Disable();
+  double events = static_cast<double>(steps) * (events_per_step + 1);
+  LOG(INFO) << "Flight recorder overhead: step " << off_ms / steps
+            << " ms without, " << on_ms / steps << " ms with, "
+            << (on_ms - off_ms) / off_ms * 100 << "%, "
+            << (on_ms - off_ms) * 1e6 / events << " ns per event";
+}
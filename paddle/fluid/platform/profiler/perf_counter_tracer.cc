@@ -0,0 +1,57 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "paddle/fluid/platform/profiler/host_tracer.h"
+#include "paddle/fluid/platform/profiler/perf_counter_tracer.h"
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace platform {
+
+void PerfCounterTracer::PrepareTracing() {
+  phi::PerfCounterRecorder::GetInstance().Clear();
+  state_ = TracerState::READY;
+}
+
+void PerfCounterTracer::StartTracing() {
+  PADDLE_ENFORCE_EQ(
+      state_ == TracerState::READY || state_ == TracerState::STOPED,
+      true,
+      platform::errors::PreconditionNotMet("TracerState must be READY"));
+  phi::PerfCounterRecorder::GetInstance().Clear();
+  phi::PerfCounterRecorder::GetInstance().Enable();
+  state_ = TracerState::STARTED;
+}
+
+void PerfCounterTracer::StopTracing() {
+  PADDLE_ENFORCE_EQ(
+      state_,
+      TracerState::STARTED,
+      platform::errors::PreconditionNotMet("TracerState must be STARTED"));
+  phi::PerfCounterRecorder::GetInstance().Disable();
+  state_ = TracerState::STOPED;
+}
+
+void PerfCounterTracer::CollectTraceData(TraceEventCollector* collector) {
+  PADDLE_ENFORCE_EQ(
+      state_,
+      TracerState::STOPED,
+      platform::errors::PreconditionNotMet("TracerState must be STOPED"));
+  for (const auto& kv : phi::PerfCounterRecorder::GetInstance().GatherStats()) {
+    collector->AddPerfCounterStats(kv.first, kv.second);
+  }
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,42 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "paddle/fluid/platform/profiler/tracer_base.h"
+#include "paddle/phi/api/profiler/perf_counters.h"
+
+namespace paddle {
+namespace platform {
+
+using PerfCounterStats = phi::PerfCounterStats;
+
+// Samples the hardware performance counters around the ops, see
+// phi::PerfCounterRecorder, and collects their sums per op type. It does
+// nothing when the counters are not available.
+class PerfCounterTracer : public TracerBase {
+ public:
+  PerfCounterTracer() {}
+
+  void PrepareTracing() override;
+
+  void StartTracing() override;
+
+  void StopTracing() override;
+
+  void CollectTraceData(TraceEventCollector* collector) override;
+};
+
+}  // namespace platform
+}  // namespace paddle
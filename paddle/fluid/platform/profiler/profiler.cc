@@ -29,6 +29,7 @@
 #include "paddle/fluid/platform/profiler/custom_device/custom_tracer.h"
 #include "paddle/fluid/platform/profiler/extra_info.h"
 #include "paddle/fluid/platform/profiler/host_tracer.h"
+#include "paddle/fluid/platform/profiler/perf_counter_tracer.h"
 #include "paddle/fluid/platform/profiler/trace_event_collector.h"
 #include "paddle/fluid/platform/profiler/utils.h"
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
@@ -58,7 +59,7 @@ void SynchronizeDevice() {
 std::atomic<bool> Profiler::alive_{false};
 
 uint32_t Profiler::span_indx = 0;
-const char* Profiler::version = "1.0.2";
+const char* Profiler::version = "1.0.3";
 
 std::unique_ptr<Profiler> Profiler::Create(
     const ProfilerOptions& options,
@@ -94,6 +95,9 @@ Profiler::Profiler(const ProfilerOptions& options,
   if (trace_switch.test(kProfileGPUOptionBit)) {
     tracers_.emplace_back(&CudaTracer::GetInstance(), false);
   }
+  if (trace_switch.test(kProfilePerfCounterOptionBit)) {
+    tracers_.emplace_back(new PerfCounterTracer(), true);
+  }
   if (trace_switch.test(kProfileCustomDeviceOptionBit)) {
     for (const auto& dev_type : custom_device_types) {
       tracers_.emplace_back(&CustomTracer::GetInstance(dev_type), false);
@@ -159,6 +163,7 @@ std::unique_ptr<ProfilerResult> Profiler::Stop() {
   ProfilerResult* profiler_result_ptr =
       new platform::ProfilerResult(std::move(tree), extrainfo);
 #endif
+  profiler_result_ptr->SetPerfCounters(collector.PerfCounters());
   profiler_result_ptr->SetVersion(std::string(version));
   profiler_result_ptr->SetSpanIndx(span_indx);
   span_indx += 1;
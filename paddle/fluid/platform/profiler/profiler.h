@@ -34,12 +34,14 @@ namespace platform {
 
 static constexpr uint32_t kProfileCPUOptionBit = 0;
 static constexpr uint32_t kProfileGPUOptionBit = 1;
+static constexpr uint32_t kProfilePerfCounterOptionBit = 2;
 static constexpr uint32_t kProfileCustomDeviceOptionBit = 3;
 
 void SynchronizeDevice();
 
 struct ProfilerOptions {
-  uint32_t trace_switch = 0;  // bit 0: cpu, bit 1: gpu
+  // bit 0: cpu, bit 1: gpu, bit 2: cpu performance counters
+  uint32_t trace_switch = 0;
   uint32_t trace_level = FLAGS_host_trace_level;
 };
 
@@ -15,10 +15,12 @@ limitations under the License. */
 #pragma once
 
 #include <list>
+#include <map>
 #include <string>
 #include <unordered_map>
 
 #include "paddle/fluid/platform/profiler/trace_event.h"
+#include "paddle/phi/api/profiler/perf_counters.h"
 #include "paddle/phi/api/profiler/trace_event_collector.h"
 
 namespace paddle {
@@ -34,6 +36,15 @@ class TraceEventCollector : public phi::TraceEventCollector {
     return op_supplement_events_;
   }
 
+  void AddPerfCounterStats(const std::string& op_type,
+                           const phi::PerfCounterStats& stats) {
+    perf_counter_stats_[op_type].Merge(stats);
+  }
+
+  const std::map<std::string, phi::PerfCounterStats>& PerfCounters() const {
+    return perf_counter_stats_;
+  }
+
   void ClearAll() {
     thread_names_.clear();
     host_events_.clear();
@@ -41,10 +52,12 @@ class TraceEventCollector : public phi::TraceEventCollector {
     device_events_.clear();
     mem_events_.clear();
     op_supplement_events_.clear();
+    perf_counter_stats_.clear();
   }
 
  private:
   std::list<OperatorSupplementEvent> op_supplement_events_;
+  std::map<std::string, phi::PerfCounterStats> perf_counter_stats_;
 };
 
 }  // namespace platform
@@ -72,6 +72,7 @@ using paddle::distributed::DistModelDataBuf;
 using paddle::distributed::DistModelDataType;
 using paddle::distributed::DistModelTensor;
 using paddle::distributed::FleetExecutor;
+using paddle::distributed::PipelinePass;
 using paddle::distributed::TaskNode;
 using paddle::framework::OpDesc;
 using paddle::framework::ProgramDesc;
@@ -170,6 +171,11 @@ void BindFleetExecutor(py::module* m) {
       .value("LOOP", DependType::LOOP)
       .value("STOP_LOOP", DependType::STOP_LOOP);
 
+  py::enum_<PipelinePass>(*m, "PipelinePass")
+      .value("NONE", PipelinePass::NONE)
+      .value("FORWARD", PipelinePass::FORWARD)
+      .value("BACKWARD", PipelinePass::BACKWARD);
+
   py::class_<TaskNode>(*m, "TaskNode")
       .def(py::init<framework::ProgramDesc*, int64_t, int64_t, int64_t>())
       .def(py::init<int32_t,
@@ -186,6 +192,10 @@ void BindFleetExecutor(py::module* m) {
       .def("set_cond_var_name", &TaskNode::SetCondVarName)
       .def("set_vars_to_shape", &TaskNode::SetVarsToShape)
       .def("set_vars_to_dtype", &TaskNode::SetVarsToDtype)
+      .def("set_pipeline_pass",
+           &TaskNode::SetPipelinePass,
+           py::arg("pass"),
+           py::arg("chunk") = 0)
       .def("role", &TaskNode::role)
       .def("init", [](TaskNode& self) { self.Init(); })
       .def("set_program", &TaskNode::SetProgram);
@@ -84,6 +84,36 @@ void BindTCPStore(py::module *m) {
                        },
                        py::arg("key"),
                        py::call_guard<py::gil_scoped_release>())
+                   .def(
+                       "multi_set",
+                       [](phi::distributed::Store &self,
+                          const std::vector<std::string> &keys,
+                          const std::vector<std::string> &values) {
+                         std::vector<std::vector<uint8_t>> data;
+                         for (const auto &value : values) {
+                           data.emplace_back(value.begin(), value.end());
+                         }
+                         self.multi_set(keys, data);
+                       },
+                       py::arg("keys"),
+                       py::arg("values"),
+                       py::call_guard<py::gil_scoped_release>())
+                   .def(
+                       "multi_get",
+                       [](phi::distributed::Store &self,
+                          const std::vector<std::string> &keys)
+                           -> std::vector<py::bytes> {
+                         auto data = self.multi_get(keys);
+                         py::gil_scoped_acquire acquire;
+                         std::vector<py::bytes> values;
+                         for (const auto &value : data) {
+                           values.emplace_back(
+                               std::string(value.begin(), value.end()));
+                         }
+                         return values;
+                       },
+                       py::arg("keys"),
+                       py::call_guard<py::gil_scoped_release>())
                    .def("add",
                         &phi::distributed::Store::add,
                         py::call_guard<py::gil_scoped_release>())
@@ -1350,7 +1350,18 @@ void BindDistributed(py::module *m) {
             self.PrepareForBackward(params);
           },
           py::arg("tensors"),
-          py::call_guard<py::gil_scoped_release>());
+          py::call_guard<py::gil_scoped_release>())
+      .def("set_comm_hook",
+           &distributed::EagerReducer::SetCommHook,
+           py::arg("compression"),
+           py::arg("topk_ratio") = 0.01,
+           py::call_guard<py::gil_scoped_release>())
+      .def("clear_comm_hook",
+           &distributed::EagerReducer::ClearCommHook,
+           py::call_guard<py::gil_scoped_release>())
+      .def("comm_hook_bytes",
+           &distributed::EagerReducer::CommHookBytes,
+           py::call_guard<py::gil_scoped_release>());
 
   py::class_<distributed::ProcessGroupIdMap,
              std::shared_ptr<distributed::ProcessGroupIdMap>>(
@@ -30,6 +30,7 @@ typedef SSIZE_T ssize_t;
 #include "paddle/fluid/eager/autograd_meta.h"
 #include "paddle/fluid/eager/backward.h"
 #include "paddle/fluid/eager/custom_operator/custom_operator_node.h"
+#include "paddle/fluid/eager/saved_tensors_compression.h"
 #include "paddle/fluid/eager/utils.h"
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/custom_operator.h"
@@ -909,6 +910,53 @@ static PyObject* eager_api_reset_saved_tensors_hooks(PyObject* self,
   EAGER_CATCH_AND_THROW_RETURN_NULL
 }
 
+static std::shared_ptr<egr::SavedTensorsCompressionContext>
+    saved_tensors_compression_context;
+
+static PyObject* eager_api_enable_saved_tensors_compression(PyObject* self,
+                                                            PyObject* args,
+                                                            PyObject* kwargs) {
+  EAGER_TRY
+  egr::SavedTensorsCompressionOptions options;
+  options.float_to_bfloat16 =
+      CastPyArg2AttrBoolean(PyTuple_GET_ITEM(args, 0), 0);
+  options.min_float_numel = CastPyArg2AttrLong(PyTuple_GET_ITEM(args, 1), 1);
+  options.async = CastPyArg2AttrBoolean(PyTuple_GET_ITEM(args, 2), 2);
+  options.prefetch_depth = CastPyArg2AttrInt(PyTuple_GET_ITEM(args, 3), 3);
+  saved_tensors_compression_context =
+      egr::EnableSavedTensorsCompression(options);
+  RETURN_PY_NONE
+  EAGER_CATCH_AND_THROW_RETURN_NULL
+}
+
+static PyObject* eager_api_disable_saved_tensors_compression(PyObject* self,
+                                                             PyObject* args,
+                                                             PyObject* kwargs) {
+  EAGER_TRY
+  egr::DisableSavedTensorsCompression();
+  RETURN_PY_NONE
+  EAGER_CATCH_AND_THROW_RETURN_NULL
+}
+
+// Returns (original_bytes, stored_bytes, peak_stored_bytes) of the tensors
+// saved since the compression was last enabled, and resets the peak.
+static PyObject* eager_api_saved_tensors_compression_stats(PyObject* self,
+                                                           PyObject* args,
+                                                           PyObject* kwargs) {
+  EAGER_TRY
+  egr::SavedTensorsCompressionStats stats;
+  if (saved_tensors_compression_context) {
+    stats = saved_tensors_compression_context->stats();
+    saved_tensors_compression_context->ResetPeak();
+  }
+  PyObject* result = PyTuple_New(3);
+  PyTuple_SET_ITEM(result, 0, ToPyObject(stats.original_bytes));
+  PyTuple_SET_ITEM(result, 1, ToPyObject(stats.stored_bytes));
+  PyTuple_SET_ITEM(result, 2, ToPyObject(stats.peak_stored_bytes));
+  return result;
+  EAGER_CATCH_AND_THROW_RETURN_NULL
+}
+
 #if defined(PADDLE_WITH_CUDA)
 static PyObject* eager_api_async_read(PyObject* self,
                                       PyObject* args,
@@ -1344,6 +1392,18 @@ PyMethodDef variable_functions[] = {
      (PyCFunction)(void (*)(void))eager_api_reset_saved_tensors_hooks,
      METH_VARARGS | METH_KEYWORDS,
      NULL},
+    {"enable_saved_tensors_compression",
+     (PyCFunction)(void (*)(void))eager_api_enable_saved_tensors_compression,
+     METH_VARARGS | METH_KEYWORDS,
+     NULL},
+    {"disable_saved_tensors_compression",
+     (PyCFunction)(void (*)(void))eager_api_disable_saved_tensors_compression,
+     METH_VARARGS | METH_KEYWORDS,
+     NULL},
+    {"saved_tensors_compression_stats",
+     (PyCFunction)(void (*)(void))eager_api_saved_tensors_compression_stats,
+     METH_VARARGS | METH_KEYWORDS,
+     NULL},
     /**amp functions**/
     {"set_master_grads",
      (PyCFunction)(void (*)(void))eager_api_set_master_grads,
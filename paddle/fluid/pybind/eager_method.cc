@@ -211,13 +211,20 @@ static PyObject* tensor_method_numpy(TensorObject* self,
       VLOG(6) << "Getting DenseTensor's numpy value";
       auto dense_tensor =
           std::dynamic_pointer_cast<phi::DenseTensor>(self->tensor.impl());
-      // deep copy
-      paddle::memory::Copy(
-          place,
-          reinterpret_cast<void*>(pybind11::detail::array_proxy(array)->data),
-          place,
-          dense_tensor->data(),
-          sizeof_dtype * numel);
+      if (!dense_tensor->is_contiguous()) {
+        // A strided view is gathered row-major.
+        phi::StridedCopyToContiguous(
+            *dense_tensor, pybind11::detail::array_proxy(array)->data);
+      } else {
+        // deep copy
+        paddle::memory::Copy(
+            place,
+            reinterpret_cast<void*>(
+                pybind11::detail::array_proxy(array)->data),
+            place,
+            dense_tensor->data(),
+            sizeof_dtype * numel);
+      }
     }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -1004,13 +1011,21 @@ static PyObject* tensor__getitem_from_offset(TensorObject* self,
   PADDLE_ENFORCE_NOT_NULL(ptr,
                           platform::errors::InvalidArgument(
                               "%s is not a DenseTensor.", self->tensor.name()));
-  const auto& tensor = *ptr;
   PADDLE_ENFORCE_EQ(
-      tensor.IsInitialized(),
+      ptr->IsInitialized(),
       true,
       platform::errors::InvalidArgument(
           "Tensor of %s is Empty, please check if it has no data.",
           self->tensor.name()));
+  // A strided view is gathered row-major first, the offsets below being
+  // those of a row-major tensor.
+  phi::DenseTensor contiguous;
+  if (!ptr->is_contiguous()) {
+    contiguous.Resize(ptr->dims());
+    contiguous.mutable_data(ptr->place(), ptr->dtype());
+    phi::StridedCopyToContiguous(*ptr, contiguous.data());
+  }
+  const auto& tensor = ptr->is_contiguous() ? *ptr : contiguous;
 
   const auto& tensor_dims = tensor.dims();
 
@@ -599,7 +599,8 @@ int tensor_properties_set_container(PyLayerObject* self,
                                     PyObject* value,
                                     void* closure) {
   EAGER_TRY
-  if (egr::SavedTensorsHooks::GetInstance().IsEnable()) {
+  if (egr::SavedTensorsHooks::GetInstance().IsEnable() &&
+      !egr::SavedTensorsHooks::GetInstance().IsNative()) {
     call_pack_hook(self, value);
   } else {
     Py_XINCREF(value);
@@ -186,6 +186,7 @@ void BindDistCommunicator(py::module* m) {
       .def("set_clients", &Communicator::SetClients)
       .def("start_coordinator", &Communicator::StartCoordinator)
       .def("query_fl_clients_info", &Communicator::QueryFLClientsInfo)
+      .def("get_send_metrics", &Communicator::GetSendMetrics)
       .def("save_fl_strategy", &Communicator::SaveFLStrategy);
 }
 
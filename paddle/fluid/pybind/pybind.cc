@@ -96,6 +96,7 @@ limitations under the License. */
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/platform/profiler/event_python.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
+#include "paddle/fluid/platform/profiler/flight_recorder_dumper.h"
 #include "paddle/fluid/platform/profiler/profiler.h"
 #include "paddle/fluid/pybind/auto_parallel_py.h"
 #include "paddle/fluid/pybind/bind_cost_model.h"
@@ -2413,6 +2414,29 @@ All parameter, weight, gradient are variables in Paddle.
       .def_readwrite("trace_switch",
                      &paddle::platform::ProfilerOptions::trace_switch);
 
+  py::class_<paddle::platform::FlightRecorderOptions>(m,
+                                                     "FlightRecorderOptions")
+      .def(py::init<>())
+      .def_readwrite(
+          "events_per_thread",
+          &paddle::platform::FlightRecorderOptions::events_per_thread)
+      .def_readwrite("trace_level",
+                     &paddle::platform::FlightRecorderOptions::trace_level)
+      .def_readwrite("exited_threads",
+                     &paddle::platform::FlightRecorderOptions::exited_threads)
+      .def_readwrite("dump_dir",
+                     &paddle::platform::FlightRecorderOptions::dump_dir)
+      .def_readwrite("window_seconds",
+                     &paddle::platform::FlightRecorderOptions::window_seconds)
+      .def_readwrite(
+          "slow_step_threshold_ms",
+          &paddle::platform::FlightRecorderOptions::slow_step_threshold_ms)
+      .def_readwrite(
+          "min_dump_interval_seconds",
+          &paddle::platform::FlightRecorderOptions::min_dump_interval_seconds)
+      .def_readwrite("dump_signal",
+                     &paddle::platform::FlightRecorderOptions::dump_signal);
+
   py::class_<platform::RecordEvent>(m, "_RecordEvent")
       .def(py::init([](std::string name, platform::TracerEventType type) {
         return std::make_unique<platform::RecordEvent>(
@@ -2450,6 +2474,12 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("disable_memory_recorder", &paddle::platform::DisableMemoryRecorder);
   m.def("enable_op_info_recorder", &phi::EnableOpInfoRecorder);
   m.def("disable_op_info_recorder", &phi::DisableOpInfoRecorder);
+  m.def("enable_flight_recorder", &paddle::platform::EnableFlightRecorder);
+  m.def("disable_flight_recorder", &paddle::platform::DisableFlightRecorder);
+  m.def("dump_flight_recorder",
+        &paddle::platform::DumpFlightRecorder,
+        py::arg("file_path") = "");
+  m.def("flight_recorder_step", &paddle::platform::FlightRecorderStep);
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   m.def("set_cublas_switch", phi::SetAllowTF32Cublas);
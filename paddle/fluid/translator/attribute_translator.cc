@@ -15,6 +15,8 @@
 #include "paddle/fluid/translator/attribute_translator.h"
 
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/dialect/pd_attribute.h"
@@ -23,6 +25,7 @@
 #include "paddle/phi/common/layout.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/common/scalar.h"
+#include "paddle/ir/core/utils.h"
 #include "paddle/utils/variant.h"
 
 namespace paddle {
@@ -201,6 +204,96 @@ class PlaceAttributeVisitor : public AttributeVisitor {
   }
 };
 
+// Hashes the legacy attribute kinds whose translation only depends on their
+// value. Attributes referring to program structure (BlockDesc*, VarDesc*),
+// Scalars and blanks are not interned and are translated every time.
+class AttributeHasher {
+ public:
+  bool operator()(int i) { return Hash(i); }
+  bool operator()(float f) { return Hash(f); }
+  bool operator()(bool b) { return Hash(b); }
+  bool operator()(double d) { return Hash(d); }
+  bool operator()(int64_t i64) { return Hash(i64); }
+  bool operator()(const std::string& str) { return Hash(str); }
+  bool operator()(const std::vector<std::string>& strs) { return Hash(strs); }
+  bool operator()(const std::vector<float>& fs) { return Hash(fs); }
+  bool operator()(const std::vector<int>& is) { return Hash(is); }
+  bool operator()(const std::vector<bool>& bs) { return Hash(bs); }
+  bool operator()(const std::vector<int64_t>& i64s) { return Hash(i64s); }
+  bool operator()(const std::vector<double>& ds) { return Hash(ds); }
+
+  template <typename T>
+  bool operator()(const T& attr) {
+    return false;
+  }
+
+  size_t value = 0;
+
+ private:
+  template <typename T>
+  bool Hash(const T& v) {
+    value = std::hash<T>()(v);
+    return true;
+  }
+
+  template <typename T>
+  bool Hash(const std::vector<T>& vs) {
+    value = std::hash<size_t>()(vs.size());
+    for (const auto& v : vs) {
+      value = ir::hash_combine(value, std::hash<T>()(v));
+    }
+    return true;
+  }
+};
+
+// Translated attributes are uniqued by the StorageManager of IrContext and are
+// never released, so the mapping from a legacy attribute to its ir::Attribute
+// can be kept for the lifetime of the thread. Hitting this table avoids
+// rebuilding the parametric storage key and taking the StorageManager lock for
+// the many identical attributes (data_format, use_mkldnn, axis, ...) found in
+// a program.
+class AttributeInterner {
+ public:
+  using Entry = std::pair<framework::Attribute, ir::Attribute>;
+
+  ir::Attribute Find(const std::string& target_type,
+                     const framework::Attribute& attr,
+                     size_t hash_value) const {
+    auto iter = tables_.find(target_type);
+    if (iter == tables_.end()) return ir::Attribute(nullptr);
+    auto range = iter->second.equal_range(hash_value);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.first == attr) return it->second.second;
+    }
+    return ir::Attribute(nullptr);
+  }
+
+  void Insert(const std::string& target_type,
+              const framework::Attribute& attr,
+              size_t hash_value,
+              ir::Attribute new_attr) {
+    if (num_entries_ >= kMaxInternedAttributes) {
+      VLOG(6) << "attribute interner is full, reset it";
+      tables_.clear();
+      num_entries_ = 0;
+    }
+    tables_[target_type].emplace(hash_value, Entry(attr, new_attr));
+    ++num_entries_;
+  }
+
+ private:
+  static constexpr size_t kMaxInternedAttributes = 1 << 16;
+  std::unordered_map<std::string,
+                     std::unordered_multimap<size_t, Entry>>
+      tables_;
+  size_t num_entries_ = 0;
+};
+
+static AttributeInterner& ThreadLocalAttributeInterner() {
+  thread_local AttributeInterner interner;
+  return interner;
+}
+
 AttributeTranslator::AttributeTranslator() {
   general_visitor = new AttributeVisitor();
   special_visitors["paddle::dialect::IntArrayAttribute"] =
@@ -220,11 +313,29 @@ ir::Attribute AttributeTranslator::operator()(
 
 ir::Attribute AttributeTranslator::operator()(
     const std::string& target_type, const framework::Attribute& attr) {
-  if (special_visitors.find(target_type) == special_visitors.end()) {
+  AttributeHasher hasher;
+  bool internable = paddle::visit(hasher, attr);
+  auto& interner = ThreadLocalAttributeInterner();
+  if (internable) {
+    ir::Attribute interned = interner.Find(target_type, attr, hasher.value);
+    if (interned) {
+      return interned;
+    }
+  }
+
+  ir::Attribute new_attr;
+  auto iter = special_visitors.find(target_type);
+  if (iter == special_visitors.end()) {
     VLOG(10) << "[" << target_type << "] not found";
-    return paddle::visit(*general_visitor, attr);
+    new_attr = paddle::visit(*general_visitor, attr);
+  } else {
+    new_attr = paddle::visit(*(iter->second), attr);
+  }
+
+  if (internable && new_attr) {
+    interner.Insert(target_type, attr, hasher.value, new_attr);
   }
-  return paddle::visit(*(special_visitors.at(target_type)), attr);
+  return new_attr;
 }
 
 }  // namespace translator
@@ -112,6 +112,40 @@ inline ir::OpInfo LoopkUpOpInfo(ir::IrContext* ctx, const OpDesc& op_desc) {
   return op_info;
 }
 
+struct OpTranslateInfo {
+  ir::OpInfo op_info;
+  OpInputInfoList input_infos;
+  OpAttributeInfoList attr_infos;
+  OpOutputInfoList output_infos;
+};
+
+// The OpInfo of an op and the arg infos from its GetOpInfoInterface only
+// depend on the op type and whether it is inplace, so they are resolved once
+// per thread and shared by all ops of the same kind.
+inline const OpTranslateInfo& LookUpOpTranslateInfo(ir::IrContext* ctx,
+                                                    const OpDesc& op_desc) {
+  thread_local std::unordered_map<std::string, OpTranslateInfo>
+      op_translate_infos;
+  std::string key = op_desc.Type();
+  if (IsInplace(op_desc)) {
+    key += "_";
+  }
+  auto iter = op_translate_infos.find(key);
+  if (iter != op_translate_infos.end()) {
+    return iter->second;
+  }
+
+  OpTranslateInfo info;
+  info.op_info = LoopkUpOpInfo(ctx, op_desc);
+  auto* op_info_concept =
+      info.op_info.GetInterfaceImpl<paddle::dialect::GetOpInfoInterface>();
+  std::tie(
+      info.input_infos, info.attr_infos, info.output_infos, std::ignore) =
+      op_info_concept->get_op_info_();
+  return op_translate_infos.emplace(std::move(key), std::move(info))
+      .first->second;
+}
+
 inline ir::Operation* InsertSliceOperationForTarget(
     ir::IrContext* ctx,
     TranslationContext* param_map,
@@ -290,7 +324,8 @@ inline std::tuple<OpOutputTypeList, OpOutputMapping> GenerateOperationOutput(
                << "[" << op_desc.Type() << "]" << info.name << " " << var_name
                << " " << var->GetType();
 
-      ir::Type translated_var_type = type_translator[var->GetType()](ctx, *var);
+      ir::Type translated_var_type =
+          type_translator.TranslateVarType(ctx, *var);
 
       arg_to_idx[var_name] = cur_output_idx;
       op_output_types.push_back(translated_var_type);
@@ -307,7 +342,7 @@ inline std::tuple<OpOutputTypeList, OpOutputMapping> GenerateOperationOutput(
                  << "[" << op_desc.Type() << "]" << info.name << " " << var_name
                  << " " << var->GetType();
         ir::Type translated_var_type =
-            type_translator[var->GetType()](ctx, *var);
+            type_translator.TranslateVarType(ctx, *var);
         types.push_back(translated_var_type);
         arg_to_idx[var_name] = cur_output_idx;
       }
@@ -378,15 +413,11 @@ ir::Operation* GeneralOpHandler(ir::IrContext* ctx,
                                 TranslationContext* param_map,
                                 ir::Program* program,
                                 const OpDesc& op_desc) {
-  auto op_info = LoopkUpOpInfo(ctx, op_desc);
-  auto* op_info_concept =
-      op_info.GetInterfaceImpl<paddle::dialect::GetOpInfoInterface>();
-
-  OpInputInfoList input_infos;
-  OpAttributeInfoList attr_infos;
-  OpOutputInfoList output_infos;
-  std::tie(input_infos, attr_infos, output_infos, std::ignore) =
-      op_info_concept->get_op_info_();
+  const auto& translate_info = LookUpOpTranslateInfo(ctx, op_desc);
+  const auto& op_info = translate_info.op_info;
+  const auto& input_infos = translate_info.input_infos;
+  const auto& attr_infos = translate_info.attr_infos;
+  const auto& output_infos = translate_info.output_infos;
 
   auto op_inputs = GenerateOperationInput(
       ctx, param_map, program, op_desc, op_info.name(), input_infos);
@@ -415,15 +446,9 @@ ir::Operation* FeedOpHandler(ir::IrContext* ctx,
                              TranslationContext* param_map,
                              ir::Program* program,
                              const OpDesc& op_desc) {
-  auto op_info = LoopkUpOpInfo(ctx, op_desc);
-
-  auto* op_info_concept =
-      op_info.GetInterfaceImpl<paddle::dialect::GetOpInfoInterface>();
-  OpInputInfoList input_infos;
-  OpAttributeInfoList attr_infos;
-  OpOutputInfoList output_infos;
-  std::tie(input_infos, attr_infos, output_infos, std::ignore) =
-      op_info_concept->get_op_info_();
+  const auto& translate_info = LookUpOpTranslateInfo(ctx, op_desc);
+  const auto& op_info = translate_info.op_info;
+  const auto& output_infos = translate_info.output_infos;
 
   std::vector<ir::OpResult> op_inputs;
 
@@ -447,15 +472,9 @@ ir::Operation* FetchOpHandler(ir::IrContext* ctx,
                               TranslationContext* param_map,
                               ir::Program* program,
                               const OpDesc& op_desc) {
-  auto op_info = LoopkUpOpInfo(ctx, op_desc);
-
-  auto* op_info_concept =
-      op_info.GetInterfaceImpl<paddle::dialect::GetOpInfoInterface>();
-  OpInputInfoList input_infos;
-  OpAttributeInfoList attr_infos;
-  OpOutputInfoList output_infos;
-  std::tie(input_infos, attr_infos, output_infos, std::ignore) =
-      op_info_concept->get_op_info_();
+  const auto& translate_info = LookUpOpTranslateInfo(ctx, op_desc);
+  const auto& op_info = translate_info.op_info;
+  const auto& input_infos = translate_info.input_infos;
 
   auto op_inputs = GenerateOperationInput(
       ctx, param_map, program, op_desc, op_info.name(), input_infos);
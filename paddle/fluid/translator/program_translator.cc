@@ -78,7 +78,7 @@ void ProgramTranslator::ExtractParameterFromSingleBlock(
     std::unordered_map<std::string, ir::Attribute> op_attribute_map = {
         {"parameter_name", ir::StrAttribute::get(ctx, var->Name())},
     };
-    ir::Type translated_var_type = type_translator[var->GetType()](ctx, *var);
+    ir::Type translated_var_type = type_translator.TranslateVarType(ctx, *var);
     ir::Operation* operation = ir::Operation::create(
         {}, op_attribute_map, {translated_var_type}, op_info);
     program->block()->push_back(operation);
@@ -18,6 +18,7 @@
 #include "paddle/fluid/dialect/pd_type_storage.h"
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/ir/core/builtin_type.h"
+#include "paddle/ir/core/utils.h"
 
 namespace paddle {
 namespace translator {
@@ -29,6 +30,29 @@ using VarType = paddle::framework::proto::VarType;
 using DenseTensorType = paddle::dialect::DenseTensorType;
 using DenseTensorTypeStorage = paddle::dialect::DenseTensorTypeStorage;
 
+namespace {
+
+struct DenseTensorTypeKey {
+  VarType::Type dtype;
+  std::vector<int64_t> shape;
+
+  bool operator==(const DenseTensorTypeKey& other) const {
+    return dtype == other.dtype && shape == other.shape;
+  }
+};
+
+struct DenseTensorTypeKeyHash {
+  size_t operator()(const DenseTensorTypeKey& key) const {
+    size_t hash_value = std::hash<int>()(static_cast<int>(key.dtype));
+    for (auto d : key.shape) {
+      hash_value = ir::hash_combine(hash_value, std::hash<int64_t>()(d));
+    }
+    return hash_value;
+  }
+};
+
+}  // namespace
+
 TypeTranslator::TypeTranslator() {
   handlers = {
       {VarType::INT64,
@@ -60,5 +84,28 @@ TypeTranslator::TypeTranslator() {
   };
 }
 
+ir::Type TypeTranslator::TranslateVarType(ir::IrContext* ctx,
+                                          const VarDesc& var_desc) {
+  if (var_desc.GetType() != VarType::LOD_TENSOR) {
+    return this->operator[](var_desc.GetType())(ctx, var_desc);
+  }
+
+  // Types are uniqued by IrContext and never released, so this table stays
+  // valid for the lifetime of the thread.
+  thread_local std::unordered_map<DenseTensorTypeKey,
+                                  ir::Type,
+                                  DenseTensorTypeKeyHash>
+      dense_tensor_types;
+  DenseTensorTypeKey key{var_desc.GetDataType(), var_desc.GetShape()};
+  auto iter = dense_tensor_types.find(key);
+  if (iter != dense_tensor_types.end()) {
+    return iter->second;
+  }
+  ir::Type translated_type =
+      this->operator[](var_desc.GetType())(ctx, var_desc);
+  dense_tensor_types.emplace(std::move(key), translated_type);
+  return translated_type;
+}
+
 }  // namespace translator
 }  // namespace paddle
@@ -16,6 +16,7 @@
 
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 
 #include "paddle/fluid/framework/op_desc.h"
 #include "paddle/fluid/framework/var_desc.h"
@@ -58,6 +59,12 @@ class TypeTranslator {
 
     return handlers[type];
   }
+
+  /// Translate the type of `var_desc`. The ir::Type of dense tensors is
+  /// remembered by (dtype, shape), so the many variables sharing a type do
+  /// not go through the StorageManager of IrContext again.
+  ir::Type TranslateVarType(ir::IrContext* ctx,
+                            const framework::VarDesc& var_desc);
 };
 
 }  // namespace translator
@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/kernels/cast_kernel.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 #include "paddle/phi/kernels/transfer_layout_kernel.h"
 
 namespace paddle {
@@ -231,6 +232,22 @@ phi::DenseTensor TransformData(phi::DenseTensor* tensor,
   return out;
 }
 
+// The strided views are made contiguous for the kernels which do not read
+// the input through its strides.
+inline bool NeedTransformContiguous(const phi::DenseTensor& tensor,
+                                    const phi::TensorArgDef& target_args_def) {
+  return tensor.initialized() && !tensor.is_contiguous() &&
+         !target_args_def.support_strided;
+}
+
+phi::DenseTensor TransContiguous(const phi::DenseTensor& tensor) {
+  auto& pool = phi::DeviceContextPool::Instance();
+  auto* dev_ctx = pool.Get(tensor.place());
+  VLOG(3) << "Make the strided tensor of dims " << tensor.dims()
+          << " contiguous.";
+  return phi::funcs::Contiguous(*dev_ctx, tensor);
+}
+
 std::shared_ptr<phi::DenseTensor> PrepareData(
     const Tensor& input,
     const phi::TensorArgDef& target_args_def,
@@ -239,6 +256,11 @@ std::shared_ptr<phi::DenseTensor> PrepareData(
   if (tensor_in) {
     phi::DenseTensor& dense_tensor =
         *static_cast<phi::DenseTensor*>(tensor_in.get());
+    if (NeedTransformContiguous(dense_tensor, target_args_def)) {
+      phi::DenseTensor contiguous = TransContiguous(dense_tensor);
+      return std::make_shared<phi::DenseTensor>(
+          TransformData(&contiguous, target_args_def, transform_flag));
+    }
     if (!transform_flag.NeedTransform() || !dense_tensor.initialized() ||
         (!NeedTransformPlace(
              dense_tensor.place(), target_args_def.backend, transform_flag) &&
@@ -276,6 +298,13 @@ std::unique_ptr<std::vector<phi::DenseTensor>> PrepareData(
 
   for (const auto& input : inputs) {
     const auto& tensor_in = input.impl();
+    auto* dense_tensor = static_cast<phi::DenseTensor*>(tensor_in.get());
+    if (NeedTransformContiguous(*dense_tensor, target_args_def)) {
+      phi::DenseTensor contiguous = TransContiguous(*dense_tensor);
+      pt_tensors->emplace_back(
+          TransformData(&contiguous, target_args_def, transform_flag));
+      continue;
+    }
     if (!transform_flag.NeedTransform() || !tensor_in->initialized() ||
         (!NeedTransformPlace(
              tensor_in->place(), target_args_def.backend, transform_flag) &&
@@ -77,8 +77,17 @@ class RecordEvent {
   void OriginalConstruct(const std::string& name,
                          const EventRole role,
                          const std::string& attr);
+  // Only the FlightRecorder is on.
+  void FlightRecorderConstruct(const char* shallow_copy_name,
+                               const std::string* name,
+                               const TracerEventType type,
+                               uint32_t level,
+                               const EventRole role);
 
   bool is_enabled_{false};
+  bool is_flight_recording_{false};
+  // A profiling session records the event, and so does the FlightRecorder.
+  bool is_flight_mirrored_{false};
   bool is_pushed_{false};
   // Event name
   std::string* name_{nullptr};
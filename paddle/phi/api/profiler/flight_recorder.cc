@@ -0,0 +1,196 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/api/profiler/flight_recorder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/os_info.h"
+
+namespace phi {
+
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t n) {
+  size_t capacity = 1;
+  while (capacity < n) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+}  // namespace
+
+// The buffer of a thread, handed back to the recorder as the thread exits.
+struct FlightRecorderThreadBuffer {
+  ~FlightRecorderThreadBuffer() {
+    if (buffer != nullptr) {
+      FlightRecorder::GetInstance().ReleaseThreadBuffer(buffer, generation);
+    }
+  }
+
+  std::shared_ptr<FlightRecorderBuffer> buffer;
+  uint64_t generation = 0;
+};
+
+namespace {
+
+thread_local FlightRecorderThreadBuffer tls_buffer;
+
+}  // namespace
+
+FlightRecorderBuffer::FlightRecorderBuffer(size_t capacity)
+    : slots_(new Slot[RoundUpToPowerOfTwo(capacity)]),
+      mask_(RoundUpToPowerOfTwo(capacity) - 1),
+      thread_id_(GetCurrentThreadSysId()),
+      thread_name_(GetCurrentThreadName()) {}
+
+void FlightRecorderBuffer::Record(const char* name,
+                                  uint64_t start_ns,
+                                  uint64_t end_ns,
+                                  EventRole role,
+                                  TracerEventType type) {
+  const uint64_t pos = head_.load(std::memory_order_relaxed);
+  Slot& slot = slots_[pos & mask_];
+  slot.seq.store(2 * pos + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  FlightRecorderEvent& event = slot.event;
+  event.start_ns = start_ns;
+  event.end_ns = end_ns;
+  event.role = role;
+  event.type = type;
+  size_t len = strnlen(name, FlightRecorderEvent::kMaxNameLength);
+  memcpy(event.name, name, len);
+  event.name[len] = '\0';
+  slot.seq.store(2 * pos + 2, std::memory_order_release);
+  head_.store(pos + 1, std::memory_order_release);
+}
+
+void FlightRecorderBuffer::Snapshot(
+    uint64_t end_ns_since, std::vector<FlightRecorderEvent>* events) const {
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const uint64_t capacity = mask_ + 1;
+  uint64_t pos = head > capacity ? head - capacity : 0;
+  for (; pos < head; ++pos) {
+    const Slot& slot = slots_[pos & mask_];
+    const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * pos + 2) {
+      // Being overwritten by a newer event.
+      continue;
+    }
+    FlightRecorderEvent event = slot.event;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq) {
+      continue;
+    }
+    if (event.end_ns >= end_ns_since) {
+      events->push_back(event);
+    }
+  }
+}
+
+std::atomic<int64_t> FlightRecorder::trace_level_{-1};
+
+FlightRecorder& FlightRecorder::GetInstance() {
+  // Never destroyed: the threads still running at exit may keep recording.
+  static FlightRecorder* instance = new FlightRecorder();
+  return *instance;
+}
+
+void FlightRecorder::Enable(const FlightRecorderOptions& options) {
+  PADDLE_ENFORCE_GT(options.events_per_thread,
+                    0,
+                    phi::errors::InvalidArgument(
+                        "The events_per_thread of the flight recorder should "
+                        "be positive, but received %d.",
+                        options.events_per_thread));
+  std::lock_guard<std::mutex> guard(mutex_);
+  options_ = options;
+  buffers_.clear();
+  exited_buffers_.clear();
+  generation_.fetch_add(1, std::memory_order_release);
+  trace_level_.store(options.trace_level, std::memory_order_relaxed);
+}
+
+void FlightRecorder::Disable() {
+  // The buffers are kept, what they hold can still be dumped.
+  trace_level_.store(-1, std::memory_order_relaxed);
+}
+
+FlightRecorderBuffer* FlightRecorder::GetThreadBuffer() {
+  const uint64_t generation = generation_.load(std::memory_order_acquire);
+  if (tls_buffer.generation != generation) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    tls_buffer.buffer =
+        std::make_shared<FlightRecorderBuffer>(options_.events_per_thread);
+    tls_buffer.generation = generation_.load(std::memory_order_relaxed);
+    buffers_.push_back(tls_buffer.buffer);
+  }
+  return tls_buffer.buffer.get();
+}
+
+void FlightRecorder::ReleaseThreadBuffer(
+    const std::shared_ptr<FlightRecorderBuffer>& buffer,
+    uint64_t generation) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (generation != generation_.load(std::memory_order_relaxed)) {
+    // Already dropped by a later Enable.
+    return;
+  }
+  auto it = std::find(buffers_.begin(), buffers_.end(), buffer);
+  if (it == buffers_.end()) {
+    return;
+  }
+  buffers_.erase(it);
+  // The events of a thread that just exited may still be dumped.
+  exited_buffers_.push_back(buffer);
+  while (exited_buffers_.size() > options_.exited_threads) {
+    exited_buffers_.pop_front();
+  }
+}
+
+void FlightRecorder::Record(const char* name,
+                            uint64_t start_ns,
+                            uint64_t end_ns,
+                            EventRole role,
+                            TracerEventType type) {
+  GetThreadBuffer()->Record(name, start_ns, end_ns, role, type);
+}
+
+std::vector<FlightRecorderThreadEvents> FlightRecorder::Snapshot(
+    uint64_t end_ns_since) {
+  std::vector<std::shared_ptr<FlightRecorderBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    buffers = buffers_;
+    buffers.insert(
+        buffers.end(), exited_buffers_.begin(), exited_buffers_.end());
+  }
+  std::vector<FlightRecorderThreadEvents> result;
+  result.reserve(buffers.size());
+  for (const auto& buffer : buffers) {
+    FlightRecorderThreadEvents thread_events;
+    thread_events.thread_id = buffer->thread_id();
+    thread_events.thread_name = buffer->thread_name();
+    buffer->Snapshot(end_ns_since, &thread_events.events);
+    if (!thread_events.events.empty()) {
+      result.push_back(std::move(thread_events));
+    }
+  }
+  return result;
+}
+
+}  // namespace phi
@@ -0,0 +1,152 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/api/profiler/event.h"
+#include "paddle/phi/api/profiler/trace_event.h"
+#include "paddle/phi/core/macros.h"
+
+namespace phi {
+
+struct FlightRecorderOptions {
+  // Events kept per thread, rounded up to a power of 2. An event takes about
+  // 96 bytes.
+  size_t events_per_thread = 16384;
+  // The RecordEvents of a level up to this one are recorded, works like
+  // HostTraceLevel.
+  uint32_t trace_level = 1;
+  // The buffers of the last exited threads kept for the snapshots, those of
+  // the threads exited before are released.
+  size_t exited_threads = 16;
+};
+
+// A host event as kept by the flight recorder, its name copied and truncated
+// to kMaxNameLength characters.
+struct FlightRecorderEvent {
+  static constexpr size_t kMaxNameLength = 63;
+
+  uint64_t start_ns = 0;
+  uint64_t end_ns = 0;
+  TracerEventType type = TracerEventType::UserDefined;
+  EventRole role = EventRole::kOrdinary;
+  char name[kMaxNameLength + 1] = {0};
+};
+
+struct FlightRecorderThreadEvents {
+  uint64_t thread_id;
+  std::string thread_name;
+  std::vector<FlightRecorderEvent> events;
+};
+
+// The ring buffer of one thread. Only its thread writes to it, without lock,
+// while the snapshots read it from any thread: each slot is guarded by a
+// sequence number, and the slots overwritten during a read are dropped.
+class FlightRecorderBuffer {
+ public:
+  explicit FlightRecorderBuffer(size_t capacity);
+
+  void Record(const char* name,
+              uint64_t start_ns,
+              uint64_t end_ns,
+              EventRole role,
+              TracerEventType type);
+
+  // Appends the events ended since end_ns_since, oldest first.
+  void Snapshot(uint64_t end_ns_since,
+                std::vector<FlightRecorderEvent>* events) const;
+
+  uint64_t thread_id() const { return thread_id_; }
+  const std::string& thread_name() const { return thread_name_; }
+
+ private:
+  struct Slot {
+    // 2 * position + 1 while the event at position is written, 2 * position
+    // + 2 once it is.
+    std::atomic<uint64_t> seq{0};
+    FlightRecorderEvent event;
+  };
+
+  DISABLE_COPY_AND_ASSIGN(FlightRecorderBuffer);
+
+  std::unique_ptr<Slot[]> slots_;
+  const uint64_t mask_;
+  std::atomic<uint64_t> head_{0};
+  uint64_t thread_id_;
+  std::string thread_name_;
+};
+
+// Always-on host event recording: unlike HostEventRecorder, which gathers
+// all the events of an explicit profiling session, the flight recorder keeps
+// the last events of every thread in fixed size ring buffers, and the events
+// of a recent time window can be snapshotted at any time without stopping
+// the recording. RecordEvent feeds it when it is enabled.
+class FlightRecorder {
+ public:
+  static FlightRecorder& GetInstance();
+
+  static bool NeedRecord(uint32_t level) {
+    return trace_level_.load(std::memory_order_relaxed) >=
+           static_cast<int64_t>(level);
+  }
+  static bool IsEnabled() {
+    return trace_level_.load(std::memory_order_relaxed) >= 0;
+  }
+
+  // Enabling again drops the events recorded so far.
+  void Enable(const FlightRecorderOptions& options);
+  void Disable();
+
+  void Record(const char* name,
+              uint64_t start_ns,
+              uint64_t end_ns,
+              EventRole role,
+              TracerEventType type);
+
+  // The events of all the threads ended since end_ns_since.
+  std::vector<FlightRecorderThreadEvents> Snapshot(uint64_t end_ns_since);
+
+ private:
+  FlightRecorder() = default;
+  DISABLE_COPY_AND_ASSIGN(FlightRecorder);
+
+  FlightRecorderBuffer* GetThreadBuffer();
+  // Called as a thread exits, with the buffer it recorded into since the
+  // Enable of generation.
+  void ReleaseThreadBuffer(
+      const std::shared_ptr<FlightRecorderBuffer>& buffer,
+      uint64_t generation);
+
+  friend struct FlightRecorderThreadBuffer;
+
+  static std::atomic<int64_t> trace_level_;
+
+  std::mutex mutex_;
+  FlightRecorderOptions options_;
+  // Bumped by Enable, so that the threads switch to new buffers.
+  std::atomic<uint64_t> generation_{0};
+  // The buffers of the running threads, and of the last exited ones.
+  std::vector<std::shared_ptr<FlightRecorderBuffer>> buffers_;
+  std::deque<std::shared_ptr<FlightRecorderBuffer>> exited_buffers_;
+};
+
+}  // namespace phi
@@ -0,0 +1,314 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/api/profiler/perf_counters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "glog/logging.h"
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/os_info.h"
+
+namespace phi {
+
+namespace {
+
+constexpr size_t kCacheLineSize = 64;
+
+#ifdef __linux__
+uint64_t PerfEventConfig(PerfCounterType type) {
+  switch (type) {
+    case PerfCounterType::kCycles:
+      return PERF_COUNT_HW_CPU_CYCLES;
+    case PerfCounterType::kInstructions:
+      return PERF_COUNT_HW_INSTRUCTIONS;
+    case PerfCounterType::kCacheReferences:
+      return PERF_COUNT_HW_CACHE_REFERENCES;
+    case PerfCounterType::kCacheMisses:
+      return PERF_COUNT_HW_CACHE_MISSES;
+    case PerfCounterType::kBranchInstructions:
+      return PERF_COUNT_HW_BRANCH_INSTRUCTIONS;
+    case PerfCounterType::kBranchMisses:
+      return PERF_COUNT_HW_BRANCH_MISSES;
+    default:
+      return PERF_COUNT_HW_MAX;
+  }
+}
+
+// Counts the calling thread, in user space only so that it works with the
+// default perf_event_paranoid of 2. The counters are not inherited: perf
+// does not support inherit with PERF_FORMAT_GROUP, and a process wide count
+// would mix the ops run concurrently by the other threads into each op.
+int OpenPerfEvent(PerfCounterType type, int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PerfEventConfig(type);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  unsigned long flags = 0;  // NOLINT
+#ifdef PERF_FLAG_FD_CLOEXEC
+  flags |= PERF_FLAG_FD_CLOEXEC;
+#endif
+  return static_cast<int>(
+      syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, flags));
+}
+#endif
+
+}  // namespace
+
+// The counter group of a thread, and the stats of the ops it ran.
+class ThreadPerfCounters {
+ public:
+  ThreadPerfCounters() {
+#ifdef __linux__
+    for (size_t i = 0; i < kNumPerfCounterTypes; ++i) {
+      auto type = static_cast<PerfCounterType>(i);
+      int fd = OpenPerfEvent(type, leader_fd_);
+      if (fd < 0) {
+        if (leader_fd_ < 0) {
+          open_errno_ = errno;
+          return;
+        }
+        // Not every CPU, or hypervisor, has all the counters.
+        VLOG(3) << "perf counter " << PerfCounterName(type)
+                << " is not available: " << strerror(errno);
+        continue;
+      }
+      if (leader_fd_ < 0) {
+        leader_fd_ = fd;
+      }
+      fds_.push_back(fd);
+      types_.push_back(type);
+    }
+#else
+    open_errno_ = ENOSYS;
+#endif
+  }
+
+  ~ThreadPerfCounters() {
+#ifdef __linux__
+    for (int fd : fds_) {
+      close(fd);
+    }
+#endif
+  }
+
+  bool IsOpened() const { return leader_fd_ >= 0; }
+  int OpenErrno() const { return open_errno_; }
+
+  // The values since the group was opened, scaled up when the counters were
+  // multiplexed with others.
+  bool Read(uint64_t values[kNumPerfCounterTypes]) {
+#ifdef __linux__
+    // nr, time_enabled, time_running, then the values of the group.
+    uint64_t buffer[3 + kNumPerfCounterTypes];
+    ssize_t size = read(leader_fd_, buffer, sizeof(buffer));
+    if (size < static_cast<ssize_t>(3 * sizeof(uint64_t)) ||
+        buffer[0] != types_.size()) {
+      return false;
+    }
+    double scale = buffer[2] > 0 && buffer[2] < buffer[1]
+                       ? static_cast<double>(buffer[1]) / buffer[2]
+                       : 1.0;
+    for (size_t i = 0; i < types_.size(); ++i) {
+      values[static_cast<size_t>(types_[i])] =
+          static_cast<uint64_t>(buffer[3 + i] * scale);
+    }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void Add(const char* op_type,
+           uint64_t time_ns,
+           const uint64_t deltas[kNumPerfCounterTypes]) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    PerfCounterStats& stats = stats_[op_type];
+    stats.calls += 1;
+    stats.time_ns += time_ns;
+    for (size_t i = 0; i < kNumPerfCounterTypes; ++i) {
+      stats.values[i] += deltas[i];
+    }
+  }
+
+  void GatherStats(std::map<std::string, PerfCounterStats>* result) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (const auto& kv : stats_) {
+      (*result)[kv.first].Merge(kv.second);
+    }
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stats_.clear();
+  }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ThreadPerfCounters);
+
+  int leader_fd_{-1};
+  int open_errno_{0};
+  std::vector<int> fds_;
+  std::vector<PerfCounterType> types_;
+  // Taken by the owning thread for every op, and only contended while the
+  // stats are gathered.
+  std::mutex mutex_;
+  std::unordered_map<std::string, PerfCounterStats> stats_;
+};
+
+const char* PerfCounterName(PerfCounterType type) {
+  switch (type) {
+    case PerfCounterType::kCycles:
+      return "cycles";
+    case PerfCounterType::kInstructions:
+      return "instructions";
+    case PerfCounterType::kCacheReferences:
+      return "cache_references";
+    case PerfCounterType::kCacheMisses:
+      return "cache_misses";
+    case PerfCounterType::kBranchInstructions:
+      return "branch_instructions";
+    case PerfCounterType::kBranchMisses:
+      return "branch_misses";
+    default:
+      return "unknown";
+  }
+}
+
+double PerfCounterStats::Ipc() const {
+  uint64_t cycles = Get(PerfCounterType::kCycles);
+  return cycles > 0 ? static_cast<double>(Get(PerfCounterType::kInstructions)) /
+                          cycles
+                    : 0.0;
+}
+
+double PerfCounterStats::EstimatedMemoryBandwidth() const {
+  return time_ns > 0 ? static_cast<double>(Get(PerfCounterType::kCacheMisses)) *
+                           kCacheLineSize * 1e9 / time_ns
+                     : 0.0;
+}
+
+void PerfCounterStats::Merge(const PerfCounterStats& other) {
+  calls += other.calls;
+  time_ns += other.time_ns;
+  for (size_t i = 0; i < kNumPerfCounterTypes; ++i) {
+    values[i] += other.values[i];
+  }
+}
+
+std::atomic<bool> PerfCounterRecorder::enabled_{false};
+
+PerfCounterRecorder& PerfCounterRecorder::GetInstance() {
+  static PerfCounterRecorder* instance = new PerfCounterRecorder();
+  return *instance;
+}
+
+ThreadPerfCounters* PerfCounterRecorder::GetThreadCounters() {
+  thread_local std::shared_ptr<ThreadPerfCounters> counters;
+  if (counters == nullptr) {
+    counters = std::make_shared<ThreadPerfCounters>();
+    std::lock_guard<std::mutex> guard(mutex_);
+    thread_counters_.push_back(counters);
+  }
+  return counters.get();
+}
+
+bool PerfCounterRecorder::Enable() {
+  ThreadPerfCounters* counters = GetThreadCounters();
+  if (!counters->IsOpened()) {
+    LOG_FIRST_N(WARNING, 1)
+        << "Hardware performance counters are not available ("
+        << strerror(counters->OpenErrno())
+        << "), the ops are profiled without them. Check "
+           "/proc/sys/kernel/perf_event_paranoid, or the PMU passthrough "
+           "in a virtual machine.";
+    return false;
+  }
+  enabled_.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+void PerfCounterRecorder::Disable() {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void PerfCounterRecorder::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::vector<std::shared_ptr<ThreadPerfCounters>> alive;
+  for (auto& counters : thread_counters_) {
+    // Only the registry holds the counters of the exited threads.
+    if (counters.use_count() > 1) {
+      counters->Clear();
+      alive.push_back(std::move(counters));
+    }
+  }
+  thread_counters_.swap(alive);
+}
+
+std::map<std::string, PerfCounterStats> PerfCounterRecorder::GatherStats() {
+  std::map<std::string, PerfCounterStats> result;
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto& counters : thread_counters_) {
+    counters->GatherStats(&result);
+  }
+  return result;
+}
+
+RecordPerfCounters::RecordPerfCounters(const char* op_type) {
+  if (LIKELY(PerfCounterRecorder::IsEnabled() == false)) {
+    return;
+  }
+  ThreadPerfCounters* counters =
+      PerfCounterRecorder::GetInstance().GetThreadCounters();
+  if (!counters->IsOpened() || !counters->Read(start_values_)) {
+    return;
+  }
+  counters_ = counters;
+  op_type_ = op_type;
+  start_ns_ = PosixInNsec();
+}
+
+void RecordPerfCounters::End() {
+  if (LIKELY(counters_ == nullptr)) {
+    return;
+  }
+  uint64_t end_ns = PosixInNsec();
+  uint64_t end_values[kNumPerfCounterTypes] = {0};
+  if (counters_->Read(end_values)) {
+    uint64_t deltas[kNumPerfCounterTypes];
+    for (size_t i = 0; i < kNumPerfCounterTypes; ++i) {
+      deltas[i] = end_values[i] > start_values_[i]
+                      ? end_values[i] - start_values_[i]
+                      : 0;
+    }
+    counters_->Add(op_type_, end_ns - start_ns_, deltas);
+  }
+  counters_ = nullptr;
+}
+
+}  // namespace phi
@@ -0,0 +1,114 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/core/macros.h"
+
+namespace phi {
+
+enum class PerfCounterType {
+  kCycles = 0,
+  kInstructions,
+  kCacheReferences,
+  // Last level cache misses on most CPUs.
+  kCacheMisses,
+  kBranchInstructions,
+  kBranchMisses,
+  kNumTypes,
+};
+
+static constexpr size_t kNumPerfCounterTypes =
+    static_cast<size_t>(PerfCounterType::kNumTypes);
+
+const char* PerfCounterName(PerfCounterType type);
+
+// The counters of the calls of an op type, in user space. The counters a CPU
+// does not support stay 0.
+struct PerfCounterStats {
+  uint64_t calls = 0;
+  uint64_t time_ns = 0;
+  uint64_t values[kNumPerfCounterTypes] = {0};
+
+  uint64_t Get(PerfCounterType type) const {
+    return values[static_cast<size_t>(type)];
+  }
+  double Ipc() const;
+  // Bytes moved from the memory per second, estimated from the cache misses.
+  double EstimatedMemoryBandwidth() const;
+
+  void Merge(const PerfCounterStats& other);
+};
+
+class ThreadPerfCounters;
+
+// Collects hardware performance counters per op type with perf_event_open.
+// Each thread opens a counter group on its first sampled op, the counters are
+// read before and after the op, and the differences are summed per op type.
+// Only the thread running the op is counted: the work an op hands to other
+// threads, e.g. the OpenMP or MKL workers of a CPU kernel, is missed, and
+// such ops look cheaper than they are.
+class PerfCounterRecorder {
+ public:
+  static PerfCounterRecorder& GetInstance();
+
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Returns false, and leaves the recorder disabled, if the counters are not
+  // available: not Linux, no PMU in a VM, perf_event_paranoid too high...
+  bool Enable();
+  void Disable();
+
+  // Drops the stats gathered so far.
+  void Clear();
+  std::map<std::string, PerfCounterStats> GatherStats();
+
+  ThreadPerfCounters* GetThreadCounters();
+
+ private:
+  PerfCounterRecorder() = default;
+  DISABLE_COPY_AND_ASSIGN(PerfCounterRecorder);
+
+  static std::atomic<bool> enabled_;
+
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<ThreadPerfCounters>> thread_counters_;
+};
+
+// Samples the counters over its lifetime, like RecordEvent.
+class RecordPerfCounters {
+ public:
+  // op_type should outlive the object.
+  explicit RecordPerfCounters(const char* op_type);
+
+  void End();
+
+  ~RecordPerfCounters() { End(); }
+
+ private:
+  ThreadPerfCounters* counters_{nullptr};
+  const char* op_type_{nullptr};
+  uint64_t start_ns_{0};
+  uint64_t start_values_[kNumPerfCounterTypes] = {0};
+};
+
+}  // namespace phi
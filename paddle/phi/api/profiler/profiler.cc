@@ -24,6 +24,7 @@ limitations under the License. */
 
 #include "paddle/phi/api/profiler/common_event.h"
 #include "paddle/phi/api/profiler/device_tracer.h"
+#include "paddle/phi/api/profiler/flight_recorder.h"
 #include "paddle/phi/api/profiler/host_event_recorder.h"
 #include "paddle/phi/api/profiler/host_tracer.h"
 #include "paddle/phi/api/profiler/profiler_helper.h"
@@ -109,6 +110,7 @@ RecordEvent::RecordEvent(const char *name,
 #endif
 #endif
   if (UNLIKELY(HostTraceLevel::GetInstance().NeedTrace(level) == false)) {
+    FlightRecorderConstruct(name, nullptr, type, level, role);
     return;
   }
   if (FLAGS_enable_host_event_recorder_hook == false) {
@@ -124,6 +126,7 @@ RecordEvent::RecordEvent(const char *name,
   }
 
   is_enabled_ = true;
+  is_flight_mirrored_ = FlightRecorder::NeedRecord(level);
   shallow_copy_name_ = name;
   role_ = role;
   type_ = type;
@@ -143,6 +146,7 @@ RecordEvent::RecordEvent(const std::string &name,
 #endif
 #endif
   if (UNLIKELY(HostTraceLevel::GetInstance().NeedTrace(level) == false)) {
+    FlightRecorderConstruct(nullptr, &name, type, level, role);
     return;
   }
 
@@ -156,6 +160,7 @@ RecordEvent::RecordEvent(const std::string &name,
   }
 
   is_enabled_ = true;
+  is_flight_mirrored_ = FlightRecorder::NeedRecord(level);
   name_ = new std::string(name);
   role_ = role;
   type_ = type;
@@ -177,6 +182,7 @@ RecordEvent::RecordEvent(const std::string &name,
 #endif
 
   if (UNLIKELY(HostTraceLevel::GetInstance().NeedTrace(level) == false)) {
+    FlightRecorderConstruct(nullptr, &name, type, level, role);
     return;
   }
 
@@ -190,6 +196,7 @@ RecordEvent::RecordEvent(const std::string &name,
   }
 
   is_enabled_ = true;
+  is_flight_mirrored_ = FlightRecorder::NeedRecord(level);
   type_ = type;
   name_ = new std::string(name);
   start_ns_ = PosixInNsec();
@@ -215,6 +222,25 @@ void RecordEvent::OriginalConstruct(const std::string &name,
   *name_ = e->name();
 }
 
+void RecordEvent::FlightRecorderConstruct(const char *shallow_copy_name,
+                                          const std::string *name,
+                                          const TracerEventType type,
+                                          uint32_t level,
+                                          const EventRole role) {
+  if (LIKELY(FlightRecorder::NeedRecord(level) == false)) {
+    return;
+  }
+  is_flight_recording_ = true;
+  if (shallow_copy_name != nullptr) {
+    shallow_copy_name_ = shallow_copy_name;
+  } else {
+    name_ = new std::string(*name);
+  }
+  role_ = role;
+  type_ = type;
+  start_ns_ = PosixInNsec();
+}
+
 void RecordEvent::End() {
 #ifndef _WIN32
 #ifdef PADDLE_WITH_CUDA
@@ -224,8 +250,31 @@ void RecordEvent::End() {
   }
 #endif
 #endif
+  if (UNLIKELY(is_flight_recording_)) {
+    uint64_t end_ns = PosixInNsec();
+    if (shallow_copy_name_ != nullptr) {
+      FlightRecorder::GetInstance().Record(
+          shallow_copy_name_, start_ns_, end_ns, role_, type_);
+    } else {
+      FlightRecorder::GetInstance().Record(
+          name_->c_str(), start_ns_, end_ns, role_, type_);
+      delete name_;
+    }
+    is_flight_recording_ = false;
+    return;
+  }
   if (LIKELY(FLAGS_enable_host_event_recorder_hook && is_enabled_)) {
     uint64_t end_ns = PosixInNsec();
+    if (UNLIKELY(is_flight_mirrored_)) {
+      // Keep the flight recorder going during a profiling session, at its
+      // own trace level.
+      FlightRecorder::GetInstance().Record(
+          shallow_copy_name_ != nullptr ? shallow_copy_name_ : name_->c_str(),
+          start_ns_,
+          end_ns,
+          role_,
+          type_);
+    }
     if (LIKELY(shallow_copy_name_ != nullptr)) {
       HostEventRecorder<CommonEvent>::GetInstance().RecordEvent(
           shallow_copy_name_, start_ns_, end_ns, role_, type_);
@@ -267,7 +316,7 @@ void RecordEvent::End() {
 
 bool RecordEvent::IsEnabled() {
   return FLAGS_enable_host_event_recorder_hook ||
-         ProfilerHelper::g_enable_nvprof_hook ||
+         FlightRecorder::IsEnabled() || ProfilerHelper::g_enable_nvprof_hook ||
          ProfilerHelper::g_state != ProfilerState::kDisabled;
 }
 
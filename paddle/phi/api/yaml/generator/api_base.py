@@ -1210,8 +1210,9 @@ PADDLE_API {self.get_return_type(inplace_flag=True)} {api_func_name}({self.get_d
 {code_indent}    TransDataBackend({kernel_out}, kernel_backend, {kernel_out});"""
         return f"""
 {code_indent}  VLOG(6) << "{self.api} API kernel key: [" << kernel_backend << ", " << kernel_layout << ", "<< kernel_data_type << "]";
-{code_indent}  auto kernel_result = phi::KernelFactory::Instance().SelectKernelOrThrowError(
-{code_indent}      "{kernel_name}", {{kernel_backend, kernel_layout, kernel_data_type}});
+{code_indent}  static thread_local phi::KernelSelectCache kernel_select_cache("{kernel_name}");
+{code_indent}  auto kernel_result = kernel_select_cache.SelectKernelOrThrowError(
+{code_indent}      {{kernel_backend, kernel_layout, kernel_data_type}});
 {code_indent}  const auto& kernel = kernel_result.kernel;
 {code_indent}  if (FLAGS_low_precision_op_list) {{
 {code_indent}    phi::KernelFactory::Instance().AddToLowPrecisionKernelList("{self.api}", kernel_data_type);
@@ -1234,7 +1235,14 @@ PADDLE_API {self.get_return_type(inplace_flag=True)} {api_func_name}({self.get_d
 {code_indent}  if(phi::RecordEvent::IsEnabled()){{
 {code_indent}    kernel_record_event = new phi::RecordEvent(\"{self.api} compute\", phi::TracerEventType::OperatorInner, 1);
 {code_indent}  }}
+{code_indent}  phi::RecordPerfCounters* kernel_perf_counters = nullptr;
+{code_indent}  if(phi::PerfCounterRecorder::IsEnabled()){{
+{code_indent}    kernel_perf_counters = new phi::RecordPerfCounters(\"{self.api}\");
+{code_indent}  }}
 {code_indent}    (*kernel_fn)({kernel_args}, {", ".join(outputs_args)});
+{code_indent}  if(kernel_perf_counters != nullptr){{
+{code_indent}    delete kernel_perf_counters;
+{code_indent}  }}
 {code_indent}  if(kernel_record_event != nullptr){{
 {code_indent}    delete kernel_record_event;
 {code_indent}  }}
@@ -377,6 +377,7 @@ def source_include(header_file_path):
 #include "paddle/phi/infermeta/ternary.h"
 
 #include "paddle/phi/api/profiler/event_tracing.h"
+#include "paddle/phi/api/profiler/perf_counters.h"
 #include "paddle/phi/api/profiler/supplement_tracing.h"
 
 DECLARE_bool(conv2d_disable_cudnn);
@@ -54,6 +54,7 @@ def source_include(header_file_path):
 #include "paddle/phi/infermeta/sparse/multiary.h"
 
 #include "paddle/phi/api/profiler/event_tracing.h"
+#include "paddle/phi/api/profiler/perf_counters.h"
 #include "paddle/phi/api/profiler/supplement_tracing.h"
 
 DECLARE_int32(low_precision_op_list);
@@ -16,9 +16,24 @@ limitations under the License. */
 
 #include <glog/logging.h>
 #include <sys/stat.h>
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
 
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <set>
+#include <sstream>
 #include <utility>
 
 #include "paddle/phi/backends/context_pool.h"
@@ -26,6 +41,8 @@ limitations under the License. */
 #include "paddle/phi/core/flags.h"
 
 PHI_DECLARE_string(cuda_dir);
+PHI_DECLARE_string(fusion_group_cpu_compiler);
+PHI_DECLARE_string(fusion_group_cpu_cache_dir);
 
 namespace phi {
 
@@ -71,12 +88,23 @@ DeviceCodePool::DeviceCodePool(const std::vector<phi::Place>& places) {
                     errors::InvalidArgument(
                         "Expected the number of places >= 1. But received %d.",
                         places.size()));
+  AddPlaces(places);
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  GPUDeviceCode::CheckAvailableStatus();
+#endif
+}
+
+void DeviceCodePool::AddPlaces(const std::vector<phi::Place>& places) {
   // Remove the duplicated places
   std::set<Place> set;
   for (auto& p : places) {
     set.insert(p);
   }
   for (auto& p : set) {
+    if (device_codes_.count(p)) {
+      continue;
+    }
     if (p.GetType() == phi::AllocationType::GPU) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
       device_codes_.emplace(p, DeviceCodeMap());
@@ -84,13 +112,16 @@ DeviceCodePool::DeviceCodePool(const std::vector<phi::Place>& places) {
       PADDLE_THROW(phi::errors::PreconditionNotMet(
           "CUDAPlace or HIPPlace is not supported, please re-compile with "
           "WITH_GPU=ON or WITH_ROCM=ON."));
+#endif
+    } else if (p.GetType() == phi::AllocationType::CPU) {
+#if !defined(_WIN32)
+      device_codes_.emplace(p, DeviceCodeMap());
+#else
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "Runtime compiling for CPUPlace is not supported on Windows."));
 #endif
     }
   }
-
-#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-  GPUDeviceCode::CheckAvailableStatus();
-#endif
 }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -477,4 +508,322 @@ bool GPUDeviceCode::CheckNVRTCResult(nvrtcResult result, std::string function) {
 }
 #endif
 
+#if !defined(_WIN32)
+namespace {
+
+// The kernels are compiled for the host they run on.
+constexpr char kCPUCompileOptions[] =
+    "-std=c++14 -O3 -march=native -fPIC -shared -fopenmp-simd "
+    "-fno-math-errno";
+
+// Declares the vector variants of expf in glibc's libmvec, as math.h does
+// under -ffast-math only.
+constexpr char kLibmvecProbe[] = R"(
+#include <cmath>
+extern "C" __attribute__((simd("notinbranch"))) float expf(float);
+extern "C" void probe(float* x, int n) {
+#pragma omp simd
+  for (int i = 0; i < n; ++i) {
+    x[i] = expf(x[i]);
+  }
+}
+)";
+
+// Each thread computes at least so many elements, the smaller tensors are
+// not worth waking up the threads.
+constexpr int64_t kCPUMinElementsPerThread = 32768;
+
+std::string ShellQuote(const std::string& str) {
+  std::string quoted = "'";
+  for (char c : str) {
+    if (c == '\'') {
+      quoted += "'\\''";
+    } else {
+      quoted += c;
+    }
+  }
+  return quoted + "'";
+}
+
+// Runs the command, and returns its exit status. Its stdout and stderr are
+// appended to output.
+int RunCommand(const std::string& command, std::string* output) {
+  FILE* pipe = popen((command + " 2>&1").c_str(), "r");
+  if (pipe == nullptr) {
+    *output += strerror(errno);
+    return -1;
+  }
+  char buffer[256];
+  while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+    *output += buffer;
+  }
+  return pclose(pipe);
+}
+
+bool MakeDirs(const std::string& dir) {
+  struct stat st;
+  for (size_t pos = dir.find('/', 1);; pos = dir.find('/', pos + 1)) {
+    std::string sub_dir = dir.substr(0, pos);
+    if (stat(sub_dir.c_str(), &st) != 0 &&
+        mkdir(sub_dir.c_str(), 0700) != 0 && errno != EEXIST) {
+      return false;
+    }
+    if (pos == std::string::npos) {
+      break;
+    }
+  }
+  return stat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// The libraries of the cache are loaded into the process, so the directory
+// must not be writable by other users: it is owned by this one, is not a
+// symlink, and gives no access to the others when it is the default one in
+// the shared temporary directory.
+bool IsCacheDirSecure(const std::string& dir, bool is_default) {
+  struct stat st;
+  if (lstat(dir.c_str(), &st) != 0) {
+    return false;
+  }
+  const mode_t denied = is_default ? 0077 : 0022;
+  if (!S_ISDIR(st.st_mode) || st.st_uid != getuid() ||
+      (st.st_mode & denied) != 0) {
+    LOG(WARNING) << "The directory " << dir
+                 << " caching the fusion_group CPU kernels must be owned by "
+                    "the current user, must not be a symlink and must have "
+                    "the mode "
+                 << (is_default ? "0700" : "0755 or stricter")
+                 << ". Its kernels are not loaded.";
+    return false;
+  }
+  return true;
+}
+
+std::string CPUCodeCacheDir() {
+  if (!FLAGS_fusion_group_cpu_cache_dir.empty()) {
+    return FLAGS_fusion_group_cpu_cache_dir;
+  }
+  const char* tmp_dir = std::getenv("TMPDIR");
+  std::string dir = tmp_dir != nullptr && tmp_dir[0] != '\0' ? tmp_dir : "/tmp";
+  return dir + "/paddle_fusion_group_" + std::to_string(getuid());
+}
+
+// Creates the cache directory if needed, and checks that it is safe to load
+// libraries from.
+bool PrepareCPUCodeCacheDir(const std::string& dir) {
+  if (!MakeDirs(dir)) {
+    LOG(WARNING) << "Cannot create the directory " << dir
+                 << " caching the fusion_group CPU kernels: "
+                 << strerror(errno);
+    return false;
+  }
+  return IsCacheDirSecure(dir, FLAGS_fusion_group_cpu_cache_dir.empty());
+}
+
+// The macros the compiler predefines for -march=native, which tell the
+// instruction sets the kernels are compiled for. They key the cache with the
+// code, a cache shared by different hosts must not load the kernels of
+// another CPU.
+const std::string& NativeTargetMacros() {
+  static std::string macros = [] {
+    std::string output;
+    RunCommand(ShellQuote(FLAGS_fusion_group_cpu_compiler) +
+                   " -march=native -E -dM -x c++ - </dev/null",
+               &output);
+    return output;
+  }();
+  return macros;
+}
+
+// The calls of exp and log are only vectorized with libmvec, which is not
+// available with all the libcs and compilers.
+bool HasLibmvec() {
+  static bool available = [] {
+    std::string dir = CPUCodeCacheDir();
+    if (!MakeDirs(dir) ||
+        !IsCacheDirSecure(dir, FLAGS_fusion_group_cpu_cache_dir.empty())) {
+      return false;
+    }
+    std::string path = dir + "/libmvec_probe_" + std::to_string(getpid());
+    {
+      std::ofstream src(path + ".cc");
+      src << kLibmvecProbe;
+    }
+    std::string output;
+    int status = RunCommand(ShellQuote(FLAGS_fusion_group_cpu_compiler) + " " +
+                                kCPUCompileOptions + " " +
+                                ShellQuote(path + ".cc") + " -o " +
+                                ShellQuote(path + ".so") + " -lmvec",
+                            &output);
+    bool available = false;
+    if (status == 0) {
+      void* handle = dlopen((path + ".so").c_str(), RTLD_NOW | RTLD_LOCAL);
+      if (handle != nullptr) {
+        available = true;
+        dlclose(handle);
+      }
+    }
+    std::remove((path + ".cc").c_str());
+    std::remove((path + ".so").c_str());
+    VLOG(3) << "libmvec is " << (available ? "" : "not ")
+            << "available for the CPU device code: " << output;
+    return available;
+  }();
+  return available;
+}
+
+}  // namespace
+
+CPUDeviceCode::CPUDeviceCode(const Place& place,
+                             const std::string& name,
+                             const std::string& kernel) {
+  if (place.GetType() != phi::AllocationType::CPU) {
+    PADDLE_THROW(phi::errors::PermissionDenied(
+        "CPUDeviceCode can only launch on CPU place."));
+  }
+
+  place_ = place;
+  name_ = name;
+  kernel_ = kernel;
+}
+
+CPUDeviceCode::~CPUDeviceCode() {
+  if (handle_ != nullptr) {
+    dlclose(handle_);
+  }
+}
+
+bool CPUDeviceCode::IsAvailable() {
+  static bool available = [] {
+    std::string output;
+    int status =
+        RunCommand(ShellQuote(FLAGS_fusion_group_cpu_compiler) + " --version",
+                   &output);
+    if (status != 0) {
+      LOG(WARNING) << "Cannot run the compiler "
+                   << FLAGS_fusion_group_cpu_compiler
+                   << " of the fusion_group CPU kernels: " << output
+                   << "Please specify it by export "
+                      "FLAGS_fusion_group_cpu_compiler=xxx.";
+    }
+    return status == 0;
+  }();
+  return available;
+}
+
+bool CPUDeviceCode::Compile(bool include_path) {
+  is_compiled_ = false;
+  std::string dir = CPUCodeCacheDir();
+  if (!PrepareCPUCodeCacheDir(dir)) {
+    return false;
+  }
+
+  std::string compiler =
+      ShellQuote(FLAGS_fusion_group_cpu_compiler) + " " + kCPUCompileOptions;
+  std::string libs;
+  if (HasLibmvec()) {
+    compiler += " -DPADDLE_WITH_LIBMVEC";
+    libs = " -lmvec";
+  }
+  std::ostringstream lib_name;
+  lib_name << name_ << "_" << std::hex
+           << std::hash<std::string>()(compiler + "\n" +
+                                       NativeTargetMacros() + "\n" + kernel_)
+           << ".so";
+  std::string lib_path = dir + "/" + lib_name.str();
+
+  struct stat st;
+  if (stat(lib_path.c_str(), &st) != 0) {
+    // Build into a file of its own, and rename it at last, so that the
+    // processes compiling the same code concurrently do not see partial
+    // libraries.
+    static std::atomic<int> counter{0};
+    std::string tmp_path = lib_path + "." + std::to_string(getpid()) + "_" +
+                           std::to_string(counter++);
+    std::string src_path = tmp_path + ".cc";
+    {
+      std::ofstream src(src_path);
+      src << kernel_;
+      if (!src.good()) {
+        LOG(WARNING) << "Cannot write the source of " << name_ << " into "
+                     << src_path;
+        return false;
+      }
+    }
+    std::string output;
+    int status = RunCommand(compiler + " " + ShellQuote(src_path) + " -o " +
+                                ShellQuote(tmp_path) + libs,
+                            &output);
+    std::remove(src_path.c_str());
+    if (status != 0) {
+      std::remove(tmp_path.c_str());
+      LOG(WARNING) << "Failed to compile " << name_ << " by "
+                   << FLAGS_fusion_group_cpu_compiler << ":\n"
+                   << output << "\nThe source is:\n"
+                   << kernel_;
+      return false;
+    }
+    if (std::rename(tmp_path.c_str(), lib_path.c_str()) != 0) {
+      std::remove(tmp_path.c_str());
+      LOG(WARNING) << "Cannot move the library of " << name_ << " to "
+                   << lib_path << ": " << strerror(errno);
+      return false;
+    }
+    VLOG(3) << "Compiled " << name_ << " into " << lib_path;
+  }
+
+  handle_ = dlopen(lib_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle_ == nullptr) {
+    LOG(WARNING) << "Cannot load " << lib_path << ": " << dlerror();
+    return false;
+  }
+  function_ = reinterpret_cast<KernelFunc>(dlsym(handle_, name_.c_str()));
+  if (function_ == nullptr) {
+    LOG(WARNING) << "Cannot find " << name_ << " in " << lib_path << ": "
+                 << dlerror();
+    return false;
+  }
+
+  is_compiled_ = true;
+  return true;
+}
+
+void CPUDeviceCode::Launch(const size_t n, std::vector<void*>* args) const {
+  PADDLE_ENFORCE_EQ(
+      is_compiled_,
+      true,
+      errors::PreconditionNotMet(
+          "Please compile the code before launching the kernel."));
+
+  // The first argument is n, the kernel takes the data pointers.
+  std::vector<void*> ptrs;
+  ptrs.reserve(args->size());
+  for (size_t i = 1; i < args->size(); ++i) {
+    ptrs.push_back(*static_cast<void**>((*args)[i]));
+  }
+
+  int64_t numel = static_cast<int64_t>(n);
+#ifdef PADDLE_WITH_MKLML
+  int64_t num_chunks =
+      std::min<int64_t>(omp_get_max_threads(),
+                        (numel + kCPUMinElementsPerThread - 1) /
+                            kCPUMinElementsPerThread);
+  if (num_chunks > 1) {
+    // The chunks start on the multiples of 64 elements, to keep the vector
+    // loops aligned.
+    int64_t chunk_size = ((numel + num_chunks - 1) / num_chunks + 63) / 64 * 64;
+#pragma omp parallel for
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      int64_t begin = i * chunk_size;
+      int64_t end = std::min(numel, begin + chunk_size);
+      if (begin < end) {
+        function_(begin, end, ptrs.data());
+      }
+    }
+    return;
+  }
+#endif
+  function_(0, numel, ptrs.data());
+}
+#endif
+
 }  // namespace phi
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -89,6 +90,40 @@ class GPUDeviceCode : public DeviceCode {
 };
 #endif
 
+#if !defined(_WIN32)
+// Runs the C++ code generated for CPU. It is compiled into a shared library by
+// the host compiler, FLAGS_fusion_group_cpu_compiler, and the libraries are
+// cached by the hash of the code in FLAGS_fusion_group_cpu_cache_dir, so that
+// the same code is compiled once across the processes.
+//
+// The kernel should define
+//   extern "C" void name(int64_t begin, int64_t end, void** args)
+// computing the elements [begin, end), args being the data pointers. It is
+// compiled with PADDLE_WITH_LIBMVEC defined, and linked to libmvec, when the
+// vector math functions of glibc are available.
+class CPUDeviceCode : public DeviceCode {
+ public:
+  explicit CPUDeviceCode(const Place& place,
+                         const std::string& name,
+                         const std::string& kernel);
+  ~CPUDeviceCode() override;
+  bool Compile(bool include_path = false) override;
+  // args holds the address of n, then the addresses of the data pointers,
+  // like for GPUDeviceCode. The elements are split among the threads.
+  void Launch(const size_t n, std::vector<void*>* args) const override;
+
+  // Whether the host compiler can be run.
+  static bool IsAvailable();
+
+ private:
+  using KernelFunc = void (*)(int64_t, int64_t, void**);
+
+  bool is_compiled_{false};
+  void* handle_{nullptr};
+  KernelFunc function_{nullptr};
+};
+#endif
+
 class DeviceCodePool {
  public:
   using DeviceCodeMap =
@@ -107,6 +142,8 @@ class DeviceCodePool {
   static DeviceCodePool& Init(const std::vector<Place>& places) {
     if (pool == nullptr) {
       pool = new DeviceCodePool(places);
+    } else {
+      pool->AddPlaces(places);
     }
     return *pool;
   }
@@ -124,6 +161,8 @@ class DeviceCodePool {
   }
 
  private:
+  void AddPlaces(const std::vector<Place>& places);
+
   static DeviceCodePool* pool;
   std::map<Place, DeviceCodeMap> device_codes_;
   DISABLE_COPY_AND_ASSIGN(DeviceCodePool);
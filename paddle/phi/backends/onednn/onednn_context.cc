@@ -14,8 +14,14 @@
 #ifdef PADDLE_WITH_MKLDNN
 #include "paddle/phi/backends/onednn/onednn_context.h"
 
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <map>
+
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/flags.h"
 #include "paddle/utils/flat_hash_map.h"
 
 #include "paddle/phi/backends/context_pool.h"
@@ -23,6 +29,8 @@
 
 #include "glog/logging.h"
 
+PHI_DECLARE_int64(onednn_blob_cache_capacity);
+
 namespace phi {
 
 OneDNNContextThreadLocals::Body::Body()
@@ -89,6 +97,16 @@ OneDNNContextThreadLocals::Body& OneDNNContextThreadLocals::fetch() {
 }
 
 struct OneDNNContext::Impl {
+  // The blobs of an op, see OpPrefix.
+  struct OpEntry {
+    std::weak_ptr<KeyBlob> blob;
+    std::string prefix;
+    std::vector<std::string> names;
+    // Looked up since eviction last passed the op.
+    bool referenced;
+  };
+  using OpEntryIter = std::list<OpEntry>::iterator;
+
   Impl() : p_blobmap_() {
     p_blobmap_.reset(new BlobMap());
     p_exec_items_.reset(new ExecShape());
@@ -105,15 +123,22 @@ struct OneDNNContext::Impl {
       // If no specific executor pointer then clear
       // everything. For executor pointer then clear only
       // objects allocated when using given executor
+      ++generation_;
       if (ptr == nullptr) {
         p_blobmap_->clear();
+        op_entries_.clear();
+        blob_to_op_.clear();
+        prefix_to_op_.clear();
       } else {
         // Iterate through all shapes and release
         // for each shape and active executor all entries
         // of this executor
         for (auto& s : *p_exec_items_) {
           for (auto& v : (*s.second)[ptr]) {
-            (v.first)->erase(v.second);
+            auto it = (v.first)->find(v.second);
+            if (it != (v.first)->end()) {
+              EraseBlob(v.first.get(), it);
+            }
           }
           s.second->erase(ptr);
         }
@@ -135,6 +160,95 @@ struct OneDNNContext::Impl {
     }
   }
 
+  // The blobs of an op share the key of its handler, up to the last '@',
+  // e.g. "<key>@fwd_pd" and "<key>@fwd_p", and are evicted together, for a
+  // primitive not to outlive its primitive_desc or the other way around.
+  static std::string OpPrefix(const std::string& name) {
+    return name.substr(0, std::min(name.rfind('@'), name.size()));
+  }
+
+  // Add the blob at it to the entry of its op, the newest entry, or mark
+  // the entry used again. Must be called with p_mutex_ held.
+  OpEntryIter AddToOpEntry(const BlobPtr_t<KeyBlob>& pBlob,
+                           KeyBlob::iterator it) const {
+    auto blob_it = blob_to_op_.find(&*it);
+    if (blob_it != blob_to_op_.end()) {
+      blob_it->second->referenced = true;
+      return blob_it->second;
+    }
+    auto key = std::make_pair(pBlob.get(), OpPrefix(it->first));
+    auto prefix_it = prefix_to_op_.find(key);
+    OpEntryIter op;
+    if (prefix_it == prefix_to_op_.end()) {
+      op_entries_.push_front({pBlob, key.second, {}, false});
+      op = op_entries_.begin();
+      prefix_to_op_.emplace(key, op);
+    } else {
+      op = prefix_it->second;
+      op->referenced = true;
+    }
+    op->names.push_back(it->first);
+    blob_to_op_[&*it] = op;
+    return op;
+  }
+
+  // Take the blob at it out of the entry of its op, dropping the entry once
+  // it is empty. Must be called with p_mutex_ held.
+  void ForgetBlob(const KeyBlob* pBlob, KeyBlob::const_iterator it) const {
+    auto blob_it = blob_to_op_.find(&*it);
+    if (blob_it == blob_to_op_.end()) {
+      return;
+    }
+    OpEntryIter op = blob_it->second;
+    blob_to_op_.erase(blob_it);
+    op->names.erase(std::find(op->names.begin(), op->names.end(), it->first));
+    if (op->names.empty()) {
+      prefix_to_op_.erase(std::make_pair(pBlob, op->prefix));
+      op_entries_.erase(op);
+    }
+  }
+
+  void EraseBlob(KeyBlob* pBlob, KeyBlob::iterator it) const {
+    ForgetBlob(pBlob, it);
+    pBlob->erase(it);
+  }
+
+  // Drop the blobs of the least recently used ops while there are more than
+  // FLAGS_onednn_blob_cache_capacity, sparing the op of `current`. The ops
+  // are kept newest first and an op looked up since it was last passed gets
+  // a second chance at the front, so lookups only set a flag. Their
+  // KeyBlobs stay, so the memorized ones do too.
+  void EvictBlobs(OpEntryIter current) const {
+    const int64_t capacity = FLAGS_onednn_blob_cache_capacity;
+    while (capacity > 0 && blob_to_op_.size() > static_cast<size_t>(capacity)) {
+      OpEntryIter last = std::prev(op_entries_.end());
+      if (last == current) {
+        if (op_entries_.size() == 1) {
+          return;
+        }
+        op_entries_.splice(op_entries_.begin(), op_entries_, last);
+        continue;
+      }
+      if (last->referenced) {
+        last->referenced = false;
+        op_entries_.splice(op_entries_.begin(), op_entries_, last);
+        continue;
+      }
+      VLOG(2) << "Evict blobs of op=" << last->prefix << "\n";
+      auto pBlob = last->blob.lock();
+      for (const auto& name : last->names) {
+        if (pBlob != nullptr) {
+          auto it = pBlob->find(name);
+          blob_to_op_.erase(&*it);
+          pBlob->erase(it);
+        }
+        ++blob_evictions_;
+      }
+      prefix_to_op_.erase(std::make_pair(pBlob.get(), last->prefix));
+      op_entries_.erase(last);
+    }
+  }
+
   // Register object to currently used executor's map
   void LinkEntryWithExecutor(BlobPtr_t<KeyBlob> pblob,
                              KeyBlob::iterator it) const {
@@ -146,8 +260,8 @@ struct OneDNNContext::Impl {
             ->insert(std::make_pair(OneDNNContext::tls().cur_input_shape_str,
                                     std::make_shared<ExecMap>()))
             .first;
-    (*key_it->second)[OneDNNContext::tls().get_curr_exec()].push_back(
-        std::make_pair(pblob, it));
+    (*key_it->second)[OneDNNContext::tls().get_curr_exec()].insert(
+        std::make_pair(pblob, it->first));
 
     VLOG(3) << "LinkEntryWithExecutor, shapes: " << p_exec_items_->size()
             << " curr exec size: "
@@ -179,15 +293,64 @@ struct OneDNNContext::Impl {
     return map_it->second->size();
   }
 
+  // Return the KeyBlob remembered by this thread for the current session id
+  // and input shape, or nullptr if it has to be looked up again. Must be
+  // called with p_mutex_ held.
+  BlobPtr_t<KeyBlob> FindMemorizedKeyBlob(int sid) const {
+    auto& memo = key_blob_memo_;
+    if (memo.owner == this && memo.generation == generation_ &&
+        memo.sid == sid &&
+        memo.shape_str == OneDNNContext::tls().cur_input_shape_str) {
+      return memo.blob.lock();
+    }
+    return nullptr;
+  }
+
+  void MemorizeKeyBlob(int sid, const BlobPtr_t<KeyBlob>& pBlob) const {
+    auto& memo = key_blob_memo_;
+    memo.owner = this;
+    memo.generation = generation_;
+    memo.sid = sid;
+    memo.shape_str = OneDNNContext::tls().cur_input_shape_str;
+    memo.blob = pBlob;
+  }
+
   void SetBlob(const std::string& name, BlobPtr_t<void> data) const {
     BlobMap* pMap = p_blobmap_.get();
-    BlobPtr_t<ShapeBlob> sBlob = nullptr;
     BlobPtr_t<KeyBlob> pBlob = nullptr;
 
     int sid = OneDNNContext::tls().get_cur_mkldnn_session_id();
 
     std::lock_guard<decltype(*p_mutex_)> lock(*p_mutex_);
 
+    pBlob = FindMemorizedKeyBlob(sid);
+    if (pBlob == nullptr) {
+      pBlob = FindOrCreateKeyBlob(pMap, sid);
+      MemorizeKeyBlob(sid, pBlob);
+    }
+
+    // Find Blob via name
+    auto blob_it = pBlob->find(name);
+    if (blob_it == pBlob->end()) {
+      auto el =
+          pBlob->insert(std::make_pair(name, data));  //  (*pBlob)[name] = data;
+      // Register new element in per executor map
+      // to have easily erased when executor terminated
+      LinkEntryWithExecutor(pBlob, el.first);
+      EvictBlobs(AddToOpEntry(pBlob, el.first));
+    } else {
+      blob_it->second = data;  // set data to existing blob
+      AddToOpEntry(pBlob, blob_it);
+    }
+    VLOG(2) << "SetBlob: sid=" << sid << ", add blob=" << name << "\n";
+    // lock will be automatically released when out of scope
+    return;
+  }
+
+  BlobPtr_t<KeyBlob> FindOrCreateKeyBlob(BlobMap* pMap, int sid) const {
+    BlobPtr_t<ShapeBlob> sBlob = nullptr;
+    BlobPtr_t<KeyBlob> pBlob = nullptr;
+
     // Find ShapeBlob for current mkldnn session id.
     auto map_it = pMap->find(sid);
 
@@ -214,29 +377,25 @@ struct OneDNNContext::Impl {
                OneDNNContext::tls().cur_input_shape_cache_capacity))) {
         VLOG(2) << "sid=" << sid
                 << ", remove all blobs of shape: " << sBlob->begin()->first;
+        const KeyBlob* evicted = sBlob->begin()->second.get();
+        for (auto it = evicted->begin(); it != evicted->end(); ++it) {
+          ForgetBlob(evicted, it);
+        }
         sBlob->erase(sBlob->begin()->first);
         RemoveShapeEntriesWithExecutor();
+        ++generation_;
       }
       pBlob = std::make_shared<KeyBlob>();
       (*sBlob)[OneDNNContext::tls().cur_input_shape_str] = pBlob;
     } else {
       pBlob = key_it->second;
     }
+    return pBlob;
+  }
 
-    // Find Blob via name
-    auto blob_it = pBlob->find(name);
-    if (blob_it == pBlob->end()) {
-      auto el =
-          pBlob->insert(std::make_pair(name, data));  //  (*pBlob)[name] = data;
-      // Register new element in per executor map
-      // to have easily erased when executor terminated
-      LinkEntryWithExecutor(pBlob, el.first);
-    } else {
-      blob_it->second = data;  // set data to existing blob
-    }
-    VLOG(2) << "SetBlob: sid=" << sid << ", add blob=" << name << "\n";
-    // lock will be automatically released when out of scope
-    return;
+  OneDNNContext::BlobCacheStats GetBlobCacheStats() const {
+    std::lock_guard<decltype(*p_mutex_)> lock(*p_mutex_);
+    return {blob_hits_, blob_misses_, blob_evictions_};
   }
 
   unsigned int GetCachedObjectsNumber(void) const {
@@ -258,35 +417,47 @@ struct OneDNNContext::Impl {
 
     std::lock_guard<decltype(*p_mutex_)> lock(*p_mutex_);
 
-    // Find ShapeBlob for current mkldnn session id firstly
-    auto map_it = pMap->find(sid);
-    // (jczaja): After first iteration of model's execution we
-    // should have all elements cached (mostly) so failures are unlikely (less
-    // likely for dynamic shapes)
-    if (unlikely(map_it == pMap->end())) {
-      VLOG(2) << "GetBlob: sid=" << sid << ", miss sid\n";
-      return nullptr;
-    }
-    sBlob = map_it->second;
+    pBlob = FindMemorizedKeyBlob(sid);
+    if (pBlob == nullptr) {
+      // Find ShapeBlob for current mkldnn session id firstly
+      auto map_it = pMap->find(sid);
+      // (jczaja): After first iteration of model's execution we
+      // should have all elements cached (mostly) so failures are unlikely
+      // (less likely for dynamic shapes)
+      if (unlikely(map_it == pMap->end())) {
+        VLOG(2) << "GetBlob: sid=" << sid << ", miss sid\n";
+        ++blob_misses_;
+        return nullptr;
+      }
+      sBlob = map_it->second;
 
-    // Find KeyBlob for current input shape secondly
-    auto sBlob_it = sBlob->find(OneDNNContext::tls().cur_input_shape_str);
-    if (unlikely(sBlob_it == sBlob->end())) {
-      VLOG(2) << "GetBlob: sid=" << OneDNNContext::tls().cur_input_shape_str
-              << ", miss input_shape_str\n";
-      return nullptr;
+      // Find KeyBlob for current input shape secondly
+      auto sBlob_it = sBlob->find(OneDNNContext::tls().cur_input_shape_str);
+      if (unlikely(sBlob_it == sBlob->end())) {
+        VLOG(2) << "GetBlob: sid=" << OneDNNContext::tls().cur_input_shape_str
+                << ", miss input_shape_str\n";
+        ++blob_misses_;
+        return nullptr;
+      }
+      pBlob = sBlob_it->second;
+      MemorizeKeyBlob(sid, pBlob);
     }
-    pBlob = sBlob_it->second;
 
     // Find Blob via name
     auto key_it = pBlob->find(name);
 
     if (unlikely(key_it == pBlob->end())) {
       VLOG(2) << "GetBlob sid=" << sid << ", miss blob=" << name << "\n";
+      ++blob_misses_;
       return nullptr;
     }
 
     VLOG(2) << "GetBlob sid=" << sid << ", get blob=" << name << "\n";
+    ++blob_hits_;
+    auto op_it = blob_to_op_.find(&*key_it);
+    if (op_it != blob_to_op_.end()) {
+      op_it->second->referenced = true;
+    }
     // lock will be automatically released when out of scope
     return key_it->second;
   }
@@ -363,6 +534,35 @@ struct OneDNNContext::Impl {
   std::shared_ptr<std::mutex> p_mutex_;
   // 0 - clearing is allowed. x > 0 do not clear.
   unsigned int block_next_cache_clearing_ = 0;
+  // Bumped whenever KeyBlobs may be dropped from the maps, invalidates the
+  // KeyBlob memorized by every thread.
+  mutable uint64_t generation_ = 0;
+  // GetBlob statistics, updated with p_mutex_ held.
+  mutable uint64_t blob_hits_ = 0;
+  mutable uint64_t blob_misses_ = 0;
+  mutable uint64_t blob_evictions_ = 0;
+
+  // The cached blobs grouped by op, the newest op first, guarded by
+  // p_mutex_. A blob is found by the address of its node in the KeyBlob,
+  // which stays put until the blob is erased.
+  mutable std::list<OpEntry> op_entries_;
+  mutable std::unordered_map<const KeyBlob::value_type*, OpEntryIter>
+      blob_to_op_;
+  mutable std::map<std::pair<const KeyBlob*, std::string>, OpEntryIter>
+      prefix_to_op_;
+
+  // The KeyBlob that this thread resolved last, so repeated GetBlob/SetBlob
+  // calls with the same session id and input shape skip the two outer map
+  // lookups (and hashing the input shape string).
+  struct KeyBlobMemo {
+    const Impl* owner = nullptr;
+    uint64_t generation = 0;
+    int sid = 0;
+    std::string shape_str;
+    // Not owning, so clearing the cache still releases the primitives.
+    std::weak_ptr<KeyBlob> blob;
+  };
+  static thread_local KeyBlobMemo key_blob_memo_;
 
   // Holds some attributes only used by the onednn kernel calculation
   // Since original mkldnn op kernel directly adds the operations that require
@@ -391,6 +591,8 @@ thread_local paddle::flat_hash_map<std::string, const DenseTensor*>
     OneDNNContext::Impl::dnn_inputs_ = {};
 thread_local TensorNameMap OneDNNContext::Impl::inputs_name_ = {};
 thread_local TensorNameMap OneDNNContext::Impl::outputs_name_ = {};
+thread_local OneDNNContext::Impl::KeyBlobMemo
+    OneDNNContext::Impl::key_blob_memo_ = {};
 
 OneDNNContext::OneDNNContext(const Place& place)
     : CPUContext(place), impl_(std::make_unique<Impl>()) {}
@@ -421,6 +623,10 @@ OneDNNContext::BlobPtr_t<void> OneDNNContext::GetBlob(
   return impl_->GetBlob(name);
 }
 
+OneDNNContext::BlobCacheStats OneDNNContext::GetBlobCacheStats() const {
+  return impl_->GetBlobCacheStats();
+}
+
 bool OneDNNContext::HasDnnAttr(const std::string& attr_name) const {
   return impl_->HasDnnAttr(attr_name);
 }
@@ -16,6 +16,7 @@ limitations under the License. */
 #ifdef PADDLE_WITH_MKLDNN
 #include <memory>
 #include <mutex>     // NOLINT
+#include <set>
 #include "dnnl.hpp"  // NOLINT
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/common/layout.h"
@@ -99,12 +100,12 @@ class OneDNNContext : public CPUContext {
   using BlobMap = umap_value_smart_t<int, ShapeBlob>;
 
   // Auxillary two-level structure (shape, executor) to easier control
-  // clearing cache objects related to specific executor
+  // clearing cache objects related to specific executor. The objects are
+  // kept by name, as they may have been evicted, and set again, since.
 
   using ExecKey = void*;
-  using ExecMapCacheIterPair = std::pair<BlobPtr_t<KeyBlob>, KeyBlob::iterator>;
-  using ExecMap =
-      std::unordered_map<ExecKey, std::vector<ExecMapCacheIterPair>>;
+  using ExecMapCacheKeyPair = std::pair<BlobPtr_t<KeyBlob>, std::string>;
+  using ExecMap = std::unordered_map<ExecKey, std::set<ExecMapCacheKeyPair>>;
   using ExecShape = std::unordered_map<std::string, std::shared_ptr<ExecMap>>;
 
   explicit OneDNNContext(const Place& place);
@@ -130,6 +131,16 @@ class OneDNNContext : public CPUContext {
   // Find a saved blob. Return nullptr if not found
   std::shared_ptr<void> GetBlob(const std::string& name) const;
 
+  struct BlobCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+  };
+
+  // Number of GetBlob calls that found / missed a saved blob, and of blobs
+  // evicted past FLAGS_onednn_blob_cache_capacity
+  BlobCacheStats GetBlobCacheStats() const;
+
   static auto tls() -> decltype(OneDNNContextThreadLocals::fetch()) {
     return OneDNNContextThreadLocals::fetch();
   }
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <thread>
+#include <type_traits>
 #include "dnnl.hpp"  // NOLINT
 #include "glog/logging.h"
 
@@ -150,10 +151,51 @@ inline std::vector<std::vector<int64_t>> ToOneDNNPadding(
 }
 
 template <typename T>
-inline void AppendKey(std::string* key, const T& num) {
+inline bool IsNegativeNumber(T num, std::true_type /*is_signed*/) {
+  return num < 0;
+}
+
+template <typename T>
+inline bool IsNegativeNumber(T /*num*/, std::false_type /*is_signed*/) {
+  return false;
+}
+
+// Keys are created on every kernel call, so integers are printed straight
+// into the key instead of going through a temporary std::to_string.
+template <typename T>
+inline void AppendNumberKey(std::string* key, T num, std::true_type) {
+  using UnsignedT = typename std::make_unsigned<T>::type;
+  char buf[24];
+  char* end = buf + sizeof(buf);
+  char* p = end;
+  bool negative = IsNegativeNumber(num, std::is_signed<T>());
+  UnsignedT value = negative ? static_cast<UnsignedT>(0) -
+                                   static_cast<UnsignedT>(num)
+                             : static_cast<UnsignedT>(num);
+  do {
+    *--p = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  if (negative) {
+    *--p = '-';
+  }
+  key->append(p, end - p);
+}
+
+inline void AppendNumberKey(std::string* key, bool num, std::true_type) {
+  key->push_back(num ? '1' : '0');
+}
+
+template <typename T>
+inline void AppendNumberKey(std::string* key, T num, std::false_type) {
   key->append(std::to_string(num));
 }
 
+template <typename T>
+inline void AppendKey(std::string* key, const T& num) {
+  AppendNumberKey(key, num, std::is_integral<T>());
+}
+
 template <>
 inline void AppendKey(std::string* key,
                       const dnnl::memory::format_tag& format) {
@@ -186,7 +228,7 @@ inline void AppendKey(std::string* key, const char* str) { key->append(str); }
 template <typename T>
 inline void AppendKey(std::string* key, const std::vector<T>& dims) {
   for (size_t i = 0; i < dims.size(); i++) {
-    AppendKey(key, std::to_string(dims[i]));
+    AppendKey(key, dims[i]);
   }
 }
 
@@ -132,6 +132,17 @@ void* DenseTensor::AllocateFrom(Allocator* allocator,
     }
   }
 
+  // A strided view shares the memory of the tensor it was made from, which
+  // must not be written through the view, so it gets a memory of its own,
+  // and an inplace version apart from that tensor.
+  if (!meta_.strides.empty()) {
+    meta_.strides.clear();
+    meta_.offset = 0;
+    holder_.reset();
+    inplace_version_counter_ =
+        std::make_shared<InplaceVersion>(*inplace_version_counter_);
+  }
+
   // NOTE(paddle-dev): In case of the allocator of storage_ is different with
   // the incoming allocator, we will re-alloc data using the incoming
   // allocator. See DeviceContext.Alloc in core/device_context.cc.
@@ -223,6 +234,36 @@ void DenseTensor::set_meta(const DenseTensorMeta& meta) {
   meta_.lod = meta.lod;
   meta_.offset = meta.offset;
   meta_.use_gpudnn = meta.use_gpudnn;
+  meta_.strides = meta.strides;
+}
+
+void DenseTensor::set_strides(const std::vector<int64_t>& strides) {
+  PADDLE_ENFORCE_EQ(
+      strides.size(),
+      static_cast<size_t>(meta_.dims.size()),
+      phi::errors::InvalidArgument(
+          "The size of the strides (%d) must be equal to the rank of the "
+          "tensor (%d).",
+          strides.size(),
+          meta_.dims.size()));
+  // The strides of the dims of size 1 do not matter.
+  bool contiguous = true;
+  int64_t expected = 1;
+  for (int i = meta_.dims.size() - 1; i >= 0; --i) {
+    if (meta_.dims[i] == 0) {
+      contiguous = true;
+      break;
+    }
+    if (meta_.dims[i] != 1) {
+      contiguous = contiguous && strides[i] == expected;
+      expected *= meta_.dims[i];
+    }
+  }
+  if (contiguous) {
+    meta_.strides.clear();
+  } else {
+    meta_.strides = strides;
+  }
 }
 
 /* @jim19930609: This interface will be further modified until we finalized the
@@ -113,6 +113,22 @@ class DenseTensor : public TensorBase,
 
   void set_meta(const DenseTensorMeta& meta);
 
+  /// \brief Returns the strides of the tensor in elements, empty for the
+  /// row-major tensors.
+  /// \return The strides of the tensor.
+  const std::vector<int64_t>& strides() const noexcept {
+    return meta_.strides;
+  }
+
+  /// \brief Makes the tensor a strided view of its memory. The strides equal
+  /// to the row-major ones of the dims are dropped.
+  /// \param strides The strides of the dense tensor, in elements.
+  void set_strides(const std::vector<int64_t>& strides);
+
+  /// \brief Test whether the elements are laid out row-major without gaps.
+  /// \return Whether the tensor is contiguous.
+  bool is_contiguous() const noexcept { return meta_.is_contiguous(); }
+
   /// \brief Test whether the metadata is valid.
   /// \return Whether the metadata is valid.
   bool valid() const noexcept override { return meta_.valid(); }
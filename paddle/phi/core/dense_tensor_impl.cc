@@ -43,14 +43,14 @@ void DenseTensor::check_memory_size() const {
       phi::errors::PreconditionNotMet("Tensor holds no memory. "
                                       "Call Tensor::mutable_data firstly."));
   PADDLE_ENFORCE_LE(
-      numel() * SizeOf(dtype()),
+      meta_.storage_numel() * SizeOf(dtype()),
       memory_size(),
       phi::errors::PreconditionNotMet(
           "Tensor's dimension is out of bound."
           "Tensor's dimension must be equal or less than the size of its "
           "memory."
           "But received Tensor's dimension is %d, memory's size is %d.",
-          numel() * SizeOf(dtype()),
+          meta_.storage_numel() * SizeOf(dtype()),
           memory_size()));
 }
 
@@ -105,11 +105,12 @@ void* DenseTensor::mutable_data(const Place& place,
   }
 
   /* some versions of paddle::variant don't have operator!= */
-  if (holder_ == nullptr || !(holder_->place() == place) ||
-      holder_->size() < size + meta_.offset) {
+  if (holder_ == nullptr || !meta_.strides.empty() ||
+      !(holder_->place() == place) || holder_->size() < size + meta_.offset) {
     holder_.reset();
     holder_ = memory_utils::AllocShared(place, size);
     meta_.offset = 0;
+    meta_.strides.clear();
   }
   return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(holder_->ptr()) +
                                  meta_.offset);
@@ -134,13 +135,14 @@ void* DenseTensor::mutable_data(const Place& place,
   size_t size = numel() * SizeOf(dtype());
 
   /* some versions of paddle::variant don't have operator!= */
-  if (holder_ == nullptr || !(holder_->place() == place) ||
-      holder_->size() < size + meta_.offset ||
+  if (holder_ == nullptr || !meta_.strides.empty() ||
+      !(holder_->place() == place) || holder_->size() < size + meta_.offset ||
       !(place.GetType() == phi::AllocationType::GPU &&
         memory_utils::InSameStream(holder_, stream))) {
     holder_.reset();
     holder_ = memory_utils::AllocShared(place, size, stream);
     meta_.offset = 0;
+    meta_.strides.clear();
   }
   return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(holder_->ptr()) +
                                  meta_.offset);
@@ -250,6 +252,13 @@ size_t DenseTensor::NumElements(size_t level) const {
 }
 
 DenseTensor& DenseTensor::Resize(const DDim& dims) {
+  // The elements of a strided view can not be read with other dims, so it
+  // becomes a tensor to be allocated.
+  if (!meta_.strides.empty() && meta_.dims != dims) {
+    meta_.strides.clear();
+    meta_.offset = 0;
+    holder_.reset();
+  }
   meta_.dims = dims;
   return *this;
 }
@@ -358,6 +367,7 @@ DenseTensor& DenseTensor::ShareDataWith(const DenseTensor& src) {
   meta_.layout = src.meta_.layout;
   meta_.offset = src.meta_.offset;
   meta_.use_gpudnn = src.meta_.use_gpudnn;
+  meta_.strides = src.meta_.strides;
   storage_properties_ =
       std::move(CopyStorageProperties(src.storage_properties_));
 #ifdef PADDLE_WITH_MKLDNN
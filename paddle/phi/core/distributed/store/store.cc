@@ -38,5 +38,29 @@ void Store::set(const std::string& key, const std::vector<uint8_t>& value) {
       errors::InvalidArgument("Implement the set method in the subclass."));
 }
 
+std::vector<std::vector<uint8_t>> Store::multi_get(
+    const std::vector<std::string>& keys) {
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  for (const auto& key : keys) {
+    values.push_back(get(key));
+  }
+  return values;
+}
+
+void Store::multi_set(const std::vector<std::string>& keys,
+                      const std::vector<std::vector<uint8_t>>& values) {
+  PADDLE_ENFORCE_EQ(keys.size(),
+                    values.size(),
+                    errors::InvalidArgument(
+                        "The numbers of keys and values must be the same, but "
+                        "got %d keys and %d values.",
+                        keys.size(),
+                        values.size()));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    set(keys[i], values[i]);
+  }
+}
+
 }  // namespace distributed
 }  // namespace phi
@@ -31,6 +31,11 @@ class Store {
   virtual std::vector<uint8_t> get(const std::string& key);
   virtual void wait(const std::string& key);
   virtual void set(const std::string& key, const std::vector<uint8_t>& value);
+  // The values of keys, waiting for them, and the sets of keys to values.
+  virtual std::vector<std::vector<uint8_t>> multi_get(
+      const std::vector<std::string>& keys);
+  virtual void multi_set(const std::vector<std::string>& keys,
+                         const std::vector<std::vector<uint8_t>>& values);
 
   virtual int timeout() { return _timeout; }
 
@@ -14,6 +14,11 @@
 
 #include "paddle/phi/core/distributed/store/tcp_store.h"
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <thread>
@@ -29,6 +34,82 @@ namespace distributed {
 namespace detail {
 
 constexpr int INFTIME = 10000;  // 10 seconds
+constexpr size_t kNumShards = 32;
+constexpr size_t kMaxThreads = 8;
+
+#ifdef __linux__
+SocketPoller::SocketPoller() {
+  _epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+  PADDLE_ENFORCE_NE(
+      _epoll_fd,
+      -1,
+      phi::errors::Fatal("failed to create epoll fd errno:%d", errno));
+}
+
+SocketPoller::~SocketPoller() { ::close(_epoll_fd); }
+
+void SocketPoller::Add(SocketType socket) {
+  struct epoll_event event {};
+  event.events = EPOLLIN | EPOLLRDHUP;
+  event.data.fd = socket;
+  PADDLE_ENFORCE_NE(
+      ::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, socket, &event),
+      -1,
+      phi::errors::Fatal("failed to add fd to epoll errno:%d", errno));
+}
+
+void SocketPoller::Remove(SocketType socket) {
+  ::epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+std::vector<SocketType> SocketPoller::Wait(int timeout_ms) {
+  std::array<struct epoll_event, 64> events;
+  int res = ::epoll_wait(_epoll_fd, events.data(), events.size(), timeout_ms);
+  std::vector<SocketType> ready;
+  for (int i = 0; i < res; ++i) {
+    ready.push_back(events[i].data.fd);
+  }
+  return ready;
+}
+#else
+SocketPoller::SocketPoller() = default;
+
+SocketPoller::~SocketPoller() = default;
+
+void SocketPoller::Add(SocketType socket) {
+  struct pollfd fd {};
+  fd.fd = socket;
+  fd.events = POLLIN;
+  _fds.push_back(fd);
+}
+
+void SocketPoller::Remove(SocketType socket) {
+  for (auto it = _fds.begin(); it != _fds.end(); ++it) {
+    if (it->fd == socket) {
+      _fds.erase(it);
+      return;
+    }
+  }
+}
+
+std::vector<SocketType> SocketPoller::Wait(int timeout_ms) {
+  for (auto& fd : _fds) {
+    fd.revents = 0;
+  }
+#ifdef _WIN32
+  ::WSAPoll(_fds.data(), _fds.size(), timeout_ms);
+#else
+  ::poll(_fds.data(), _fds.size(), timeout_ms);
+#endif
+  std::vector<SocketType> ready;
+  for (const auto& fd : _fds) {
+    if (fd.revents != 0) {
+      ready.push_back(fd.fd);
+    }
+  }
+  return ready;
+}
+#endif
 
 std::unique_ptr<MasterDaemon> MasterDaemon::start(SocketType socket,
                                                   int nranks,
@@ -38,15 +119,37 @@ std::unique_ptr<MasterDaemon> MasterDaemon::start(SocketType socket,
 }
 
 MasterDaemon::MasterDaemon(SocketType socket, int nranks, int timeout)
-    : _listen_socket(socket), _nranks(nranks), _timeout(timeout) {
+    : _listen_socket(socket),
+      _shards(kNumShards),
+      _nranks(nranks),
+      _timeout(timeout) {
   InitControlFd();
-  _background_thread = std::thread{&MasterDaemon::run, this};
+#ifdef __linux__
+  const size_t num_threads = std::max(
+      static_cast<size_t>(1),
+      std::min(kMaxThreads,
+               static_cast<size_t>(std::thread::hardware_concurrency())));
+#else
+  const size_t num_threads = 1;
+#endif
+  for (size_t i = 0; i < num_threads; ++i) {
+    _pollers.emplace_back(std::make_unique<SocketPoller>());
+#ifndef _WIN32
+    _pollers.back()->Add(_control_fd[0]);
+#endif
+  }
+  _pollers[0]->Add(_listen_socket);
+  for (size_t i = 0; i < num_threads; ++i) {
+    _background_threads.emplace_back(&MasterDaemon::run, this, i);
+  }
 }
 
 MasterDaemon::~MasterDaemon() {
   VLOG(4) << ("begin to destruct MasterDaemon");
   StopByControlFd();
-  _background_thread.join();
+  for (auto& thread : _background_threads) {
+    thread.join();
+  }
   tcputils::close_socket(_listen_socket);
   for (SocketType socket : _sockets) {
     tcputils::close_socket(socket);
@@ -54,26 +157,50 @@ MasterDaemon::~MasterDaemon() {
   CloseControlFd();
 }
 
+StoreShard& MasterDaemon::GetShard(const std::string& key) {
+  return _shards[std::hash<std::string>()(key) % _shards.size()];
+}
+
+void MasterDaemon::SetValue(const std::string& key,
+                            std::vector<uint8_t> value) {
+  StoreShard& shard = GetShard(key);
+  std::vector<std::shared_ptr<Waiter>> ready;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.store[key] = std::move(value);
+    ready = _notify_waiting_sockets(&shard, key);
+  }
+  for (const auto& waiter : ready) {
+    ReplyStopWait(waiter);
+  }
+}
+
 void MasterDaemon::_do_add(SocketType socket) {
   int64_t new_value{};
   std::string key = tcputils::receive_string(socket);
   new_value = tcputils::receive_value<int64_t>(socket);
-  std::vector<uint8_t> old_value;
-  auto it = _store.find(key);
-  if (it != _store.end()) {
-    old_value = it->second;
-    char* buffer = reinterpret_cast<char*>(it->second.data());
-    size_t len = old_value.size();
-    new_value += std::stoll(std::string(buffer, len));
-  }
-
-  std::string new_value_str = std::to_string(new_value);
-  _store[key] =
-      std::vector<uint8_t>(new_value_str.begin(), new_value_str.end());
+  std::vector<std::shared_ptr<Waiter>> ready;
+  {
+    StoreShard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.store.find(key);
+    if (it != shard.store.end()) {
+      char* buffer = reinterpret_cast<char*>(it->second.data());
+      size_t len = it->second.size();
+      new_value += std::stoll(std::string(buffer, len));
+    }
+
+    std::string new_value_str = std::to_string(new_value);
+    shard.store[key] =
+        std::vector<uint8_t>(new_value_str.begin(), new_value_str.end());
+    ready = _notify_waiting_sockets(&shard, key);
+  }
+  for (const auto& waiter : ready) {
+    ReplyStopWait(waiter);
+  }
   VLOG(4) << "TCPStore: new value (" << new_value << ") for key (" << key
           << ") " << GetSockName(socket);
   tcputils::send_value<int64_t>(socket, new_value);
-  _notify_waiting_sockets(key);
 }
 
 void MasterDaemon::_do_set(SocketType socket) {
@@ -81,19 +208,51 @@ void MasterDaemon::_do_set(SocketType socket) {
   VLOG(4) << "MasterDaemon::_do_set key(" << key << ") " << GetSockName(socket);
 
   auto value = tcputils::receive_vector<uint8_t>(socket);
-  _store[key] = value;
-  _notify_waiting_sockets(key);
+  SetValue(key, std::move(value));
 }
 
-void MasterDaemon::_notify_waiting_sockets(const std::string& key) {
-  if (_waiting_sockets.find(key) != _waiting_sockets.end()) {
-    for (auto waiting_socket : _waiting_sockets.at(key)) {
-      auto reply = ReplyType::STOP_WAIT;
-      VLOG(3) << "TCPStore: notify the socket: " << GetSockName(waiting_socket)
-              << " that key: " << key << " is ready.";
-      tcputils::send_value<ReplyType>(waiting_socket, reply);
+void MasterDaemon::_do_multi_set(SocketType socket) {
+  size_t num_keys = tcputils::receive_value<size_t>(socket);
+  VLOG(4) << "MasterDaemon::_do_multi_set " << num_keys << " keys "
+          << GetSockName(socket);
+  for (size_t i = 0; i < num_keys; ++i) {
+    std::string key = tcputils::receive_string(socket);
+    auto value = tcputils::receive_vector<uint8_t>(socket);
+    SetValue(key, std::move(value));
+  }
+}
+
+std::vector<std::shared_ptr<Waiter>> MasterDaemon::_notify_waiting_sockets(
+    StoreShard* shard, const std::string& key) {
+  std::vector<std::shared_ptr<Waiter>> ready;
+  auto it = shard->waiting.find(key);
+  if (it == shard->waiting.end()) {
+    return ready;
+  }
+  for (const auto& waiter : it->second) {
+    if (--waiter->remaining > 0) {
+      continue;
     }
-    _waiting_sockets.erase(key);
+    VLOG(3) << "TCPStore: notify the socket: " << GetSockName(waiter->socket)
+            << " that key: " << key << " is ready.";
+    ready.emplace_back(waiter);
+  }
+  shard->waiting.erase(it);
+  return ready;
+}
+
+void MasterDaemon::ReplyStopWait(const std::shared_ptr<Waiter>& waiter) {
+  // A blocking send holds up no shard, only the close of this socket, which
+  // then can not hand the fd to a new connection before the reply is gone.
+  std::lock_guard<std::mutex> lock(waiter->mutex);
+  if (waiter->closed) {
+    return;
+  }
+  try {
+    tcputils::send_value<ReplyType>(waiter->socket, ReplyType::STOP_WAIT);
+  } catch (const std::exception& ex) {
+    // The thread of the socket closes it on its next read.
+    VLOG(5) << "Meet some exceptions during notify:" << ex.what();
   }
 }
 
@@ -101,15 +260,39 @@ void MasterDaemon::_do_get(SocketType socket) {
   std::string key = tcputils::receive_string(socket);
   VLOG(4) << "MasterDaemon::_do_get key(" << key << ") " << GetSockName(socket);
 
-  auto iter = _store.find(key);
-  PADDLE_ENFORCE_NE(
-      iter,
-      _store.end(),
-      phi::errors::InvalidArgument("Key %s not found in TCPStore.", key));
-  std::vector<uint8_t> value = iter->second;
+  std::vector<uint8_t> value;
+  {
+    StoreShard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.store.find(key);
+    PADDLE_ENFORCE_NE(
+        iter,
+        shard.store.end(),
+        phi::errors::InvalidArgument("Key %s not found in TCPStore.", key));
+    value = iter->second;
+  }
   tcputils::send_vector<uint8_t>(socket, value);
 }
 
+void MasterDaemon::_do_multi_get(SocketType socket) {
+  size_t num_keys = tcputils::receive_value<size_t>(socket);
+  std::vector<char> buffer;
+  for (size_t i = 0; i < num_keys; ++i) {
+    std::string key = tcputils::receive_string(socket);
+    StoreShard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.store.find(key);
+    PADDLE_ENFORCE_NE(
+        iter,
+        shard.store.end(),
+        phi::errors::InvalidArgument("Key %s not found in TCPStore.", key));
+    tcputils::append_vector<uint8_t>(&buffer, iter->second);
+  }
+  VLOG(4) << "MasterDaemon::_do_multi_get " << num_keys << " keys "
+          << GetSockName(socket);
+  tcputils::send_bytes<char>(socket, buffer.data(), buffer.size());
+}
+
 #ifndef _WIN32
 void MasterDaemon::InitControlFd() {
   PADDLE_ENFORCE_NE(
@@ -147,148 +330,178 @@ void MasterDaemon::CloseControlFd() { CloseHandle(ghStopEvent_); }
 void MasterDaemon::StopByControlFd() { SetEvent(ghStopEvent_); }
 #endif
 
+void MasterDaemon::WaitForKeys(SocketType socket,
+                               const std::vector<std::string>& keys) {
+  // One count for every missing key, and one for this function, so the reply
+  // goes once, after the last of the keys is set and the keys are checked.
+  auto waiter = std::make_shared<Waiter>();
+  waiter->socket = socket;
+  waiter->remaining = 1;
+  {
+    std::lock_guard<std::mutex> lock(_sockets_mutex);
+    _waiters[socket] = waiter;
+  }
+  for (const auto& key : keys) {
+    StoreShard& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.store.find(key) == shard.store.end()) {
+      // The key can not be found in store currently. Record and check later.
+      ++waiter->remaining;
+      shard.waiting[key].emplace_back(waiter);
+    }
+  }
+  if (--waiter->remaining == 0) {
+    VLOG(3) << "TCPStore: wait reply ("
+            << static_cast<int>(ReplyType::STOP_WAIT) << ") for "
+            << keys.size() << " keys.";
+    tcputils::send_value<ReplyType>(socket, ReplyType::STOP_WAIT);
+  }
+}
+
 void MasterDaemon::_do_wait(SocketType socket) {
   std::string key = tcputils::receive_string(socket);
   VLOG(4) << "MasterDaemon::_do_wait key(" << key << ") "
           << GetSockName(socket);
+  WaitForKeys(socket, {key});
+}
 
-  auto iter = _store.find(key);
-  if (iter == _store.end()) {
-    // The key can not be found in store currently. Record and check later.
-    _waiting_sockets[key].emplace_back(socket);
-  } else {
-    auto reply = ReplyType::STOP_WAIT;
-    VLOG(3) << "TCPStore: wait reply (" << static_cast<int>(reply)
-            << ") for key (" << key << ").";
-    tcputils::send_value<ReplyType>(socket, reply);
+void MasterDaemon::_do_multi_wait(SocketType socket) {
+  size_t num_keys = tcputils::receive_value<size_t>(socket);
+  std::vector<std::string> keys(num_keys);
+  for (auto& key : keys) {
+    key = tcputils::receive_string(socket);
   }
+  VLOG(4) << "MasterDaemon::_do_multi_wait " << num_keys << " keys "
+          << GetSockName(socket);
+  WaitForKeys(socket, keys);
 }
 
-void MasterDaemon::ProcessCommands(std::vector<struct pollfd>* p_fds) {
-  std::vector<struct pollfd>& fds = *p_fds;
-  // FIXME(gongwb): Don't loop all fds of set just the fds who have event.
-#ifdef _WIN32
-  // 0: listen socket, so loop from 1.
-  for (size_t i = 1; i < fds.size(); i++) {
-#else
-  // 0: listen socket, 1:controller pipe, so loop from 2.
-  for (size_t i = 2; i < fds.size(); i++) {
-#endif
-    try {
-      if (fds[i].revents == 0) {
-        continue;
+void MasterDaemon::RemoveWaitingSocket(SocketType socket) {
+  for (auto& shard : _shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto map_iter = shard.waiting.begin();
+    while (map_iter != shard.waiting.end()) {
+      auto& waiters = map_iter->second;
+      waiters.erase(std::remove_if(waiters.begin(),
+                                   waiters.end(),
+                                   [socket](const std::shared_ptr<Waiter>& w) {
+                                     return w->socket == socket;
+                                   }),
+                    waiters.end());
+      if (waiters.empty()) {
+        map_iter = shard.waiting.erase(map_iter);
+      } else {
+        ++map_iter;
       }
+    }
+  }
+}
 
-      VLOG(4) << "Plan to receive command from " << GetSockName(fds[i].fd);
-      Command command = tcputils::receive_value<Command>(fds[i].fd);
-      VLOG(3) << "TCPStore: recv command: " << static_cast<int>(command) << ".";
-
-      switch (command) {
-        case Command::ADD:
-          _do_add(fds[i].fd);
-          break;
-        case Command::GET:
-          _do_get(fds[i].fd);
-          break;
-        case Command::SET:
-          _do_set(fds[i].fd);
-          break;
-        case Command::WAIT:
-          _do_wait(fds[i].fd);
-          break;
-        default:
-          VLOG(4) << "Unknown command: " << static_cast<int>(command)
-                  << " from addr info:" << GetSockName(fds[i].fd);
-      }
-    } catch (const std::exception& ex) {
-      auto map_iter = _waiting_sockets.begin();
-      while (map_iter != _waiting_sockets.end()) {
-        auto vec_iter = map_iter->second.begin();
-        while (vec_iter != map_iter->second.end()) {
-          if (*vec_iter == fds[i].fd) {
-            vec_iter = map_iter->second.erase(vec_iter);
-          } else {
-            ++vec_iter;
-          }
-        }
-        if (map_iter->second.empty()) {
-          map_iter = _waiting_sockets.erase(map_iter);
-        } else {
-          ++map_iter;
-        }
-      }
+void MasterDaemon::CloseSocket(SocketPoller* poller, SocketType socket) {
+  // No reply may go to the socket, or to the next one of the same fd, once
+  // it is closed. A reply already on its way is waited for.
+  RemoveWaitingSocket(socket);
+  poller->Remove(socket);
+  std::shared_ptr<Waiter> waiter;
+  {
+    std::lock_guard<std::mutex> lock(_sockets_mutex);
+    _sockets.erase(socket);
+    auto it = _waiters.find(socket);
+    if (it != _waiters.end()) {
+      waiter = std::move(it->second);
+      _waiters.erase(it);
+    }
+  }
+  if (waiter) {
+    std::lock_guard<std::mutex> lock(waiter->mutex);
+    waiter->closed = true;
+  }
+  tcputils::close_socket(socket);
+}
 
-      tcputils::close_socket(fds[i].fd);
-      fds.erase(fds.begin() + i);
-#ifdef _WIN32
-      _sockets.erase(_sockets.begin() + i - 1);
-#else
-      _sockets.erase(_sockets.begin() + i - 2);
-#endif
+void MasterDaemon::ProcessCommand(SocketPoller* poller, SocketType socket) {
+  try {
+    VLOG(4) << "Plan to receive command from " << GetSockName(socket);
+    Command command = tcputils::receive_value<Command>(socket);
+    VLOG(3) << "TCPStore: recv command: " << static_cast<int>(command) << ".";
 
-      VLOG(5) << "Meet some exceptions during run:" << ex.what();
+    switch (command) {
+      case Command::ADD:
+        _do_add(socket);
+        break;
+      case Command::GET:
+        _do_get(socket);
+        break;
+      case Command::SET:
+        _do_set(socket);
+        break;
+      case Command::WAIT:
+        _do_wait(socket);
+        break;
+      case Command::MULTI_GET:
+        _do_multi_get(socket);
+        break;
+      case Command::MULTI_SET:
+        _do_multi_set(socket);
+        break;
+      case Command::MULTI_WAIT:
+        _do_multi_wait(socket);
+        break;
+      default:
+        VLOG(4) << "Unknown command: " << static_cast<int>(command)
+                << " from addr info:" << GetSockName(socket);
     }
+  } catch (const std::exception& ex) {
+    CloseSocket(poller, socket);
+    VLOG(5) << "Meet some exceptions during run:" << ex.what();
   }
 }
 
-void MasterDaemon::run() {
-  std::vector<struct pollfd> fds;
-#ifdef _WIN32
-  fds.push_back({_listen_socket, POLLIN});
-#else
-  fds.push_back({.fd = _listen_socket, .events = POLLIN, .revents = 0});
-  fds.push_back(
-      {.fd = _control_fd[0], .events = POLLIN | POLLHUP, .revents = 0});
-#endif
+void MasterDaemon::Accept() {
+  SocketType socket;
+  try {
+    socket = tcputils::tcp_accept(_listen_socket);
+  } catch (const std::exception& ex) {
+    VLOG(0) << "Meet some exceptions during accept:" << ex.what();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_sockets_mutex);
+    _sockets.insert(socket);
+  }
+  // The connections go round the threads.
+  _pollers[_next_poller++ % _pollers.size()]->Add(socket);
+}
 
+void MasterDaemon::run(size_t thread_index) {
+  SocketPoller* poller = _pollers[thread_index].get();
   bool finished = false;
   while (!finished) {
-    for (size_t i = 0; i < fds.size(); i++) {
-      fds[i].revents = 0;
-    }
-
-    VLOG(9) << "begin to poll fds_size:"
-            << paddle::string::Sprintf("%d", fds.size());
+    VLOG(9) << "begin to poll in thread " << thread_index;
+    std::vector<SocketType> ready = poller->Wait(INFTIME);
 #ifdef _WIN32
-    int res = ::WSAPoll(fds.data(), fds.size(), INFTIME);
-    if (res == 0) {
-      auto rv = WaitForSingleObject(ghStopEvent_, 0);
-      if (rv != WAIT_TIMEOUT) {
-        finished = true;
-        break;
-      }
-      continue;
-    }
-#else
-    ::poll(fds.data(), fds.size(), INFTIME);
-
-    VLOG(9) << "begin to fds[1].revents:"
-            << paddle::string::Sprintf("%d", fds[1].revents);
-    // The control pipe receive shutdown event, and begin to close it.
-    if (fds[1].revents != 0) {
-      if (fds[1].revents & ~(POLLIN | POLLHUP)) {
-        PADDLE_THROW(
-            phi::errors::Fatal("Undefined event type:%d", fds[1].revents));
-      }
-      VLOG(0)
-          << "receive shutdown event and so quit from MasterDaemon run loop";
+    auto rv = WaitForSingleObject(ghStopEvent_, 0);
+    if (rv != WAIT_TIMEOUT) {
       finished = true;
       break;
     }
 #endif
-
-    // accept connect request.
-    if (fds[0].revents != 0) {
-      auto socket = tcputils::tcp_accept(_listen_socket);
-      _sockets.emplace_back(socket);
-#ifdef _WIN32
-      fds.push_back({socket, POLLIN});
-#else
-      fds.push_back({.fd = socket, .events = POLLIN, .revents = 0});
+    for (SocketType socket : ready) {
+#ifndef _WIN32
+      // The control pipe receive shutdown event, and begin to close it.
+      if (socket == _control_fd[0]) {
+        VLOG(0)
+            << "receive shutdown event and so quit from MasterDaemon run loop";
+        finished = true;
+        break;
+      }
 #endif
+      if (socket == _listen_socket) {
+        Accept();
+      } else {
+        ProcessCommand(poller, socket);
+      }
     }
-
-    ProcessCommands(&fds);
   }
 }
 
@@ -316,6 +529,14 @@ void TCPClient::send_command_for_key(Command type, const std::string& key) {
   tcputils::send_string(_socket, key);
 }
 
+void TCPClient::send_buffer(const std::vector<char>& buffer) {
+  tcputils::send_bytes<char>(_socket, buffer.data(), buffer.size());
+}
+
+bool TCPClient::wait_for_reply(std::chrono::seconds timeout) {
+  return tcputils::wait_readable(_socket, timeout);
+}
+
 template <typename T>
 void TCPClient::send_value(const T& value) {
   tcputils::send_bytes<T>(_socket, &value, 1);
@@ -345,7 +566,11 @@ TCPStore::TCPStore(std::string host,
                    bool is_master,
                    size_t num_workers,
                    int timeout)
-    : Store(timeout), _is_master(is_master), _num_workers(num_workers) {
+    : Store(timeout),
+      _host(host),
+      _port(port),
+      _is_master(is_master),
+      _num_workers(num_workers) {
   _timeout = timeout;
   PADDLE_ENFORCE_GT(
       timeout, 0, phi::errors::InvalidArgument("timeout must >= %d", timeout));
@@ -363,37 +588,15 @@ void TCPStore::waitWorkers() {
   if (_num_workers == 0) {
     return;
   }
-  add(_init_key, 1);
+  // The last worker to come marks the end, which the master waits for on
+  // the server.
+  if (add(_init_key, 1) == _num_workers) {
+    set(_init_done_key, {1});
+  }
 
   if (_is_master) {
     VLOG(3) << paddle::string::Sprintf("_timeout:%d", _timeout);
-    auto begin = std::chrono::steady_clock::now();
-    do {
-      auto value = get(_init_key);
-      int completed = std::stoi(std::string(value.begin(), value.end()));
-      VLOG(3) << completed << " worker ready, total " << _num_workers
-              << ", _timeout:" << _timeout;
-      if (completed >= _num_workers) {
-        break;
-      }
-      const auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-          std::chrono::steady_clock::now() - begin);
-
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      if (_timeout != 0 && elapsed.count() > _timeout) {
-        LOG(FATAL) << paddle::string::Sprintf(
-            "_timeout:%d elapsed:%d (elapsed > _timeout)=%d",
-            _timeout,
-            elapsed.count(),
-            elapsed.count() > _timeout);
-
-        PADDLE_ENFORCE_EQ(
-            completed,
-            _num_workers,
-            phi::errors::InvalidArgument(
-                "TCPStore timeouted and not all workers got ready."));
-      }
-    } while (true);
+    wait(_init_done_key);
   }
   VLOG(3) << "TCPStore initialized.";
 }
@@ -418,10 +621,34 @@ std::vector<uint8_t> TCPStore::get(const std::string& key) {
   return _client->receive_vector<uint8_t>();
 }
 
-void TCPStore::wait(const std::string& key) {
+void TCPStore::wait(const std::string& key) { multi_wait({key}); }
+
+void TCPStore::multi_wait(const std::vector<std::string>& keys) {
   ReplyType reply;
   VLOG(3) << "TCPStore wait.";
-  _client->send_command_for_key(Command::WAIT, _key_prefix + key);
+  if (keys.size() == 1) {
+    _client->send_command_for_key(Command::WAIT, _key_prefix + keys[0]);
+  } else {
+    std::vector<char> buffer;
+    tcputils::append_value<Command>(&buffer, Command::MULTI_WAIT);
+    tcputils::append_value<size_t>(&buffer, keys.size());
+    for (const auto& key : keys) {
+      tcputils::append_string(&buffer, _key_prefix + key);
+    }
+    _client->send_buffer(buffer);
+  }
+  if (!_client->wait_for_reply(std::chrono::seconds(_timeout))) {
+    // The master still holds the wait, and would answer it in the middle of
+    // the next command, so the connection starts over. The master drops the
+    // wait as the old one closes.
+    _client = detail::TCPClient::connect(_host, _port);
+    PADDLE_THROW(phi::errors::Unavailable(
+        "TCPStore timed out after %d seconds waiting for %d keys, the "
+        "first of them %s.",
+        _timeout,
+        keys.size(),
+        keys.empty() ? "" : keys[0]));
+  }
   reply = _client->receive_value<ReplyType>();
   PADDLE_ENFORCE_EQ(
       reply == ReplyType::STOP_WAIT,
@@ -429,6 +656,48 @@ void TCPStore::wait(const std::string& key) {
       phi::errors::InvalidArgument("Stop_waiting response is expected"));
 }
 
+std::vector<std::vector<uint8_t>> TCPStore::multi_get(
+    const std::vector<std::string>& keys) {
+  if (keys.empty()) {
+    return {};
+  }
+  multi_wait(keys);
+  std::vector<char> buffer;
+  tcputils::append_value<Command>(&buffer, Command::MULTI_GET);
+  tcputils::append_value<size_t>(&buffer, keys.size());
+  for (const auto& key : keys) {
+    tcputils::append_string(&buffer, _key_prefix + key);
+  }
+  _client->send_buffer(buffer);
+  VLOG(3) << "TCPStore multi_get.";
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    values.push_back(_client->receive_vector<uint8_t>());
+  }
+  return values;
+}
+
+void TCPStore::multi_set(const std::vector<std::string>& keys,
+                         const std::vector<std::vector<uint8_t>>& values) {
+  PADDLE_ENFORCE_EQ(keys.size(),
+                    values.size(),
+                    phi::errors::InvalidArgument(
+                        "The numbers of keys and values must be the same, but "
+                        "got %d keys and %d values.",
+                        keys.size(),
+                        values.size()));
+  VLOG(3) << "TCPStore multi_set.";
+  std::vector<char> buffer;
+  tcputils::append_value<Command>(&buffer, Command::MULTI_SET);
+  tcputils::append_value<size_t>(&buffer, keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    tcputils::append_string(&buffer, _key_prefix + keys[i]);
+    tcputils::append_vector<uint8_t>(&buffer, values[i]);
+  }
+  _client->send_buffer(buffer);
+}
+
 TCPStore::~TCPStore() { VLOG(3) << "TCPStore destructure"; }
 
 }  // namespace distributed
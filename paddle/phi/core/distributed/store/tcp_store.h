@@ -24,11 +24,16 @@
 #endif
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "paddle/phi/core/distributed/store/socket.h"
 #include "paddle/phi/core/distributed/store/store.h"
@@ -38,10 +43,60 @@ namespace phi {
 namespace distributed {
 
 enum class ReplyType { WAITING, STOP_WAIT };
-enum class Command { ADD, GET, SET, WAIT, STOP };
+// MULTI_* are the batched commands: a count, then the keys, and for MULTI_SET
+// the values of the keys.
+enum class Command {
+  ADD,
+  GET,
+  SET,
+  WAIT,
+  STOP,
+  MULTI_GET,
+  MULTI_SET,
+  MULTI_WAIT
+};
 
 namespace detail {
 
+// A WAIT or MULTI_WAIT of a socket, answered when the last of its keys is
+// set. The reply goes under mutex, and not once the socket is closed.
+struct Waiter {
+  SocketType socket;
+  std::atomic<int> remaining;
+  std::mutex mutex;
+  bool closed = false;
+};
+
+// A part of the key space, with the waits for its keys.
+struct StoreShard {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::vector<uint8_t>> store;
+  std::unordered_map<std::string, std::vector<std::shared_ptr<Waiter>>>
+      waiting;
+};
+
+// The sockets a thread of MasterDaemon serves, watched by epoll on Linux,
+// where Add may be called from any thread, and by poll elsewhere.
+class SocketPoller {
+ public:
+  SocketPoller();
+  ~SocketPoller();
+  void Add(SocketType socket);
+  void Remove(SocketType socket);
+  // The sockets readable, or closed, within timeout_ms.
+  std::vector<SocketType> Wait(int timeout_ms);
+
+ private:
+#ifdef __linux__
+  int _epoll_fd{-1};
+#else
+  std::vector<struct pollfd> _fds;
+#endif
+};
+
+// Serves the clients from a few threads, each watching its share of the
+// connections, over a key space in shards of their own locks. The first
+// thread accepts the connections too. Without epoll there is one thread.
 class MasterDaemon {
  public:
   static std::unique_ptr<MasterDaemon> start(SocketType listen_socket,
@@ -54,21 +109,37 @@ class MasterDaemon {
   ~MasterDaemon();
 
  private:
-  void run();
-  void ProcessCommands(std::vector<struct pollfd>* p_fds);
+  void run(size_t thread_index);
+  void Accept();
+  void ProcessCommand(SocketPoller* poller, SocketType socket);
+  void CloseSocket(SocketPoller* poller, SocketType socket);
   void _do_add(SocketType socket);
   void _do_wait(SocketType socket);
   void _do_get(SocketType socket);
   void _do_set(SocketType socket);
-  void _notify_waiting_sockets(const std::string&);
+  void _do_multi_get(SocketType socket);
+  void _do_multi_set(SocketType socket);
+  void _do_multi_wait(SocketType socket);
+  StoreShard& GetShard(const std::string& key);
+  void SetValue(const std::string& key, std::vector<uint8_t> value);
+  void WaitForKeys(SocketType socket, const std::vector<std::string>& keys);
+  // Called with the lock of shard, returns the waiters to reply to once the
+  // lock is released.
+  std::vector<std::shared_ptr<Waiter>> _notify_waiting_sockets(
+      StoreShard* shard, const std::string& key);
+  void ReplyStopWait(const std::shared_ptr<Waiter>& waiter);
+  void RemoveWaitingSocket(SocketType socket);
   SocketType _listen_socket;
-  std::vector<SocketType> _sockets;
-  std::unordered_map<std::string, std::vector<uint8_t>> _store;
-  std::thread _background_thread{};
+  std::mutex _sockets_mutex;
+  std::unordered_set<SocketType> _sockets;
+  // The last wait of every socket, guarded by _sockets_mutex.
+  std::unordered_map<SocketType, std::shared_ptr<Waiter>> _waiters;
+  std::vector<StoreShard> _shards;
+  std::vector<std::unique_ptr<SocketPoller>> _pollers;
+  std::atomic<size_t> _next_poller{0};
+  std::vector<std::thread> _background_threads;
   int _nranks = -1;
   int _timeout = 0;
-  std::unordered_map<std::string, std::vector<SocketType>>
-      _waiting_sockets;  // key -> list of waiting sockets
 
   void InitControlFd();
   void CloseControlFd();
@@ -98,6 +169,10 @@ class TCPClient {
                                             uint16_t port);
   ~TCPClient() { tcputils::close_socket(_socket); }
   void send_command_for_key(Command type, const std::string& key);
+  // Sends a message put together by the tcputils::append_* functions.
+  void send_buffer(const std::vector<char>& buffer);
+  // Whether the reply comes within timeout.
+  bool wait_for_reply(std::chrono::seconds timeout);
 
   template <typename T>
   void send_value(const T& value);
@@ -132,13 +207,23 @@ class TCPStore : public Store {
   std::vector<uint8_t> get(const std::string& key) override;
   void wait(const std::string& key) override;
   void set(const std::string& key, const std::vector<uint8_t>& value) override;
+  // One message to the master for all the keys, multi_get waiting for them
+  // and then getting them in two round trips.
+  std::vector<std::vector<uint8_t>> multi_get(
+      const std::vector<std::string>& keys) override;
+  void multi_set(const std::vector<std::string>& keys,
+                 const std::vector<std::vector<uint8_t>>& values) override;
+  void multi_wait(const std::vector<std::string>& keys);
 
  private:
   void waitWorkers();
+  std::string _host;
+  uint16_t _port;
   std::unique_ptr<detail::TCPServer> _server;
   std::unique_ptr<detail::TCPClient> _client;
 
   const std::string _init_key = "init/";
+  const std::string _init_done_key = "init/done";
   const std::string _key_prefix = "/";
 
   bool _is_master;
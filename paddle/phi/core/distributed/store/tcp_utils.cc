@@ -223,6 +223,33 @@ std::string receive_string(SocketType socket) {
   return std::string(v.data(), v.size());
 }
 
+bool wait_readable(SocketType socket, std::chrono::seconds timeout) {
+  ::pollfd fd{};
+  fd.fd = socket;
+  fd.events = POLLIN;
+  const int timeout_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count();
+  int res;
+  do {
+#ifdef _WIN32
+    res = ::WSAPoll(&fd, 1, timeout_ms);
+#else
+    res = ::poll(&fd, 1, timeout_ms);
+#endif
+  } while (res < 0 && errno == EINTR);
+  PADDLE_ENFORCE_GE(
+      res,
+      0,
+      phi::errors::InvalidArgument("TCP poll error. Details: %s.",
+                                   socket_error().message()));
+  return res > 0;
+}
+
+void append_string(std::vector<char>* buffer, const std::string& s) {
+  append_value<std::string::size_type>(buffer, s.size());
+  buffer->insert(buffer->end(), s.begin(), s.end());
+}
+
 }  // namespace tcputils
 }  // namespace distributed
 }  // namespace phi
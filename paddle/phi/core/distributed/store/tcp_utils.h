@@ -29,6 +29,7 @@
 
 #include <chrono>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "paddle/phi/core/enforce.h"
@@ -69,6 +70,9 @@ SocketType tcp_accept(SocketType socket);
 void send_string(SocketType socket, const std::string& s);
 std::string receive_string(SocketType socket);
 
+// Whether socket is readable, or closed, within timeout.
+bool wait_readable(SocketType socket, std::chrono::seconds timeout);
+
 template <typename T>
 void send_bytes(SocketType socket, const T* buffer, size_t len) {
   size_t to_send = len * sizeof(T);
@@ -139,6 +143,23 @@ T receive_value(SocketType socket) {
   return v;
 }
 
+// Append to buffer what send_value, send_string and send_vector send, for a
+// message of many parts to go in one send.
+template <typename T>
+void append_value(std::vector<char>* buffer, const T& v) {
+  auto ptr = reinterpret_cast<const char*>(&v);
+  buffer->insert(buffer->end(), ptr, ptr + sizeof(T));
+}
+
+void append_string(std::vector<char>* buffer, const std::string& s);
+
+template <typename T>
+void append_vector(std::vector<char>* buffer, const std::vector<T>& v) {
+  append_value<size_t>(buffer, v.size());
+  auto ptr = reinterpret_cast<const char*>(v.data());
+  buffer->insert(buffer->end(), ptr, ptr + v.size() * sizeof(T));
+}
+
 }  // namespace tcputils
 }  // namespace distributed
 }  // namespace phi
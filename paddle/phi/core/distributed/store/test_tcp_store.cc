@@ -12,12 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "paddle/phi/core/distributed/store/tcp_store.h"
 #include "paddle/phi/core/distributed/store/tcp_utils.h"
 
 #ifdef _WIN32
 #include <windows.h>
+#else
+#include <arpa/inet.h>
 #endif
 
 namespace phi {
@@ -37,6 +44,92 @@ TEST(MasterDaemon, init) {
   d.reset();
 }
 
+uint16_t FreePort() {
+  SocketType socket = tcputils::tcp_listen("", "0", AF_INET);
+  ::sockaddr_in addr{};
+  ::socklen_t len = sizeof(addr);
+  ::getsockname(socket, reinterpret_cast<::sockaddr*>(&addr), &len);
+  tcputils::close_socket(socket);
+  return ntohs(addr.sin_port);
+}
+
+std::vector<uint8_t> ToBytes(const std::string& s) {
+  return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+TEST(TCPStore, batched_commands) {
+  uint16_t port = FreePort();
+  auto server = detail::TCPServer::create(port, 2, 30);
+  TCPStore store("127.0.0.1", port, false, 0, 30);
+  TCPStore other("127.0.0.1", port, false, 0, 30);
+
+  store.multi_set({"a", "b", "c"}, {ToBytes("1"), ToBytes("22"), ToBytes("")});
+  std::vector<std::vector<uint8_t>> expected = {
+      ToBytes(""), ToBytes("1"), ToBytes("22")};
+  EXPECT_EQ(other.multi_get({"c", "a", "b"}), expected);
+  EXPECT_EQ(store.add("n", 3), 3);
+  EXPECT_EQ(other.add("n", 4), 7);
+  EXPECT_EQ(store.get("n"), ToBytes("7"));
+
+  // The waits return once the last of their keys is set.
+  std::thread setter([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    store.set("x", ToBytes("x"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    store.multi_set({"y", "z"}, {ToBytes("y"), ToBytes("z")});
+  });
+  expected = {ToBytes("1"), ToBytes("x"), ToBytes("z")};
+  EXPECT_EQ(other.multi_get({"a", "x", "z"}), expected);
+  setter.join();
+}
+
+// A wait that timed out is not answered on the next command.
+TEST(TCPStore, timed_out_wait) {
+  uint16_t port = FreePort();
+  auto server = detail::TCPServer::create(port, 2, 30);
+  TCPStore store("127.0.0.1", port, false, 0, 1);
+  TCPStore other("127.0.0.1", port, false, 0, 30);
+
+  EXPECT_ANY_THROW(store.wait("late"));
+  other.set("late", ToBytes("late"));
+  EXPECT_EQ(store.add("n", 2), 2);
+  EXPECT_EQ(store.get("late"), ToBytes("late"));
+}
+
+// A rendezvous of a few ranks: each sets its address, passes a barrier, and
+// gets the addresses of all the ranks by get and by multi_get.
+TEST(TCPStore, rendezvous) {
+  const int num_ranks = 8;
+  uint16_t port = FreePort();
+  auto server = detail::TCPServer::create(port, num_ranks, 30);
+  auto addr = [](int rank) {
+    return ToBytes("127.0.0.1:" + std::to_string(10000 + rank));
+  };
+  std::vector<std::thread> ranks;
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    ranks.emplace_back([&, rank]() {
+      TCPStore store("127.0.0.1", port, false, num_ranks, 30);
+      store.set("addr/" + std::to_string(rank), addr(rank));
+      if (store.add("connect", 1) == num_ranks) {
+        store.set("connect/done", {1});
+      }
+      store.wait("connect/done");
+
+      std::vector<std::string> keys;
+      std::vector<std::vector<uint8_t>> expected;
+      for (int i = 0; i < num_ranks; ++i) {
+        keys.push_back("addr/" + std::to_string((rank + i) % num_ranks));
+        expected.push_back(addr((rank + i) % num_ranks));
+        EXPECT_EQ(store.get(keys.back()), expected.back());
+      }
+      EXPECT_EQ(store.multi_get(keys), expected);
+    });
+  }
+  for (auto& rank : ranks) {
+    rank.join();
+  }
+}
+
 /* now for only c compile test
 TEST(TCPStore, init) {
   TCPStore store("127.0.0.1", 6170, true, 1);
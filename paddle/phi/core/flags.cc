@@ -681,6 +681,21 @@ PHI_DEFINE_EXPORTED_bool(
  */
 PHI_DEFINE_EXPORTED_bool(use_mkldnn, false, "Use MKLDNN to run");
 
+/**
+ * MKLDNN related FLAG
+ * Name: onednn_blob_cache_capacity
+ * Since Version:
+ * Value Range: int64, default=65536
+ * Example:
+ * Note: The most oneDNN primitives, memories and descriptors cached by the
+ * OneDNNContext. Past it, the objects of the least recently used ops are
+ * evicted, those of an op all together. 0 for no limit.
+ */
+PHI_DEFINE_EXPORTED_int64(onednn_blob_cache_capacity,
+                          65536,
+                          "The most objects in the oneDNN cache, 0 for no "
+                          "limit.");
+
 /**
  * Debug related FLAG
  * Name: FLAGS_call_stack_level
@@ -1256,3 +1271,86 @@ PHI_DEFINE_EXPORTED_bool(use_shm_cache,
 PHI_DEFINE_EXPORTED_string(tensor_operants_mode,
                            "eager",
                            "Tensor operants mode");
+
+/**
+ * fusion_group related FLAG
+ * Name: fusion_group_cpu_compiler
+ * Since Version: 2.5.0
+ * Value Range: string, default=c++
+ * Example: FLAGS_fusion_group_cpu_compiler=clang++
+ * Note: The host compiler building the code generated by fusion_group_pass
+ * for CPU. The pass leaves the graph unchanged when it cannot be run.
+ */
+PHI_DEFINE_EXPORTED_string(fusion_group_cpu_compiler,
+                           "c++",
+                           "The compiler of the fusion_group CPU kernels.");
+
+/**
+ * fusion_group related FLAG
+ * Name: fusion_group_cpu_cache_dir
+ * Since Version: 2.5.0
+ * Value Range: string, default=""
+ * Example: FLAGS_fusion_group_cpu_cache_dir="./fusion_group_cache"
+ * Note: Where the compiled fusion_group CPU kernels are cached, so that the
+ * same code is only compiled once. Empty means paddle_fusion_group_<uid> in
+ * $TMPDIR, or /tmp, which must have the mode 0700. The directory must be
+ * owned by the current user and not be writable by the others.
+ */
+PHI_DEFINE_EXPORTED_string(fusion_group_cpu_cache_dir,
+                           "",
+                           "The cache directory of the fusion_group CPU "
+                           "kernels.");
+
+/**
+ * Tensor related FLAG
+ * Name: use_stride_kernel
+ * Since Version: 2.5.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_use_stride_kernel=true
+ * Note: Experimental. If True, the API functions of transpose, slice,
+ * strided_slice, expand, split and unsqueeze on CPU dispatch to their
+ * `<kernel>_strided` kernels, which return strided views sharing the memory
+ * of their input instead of copies. The views are made contiguous only
+ * before the kernels which do not read strided inputs, and the kernels
+ * calling these kernels directly still get copies. Only for the dynamic
+ * graph, the static graph executors expect contiguous tensors. The inplace
+ * ops write to the memory shared by a contiguous view, and give a
+ * non-contiguous view a memory of its own.
+ */
+PHI_DEFINE_EXPORTED_bool(use_stride_kernel,
+                         false,
+                         "Make the view kernels on CPU return strided views.");
+
+/**
+ * Conv related FLAG
+ * Name: cpu_conv_algo
+ * Since Version: 2.5.0
+ * Value Range: string, default="auto"
+ * Example: FLAGS_cpu_conv_algo="im2col"
+ * Note: The algorithm of conv2d and depthwise_conv2d on CPU without oneDNN.
+ * "auto" picks the direct kernels for depthwise and 1x1 convolutions,
+ * Winograd F(4,3) for the 3x3 ones of stride 1 with enough pixels, and
+ * im2col and GEMM for the others.
+ * "im2col" always uses im2col and GEMM. "direct_1x1", "depthwise",
+ * "winograd_f23" and "winograd_f43" force one algorithm where it applies.
+ */
+PHI_DEFINE_EXPORTED_string(cpu_conv_algo,
+                           "auto",
+                           "The algorithm of conv2d on CPU.");
+
+/**
+ * Fleet executor related FLAG
+ * Name: fleet_executor_shm_ring_bytes
+ * Since Version: 2.5.0
+ * Value Range: int64, default=1048576
+ * Example: FLAGS_fleet_executor_shm_ring_bytes=0
+ * Note: The size in bytes of the rings in shared memory the message bus of
+ * the fleet executor sends the messages through between the ranks on one
+ * host, instead of brpc. Rounded up to a power of two, and each rank has a
+ * ring for every other rank on its host. Messages larger than a ring go
+ * through in parts. 0 sends all the messages by brpc. Only on Linux.
+ */
+PHI_DEFINE_EXPORTED_int64(
+    fleet_executor_shm_ring_bytes,
+    1 << 20,
+    "The size of the shared memory rings of the fleet executor, 0 for none.");
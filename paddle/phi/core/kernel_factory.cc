@@ -31,6 +31,7 @@
 DECLARE_int32(low_precision_op_list);
 DECLARE_bool(enable_api_kernel_fallback);
 DECLARE_bool(run_kp_kernel);
+DECLARE_bool(use_stride_kernel);
 namespace phi {
 
 const static Kernel empty_kernel;  // NOLINT
@@ -280,6 +281,46 @@ KernelResult KernelFactory::SelectKernelOrThrowError(
   return {kernel_iter->second, false};
 }
 
+const std::string& KernelSelectCache::SelectKernelName(
+    const KernelKey& kernel_key) const {
+  if (FLAGS_use_stride_kernel && kernel_key.backend() == Backend::CPU &&
+      KernelFactory::Instance()
+          .SelectKernel(strided_kernel_name_, kernel_key)
+          .IsValid()) {
+    return strided_kernel_name_;
+  }
+  return kernel_name_;
+}
+
+KernelResult KernelSelectCache::SelectKernelOrThrowError(
+    const KernelKey& kernel_key) {
+  auto& factory = KernelFactory::Instance();
+#if defined(PADDLE_WITH_XPU_KP)
+  // The selection also depends on FLAGS_run_kp_kernel, which may be changed
+  // between calls, so it is not cached.
+  return factory.SelectKernelOrThrowError(SelectKernelName(kernel_key),
+                                          kernel_key);
+#else
+  uint64_t generation = factory.kernels_generation();
+  if (kernel_ != nullptr && kernel_key_ == kernel_key &&
+      generation_ == generation &&
+      enable_fallback_ == FLAGS_enable_api_kernel_fallback &&
+      use_stride_kernel_ == FLAGS_use_stride_kernel) {
+    return {*kernel_, has_fallback_cpu_};
+  }
+
+  auto kernel_result = factory.SelectKernelOrThrowError(
+      SelectKernelName(kernel_key), kernel_key);
+  kernel_key_ = kernel_key;
+  kernel_ = &kernel_result.kernel;
+  has_fallback_cpu_ = kernel_result.has_fallback_cpu;
+  enable_fallback_ = FLAGS_enable_api_kernel_fallback;
+  use_stride_kernel_ = FLAGS_use_stride_kernel;
+  generation_ = generation;
+  return kernel_result;
+#endif
+}
+
 const KernelArgsDef& KernelFactory::GetFirstKernelArgsDef(
     const std::string& kernel_name) const {
   auto iter = kernels_.find(kernel_name);
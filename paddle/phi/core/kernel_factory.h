@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <ostream>
 #include <string>
@@ -126,6 +127,9 @@ struct TensorArgDef {
   DataLayout layout;
   DataType dtype;
   std::type_index type_index;
+  // Whether the kernel reads the input through its strides, so that a
+  // strided view is not made contiguous before the kernel runs.
+  bool support_strided{false};
 
   TensorArgDef(Backend in_backend,
                DataLayout in_layout,
@@ -150,6 +154,11 @@ struct TensorArgDef {
     dtype = in_dtype;
     return *this;
   }
+
+  TensorArgDef& SetSupportStrided(bool in_support_strided) {
+    support_strided = in_support_strided;
+    return *this;
+  }
 };
 
 // Align the original fluid Attribute type with lower overhead
@@ -315,7 +324,17 @@ class KernelFactory {
  public:
   static KernelFactory& Instance();
 
-  KernelNameMap& kernels() { return kernels_; }
+  // NOTE: the registered kernels may be changed through the returned
+  // reference, so every access bumps the generation observed by
+  // KernelSelectCache.
+  KernelNameMap& kernels() {
+    kernels_generation_.fetch_add(1, std::memory_order_relaxed);
+    return kernels_;
+  }
+
+  uint64_t kernels_generation() const {
+    return kernels_generation_.load(std::memory_order_relaxed);
+  }
 
   bool HasCompatiblePhiKernel(const std::string& op_type) const;
 
@@ -347,10 +366,49 @@ class KernelFactory {
 
   KernelNameMap kernels_;
 
+  std::atomic<uint64_t> kernels_generation_{0};
+
   // Get the low precision kernel list of current module.
   std::map<const std::string, OpCount> low_precision_kernels_;
 };
 
+/**
+ * KernelSelectCache is an inline cache for the kernel selected at one call
+ * site. The generated API functions keep a thread_local instance for each
+ * kernel they dispatch to, so consecutive calls with the same KernelKey
+ * reuse the resolved Kernel instead of hashing the kernel name into the
+ * KernelNameMap and the key into the KernelKeyMap again.
+ *
+ * A different KernelKey, a change of FLAGS_enable_api_kernel_fallback or
+ * FLAGS_use_stride_kernel or a change of the registered kernels goes through
+ * KernelFactory::SelectKernelOrThrowError and refills the cache.
+ *
+ * With FLAGS_use_stride_kernel, the kernel `<kernel_name>_strided` is
+ * selected instead on CPU if it is registered. These kernels return strided
+ * views, and are only reached from the API functions, the kernels calling
+ * one another directly get contiguous outputs.
+ */
+class KernelSelectCache {
+ public:
+  explicit KernelSelectCache(const char* kernel_name)
+      : kernel_name_(kernel_name),
+        strided_kernel_name_(std::string(kernel_name) + "_strided") {}
+
+  KernelResult SelectKernelOrThrowError(const KernelKey& kernel_key);
+
+ private:
+  const std::string& SelectKernelName(const KernelKey& kernel_key) const;
+
+  std::string kernel_name_;
+  std::string strided_kernel_name_;
+  KernelKey kernel_key_;
+  const Kernel* kernel_{nullptr};
+  bool has_fallback_cpu_{false};
+  bool enable_fallback_{false};
+  bool use_stride_kernel_{false};
+  uint64_t generation_{0};
+};
+
 inline std::ostream& operator<<(std::ostream& os, const KernelKey& kernel_key) {
   os << "(" << kernel_key.backend() << ", " << kernel_key.layout() << ", "
      << kernel_key.dtype() << ")";
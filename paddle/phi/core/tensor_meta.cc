@@ -45,9 +45,33 @@ bool DenseTensorMeta::valid() const noexcept {
   valid = valid && (dtype != DataType::UNDEFINED);
   valid = valid && (layout != DataLayout::UNDEFINED);
   valid = valid && (is_scalar || product(dims) >= 0);
+  valid = valid && (strides.empty() ||
+                    strides.size() == static_cast<size_t>(dims.size()));
   return valid;
 }
 
+bool DenseTensorMeta::is_contiguous() const noexcept { return strides.empty(); }
+
+int64_t DenseTensorMeta::storage_numel() const noexcept {
+  int64_t numel = product(dims);
+  if (strides.empty() || numel <= 0) {
+    return numel;
+  }
+  int64_t last = 0;
+  for (int i = 0; i < dims.size(); ++i) {
+    last += (dims[i] - 1) * strides[i];
+  }
+  return last + 1;
+}
+
+std::vector<int64_t> DenseTensorMeta::calc_strides(const DDim& dims) {
+  std::vector<int64_t> strides(dims.size(), 1);
+  for (int i = dims.size() - 2; i >= 0; --i) {
+    strides[i] = strides[i + 1] * dims[i + 1];
+  }
+  return strides;
+}
+
 StringTensorMeta::StringTensorMeta(const DDim& dims) : dims(dims) {}
 
 bool StringTensorMeta::valid() const noexcept {
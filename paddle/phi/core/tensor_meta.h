@@ -62,6 +62,18 @@ struct DenseTensorMeta {
   /// \return Whether the metadata is valid.
   bool valid() const noexcept;
 
+  /// \brief Test whether the elements are laid out row-major without gaps,
+  /// which is the case when strides is empty.
+  bool is_contiguous() const noexcept;
+
+  /// \brief The number of elements the memory spans from the offset, which
+  /// is larger than the number of elements for views with gaps, and smaller
+  /// for the broadcast ones.
+  int64_t storage_numel() const noexcept;
+
+  /// \brief The row-major strides of dims, in elements.
+  static std::vector<int64_t> calc_strides(const DDim& dims);
+
   bool is_scalar{false};
   /// \brief Determine whether using gpudnn speed-up library in the new dygraph.
   /// It maybe also support MKLDNN library in the near future.
@@ -71,13 +83,18 @@ struct DenseTensorMeta {
   DataLayout layout{DataLayout::NCHW};
   LoD lod;
   size_t offset{0};
+  /// \brief The distance in elements between the neighbours of each dim, for
+  /// the tensors which are strided views of the memory of another one, as
+  /// transpose, slice and expand return with FLAGS_use_stride_kernel. Empty
+  /// for the row-major tensors, which are all the others.
+  std::vector<int64_t> strides;
 };
 
 inline bool operator==(const DenseTensorMeta& lhs, const DenseTensorMeta& rhs) {
   return (lhs.is_scalar == rhs.is_scalar) && lhs.use_gpudnn == rhs.use_gpudnn &&
          (lhs.dims == rhs.dims) && (lhs.dtype == rhs.dtype) &&
          (lhs.layout == rhs.layout) && (lhs.lod == rhs.lod) &&
-         (lhs.offset == rhs.offset);
+         (lhs.offset == rhs.offset) && (lhs.strides == rhs.strides);
 }
 
 struct StringTensorMeta {
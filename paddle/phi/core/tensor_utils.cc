@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/phi/core/tensor_utils.h"
 
+#include <cstring>
+
 #include "glog/logging.h"
 
 #include "paddle/phi/backends/context_pool.h"
@@ -25,6 +27,44 @@ limitations under the License. */
 
 namespace phi {
 
+void StridedCopyToContiguous(const DenseTensor& src, void* dst) {
+  const int64_t numel = src.numel();
+  const size_t size = SizeOf(src.dtype());
+  const auto* in = static_cast<const uint8_t*>(src.data());
+  auto* out = static_cast<uint8_t*>(dst);
+  if (src.is_contiguous()) {
+    std::memcpy(out, in, numel * size);
+    return;
+  }
+  if (numel == 0) {
+    return;
+  }
+  std::vector<int64_t> dims = vectorize(src.dims());
+  const std::vector<int64_t>& strides = src.strides();
+  // The innermost dims laid out row-major are copied as a single run.
+  int64_t run = 1;
+  int rank = static_cast<int>(dims.size());
+  while (rank > 0 && (dims[rank - 1] == 1 || strides[rank - 1] == run)) {
+    run *= dims[rank - 1];
+    --rank;
+  }
+  const size_t run_bytes = run * size;
+  std::vector<int64_t> index(rank, 0);
+  int64_t offset = 0;
+  for (int64_t copied = 0; copied < numel; copied += run) {
+    std::memcpy(out, in + offset * size, run_bytes);
+    out += run_bytes;
+    for (int i = rank - 1; i >= 0; --i) {
+      offset += strides[i];
+      if (++index[i] < dims[i]) {
+        break;
+      }
+      offset -= strides[i] * dims[i];
+      index[i] = 0;
+    }
+  }
+}
+
 template <typename Context>
 void Copy(const Context& dev_ctx,
           const DenseTensor& src,
@@ -50,6 +90,21 @@ void Copy(const Context& dev_ctx,
   VLOG(3) << "TensorCopy " << src.dims() << " from " << src.place() << " to "
           << dst_place;
 
+  if (!src.is_contiguous()) {
+    PADDLE_ENFORCE_EQ(
+        src_place.GetType(),
+        AllocationType::CPU,
+        errors::Unimplemented("Only the strided tensors on CPU can be copied, "
+                              "but the tensor is on %s.",
+                              src_place));
+    DenseTensor contiguous;
+    contiguous.Resize(src.dims());
+    contiguous.set_layout(src.layout());
+    StridedCopyToContiguous(src, dev_ctx.HostAlloc(&contiguous, src.dtype()));
+    Copy(dev_ctx, contiguous, dst_place, blocking, dst);
+    return;
+  }
+
   dst->Resize(src.dims());
 
   void* dst_ptr = nullptr;
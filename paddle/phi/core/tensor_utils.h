@@ -82,6 +82,10 @@ class DenseTensorUtils {
   }
 };
 
+// Gathers the elements of the tensor on CPU src, which may be a strided
+// view, row-major into the memory dst of src.numel() elements.
+void StridedCopyToContiguous(const DenseTensor& src, void* dst);
+
 template <typename Context>
 void Copy(const Context& dev_ctx,
           const DenseTensor& src,
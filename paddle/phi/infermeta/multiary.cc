@@ -3106,6 +3106,76 @@ void WarprnntInferMeta(const MetaTensor& input,
   loss->set_dtype(input.dtype());
 }
 
+void WeightOnlyLinearInferMeta(const MetaTensor& x,
+                               const MetaTensor& weight,
+                               const MetaTensor& bias,
+                               const MetaTensor& weight_scale,
+                               const std::string& weight_dtype,
+                               int group_size,
+                               MetaTensor* out) {
+  PADDLE_ENFORCE_EQ(
+      weight_dtype == "int8" || weight_dtype == "int4",
+      true,
+      errors::InvalidArgument(
+          "The weight_dtype of weight_only_linear should be int8 or int4, "
+          "but received %s.",
+          weight_dtype));
+  auto x_dims = x.dims();
+  auto w_dims = weight.dims();
+  PADDLE_ENFORCE_EQ(
+      w_dims.size(),
+      2,
+      errors::InvalidArgument(
+          "The weight of weight_only_linear should be a 2-D [n, k] tensor "
+          "(k / 2 for int4), but received a %d-D tensor.",
+          w_dims.size()));
+  const int64_t n = w_dims[0];
+  const int64_t k = weight_dtype == "int4" ? w_dims[1] * 2 : w_dims[1];
+  PADDLE_ENFORCE_EQ(
+      x_dims[x_dims.size() - 1],
+      k,
+      errors::InvalidArgument(
+          "The last dim of x (%d) should be equal to the input size of the "
+          "weight (%d).",
+          x_dims[x_dims.size() - 1],
+          k));
+  auto scale_dims = weight_scale.dims();
+  if (group_size > 0) {
+    PADDLE_ENFORCE_EQ(
+        scale_dims.size() == 2 && scale_dims[0] * group_size == k &&
+            scale_dims[1] == n,
+        true,
+        errors::InvalidArgument(
+            "The weight_scale should be [%d, %d] with group_size %d, but "
+            "received [%s].",
+            k / group_size,
+            n,
+            group_size,
+            scale_dims));
+  } else {
+    PADDLE_ENFORCE_EQ(
+        scale_dims.size() == 1 && scale_dims[0] == n,
+        true,
+        errors::InvalidArgument(
+            "The weight_scale should be [%d], but received [%s].",
+            n,
+            scale_dims));
+  }
+  if (bias) {
+    PADDLE_ENFORCE_EQ(bias.numel(),
+                      n,
+                      errors::InvalidArgument(
+                          "The size of bias (%d) should be equal to the "
+                          "output size of the weight (%d).",
+                          bias.numel(),
+                          n));
+  }
+  auto out_dims = x_dims;
+  out_dims[out_dims.size() - 1] = n;
+  out->set_dims(out_dims);
+  out->set_dtype(x.dtype());
+}
+
 void WhereInferMeta(const MetaTensor& condition,
                     const MetaTensor& x,
                     const MetaTensor& y,
@@ -4913,6 +4913,53 @@ void UnStackInferMeta(const MetaTensor& x,
   }
 }
 
+void WeightQuantizeInferMeta(const MetaTensor& x,
+                             const std::string& algo,
+                             int group_size,
+                             MetaTensor* out,
+                             MetaTensor* scale) {
+  PADDLE_ENFORCE_EQ(
+      algo == "weight_only_int8" || algo == "weight_only_int4",
+      true,
+      phi::errors::InvalidArgument(
+          "The algo of weight_quantize should be weight_only_int8 or "
+          "weight_only_int4, but received %s.",
+          algo));
+  auto x_dims = x.dims();
+  PADDLE_ENFORCE_EQ(
+      x_dims.size(),
+      2,
+      phi::errors::InvalidArgument(
+          "The x of weight_quantize should be a 2-D [k, n] weight, but "
+          "received a %d-D tensor.",
+          x_dims.size()));
+  const int64_t k = x_dims[0];
+  const int64_t n = x_dims[1];
+  const bool int4 = algo == "weight_only_int4";
+  PADDLE_ENFORCE_EQ(int4 && k % 2 != 0,
+                    false,
+                    phi::errors::InvalidArgument(
+                        "The first dim of the weight should be even for "
+                        "weight_only_int4, but received %d.",
+                        k));
+  if (group_size > 0) {
+    PADDLE_ENFORCE_EQ(
+        k % group_size,
+        0,
+        phi::errors::InvalidArgument(
+            "The first dim of the weight (%d) should be divisible by "
+            "group_size (%d).",
+            k,
+            group_size));
+    scale->set_dims(phi::make_ddim({k / group_size, n}));
+  } else {
+    scale->set_dims(phi::make_ddim({n}));
+  }
+  scale->set_dtype(phi::DataType::FLOAT32);
+  out->set_dims(phi::make_ddim({n, int4 ? k / 2 : k}));
+  out->set_dtype(phi::DataType::INT8);
+}
+
 void ChannelShuffleInferMeta(const MetaTensor& x,
                              int groups,
                              const std::string& data_format,
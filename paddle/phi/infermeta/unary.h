@@ -702,4 +702,10 @@ void UnStackInferMeta(const MetaTensor& x,
                       int num,
                       std::vector<MetaTensor*> outs);
 
+void WeightQuantizeInferMeta(const MetaTensor& x,
+                             const std::string& algo,
+                             int group_size,
+                             MetaTensor* out,
+                             MetaTensor* scale);
+
 }  // namespace phi
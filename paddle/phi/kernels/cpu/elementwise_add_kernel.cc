@@ -19,6 +19,7 @@
 #include "paddle/phi/common/complex.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/cpu/elementwise.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 #include "paddle/phi/kernels/impl/elementwise_kernel_impl.h"
 
 namespace phi {
@@ -29,6 +30,11 @@ void AddFunctor(const Context& dev_ctx,
                 const DenseTensor& y,
                 int axis,
                 DenseTensor* out) {
+  if (!x.is_contiguous() || !y.is_contiguous()) {
+    funcs::StridedElementwiseCompute<funcs::AddFunctor<T>, T>(
+        dev_ctx, x, y, funcs::AddFunctor<T>(), out);
+    return;
+  }
   dev_ctx.template Alloc<T>(out);
   if (x.dims() == y.dims()) {
     SameDimsElementwiseCompute<SameDimsAddFunctor<CPUContext, T>>()(
@@ -80,7 +86,10 @@ PD_REGISTER_KERNEL(add,
                    int,
                    int64_t,
                    complex64,
-                   complex128) {}
+                   complex128) {
+  kernel->InputAt(0).SetSupportStrided(true);
+  kernel->InputAt(1).SetSupportStrided(true);
+}
 
 PD_REGISTER_KERNEL(grad_add,
                    CPU,
@@ -18,6 +18,7 @@
 #include "paddle/phi/common/complex.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/cpu/elementwise.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 #include "paddle/phi/kernels/impl/elementwise_kernel_impl.h"
 
 namespace phi {
@@ -27,6 +28,11 @@ void DivideKernel(const Context& dev_ctx,
                   const DenseTensor& x,
                   const DenseTensor& y,
                   DenseTensor* out) {
+  if (!x.is_contiguous() || !y.is_contiguous()) {
+    funcs::StridedElementwiseCompute<funcs::DivideFunctor<T>, T>(
+        dev_ctx, x, y, funcs::DivideFunctor<T>(), out);
+    return;
+  }
   // allocate memory for out
   dev_ctx.template Alloc<T>(out);
   if (x.dims() == y.dims() && std::is_floating_point<T>::value) {
@@ -62,4 +68,7 @@ PD_REGISTER_KERNEL(divide,
                    int,
                    int64_t,
                    complex64,
-                   complex128) {}
+                   complex128) {
+  kernel->InputAt(0).SetSupportStrided(true);
+  kernel->InputAt(1).SetSupportStrided(true);
+}
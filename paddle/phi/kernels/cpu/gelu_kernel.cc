@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include "glog/logging.h"
 
@@ -25,6 +26,7 @@
 #include "paddle/phi/kernels/funcs/blas/blas_impl.h"
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
+#include "paddle/phi/kernels/funcs/jit/kernels.h"
 
 namespace phi {
 
@@ -93,6 +95,25 @@ void GeluKernel(const Context& dev_ctx,
                 bool approximate,
                 DenseTensor* out) {
   dev_ctx.template Alloc<T>(out);
+  const int64_t numel = x.numel();
+  if (numel <= std::numeric_limits<int>::max()) {
+    const int n = static_cast<int>(numel);
+    const T* x_data = x.data<T>();
+    T* out_data = out->data<T>();
+    if (approximate) {
+      auto compute = phi::jit::KernelFuncs<phi::jit::VGeluTanhTuple<T>,
+                                           phi::CPUPlace>::Cache()
+                         .At(n);
+      compute(x_data, out_data, n);
+    } else {
+      auto compute = phi::jit::KernelFuncs<phi::jit::VGeluErfTuple<T>,
+                                           phi::CPUPlace>::Cache()
+                         .At(n);
+      compute(x_data, out_data, n);
+    }
+    return;
+  }
+
   auto eigen_out = EigenVector<T>::Flatten(*out);
   auto eigen_x = EigenVector<T>::Flatten(x);
   auto& dev = *dev_ctx.eigen_device();
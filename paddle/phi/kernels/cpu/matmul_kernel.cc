@@ -17,16 +17,87 @@ limitations under the License. */
 #include "paddle/phi/backends/cpu/cpu_context.h"
 #include "paddle/phi/common/complex.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/cast_kernel.h"
+#include "paddle/phi/kernels/funcs/jit/kernels.h"
 #include "paddle/phi/kernels/impl/matmul_kernel_impl.h"
 
+namespace phi {
+
+// There is no bfloat16 gemm on CPU. A few rows against a plain 2-D weight
+// go through the jit bfloat16 GEMV, which reads the weight as it is stored;
+// everything else is computed in float.
+template <>
+struct MatMulDispatcher<phi::CPUContext, phi::dtype::bfloat16> {
+  void operator()(const phi::CPUContext& ctx,
+                  const DenseTensor& x,
+                  const DenseTensor& y,
+                  const std::vector<std::int64_t>& x_dims,
+                  const std::vector<std::int64_t>& y_dims,
+                  DenseTensor* out,
+                  bool trans_x,
+                  bool trans_y,
+                  bool flag = false) {
+    using bf16 = phi::dtype::bfloat16;
+    constexpr int64_t kMaxGemvRows = 8;
+    const int x_ndim = x_dims.size();
+    const int y_ndim = y_dims.size();
+    if (!trans_x && !trans_y && !flag && x_ndim >= 1 && y_ndim == 2 &&
+        x_dims.back() == y_dims[0] && x.numel() / y_dims[0] <= kMaxGemvRows) {
+      const int k = y_dims[0];
+      const int n = y_dims[1];
+      const int64_t rows = x.numel() / k;
+      std::vector<std::int64_t> out_dims(x_dims.begin(), x_dims.end() - 1);
+      out_dims.push_back(n);
+      out->ResizeAndAllocate(phi::make_ddim(out_dims));
+      bf16* out_data = ctx.template Alloc<bf16>(out);
+      const bf16* x_data = x.data<bf16>();
+      const uint16_t* y_data =
+          reinterpret_cast<const uint16_t*>(y.data<bf16>());
+
+      const phi::jit::matmul_attr_t attr{1, n, k};
+      auto gemv =
+          phi::jit::KernelFuncs<phi::jit::MatMulBF16Tuple<float>,
+                                phi::CPUPlace>::Cache()
+              .At(attr);
+      std::vector<float> x_row(k), out_row(n);
+      for (int64_t i = 0; i < rows; ++i) {
+        for (int j = 0; j < k; ++j) {
+          x_row[j] = static_cast<float>(x_data[i * k + j]);
+        }
+        gemv(x_row.data(), y_data, out_row.data(), &attr);
+        for (int j = 0; j < n; ++j) {
+          out_data[i * n + j] = static_cast<bf16>(out_row[j]);
+        }
+      }
+      return;
+    }
+
+    DenseTensor x_fp32 = phi::Cast<bf16>(ctx, x, phi::DataType::FLOAT32);
+    DenseTensor y_fp32 = phi::Cast<bf16>(ctx, y, phi::DataType::FLOAT32);
+    DenseTensor out_fp32;
+    if (flag) {
+      out_fp32 = phi::Cast<bf16>(ctx, *out, phi::DataType::FLOAT32);
+    }
+    MatMulFunction<phi::CPUContext, float>(
+        ctx, x_fp32, y_fp32, x_dims, y_dims, &out_fp32, trans_x, trans_y, flag);
+    phi::CastKernel<float>(ctx, out_fp32, phi::DataType::BFLOAT16, out);
+  }
+};
+
+}  // namespace phi
+
 PD_REGISTER_KERNEL(matmul,
                    CPU,
                    ALL_LAYOUT,
                    phi::MatmulKernel,
                    float,
                    double,
+                   phi::dtype::bfloat16,
                    phi::dtype::complex<float>,
-                   phi::dtype::complex<double>) {}
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetSupportStrided(true);
+  kernel->InputAt(1).SetSupportStrided(true);
+}
 
 PD_REGISTER_KERNEL(matmul_with_flatten,
                    CPU,
@@ -18,6 +18,7 @@
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/cpu/reduce.h"
 #include "paddle/phi/kernels/funcs/reduce_functor.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 
 namespace phi {
 
@@ -30,6 +31,22 @@ void MeanRawKernel(const Context& dev_ctx,
                    DenseTensor* out) {
   reduce_all = recompute_reduce_all(x, dims, reduce_all);
   auto out_dtype = x.dtype();
+  if (!x.is_contiguous()) {
+    if (!std::is_same<T, bool>::value) {
+      funcs::StridedReduceSum<T>(
+          dev_ctx, x, dims.GetData(), reduce_all, true, out);
+      return;
+    }
+    phi::Reduce<CPUContext, T, phi::funcs::MeanFunctor>(
+        dev_ctx,
+        funcs::Contiguous(dev_ctx, x),
+        reduce_all,
+        dims.GetData(),
+        keep_dim,
+        out_dtype,
+        out);
+    return;
+  }
   phi::Reduce<CPUContext, T, phi::funcs::MeanFunctor>(
       dev_ctx, x, reduce_all, dims.GetData(), keep_dim, out_dtype, out);
 }
@@ -44,4 +61,6 @@ PD_REGISTER_KERNEL(mean_raw,
                    double,
                    bool,
                    phi::dtype::complex<float>,
-                   phi::dtype::complex<double>) {}
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
@@ -18,6 +18,7 @@
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/cpu/reduce.h"
 #include "paddle/phi/kernels/funcs/reduce_functor.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 
 namespace phi {
 
@@ -32,6 +33,24 @@ void SumRawKernel(const Context& dev_ctx,
   if (out_dtype == DataType::UNDEFINED && out->dtype() != x.dtype()) {
     out_dtype = out->dtype();
   }
+  if (!x.is_contiguous()) {
+    if (!std::is_same<T, bool>::value &&
+        (out_dtype == DataType::UNDEFINED || out_dtype == x.dtype())) {
+      reduce_all = recompute_reduce_all(x, dims, reduce_all);
+      funcs::StridedReduceSum<T>(
+          dev_ctx, x, dims.GetData(), reduce_all, false, out);
+      return;
+    }
+    phi::Reduce<CPUContext, T, phi::funcs::SumFunctor>(
+        dev_ctx,
+        funcs::Contiguous(dev_ctx, x),
+        reduce_all,
+        dims.GetData(),
+        keep_dim,
+        out_dtype,
+        out);
+    return;
+  }
   phi::Reduce<CPUContext, T, phi::funcs::SumFunctor>(
       dev_ctx, x, reduce_all, dims.GetData(), keep_dim, out_dtype, out);
 }
@@ -54,5 +73,6 @@ PD_REGISTER_KERNEL(sum_raw,
                    int64_t,
                    complex64,
                    complex128) {
+  kernel->InputAt(0).SetSupportStrided(true);
   kernel->OutputAt(0).SetDataType(phi::DataType::UNDEFINED);
 }
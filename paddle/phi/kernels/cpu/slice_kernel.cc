@@ -30,7 +30,9 @@ PD_REGISTER_KERNEL(slice,
                    double,
                    phi::dtype::complex<float>,
                    phi::dtype::complex<double>,
-                   phi::dtype::bfloat16) {}
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
 
 PD_REGISTER_KERNEL(slice_array,
                    CPU,
@@ -30,7 +30,9 @@ PD_REGISTER_KERNEL(split,
                    uint8_t,
                    int8_t,
                    phi::dtype::float16,
-                   phi::dtype::bfloat16) {}
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
 
 PD_REGISTER_KERNEL(split_with_num,
                    CPU,
@@ -44,4 +46,6 @@ PD_REGISTER_KERNEL(split_with_num,
                    uint8_t,
                    int8_t,
                    phi::dtype::float16,
-                   phi::dtype::bfloat16) {}
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
@@ -30,7 +30,9 @@ PD_REGISTER_KERNEL(strided_slice_raw,
                    double,
                    phi::dtype::bfloat16,
                    phi::dtype::complex<float>,
-                   phi::dtype::complex<double>) {}
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
 
 PD_REGISTER_KERNEL(strided_slice_array,
                    CPU,
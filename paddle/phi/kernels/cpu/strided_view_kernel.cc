@@ -0,0 +1,350 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/strided_view_kernel.h"
+
+#include <algorithm>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/expand_kernel.h"
+#include "paddle/phi/kernels/funcs/slice_utils.h"
+#include "paddle/phi/kernels/funcs/strided_slice.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
+#include "paddle/phi/kernels/funcs/unsqueeze.h"
+#include "paddle/phi/kernels/slice_kernel.h"
+#include "paddle/phi/kernels/split_kernel.h"
+#include "paddle/phi/kernels/strided_slice_kernel.h"
+#include "paddle/phi/kernels/transpose_kernel.h"
+#include "paddle/phi/kernels/unsqueeze_kernel.h"
+
+namespace phi {
+
+template <typename T, typename Context>
+void TransposeStridedKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            const std::vector<int>& axis,
+                            DenseTensor* out) {
+  if (!funcs::UseStridedView(x)) {
+    TransposeKernel<T, Context>(dev_ctx, x, axis, out);
+    return;
+  }
+  // out is x with its strides permuted.
+  int rank = static_cast<int>(axis.size());
+  std::vector<int64_t> x_strides = funcs::GetStrides(x);
+  std::vector<int64_t> strides(rank);
+  for (int i = 0; i < rank; ++i) {
+    strides[i] = x_strides[axis[i] < 0 ? axis[i] + rank : axis[i]];
+  }
+  funcs::MakeStridedView(x, out->dims(), strides, 0, out);
+}
+
+template <typename T, typename Context>
+void SliceStridedKernel(const Context& dev_ctx,
+                        const DenseTensor& input,
+                        const std::vector<int64_t>& axes,
+                        const IntArray& starts_arr,
+                        const IntArray& ends_arr,
+                        const std::vector<int64_t>& infer_flags,
+                        const std::vector<int64_t>& decrease_axis,
+                        DenseTensor* out) {
+  if (!funcs::UseStridedView(input)) {
+    SliceKernel<T, Context>(dev_ctx,
+                            input,
+                            axes,
+                            starts_arr,
+                            ends_arr,
+                            infer_flags,
+                            decrease_axis,
+                            out);
+    return;
+  }
+  std::vector<int64_t> starts = starts_arr.GetData();
+  std::vector<int64_t> ends = ends_arr.GetData();
+  auto in_dims = input.dims();
+  for (size_t i = 0; i < axes.size(); ++i) {
+    if (starts[i] == -1 && ends[i] == 0 && infer_flags[i] == -1) {
+      auto ret = std::find(decrease_axis.begin(), decrease_axis.end(), axes[i]);
+      if (ret != decrease_axis.end()) {
+        ends[i] = in_dims[axes[i]];
+      }
+    }
+  }
+  funcs::UpdateSliceAttrs<int64_t>(in_dims, axes, &starts, &ends);
+  auto slice_dims = funcs::GetSliceDims<int64_t>(
+      in_dims, axes, starts, ends, nullptr, nullptr);
+  auto out_dims = funcs::GetDecreasedDims<int64_t>(slice_dims, decrease_axis);
+
+  std::vector<int64_t> in_strides = funcs::GetStrides(input);
+  int64_t offset = 0;
+  for (size_t i = 0; i < axes.size(); ++i) {
+    offset += starts[i] * in_strides[axes[i]];
+  }
+  std::vector<int64_t> strides;
+  for (int i = 0; i < slice_dims.size(); ++i) {
+    if (std::find(decrease_axis.begin(), decrease_axis.end(), i) ==
+        decrease_axis.end()) {
+      strides.push_back(in_strides[i]);
+    }
+  }
+  // The slices decreased to 0-D are 1-D with FLAGS_set_to_1d.
+  strides.resize(out_dims.size(), 1);
+  funcs::MakeStridedView(input, out_dims, strides, offset, out);
+}
+
+template <typename T, typename Context>
+void StridedSliceStridedKernel(const Context& dev_ctx,
+                               const DenseTensor& x,
+                               const std::vector<int>& axes,
+                               const IntArray& starts,
+                               const IntArray& ends,
+                               const IntArray& strides,
+                               DenseTensor* out) {
+  std::vector<int> infer_flags(axes.size(), 1);
+  std::vector<int> decrease_axis;
+  if (funcs::UseStridedView(x) &&
+      funcs::StridedSliceView(
+          x, axes, starts, ends, strides, infer_flags, decrease_axis, out)) {
+    return;
+  }
+  StridedSliceKernel<T, Context>(dev_ctx, x, axes, starts, ends, strides, out);
+}
+
+template <typename T, typename Context>
+void ExpandStridedKernel(const Context& dev_ctx,
+                         const DenseTensor& x,
+                         const IntArray& shape,
+                         DenseTensor* out) {
+  if (!funcs::UseStridedView(x)) {
+    ExpandKernel<T, Context>(dev_ctx, x, shape, out);
+    return;
+  }
+  // The expanded dims have a stride of 0.
+  auto expand_shape = shape.GetData();
+  const int rank = static_cast<int>(expand_shape.size());
+  const int diff = rank - x.dims().size();
+  std::vector<int64_t> x_strides = funcs::GetStrides(x);
+  std::vector<int64_t> dims(rank);
+  std::vector<int64_t> strides(rank, 0);
+  for (int i = 0; i < rank; ++i) {
+    PADDLE_ENFORCE_NE(
+        expand_shape[i],
+        0,
+        phi::errors::InvalidArgument("The expanded size cannot be zero."));
+    if (i < diff) {
+      PADDLE_ENFORCE_GT(
+          expand_shape[i],
+          0,
+          phi::errors::InvalidArgument(
+              "The expanded size (%d) for non-existing dimensions must be "
+              "positive for expand_v2 op.",
+              expand_shape[i]));
+      dims[i] = expand_shape[i];
+      continue;
+    }
+    const int64_t in_dim = x.dims()[i - diff];
+    dims[i] = expand_shape[i] == -1 ? in_dim : expand_shape[i];
+    PADDLE_ENFORCE_EQ(
+        in_dim == 1 || in_dim == dims[i],
+        true,
+        phi::errors::InvalidArgument(
+            "The value (%d) of the non-singleton dimension does not match"
+            " the corresponding value (%d) in shape for expand_v2 op.",
+            in_dim,
+            expand_shape[i]));
+    if (in_dim == dims[i]) {
+      strides[i] = x_strides[i - diff];
+    }
+  }
+  funcs::MakeStridedView(x, make_ddim(dims), strides, 0, out);
+}
+
+template <typename T, typename Context>
+void SplitStridedKernel(const Context& dev_ctx,
+                        const DenseTensor& x,
+                        const IntArray& sections,
+                        const Scalar& axis_scalar,
+                        std::vector<DenseTensor*> outs) {
+  if (!funcs::UseStridedView(x)) {
+    SplitKernel<T, Context>(dev_ctx, x, sections, axis_scalar, outs);
+    return;
+  }
+  // The outs are views of x, one after the other along axis.
+  int axis = axis_scalar.to<int>();
+  axis = axis < 0 ? axis + x.dims().size() : axis;
+  std::vector<int64_t> strides = funcs::GetStrides(x);
+  int64_t offset = 0;
+  for (auto* out : outs) {
+    if (out == nullptr) {
+      continue;
+    }
+    funcs::MakeStridedView(x, out->dims(), strides, offset, out);
+    offset += out->dims()[axis] * strides[axis];
+  }
+}
+
+template <typename T, typename Context>
+void SplitWithNumStridedKernel(const Context& dev_ctx,
+                               const DenseTensor& x,
+                               int num,
+                               const Scalar& axis_scalar,
+                               std::vector<DenseTensor*> outs) {
+  int axis_value = axis_scalar.to<int>();
+  auto input_axis_dim = x.dims().at(axis_value);
+  std::vector<int64_t> sections_vec(num, input_axis_dim / num);
+  IntArray sections(sections_vec);
+  SplitStridedKernel<T, Context>(dev_ctx, x, sections, axis_scalar, outs);
+}
+
+template <typename T, typename Context>
+void UnsqueezeStridedKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            const IntArray& axes,
+                            DenseTensor* out,
+                            DenseTensor* xshape) {
+  if (!funcs::UseStridedView(x)) {
+    UnsqueezeKernel<T, Context>(dev_ctx, x, axes, out, xshape);
+    return;
+  }
+  auto x_dims = x.dims();
+  auto out_dims = out->dims();
+  if (axes.FromTensor()) {
+    out_dims = funcs::GetUnsqueezeShape(axes.GetData(), x_dims);
+  }
+  // The dims of x keep their strides, those of the dims of 1 do not matter.
+  std::vector<int64_t> x_strides = funcs::GetStrides(x);
+  std::vector<int64_t> strides(out_dims.size(), 1);
+  int j = 0;
+  for (int i = 0; i < out_dims.size(); ++i) {
+    if (out_dims[i] == 1) {
+      continue;
+    }
+    while (x_dims[j] == 1) {
+      ++j;
+    }
+    strides[i] = x_strides[j++];
+  }
+  funcs::MakeStridedView(x, out_dims, strides, 0, out);
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(transpose_strided,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::TransposeStridedKernel,
+                   bool,
+                   float,
+                   double,
+                   int32_t,
+                   int64_t,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16,
+                   phi::dtype::complex<float>,
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
+
+PD_REGISTER_KERNEL(slice_strided,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::SliceStridedKernel,
+                   bool,
+                   uint8_t,
+                   int,
+                   int64_t,
+                   float,
+                   double,
+                   phi::dtype::complex<float>,
+                   phi::dtype::complex<double>,
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
+
+PD_REGISTER_KERNEL(strided_slice_strided,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::StridedSliceStridedKernel,
+                   bool,
+                   int,
+                   int64_t,
+                   float,
+                   double,
+                   phi::dtype::bfloat16,
+                   phi::dtype::complex<float>,
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
+
+PD_REGISTER_KERNEL(expand_strided,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::ExpandStridedKernel,
+                   float,
+                   double,
+                   int,
+                   int64_t,
+                   bool) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
+
+PD_REGISTER_KERNEL(split_strided,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::SplitStridedKernel,
+                   float,
+                   double,
+                   int64_t,
+                   int,
+                   bool,
+                   uint8_t,
+                   int8_t,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
+
+PD_REGISTER_KERNEL(split_with_num_strided,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::SplitWithNumStridedKernel,
+                   float,
+                   double,
+                   int64_t,
+                   int,
+                   bool,
+                   uint8_t,
+                   int8_t,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
+
+PD_REGISTER_KERNEL(unsqueeze_strided,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::UnsqueezeStridedKernel,
+                   float,
+                   double,
+                   phi::dtype::bfloat16,
+                   bool,
+                   int,
+                   int16_t,
+                   uint8_t,
+                   int8_t,
+                   int64_t,
+                   phi::dtype::complex<float>,
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
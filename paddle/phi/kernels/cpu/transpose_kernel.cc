@@ -20,6 +20,7 @@
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 
 namespace phi {
 
@@ -36,43 +37,44 @@ void TransposeKernel(const Context& ctx,
     }
   }
 
+  int rank = formated_axis.size();
+  const DenseTensor x_in = funcs::Contiguous(ctx, x);
   ctx.template Alloc<T>(out);
   if (out->numel() == 0) {
     return;
   }
-  int rank = formated_axis.size();
   switch (rank) {
     case 0:
-      phi::Copy<Context>(ctx, x, ctx.GetPlace(), false, out);
+      phi::Copy<Context>(ctx, x_in, ctx.GetPlace(), false, out);
       break;
     case 1:
       funcs::Transpose<Context, T, 1> trans1;
-      trans1(ctx, x, out, formated_axis);
+      trans1(ctx, x_in, out, formated_axis);
       break;
     case 2:
       funcs::Transpose<Context, T, 2> trans2;
-      trans2(ctx, x, out, formated_axis);
+      trans2(ctx, x_in, out, formated_axis);
       break;
     case 3:
       funcs::Transpose<Context, T, 3> trans3;
-      trans3(ctx, x, out, formated_axis);
+      trans3(ctx, x_in, out, formated_axis);
       break;
     case 4:
       funcs::Transpose<Context, T, 4> trans4;
-      trans4(ctx, x, out, formated_axis);
+      trans4(ctx, x_in, out, formated_axis);
       break;
     case 5:
       funcs::Transpose<Context, T, 5> trans5;
-      trans5(ctx, x, out, formated_axis);
+      trans5(ctx, x_in, out, formated_axis);
       break;
     case 6:
       funcs::Transpose<Context, T, 6> trans6;
-      trans6(ctx, x, out, formated_axis);
+      trans6(ctx, x_in, out, formated_axis);
       break;
     default:
       // for rank >= 7 situation
       funcs::TransposeNormal<Context, T> trans_normal;
-      trans_normal(ctx, x, out, formated_axis);
+      trans_normal(ctx, x_in, out, formated_axis);
   }
 }
 
@@ -90,4 +92,6 @@ PD_REGISTER_KERNEL(transpose,
                    phi::dtype::float16,
                    phi::dtype::bfloat16,
                    phi::dtype::complex<float>,
-                   phi::dtype::complex<double>) {}
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
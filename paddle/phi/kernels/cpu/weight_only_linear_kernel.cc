@@ -0,0 +1,60 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/weight_only_linear_kernel.h"
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/weight_only_gemm.h"
+
+namespace phi {
+
+template <typename T, typename Context>
+void WeightOnlyLinearKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            const DenseTensor& weight,
+                            const paddle::optional<DenseTensor>& bias,
+                            const DenseTensor& weight_scale,
+                            const std::string& weight_dtype,
+                            int group_size,
+                            DenseTensor* out) {
+  const int bits = weight_dtype == "int4" ? 4 : 8;
+  const auto x_dims = x.dims();
+  const int k = x_dims[x_dims.size() - 1];
+  const int m = x.numel() / k;
+  const int n = weight.dims()[0];
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  funcs::WeightOnlyGemm(dev_ctx,
+                        x.data<T>(),
+                        m,
+                        k,
+                        n,
+                        weight.data<int8_t>(),
+                        weight_scale.data<float>(),
+                        bias ? bias->data<T>() : nullptr,
+                        bits,
+                        group_size,
+                        out_data);
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(weight_only_linear,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::WeightOnlyLinearKernel,
+                   float) {
+  kernel->InputAt(1).SetDataType(phi::DataType::INT8);
+  kernel->InputAt(3).SetDataType(phi::DataType::FLOAT32);
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/kernels/weight_quantize_kernel.h"
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/weight_only_gemm.h"
+
+namespace phi {
+
+template <typename T, typename Context>
+void WeightQuantizeKernel(const Context& dev_ctx,
+                          const DenseTensor& x,
+                          const std::string& algo,
+                          int group_size,
+                          DenseTensor* out,
+                          DenseTensor* scale) {
+  const int bits = algo == "weight_only_int4" ? 4 : 8;
+  const int k = x.dims()[0];
+  const int n = x.dims()[1];
+  funcs::WeightOnlyQuantize(x.data<T>(),
+                            k,
+                            n,
+                            bits,
+                            group_size,
+                            dev_ctx.template Alloc<int8_t>(out),
+                            dev_ctx.template Alloc<float>(scale));
+}
+
+}  // namespace phi
+
+PD_REGISTER_KERNEL(
+    weight_quantize, CPU, ALL_LAYOUT, phi::WeightQuantizeKernel, float) {
+  kernel->OutputAt(0).SetDataType(phi::DataType::INT8);
+  kernel->OutputAt(1).SetDataType(phi::DataType::FLOAT32);
+}
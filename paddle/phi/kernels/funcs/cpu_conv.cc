@@ -0,0 +1,533 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/cpu_conv.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/flags.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+PHI_DECLARE_string(cpu_conv_algo);
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// The output channels and pixels kDirect1x1 accumulates at a time.
+constexpr int64_t kOcBlock = 8;
+constexpr int64_t kPixelTile = 64;
+// The largest output planes of stride 1 worth kDirect1x1 rather than a GEMM.
+constexpr int64_t kDirect1x1MaxPlane = 1024;
+// The fewest channels for which the GEMMs of Winograd outweigh its
+// transforms, and the fewest 4x4 tiles of the batch over which the transform
+// of the filter and the GEMMs as wide as the tiles pay off.
+constexpr int64_t kWinogradMinChannels = 8;
+constexpr int64_t kWinogradMinTiles = 48;
+// The bytes of the transformed tiles Winograd keeps at a time.
+constexpr int64_t kWinogradBufferBytes = 32 << 20;
+// The fewest multiply-adds worth a thread of their own.
+constexpr int64_t kMinWorkPerThread = 256 * 1024;
+
+constexpr CPUConvAlgo kAllAlgos[] = {CPUConvAlgo::kIm2ColGemm,
+                                     CPUConvAlgo::kDirect1x1,
+                                     CPUConvAlgo::kDepthwise,
+                                     CPUConvAlgo::kWinogradF23,
+                                     CPUConvAlgo::kWinogradF43};
+
+int ConvThreads(int64_t work) {
+#ifdef _OPENMP
+  return static_cast<int>(std::max<int64_t>(
+      1,
+      std::min<int64_t>(omp_get_max_threads(), work / kMinWorkPerThread)));
+#else
+  return 1;
+#endif
+}
+
+template <typename T>
+void DepthwiseConv(const CPUConv2DShape& s,
+                   const T* input,
+                   const T* filter,
+                   T* output) {
+  const int64_t multiplier = s.out_channels / s.in_channels;
+  const int64_t in_plane = s.in_h * s.in_w;
+  const int64_t out_plane = s.out_h * s.out_w;
+  const int64_t num_planes = s.batch_size * s.out_channels;
+  const int ksize = s.kernel_h * s.kernel_w;
+  // The output columns reading inside the input rows, for each column of the
+  // filter, so that the inner loops need no bounds checks.
+  std::vector<int64_t> ow_begin(s.kernel_w);
+  std::vector<int64_t> ow_end(s.kernel_w);
+  for (int kw = 0; kw < s.kernel_w; ++kw) {
+    const int64_t offset = kw * s.dilation_w - s.pad_left;
+    ow_begin[kw] = offset >= 0 ? 0 : (-offset + s.stride_w - 1) / s.stride_w;
+    ow_end[kw] = s.in_w - 1 - offset >= 0
+                     ? std::min(s.out_w, (s.in_w - 1 - offset) / s.stride_w + 1)
+                     : 0;
+    ow_begin[kw] = std::min(ow_begin[kw], ow_end[kw]);
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads( \
+    ConvThreads(num_planes * out_plane * ksize))
+#endif
+  for (int64_t plane = 0; plane < num_planes; ++plane) {
+    const int64_t n = plane / s.out_channels;
+    const int64_t oc = plane % s.out_channels;
+    const T* in = input + (n * s.in_channels + oc / multiplier) * in_plane;
+    const T* weights = filter + oc * ksize;
+    T* out = output + plane * out_plane;
+    std::fill(out, out + out_plane, static_cast<T>(0));
+    for (int64_t oh = 0; oh < s.out_h; ++oh) {
+      T* out_row = out + oh * s.out_w;
+      for (int kh = 0; kh < s.kernel_h; ++kh) {
+        const int64_t ih = oh * s.stride_h + kh * s.dilation_h - s.pad_top;
+        if (ih < 0 || ih >= s.in_h) {
+          continue;
+        }
+        const T* in_row = in + ih * s.in_w;
+        for (int kw = 0; kw < s.kernel_w; ++kw) {
+          const T weight = weights[kh * s.kernel_w + kw];
+          const int64_t offset = kw * s.dilation_w - s.pad_left;
+          if (s.stride_w == 1) {
+            for (int64_t ow = ow_begin[kw]; ow < ow_end[kw]; ++ow) {
+              out_row[ow] += weight * in_row[ow + offset];
+            }
+          } else {
+            for (int64_t ow = ow_begin[kw]; ow < ow_end[kw]; ++ow) {
+              out_row[ow] += weight * in_row[ow * s.stride_w + offset];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void Direct1x1Conv(const CPUContext& dev_ctx,
+                   const CPUConv2DShape& s,
+                   const T* input,
+                   const T* filter,
+                   T* output) {
+  const int64_t ic = s.in_channels;
+  const int64_t oc = s.out_channels;
+  const int64_t plane = s.out_h * s.out_w;
+  const T* in = input;
+  // The pixels of a stride > 1 are gathered first, into a quarter of the
+  // input for a stride of 2 rather than the columns of im2col.
+  DenseTensor gathered;
+  if (s.stride_h != 1 || s.stride_w != 1) {
+    gathered.Resize({s.batch_size, ic, plane});
+    T* gathered_data = dev_ctx.template Alloc<T>(&gathered);
+    const int64_t num_planes = s.batch_size * ic;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(ConvThreads(num_planes * plane))
+#endif
+    for (int64_t i = 0; i < num_planes; ++i) {
+      const T* src = input + i * s.in_h * s.in_w;
+      T* dst = gathered_data + i * plane;
+      for (int64_t oh = 0; oh < s.out_h; ++oh) {
+        const T* src_row = src + oh * s.stride_h * s.in_w;
+        for (int64_t ow = 0; ow < s.out_w; ++ow) {
+          dst[oh * s.out_w + ow] = src_row[ow * s.stride_w];
+        }
+      }
+    }
+    in = gathered_data;
+  }
+
+  // The filter in blocks of kOcBlock output channels, [oc / 8][ic][8], the
+  // missing channels of the last block being 0.
+  const int64_t num_blocks = (oc + kOcBlock - 1) / kOcBlock;
+  DenseTensor packed;
+  packed.Resize({num_blocks, ic, kOcBlock});
+  T* packed_data = dev_ctx.template Alloc<T>(&packed);
+  for (int64_t o = 0; o < num_blocks * kOcBlock; ++o) {
+    T* dst = packed_data + (o / kOcBlock) * ic * kOcBlock + o % kOcBlock;
+    for (int64_t c = 0; c < ic; ++c) {
+      dst[c * kOcBlock] = o < oc ? filter[o * ic + c] : static_cast<T>(0);
+    }
+  }
+
+  const int64_t num_tiles = (plane + kPixelTile - 1) / kPixelTile;
+  const int64_t num_tasks = s.batch_size * num_blocks * num_tiles;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads( \
+    ConvThreads(s.batch_size * oc * ic * plane))
+#endif
+  for (int64_t task = 0; task < num_tasks; ++task) {
+    const int64_t n = task / (num_blocks * num_tiles);
+    const int64_t block = task / num_tiles % num_blocks;
+    const int64_t begin = task % num_tiles * kPixelTile;
+    const int64_t len = std::min(kPixelTile, plane - begin);
+    T acc[kOcBlock][kPixelTile];
+    for (auto& row : acc) {
+      std::fill(row, row + len, static_cast<T>(0));
+    }
+    const T* x = in + n * ic * plane + begin;
+    const T* w = packed_data + block * ic * kOcBlock;
+    for (int64_t c = 0; c < ic; ++c) {
+      const T* x_row = x + c * plane;
+      for (int64_t o = 0; o < kOcBlock; ++o) {
+        const T weight = w[c * kOcBlock + o];
+        T* acc_row = acc[o];
+        for (int64_t j = 0; j < len; ++j) {
+          acc_row[j] += weight * x_row[j];
+        }
+      }
+    }
+    const int64_t num_valid = std::min(kOcBlock, oc - block * kOcBlock);
+    for (int64_t o = 0; o < num_valid; ++o) {
+      std::memcpy(output + (n * oc + block * kOcBlock + o) * plane + begin,
+                  acc[o],
+                  len * sizeof(T));
+    }
+  }
+}
+
+// The transforms of Winograd F(M, 3), from "Fast Algorithms for
+// Convolutional Neural Networks" by Lavin and Gray: the output tile is
+// A^T [(G g G^T) * (B^T d B)] A for the 3x3 filter g and the input tile d
+// of kAlpha x kAlpha.
+template <int M>
+struct Winograd;
+
+template <>
+struct Winograd<2> {
+  static constexpr int kAlpha = 4;
+  static constexpr double kBT[4][4] = {
+      {1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}};
+  static constexpr double kG[4][3] = {
+      {1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+  static constexpr double kAT[2][4] = {{1, 1, 1, 0}, {0, 1, -1, -1}};
+};
+
+// Sandwich binds the tables by reference, they need a definition.
+constexpr double Winograd<2>::kBT[4][4];
+constexpr double Winograd<2>::kG[4][3];
+constexpr double Winograd<2>::kAT[2][4];
+
+template <>
+struct Winograd<4> {
+  static constexpr int kAlpha = 6;
+  static constexpr double kBT[6][6] = {{4, 0, -5, 0, 1, 0},
+                                       {0, -4, -4, 1, 1, 0},
+                                       {0, 4, -4, -1, 1, 0},
+                                       {0, -2, -1, 2, 1, 0},
+                                       {0, 2, -1, -2, 1, 0},
+                                       {0, 4, 0, -5, 0, 1}};
+  static constexpr double kG[6][3] = {{1.0 / 4, 0, 0},
+                                      {-1.0 / 6, -1.0 / 6, -1.0 / 6},
+                                      {-1.0 / 6, 1.0 / 6, -1.0 / 6},
+                                      {1.0 / 24, 1.0 / 12, 1.0 / 6},
+                                      {1.0 / 24, -1.0 / 12, 1.0 / 6},
+                                      {0, 0, 1}};
+  static constexpr double kAT[4][6] = {{1, 1, 1, 1, 1, 0},
+                                       {0, 1, -1, 2, -2, 0},
+                                       {0, 1, 1, 4, 4, 0},
+                                       {0, 1, -1, 8, -8, 1}};
+};
+
+constexpr double Winograd<4>::kBT[6][6];
+constexpr double Winograd<4>::kG[6][3];
+constexpr double Winograd<4>::kAT[4][6];
+
+// out = lhs x in x rhs^T, for in of R x C, lhs of P x R and rhs of Q x C.
+template <typename T, int P, int R, int Q, int C>
+inline void Sandwich(const double (&lhs)[P][R],
+                     const T* in,
+                     const double (&rhs)[Q][C],
+                     T* out) {
+  T tmp[P][C];
+  for (int i = 0; i < P; ++i) {
+    for (int j = 0; j < C; ++j) {
+      T sum = 0;
+      for (int k = 0; k < R; ++k) {
+        sum += static_cast<T>(lhs[i][k]) * in[k * C + j];
+      }
+      tmp[i][j] = sum;
+    }
+  }
+  for (int i = 0; i < P; ++i) {
+    for (int j = 0; j < Q; ++j) {
+      T sum = 0;
+      for (int k = 0; k < C; ++k) {
+        sum += tmp[i][k] * static_cast<T>(rhs[j][k]);
+      }
+      out[i * Q + j] = sum;
+    }
+  }
+}
+
+template <typename T, int M>
+void WinogradConv(const CPUContext& dev_ctx,
+                  const CPUConv2DShape& s,
+                  const T* input,
+                  const T* filter,
+                  T* output) {
+  using W = Winograd<M>;
+  constexpr int kAlpha = W::kAlpha;
+  constexpr int kPoints = kAlpha * kAlpha;
+  const int64_t ic = s.in_channels;
+  const int64_t oc = s.out_channels;
+  const int64_t tiles_h = (s.out_h + M - 1) / M;
+  const int64_t tiles_w = (s.out_w + M - 1) / M;
+  const int64_t tiles_per_image = tiles_h * tiles_w;
+  const int64_t num_tiles = s.batch_size * tiles_per_image;
+
+  // The transformed filter, [kPoints][oc][ic].
+  DenseTensor u;
+  u.Resize({kPoints, oc, ic});
+  T* u_data = dev_ctx.template Alloc<T>(&u);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(ConvThreads(oc * ic * kPoints * 8))
+#endif
+  for (int64_t i = 0; i < oc * ic; ++i) {
+    T point[kPoints];
+    Sandwich(W::kG, filter + i * 9, W::kG, point);
+    for (int p = 0; p < kPoints; ++p) {
+      u_data[p * oc * ic + i] = point[p];
+    }
+  }
+
+  // The transformed input and output tiles, [kPoints][channels][chunk],
+  // for chunks of tiles of the whole batch, so that the GEMMs are wide.
+  const int64_t chunk = std::min(
+      num_tiles,
+      std::max<int64_t>(
+          64, kWinogradBufferBytes / (kPoints * (ic + oc) * sizeof(T))));
+  DenseTensor v;
+  DenseTensor m;
+  v.Resize({kPoints, ic, chunk});
+  m.Resize({kPoints, oc, chunk});
+  T* v_data = dev_ctx.template Alloc<T>(&v);
+  T* m_data = dev_ctx.template Alloc<T>(&m);
+  auto blas = GetBlas<CPUContext, T>(dev_ctx);
+
+  for (int64_t first = 0; first < num_tiles; first += chunk) {
+    const int64_t len = std::min(chunk, num_tiles - first);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(ConvThreads(ic * len * kPoints * 8))
+#endif
+    for (int64_t task = 0; task < ic * len; ++task) {
+      const int64_t c = task / len;
+      const int64_t k = task % len;
+      const int64_t tile = first + k;
+      const int64_t n = tile / tiles_per_image;
+      const int64_t y0 = tile % tiles_per_image / tiles_w * M - s.pad_top;
+      const int64_t x0 = tile % tiles_w * M - s.pad_left;
+      const T* in = input + (n * ic + c) * s.in_h * s.in_w;
+      T d[kPoints];
+      for (int i = 0; i < kAlpha; ++i) {
+        const int64_t y = y0 + i;
+        for (int j = 0; j < kAlpha; ++j) {
+          const int64_t x = x0 + j;
+          d[i * kAlpha + j] = y >= 0 && y < s.in_h && x >= 0 && x < s.in_w
+                                  ? in[y * s.in_w + x]
+                                  : static_cast<T>(0);
+        }
+      }
+      T point[kPoints];
+      Sandwich(W::kBT, d, W::kBT, point);
+      for (int p = 0; p < kPoints; ++p) {
+        v_data[(p * ic + c) * chunk + k] = point[p];
+      }
+    }
+
+    for (int p = 0; p < kPoints; ++p) {
+      blas.GEMM(false,
+                false,
+                static_cast<int>(oc),
+                static_cast<int>(len),
+                static_cast<int>(ic),
+                static_cast<T>(1),
+                u_data + p * oc * ic,
+                static_cast<int>(ic),
+                v_data + p * ic * chunk,
+                static_cast<int>(chunk),
+                static_cast<T>(0),
+                m_data + p * oc * chunk,
+                static_cast<int>(chunk));
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(ConvThreads(oc * len * kPoints * 4))
+#endif
+    for (int64_t task = 0; task < oc * len; ++task) {
+      const int64_t o = task / len;
+      const int64_t k = task % len;
+      const int64_t tile = first + k;
+      const int64_t n = tile / tiles_per_image;
+      const int64_t y0 = tile % tiles_per_image / tiles_w * M;
+      const int64_t x0 = tile % tiles_w * M;
+      T point[kPoints];
+      for (int p = 0; p < kPoints; ++p) {
+        point[p] = m_data[(p * oc + o) * chunk + k];
+      }
+      T y[M * M];
+      Sandwich(W::kAT, point, W::kAT, y);
+      T* out = output + (n * oc + o) * s.out_h * s.out_w;
+      const int64_t rows = std::min<int64_t>(M, s.out_h - y0);
+      const int64_t cols = std::min<int64_t>(M, s.out_w - x0);
+      for (int64_t i = 0; i < rows; ++i) {
+        for (int64_t j = 0; j < cols; ++j) {
+          out[(y0 + i) * s.out_w + x0 + j] = y[i * M + j];
+        }
+      }
+    }
+  }
+}
+
+CPUConvAlgo AutoSelectCPUConvAlgo(const CPUConv2DShape& s) {
+  if (s.groups > 1 && CPUConvAlgoSupports(CPUConvAlgo::kDepthwise, s)) {
+    return CPUConvAlgo::kDepthwise;
+  }
+  // The 1x1 convolutions of stride 1 are a GEMM per sample, the ones of
+  // small planes too small to be threaded well.
+  if (CPUConvAlgoSupports(CPUConvAlgo::kDirect1x1, s) &&
+      (s.stride_h != 1 || s.stride_w != 1 ||
+       s.out_h * s.out_w <= kDirect1x1MaxPlane)) {
+    return CPUConvAlgo::kDirect1x1;
+  }
+  const int64_t tiles =
+      s.batch_size * ((s.out_h + 3) / 4) * ((s.out_w + 3) / 4);
+  if (CPUConvAlgoSupports(CPUConvAlgo::kWinogradF43, s) &&
+      s.in_channels >= kWinogradMinChannels &&
+      s.out_channels >= kWinogradMinChannels && tiles >= kWinogradMinTiles) {
+    return CPUConvAlgo::kWinogradF43;
+  }
+  return CPUConvAlgo::kIm2ColGemm;
+}
+
+}  // namespace
+
+const char* CPUConvAlgoName(CPUConvAlgo algo) {
+  switch (algo) {
+    case CPUConvAlgo::kIm2ColGemm:
+      return "im2col";
+    case CPUConvAlgo::kDirect1x1:
+      return "direct_1x1";
+    case CPUConvAlgo::kDepthwise:
+      return "depthwise";
+    case CPUConvAlgo::kWinogradF23:
+      return "winograd_f23";
+    case CPUConvAlgo::kWinogradF43:
+      return "winograd_f43";
+  }
+  return "unknown";
+}
+
+bool CPUConvAlgoSupports(CPUConvAlgo algo, const CPUConv2DShape& s) {
+  switch (algo) {
+    case CPUConvAlgo::kIm2ColGemm:
+      return true;
+    case CPUConvAlgo::kDirect1x1:
+      return s.groups == 1 && s.kernel_h == 1 && s.kernel_w == 1 &&
+             s.pad_top == 0 && s.pad_bottom == 0 && s.pad_left == 0 &&
+             s.pad_right == 0;
+    case CPUConvAlgo::kDepthwise:
+      return s.groups == s.in_channels && s.in_channels > 0 &&
+             s.out_channels % s.in_channels == 0;
+    case CPUConvAlgo::kWinogradF23:
+    case CPUConvAlgo::kWinogradF43:
+      return s.groups == 1 && s.kernel_h == 3 && s.kernel_w == 3 &&
+             s.stride_h == 1 && s.stride_w == 1 && s.dilation_h == 1 &&
+             s.dilation_w == 1;
+  }
+  return false;
+}
+
+CPUConvAlgo SelectCPUConvAlgo(const CPUConv2DShape& shape) {
+  const std::string& name = FLAGS_cpu_conv_algo;
+  if (name == "auto") {
+    return AutoSelectCPUConvAlgo(shape);
+  }
+  for (auto algo : kAllAlgos) {
+    if (name == CPUConvAlgoName(algo)) {
+      return CPUConvAlgoSupports(algo, shape) ? algo
+                                              : CPUConvAlgo::kIm2ColGemm;
+    }
+  }
+  PADDLE_THROW(phi::errors::InvalidArgument(
+      "FLAGS_cpu_conv_algo should be auto, im2col, direct_1x1, depthwise, "
+      "winograd_f23 or winograd_f43, but received %s.",
+      name));
+}
+
+template <typename T>
+void CPUConv2D(const CPUContext& dev_ctx,
+               const CPUConv2DShape& shape,
+               CPUConvAlgo algo,
+               const T* input,
+               const T* filter,
+               T* output) {
+  PADDLE_ENFORCE_EQ(
+      algo != CPUConvAlgo::kIm2ColGemm && CPUConvAlgoSupports(algo, shape),
+      true,
+      phi::errors::InvalidArgument(
+          "The %s convolution does not support the conv2d of the filter of "
+          "%dx%d, the stride of %dx%d and %d groups.",
+          CPUConvAlgoName(algo),
+          shape.kernel_h,
+          shape.kernel_w,
+          shape.stride_h,
+          shape.stride_w,
+          shape.groups));
+  if (shape.batch_size * shape.out_channels * shape.out_h * shape.out_w == 0) {
+    return;
+  }
+  switch (algo) {
+    case CPUConvAlgo::kDirect1x1:
+      Direct1x1Conv(dev_ctx, shape, input, filter, output);
+      break;
+    case CPUConvAlgo::kDepthwise:
+      DepthwiseConv(shape, input, filter, output);
+      break;
+    case CPUConvAlgo::kWinogradF23:
+      WinogradConv<T, 2>(dev_ctx, shape, input, filter, output);
+      break;
+    case CPUConvAlgo::kWinogradF43:
+      WinogradConv<T, 4>(dev_ctx, shape, input, filter, output);
+      break;
+    default:
+      break;
+  }
+}
+
+template void CPUConv2D<float>(const CPUContext& dev_ctx,
+                               const CPUConv2DShape& shape,
+                               CPUConvAlgo algo,
+                               const float* input,
+                               const float* filter,
+                               float* output);
+template void CPUConv2D<double>(const CPUContext& dev_ctx,
+                                const CPUConv2DShape& shape,
+                                CPUConvAlgo algo,
+                                const double* input,
+                                const double* filter,
+                                double* output);
+
+}  // namespace funcs
+}  // namespace phi
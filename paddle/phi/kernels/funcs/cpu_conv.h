@@ -0,0 +1,84 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+
+namespace phi {
+namespace funcs {
+
+// The algorithms of the 2D convolutions on CPU.
+enum class CPUConvAlgo {
+  // Im2ColFunctor and a GEMM per sample and group, as ConvKernelImpl does.
+  kIm2ColGemm,
+  // 1x1 filters, the output channels in blocks of 8 accumulated over the
+  // input channels for tiles of 64 pixels, sample by sample in parallel.
+  kDirect1x1,
+  // groups == input channels, every output plane on its own.
+  kDepthwise,
+  // 3x3 filters of stride 1, in tiles of 2x2 and 4x4 output pixels, with a
+  // GEMM over the channels for each point of the transformed tiles.
+  kWinogradF23,
+  kWinogradF43,
+};
+
+// The shape of a conv2d in NCHW, with the paddings of the four sides.
+struct CPUConv2DShape {
+  int64_t batch_size;
+  int64_t in_channels;
+  int64_t in_h;
+  int64_t in_w;
+  int64_t out_channels;
+  int64_t out_h;
+  int64_t out_w;
+  int kernel_h;
+  int kernel_w;
+  int stride_h;
+  int stride_w;
+  int pad_top;
+  int pad_bottom;
+  int pad_left;
+  int pad_right;
+  int dilation_h;
+  int dilation_w;
+  int groups;
+};
+
+const char* CPUConvAlgoName(CPUConvAlgo algo);
+
+bool CPUConvAlgoSupports(CPUConvAlgo algo, const CPUConv2DShape& shape);
+
+// The algorithm FLAGS_cpu_conv_algo chooses for shape. With "auto", the
+// default, depthwise convolutions are done by kDepthwise, 1x1 ones of
+// stride > 1 or of small planes by kDirect1x1, and 3x3 ones of stride 1, at
+// least 8 channels and enough output pixels in the batch by kWinogradF43.
+// The others, and the ones forced to an algorithm which does not support
+// them, are left to kIm2ColGemm.
+CPUConvAlgo SelectCPUConvAlgo(const CPUConv2DShape& shape);
+
+// Computes the conv2d of shape of the NCHW input and the OIHW filter into
+// output by algo, which must not be kIm2ColGemm and must support shape.
+template <typename T>
+void CPUConv2D(const CPUContext& dev_ctx,
+               const CPUConv2DShape& shape,
+               CPUConvAlgo algo,
+               const T* input,
+               const T* filter,
+               T* output);
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,471 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/dims_simplifier.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// The side of the tiles of the 2D transposes, so that the input and the
+// output tiles stay in L1. The tiles of the small elements are wider, for
+// their rows to fill at least a couple of cache lines.
+constexpr int64_t kTileSize = 32;
+constexpr int64_t kMinTileRowBytes = 128;
+// The fewest bytes worth a thread of their own.
+constexpr int64_t kMinBytesPerThread = 128 * 1024;
+
+int TransposeThreads(int64_t num_bytes) {
+#ifdef PADDLE_WITH_MKLML
+  return static_cast<int>(std::max<int64_t>(
+      1,
+      std::min<int64_t>(omp_get_max_threads(),
+                        num_bytes / kMinBytesPerThread)));
+#else
+  return 1;
+#endif
+}
+
+struct alignas(8) Bytes16 {
+  uint64_t data[2];
+};
+
+// out[j * ldo + i] = in[i * ldi + j] for the rows x cols block of in.
+template <typename T>
+inline void TransposeScalar(const T* in,
+                            int64_t ldi,
+                            T* out,
+                            int64_t ldo,
+                            int64_t rows,
+                            int64_t cols) {
+  for (int64_t j = 0; j < cols; ++j) {
+    for (int64_t i = 0; i < rows; ++i) {
+      out[j * ldo + i] = in[i * ldi + j];
+    }
+  }
+}
+
+// Transposes a kSize x kSize block with SIMD shuffles, none by default.
+template <typename T>
+struct MicroKernel {
+  static constexpr int64_t kSize = 0;
+  static void Run(const T* in, int64_t ldi, T* out, int64_t ldo) {}
+};
+
+#if defined(__SSE2__)
+template <int kBytes>
+inline __m128i UnpackLo(__m128i a, __m128i b);
+template <int kBytes>
+inline __m128i UnpackHi(__m128i a, __m128i b);
+
+#define DEFINE_SSE2_UNPACK(BYTES, BITS)                       \
+  template <>                                                 \
+  inline __m128i UnpackLo<BYTES>(__m128i a, __m128i b) {      \
+    return _mm_unpacklo_epi##BITS(a, b);                      \
+  }                                                           \
+  template <>                                                 \
+  inline __m128i UnpackHi<BYTES>(__m128i a, __m128i b) {      \
+    return _mm_unpackhi_epi##BITS(a, b);                      \
+  }
+
+DEFINE_SSE2_UNPACK(1, 8);
+DEFINE_SSE2_UNPACK(2, 16);
+DEFINE_SSE2_UNPACK(4, 32);
+DEFINE_SSE2_UNPACK(8, 64);
+#undef DEFINE_SSE2_UNPACK
+
+template <int kRows, int kBytes>
+inline void UnpackStages(__m128i* r);
+
+// Runs the stages after the kBytes one, if any.
+template <int kRows, int kBytes>
+inline void UnpackNextStages(__m128i* r, std::true_type) {
+  UnpackStages<kRows, kBytes * 2>(r);
+}
+template <int kRows, int kBytes>
+inline void UnpackNextStages(__m128i* r, std::false_type) {}
+
+// Interleaves the rows by pairs, kBytes at a time, then by 2 * kBytes...
+// After the last stage, r[i] holds the column whose index is i with its
+// bits reversed.
+template <int kRows, int kBytes>
+inline void UnpackStages(__m128i* r) {
+  __m128i t[kRows];
+  for (int i = 0; i < kRows / 2; ++i) {
+    t[i] = UnpackLo<kBytes>(r[2 * i], r[2 * i + 1]);
+    t[i + kRows / 2] = UnpackHi<kBytes>(r[2 * i], r[2 * i + 1]);
+  }
+  for (int i = 0; i < kRows; ++i) {
+    r[i] = t[i];
+  }
+  UnpackNextStages<kRows, kBytes>(
+      r, std::integral_constant<bool, (kBytes < 8)>());
+}
+
+constexpr int BitReverse(int value, int rows) {
+  int result = 0;
+  for (int bit = 1; bit < rows; bit <<= 1) {
+    result = (result << 1) | ((value & bit) ? 1 : 0);
+  }
+  return result;
+}
+
+// The transpose of the 16 / sizeof(T) square block of a 128 bits register
+// per row.
+template <typename T>
+struct SSE2MicroKernel {
+  static constexpr int64_t kSize = 16 / sizeof(T);
+  static void Run(const T* in, int64_t ldi, T* out, int64_t ldo) {
+    __m128i r[kSize];
+    for (int i = 0; i < kSize; ++i) {
+      r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * ldi));
+    }
+    UnpackStages<kSize, sizeof(T)>(r);
+    for (int i = 0; i < kSize; ++i) {
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + BitReverse(i, kSize) * ldo), r[i]);
+    }
+  }
+};
+
+template <>
+struct MicroKernel<uint8_t> : SSE2MicroKernel<uint8_t> {};
+template <>
+struct MicroKernel<uint16_t> : SSE2MicroKernel<uint16_t> {};
+#if !defined(__AVX__)
+template <>
+struct MicroKernel<uint32_t> : SSE2MicroKernel<uint32_t> {};
+#endif
+#endif
+
+#if defined(__AVX__)
+template <>
+struct MicroKernel<uint32_t> {
+  static constexpr int64_t kSize = 8;
+  static void Run(const uint32_t* in,
+                  int64_t ldi,
+                  uint32_t* out,
+                  int64_t ldo) {
+    const float* src = reinterpret_cast<const float*>(in);
+    float* dst = reinterpret_cast<float*>(out);
+    __m256 r0 = _mm256_loadu_ps(src);
+    __m256 r1 = _mm256_loadu_ps(src + ldi);
+    __m256 r2 = _mm256_loadu_ps(src + 2 * ldi);
+    __m256 r3 = _mm256_loadu_ps(src + 3 * ldi);
+    __m256 r4 = _mm256_loadu_ps(src + 4 * ldi);
+    __m256 r5 = _mm256_loadu_ps(src + 5 * ldi);
+    __m256 r6 = _mm256_loadu_ps(src + 6 * ldi);
+    __m256 r7 = _mm256_loadu_ps(src + 7 * ldi);
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm256_storeu_ps(dst, _mm256_permute2f128_ps(s0, s4, 0x20));
+    _mm256_storeu_ps(dst + ldo, _mm256_permute2f128_ps(s1, s5, 0x20));
+    _mm256_storeu_ps(dst + 2 * ldo, _mm256_permute2f128_ps(s2, s6, 0x20));
+    _mm256_storeu_ps(dst + 3 * ldo, _mm256_permute2f128_ps(s3, s7, 0x20));
+    _mm256_storeu_ps(dst + 4 * ldo, _mm256_permute2f128_ps(s0, s4, 0x31));
+    _mm256_storeu_ps(dst + 5 * ldo, _mm256_permute2f128_ps(s1, s5, 0x31));
+    _mm256_storeu_ps(dst + 6 * ldo, _mm256_permute2f128_ps(s2, s6, 0x31));
+    _mm256_storeu_ps(dst + 7 * ldo, _mm256_permute2f128_ps(s3, s7, 0x31));
+  }
+};
+
+template <>
+struct MicroKernel<uint64_t> {
+  static constexpr int64_t kSize = 4;
+  static void Run(const uint64_t* in,
+                  int64_t ldi,
+                  uint64_t* out,
+                  int64_t ldo) {
+    const double* src = reinterpret_cast<const double*>(in);
+    double* dst = reinterpret_cast<double*>(out);
+    __m256d r0 = _mm256_loadu_pd(src);
+    __m256d r1 = _mm256_loadu_pd(src + ldi);
+    __m256d r2 = _mm256_loadu_pd(src + 2 * ldi);
+    __m256d r3 = _mm256_loadu_pd(src + 3 * ldi);
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + ldo, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ldo, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ldo, _mm256_permute2f128_pd(t1, t3, 0x31));
+  }
+};
+#endif
+
+// The rows x cols tile, by micro kernel blocks where they fit.
+template <typename T>
+void TransposeTile(const T* in,
+                   int64_t ldi,
+                   T* out,
+                   int64_t ldo,
+                   int64_t rows,
+                   int64_t cols) {
+  constexpr int64_t kSize = MicroKernel<T>::kSize;
+  int64_t i = 0;
+  for (; kSize > 0 && i + kSize <= rows; i += kSize) {
+    int64_t j = 0;
+    for (; j + kSize <= cols; j += kSize) {
+      MicroKernel<T>::Run(in + i * ldi + j, ldi, out + j * ldo + i, ldo);
+    }
+    TransposeScalar(in + i * ldi + j, ldi, out + j * ldo + i, ldo, kSize,
+                    cols - j);
+  }
+  TransposeScalar(in + i * ldi, ldi, out + i, ldo, rows - i, cols);
+}
+
+// A batch of rows x cols transposes, the input rows being in_row_stride
+// elements apart and the output rows out_row_stride. The batch dims are in
+// the order of the output, with their strides in the input and the output.
+struct Transpose2DPlan {
+  int64_t rows;
+  int64_t cols;
+  int64_t in_row_stride;
+  int64_t out_row_stride;
+  std::vector<int64_t> batch_dims;
+  std::vector<int64_t> batch_in_strides;
+  std::vector<int64_t> batch_out_strides;
+};
+
+// Shares the tiles among the threads. tile_func(in_offset, out_offset, rows,
+// cols) transposes a tile, the offsets being in elements.
+template <typename TileFunc>
+void RunTiles(const Transpose2DPlan& plan,
+              size_t element_size,
+              int64_t num_bytes,
+              const TileFunc& tile_func) {
+  const int64_t tile_size = std::max<int64_t>(
+      kTileSize, kMinTileRowBytes / static_cast<int64_t>(element_size));
+  // The tiles of few rows, or columns, are longer to do as much work.
+  int64_t row_tile = std::min(plan.rows, tile_size);
+  int64_t col_tile = std::min(
+      plan.cols, std::max(tile_size, tile_size * tile_size / row_tile));
+  row_tile = std::min(
+      plan.rows, std::max(tile_size, tile_size * tile_size / col_tile));
+  const int64_t row_tiles = (plan.rows + row_tile - 1) / row_tile;
+  const int64_t col_tiles = (plan.cols + col_tile - 1) / col_tile;
+  const int64_t tiles_per_batch = row_tiles * col_tiles;
+  int64_t batch_size = 1;
+  for (auto dim : plan.batch_dims) {
+    batch_size *= dim;
+  }
+  const int64_t num_tiles = batch_size * tiles_per_batch;
+  const int num_batch_dims = static_cast<int>(plan.batch_dims.size());
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(TransposeThreads(num_bytes))
+#endif
+  for (int64_t tile = 0; tile < num_tiles; ++tile) {
+    int64_t batch = tile / tiles_per_batch;
+    const int64_t tile_in_batch = tile - batch * tiles_per_batch;
+    const int64_t col_begin = tile_in_batch / row_tiles * col_tile;
+    const int64_t row_begin = tile_in_batch % row_tiles * row_tile;
+    int64_t in_offset = row_begin * plan.in_row_stride + col_begin;
+    int64_t out_offset = col_begin * plan.out_row_stride + row_begin;
+    for (int k = num_batch_dims - 1; k >= 0; --k) {
+      const int64_t index = batch % plan.batch_dims[k];
+      batch /= plan.batch_dims[k];
+      in_offset += index * plan.batch_in_strides[k];
+      out_offset += index * plan.batch_out_strides[k];
+    }
+    tile_func(in_offset,
+              out_offset,
+              std::min(row_tile, plan.rows - row_begin),
+              std::min(col_tile, plan.cols - col_begin));
+  }
+}
+
+template <typename T>
+void TransposeTiles(const void* in,
+                    void* out,
+                    const Transpose2DPlan& plan,
+                    int64_t num_bytes) {
+  const T* in_data = static_cast<const T*>(in);
+  T* out_data = static_cast<T*>(out);
+  RunTiles(plan,
+           sizeof(T),
+           num_bytes,
+           [&](int64_t in_offset, int64_t out_offset, int64_t rows,
+               int64_t cols) {
+             TransposeTile(in_data + in_offset,
+                           plan.in_row_stride,
+                           out_data + out_offset,
+                           plan.out_row_stride,
+                           rows,
+                           cols);
+           });
+}
+
+// For the elements of other sizes, mostly rows of the dims which are not
+// moved.
+void TransposeTilesOfBytes(const void* in,
+                           void* out,
+                           size_t element_size,
+                           const Transpose2DPlan& plan,
+                           int64_t num_bytes) {
+  const char* in_data = static_cast<const char*>(in);
+  char* out_data = static_cast<char*>(out);
+  RunTiles(plan,
+           element_size,
+           num_bytes,
+           [&](int64_t in_offset, int64_t out_offset, int64_t rows,
+               int64_t cols) {
+             for (int64_t j = 0; j < cols; ++j) {
+               for (int64_t i = 0; i < rows; ++i) {
+                 std::memcpy(
+                     out_data + (out_offset + j * plan.out_row_stride + i) *
+                                    element_size,
+                     in_data + (in_offset + i * plan.in_row_stride + j) *
+                                   element_size,
+                     element_size);
+               }
+             }
+           });
+}
+
+}  // namespace
+
+void TransposeCPU(const void* in,
+                  void* out,
+                  size_t element_size,
+                  const std::vector<int64_t>& dims,
+                  const std::vector<int>& axis) {
+  PADDLE_ENFORCE_EQ(
+      dims.size(),
+      axis.size(),
+      phi::errors::InvalidArgument(
+          "The rank of the tensor (%d) and the size of axis (%d) of "
+          "transpose should be the same.",
+          dims.size(),
+          axis.size()));
+  int64_t numel = 1;
+  for (auto dim : dims) {
+    numel *= dim;
+  }
+  if (numel == 0) {
+    return;
+  }
+  const int64_t num_bytes = numel * static_cast<int64_t>(element_size);
+
+  // The dims of 1 go first, PermuteDimsSimplifier does not merge the dims
+  // they separate.
+  std::vector<int> new_index(dims.size(), -1);
+  std::vector<int64_t> kept_dims;
+  for (size_t i = 0; i < dims.size(); ++i) {
+    if (dims[i] != 1) {
+      new_index[i] = static_cast<int>(kept_dims.size());
+      kept_dims.push_back(dims[i]);
+    }
+  }
+  std::vector<int> kept_axis;
+  for (auto dim : axis) {
+    if (new_index[dim] >= 0) {
+      kept_axis.push_back(new_index[dim]);
+    }
+  }
+  if (kept_dims.size() <= 1) {
+    std::memcpy(out, in, num_bytes);
+    return;
+  }
+
+  PermuteDimsSimplifier simplifier(
+      static_cast<int>(kept_dims.size()), numel, kept_axis, kept_dims);
+  int rank = simplifier.GetRank();
+  std::vector<int> perm = simplifier.GetPerm();
+  std::vector<int64_t> src_dims = simplifier.GetSrcDims();
+  // The innermost dims which stay innermost are moved as rows, being the
+  // elements of the transpose of the other dims.
+  while (rank > 1 && perm[rank - 1] == rank - 1) {
+    element_size *= src_dims[rank - 1];
+    rank -= 1;
+  }
+  if (rank == 1) {
+    std::memcpy(out, in, num_bytes);
+    return;
+  }
+
+  std::vector<int64_t> in_strides(rank, 1);
+  std::vector<int64_t> out_strides(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * src_dims[i + 1];
+    out_strides[i] = out_strides[i + 1] * src_dims[perm[i + 1]];
+  }
+  // The rows of the 2D transposes are along the dim which becomes the
+  // innermost of the output, their columns along the innermost of the input.
+  Transpose2DPlan plan;
+  plan.rows = src_dims[perm[rank - 1]];
+  plan.cols = src_dims[rank - 1];
+  plan.in_row_stride = in_strides[perm[rank - 1]];
+  for (int i = 0; i < rank - 1; ++i) {
+    if (perm[i] == rank - 1) {
+      plan.out_row_stride = out_strides[i];
+    } else {
+      plan.batch_dims.push_back(src_dims[perm[i]]);
+      plan.batch_in_strides.push_back(in_strides[perm[i]]);
+      plan.batch_out_strides.push_back(out_strides[i]);
+    }
+  }
+
+  switch (element_size) {
+    case 1:
+      TransposeTiles<uint8_t>(in, out, plan, num_bytes);
+      break;
+    case 2:
+      TransposeTiles<uint16_t>(in, out, plan, num_bytes);
+      break;
+    case 4:
+      TransposeTiles<uint32_t>(in, out, plan, num_bytes);
+      break;
+    case 8:
+      TransposeTiles<uint64_t>(in, out, plan, num_bytes);
+      break;
+    case 16:
+      TransposeTiles<Bytes16>(in, out, plan, num_bytes);
+      break;
+    default:
+      TransposeTilesOfBytes(in, out, element_size, plan, num_bytes);
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
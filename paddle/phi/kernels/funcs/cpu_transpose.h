@@ -0,0 +1,50 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+namespace funcs {
+
+// Transposes the row-major tensor of dims in into out, out[i] being
+// in[axis[i]], for elements of any trivially copyable type of element_size
+// bytes. The dims which stay next to each other are folded first, as
+// PermuteDimsSimplifier does for GPU, so that most transposes end up as a
+// batch of 2D transposes of the innermost swapped pair of dims. Those are
+// done in cache blocked tiles, with SIMD shuffle micro kernels for elements
+// of 1, 2, 4 and 8 bytes, and the tiles are shared among the threads.
+void TransposeCPU(const void* in,
+                  void* out,
+                  size_t element_size,
+                  const std::vector<int64_t>& dims,
+                  const std::vector<int>& axis);
+
+template <typename T>
+void TransposeCPU(const DenseTensor& in,
+                  DenseTensor* out,
+                  const std::vector<int>& axis) {
+  TransposeCPU(in.data<T>(),
+               out->data<T>(),
+               sizeof(T),
+               phi::vectorize<int64_t>(in.dims()),
+               axis);
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License. */
 
+#include <cstring>
 #include <iostream>
 #include <random>
 
@@ -379,6 +380,55 @@ void BenchKernelMatMul() {
   }
 }
 
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelMatMulBF16() {
+  using T = typename KernelTuple::data_type;
+  for (int n : {16, 64, 256, 1024, 4096}) {
+    for (int k : {64, 256, 1024, 4096}) {
+      phi::DenseTensor a, b, c;
+      a.Resize({k});
+      b.Resize({k * n});
+      c.Resize({n});
+      RandomVec<T>(k, a.mutable_data<T>(PlaceType()), -2.f, 2.f);
+      RandomVec<float>(k * n, b.mutable_data<float>(PlaceType()), -2.f, 2.f);
+      // keep the high half of each float as its bfloat16 value
+      std::vector<uint16_t> b_bf16(k * n);
+      const float* b_fp32 = b.data<float>();
+      for (int i = 0; i < k * n; ++i) {
+        uint32_t bits;
+        std::memcpy(&bits, b_fp32 + i, sizeof(bits));
+        b_bf16[i] = static_cast<uint16_t>(bits >> 16);
+      }
+      const T* a_data = a.data<T>();
+      const uint16_t* b_data = b_bf16.data();
+      T* c_data = c.mutable_data<T>(PlaceType());
+      const jit::matmul_attr_t attr{1, n, k};
+      BenchAllImpls<KernelTuple, PlaceType>(
+          attr, a_data, b_data, c_data, &attr);
+    }
+  }
+}
+
+template <typename KernelTuple, typename PlaceType>
+void BenchKernelSoftmax() {
+  using T = typename KernelTuple::data_type;
+  for (int bs : {1, 2, 10}) {
+    for (int n : TestSizes()) {
+      for (int remain : {1, 2, 3}) {
+        phi::DenseTensor x, y;
+        x.Resize({bs, n * remain});
+        y.Resize({bs, n * remain});
+        RandomVec<T>(
+            bs * n * remain, x.mutable_data<T>(PlaceType()), -2.f, 2.f);
+        const T* x_data = x.data<T>();
+        T* y_data = y.mutable_data<T>(PlaceType());
+        BenchAllImpls<KernelTuple, PlaceType>(
+            n, x_data, y_data, n, bs, remain);
+      }
+    }
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void BenchKernelLayerNorm() {
   using T = typename KernelTuple::data_type;
@@ -486,6 +536,8 @@ void BenchKernelVBroadcast() {
 #define BenchKernelVSigmoid BenchKernelXYN
 #define BenchKernelVTanh BenchKernelXYN
 #define BenchKernelVCopy BenchKernelXYN
+#define BenchKernelVGeluErf BenchKernelXYN
+#define BenchKernelVGeluTanh BenchKernelXYN
 
 #define BenchKernelLSTMCtHt BenchKernelLSTM
 #define BenchKernelLSTMC1H1 BenchKernelLSTM
@@ -519,6 +571,8 @@ BENCH_FP32_CPU(VExp);
 BENCH_FP32_CPU(VSigmoid);
 BENCH_FP32_CPU(VTanh);
 BENCH_FP32_CPU(VCopy);
+BENCH_FP32_CPU(VGeluErf);
+BENCH_FP32_CPU(VGeluTanh);
 
 // LSTM
 BENCH_FP32_CPU(LSTMCtHt);
@@ -535,6 +589,8 @@ BENCH_FP32_CPU(CRFDecoding);
 BENCH_FP32_CPU(SeqPool);
 BENCH_FP32_CPU(EmbSeqPool);
 BENCH_FP32_CPU(MatMul);
+BENCH_FP32_CPU(MatMulBF16);
+BENCH_FP32_CPU(Softmax);
 BENCH_FP32_CPU(Sgd);
 BENCH_FP32_CPU(VBroadcast);
 
@@ -16,6 +16,8 @@
 
 #include <stddef.h>  // offsetof
 
+#include <algorithm>
+
 #include "paddle/phi/backends/cpu/cpu_info.h"
 #include "paddle/phi/kernels/funcs/jit/registry.h"
 
@@ -106,6 +108,48 @@ void MatMulJitCode::genCode() {
   postCode();
 }
 
+void MatMulBF16JitCode::genCode() {
+  preCode();
+  // zmm0-7 accumulate outputs, zmm8-15 hold widened weights and zmm31 holds
+  // the broadcast element of x.
+  constexpr int max_accs = 8;
+  const int x_reg_idx = 31;
+  const int blocks = n_ / ZMM_FLOAT_BLOCK;
+  const int wgt_block_len = sizeof(uint16_t) * ZMM_FLOAT_BLOCK;
+  const int z_block_len = sizeof(float) * ZMM_FLOAT_BLOCK;
+  for (int b = 0; b < blocks; b += max_accs) {
+    const int accs = std::min(max_accs, blocks - b);
+    for (int i = 0; i < accs; ++i) {
+      vxorps(zmm_t(i), zmm_t(i), zmm_t(i));
+    }
+    mov(reg_ptr_x, param_x);
+    mov(reg_ptr_wgt, param_y);
+    if (b > 0) {
+      add(reg_ptr_wgt, b * wgt_block_len);
+    }
+    mov(reg_k, k_);
+    Label l_next_k;
+    L(l_next_k);
+    {
+      vbroadcastss(zmm_t(x_reg_idx), ptr[reg_ptr_x]);
+      for (int i = 0; i < accs; ++i) {
+        // bfloat16 is the high half of a float
+        vpmovzxwd(zmm_t(max_accs + i), ptr[reg_ptr_wgt + i * wgt_block_len]);
+        vpslld(zmm_t(max_accs + i), zmm_t(max_accs + i), 16);
+        vfmadd231ps(zmm_t(i), zmm_t(max_accs + i), zmm_t(x_reg_idx));
+      }
+      add(reg_ptr_x, sizeof(float));
+      add(reg_ptr_wgt, n_ * sizeof(uint16_t));
+      dec(reg_k);
+      jnz(l_next_k, T_NEAR);
+    }
+    for (int i = 0; i < accs; ++i) {
+      vmovups(ptr[param_z + (b + i) * z_block_len], zmm_t(i));
+    }
+  }
+  postCode();
+}
+
 class MatMulCreator : public JitCodeCreator<matmul_attr_t> {
  public:
   bool CanBeUsed(const matmul_attr_t& attr) const override {
@@ -147,6 +191,30 @@ class MatMulCreator : public JitCodeCreator<matmul_attr_t> {
   }
 };
 
+class MatMulBF16Creator : public JitCodeCreator<matmul_attr_t> {
+ public:
+  bool CanBeUsed(const matmul_attr_t& attr) const override {
+    return attr.m == 1 && attr.k > 0 &&
+           phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f) &&
+           attr.n > 0 && attr.n % ZMM_FLOAT_BLOCK == 0;
+  }
+  size_t CodeSize(const matmul_attr_t& attr) const override {
+    // every group of 8 output blocks costs a short loop body
+    return 96 + (attr.n / ZMM_FLOAT_BLOCK + 1) * 4 * 8 * 8;
+  }
+  std::unique_ptr<GenBase> CreateJitCode(
+      const matmul_attr_t& attr) const override {
+    PADDLE_ENFORCE_GT(
+        attr.k,
+        0,
+        phi::errors::InvalidArgument(
+            "The attribute k (second matrix's col) of MatMulBF16 should "
+            "be larger than 0. But it is %d.",
+            attr.k));
+    return make_unique<MatMulBF16JitCode>(attr, CodeSize(attr));
+  }
+};
+
 }  // namespace gen
 }  // namespace jit
 }  // namespace phi
@@ -154,3 +222,4 @@ class MatMulCreator : public JitCodeCreator<matmul_attr_t> {
 namespace gen = phi::jit::gen;
 
 REGISTER_JITKERNEL_GEN(kMatMul, gen::MatMulCreator);
+REGISTER_JITKERNEL_GEN(kMatMulBF16, gen::MatMulBF16Creator);
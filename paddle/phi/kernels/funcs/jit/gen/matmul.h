@@ -62,6 +62,45 @@ class MatMulJitCode : public JitCode {
   reg64_t reg_ptr_wgt{r10};
 };
 
+// C(1,N) = A(1,K) * B(K,N) with B kept as bfloat16 in memory. B is widened to
+// float in registers, so the accumulation has the same precision as the
+// float kernel while only half of the weight bytes are read.
+class MatMulBF16JitCode : public JitCode {
+ public:
+  explicit MatMulBF16JitCode(const matmul_attr_t& attr,
+                             size_t code_size = 256 * 1024,
+                             void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr), m_(attr.m), n_(attr.n), k_(attr.k) {
+    PADDLE_ENFORCE_EQ(
+        m_,
+        1,
+        phi::errors::Unimplemented("Jitcode of bf16 matmul only support m==1 "
+                                   "(first matrix's row) now. But m is %d.",
+                                   m_));
+    this->genCode();
+  }
+
+  std::string name() const override {
+    std::string base = "MatMulBF16JitCode";
+    base = base + "_M" + std::to_string(m_) + "_N" + std::to_string(n_) + "_K" +
+           std::to_string(k_);
+    return base;
+  }
+  void genCode() override;
+
+ private:
+  int m_, n_, k_;
+
+  reg64_t param_x{abi_param1};
+  reg64_t param_y{abi_param2};
+  reg64_t param_z{abi_param3};
+  reg64_t param_attr{abi_param4};
+  reg64_t reg_k{rax};
+
+  reg64_t reg_ptr_x{r10};
+  reg64_t reg_ptr_wgt{r11};
+};
+
 }  // namespace gen
 }  // namespace jit
 }  // namespace phi
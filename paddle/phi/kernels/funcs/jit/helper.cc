@@ -47,6 +47,8 @@ const char* to_string(KernelType kt) {
     ONE_CASE(kVSquare);
     ONE_CASE(kVSigmoid);
     ONE_CASE(kVTanh);
+    ONE_CASE(kVGeluErf);
+    ONE_CASE(kVGeluTanh);
     ONE_CASE(kLSTMCtHt);
     ONE_CASE(kLSTMC1H1);
     ONE_CASE(kGRUH1);
@@ -56,6 +58,8 @@ const char* to_string(KernelType kt) {
     ONE_CASE(kLayerNorm);
     ONE_CASE(kSeqPool);
     ONE_CASE(kMatMul);
+    ONE_CASE(kMatMulBF16);
+    ONE_CASE(kSoftmax);
     ONE_CASE(kAdam);
     ONE_CASE(kAdamW);
     ONE_CASE(kEmbSeqPool);
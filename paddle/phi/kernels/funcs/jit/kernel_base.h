@@ -35,13 +35,17 @@ typedef enum {
   kLSTMC1H1,
   kLayerNorm,
   kMatMul,
+  kMatMulBF16,
   kSeqPool,
+  kSoftmax,
   kVAdd,
   kVAddBias,
   kVAddRelu,
   kVBroadcast,
   kVCopy,
   kVExp,
+  kVGeluErf,
+  kVGeluTanh,
   kVIdentity,
   kVMul,
   kVRelu,
@@ -118,6 +122,8 @@ DECLARE_KERNELTUPLE(XYNTuple, VExp);
 DECLARE_KERNELTUPLE(XYNTuple, VSigmoid);
 DECLARE_KERNELTUPLE(XYNTuple, VTanh);
 DECLARE_KERNELTUPLE(XYNTuple, VCopy);
+DECLARE_KERNELTUPLE(XYNTuple, VGeluErf);
+DECLARE_KERNELTUPLE(XYNTuple, VGeluTanh);
 
 typedef struct {
   void* gates;  // gates: x_ch, x_ih, x_fh, x_oh
@@ -317,6 +323,28 @@ struct MatMulTuple {
   typedef void (*func_type)(const T*, const T*, T*, const matmul_attr_t*);
 };
 
+// A(M,K) * B(K,N) = C(M,N), where B is stored as raw bfloat16 bits
+template <typename T>
+struct MatMulBF16Tuple {
+  static constexpr KernelType kernel_type = kMatMulBF16;
+  typedef T data_type;
+  typedef matmul_attr_t attr_type;
+  typedef void (*func_type)(const T*,
+                            const uint16_t*,
+                            T*,
+                            const matmul_attr_t*);
+};
+
+// x, y, n, bs, remain: softmax of bs rows, each row has n groups of
+// remain elements and the softmax is taken along n
+template <typename T>
+struct SoftmaxTuple {
+  static constexpr KernelType kernel_type = kSoftmax;
+  typedef T data_type;
+  typedef int attr_type;
+  typedef void (*func_type)(const T*, T*, int, int, int);
+};
+
 template <typename T>
 struct CRFDecodingTuple {
   static constexpr KernelType kernel_type = kCRFDecoding;
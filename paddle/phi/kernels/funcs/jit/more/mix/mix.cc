@@ -14,6 +14,10 @@
 
 #include "paddle/phi/kernels/funcs/jit/more/mix/mix.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "paddle/phi/kernels/funcs/jit/kernels.h"
 #include "paddle/phi/kernels/funcs/jit/registry.h"
 
@@ -49,6 +53,93 @@ void VTanh(const T* x, T* y, int n) {
   compute_addbias(&b, y, y, n);
 }
 
+void VGeluTanh(const T* x, T* y, int n) {
+  // Work on fixed-size chunks so that only a couple of tanh kernels get
+  // generated whatever n is, and x may alias y.
+  constexpr int kBlock = 256;
+  const T c = static_cast<T>(M_2_SQRTPI * M_SQRT1_2);
+  const T a = static_cast<T>(0.044715);
+  T tmp[kBlock];
+  for (int offset = 0; offset < n; offset += kBlock) {
+    const int len = std::min(kBlock, n - offset);
+    auto compute_tanh = KernelFuncs<VTanhTuple<T>, CPUPlace>::Cache().At(len);
+    const T* px = x + offset;
+    T* py = y + offset;
+    for (int i = 0; i < len; ++i) {
+      tmp[i] = c * (px[i] + a * px[i] * px[i] * px[i]);
+    }
+    compute_tanh(tmp, tmp, len);
+    for (int i = 0; i < len; ++i) {
+      py[i] = static_cast<T>(0.5) * px[i] * (static_cast<T>(1) + tmp[i]);
+    }
+  }
+}
+
+// The shifted logits are clipped at -64 before exp, as in SoftmaxEigen.
+static void SoftmaxClip(T* x, int n) {
+  const T threshold = static_cast<T>(-64);
+  for (int i = 0; i < n; ++i) {
+    x[i] = x[i] < threshold ? threshold : x[i];
+  }
+}
+
+void Softmax(const T* x, T* y, int n, int bs, int remain) {
+  const int row_len = n * remain;
+  auto compute_exp = KernelFuncs<VExpTuple<T>, CPUPlace>::Cache().At(row_len);
+  if (remain == 1) {
+    auto compute_addbias =
+        KernelFuncs<VAddBiasTuple<T>, CPUPlace>::Cache().At(n);
+    auto compute_scal = KernelFuncs<VScalTuple<T>, CPUPlace>::Cache().At(n);
+    for (int i = 0; i < bs; ++i) {
+      T scalar = -*std::max_element(x, x + n);
+      compute_addbias(&scalar, x, y, n);
+      SoftmaxClip(y, n);
+      compute_exp(y, y, n);
+      T sum = static_cast<T>(0);
+      for (int k = 0; k < n; ++k) {
+        sum += y[k];
+      }
+      scalar = static_cast<T>(1) / sum;
+      compute_scal(&scalar, y, y, n);
+      x += n;
+      y += n;
+    }
+    return;
+  }
+
+  // softmax along a strided axis: keep one running max and sum per column
+  auto compute_sub = KernelFuncs<VSubTuple<T>, CPUPlace>::Cache().At(remain);
+  auto compute_add = KernelFuncs<VAddTuple<T>, CPUPlace>::Cache().At(remain);
+  auto compute_mul = KernelFuncs<VMulTuple<T>, CPUPlace>::Cache().At(remain);
+  std::vector<T> max_val(remain), sum(remain);
+  for (int i = 0; i < bs; ++i) {
+    std::copy(x, x + remain, max_val.begin());
+    for (int k = 1; k < n; ++k) {
+      const T* px = x + k * remain;
+      for (int j = 0; j < remain; ++j) {
+        max_val[j] = std::max(max_val[j], px[j]);
+      }
+    }
+    for (int k = 0; k < n; ++k) {
+      compute_sub(x + k * remain, max_val.data(), y + k * remain, remain);
+    }
+    SoftmaxClip(y, row_len);
+    compute_exp(y, y, row_len);
+    std::copy(y, y + remain, sum.begin());
+    for (int k = 1; k < n; ++k) {
+      compute_add(y + k * remain, sum.data(), sum.data(), remain);
+    }
+    for (int j = 0; j < remain; ++j) {
+      sum[j] = static_cast<T>(1) / sum[j];
+    }
+    for (int k = 0; k < n; ++k) {
+      compute_mul(y + k * remain, sum.data(), y + k * remain, remain);
+    }
+    x += row_len;
+    y += row_len;
+  }
+}
+
 void (*getActFunc(KernelType type, int d))(const T*, T*, int) {  // NOLINT
   if (type == kVSigmoid) {
     return KernelFuncs<VSigmoidTuple<T>, CPUPlace>::Cache().At(d);
@@ -186,6 +277,10 @@ bool VSigmoidKernel::CanBeUsed(const int& d) const { return true; }
 
 bool VTanhKernel::CanBeUsed(const int& d) const { return true; }
 
+bool VGeluTanhKernel::CanBeUsed(const int& d) const { return true; }
+
+bool SoftmaxKernel::CanBeUsed(const int& d) const { return true; }
+
 bool LSTMCtHtKernel::CanBeUsed(const lstm_attr_t& attr) const { return true; }
 
 bool LSTMC1H1Kernel::CanBeUsed(const lstm_attr_t& attr) const { return true; }
@@ -208,6 +303,8 @@ namespace mix = phi::jit::more::mix;
 
 REGISTER_MORE_KERNEL(VSigmoid);
 REGISTER_MORE_KERNEL(VTanh);
+REGISTER_MORE_KERNEL(VGeluTanh);
+REGISTER_MORE_KERNEL(Softmax);
 REGISTER_MORE_KERNEL(LSTMCtHt);
 REGISTER_MORE_KERNEL(LSTMC1H1);
 REGISTER_MORE_KERNEL(GRUH1);
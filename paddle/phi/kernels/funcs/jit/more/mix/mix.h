@@ -26,6 +26,8 @@ using T = float;
 
 void VSigmoid(const T* x, T* y, int n);
 void VTanh(const T* x, T* y, int n);
+void VGeluTanh(const T* x, T* y, int n);
+void Softmax(const T* x, T* y, int n, int bs, int remain);
 
 void LSTMCtHt(lstm_t* step, const lstm_attr_t* attr);
 void LSTMC1H1(lstm_t* step, const lstm_attr_t* attr);
@@ -44,6 +46,9 @@ void GRUHtPart2(gru_t* step, const gru_attr_t* attr);
 // XYN
 DECLARE_MORE_KERNEL(VSigmoid);
 DECLARE_MORE_KERNEL(VTanh);
+DECLARE_MORE_KERNEL(VGeluTanh);
+
+DECLARE_MORE_KERNEL(Softmax);
 
 // XRN
 DECLARE_MORE_KERNEL(LSTMCtHt);
@@ -124,6 +124,16 @@ void VSquare<double>(const double* x, double* y, int n) {
   phi::dynload::vdSqr(n, x, y);
 }
 
+template <>
+void VErf<float>(const float* x, float* y, int n) {
+  phi::dynload::vmsErf(n, x, y, VML_LA);
+}
+
+template <>
+void VErf<double>(const double* x, double* y, int n) {
+  phi::dynload::vmdErf(n, x, y, VML_LA);
+}
+
 template <>
 void VCopy<float>(const float* x, float* y, int n) {
   phi::dynload::cblas_scopy(n, x, 1, y, 1);
@@ -205,6 +215,11 @@ bool VTanhKernel<float>::CanBeUsed(const int& d) const {
   return d > 7;
 }
 
+template <>
+bool VGeluErfKernel<float>::CanBeUsed(const int& d) const {
+  return d > 7;
+}
+
 template <>
 bool SeqPoolKernel<float>::CanBeUsed(const seq_pool_attr_t& attr) const {
   return true;
@@ -258,6 +273,7 @@ AWALYS_USE_ME_WITH_DOUBLE(VScal);
 AWALYS_USE_ME_WITH_DOUBLE(VExp);
 AWALYS_USE_ME_WITH_DOUBLE(VSigmoid);
 AWALYS_USE_ME_WITH_DOUBLE(VTanh);
+AWALYS_USE_ME_WITH_DOUBLE(VGeluErf);
 AWALYS_USE_ME_WITH_DOUBLE(VSquare);
 AWALYS_USE_ME_WITH_DOUBLE(VCopy);
 
@@ -283,6 +299,7 @@ REGISTER_MKL_KERNEL(VCopy);
 REGISTER_MKL_KERNEL(VBroadcast);
 REGISTER_MKL_KERNEL(VSigmoid);
 REGISTER_MKL_KERNEL(VTanh);
+REGISTER_MKL_KERNEL(VGeluErf);
 REGISTER_MKL_KERNEL(SeqPool);
 REGISTER_MKL_KERNEL(EmbSeqPool);
 REGISTER_MKL_KERNEL(Sgd);
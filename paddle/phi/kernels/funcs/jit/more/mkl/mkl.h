@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <type_traits>
 #include <vector>
@@ -44,6 +45,9 @@ void VExp(const T* x, T* y, int n);
 template <typename T>
 void VSquare(const T* x, T* y, int n);
 
+template <typename T>
+void VErf(const T* x, T* y, int n);
+
 template <typename T>
 void VCopy(const T* x, T* y, int n);
 
@@ -82,6 +86,25 @@ void VTanh(const T* x, T* y, int n) {
   }
 }
 
+template <typename T>
+void VGeluErf(const T* x, T* y, int n) {
+  // erf is computed on a local chunk so that x may alias y
+  constexpr int kBlock = 256;
+  T tmp[kBlock];
+  for (int offset = 0; offset < n; offset += kBlock) {
+    const int len = std::min(kBlock, n - offset);
+    const T* px = x + offset;
+    T* py = y + offset;
+    for (int i = 0; i < len; ++i) {
+      tmp[i] = px[i] * static_cast<T>(M_SQRT1_2);
+    }
+    VErf(tmp, tmp, len);
+    for (int i = 0; i < len; ++i) {
+      py[i] = static_cast<T>(0.5) * px[i] * (static_cast<T>(1) + tmp[i]);
+    }
+  }
+}
+
 template <typename T>
 void SeqPool(const T* x, T* y, const seq_pool_attr_t* attr) {
   VCopy<T>(x, y, attr->w);
@@ -253,6 +276,7 @@ DECLARE_MKL_KERNEL(VScal);
 DECLARE_MKL_KERNEL(VExp);
 DECLARE_MKL_KERNEL(VSigmoid);
 DECLARE_MKL_KERNEL(VTanh);
+DECLARE_MKL_KERNEL(VGeluErf);
 DECLARE_MKL_KERNEL(VSquare);
 DECLARE_MKL_KERNEL(VCopy);
 
@@ -37,6 +37,8 @@ REGISTER_REFER_KERNEL(VSquare);
 REGISTER_REFER_KERNEL(VExp);
 REGISTER_REFER_KERNEL(VSigmoid);
 REGISTER_REFER_KERNEL(VTanh);
+REGISTER_REFER_KERNEL(VGeluErf);
+REGISTER_REFER_KERNEL(VGeluTanh);
 
 REGISTER_REFER_KERNEL(LSTMCtHt);
 REGISTER_REFER_KERNEL(LSTMC1H1);
@@ -49,6 +51,7 @@ REGISTER_REFER_KERNEL(CRFDecoding);
 REGISTER_REFER_KERNEL(LayerNorm);
 REGISTER_REFER_KERNEL(SeqPool);
 REGISTER_REFER_KERNEL(MatMul);
+REGISTER_REFER_KERNEL(Softmax);
 REGISTER_REFER_KERNEL(EmbSeqPool);
 REGISTER_REFER_KERNEL(Adam);
 REGISTER_REFER_KERNEL(AdamW);
@@ -56,3 +59,6 @@ REGISTER_REFER_KERNEL(Sgd);
 REGISTER_REFER_KERNEL(VBroadcast);
 
 #undef REGISTER_REFER_KERNEL
+
+// bfloat16 weights are only paired with float activations
+REGISTER_JITKERNEL_REFER(kMatMulBF16, refer::MatMulBF16Kernel<float>);
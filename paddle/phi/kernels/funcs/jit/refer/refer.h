@@ -135,6 +135,25 @@ void VTanh(const T* x, T* y, int n) {
   }
 }
 
+// y = 0.5 * x * (1 + erf(x / sqrt(2)))
+template <typename T>
+void VGeluErf(const T* x, T* y, int n) {
+  for (int i = 0; i < n; ++i) {
+    T tmp = static_cast<T>(std::erf(x[i] * static_cast<T>(M_SQRT1_2)));
+    y[i] = x[i] * static_cast<T>(0.5) * (static_cast<T>(1) + tmp);
+  }
+}
+
+// y = 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+template <typename T>
+void VGeluTanh(const T* x, T* y, int n) {
+  for (int i = 0; i < n; ++i) {
+    T tmp = static_cast<T>(M_2_SQRTPI * M_SQRT1_2) *
+            (x[i] + static_cast<T>(0.044715) * x[i] * x[i] * x[i]);
+    y[i] = x[i] * static_cast<T>(0.5) * (static_cast<T>(1) + std::tanh(tmp));
+  }
+}
+
 template <typename T>
 void (*getActFunc(KernelType type))(const T*, T*, int) {  // NOLINT
   if (type == kVSigmoid) {
@@ -394,6 +413,66 @@ void MatMul(const T* A, const T* B, T* C, const matmul_attr_t* attr) {
   }
 }
 
+inline float BF16ToFloat(uint16_t x) {
+  uint32_t bits = static_cast<uint32_t>(x) << 16;
+  float res;
+  std::memcpy(&res, &bits, sizeof(res));
+  return res;
+}
+
+// A(M,K) * B(K,N) = C(M,N), B holds bfloat16 bits
+template <typename T>
+void MatMulBF16(const T* A,
+                const uint16_t* B,
+                T* C,
+                const matmul_attr_t* attr) {
+  int M = attr->m;
+  int N = attr->n;
+  int K = attr->k;
+  for (int m = 0; m < M; ++m) {
+    const T* pa = A + m * K;
+    T* pc = C + m * N;
+    for (int n = 0; n < N; ++n) {
+      pc[n] = static_cast<T>(0);
+    }
+    for (int k = 0; k < K; ++k) {
+      const uint16_t* pb = B + k * N;
+      for (int n = 0; n < N; ++n) {
+        pc[n] += pa[k] * static_cast<T>(BF16ToFloat(pb[n]));
+      }
+    }
+  }
+}
+
+// x and y are (bs, n, remain), softmax is computed along n. The shifted
+// logits are clipped at -64 before exp, as in SoftmaxEigen.
+template <typename T>
+void Softmax(const T* x, T* y, int n, int bs, int remain) {
+  const T threshold = static_cast<T>(-64);
+  for (int i = 0; i < bs; ++i) {
+    for (int j = 0; j < remain; ++j) {
+      const T* px = x + j;
+      T* py = y + j;
+      T max_val = px[0];
+      for (int k = 1; k < n; ++k) {
+        max_val = px[k * remain] > max_val ? px[k * remain] : max_val;
+      }
+      T sum = static_cast<T>(0);
+      for (int k = 0; k < n; ++k) {
+        T shifted = px[k * remain] - max_val;
+        py[k * remain] = std::exp(shifted < threshold ? threshold : shifted);
+        sum += py[k * remain];
+      }
+      T scalar = static_cast<T>(1) / sum;
+      for (int k = 0; k < n; ++k) {
+        py[k * remain] *= scalar;
+      }
+    }
+    x += n * remain;
+    y += n * remain;
+  }
+}
+
 // embedding seq pool
 // table is a matrix with (tbl_h, tbl_w)
 // idx is a matrix with (idx_h, idx_w)
@@ -587,6 +666,8 @@ DECLARE_REFER_KERNEL(VSigmoid);
 DECLARE_REFER_KERNEL(VTanh);
 DECLARE_REFER_KERNEL(VSquare);
 DECLARE_REFER_KERNEL(VCopy);
+DECLARE_REFER_KERNEL(VGeluErf);
+DECLARE_REFER_KERNEL(VGeluTanh);
 
 // lstm_t*, const lstm_attr_t*
 DECLARE_REFER_KERNEL(LSTMCtHt);
@@ -602,6 +683,8 @@ DECLARE_REFER_KERNEL(CRFDecoding);
 DECLARE_REFER_KERNEL(LayerNorm);
 DECLARE_REFER_KERNEL(SeqPool);
 DECLARE_REFER_KERNEL(MatMul);
+DECLARE_REFER_KERNEL(MatMulBF16);
+DECLARE_REFER_KERNEL(Softmax);
 DECLARE_REFER_KERNEL(EmbSeqPool);
 DECLARE_REFER_KERNEL(Adam);
 DECLARE_REFER_KERNEL(AdamW);
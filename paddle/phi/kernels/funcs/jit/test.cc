@@ -12,6 +12,9 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <random>
 
@@ -687,6 +690,103 @@ void TestKernelMatMul() {
   FLAGS_acc = last_acc;
 }
 
+template <typename KernelTuple, typename PlaceType>
+void TestKernelMatMulBF16() {
+  using T = typename KernelTuple::data_type;
+  VLOG(10) << "Test JITKernel: " << jit::to_string(KernelTuple::kernel_type);
+  auto last_acc = FLAGS_acc;
+  FLAGS_acc = 1e-3;
+  for (int n : {1, 15, 16, 32, 48, 160}) {
+    for (int k : TestSizes()) {
+      auto ref = jit::GetReferFunc<KernelTuple>();
+      EXPECT_TRUE(ref != nullptr);
+      std::vector<T> a(k), c(n), b_fp32(k * n);
+      std::vector<uint16_t> b(k * n);
+      RandomVec<T>(k, a.data());
+      RandomVec<T>(k * n, b_fp32.data());
+      for (int i = 0; i < k * n; ++i) {
+        float f = static_cast<float>(b_fp32[i]);
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        b[i] = static_cast<uint16_t>(bits >> 16);
+      }
+      const jit::matmul_attr_t attr{1, n, k};
+      ref(a.data(), b.data(), c.data(), &attr);
+      auto verifier = [](const typename KernelTuple::func_type tgt,
+                         const std::vector<T>& a,
+                         const std::vector<uint16_t>& b,
+                         const std::vector<T>& cref,
+                         const typename KernelTuple::attr_type& attr) {
+        EXPECT_TRUE(tgt != nullptr);
+        std::vector<T> c(cref.size());
+        tgt(a.data(), b.data(), c.data(), &attr);
+        ExpectEQ<T>(c.data(), cref.data(), attr.n);
+      };
+      TestAllImpls<KernelTuple, PlaceType>(attr, verifier, a, b, c, attr);
+    }
+  }
+  FLAGS_acc = last_acc;
+}
+
+template <typename KernelTuple, typename PlaceType>
+void TestKernelSoftmax() {
+  using T = typename KernelTuple::data_type;
+  VLOG(10) << "Test JITKernel: " << jit::to_string(KernelTuple::kernel_type);
+  for (int bs : {1, 2, 10}) {
+    for (int n : TestSizes()) {
+      for (int remain : {1, 2, 3}) {
+        auto ref = jit::GetReferFunc<KernelTuple>();
+        EXPECT_TRUE(ref != nullptr);
+        const int sz = bs * n * remain;
+        std::vector<T> x(sz), yref(sz);
+        RandomVec<T>(sz, x.data());
+        ref(x.data(), yref.data(), n, bs, remain);
+        // each column along n should sum to one
+        for (int i = 0; i < bs; ++i) {
+          for (int j = 0; j < remain; ++j) {
+            T sum = static_cast<T>(0);
+            for (int k = 0; k < n; ++k) {
+              sum += yref[i * n * remain + k * remain + j];
+            }
+            EXPECT_NEAR(sum, static_cast<T>(1), FLAGS_acc);
+          }
+        }
+        auto verifier = [](const typename KernelTuple::func_type tgt,
+                           const std::vector<T>& x,
+                           const std::vector<T>& yref,
+                           int n,
+                           int bs,
+                           int remain) {
+          EXPECT_TRUE(tgt != nullptr);
+          std::vector<T> ytgt(yref.size());
+          // test normal
+          tgt(x.data(), ytgt.data(), n, bs, remain);
+          ExpectEQ<T>(ytgt.data(), yref.data(), yref.size());
+          // test inplace x
+          std::copy(x.begin(), x.end(), ytgt.begin());
+          tgt(ytgt.data(), ytgt.data(), n, bs, remain);
+          ExpectEQ<T>(ytgt.data(), yref.data(), yref.size());
+        };
+        TestAllImpls<KernelTuple, PlaceType>(
+            n, verifier, x, yref, n, bs, remain);
+      }
+    }
+  }
+  // The shifted logits are clipped at -64 before exp.
+  const T clipped = std::exp(static_cast<T>(-64));
+  const T expected = clipped / (static_cast<T>(1) + clipped);
+  for (int remain : {1, 2}) {
+    std::vector<T> x(2 * remain, static_cast<T>(0)), y(2 * remain);
+    std::fill(x.begin() + remain, x.end(), static_cast<T>(-100));
+    auto ref = jit::GetReferFunc<KernelTuple>();
+    ref(x.data(), y.data(), 2, 1, remain);
+    EXPECT_NEAR(y[remain] / expected, static_cast<T>(1), FLAGS_acc);
+    auto tgt = jit::KernelFuncs<KernelTuple, PlaceType>::Cache().At(2);
+    tgt(x.data(), y.data(), 2, 1, remain);
+    EXPECT_NEAR(y[remain] / expected, static_cast<T>(1), FLAGS_acc);
+  }
+}
+
 template <typename KernelTuple, typename PlaceType>
 void TestKernelAdam() {
   using T = typename KernelTuple::data_type;
@@ -1417,6 +1517,8 @@ TEST(JITKernel_key, sgd) {
 #define TestKernelVSigmoid TestKernelXYN
 #define TestKernelVTanh TestKernelXYN
 #define TestKernelVCopy TestKernelXYN
+#define TestKernelVGeluErf TestKernelXYN
+#define TestKernelVGeluTanh TestKernelXYN
 
 #define TestKernelLSTMCtHt TestKernelLSTM
 #define TestKernelLSTMC1H1 TestKernelLSTM
@@ -1446,6 +1548,8 @@ TEST_CPU_KERNEL(VExp);
 TEST_CPU_KERNEL(VSigmoid);
 TEST_CPU_KERNEL(VTanh);
 TEST_CPU_KERNEL(VCopy);
+TEST_CPU_KERNEL(VGeluErf);
+TEST_CPU_KERNEL(VGeluTanh);
 
 TEST_CPU_KERNEL(LSTMCtHt);
 TEST_CPU_KERNEL(LSTMC1H1);
@@ -1460,7 +1564,13 @@ TEST_CPU_KERNEL(CRFDecoding);
 TEST_CPU_KERNEL(SeqPool);
 TEST_CPU_KERNEL(EmbSeqPool);
 TEST_CPU_KERNEL(MatMul);
+TEST_CPU_KERNEL(Softmax);
 TEST_CPU_KERNEL(Adam);
 TEST_CPU_KERNEL(AdamW);
 TEST_CPU_KERNEL(Sgd);
 TEST_CPU_KERNEL(VBroadcast);
+
+// bfloat16 weights are only paired with float activations
+TEST(JITKernel, MatMulBF16) {
+  TestKernelMatMulBF16<jit::MatMulBF16Tuple<float>, CPUPlace>();
+}
@@ -67,55 +67,13 @@ template struct SetConstant<phi::XPUContext, phi::dtype::complex<double>>;
 
 #endif
 
-#define DEFINE_CPU_TRANS(RANK)                                            \
-  template struct Transpose<phi::CPUContext, phi::dtype::float16, RANK>;  \
-  template struct Transpose<phi::CPUContext, phi::dtype::bfloat16, RANK>; \
-  template struct Transpose<phi::CPUContext, float, RANK>;                \
-  template struct Transpose<phi::CPUContext, double, RANK>;               \
-  template struct Transpose<phi::CPUContext, int, RANK>;                  \
-  template struct Transpose<phi::CPUContext, int64_t, RANK>;              \
-  template struct Transpose<phi::CPUContext, bool, RANK>;                 \
-  template struct Transpose<phi::CPUContext, int16_t, RANK>;              \
-  template struct Transpose<phi::CPUContext, uint8_t, RANK>;              \
-  template struct Transpose<phi::CPUContext, int8_t, RANK>;               \
-  template struct Transpose<phi::CPUContext,                              \
-                            phi::dtype::complex<float>,                   \
-                            RANK>;                                        \
-  template struct Transpose<phi::CPUContext, phi::dtype::complex<double>, RANK>;
-
-DEFINE_CPU_TRANS(1);
-DEFINE_CPU_TRANS(2);
-DEFINE_CPU_TRANS(3);
-DEFINE_CPU_TRANS(4);
-DEFINE_CPU_TRANS(5);
-DEFINE_CPU_TRANS(6);
-
 template <typename DeviceContext, typename T>
 void TransposeNormal<DeviceContext, T>::operator()(
     const DeviceContext& context UNUSED,
     const phi::DenseTensor& in,
     phi::DenseTensor* out,
     const std::vector<int>& axis) {
-  const int rank = axis.size();
-  auto in_stride = phi::stride(in.dims());
-  auto out_stride = phi::stride(out->dims());
-  const T* in_ptr = in.data<T>();
-  T* out_ptr = out->data<T>();
-
-  auto transpose_helper = [&](int64_t beg, int64_t end) {
-    for (int64_t out_idx = beg; out_idx < end; ++out_idx) {
-      int64_t in_idx = 0;
-      int64_t tmp_idx = out_idx;
-      // calculate the input index
-      for (int i = 0; i < rank; ++i) {
-        const int64_t coordinate = tmp_idx / out_stride[i];
-        tmp_idx -= coordinate * out_stride[i];
-        in_idx += coordinate * in_stride[axis[i]];
-      }
-      out_ptr[out_idx] = in_ptr[in_idx];
-    }
-  };
-  transpose_helper(0, out->numel());
+  TransposeCPU<T>(in, out, axis);
 }
 
 // define transpose normal
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/phi/common/memory_utils.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/utils/data_type.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
 
 namespace phi {
 namespace funcs {
@@ -51,6 +52,17 @@ struct Transpose {
                   const std::vector<int>& axis);
 };
 
+// The transposes of any rank on CPU, see cpu_transpose.h.
+template <typename T, int Rank>
+struct Transpose<phi::CPUContext, T, Rank> {
+  void operator()(const phi::CPUContext& context,
+                  const phi::DenseTensor& in,
+                  phi::DenseTensor* out,
+                  const std::vector<int>& axis) {
+    TransposeCPU<T>(in, out, axis);
+  }
+};
+
 template <typename DeviceContext, typename T>
 struct SetConstant {
   void operator()(const DeviceContext& context,
@@ -16,18 +16,391 @@ limitations under the License. */
 
 #include <algorithm>
 #include <vector>
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
 
 namespace phi {
 namespace funcs {
 
+namespace {
+
+// The fewest input elements worth a thread of their own.
+constexpr int64_t kMinPoolWorkPerThread = 64 * 1024;
+// The channels of NHWC the backward passes hand to a thread at a time.
+constexpr int kPoolChannelBlock = 64;
+
+int PoolThreads(int64_t work) {
+#ifdef PADDLE_WITH_MKLML
+  return static_cast<int>(std::max<int64_t>(
+      1,
+      std::min<int64_t>(omp_get_max_threads(),
+                        work / kMinPoolWorkPerThread)));
+#else
+  return 1;
+#endif
+}
+
+struct Pool2dShape {
+  Pool2dShape(const DenseTensor& input,
+              const DDim& output_dims,
+              const std::vector<int>& ksize,
+              const std::vector<int>& strides,
+              const std::vector<int>& paddings,
+              bool channel_last)
+      : channel_last(channel_last) {
+    const auto& in = input.dims();
+    batch_size = static_cast<int>(in[0]);
+    channels = static_cast<int>(channel_last ? output_dims[3] : output_dims[1]);
+    input_height = static_cast<int>(channel_last ? in[1] : in[2]);
+    input_width = static_cast<int>(channel_last ? in[2] : in[3]);
+    output_height =
+        static_cast<int>(channel_last ? output_dims[1] : output_dims[2]);
+    output_width =
+        static_cast<int>(channel_last ? output_dims[2] : output_dims[3]);
+    ksize_height = ksize[0];
+    ksize_width = ksize[1];
+    stride_height = strides[0];
+    stride_width = strides[1];
+    padding_height = paddings[0];
+    padding_width = paddings[1];
+  }
+
+  int64_t input_numel() const {
+    return static_cast<int64_t>(batch_size) * channels * input_height *
+           input_width;
+  }
+
+  bool channel_last;
+  int batch_size;
+  int channels;
+  int input_height;
+  int input_width;
+  int output_height;
+  int output_width;
+  int ksize_height;
+  int ksize_width;
+  int stride_height;
+  int stride_width;
+  int padding_height;
+  int padding_width;
+};
+
+// The input pixels [hstart, hend) x [wstart, wend) pooled into the output
+// pixel (ph, pw), and the count their average is divided by.
+struct PoolWindow {
+  int hstart;
+  int hend;
+  int wstart;
+  int wend;
+  int pool_size;
+};
+
+inline PoolWindow GetPoolWindow(
+    const Pool2dShape& s, int ph, int pw, bool exclusive, bool adaptive) {
+  PoolWindow win;
+  if (adaptive) {
+    win.hstart = AdaptStartIndex(ph, s.input_height, s.output_height);
+    win.hend = AdaptEndIndex(ph, s.input_height, s.output_height);
+    win.wstart = AdaptStartIndex(pw, s.input_width, s.output_width);
+    win.wend = AdaptEndIndex(pw, s.input_width, s.output_width);
+  } else {
+    win.hstart = ph * s.stride_height - s.padding_height;
+    win.wstart = pw * s.stride_width - s.padding_width;
+    win.hend = std::min(win.hstart + s.ksize_height,
+                        s.input_height + s.padding_height);
+    win.wend =
+        std::min(win.wstart + s.ksize_width, s.input_width + s.padding_width);
+    win.pool_size = (win.hend - win.hstart) * (win.wend - win.wstart);
+    win.hstart = std::max(win.hstart, 0);
+    win.wstart = std::max(win.wstart, 0);
+    win.hend = std::min(win.hend, s.input_height);
+    win.wend = std::min(win.wend, s.input_width);
+  }
+  if (exclusive || adaptive) {
+    win.pool_size = (win.hend - win.hstart) * (win.wend - win.wstart);
+  }
+  return win;
+}
+
+// NCHW, a plane of the batch and the channels at a time.
+template <typename PoolProcess, typename T>
+void Pool2dNCHW(const Pool2dShape& s,
+                const T* input_data,
+                T* output_data,
+                bool exclusive,
+                bool adaptive,
+                PoolProcess pool_process) {
+  const int64_t num_planes = static_cast<int64_t>(s.batch_size) * s.channels;
+  const int64_t input_stride = s.input_height * s.input_width;
+  const int64_t output_stride = s.output_height * s.output_width;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(PoolThreads(s.input_numel())) \
+    firstprivate(pool_process)
+#endif
+  for (int64_t i = 0; i < num_planes; ++i) {
+    const T* in = input_data + i * input_stride;
+    T* out = output_data + i * output_stride;
+    for (int ph = 0; ph < s.output_height; ++ph) {
+      for (int pw = 0; pw < s.output_width; ++pw) {
+        const PoolWindow win = GetPoolWindow(s, ph, pw, exclusive, adaptive);
+        T ele = pool_process.initial();
+        for (int h = win.hstart; h < win.hend; ++h) {
+          for (int w = win.wstart; w < win.wend; ++w) {
+            pool_process.compute(in[h * s.input_width + w], &ele);
+          }
+        }
+        pool_process.finalize(static_cast<T>(win.pool_size), &ele);
+        out[ph * s.output_width + pw] = ele;
+      }
+    }
+  }
+}
+
+// NHWC, an output row of a sample at a time, pooling all the channels of a
+// pixel at once so that the inner loops run over contiguous channels.
+template <typename PoolProcess, typename T>
+void Pool2dNHWC(const Pool2dShape& s,
+                const T* input_data,
+                T* output_data,
+                bool exclusive,
+                bool adaptive,
+                PoolProcess pool_process) {
+  const int64_t num_rows = static_cast<int64_t>(s.batch_size) * s.output_height;
+  const int channels = s.channels;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(PoolThreads(s.input_numel()))
+#endif
+  for (int64_t row = 0; row < num_rows; ++row) {
+    const int64_t n = row / s.output_height;
+    const int ph = static_cast<int>(row % s.output_height);
+    const T* in = input_data + n * s.input_height * s.input_width * channels;
+    T* out = output_data + row * s.output_width * channels;
+    std::vector<PoolProcess> processes(channels, pool_process);
+    std::vector<T> values(channels);
+    for (int pw = 0; pw < s.output_width; ++pw) {
+      const PoolWindow win = GetPoolWindow(s, ph, pw, exclusive, adaptive);
+      for (int c = 0; c < channels; ++c) {
+        values[c] = processes[c].initial();
+      }
+      for (int h = win.hstart; h < win.hend; ++h) {
+        for (int w = win.wstart; w < win.wend; ++w) {
+          const T* pixel = in + (h * s.input_width + w) * channels;
+          for (int c = 0; c < channels; ++c) {
+            processes[c].compute(pixel[c], &values[c]);
+          }
+        }
+      }
+      T* out_pixel = out + pw * channels;
+      for (int c = 0; c < channels; ++c) {
+        processes[c].finalize(static_cast<T>(win.pool_size), &values[c]);
+        out_pixel[c] = values[c];
+      }
+    }
+  }
+}
+
+// The windows of neighbouring output pixels overlap, so the backward passes
+// are split over the planes of NCHW and the channel blocks of NHWC, which
+// are written by one thread each.
+template <typename PoolProcess, typename T>
+void Pool2dGradNCHW(const Pool2dShape& s,
+                    const T* input_data,
+                    const T* output_data,
+                    const T* output_grad_data,
+                    T* input_grad_data,
+                    bool exclusive,
+                    bool adaptive,
+                    PoolProcess pool_grad_process) {
+  const int64_t num_planes = static_cast<int64_t>(s.batch_size) * s.channels;
+  const int64_t input_stride = s.input_height * s.input_width;
+  const int64_t output_stride = s.output_height * s.output_width;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(PoolThreads(s.input_numel())) \
+    firstprivate(pool_grad_process)
+#endif
+  for (int64_t i = 0; i < num_planes; ++i) {
+    const T* in = input_data + i * input_stride;
+    const T* out = output_data + i * output_stride;
+    const T* out_grad = output_grad_data + i * output_stride;
+    T* in_grad = input_grad_data + i * input_stride;
+    for (int ph = 0; ph < s.output_height; ++ph) {
+      for (int pw = 0; pw < s.output_width; ++pw) {
+        const PoolWindow win = GetPoolWindow(s, ph, pw, exclusive, adaptive);
+        const int output_idx = ph * s.output_width + pw;
+        float scale = 1.0 / win.pool_size;
+        for (int h = win.hstart; h < win.hend; ++h) {
+          for (int w = win.wstart; w < win.wend; ++w) {
+            const int input_idx = h * s.input_width + w;
+            pool_grad_process.compute(in[input_idx],
+                                      out[output_idx],
+                                      out_grad[output_idx],
+                                      static_cast<T>(scale),
+                                      in_grad + input_idx);
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename PoolProcess, typename T>
+void Pool2dGradNHWC(const Pool2dShape& s,
+                    const T* input_data,
+                    const T* output_data,
+                    const T* output_grad_data,
+                    T* input_grad_data,
+                    bool exclusive,
+                    bool adaptive,
+                    PoolProcess pool_grad_process) {
+  const int channels = s.channels;
+  const int num_blocks = (channels + kPoolChannelBlock - 1) / kPoolChannelBlock;
+  const int64_t num_tasks = static_cast<int64_t>(s.batch_size) * num_blocks;
+  const int64_t input_stride =
+      static_cast<int64_t>(s.input_height) * s.input_width * channels;
+  const int64_t output_stride =
+      static_cast<int64_t>(s.output_height) * s.output_width * channels;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(PoolThreads(s.input_numel())) \
+    firstprivate(pool_grad_process)
+#endif
+  for (int64_t task = 0; task < num_tasks; ++task) {
+    const int64_t n = task / num_blocks;
+    const int c_begin = static_cast<int>(task % num_blocks) * kPoolChannelBlock;
+    const int c_end = std::min(channels, c_begin + kPoolChannelBlock);
+    const T* in = input_data + n * input_stride;
+    const T* out = output_data + n * output_stride;
+    const T* out_grad = output_grad_data + n * output_stride;
+    T* in_grad = input_grad_data + n * input_stride;
+    for (int ph = 0; ph < s.output_height; ++ph) {
+      for (int pw = 0; pw < s.output_width; ++pw) {
+        const PoolWindow win = GetPoolWindow(s, ph, pw, exclusive, adaptive);
+        const int64_t output_idx =
+            (static_cast<int64_t>(ph) * s.output_width + pw) * channels;
+        const T scale = static_cast<T>(static_cast<float>(1.0 / win.pool_size));
+        for (int h = win.hstart; h < win.hend; ++h) {
+          for (int w = win.wstart; w < win.wend; ++w) {
+            const int64_t input_idx =
+                (static_cast<int64_t>(h) * s.input_width + w) * channels;
+            for (int c = c_begin; c < c_end; ++c) {
+              pool_grad_process.compute(in[input_idx + c],
+                                        out[output_idx + c],
+                                        out_grad[output_idx + c],
+                                        scale,
+                                        in_grad + input_idx + c);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// The gradient of max pooling goes to the first input of each window equal
+// to the output.
+template <typename T>
+void MaxPool2dGradNCHW(const Pool2dShape& s,
+                       const T* input_data,
+                       const T* output_data,
+                       const T* output_grad_data,
+                       T* input_grad_data) {
+  const int64_t num_planes = static_cast<int64_t>(s.batch_size) * s.channels;
+  const int64_t input_stride = s.input_height * s.input_width;
+  const int64_t output_stride = s.output_height * s.output_width;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(PoolThreads(s.input_numel()))
+#endif
+  for (int64_t i = 0; i < num_planes; ++i) {
+    const T* in = input_data + i * input_stride;
+    const T* out = output_data + i * output_stride;
+    const T* out_grad = output_grad_data + i * output_stride;
+    T* in_grad = input_grad_data + i * input_stride;
+    for (int ph = 0; ph < s.output_height; ++ph) {
+      for (int pw = 0; pw < s.output_width; ++pw) {
+        const PoolWindow win = GetPoolWindow(s, ph, pw, true, false);
+        const int output_idx = ph * s.output_width + pw;
+        bool stop = false;
+        for (int h = win.hstart; h < win.hend && !stop; ++h) {
+          for (int w = win.wstart; w < win.wend && !stop; ++w) {
+            const int input_idx = h * s.input_width + w;
+            if (in[input_idx] == out[output_idx]) {
+              in_grad[input_idx] += out_grad[output_idx];
+              stop = true;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void MaxPool2dGradNHWC(const Pool2dShape& s,
+                       const T* input_data,
+                       const T* output_data,
+                       const T* output_grad_data,
+                       T* input_grad_data) {
+  const int channels = s.channels;
+  const int num_blocks = (channels + kPoolChannelBlock - 1) / kPoolChannelBlock;
+  const int64_t num_tasks = static_cast<int64_t>(s.batch_size) * num_blocks;
+  const int64_t input_stride =
+      static_cast<int64_t>(s.input_height) * s.input_width * channels;
+  const int64_t output_stride =
+      static_cast<int64_t>(s.output_height) * s.output_width * channels;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(PoolThreads(s.input_numel()))
+#endif
+  for (int64_t task = 0; task < num_tasks; ++task) {
+    const int64_t n = task / num_blocks;
+    const int c_begin = static_cast<int>(task % num_blocks) * kPoolChannelBlock;
+    const int c_end = std::min(channels, c_begin + kPoolChannelBlock);
+    const T* in = input_data + n * input_stride;
+    const T* out = output_data + n * output_stride;
+    const T* out_grad = output_grad_data + n * output_stride;
+    T* in_grad = input_grad_data + n * input_stride;
+    // Whether the maximum of each channel has been found, branchless so that
+    // the channels are vectorized.
+    uint8_t found[kPoolChannelBlock];
+    for (int ph = 0; ph < s.output_height; ++ph) {
+      for (int pw = 0; pw < s.output_width; ++pw) {
+        const PoolWindow win = GetPoolWindow(s, ph, pw, true, false);
+        const int64_t output_idx =
+            (static_cast<int64_t>(ph) * s.output_width + pw) * channels +
+            c_begin;
+        const int num_channels = c_end - c_begin;
+        std::fill(found, found + num_channels, 0);
+        for (int h = win.hstart; h < win.hend; ++h) {
+          for (int w = win.wstart; w < win.wend; ++w) {
+            const int64_t input_idx =
+                (static_cast<int64_t>(h) * s.input_width + w) * channels +
+                c_begin;
+            for (int c = 0; c < num_channels; ++c) {
+              const uint8_t match = in[input_idx + c] == out[output_idx + c];
+              const uint8_t take = match & (found[c] ^ 1);
+              in_grad[input_idx + c] +=
+                  take ? out_grad[output_idx + c] : static_cast<T>(0);
+              found[c] |= match;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
 /*
  * Tensors are in NCHW or NHWC format.
  * Ksize, strides are two elements. These two elements represent height
  * and width, respectively.
  * Paddings are four elements. These four elements represent height_up,
  * height_down, width_left and width_right, respectively.
+ *
+ * NCHW is pooled a plane at a time, NHWC an output row at a time with the
+ * channels of a pixel pooled together, both in parallel.
  */
 template <typename PoolProcess, typename T>
 class Pool2dFunctor<CPUContext, PoolProcess, T> {
@@ -41,72 +414,16 @@ class Pool2dFunctor<CPUContext, PoolProcess, T> {
                   bool adaptive,
                   DenseTensor* output,
                   PoolProcess pool_process) {
-    const int batch_size = input.dims()[0];
-    const int input_height = input.dims()[2];
-    const int input_width = input.dims()[3];
-    const int output_channels = output->dims()[1];
-    const int output_height = output->dims()[2];
-    const int output_width = output->dims()[3];
-    const int ksize_height = ksize[0];
-    const int ksize_width = ksize[1];
-    const int stride_height = strides[0];
-    const int stride_width = strides[1];
-    const int padding_height = paddings[0];
-    const int padding_width = paddings[1];
-
-    const int input_stride = input_height * input_width;
-    const int output_stride = output_height * output_width;
-
-    const T* input_data = input.data<T>();
-    T* output_data = context.template Alloc<T>(output);
-
-    int hstart = 0, hend = 1;
-    int wstart = 0, wend = 1;
-    for (int i = 0; i < batch_size; i++) {
-      for (int c = 0; c < output_channels; ++c) {
-        for (int ph = 0; ph < output_height; ++ph) {
-          if (adaptive) {
-            hstart = AdaptStartIndex(ph, input_height, output_height);
-            hend = AdaptEndIndex(ph, input_height, output_height);
-          }
-          for (int pw = 0; pw < output_width; ++pw) {
-            int pool_size = 1;
-            if (adaptive) {
-              wstart = AdaptStartIndex(pw, input_width, output_width);
-              wend = AdaptEndIndex(pw, input_width, output_width);
-            } else {
-              hstart = ph * stride_height - padding_height;
-              wstart = pw * stride_width - padding_width;
-              hend = std::min(hstart + ksize_height,
-                              input_height + padding_height);
-              wend =
-                  std::min(wstart + ksize_width, input_width + padding_width);
-              pool_size = (hend - hstart) * (wend - wstart);
-
-              wstart = std::max(wstart, 0);
-              hstart = std::max(hstart, 0);
-              hend = std::min(hend, input_height);
-              wend = std::min(wend, input_width);
-            }
-
-            T ele = pool_process.initial();
-            for (int h = hstart; h < hend; ++h) {
-              for (int w = wstart; w < wend; ++w) {
-                pool_process.compute(input_data[h * input_width + w], &ele);
-              }
-            }
-            if (exclusive || adaptive) {
-              pool_size = (hend - hstart) * (wend - wstart);
-            }
-
-            pool_process.finalize(static_cast<T>(pool_size), &ele);
-            output_data[ph * output_width + pw] = ele;
-          }
-        }
-        input_data += input_stride;
-        output_data += output_stride;
-      }
-    }
+    (*this)(context,
+            input,
+            ksize,
+            strides,
+            paddings,
+            "NCHW",
+            exclusive,
+            adaptive,
+            output,
+            pool_process);
   }
 
   void operator()(const CPUContext& context,
@@ -119,131 +436,16 @@ class Pool2dFunctor<CPUContext, PoolProcess, T> {
                   bool adaptive,
                   DenseTensor* output,
                   PoolProcess pool_process) {
-    bool channel_last = (data_format == "NHWC");
-
-    const int batch_size = input.dims()[0];
-    const int input_channels = channel_last ? input.dims()[3] : input.dims()[1];
-    const int input_height = channel_last ? input.dims()[1] : input.dims()[2];
-    const int input_width = channel_last ? input.dims()[2] : input.dims()[3];
-
-    const int output_channels =
-        channel_last ? output->dims()[3] : output->dims()[1];
-    const int output_height =
-        channel_last ? output->dims()[1] : output->dims()[2];
-    const int output_width =
-        channel_last ? output->dims()[2] : output->dims()[3];
-
-    const int ksize_height = ksize[0];
-    const int ksize_width = ksize[1];
-
-    const int stride_height = strides[0];
-    const int stride_width = strides[1];
-
-    const int padding_height = paddings[0];
-    const int padding_width = paddings[1];
-
+    const Pool2dShape shape(
+        input, output->dims(), ksize, strides, paddings, data_format == "NHWC");
     const T* input_data = input.data<T>();
     T* output_data = context.template Alloc<T>(output);
-
-    int hstart = 0, hend = 1;
-    int wstart = 0, wend = 1;
-    if (!channel_last) {
-      const int input_stride = input_height * input_width;
-      const int output_stride = output_height * output_width;
-      for (int i = 0; i < batch_size; i++) {
-        for (int c = 0; c < output_channels; ++c) {
-          for (int ph = 0; ph < output_height; ++ph) {
-            if (adaptive) {
-              hstart = AdaptStartIndex(ph, input_height, output_height);
-              hend = AdaptEndIndex(ph, input_height, output_height);
-            }
-            for (int pw = 0; pw < output_width; ++pw) {
-              int pool_size = 1;
-              if (adaptive) {
-                wstart = AdaptStartIndex(pw, input_width, output_width);
-                wend = AdaptEndIndex(pw, input_width, output_width);
-              } else {
-                hstart = ph * stride_height - padding_height;
-                wstart = pw * stride_width - padding_width;
-                hend = std::min(hstart + ksize_height,
-                                input_height + padding_height);
-                wend =
-                    std::min(wstart + ksize_width, input_width + padding_width);
-                pool_size = (hend - hstart) * (wend - wstart);
-
-                wstart = std::max(wstart, 0);
-                hstart = std::max(hstart, 0);
-                hend = std::min(hend, input_height);
-                wend = std::min(wend, input_width);
-              }
-
-              T ele = pool_process.initial();
-              for (int h = hstart; h < hend; ++h) {
-                for (int w = wstart; w < wend; ++w) {
-                  pool_process.compute(input_data[h * input_width + w], &ele);
-                }
-              }
-              if (exclusive || adaptive) {
-                pool_size = (hend - hstart) * (wend - wstart);
-              }
-              pool_process.finalize(static_cast<T>(pool_size), &ele);
-              output_data[ph * output_width + pw] = ele;
-            }
-          }
-          input_data += input_stride;
-          output_data += output_stride;
-        }
-      }
+    if (shape.channel_last) {
+      Pool2dNHWC(
+          shape, input_data, output_data, exclusive, adaptive, pool_process);
     } else {
-      const int input_stride = input_height * input_width * input_channels;
-      const int output_stride = output_height * output_width * output_channels;
-      for (int i = 0; i < batch_size; i++) {
-        for (int c = 0; c < output_channels; ++c) {
-          for (int ph = 0; ph < output_height; ++ph) {
-            if (adaptive) {
-              hstart = AdaptStartIndex(ph, input_height, output_height);
-              hend = AdaptEndIndex(ph, input_height, output_height);
-            }
-            for (int pw = 0; pw < output_width; ++pw) {
-              int pool_size = 1;
-              if (adaptive) {
-                wstart = AdaptStartIndex(pw, input_width, output_width);
-                wend = AdaptEndIndex(pw, input_width, output_width);
-              } else {
-                hstart = ph * stride_height - padding_height;
-                wstart = pw * stride_width - padding_width;
-                hend = std::min(hstart + ksize_height,
-                                input_height + padding_height);
-                wend =
-                    std::min(wstart + ksize_width, input_width + padding_width);
-                pool_size = (hend - hstart) * (wend - wstart);
-
-                wstart = std::max(wstart, 0);
-                hstart = std::max(hstart, 0);
-                hend = std::min(hend, input_height);
-                wend = std::min(wend, input_width);
-              }
-              T ele = pool_process.initial();
-              for (int h = hstart; h < hend; ++h) {
-                for (int w = wstart; w < wend; ++w) {
-                  pool_process.compute(
-                      input_data[h * input_width * input_channels +
-                                 w * input_channels + c],
-                      &ele);
-                }
-              }
-              if (exclusive || adaptive) {
-                pool_size = (hend - hstart) * (wend - wstart);
-              }
-              pool_process.finalize(static_cast<T>(pool_size), &ele);
-              output_data[ph * output_width * output_channels +
-                          pw * output_channels + c] = ele;
-            }
-          }
-        }
-        input_data += input_stride;
-        output_data += output_stride;
-      }
+      Pool2dNCHW(
+          shape, input_data, output_data, exclusive, adaptive, pool_process);
     }
   }
 };
@@ -269,76 +471,18 @@ class Pool2dGradFunctor<CPUContext, PoolProcess, T> {
                   bool adaptive,
                   DenseTensor* input_grad,
                   PoolProcess pool_grad_process) {
-    const int batch_size = input.dims()[0];
-    const int input_height = input.dims()[2];
-    const int input_width = input.dims()[3];
-    const int output_channels = output.dims()[1];
-    const int output_height = output.dims()[2];
-    const int output_width = output.dims()[3];
-    const int ksize_height = ksize[0];
-    const int ksize_width = ksize[1];
-    const int stride_height = strides[0];
-    const int stride_width = strides[1];
-    const int padding_height = paddings[0];
-    const int padding_width = paddings[1];
-    const int input_stride = input_height * input_width;
-    const int output_stride = output_height * output_width;
-
-    const T* input_data = input.data<T>();
-    const T* output_data = output.data<T>();
-    const T* output_grad_data = output_grad.data<T>();
-    T* input_grad_data = context.template Alloc<T>(input_grad);
-
-    int hstart = 0, hend = 1;
-    int wstart = 0, wend = 1;
-    for (int i = 0; i < batch_size; i++) {
-      for (int c = 0; c < output_channels; ++c) {
-        for (int ph = 0; ph < output_height; ++ph) {
-          if (adaptive) {
-            hstart = AdaptStartIndex(ph, input_height, output_height);
-            hend = AdaptEndIndex(ph, input_height, output_height);
-          }
-          for (int pw = 0; pw < output_width; ++pw) {
-            int pool_size = 1;
-            if (adaptive) {
-              wstart = AdaptStartIndex(pw, input_width, output_width);
-              wend = AdaptEndIndex(pw, input_width, output_width);
-            } else {
-              hstart = ph * stride_height - padding_height;
-              wstart = pw * stride_width - padding_width;
-              hend = std::min(hstart + ksize_height,
-                              input_height + padding_height);
-              wend =
-                  std::min(wstart + ksize_width, input_width + padding_width);
-              pool_size = (hend - hstart) * (wend - wstart);
-
-              wstart = std::max(wstart, 0);
-              hstart = std::max(hstart, 0);
-              hend = std::min(hend, input_height);
-              wend = std::min(wend, input_width);
-            }
-            if (exclusive || adaptive) {
-              pool_size = (hend - hstart) * (wend - wstart);
-            }
-            float scale = 1.0 / pool_size;
-            for (int h = hstart; h < hend; ++h) {
-              for (int w = wstart; w < wend; ++w) {
-                pool_grad_process.compute(
-                    input_data[h * input_width + w],
-                    output_data[ph * output_width + pw],
-                    output_grad_data[ph * output_width + pw],
-                    static_cast<T>(scale),
-                    input_grad_data + h * input_width + w);
-              }
-            }
-          }
-        }
-        input_data += input_stride;
-        output_data += output_stride;
-        input_grad_data += input_stride;
-        output_grad_data += output_stride;
-      }
-    }
+    (*this)(context,
+            input,
+            output,
+            output_grad,
+            ksize,
+            strides,
+            paddings,
+            "NCHW",
+            exclusive,
+            adaptive,
+            input_grad,
+            pool_grad_process);
   }
 
   void operator()(const CPUContext& context,
@@ -353,141 +497,30 @@ class Pool2dGradFunctor<CPUContext, PoolProcess, T> {
                   bool adaptive,
                   DenseTensor* input_grad,
                   PoolProcess pool_grad_process) {
-    bool channel_last = (data_format == "NHWC");
-
-    const int batch_size = input.dims()[0];
-
-    const int input_channels = channel_last ? input.dims()[3] : input.dims()[1];
-    const int input_height = channel_last ? input.dims()[1] : input.dims()[2];
-    const int input_width = channel_last ? input.dims()[2] : input.dims()[3];
-
-    const int output_channels =
-        channel_last ? output.dims()[3] : output.dims()[1];
-    const int output_height =
-        channel_last ? output.dims()[1] : output.dims()[2];
-    const int output_width = channel_last ? output.dims()[2] : output.dims()[3];
-
-    const int ksize_height = ksize[0];
-    const int ksize_width = ksize[1];
-
-    const int stride_height = strides[0];
-    const int stride_width = strides[1];
-
-    const int padding_height = paddings[0];
-    const int padding_width = paddings[1];
-
+    const Pool2dShape shape(
+        input, output.dims(), ksize, strides, paddings, data_format == "NHWC");
     const T* input_data = input.data<T>();
     const T* output_data = output.data<T>();
     const T* output_grad_data = output_grad.data<T>();
     T* input_grad_data = context.template Alloc<T>(input_grad);
-
-    int hstart = 0, hend = 1;
-    int wstart = 0, wend = 1;
-    if (!channel_last) {
-      const int input_stride = input_height * input_width;
-      const int output_stride = output_height * output_width;
-      for (int i = 0; i < batch_size; i++) {
-        for (int c = 0; c < output_channels; ++c) {
-          for (int ph = 0; ph < output_height; ++ph) {
-            if (adaptive) {
-              hstart = AdaptStartIndex(ph, input_height, output_height);
-              hend = AdaptEndIndex(ph, input_height, output_height);
-            }
-            for (int pw = 0; pw < output_width; ++pw) {
-              int pool_size = 1;
-              if (adaptive) {
-                wstart = AdaptStartIndex(pw, input_width, output_width);
-                wend = AdaptEndIndex(pw, input_width, output_width);
-              } else {
-                hstart = ph * stride_height - padding_height;
-                wstart = pw * stride_width - padding_width;
-                hend = std::min(hstart + ksize_height,
-                                input_height + padding_height);
-                wend =
-                    std::min(wstart + ksize_width, input_width + padding_width);
-                pool_size = (hend - hstart) * (wend - wstart);
-
-                wstart = std::max(wstart, 0);
-                hstart = std::max(hstart, 0);
-                hend = std::min(hend, input_height);
-                wend = std::min(wend, input_width);
-              }
-              if (exclusive || adaptive) {
-                pool_size = (hend - hstart) * (wend - wstart);
-              }
-              float scale = 1.0 / pool_size;
-              for (int h = hstart; h < hend; ++h) {
-                for (int w = wstart; w < wend; ++w) {
-                  pool_grad_process.compute(
-                      input_data[h * input_width + w],
-                      output_data[ph * output_width + pw],
-                      output_grad_data[ph * output_width + pw],
-                      static_cast<T>(scale),
-                      input_grad_data + h * input_width + w);
-                }
-              }
-            }
-          }
-          input_data += input_stride;
-          output_data += output_stride;
-          input_grad_data += input_stride;
-          output_grad_data += output_stride;
-        }
-      }
+    if (shape.channel_last) {
+      Pool2dGradNHWC(shape,
+                     input_data,
+                     output_data,
+                     output_grad_data,
+                     input_grad_data,
+                     exclusive,
+                     adaptive,
+                     pool_grad_process);
     } else {
-      const int input_stride = input_height * input_width * input_channels;
-      const int output_stride = output_height * output_width * output_channels;
-      for (int i = 0; i < batch_size; i++) {
-        for (int c = 0; c < output_channels; ++c) {
-          for (int ph = 0; ph < output_height; ++ph) {
-            if (adaptive) {
-              hstart = AdaptStartIndex(ph, input_height, output_height);
-              hend = AdaptEndIndex(ph, input_height, output_height);
-            }
-            for (int pw = 0; pw < output_width; ++pw) {
-              int pool_size = 1;
-              if (adaptive) {
-                wstart = AdaptStartIndex(pw, input_width, output_width);
-                wend = AdaptEndIndex(pw, input_width, output_width);
-              } else {
-                hstart = ph * stride_height - padding_height;
-                wstart = pw * stride_width - padding_width;
-                hend = std::min(hstart + ksize_height,
-                                input_height + padding_height);
-                wend =
-                    std::min(wstart + ksize_width, input_width + padding_width);
-                pool_size = (hend - hstart) * (wend - wstart);
-
-                wstart = std::max(wstart, 0);
-                hstart = std::max(hstart, 0);
-                hend = std::min(hend, input_height);
-                wend = std::min(wend, input_width);
-              }
-              if (exclusive || adaptive) {
-                pool_size = (hend - hstart) * (wend - wstart);
-              }
-              float scale = 1.0 / pool_size;
-              for (int h = hstart; h < hend; ++h) {
-                for (int w = wstart; w < wend; ++w) {
-                  auto input_idx =
-                      h * input_width * input_channels + w * input_channels + c;
-                  auto output_idx = ph * output_width * output_channels +
-                                    pw * output_channels + c;
-                  pool_grad_process.compute(input_data[input_idx],
-                                            output_data[output_idx],
-                                            output_grad_data[output_idx],
-                                            static_cast<T>(scale),
-                                            input_grad_data + input_idx);
-                }
-              }
-            }
-          }
-        }
-        input_data += input_stride;
-        output_data += output_stride;
-        input_grad_data += input_stride;
-        output_grad_data += output_stride;
-      }
+      Pool2dGradNCHW(shape,
+                     input_data,
+                     output_data,
+                     output_grad_data,
+                     input_grad_data,
+                     exclusive,
+                     adaptive,
+                     pool_grad_process);
     }
   }
 };
@@ -510,56 +543,15 @@ class MaxPool2dGradFunctor<CPUContext, T> {
                   const std::vector<int>& strides,
                   const std::vector<int>& paddings,
                   DenseTensor* input_grad) {
-    const int batch_size = input.dims()[0];
-    const int input_height = input.dims()[2];
-    const int input_width = input.dims()[3];
-    const int output_channels = output.dims()[1];
-    const int output_height = output.dims()[2];
-    const int output_width = output.dims()[3];
-    const int ksize_height = ksize[0];
-    const int ksize_width = ksize[1];
-    const int stride_height = strides[0];
-    const int stride_width = strides[1];
-    const int padding_height = paddings[0];
-    const int padding_width = paddings[1];
-    const int input_stride = input_height * input_width;
-    const int output_stride = output_height * output_width;
-
-    const T* input_data = input.data<T>();
-    const T* output_data = output.data<T>();
-    const T* output_grad_data = output_grad.data<T>();
-    T* input_grad_data = context.template Alloc<T>(input_grad);
-
-    for (int i = 0; i < batch_size; i++) {
-      for (int c = 0; c < output_channels; ++c) {
-        for (int ph = 0; ph < output_height; ++ph) {
-          int hstart = ph * stride_height - padding_height;
-          int hend = std::min(hstart + ksize_height, input_height);
-          hstart = std::max(hstart, 0);
-          for (int pw = 0; pw < output_width; ++pw) {
-            int wstart = pw * stride_width - padding_width;
-            int wend = std::min(wstart + ksize_width, input_width);
-            wstart = std::max(wstart, 0);
-
-            bool stop = false;
-            for (int h = hstart; h < hend && !stop; ++h) {
-              for (int w = wstart; w < wend && !stop; ++w) {
-                int input_idx = h * input_width + w;
-                int output_idx = ph * output_width + pw;
-                if (input_data[input_idx] == output_data[output_idx]) {
-                  input_grad_data[input_idx] += output_grad_data[output_idx];
-                  stop = true;
-                }
-              }
-            }
-          }
-        }
-        input_data += input_stride;
-        output_data += output_stride;
-        input_grad_data += input_stride;
-        output_grad_data += output_stride;
-      }
-    }
+    (*this)(context,
+            input,
+            output,
+            output_grad,
+            ksize,
+            strides,
+            paddings,
+            "NCHW",
+            input_grad);
   }
 
   void operator()(const CPUContext& context,
@@ -571,102 +563,18 @@ class MaxPool2dGradFunctor<CPUContext, T> {
                   const std::vector<int>& paddings,
                   const std::string data_format,
                   DenseTensor* input_grad) {
-    bool channel_last = (data_format == "NHWC");
-
-    const int batch_size = input.dims()[0];
-
-    const int input_channels = channel_last ? input.dims()[3] : input.dims()[1];
-    const int input_height = channel_last ? input.dims()[1] : input.dims()[2];
-    const int input_width = channel_last ? input.dims()[2] : input.dims()[3];
-
-    const int output_channels =
-        channel_last ? output.dims()[3] : output.dims()[1];
-    const int output_height =
-        channel_last ? output.dims()[1] : output.dims()[2];
-    const int output_width = channel_last ? output.dims()[2] : output.dims()[3];
-
-    const int ksize_height = ksize[0];
-    const int ksize_width = ksize[1];
-
-    const int stride_height = strides[0];
-    const int stride_width = strides[1];
-
-    const int padding_height = paddings[0];
-    const int padding_width = paddings[1];
-
+    const Pool2dShape shape(
+        input, output.dims(), ksize, strides, paddings, data_format == "NHWC");
     const T* input_data = input.data<T>();
     const T* output_data = output.data<T>();
     const T* output_grad_data = output_grad.data<T>();
     T* input_grad_data = context.template Alloc<T>(input_grad);
-
-    if (!channel_last) {
-      const int input_stride = input_height * input_width;
-      const int output_stride = output_height * output_width;
-      for (int i = 0; i < batch_size; i++) {
-        for (int c = 0; c < output_channels; ++c) {
-          for (int ph = 0; ph < output_height; ++ph) {
-            int hstart = ph * stride_height - padding_height;
-            int hend = std::min(hstart + ksize_height, input_height);
-            hstart = std::max(hstart, 0);
-            for (int pw = 0; pw < output_width; ++pw) {
-              int wstart = pw * stride_width - padding_width;
-              int wend = std::min(wstart + ksize_width, input_width);
-              wstart = std::max(wstart, 0);
-
-              bool stop = false;
-              for (int h = hstart; h < hend && !stop; ++h) {
-                for (int w = wstart; w < wend && !stop; ++w) {
-                  int input_idx = h * input_width + w;
-                  int output_idx = ph * output_width + pw;
-                  if (input_data[input_idx] == output_data[output_idx]) {
-                    input_grad_data[input_idx] += output_grad_data[output_idx];
-                    stop = true;
-                  }
-                }
-              }
-            }
-          }
-          input_data += input_stride;
-          output_data += output_stride;
-          input_grad_data += input_stride;
-          output_grad_data += output_stride;
-        }
-      }
+    if (shape.channel_last) {
+      MaxPool2dGradNHWC(
+          shape, input_data, output_data, output_grad_data, input_grad_data);
     } else {
-      const int input_stride = input_height * input_width * input_channels;
-      const int output_stride = output_height * output_width * output_channels;
-      for (int i = 0; i < batch_size; i++) {
-        for (int c = 0; c < output_channels; ++c) {
-          for (int ph = 0; ph < output_height; ++ph) {
-            int hstart = ph * stride_height - padding_height;
-            int hend = std::min(hstart + ksize_height, input_height);
-            hstart = std::max(hstart, 0);
-            for (int pw = 0; pw < output_width; ++pw) {
-              int wstart = pw * stride_width - padding_width;
-              int wend = std::min(wstart + ksize_width, input_width);
-              wstart = std::max(wstart, 0);
-
-              bool stop = false;
-              for (int h = hstart; h < hend && !stop; ++h) {
-                for (int w = wstart; w < wend && !stop; ++w) {
-                  int input_idx =
-                      h * input_width * input_channels + w * input_channels + c;
-                  int output_idx = ph * output_width * output_channels +
-                                   pw * output_channels + c;
-                  if (input_data[input_idx] == output_data[output_idx]) {
-                    input_grad_data[input_idx] += output_grad_data[output_idx];
-                    stop = true;
-                  }
-                }
-              }
-            }
-          }
-        }
-        input_data += input_stride;
-        output_data += output_stride;
-        input_grad_data += input_stride;
-        output_grad_data += output_stride;
-      }
+      MaxPool2dGradNCHW(
+          shape, input_data, output_data, output_grad_data, input_grad_data);
     }
   }
 };
@@ -15,9 +15,15 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/selected_rows_functor.h"
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
 
 #include "paddle/phi/core/ddim.h"
 #include "paddle/phi/core/mixed_vector.h"
@@ -26,10 +32,6 @@ limitations under the License. */
 #include "paddle/phi/backends/xpu/enforce_xpu.h"
 #endif
 
-#ifdef PADDLE_WITH_MKLDNN
-#include "paddle/phi/backends/onednn/axpy_handler.h"
-#endif
-
 #include "glog/logging.h"
 
 namespace phi {
@@ -409,90 +411,198 @@ template struct SelectedRowsAddToTensor<phi::XPUContext, float>;
 // add or mul.
 namespace scatter {
 
-template <typename T, typename DeviceContext>
-typename std::enable_if<!std::is_integral<T>::value>::type elementwise_add_to(
-    phi::funcs::BlasT<DeviceContext, T>* blas,
-    size_t data_len,
-    const T* in,
-    T* out) {
-  blas->AXPY(data_len, T(1.f), in, out);
+namespace {
+
+// The fewest rows worth a thread of their own when merging.
+constexpr int64_t kMinMergeRowsPerThread = 16 * 1024;
+
+int MergeThreads(int64_t num_rows) {
+#ifdef PADDLE_WITH_MKLML
+  return static_cast<int>(std::max<int64_t>(
+      1,
+      std::min<int64_t>(omp_get_max_threads(),
+                        num_rows / kMinMergeRowsPerThread)));
+#else
+  return 1;
+#endif
 }
 
-template <typename T, typename DeviceContext>
-typename std::enable_if<std::is_integral<T>::value>::type elementwise_add_to(
-    phi::funcs::BlasT<DeviceContext, T>* blas UNUSED,
-    size_t data_len,
-    const T* in,
-    T* out) {
-  for (size_t i = 0; i < data_len; i++) {
-    out[i] += in[i];
+// Stable LSD radix sort of the pairs (keys[i], values[i]) by key, 8 bits per
+// pass. The keys are sorted as offsets from the smallest one and only the
+// bytes that differ are sorted, so ids spanning less than 2^24 take three
+// passes. The pairs are histogrammed and then scattered by contiguous
+// slices, in parallel.
+void RadixSortPairs(std::vector<int64_t>* keys, std::vector<int64_t>* values) {
+  const int64_t n = static_cast<int64_t>(keys->size());
+  if (n < 2) {
+    return;
+  }
+  const auto minmax = std::minmax_element(keys->begin(), keys->end());
+  const uint64_t min_key = static_cast<uint64_t>(*minmax.first);
+  const uint64_t range = static_cast<uint64_t>(*minmax.second) - min_key;
+
+  const int threads = MergeThreads(n);
+  const int64_t chunk = (n + threads - 1) / threads;
+  std::vector<int64_t> keys_buffer(n);
+  std::vector<int64_t> values_buffer(n);
+  std::vector<int64_t> offsets(static_cast<size_t>(threads) * 256);
+  for (int shift = 0; shift < 64 && (range >> shift) > 0; shift += 8) {
+    const int64_t* src_keys = keys->data();
+    const int64_t* src_values = values->data();
+    int64_t* dst_keys = keys_buffer.data();
+    int64_t* dst_values = values_buffer.data();
+    auto digit = [&](int64_t i) {
+      return ((static_cast<uint64_t>(src_keys[i]) - min_key) >> shift) & 0xFF;
+    };
+    std::fill(offsets.begin(), offsets.end(), 0);
+    auto slice = [&](int t) {
+      const int64_t begin = std::min(n, t * chunk);
+      return std::make_pair(begin, std::min(n, begin + chunk));
+    };
+    // The slices are split by omp for rather than by thread number, OpenMP
+    // may run the region on fewer threads than asked for.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel num_threads(threads)
+#endif
+    {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp for schedule(static)
+#endif
+      for (int t = 0; t < threads; ++t) {
+        const auto range = slice(t);
+        int64_t* offset = offsets.data() + t * 256;
+        for (int64_t i = range.first; i < range.second; ++i) {
+          ++offset[digit(i)];
+        }
+      }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp single
+#endif
+      {
+        // digit major, slice minor, which keeps the sort stable
+        int64_t sum = 0;
+        for (int d = 0; d < 256; ++d) {
+          for (int t = 0; t < threads; ++t) {
+            int64_t count = offsets[t * 256 + d];
+            offsets[t * 256 + d] = sum;
+            sum += count;
+          }
+        }
+      }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp for schedule(static)
+#endif
+      for (int t = 0; t < threads; ++t) {
+        const auto range = slice(t);
+        int64_t* offset = offsets.data() + t * 256;
+        for (int64_t i = range.first; i < range.second; ++i) {
+          const int64_t pos = offset[digit(i)]++;
+          dst_keys[pos] = src_keys[i];
+          dst_values[pos] = src_values[i];
+        }
+      }
+    }
+    keys->swap(keys_buffer);
+    values->swap(values_buffer);
   }
 }
 
-template <typename T, typename DeviceContext>
-typename std::enable_if<std::is_same<T, phi::dtype::bfloat16>::value>::type
-add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
-                  const std::unordered_map<int64_t, size_t>& rows_to_id,
-                  int64_t input_width,
-                  const DeviceContext& context,
-                  T* out_data) {
-#ifndef PADDLE_WITH_MKLDNN
-  auto blas = phi::funcs::GetBlas<DeviceContext, T>(context);
-#endif
+// The rows of several SelectedRows grouped by id. merge_rows holds the
+// distinct ids in ascending order, and the rows that add up to merge_rows[i]
+// are sources[offsets[i]] to sources[offsets[i + 1] - 1] in input order, as
+// (input index, row index) pairs.
+struct RowGroups {
+  std::vector<int64_t> merge_rows;
+  std::vector<int64_t> offsets;
+  std::vector<std::pair<int, int64_t>> sources;
+};
+
+RowGroups GroupRows(const std::vector<const phi::SelectedRows*>& inputs,
+                    size_t row_num) {
+  std::vector<int64_t> ids;
+  std::vector<int64_t> positions;
+  ids.reserve(row_num);
+  positions.reserve(row_num);
   for (auto* input : inputs) {
-    if (input->rows().size() == 0) {
-      continue;
-    }
-    auto* input_data = input->value().data<T>();
-    auto& input_rows = input->rows();
-
-#ifdef PADDLE_WITH_MKLDNN
-    OneDNNContext onednn_context(context.GetPlace());
-    funcs::OneDNNAXPYHandler<T> axpy_handler(
-        input_width, T(1.f), onednn_context.GetEngine());
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
-      axpy_handler(&input_data[i * input_width],
-                   &out_data[out_i * input_width]);
-    }
-#else
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
-      elementwise_add_to<T, DeviceContext>(&blas,
-                                           static_cast<size_t>(input_width),
-                                           &input_data[i * input_width],
-                                           &out_data[out_i * input_width]);
+    ids.insert(ids.end(), input->rows().begin(), input->rows().end());
+  }
+  for (size_t i = 0; i < ids.size(); ++i) {
+    positions.push_back(static_cast<int64_t>(i));
+  }
+  // Rows already in ascending order with no duplicates, e.g. the output of
+  // an earlier MergeAdd, are their own groups. Otherwise whether any rows
+  // repeat is only known once they are sorted.
+  if (std::adjacent_find(
+          ids.begin(), ids.end(), std::greater_equal<int64_t>()) != ids.end()) {
+    RadixSortPairs(&ids, &positions);
+  }
+
+  std::vector<int64_t> input_begins;
+  int64_t begin = 0;
+  for (auto* input : inputs) {
+    input_begins.push_back(begin);
+    begin += static_cast<int64_t>(input->rows().size());
+  }
+
+  RowGroups groups;
+  groups.sources.resize(ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (i == 0 || ids[i] != ids[i - 1]) {
+      groups.merge_rows.push_back(ids[i]);
+      groups.offsets.push_back(static_cast<int64_t>(i));
     }
-#endif
+    const int input = static_cast<int>(
+        std::upper_bound(
+            input_begins.begin(), input_begins.end(), positions[i]) -
+        input_begins.begin() - 1);
+    groups.sources[i] = {input, positions[i] - input_begins[input]};
   }
+  groups.offsets.push_back(static_cast<int64_t>(ids.size()));
+  return groups;
 }
 
-template <typename T, typename DeviceContext>
-typename std::enable_if<!std::is_same<T, phi::dtype::bfloat16>::value>::type
-add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
-                  const std::unordered_map<int64_t, size_t>& rows_to_id,
-                  int64_t input_width,
-                  const DeviceContext& context,
+// out [merge_rows, width] = the sum of every group of rows, divided by
+// divisor when it is not one. Each output row is written by a single thread,
+// so the accumulation needs no atomics and no zero fill.
+template <typename T>
+void SumRowGroups(const std::vector<const phi::SelectedRows*>& inputs,
+                  const RowGroups& groups,
+                  int64_t width,
+                  T divisor,
                   T* out_data) {
-  VLOG(4) << "[CPU] add_sparse_inputs <" << typeid(T).name();
-  auto blas = phi::funcs::GetBlas<DeviceContext, T>(context);
+  std::vector<const T*> input_data;
   for (auto* input : inputs) {
-    if (input->rows().size() == 0) {
-      continue;
+    input_data.push_back(input->rows().empty() ? nullptr
+                                               : input->value().data<T>());
+  }
+  const int64_t num_groups = static_cast<int64_t>(groups.merge_rows.size());
+  const bool need_divide = divisor != static_cast<T>(1);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(MergeThreads(groups.sources.size()))
+#endif
+  for (int64_t i = 0; i < num_groups; ++i) {
+    T* dst = out_data + i * width;
+    for (int64_t s = groups.offsets[i]; s < groups.offsets[i + 1]; ++s) {
+      const auto& source = groups.sources[s];
+      const T* src = input_data[source.first] + source.second * width;
+      if (s == groups.offsets[i]) {
+        std::memcpy(dst, src, width * sizeof(T));
+      } else {
+        for (int64_t j = 0; j < width; ++j) {
+          dst[j] += src[j];
+        }
+      }
     }
-    auto* input_data = input->value().data<T>();
-    auto& input_rows = input->rows();
-
-    for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
-      elementwise_add_to<T, DeviceContext>(&blas,
-                                           static_cast<size_t>(input_width),
-                                           &input_data[i * input_width],
-                                           &out_data[out_i * input_width]);
+    if (need_divide) {
+      for (int64_t j = 0; j < width; ++j) {
+        dst[j] = dst[j] / divisor;
+      }
     }
   }
 }
 
+}  // namespace
+
 template <typename DeviceContext, typename T>
 struct MergeAddImpl {
   phi::SelectedRows operator()(const DeviceContext& context,
@@ -534,7 +644,6 @@ struct MergeAddImpl {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     phi::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
     size_t row_num = 0;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
@@ -550,16 +659,16 @@ struct MergeAddImpl {
           input->height(),
           phi::errors::InvalidArgument("All inputs should have same height."));
       row_num += input->rows().size();
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
     }
+    RowGroups groups = GroupRows(inputs, row_num);
 
     out.set_height(input_height);
     DenseTensor* out_tensor = out.mutable_value();
     out_tensor->Resize(phi::make_ddim(
-        {static_cast<int64_t>(merged_row_set.size()), input_width}));
+        {static_cast<int64_t>(groups.merge_rows.size()), input_width}));
     auto* out_data = context.template Alloc<T>(out_tensor);
 
-    if (merged_row_set.size() == row_num && !sorted_result) {
+    if (groups.merge_rows.size() == row_num && !sorted_result) {
       // no duplicated ids, just concat the result together
       std::vector<int64_t> merge_rows;
       merge_rows.reserve(row_num);
@@ -583,25 +692,9 @@ struct MergeAddImpl {
         copied_numel += in_numel;
       }
     } else {
-      std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                      merged_row_set.end());
-
-      if (sorted_result) {
-        std::sort(merge_rows.begin(), merge_rows.end());
-      }
-
-      out.set_rows(merge_rows);
-
-      phi::funcs::SetConstant<DeviceContext, T> constant_functor;
-      constant_functor(context, out.mutable_value(), static_cast<T>(0.f));
-
-      std::unordered_map<int64_t, size_t> rows_to_id;
-      for (size_t i = 0; i < merge_rows.size(); ++i) {
-        rows_to_id[merge_rows[i]] = i;
-      }
-
-      add_sparse_inputs<T, DeviceContext>(
-          inputs, rows_to_id, input_width, context, out_data);
+      out.set_rows(groups.merge_rows);
+      SumRowGroups<T>(
+          inputs, groups, input_width, static_cast<T>(1), out_data);
     }
   }
 };
@@ -849,7 +942,6 @@ struct MergeAverage<phi::CPUContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     phi::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
     size_t row_num = 0;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
@@ -865,53 +957,22 @@ struct MergeAverage<phi::CPUContext, T> {
           input->height(),
           phi::errors::InvalidArgument("All input should have same height."));
       row_num += input->rows().size();
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
     }
+    RowGroups groups = GroupRows(inputs, row_num);
 
     out.set_height(input_height);
 
     DenseTensor* out_tensor = out.mutable_value();
     out_tensor->Resize(phi::make_ddim(
-        {static_cast<int64_t>(merged_row_set.size()), input_width}));
+        {static_cast<int64_t>(groups.merge_rows.size()), input_width}));
     auto* out_data = context.template Alloc<T>(out_tensor);
 
-    std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                    merged_row_set.end());
-    std::sort(merge_rows.begin(), merge_rows.end());
-
-    out.set_rows(merge_rows);
-
-    phi::funcs::SetConstant<phi::CPUContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), 0.0);
-
-    std::unordered_map<int64_t, size_t> rows_to_id;
-    for (size_t i = 0; i < merge_rows.size(); ++i) {
-      rows_to_id[merge_rows[i]] = i;
-    }
-
-    auto blas = phi::funcs::GetBlas<phi::CPUContext, T>(context);
-    for (auto* input : inputs) {
-      if (input->rows().size() == 0) {
-        continue;
-      }
-      auto* input_data = input->value().data<T>();
-      auto& input_rows = input->rows();
-
-      for (size_t i = 0; i < input_rows.size(); i++) {
-        size_t out_i = rows_to_id[input_rows[i]];
-        elementwise_add_to<T>(&blas,
-                              static_cast<size_t>(input_width),
-                              &input_data[i * input_width],
-                              &out_data[out_i * input_width]);
-      }
-    }
-    size_t input_width_cast = static_cast<size_t>(input_width);
-    T count = static_cast<T>(inputs.size());
-    for (size_t i = 0; i < merge_rows.size(); i++) {
-      for (size_t j = 0; j < input_width_cast; j++) {
-        out_data[i * input_width + j] = out_data[i * input_width + j] / count;
-      }
-    }
+    out.set_rows(groups.merge_rows);
+    SumRowGroups<T>(inputs,
+                    groups,
+                    input_width,
+                    static_cast<T>(inputs.size()),
+                    out_data);
   }
 };
 
@@ -15,11 +15,32 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/softmax.h"
 
 #include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/funcs/jit/kernels.h"
 #include "paddle/phi/kernels/funcs/softmax_impl.h"
 
 namespace phi {
 namespace funcs {
 
+template <typename DeviceContext, typename T>
+void SoftmaxFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>>::operator()(
+    const DeviceContext& context UNUSED,
+    const int axis_dim,
+    const phi::DenseTensor* X,
+    phi::DenseTensor* Y) {
+  const auto& in_dims = X->dims();
+  constexpr int kBatchDim = 0;
+  constexpr int kClassDim = 1;
+
+  const int num_classes = in_dims[kClassDim];
+  const int batch_size = in_dims[kBatchDim];
+  const int num_remain = num_classes / axis_dim;
+
+  auto compute_softmax =
+      phi::jit::KernelFuncs<phi::jit::SoftmaxTuple<T>, phi::CPUPlace>::Cache()
+          .At(axis_dim);
+  compute_softmax(X->data<T>(), Y->data<T>(), axis_dim, batch_size, num_remain);
+}
+
 template class SoftmaxFunctor<phi::CPUContext, float>;
 template class SoftmaxFunctor<phi::CPUContext, double>;
 template class SoftmaxGradFunctor<phi::CPUContext, float>;
@@ -230,47 +230,14 @@ template <class DeviceContext>
 using enable_if_CPU = typename std::enable_if<
     std::is_same<DeviceContext, phi::CPUContext>::value>::type;
 
+// Defined in softmax.cc on top of the jit softmax kernel.
 template <typename DeviceContext, typename T>
 class SoftmaxFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>> {
  public:
   void operator()(const DeviceContext& context,
                   const int axis_dim,
                   const phi::DenseTensor* X,
-                  phi::DenseTensor* Y) {
-    const auto& in_dims = X->dims();
-    constexpr int kBatchDim = 0;
-    constexpr int kClassDim = 1;
-
-    const int num_classes = in_dims[kClassDim];
-    const int batch_size = in_dims[kBatchDim];
-    const int num_remain = num_classes / axis_dim;
-
-    if (num_remain == 1 &&
-        phi::backends::cpu::MayIUse(phi::backends::cpu::avx)) {
-      const T* in_data = X->data<T>();
-      T* out_data = Y->data<T>();
-      for (int bs = 0; bs < batch_size; ++bs) {
-        T max_val = *std::max_element(in_data, in_data + num_classes);
-        max_val *= static_cast<T>(-1);
-        vec_add_bias<T, phi::backends::cpu::avx>(
-            num_classes, max_val, in_data, out_data);
-        vec_clip<T, phi::backends::cpu::avx>(
-            num_classes, static_cast<T>(-64), out_data, out_data);
-        vec_exp<T>(num_classes, out_data, out_data);
-
-        T sum = 0;
-        vec_sum<T, phi::backends::cpu::avx>(num_classes, out_data, &sum);
-        sum = static_cast<T>(1) / sum;
-        vec_scal<T, phi::backends::cpu::avx>(
-            num_classes, sum, out_data, out_data);
-
-        in_data += num_classes;
-        out_data += num_classes;
-      }
-    } else {
-      SoftmaxEigen<DeviceContext, T>()(context, axis_dim, X, Y);
-    }
-  }
+                  phi::DenseTensor* Y);
 };
 
 template <typename DeviceContext, typename T>
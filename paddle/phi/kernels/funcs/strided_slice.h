@@ -25,6 +25,7 @@
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 
 namespace phi {
 namespace funcs {
@@ -179,6 +180,72 @@ static void StridedSliceFunctor(int64_t* starts,
   }
 }
 
+// Makes out the view of the strided slice of x, multiplying the strides of
+// x by the steps. Returns false, leaving out as it is, for the negative steps
+// which are computed by StridedSliceCompute.
+inline bool StridedSliceView(const DenseTensor& x,
+                             const std::vector<int>& axes,
+                             const IntArray& starts,
+                             const IntArray& ends,
+                             const IntArray& strides,
+                             const std::vector<int>& infer_flags,
+                             const std::vector<int>& decrease_axis,
+                             DenseTensor* out) {
+  auto starts_ = starts.GetData();
+  auto ends_ = ends.GetData();
+  auto strides_ = strides.GetData();
+  for (auto step : strides_) {
+    if (step < 0) {
+      return false;
+    }
+  }
+  DDim in_dims = x.dims();
+  std::vector<int64_t> out_dims(in_dims.size(), -1);
+  StridedSliceOutDims(starts_,
+                      ends_,
+                      strides_,
+                      axes,
+                      infer_flags,
+                      in_dims,
+                      decrease_axis,
+                      out_dims.data(),
+                      axes.size(),
+                      false);
+  std::vector<int> reverse_vector(starts_.size(), 0);
+  StridedSliceFunctor(starts_.data(),
+                      ends_.data(),
+                      strides_.data(),
+                      axes.data(),
+                      reverse_vector.data(),
+                      in_dims,
+                      infer_flags,
+                      decrease_axis,
+                      starts_.size());
+
+  std::vector<int64_t> view_strides = GetStrides(x);
+  int64_t offset = 0;
+  for (size_t i = 0; i < axes.size(); ++i) {
+    int64_t start = std::min<int64_t>(starts_[i], in_dims[axes[i]]);
+    offset += start * view_strides[axes[i]];
+    view_strides[axes[i]] *= strides_[i];
+  }
+  std::vector<int64_t> dims;
+  std::vector<int64_t> decreased_strides;
+  for (int i = 0; i < in_dims.size(); ++i) {
+    if (std::find(decrease_axis.begin(), decrease_axis.end(), i) ==
+        decrease_axis.end()) {
+      dims.push_back(out_dims[i]);
+      decreased_strides.push_back(view_strides[i]);
+    }
+  }
+  if (dims.empty()) {
+    dims.push_back(1);
+    decreased_strides.push_back(1);
+  }
+  MakeStridedView(x, make_ddim(dims), decreased_strides, offset, out);
+  return true;
+}
+
 template <typename Context, typename T, size_t D>
 void StridedSliceCompute(const Context& dev_ctx,
                          const DenseTensor& x,
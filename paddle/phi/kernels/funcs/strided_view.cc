@@ -0,0 +1,142 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/strided_view.h"
+
+#include <cstring>
+#include <numeric>
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/flags.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+
+PHI_DECLARE_bool(use_stride_kernel);
+
+namespace phi {
+namespace funcs {
+
+bool UseStridedView(const DenseTensor& x) {
+  return FLAGS_use_stride_kernel && x.initialized() &&
+         x.place().GetType() == AllocationType::CPU;
+}
+
+std::vector<int64_t> GetStrides(const DenseTensor& x) {
+  return x.is_contiguous() ? DenseTensorMeta::calc_strides(x.dims())
+                           : x.strides();
+}
+
+void MakeStridedView(const DenseTensor& x,
+                     const DDim& dims,
+                     const std::vector<int64_t>& strides,
+                     int64_t offset,
+                     DenseTensor* out) {
+  const DenseTensor x_in = x;
+  out->ShareBufferWith(x_in);
+  // Inplace ops on a contiguous view write into x, so, as the view ops of
+  // the eager mode do, out bumps the inplace version autograd checks for x.
+  out->ShareInplaceVersionCounterWith(x_in);
+  auto* meta = DenseTensorUtils::GetMutableMeta(out);
+  meta->offset = x_in.meta().offset + offset * SizeOf(x_in.dtype());
+  meta->dims = dims;
+  meta->strides.clear();
+  out->set_strides(strides);
+}
+
+// Finds the permutation axis of the dims of a row-major tensor x is a view
+// of, if there is one.
+static bool IsPermutedView(const DenseTensor& x,
+                           std::vector<int64_t>* src_dims,
+                           std::vector<int>* axis) {
+  const std::vector<int64_t>& strides = x.strides();
+  const int rank = x.dims().size();
+  std::vector<int> order(rank);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+    return strides[lhs] > strides[rhs];
+  });
+  int64_t expected = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    const int64_t dim = x.dims()[order[i]];
+    if (dim != 1 && strides[order[i]] != expected) {
+      return false;
+    }
+    expected *= dim;
+  }
+  src_dims->resize(rank);
+  axis->resize(rank);
+  for (int i = 0; i < rank; ++i) {
+    (*src_dims)[i] = x.dims()[order[i]];
+    (*axis)[order[i]] = i;
+  }
+  return true;
+}
+
+void ContiguousCopy(const DeviceContext& dev_ctx,
+                    const DenseTensor& x,
+                    DenseTensor* out) {
+  PADDLE_ENFORCE_EQ(
+      x.place().GetType(),
+      AllocationType::CPU,
+      phi::errors::Unimplemented("Only the strided tensors on CPU can be made "
+                                 "contiguous, but the tensor is on %s.",
+                                 x.place()));
+  const DenseTensor x_in = x;
+  out->Resize(x_in.dims());
+  out->set_layout(x_in.layout());
+  void* out_data = dev_ctx.HostAlloc(out, x_in.dtype());
+  std::vector<int64_t> src_dims;
+  std::vector<int> axis;
+  if (!x_in.is_contiguous() && IsPermutedView(x_in, &src_dims, &axis)) {
+    TransposeCPU(
+        x_in.data(), out_data, SizeOf(x_in.dtype()), src_dims, axis);
+  } else {
+    StridedCopyToContiguous(x_in, out_data);
+  }
+}
+
+DenseTensor Contiguous(const DeviceContext& dev_ctx, const DenseTensor& x) {
+  if (x.is_contiguous()) {
+    return x;
+  }
+  DenseTensor out;
+  ContiguousCopy(dev_ctx, x, &out);
+  return out;
+}
+
+DenseTensor MatmulOperand(const DeviceContext& dev_ctx,
+                          const DenseTensor& x,
+                          bool* trans) {
+  const int rank = x.dims().size();
+  if (x.is_contiguous() || rank < 2) {
+    return Contiguous(dev_ctx, x);
+  }
+  DDim dims = x.dims();
+  std::swap(dims[rank - 1], dims[rank - 2]);
+  std::vector<int64_t> strides = DenseTensorMeta::calc_strides(dims);
+  std::vector<int64_t> expected = strides;
+  std::swap(expected[rank - 1], expected[rank - 2]);
+  for (int i = 0; i < rank; ++i) {
+    if (x.dims()[i] != 1 && x.strides()[i] != expected[i]) {
+      return Contiguous(dev_ctx, x);
+    }
+  }
+  DenseTensor out;
+  MakeStridedView(x, dims, strides, 0, &out);
+  *trans = !*trans;
+  return out;
+}
+
+}  // namespace funcs
+}  // namespace phi
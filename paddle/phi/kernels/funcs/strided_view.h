@@ -0,0 +1,198 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "paddle/phi/common/amp_type_traits.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/device_context.h"
+
+namespace phi {
+namespace funcs {
+
+// Whether the `<kernel>_strided` kernels of strided_view_kernel.h make out a
+// strided view of the memory of x instead of a copy, which they do with
+// FLAGS_use_stride_kernel for the tensors on CPU.
+bool UseStridedView(const DenseTensor& x);
+
+// The strides of x in elements, the row-major ones if it is contiguous.
+std::vector<int64_t> GetStrides(const DenseTensor& x);
+
+// Makes out the view of dims and strides of the memory of x, starting offset
+// elements after the first element of x. out shares the inplace version of x.
+// out may be x.
+void MakeStridedView(const DenseTensor& x,
+                     const DDim& dims,
+                     const std::vector<int64_t>& strides,
+                     int64_t offset,
+                     DenseTensor* out);
+
+// Copies the tensor on CPU x, which may be a strided view, row-major into
+// out. The views of a permutation of the dims of a row-major tensor are
+// transposed by TransposeCPU, the others are gathered a row at a time.
+void ContiguousCopy(const DeviceContext& dev_ctx,
+                    const DenseTensor& x,
+                    DenseTensor* out);
+
+// x itself if it is contiguous, a contiguous copy of it otherwise.
+DenseTensor Contiguous(const DeviceContext& dev_ctx, const DenseTensor& x);
+
+// The operand x of matmul, taken as the contiguous transpose of its last two
+// dims with *trans flipped when it is a transposed view of one, as it is for
+// the keys of attention. Other views are made contiguous.
+DenseTensor MatmulOperand(const DeviceContext& dev_ctx,
+                          const DenseTensor& x,
+                          bool* trans);
+
+// Calls func(offsets) at the start of each innermost row of the non-empty
+// dims, offsets[k] being the offset in elements of the row in the k-th
+// tensor of strides.
+template <size_t N, typename Func>
+void ForEachStridedRow(const std::vector<int64_t>& dims,
+                       const std::array<std::vector<int64_t>, N>& strides,
+                       Func func) {
+  const int rank = static_cast<int>(dims.size());
+  int64_t rows = 1;
+  for (int i = 0; i < rank - 1; ++i) {
+    rows *= dims[i];
+  }
+  if (rows == 0 || dims[rank - 1] == 0) {
+    return;
+  }
+  std::vector<int64_t> index(rank, 0);
+  std::array<int64_t, N> offsets{};
+  for (int64_t row = 0; row < rows; ++row) {
+    func(offsets);
+    for (int i = rank - 2; i >= 0; --i) {
+      for (size_t k = 0; k < N; ++k) {
+        offsets[k] += strides[k][i];
+      }
+      if (++index[i] < dims[i]) {
+        break;
+      }
+      for (size_t k = 0; k < N; ++k) {
+        offsets[k] -= strides[k][i] * dims[i];
+      }
+      index[i] = 0;
+    }
+  }
+}
+
+// The strides of x broadcast to rank dims aligned to the right, 0 for the
+// dims x does not have or has as 1.
+inline std::vector<int64_t> GetBroadcastStrides(const DenseTensor& x,
+                                                int rank) {
+  std::vector<int64_t> strides(rank, 0);
+  std::vector<int64_t> x_strides = GetStrides(x);
+  const int x_rank = x.dims().size();
+  for (int i = 0; i < x_rank; ++i) {
+    if (x.dims()[i] != 1) {
+      strides[rank - x_rank + i] = x_strides[i];
+    }
+  }
+  return strides;
+}
+
+// out = func(x, y) for inputs which may be strided views, broadcast as
+// elementwise kernels do with axis = -1.
+template <typename Functor, typename T, typename Context, typename OutT = T>
+void StridedElementwiseCompute(const Context& dev_ctx,
+                               const DenseTensor& x,
+                               const DenseTensor& y,
+                               Functor func,
+                               DenseTensor* out) {
+  // out may be x or y, whose memory is released by Alloc.
+  const DenseTensor x_in = x;
+  const DenseTensor y_in = y;
+  OutT* out_data = dev_ctx.template Alloc<OutT>(out);
+  std::vector<int64_t> dims = vectorize(out->dims());
+  if (dims.empty()) {
+    dims.push_back(1);
+  }
+  const int rank = static_cast<int>(dims.size());
+  std::array<std::vector<int64_t>, 3> strides = {
+      GetBroadcastStrides(x_in, rank),
+      GetBroadcastStrides(y_in, rank),
+      DenseTensorMeta::calc_strides(make_ddim(dims))};
+  const T* x_data = x_in.data<T>();
+  const T* y_data = y_in.data<T>();
+  const int64_t n = dims.back();
+  const int64_t x_stride = strides[0].back();
+  const int64_t y_stride = strides[1].back();
+  ForEachStridedRow<3>(
+      dims, strides, [&](const std::array<int64_t, 3>& offsets) {
+        const T* x_row = x_data + offsets[0];
+        const T* y_row = y_data + offsets[1];
+        OutT* out_row = out_data + offsets[2];
+        for (int64_t j = 0; j < n; ++j) {
+          out_row[j] = func(x_row[j * x_stride], y_row[j * y_stride]);
+        }
+      });
+}
+
+// Sums, or averages, the strided view x over dims into out.
+template <typename T, typename Context>
+void StridedReduceSum(const Context& dev_ctx,
+                      const DenseTensor& x,
+                      const std::vector<int64_t>& dims,
+                      bool reduce_all,
+                      bool mean,
+                      DenseTensor* out) {
+  using MT = typename phi::dtype::MPTypeTrait<T>::Type;
+  const DenseTensor x_in = x;
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  std::vector<int64_t> x_dims = vectorize(x_in.dims());
+  const int rank = static_cast<int>(x_dims.size());
+  std::vector<bool> reduced(rank, reduce_all || dims.empty());
+  for (auto dim : dims) {
+    reduced[dim < 0 ? dim + rank : dim] = true;
+  }
+  // The elements of x are added to out through strides of 0 on the reduced
+  // dims.
+  std::array<std::vector<int64_t>, 2> strides = {GetStrides(x_in),
+                                                 std::vector<int64_t>(rank)};
+  int64_t out_numel = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    if (!reduced[i]) {
+      strides[1][i] = out_numel;
+      out_numel *= x_dims[i];
+    }
+  }
+  std::vector<MT> sums(out_numel, static_cast<MT>(0));
+  const T* x_data = x_in.data<T>();
+  const int64_t n = x_dims.back();
+  const int64_t x_stride = strides[0].back();
+  const int64_t out_stride = strides[1].back();
+  ForEachStridedRow<2>(
+      x_dims, strides, [&](const std::array<int64_t, 2>& offsets) {
+        const T* x_row = x_data + offsets[0];
+        MT* sum_row = sums.data() + offsets[1];
+        for (int64_t j = 0; j < n; ++j) {
+          sum_row[j * out_stride] += static_cast<MT>(x_row[j * x_stride]);
+        }
+      });
+  const MT count =
+      static_cast<MT>(out_numel == 0 ? 0 : x_in.numel() / out_numel);
+  for (int64_t i = 0; i < out_numel; ++i) {
+    out_data[i] = static_cast<T>(mean ? sums[i] / count : sums[i]);
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
@@ -0,0 +1,199 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/kernels/funcs/weight_only_gemm.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+
+namespace phi {
+namespace funcs {
+
+namespace {
+
+// Number of dequantized weights per tile of WeightOnlyGemm, 256KB of fp32.
+constexpr int64_t kTileElements = 64 * 1024;
+
+void CheckWeightOnlyArgs(int k, int bits, int group_size) {
+  PADDLE_ENFORCE_EQ(
+      bits == 8 || bits == 4,
+      true,
+      errors::InvalidArgument(
+          "Weight-only quantization supports 8 and 4 bits, but received %d.",
+          bits));
+  if (group_size > 0) {
+    PADDLE_ENFORCE_EQ(k % group_size,
+                      0,
+                      errors::InvalidArgument(
+                          "The input size of the weight (%d) should be "
+                          "divisible by group_size (%d).",
+                          k,
+                          group_size));
+  }
+  // Two 4 bits values of a byte must share their scale.
+  const int group = group_size > 0 ? group_size : k;
+  PADDLE_ENFORCE_EQ(bits == 4 && group % 2 != 0,
+                    false,
+                    errors::InvalidArgument(
+                        "The input size of the weight and group_size should "
+                        "be even for 4 bits, but received %d and %d.",
+                        k,
+                        group_size));
+}
+
+// Dequantizes the j-th output channel of qweight into out [k].
+void DequantizeChannel(const int8_t* qweight,
+                       const float* scale,
+                       int j,
+                       int k,
+                       int n,
+                       int bits,
+                       int group_size,
+                       float* out) {
+  const int group = group_size > 0 ? group_size : k;
+  if (bits == 8) {
+    const int8_t* q = qweight + static_cast<int64_t>(j) * k;
+    for (int g = 0; g * group < k; ++g) {
+      const float s = scale[static_cast<int64_t>(g) * n + j];
+      for (int i = g * group; i < (g + 1) * group; ++i) {
+        out[i] = s * q[i];
+      }
+    }
+  } else {
+    const int8_t* q = qweight + static_cast<int64_t>(j) * (k / 2);
+    for (int g = 0; g * group < k; ++g) {
+      const float s = scale[static_cast<int64_t>(g) * n + j];
+      for (int i = g * group; i < (g + 1) * group; i += 2) {
+        // sign extend both nibbles
+        const int8_t packed = q[i / 2];
+        out[i] = s * (static_cast<int8_t>(packed << 4) >> 4);
+        out[i + 1] = s * (packed >> 4);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void WeightOnlyQuantize(const float* weight,
+                        int k,
+                        int n,
+                        int bits,
+                        int group_size,
+                        int8_t* qweight,
+                        float* scale) {
+  CheckWeightOnlyArgs(k, bits, group_size);
+  const int group = group_size > 0 ? group_size : k;
+  const float qmax = bits == 8 ? 127.f : 7.f;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int j = 0; j < n; ++j) {
+    int8_t* q = qweight + static_cast<int64_t>(j) * k * bits / 8;
+    for (int g = 0; g * group < k; ++g) {
+      float abs_max = 0.f;
+      for (int i = g * group; i < (g + 1) * group; ++i) {
+        const float v = weight[static_cast<int64_t>(i) * n + j];
+        abs_max = std::max(abs_max, std::fabs(v));
+      }
+      const float s = abs_max / qmax;
+      const float inv_s = s > 0.f ? 1.f / s : 0.f;
+      scale[static_cast<int64_t>(g) * n + j] = s;
+      auto quant = [&](int i) {
+        float v = weight[static_cast<int64_t>(i) * n + j] * inv_s;
+        return static_cast<int>(std::round(std::min(std::max(v, -qmax), qmax)));
+      };
+      for (int i = g * group; i < (g + 1) * group; ++i) {
+        if (bits == 8) {
+          q[i] = static_cast<int8_t>(quant(i));
+        } else if (i % 2 == 0) {
+          const unsigned lo = static_cast<unsigned>(quant(i)) & 0xF;
+          const unsigned hi = static_cast<unsigned>(quant(i + 1)) & 0xF;
+          q[i / 2] = static_cast<int8_t>(lo | (hi << 4));
+        }
+      }
+    }
+  }
+}
+
+void WeightOnlyGemm(const CPUContext& dev_ctx,
+                    const float* x,
+                    int m,
+                    int k,
+                    int n,
+                    const int8_t* qweight,
+                    const float* scale,
+                    const float* bias,
+                    int bits,
+                    int group_size,
+                    float* out) {
+  CheckWeightOnlyArgs(k, bits, group_size);
+  const int tile_n = static_cast<int>(
+      std::max<int64_t>(1, std::min<int64_t>(n, kTileElements / k)));
+  const int tiles = (n + tile_n - 1) / tile_n;
+  auto blas = GetBlas<CPUContext, float>(dev_ctx);
+  // The tiles are independent, each thread dequantizes into its own buffer
+  // and runs a single threaded sgemm on it.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel
+#endif
+  {
+    std::vector<float> buffer(static_cast<size_t>(tile_n) * k);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp for
+#endif
+    for (int t = 0; t < tiles; ++t) {
+      const int n0 = t * tile_n;
+      const int cur_n = std::min(tile_n, n - n0);
+      for (int j = 0; j < cur_n; ++j) {
+        DequantizeChannel(qweight,
+                          scale,
+                          n0 + j,
+                          k,
+                          n,
+                          bits,
+                          group_size,
+                          buffer.data() + static_cast<int64_t>(j) * k);
+      }
+      blas.GEMM(CblasNoTrans,
+                CblasTrans,
+                m,
+                cur_n,
+                k,
+                1.f,
+                x,
+                k,
+                buffer.data(),
+                k,
+                0.f,
+                out + n0,
+                n);
+      if (bias) {
+        for (int i = 0; i < m; ++i) {
+          float* row = out + static_cast<int64_t>(i) * n + n0;
+          for (int j = 0; j < cur_n; ++j) {
+            row[j] += bias[n0 + j];
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace funcs
+}  // namespace phi
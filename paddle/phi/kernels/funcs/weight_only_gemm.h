@@ -0,0 +1,56 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+
+namespace phi {
+namespace funcs {
+
+// Weight-only quantization of a [k, n] fp32 weight, the weight layout of fc
+// and matmul_v2. The result is stored output channel major, so that one
+// channel is contiguous: qweight is int8 [n, k], or [n, k / 2] for 4 bits
+// with two values per byte, the even row in the low nibble. The scales are
+// symmetric abs-max ones, one per output channel, or one per group of
+// group_size rows when group_size > 0: scale is [n] or [k / group_size, n].
+void WeightOnlyQuantize(const float* weight,
+                        int k,
+                        int n,
+                        int bits,
+                        int group_size,
+                        int8_t* qweight,
+                        float* scale);
+
+// out [m, n] = x [m, k] * dequantize(qweight) + bias, with qweight and scale
+// laid out as by WeightOnlyQuantize and bias optional. A few output channels
+// at a time are dequantized into a cache resident buffer and multiplied with
+// sgemm, so the full precision weight is never materialized and the memory
+// traffic of the weight is that of its quantized form.
+void WeightOnlyGemm(const CPUContext& dev_ctx,
+                    const float* x,
+                    int m,
+                    int k,
+                    int n,
+                    const int8_t* qweight,
+                    const float* scale,
+                    const float* bias,
+                    int bits,
+                    int group_size,
+                    float* out);
+
+}  // namespace funcs
+}  // namespace phi
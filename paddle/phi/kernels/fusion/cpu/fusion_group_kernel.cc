@@ -0,0 +1,87 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "glog/logging.h"
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/backends/device_code.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/utils/data_type.h"
+
+namespace phi {
+namespace fusion {
+
+static void* MutableTypeData(const CPUContext& dev_ctx,
+                             int data_type,
+                             DenseTensor* var) {
+  if (data_type == phi::TransToProtoVarType(phi::DataType::FLOAT32)) {
+    return dev_ctx.Alloc<float>(var);
+  } else if (data_type == phi::TransToProtoVarType(phi::DataType::FLOAT64)) {
+    return dev_ctx.Alloc<double>(var);
+  }
+  PADDLE_THROW(phi::errors::Unimplemented(
+      "The CPU kernel of fusion_group only supports float32 and float64."));
+}
+
+static const void* TypeData(int data_type, const DenseTensor* var) {
+  if (data_type == phi::TransToProtoVarType(phi::DataType::FLOAT32)) {
+    return var->data<float>();
+  } else if (data_type == phi::TransToProtoVarType(phi::DataType::FLOAT64)) {
+    return var->data<double>();
+  }
+  PADDLE_THROW(phi::errors::Unimplemented(
+      "The CPU kernel of fusion_group only supports float32 and float64."));
+}
+
+template <typename T, typename Context>
+void FusionGroupKernel(const Context& dev_ctx,
+                       const std::vector<const DenseTensor*>& ins,
+                       const std::vector<int>& outs_dtype,
+                       const std::vector<int>& inputs_dtype,
+                       const std::string& func_name,
+                       int type,
+                       std::vector<DenseTensor*> outs) {
+  size_t num_ins = ins.size();
+  size_t num_outs = outs.size();
+
+  phi::DeviceCode* dev_code =
+      phi::DeviceCodePool::Instance().Get(dev_ctx.GetPlace(), func_name);
+  VLOG(3) << "func_name: " << func_name;
+
+  if (type == 0) {
+    size_t n = ins[0]->numel();
+    std::vector<void*> args;
+    args.push_back(&n);
+    std::vector<const void*> ptrs(num_ins + num_outs);
+    for (size_t i = 0; i < num_ins; ++i) {
+      ptrs[i] = TypeData(inputs_dtype[i], ins[i]);
+      args.push_back(&ptrs[i]);
+    }
+    for (size_t j = 0; j < num_outs; ++j) {
+      ptrs[num_ins + j] = MutableTypeData(dev_ctx, outs_dtype[j], outs[j]);
+      args.push_back(&ptrs[num_ins + j]);
+    }
+    dev_code->Launch(n, &args);
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fusion_group,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusionGroupKernel,
+                   float,
+                   double) {}
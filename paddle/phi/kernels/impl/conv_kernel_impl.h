@@ -14,16 +14,81 @@
 
 #pragma once
 
+#include <type_traits>
+
+#include "paddle/phi/core/macros.h"
 #include "paddle/phi/kernels/conv_kernel.h"
 #include "paddle/phi/kernels/cpu/conv_util.h"
 #include "paddle/phi/kernels/funcs/batch_norm_utils.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/cpu_conv.h"
 #include "paddle/phi/kernels/funcs/im2col.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 #include "paddle/phi/kernels/funcs/vol2col.h"
 
 namespace phi {
 
+// Runs the 2D conv with one of the algorithms of funcs/cpu_conv.h, returning
+// false for the contexts, types and shapes left to im2col + GEMM.
+template <typename T, typename Context>
+bool TryCPUConv2D(const Context& dev_ctx UNUSED,
+                  const DenseTensor& input UNUSED,
+                  const DenseTensor& filter UNUSED,
+                  const std::vector<int>& ksize UNUSED,
+                  const std::vector<int>& strides UNUSED,
+                  const std::vector<int>& paddings UNUSED,
+                  const std::vector<int>& dilations UNUSED,
+                  int groups UNUSED,
+                  DenseTensor* output UNUSED) {
+  return false;
+}
+
+template <typename T>
+typename std::enable_if<std::is_same<T, float>::value ||
+                            std::is_same<T, double>::value,
+                        bool>::type
+TryCPUConv2D(const CPUContext& dev_ctx,
+             const DenseTensor& input,
+             const DenseTensor& filter,
+             const std::vector<int>& ksize,
+             const std::vector<int>& strides,
+             const std::vector<int>& paddings,
+             const std::vector<int>& dilations,
+             int groups,
+             DenseTensor* output) {
+  auto in_dims = input.dims();
+  auto out_dims = output->dims();
+  funcs::CPUConv2DShape shape = {in_dims[0],
+                                 in_dims[1],
+                                 in_dims[2],
+                                 in_dims[3],
+                                 out_dims[1],
+                                 out_dims[2],
+                                 out_dims[3],
+                                 ksize[0],
+                                 ksize[1],
+                                 strides[0],
+                                 strides[1],
+                                 paddings[0],
+                                 paddings[1],
+                                 paddings[2],
+                                 paddings[3],
+                                 dilations[0],
+                                 dilations[1],
+                                 groups};
+  funcs::CPUConvAlgo algo = funcs::SelectCPUConvAlgo(shape);
+  if (algo == funcs::CPUConvAlgo::kIm2ColGemm) {
+    return false;
+  }
+  funcs::CPUConv2D<T>(dev_ctx,
+                      shape,
+                      algo,
+                      input.data<T>(),
+                      filter.data<T>(),
+                      output->data<T>());
+  return true;
+}
+
 template <typename T, typename Context>
 void ConvKernelImpl(const Context& dev_ctx,
                     const DenseTensor& input,
@@ -70,6 +135,22 @@ void ConvKernelImpl(const Context& dev_ctx,
   UpdatePaddingAndDilation(
       &paddings, &dilations, padding_algorithm, in_data_dims, strides, ksize);
 
+  if (filter_dims.size() == 4 &&
+      TryCPUConv2D<T>(dev_ctx,
+                      transformed_input,
+                      filter,
+                      ksize,
+                      strides,
+                      paddings,
+                      dilations,
+                      groups,
+                      &transformed_output)) {
+    if (channel_last) {
+      TransToChannelLast<Context, T>(dev_ctx, &transformed_output, output);
+    }
+    return;
+  }
+
   const int batch_size = static_cast<int>(transformed_input.dims()[0]);
 
   // filter_shape_vec:
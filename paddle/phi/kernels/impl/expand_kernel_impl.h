@@ -19,6 +19,7 @@
 
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 #define MAX_RANK_SUPPORTED 6
 
 namespace phi {
@@ -146,28 +147,29 @@ void ExpandKernel(const Context& ctx,
           "less than or equal to %d.",
           shape_size,
           MAX_RANK_SUPPORTED));
+  const DenseTensor x_in = funcs::Contiguous(ctx, x);
   rank = std::max(rank, static_cast<int>(shape_size));
   switch (rank) {
     case 0:
-      Expand<Context, T, 0>(ctx, x, shape, out);
+      Expand<Context, T, 0>(ctx, x_in, shape, out);
       break;
     case 1:
-      Expand<Context, T, 1>(ctx, x, shape, out);
+      Expand<Context, T, 1>(ctx, x_in, shape, out);
       break;
     case 2:
-      Expand<Context, T, 2>(ctx, x, shape, out);
+      Expand<Context, T, 2>(ctx, x_in, shape, out);
       break;
     case 3:
-      Expand<Context, T, 3>(ctx, x, shape, out);
+      Expand<Context, T, 3>(ctx, x_in, shape, out);
       break;
     case 4:
-      Expand<Context, T, 4>(ctx, x, shape, out);
+      Expand<Context, T, 4>(ctx, x_in, shape, out);
       break;
     case 5:
-      Expand<Context, T, 5>(ctx, x, shape, out);
+      Expand<Context, T, 5>(ctx, x_in, shape, out);
       break;
     case 6:
-      Expand<Context, T, 6>(ctx, x, shape, out);
+      Expand<Context, T, 6>(ctx, x_in, shape, out);
       break;
   }
 }
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/blas/blaslt_impl.cu.h"
 #include "paddle/phi/kernels/funcs/complex_functors.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 #if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 11060
 #include "paddle/phi/kernels/autotune/auto_tune_base.h"
 #endif
@@ -981,6 +982,14 @@ void MatmulKernel(const Context& ctx,
       0,
       phi::errors::InvalidArgument("The Input(Y) dims size must not be equal 0,"
                                    " but reviced dims size is 0. "));
+  if (!x.is_contiguous() || !y.is_contiguous()) {
+    bool trans_x = transpose_x;
+    bool trans_y = transpose_y;
+    const DenseTensor x_in = funcs::MatmulOperand(ctx, x, &trans_x);
+    const DenseTensor y_in = funcs::MatmulOperand(ctx, y, &trans_y);
+    MatmulKernel<T, Context>(ctx, x_in, y_in, trans_x, trans_y, out);
+    return;
+  }
   const std::vector<std::int64_t> x_dims = vectorize(x.dims());
   const std::vector<std::int64_t> y_dims = vectorize(y.dims());
   MatMulFunction<Context, T>(
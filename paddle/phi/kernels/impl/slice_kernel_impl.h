@@ -20,6 +20,7 @@
 #include "paddle/phi/kernels/funcs/eigen/common.h"
 #include "paddle/phi/kernels/funcs/eigen/eigen_function.h"
 #include "paddle/phi/kernels/funcs/slice_utils.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 #include "paddle/phi/kernels/slice_kernel.h"
 
 namespace phi {
@@ -113,30 +114,32 @@ void SliceKernel(const Context& ctx,
   auto& starts = starts_arr.GetData();
   auto& ends = ends_arr.GetData();
 
+  const DenseTensor x = funcs::Contiguous(ctx, input);
+
   switch (rank) {
     case 1:
       SliceCompute<T, Context, 1>(
-          ctx, input, axes, starts, ends, infer_flags, decrease_axis, out);
+          ctx, x, axes, starts, ends, infer_flags, decrease_axis, out);
       break;
     case 2:
       SliceCompute<T, Context, 2>(
-          ctx, input, axes, starts, ends, infer_flags, decrease_axis, out);
+          ctx, x, axes, starts, ends, infer_flags, decrease_axis, out);
       break;
     case 3:
       SliceCompute<T, Context, 3>(
-          ctx, input, axes, starts, ends, infer_flags, decrease_axis, out);
+          ctx, x, axes, starts, ends, infer_flags, decrease_axis, out);
       break;
     case 4:
       SliceCompute<T, Context, 4>(
-          ctx, input, axes, starts, ends, infer_flags, decrease_axis, out);
+          ctx, x, axes, starts, ends, infer_flags, decrease_axis, out);
       break;
     case 5:
       SliceCompute<T, Context, 5>(
-          ctx, input, axes, starts, ends, infer_flags, decrease_axis, out);
+          ctx, x, axes, starts, ends, infer_flags, decrease_axis, out);
       break;
     case 6:
       SliceCompute<T, Context, 6>(
-          ctx, input, axes, starts, ends, infer_flags, decrease_axis, out);
+          ctx, x, axes, starts, ends, infer_flags, decrease_axis, out);
       break;
     default:
       PADDLE_THROW(phi::errors::InvalidArgument(
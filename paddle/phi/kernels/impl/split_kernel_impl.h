@@ -20,6 +20,7 @@
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/funcs/concat_and_split_functor.h"
 #include "paddle/phi/kernels/funcs/strided_memcpy.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 
 namespace phi {
 template <typename T, typename Context>
@@ -28,6 +29,8 @@ void SplitKernel(const Context& dev_ctx,
                  const IntArray& sections UNUSED,
                  const Scalar& axis_scalar,
                  std::vector<DenseTensor*> outs) {
+  const DenseTensor x_in = funcs::Contiguous(dev_ctx, x);
+
   std::vector<const DenseTensor*> shape_refer;
   for (size_t j = 0; j < outs.size(); ++j) {
     dev_ctx.template Alloc<T>(outs[j]);
@@ -38,10 +41,10 @@ void SplitKernel(const Context& dev_ctx,
   // Sometimes direct copies will be faster, this maybe need deeply analysis.
   if (axis == 0 && outs.size() < 10) {
     phi::funcs::StridedMemcpyWithAxis0<T, Context>(
-        dev_ctx, x, shape_refer, &outs);
+        dev_ctx, x_in, shape_refer, &outs);
   } else {
     phi::funcs::SplitFunctor<Context, T> functor;
-    functor(dev_ctx, x, shape_refer, axis, &outs);
+    functor(dev_ctx, x_in, shape_refer, axis, &outs);
   }
 }
 
@@ -28,11 +28,12 @@ void StridedSliceRawKernel(const Context& dev_ctx,
                            const std::vector<int>& infer_flags,
                            const std::vector<int>& decrease_axis,
                            DenseTensor* out) {
+  const DenseTensor x_in = funcs::Contiguous(dev_ctx, x);
   int rank = x.dims().size();
 #define SLICE_CASE(Rank)                                        \
   case Rank:                                                    \
     funcs::StridedSliceCompute<Context, T, Rank>(dev_ctx,       \
-                                                 x,             \
+                                                 x_in,          \
                                                  axes,          \
                                                  starts,        \
                                                  ends,          \
@@ -49,6 +49,7 @@ PD_REGISTER_KERNEL(sum,
                    int64_t,
                    complex64,
                    complex128) {
+  kernel->InputAt(0).SetSupportStrided(true);
   kernel->OutputAt(0).SetDataType(phi::DataType::UNDEFINED);
 }
 
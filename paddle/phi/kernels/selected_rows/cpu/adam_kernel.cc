@@ -14,6 +14,8 @@
 
 #include "paddle/phi/kernels/selected_rows/adam_kernel.h"
 
+#include <algorithm>
+
 #include "gflags/gflags.h"
 #include "glog/logging.h"
 
@@ -184,17 +186,16 @@ void AdamDenseParamSparseGradKernel(
       VLOG(1) << "FLAGS_inner_op_parallelism " << FLAGS_inner_op_parallelism
               << " is two large!";
     }
-    auto& grad_rows = grad_merge.rows();
-    std::unordered_map<size_t, int> row_id_to_grad_row_offset;
+    // The rows of grad_merge are strictly ascending, so every thread walks
+    // its range of param rows and the grad rows falling into it together.
+    const int64_t* grad_rows_begin = grad_merge.rows().data();
+    const int64_t* grad_rows_end = grad_rows_begin + grad_merge.rows().size();
     size_t param_row_count = param.numel() / row_numel;
     if (param_row_count < 1000) {
       VLOG(1) << "param_row_count should be larger then 1000 to use "
                  "multi thread, currently "
               << param_row_count;
     }
-    for (size_t i = 0; i < grad_rows.size(); ++i) {
-      row_id_to_grad_row_offset[grad_rows[i]] = i;
-    }
     std::vector<std::future<void>> fs;
     int64_t line_in_each_thread =
         param_row_count / FLAGS_inner_op_parallelism + 1;
@@ -208,19 +209,23 @@ void AdamDenseParamSparseGradKernel(
         end = static_cast<int64_t>(param_row_count);
       }
       fs.push_back(phi::Async([&functor,
-                               &row_id_to_grad_row_offset,
                                &grad_data,
+                               grad_rows_begin,
+                               grad_rows_end,
                                row_numel,
                                start,
                                end]() {
+        const int64_t* grad_row =
+            std::lower_bound(grad_rows_begin, grad_rows_end, start);
         for (int64_t row_id = start; row_id < end; ++row_id) {
-          auto iter = row_id_to_grad_row_offset.find(row_id);
-          if (iter != row_id_to_grad_row_offset.end()) {
+          if (grad_row != grad_rows_end && *grad_row == row_id) {
+            const size_t grad_offset = grad_row - grad_rows_begin;
             for (size_t row_offset = 0U; row_offset < row_numel; ++row_offset) {
               functor.adam_update(
                   row_id * row_numel + row_offset,
-                  grad_data[iter->second * row_numel + row_offset]);
+                  grad_data[grad_offset * row_numel + row_offset]);
             }
+            ++grad_row;
           } else {
             for (size_t row_offset = 0U; row_offset < row_numel; ++row_offset) {
               functor.adam_update(row_id * row_numel + row_offset, 0);
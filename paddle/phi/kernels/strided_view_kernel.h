@@ -0,0 +1,84 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "paddle/phi/common/int_array.h"
+#include "paddle/phi/common/scalar.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+
+// The view kernels registered as `<kernel>_strided`. With
+// FLAGS_use_stride_kernel, the API functions dispatch to them instead of the
+// kernels of the same name, and they make out a strided view of the memory
+// of x. The kernels calling one another, e.g. TransposeKernel, still get
+// contiguous outputs.
+
+template <typename T, typename Context>
+void TransposeStridedKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            const std::vector<int>& axis,
+                            DenseTensor* out);
+
+template <typename T, typename Context>
+void SliceStridedKernel(const Context& dev_ctx,
+                        const DenseTensor& input,
+                        const std::vector<int64_t>& axes,
+                        const IntArray& starts,
+                        const IntArray& ends,
+                        const std::vector<int64_t>& infer_flags,
+                        const std::vector<int64_t>& decrease_axis,
+                        DenseTensor* out);
+
+// Falls back to StridedSliceKernel for the negative steps.
+template <typename T, typename Context>
+void StridedSliceStridedKernel(const Context& dev_ctx,
+                               const DenseTensor& x,
+                               const std::vector<int>& axes,
+                               const IntArray& starts,
+                               const IntArray& ends,
+                               const IntArray& strides,
+                               DenseTensor* out);
+
+template <typename T, typename Context>
+void ExpandStridedKernel(const Context& dev_ctx,
+                         const DenseTensor& x,
+                         const IntArray& shape,
+                         DenseTensor* out);
+
+template <typename T, typename Context>
+void SplitStridedKernel(const Context& dev_ctx,
+                        const DenseTensor& x,
+                        const IntArray& sections,
+                        const Scalar& axis,
+                        std::vector<DenseTensor*> out);
+
+template <typename T, typename Context>
+void SplitWithNumStridedKernel(const Context& dev_ctx,
+                               const DenseTensor& x,
+                               int num,
+                               const Scalar& axis,
+                               std::vector<DenseTensor*> out);
+
+template <typename T, typename Context>
+void UnsqueezeStridedKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            const IntArray& axes,
+                            DenseTensor* out,
+                            DenseTensor* xshape);
+
+}  // namespace phi
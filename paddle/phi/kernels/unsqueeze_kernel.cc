@@ -17,6 +17,7 @@
 #include "paddle/phi/backends/all_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
 #include "paddle/phi/kernels/funcs/unsqueeze.h"
 
 namespace phi {
@@ -30,12 +31,13 @@ void UnsqueezeInferKernel(const Context& dev_ctx,
   if (axes.FromTensor()) {
     out_dims = funcs::GetUnsqueezeShape(axes.GetData(), x_dims);
   }
+  const DenseTensor x_in = funcs::Contiguous(dev_ctx, x);
   out->Resize(out_dims);
   dev_ctx.template Alloc<T>(out);
-  if (x.Holder() == out->Holder()) {
+  if (x_in.Holder() == out->Holder()) {
     return;
   }
-  phi::Copy(dev_ctx, x, dev_ctx.GetPlace(), false, out);
+  phi::Copy(dev_ctx, x_in, dev_ctx.GetPlace(), false, out);
   out->Resize(out_dims);  // copy will reset the dims.
 }
 
@@ -63,7 +65,9 @@ PD_REGISTER_KERNEL(unsqueeze_infer,
                    int8_t,
                    int64_t,
                    phi::dtype::complex<float>,
-                   phi::dtype::complex<double>) {}
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
 
 PD_REGISTER_KERNEL(unsqueeze,
                    CPU,
@@ -79,7 +83,9 @@ PD_REGISTER_KERNEL(unsqueeze,
                    int8_t,
                    int64_t,
                    phi::dtype::complex<float>,
-                   phi::dtype::complex<double>) {}
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetSupportStrided(true);
+}
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 PD_REGISTER_KERNEL(unsqueeze_infer,
                    GPU,
@@ -191,6 +191,19 @@ class Communicator:
             return
         self.communicator_.is_running()
 
+    def get_send_metrics(self):
+        """
+        Get the gradients the communicator sent per second (send_rate) and
+        merged per send (merge_ratio) since its first send.
+
+        Returns:
+            dict
+        """
+        if self.communicator_ is None:
+            print('you must call init_with_ctx first to get send metrics')
+            return {}
+        return self.communicator_.get_send_metrics()
+
     def recv(self):
         self.communicator_.recv()
 
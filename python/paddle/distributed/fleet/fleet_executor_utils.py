@@ -64,6 +64,7 @@ class TaskNode:
         self.vars_to_shape = vars_to_shape
         self.run_pre_steps = None
         self.run_at_offset = None
+        self.pipeline_pass = None
         self.node = None
         self.upstreams = []
         self.downstreams = []
@@ -109,6 +110,8 @@ class TaskNode:
                 self.node.set_vars_to_shape(self.vars_to_shape)
             if self.vars_to_dtype:
                 self.node.set_vars_to_dtype(self.vars_to_dtype)
+            if self.pipeline_pass:
+                self.node.set_pipeline_pass(*self.pipeline_pass)
             for up in self.upstreams:
                 self.node.add_upstream_task(up[0], up[1], up[2])
             for down in self.downstreams:
@@ -140,6 +143,18 @@ class TaskNode:
         else:
             self.node.set_run_at_offset(offset)
 
+    def set_pipeline_pass(self, pipeline_pass, chunk=0):
+        """
+        Let the task node run the forward or backward steps of model chunk
+        `chunk` in the pipeline schedule of its rank.
+        :param pipeline_pass (core.PipelinePass): FORWARD or BACKWARD.
+        :param chunk (int): The model chunk of the stage, the virtual stage.
+        """
+        if self.lazy_initialize:
+            self.pipeline_pass = (pipeline_pass, chunk)
+        else:
+            self.node.set_pipeline_pass(pipeline_pass, chunk)
+
     def add_upstream_task(
         self, upstream, buffer_size=2, depend_type=core.DependType.NORMAL
     ):
@@ -229,12 +244,18 @@ class CoordSys:
 
 class FleetExecutorUtils:
     def __init__(
-        self, dist_strategy=None, rank=None, nrank=None, max_run_times=None
+        self,
+        dist_strategy=None,
+        rank=None,
+        nrank=None,
+        max_run_times=None,
+        pipeline_schedule=None,
     ):
         self.dist_strategy = dist_strategy
         self.rank = rank
         self.nrank = nrank
         self.max_run_times = max_run_times
+        self.pipeline_schedule = pipeline_schedule
         self.is_auto_parallel = True if dist_strategy is None else False
         self.num_of_functionality = 4
         self.coord_sys = None
@@ -304,6 +325,13 @@ class FleetExecutorUtils:
         pp_buff_size = int(
             self.dist_strategy['pp_degree'] - self.coord['pp_idx']
         )
+        # The pipeline schedule bounds the micro batches in flight itself,
+        # the buffers between the forward and backward nodes must not.
+        inter_buff_size = 2
+        if self.pipeline_schedule is not None:
+            pp_buff_size = inter_buff_size = self.max_run_times
+            task_node_map["fwd"].set_pipeline_pass(core.PipelinePass.FORWARD)
+            task_node_map["bwd"].set_pipeline_pass(core.PipelinePass.BACKWARD)
         task_node_map["lr"].add_downstream_task(cur_start_id + 1)
         task_node_map["fwd"].add_upstream_task(cur_start_id)
         task_node_map["fwd"].add_downstream_task(cur_start_id + 2, pp_buff_size)
@@ -321,11 +349,19 @@ class FleetExecutorUtils:
         prev_pp_start_id = pp_upstream * self.num_of_functionality
         next_pp_start_id = pp_downstream * self.num_of_functionality
         if not first_stage:
-            task_node_map["fwd"].add_upstream_task(prev_pp_start_id + 1)
-            task_node_map["bwd"].add_downstream_task(prev_pp_start_id + 2)
+            task_node_map["fwd"].add_upstream_task(
+                prev_pp_start_id + 1, inter_buff_size
+            )
+            task_node_map["bwd"].add_downstream_task(
+                prev_pp_start_id + 2, inter_buff_size
+            )
         if not last_stage:
-            task_node_map["fwd"].add_downstream_task(next_pp_start_id + 1)
-            task_node_map["bwd"].add_upstream_task(next_pp_start_id + 2)
+            task_node_map["fwd"].add_downstream_task(
+                next_pp_start_id + 1, inter_buff_size
+            )
+            task_node_map["bwd"].add_upstream_task(
+                next_pp_start_id + 2, inter_buff_size
+            )
         return task_node_map
 
     def construct_task_nodes_1f1b(self, program_map):
@@ -420,6 +456,7 @@ def run1f1b(
     dist_opt,
     nrank,
     with_standalone_executor=False,
+    pipeline_schedule=None,
 ):
     """
     Split the program to support 1f1b pipeline scheduler.
@@ -432,6 +469,7 @@ def run1f1b(
     :param dist_opt: The fleet_opt configured by user.
     :param nrank: Number of workers (can be got from fleet.worker_num()).
     :param with_standalone_executor: Experiment feature, use fleet executor with standalone executor.
+    :param pipeline_schedule: A PipelineScheduleDesc of GPipe or 1F1B for the forward and backward nodes to run in its order, whose stage and num_stages are filled in from dist_opt.
     :return:
         task_nodes (list): four task nodes for current rank
         task_id_to_rank (dict): task nodes' ids to it's corresponding rank
@@ -442,7 +480,14 @@ def run1f1b(
         rank=rank,
         nrank=nrank,
         max_run_times=max_run_times,
+        pipeline_schedule=pipeline_schedule,
     )
+    if pipeline_schedule is not None:
+        assert (
+            pipeline_schedule.num_virtual_stages == 1
+        ), "The 1F1B scheduler splits a stage into one forward node and one backward node, provide task nodes for the chunks of an interleaved schedule."
+        pipeline_schedule.num_stages = fleet_executor_utils.coord_sys.pp_degree
+        pipeline_schedule.stage = fleet_executor_utils.coord['pp_idx']
     op_list_map = fleet_executor_utils.split_program_to_op_list(program)
     task_node_map = None
     if with_standalone_executor:
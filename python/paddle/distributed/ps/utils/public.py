@@ -129,6 +129,9 @@ class TrainerRuntimeConfig:
         self.runtime_configs['communicator_is_sgd_optimizer'] = os.getenv(
             "FLAGS_communicator_is_sgd_optimizer", "1"
         )
+        self.runtime_configs['communicator_adaptive_merge'] = os.getenv(
+            "FLAGS_communicator_adaptive_merge", "0"
+        )
 
     def get_communicator_flags(self):
         need_keys = []
@@ -2216,6 +2216,7 @@ class Executor:
         cur_rank = int(os.getenv("PADDLE_TRAINER_ID", 0))
         trainer_endpoints = os.getenv("PADDLE_TRAINER_ENDPOINTS", "").split(',')
         nrank = len(trainer_endpoints)
+        pipeline_schedule = self._prepare_pipeline_schedule(fleet_opt)
 
         assert 'scheduler' in fleet_opt or 'tasks' in fleet_opt, (
             "Fleet executor need configuration for scheduler, you can choose from 1F1B or Origin. "
@@ -2249,6 +2250,7 @@ class Executor:
                     fleet_opt.get('dist_strategy', {}),
                     nrank,
                     with_standalone_executor,
+                    pipeline_schedule,
                 )
             elif scheduler == 'Origin':
                 from paddle.distributed.fleet.fleet_executor_utils import origin
@@ -2278,6 +2280,9 @@ class Executor:
         inference_root_scope_vars = (
             fleet_opt["fetch_var"] if "fetch_var" in fleet_opt else []
         )
+        pipeline_schedule_str = b""
+        if pipeline_schedule is not None:
+            pipeline_schedule_str = pipeline_schedule.SerializeToString()
         self._fleet_executor.init(
             carrier_id,
             program.desc,
@@ -2288,8 +2293,32 @@ class Executor:
             task_id_to_rank,
             inference_root_scope_vars,
             micro_scope_list,
+            pipeline_schedule_str,
         )
 
+    def _prepare_pipeline_schedule(self, fleet_opt):
+        """
+        Build the PipelineScheduleDesc of fleet_opt["pipeline_schedule"], a
+        dict of its fields, mode being GPipe, 1F1B or Interleaved1F1B. The
+        forward and backward task nodes set_pipeline_pass run in its order.
+        """
+        if not fleet_opt.get("pipeline_schedule"):
+            return None
+        from ..distributed.fleet.proto import fleet_executor_desc_pb2
+
+        pipeline_schedule = fleet_executor_desc_pb2.PipelineScheduleDesc()
+        for key, value in fleet_opt["pipeline_schedule"].items():
+            setattr(pipeline_schedule, key, value)
+        assert pipeline_schedule.mode in [
+            "GPipe",
+            "1F1B",
+            "Interleaved1F1B",
+        ], (
+            "The pipeline schedule should be GPipe, 1F1B or Interleaved1F1B, "
+            "but received " + pipeline_schedule.mode + "."
+        )
+        return pipeline_schedule
+
     def _run_using_fleet_executor(
         self,
         program=None,
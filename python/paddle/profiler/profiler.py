@@ -105,9 +105,12 @@ class ProfilerTarget(Enum):
     - **ProfilerTarget.CPU** : Profile events on CPU.
 
     - **ProfilerTarget.GPU** : Profile events on GPU.
+
+    - **ProfilerTarget.PERF_COUNTER** : Collect the CPU hardware performance counters (cycles, instructions, cache and branch misses) of each op type, on Linux. Only the thread running an op is counted, not the worker threads it uses. It is never chosen by default.
     """
     CPU = 0
     GPU = 1
+    PERF_COUNTER = 2
     CUSTOM_DEVICE = 3
 
 
@@ -481,7 +484,10 @@ class Profiler:
         if targets:
             self.targets = set(targets)
             for target in targets:
-                if target not in supported_targets:
+                if (
+                    target not in supported_targets
+                    and target != ProfilerTarget.PERF_COUNTER
+                ):
                     self.targets.remove(target)
                     warn(
                         "Profiling {} is not supported in current context.".format(
@@ -495,6 +501,8 @@ class Profiler:
             profileoption.trace_switch |= 1
         if ProfilerTarget.GPU in self.targets:
             profileoption.trace_switch |= 1 << 1
+        if ProfilerTarget.PERF_COUNTER in self.targets:
+            profileoption.trace_switch |= 1 << 2
         if ProfilerTarget.CUSTOM_DEVICE in self.targets:
             profileoption.trace_switch |= 1 << 3
             if not custom_device_types:
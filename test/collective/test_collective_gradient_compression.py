@@ -0,0 +1,178 @@
+# Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import multiprocessing
+import socket
+import time
+import unittest
+from contextlib import closing
+
+import numpy as np
+
+import paddle
+from paddle.fluid import core
+
+port_set = set()
+
+# The bucket sizes of the reducer in bytes, small for the models to have a
+# few buckets.
+GROUP_SIZE_LIMITS = [256 * 1024, 1024 * 1024]
+
+
+def find_free_port():
+    def _free_port():
+        with closing(socket.socket(socket.AF_INET, socket.SOCK_STREAM)) as s:
+            s.bind(('', 0))
+            return s.getsockname()[1]
+
+    while True:
+        port = _free_port()
+        if port not in port_set:
+            port_set.add(port)
+            return port
+
+
+class MLP(paddle.nn.Layer):
+    def __init__(self, width):
+        super().__init__()
+        self.fc1 = paddle.nn.Linear(64, width)
+        self.fc2 = paddle.nn.Linear(width, width)
+        self.fc3 = paddle.nn.Linear(width, 1)
+
+    def forward(self, x):
+        x = paddle.nn.functional.relu(self.fc1(x))
+        x = paddle.nn.functional.relu(self.fc2(x))
+        return self.fc3(x)
+
+
+def train(rank, nranks, port, compression, width, steps, out_dict):
+    """Trains MLP on the data of rank by data parallel over gloo, the
+    reducer sending the gradients through a hook of compression, or without
+    a hook when compression is None."""
+    paddle.set_device('cpu')
+    store = core.TCPStore("127.0.0.1", port, rank == 0, nranks, 60)
+    pg = core.ProcessGroupGloo.create(store, rank, nranks)
+
+    paddle.seed(2023)
+    model = MLP(width)
+    teacher = MLP(16)
+    params = list(model.parameters())
+    is_sparse_gradient = [False] * len(params)
+    group_indices = core.eager_assign_group_by_size(
+        params, is_sparse_gradient, GROUP_SIZE_LIMITS
+    )
+    reducer = core.EagerReducer(
+        params,
+        list(reversed(group_indices)),
+        is_sparse_gradient,
+        pg,
+        GROUP_SIZE_LIMITS,
+        False,
+    )
+    if compression is not None:
+        reducer.set_comm_hook(compression, topk_ratio=0.05)
+    opt = paddle.optimizer.SGD(learning_rate=0.05, parameters=params)
+
+    rng = np.random.RandomState(rank)
+    losses = []
+    start = time.time()
+    for _ in range(steps):
+        x = paddle.to_tensor(rng.randn(32, 64).astype('float32'))
+        with paddle.no_grad():
+            y = teacher(x)
+        loss = ((model(x) - y) ** 2).mean()
+        reducer.prepare_for_backward([loss])
+        loss.backward()
+        opt.step()
+        opt.clear_grad()
+        losses.append(float(loss))
+    step_ms = (time.time() - start) * 1000 / steps
+
+    wire_bytes, raw_bytes = reducer.comm_hook_bytes()
+    reducer.clear_comm_hook()
+    out_dict[rank] = {
+        "losses": losses,
+        "checksum": [float(p.sum()) for p in params],
+        "step_ms": step_ms,
+        "wire_bytes": wire_bytes,
+        "raw_bytes": raw_bytes,
+    }
+
+
+def run(nranks, compression, width, steps):
+    port = find_free_port()
+    manager = multiprocessing.Manager()
+    out_dict = manager.dict()
+    jobs = []
+    for rank in range(nranks):
+        p = multiprocessing.Process(
+            target=train,
+            args=(rank, nranks, port, compression, width, steps, out_dict),
+        )
+        jobs.append(p)
+        p.start()
+    for p in jobs:
+        p.join()
+    return [out_dict[rank] for rank in range(nranks)]
+
+
+class TestGradientCompression(unittest.TestCase):
+    def check(self, results):
+        # The ranks step on the same gradients.
+        for result in results[1:]:
+            np.testing.assert_allclose(
+                result["checksum"], results[0]["checksum"], rtol=1e-6
+            )
+
+    def test_compressions(self):
+        nranks, width, steps = 2, 256, 40
+        baseline = run(nranks, None, width, steps)
+        self.check(baseline)
+        no_hook_loss = np.mean(baseline[0]["losses"][-10:])
+        for compression in ["none", "fp16", "bf16", "topk"]:
+            results = run(nranks, compression, width, steps)
+            self.check(results)
+            loss = np.mean(results[0]["losses"][-10:])
+            wire_bytes = results[0]["wire_bytes"]
+            raw_bytes = results[0]["raw_bytes"]
+            if compression == "none":
+                np.testing.assert_allclose(
+                    results[0]["checksum"],
+                    baseline[0]["checksum"],
+                    rtol=1e-5,
+                )
+                self.assertEqual(wire_bytes, raw_bytes)
+            elif compression == "topk":
+                self.assertLess(wire_bytes, raw_bytes * 0.15)
+                self.assertLess(loss, results[0]["losses"][0] * 0.5)
+            else:
+                self.assertEqual(wire_bytes * 2, raw_bytes)
+                self.assertLess(loss, no_hook_loss * 1.1)
+
+    def test_scaling_benchmark(self):
+        width, steps = 1024, 10
+        for nranks in [2, 4]:
+            for compression in [None, "none", "fp16", "bf16", "topk"]:
+                result = run(nranks, compression, width, steps)[0]
+                print(
+                    f"{nranks} ranks, hook {compression}: "
+                    f"{result['step_ms']:.1f} ms per step, "
+                    f"{result['wire_bytes'] / steps / 1e6:.2f} MB "
+                    f"sent per step of "
+                    f"{result['raw_bytes'] / steps / 1e6:.2f} MB"
+                )
+
+
+if __name__ == '__main__':
+    unittest.main()
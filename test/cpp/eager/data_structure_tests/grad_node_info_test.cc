@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/eager/grad_node_info.h"
 
+#include <thread>
+
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/eager/autograd_meta.h"
@@ -160,3 +162,48 @@ TEST(GradNodeInfo, Edge) {
   CHECK_EQ(edge2.GetEdgeRankInfo().first, size_t(4));
   CHECK_EQ(edge2.GetEdgeRankInfo().second, size_t(5));
 }
+
+TEST(GradNodeInfo, PooledGradNode) {
+  auto node = egr::MakePooled<eager_test::GradTestNode>(5, 1, 1);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(node.get()) %
+               alignof(eager_test::GradTestNode),
+           uintptr_t(0));
+  CHECK_EQ(node->val_, 5.0f);
+  // The block of a released node is reused by the next one on this thread.
+  auto* address = node.get();
+  node.reset();
+  node = egr::MakePooled<eager_test::GradTestNode>(6, 1, 1);
+  CHECK_EQ(node.get(), address);
+
+  // Blocks freed by another thread are reused too.
+  std::vector<std::shared_ptr<egr::GradNodeBase>> nodes;
+  std::thread producer([&nodes]() {
+    for (int i = 0; i < 10000; ++i) {
+      nodes.emplace_back(egr::MakePooled<eager_test::GradTestNode>(i, 1, 1));
+    }
+  });
+  producer.join();
+  nodes.clear();
+  const int64_t reserved = egr::EagerObjectPool::ReservedBytes();
+  for (int i = 0; i < 10000; ++i) {
+    nodes.emplace_back(egr::MakePooled<eager_test::GradTestNode>(i, 1, 1));
+  }
+  CHECK_EQ(egr::EagerObjectPool::ReservedBytes(), reserved);
+}
+
+TEST(GradNodeInfo, ReleaseLongGraph) {
+  // A chain much deeper than the stack would allow to destroy recursively.
+  const int num_nodes = 1000000;
+  auto head = egr::MakePooled<eager_test::GradTestNode>(0, 1, 1);
+  std::weak_ptr<egr::GradNodeBase> tail = head;
+  for (int i = 1; i < num_nodes; ++i) {
+    auto node = egr::MakePooled<eager_test::GradTestNode>(i, 1, 1);
+    node->MutableOutputMeta()[0].resize(1);
+    node->MutableOutputMeta()[0][0].SetEdge(
+        head, std::make_pair(size_t(0), size_t(0)));
+    head = node;
+  }
+  CHECK(!tail.expired());
+  head.reset();
+  CHECK(tail.expired());
+}
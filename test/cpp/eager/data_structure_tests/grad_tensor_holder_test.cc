@@ -31,7 +31,7 @@ PD_DECLARE_KERNEL(add, CPU, ALL_LAYOUT);
 using namespace egr;  // NOLINT
 
 TEST(GradTensorHolder, Constructor) {
-  std::vector<GradSlotMeta> slot_meta(1);
+  GradSlotMetaVector slot_meta(1);
   GradTensorHolder grad_tensor_holder = GradTensorHolder({slot_meta});
   GradTensorHolder grad_tensor_holder2 = GradTensorHolder(grad_tensor_holder);
 
@@ -73,7 +73,7 @@ TEST(GradTensorHolder, Interfaces) {
   paddle::Tensor et1 = paddle::Tensor(dt1);
 
   // Constructor empty GradTensorHolder
-  std::vector<GradSlotMeta> slot_meta(1);
+  GradSlotMetaVector slot_meta(1);
   GradTensorHolder grad_tensor_holder =
       GradTensorHolder({slot_meta, slot_meta});
   egr::EagerUtils::autograd_meta(&et0);
@@ -138,7 +138,7 @@ TEST(GradTensorHolder, SelectedRowsMergeAdd) {
   paddle::Tensor t2(sr2);
 
   // Constructor empty GradTensorHolder
-  std::vector<GradSlotMeta> slot_meta(1);
+  GradSlotMetaVector slot_meta(1);
   GradTensorHolder grad_tensor_holder =
       GradTensorHolder({slot_meta, slot_meta});
 
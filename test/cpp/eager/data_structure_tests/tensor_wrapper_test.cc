@@ -14,8 +14,12 @@
 
 #include "paddle/fluid/eager/tensor_wrapper.h"
 
+#include <cmath>
+#include <random>
+
 #include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/eager/saved_tensors_compression.h"
 #include "paddle/fluid/eager/utils.h"
 #include "test/cpp/eager/data_structure_tests/grad_node_test.h"
 
@@ -82,3 +86,151 @@ TEST(TensorWrapper, Basic) {
   auto tw2 = egr::TensorWrapper(et3);
   CHECK(tw2.recover().initialized() == false);
 }
+
+#ifndef PADDLE_NO_PYTHON
+template <typename T>
+paddle::Tensor MakeCPUTensor(const std::vector<T>& values,
+                             phi::DataType dtype) {
+  phi::DenseTensorMeta meta(
+      dtype, phi::make_ddim({static_cast<int64_t>(values.size())}));
+  auto dt = std::make_shared<phi::DenseTensor>(
+      std::make_unique<paddle::experimental::DefaultAllocator>(
+          paddle::platform::CPUPlace())
+          .get(),
+      meta);
+  std::copy(values.begin(),
+            values.end(),
+            dt->mutable_data<T>(paddle::platform::CPUPlace()));
+  return paddle::Tensor(dt);
+}
+
+template <typename T>
+std::vector<T> ToVector(const paddle::Tensor& tensor) {
+  const T* data = tensor.data<T>();
+  return std::vector<T>(data, data + tensor.numel());
+}
+
+TEST(TensorWrapper, CompressedIntegers) {
+  auto context = egr::EnableSavedTensorsCompression({});
+  std::vector<bool> mask_values{true, false, false, true, true, false, true};
+  std::vector<uint8_t> mask_bytes(mask_values.begin(), mask_values.end());
+  std::vector<int64_t> indices{3, -7, 120, 0, 42};
+  std::vector<int32_t> wide{70000, -3, 5};
+  {
+    auto tw0 =
+        egr::TensorWrapper(MakeCPUTensor(mask_values, phi::DataType::BOOL));
+    auto tw1 =
+        egr::TensorWrapper(MakeCPUTensor(mask_bytes, phi::DataType::UINT8));
+    auto tw2 = egr::TensorWrapper(MakeCPUTensor(indices, phi::DataType::INT64));
+    auto tw3 = egr::TensorWrapper(MakeCPUTensor(wide, phi::DataType::INT32));
+    auto stats = context->stats();
+    EXPECT_EQ(stats.original_bytes, 7 + 7 + 5 * 8 + 3 * 4);
+    // one byte for each mask, one per index, the int32 tensor is kept
+    EXPECT_EQ(stats.stored_bytes, 1 + 1 + 5 + 3 * 4);
+
+    const bool* recovered_mask = tw0.recover().data<bool>();
+    for (size_t i = 0; i < mask_values.size(); ++i) {
+      EXPECT_EQ(recovered_mask[i], mask_values[i]);
+    }
+    EXPECT_EQ(ToVector<uint8_t>(tw1.recover()), mask_bytes);
+    EXPECT_EQ(ToVector<int64_t>(tw2.recover()), indices);
+    // recovering twice, as with retain_graph
+    EXPECT_EQ(ToVector<int64_t>(tw2.recover()), indices);
+    EXPECT_EQ(ToVector<int32_t>(tw3.recover()), wide);
+  }
+  EXPECT_EQ(context->stats().stored_bytes, 0);
+  egr::DisableSavedTensorsCompression();
+}
+
+TEST(TensorWrapper, CompressedViews) {
+  auto context = egr::EnableSavedTensorsCompression({});
+  std::vector<int64_t> values{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  auto base = MakeCPUTensor(values, phi::DataType::INT64);
+  auto* base_tensor = static_cast<phi::DenseTensor*>(base.impl().get());
+  {
+    // A slice, at a non-zero offset of the memory of the base tensor.
+    auto slice =
+        std::make_shared<phi::DenseTensor>(base_tensor->Slice(3, 8));
+    auto tw = egr::TensorWrapper(paddle::Tensor(slice));
+    EXPECT_EQ(context->stats().stored_bytes, 5);
+    EXPECT_EQ(ToVector<int64_t>(tw.recover()),
+              std::vector<int64_t>(values.begin() + 3, values.begin() + 8));
+  }
+  {
+    // A strided view, kept as it is.
+    auto strided = std::make_shared<phi::DenseTensor>();
+    strided->ShareDataWith(*base_tensor);
+    strided->Resize(phi::make_ddim({5}));
+    strided->set_strides({2});
+    auto tw = egr::TensorWrapper(paddle::Tensor(strided));
+    EXPECT_EQ(context->stats().stored_bytes, 5 * 8);
+    auto recovered = tw.recover();
+    auto* recovered_tensor =
+        static_cast<phi::DenseTensor*>(recovered.impl().get());
+    EXPECT_EQ(recovered_tensor->strides(), std::vector<int64_t>{2});
+    EXPECT_EQ(recovered_tensor->data<int64_t>(), base_tensor->data<int64_t>());
+  }
+  egr::DisableSavedTensorsCompression();
+}
+
+TEST(TensorWrapper, CompressedFloatToBFloat16) {
+  egr::SavedTensorsCompressionOptions options;
+  options.float_to_bfloat16 = true;
+  options.min_float_numel = 16;
+  auto context = egr::EnableSavedTensorsCompression(options);
+  std::mt19937 rng(0);
+  std::normal_distribution<float> dist;
+  std::vector<float> small(8), large(1024);
+  for (auto& v : small) v = dist(rng);
+  for (auto& v : large) v = dist(rng);
+  auto tw_small =
+      egr::TensorWrapper(MakeCPUTensor(small, phi::DataType::FLOAT32));
+  auto tw_large =
+      egr::TensorWrapper(MakeCPUTensor(large, phi::DataType::FLOAT32));
+  EXPECT_EQ(context->stats().stored_bytes, 8 * 4 + 1024 * 2);
+
+  // Small tensors are kept exactly, the others within the bfloat16 rounding.
+  EXPECT_EQ(ToVector<float>(tw_small.recover()), small);
+  auto recovered = ToVector<float>(tw_large.recover());
+  for (size_t i = 0; i < large.size(); ++i) {
+    EXPECT_NEAR(recovered[i], large[i], std::fabs(large[i]) / 256);
+  }
+  egr::DisableSavedTensorsCompression();
+}
+
+TEST(TensorWrapper, CompressedAsyncPrefetch) {
+  egr::SavedTensorsCompressionOptions options;
+  options.async = true;
+  options.prefetch_depth = 2;
+  auto context = egr::EnableSavedTensorsCompression(options);
+  std::vector<std::vector<int64_t>> values;
+  std::vector<egr::TensorWrapper> wrappers;
+  for (int i = 0; i < 8; ++i) {
+    values.push_back(std::vector<int64_t>(100, i - 4));
+    wrappers.emplace_back(MakeCPUTensor(values.back(), phi::DataType::INT64));
+  }
+  // The snapshot of the first tensor is counted with the tensor until the
+  // worker has compressed it.
+  EXPECT_GE(context->stats().peak_stored_bytes, 2 * 100 * 8);
+  // Backward order.
+  for (int i = 7; i >= 0; --i) {
+    EXPECT_EQ(ToVector<int64_t>(wrappers[i].recover()), values[i]);
+  }
+  egr::DisableSavedTensorsCompression();
+}
+
+TEST(TensorWrapper, CompressedThenModifiedInplace) {
+  auto context = egr::EnableSavedTensorsCompression({});
+  std::vector<int64_t> values(100, 1);
+  auto tensor = MakeCPUTensor(values, phi::DataType::INT64);
+  auto tw = egr::TensorWrapper(tensor);
+  EXPECT_EQ(context->stats().stored_bytes, 100 / 8 + 1);
+  // The compressed tensor still reports the inplace ops on the saved one.
+  static_cast<phi::DenseTensor*>(tensor.impl().get())
+      ->InplaceVersionCounter()
+      .Bump();
+  EXPECT_ANY_THROW(tw.recover());
+  egr::DisableSavedTensorsCompression();
+}
+
+#endif
@@ -0,0 +1,191 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/core/flags.h"
+#include "paddle/phi/kernels/conv_kernel.h"
+#include "paddle/phi/kernels/funcs/cpu_conv.h"
+
+PHI_DECLARE_string(cpu_conv_algo);
+
+namespace phi {
+namespace tests {
+
+struct ConvCase {
+  std::vector<int64_t> input_dims;  // NCHW
+  std::vector<int64_t> filter_dims;
+  std::vector<int> strides;
+  std::vector<int> paddings;
+  std::vector<int> dilations;
+  int groups;
+};
+
+std::string ToString(const ConvCase& c) {
+  std::string result = "input [";
+  for (auto dim : c.input_dims) {
+    result += " " + std::to_string(dim);
+  }
+  result += " ], filter [";
+  for (auto dim : c.filter_dims) {
+    result += " " + std::to_string(dim);
+  }
+  return result + " ], stride " + std::to_string(c.strides[0]) +
+         ", padding " + std::to_string(c.paddings[0]) + ", dilation " +
+         std::to_string(c.dilations[0]) + ", groups " +
+         std::to_string(c.groups);
+}
+
+class ConvRunner {
+ public:
+  explicit ConvRunner(const ConvCase& c) : case_(c) {
+    dev_ctx_ = static_cast<phi::CPUContext*>(
+        phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+    std::mt19937 rng(2023);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    input_.Resize(make_ddim(c.input_dims));
+    filter_.Resize(make_ddim(c.filter_dims));
+    for (auto* t : {&input_, &filter_}) {
+      float* data = dev_ctx_->template Alloc<float>(t);
+      for (int64_t i = 0; i < t->numel(); ++i) {
+        data[i] = dist(rng);
+      }
+    }
+    std::vector<int64_t> out_dims = {c.input_dims[0], c.filter_dims[0]};
+    for (int i = 0; i < 2; ++i) {
+      const int64_t extent = c.dilations[i] * (c.filter_dims[i + 2] - 1) + 1;
+      out_dims.push_back(
+          (c.input_dims[i + 2] + 2 * c.paddings[i] - extent) / c.strides[i] +
+          1);
+    }
+    out_.Resize(make_ddim(out_dims));
+  }
+
+  // Runs conv2d with FLAGS_cpu_conv_algo set to algo.
+  std::vector<float> Run(const std::string& algo) {
+    FLAGS_cpu_conv_algo = algo;
+    ConvKernel<float>(*dev_ctx_,
+                      input_,
+                      filter_,
+                      case_.strides,
+                      case_.paddings,
+                      "EXPLICIT",
+                      case_.dilations,
+                      case_.groups,
+                      "NCHW",
+                      &out_);
+    FLAGS_cpu_conv_algo = "auto";
+    const float* data = out_.data<float>();
+    return std::vector<float>(data, data + out_.numel());
+  }
+
+  funcs::CPUConv2DShape Shape() const {
+    return {input_.dims()[0],
+            input_.dims()[1],
+            input_.dims()[2],
+            input_.dims()[3],
+            out_.dims()[1],
+            out_.dims()[2],
+            out_.dims()[3],
+            static_cast<int>(filter_.dims()[2]),
+            static_cast<int>(filter_.dims()[3]),
+            case_.strides[0],
+            case_.strides[1],
+            case_.paddings[0],
+            case_.paddings[0],
+            case_.paddings[1],
+            case_.paddings[1],
+            case_.dilations[0],
+            case_.dilations[1],
+            case_.groups};
+  }
+
+  // The best of a few runs, in ms.
+  double Time(const std::string& algo) {
+    double best = 1e30;
+    for (int i = 0; i < 5; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      Run(algo);
+      auto end = std::chrono::steady_clock::now();
+      best = std::min(
+          best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+  }
+
+ private:
+  ConvCase case_;
+  phi::CPUContext* dev_ctx_;
+  DenseTensor input_;
+  DenseTensor filter_;
+  DenseTensor out_;
+};
+
+ConvCase MakeCase(int64_t batch_size,
+                  int64_t channels,
+                  int64_t size,
+                  int64_t out_channels,
+                  int64_t kernel,
+                  int stride,
+                  int padding,
+                  int dilation,
+                  int groups) {
+  return {{batch_size, channels, size, size},
+          {out_channels, channels / groups, kernel, kernel},
+          {stride, stride},
+          {padding, padding},
+          {dilation, dilation},
+          groups};
+}
+
+TEST(cpu_conv, benchmark) {
+  struct Layer {
+    std::string name;
+    ConvCase c;
+  };
+  const std::vector<Layer> layers = {
+      {"ResNet 3x3, 64 channels", MakeCase(8, 64, 56, 64, 3, 1, 1, 1, 1)},
+      {"ResNet 3x3, 128 channels", MakeCase(8, 128, 28, 128, 3, 1, 1, 1, 1)},
+      {"ResNet 3x3, 256 channels", MakeCase(8, 256, 14, 256, 3, 1, 1, 1, 1)},
+      {"ResNet 1x1, 256 to 64", MakeCase(8, 256, 56, 64, 1, 1, 0, 1, 1)},
+      {"ResNet 1x1 stride 2, 256 to 512",
+       MakeCase(8, 256, 56, 512, 1, 2, 0, 1, 1)},
+      {"ResNet 1x1, 1024 to 256", MakeCase(8, 1024, 14, 256, 1, 1, 0, 1, 1)},
+      {"MobileNet depthwise, 32 channels",
+       MakeCase(8, 32, 112, 32, 3, 1, 1, 1, 32)},
+      {"MobileNet depthwise stride 2, 128 channels",
+       MakeCase(8, 128, 56, 128, 3, 2, 1, 1, 128)},
+      {"MobileNet depthwise, 512 channels",
+       MakeCase(8, 512, 14, 512, 3, 1, 1, 1, 512)},
+  };
+  for (const auto& layer : layers) {
+    ConvRunner runner(layer.c);
+    funcs::CPUConvAlgo algo = funcs::SelectCPUConvAlgo(runner.Shape());
+    double im2col_ms = runner.Time("im2col");
+    double ms = runner.Time("auto");
+    LOG(INFO) << layer.name << ", " << ToString(layer.c) << ": im2col "
+              << im2col_ms << " ms, " << funcs::CPUConvAlgoName(algo) << " "
+              << ms << " ms, " << im2col_ms / ms << "x";
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
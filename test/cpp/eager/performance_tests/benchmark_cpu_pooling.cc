@@ -0,0 +1,200 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+#include "paddle/phi/kernels/funcs/pooling.h"
+
+namespace phi {
+namespace tests {
+
+struct PoolCase {
+  int64_t batch_size;
+  int64_t channels;
+  int64_t height;
+  int64_t width;
+  std::vector<int> ksize;
+  std::vector<int> strides;
+  std::vector<int> paddings;
+  bool adaptive;
+  bool exclusive;
+
+  std::vector<int64_t> OutputHW() const {
+    if (adaptive) {
+      return {ksize[0], ksize[1]};
+    }
+    return {(height + 2 * paddings[0] - ksize[0]) / strides[0] + 1,
+            (width + 2 * paddings[1] - ksize[1]) / strides[1] + 1};
+  }
+};
+
+const phi::CPUContext& GetCPUContext() {
+  return *static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+}
+
+DenseTensor NewTensor(const std::vector<int64_t>& dims) {
+  DenseTensor t;
+  t.Resize(make_ddim(dims));
+  GetCPUContext().template Alloc<float>(&t);
+  return t;
+}
+
+// The NHWC copy of the NCHW x, or the other way around.
+DenseTensor ToLayout(const DenseTensor& x, bool to_nhwc) {
+  std::vector<int64_t> dims = vectorize(x.dims());
+  std::vector<int> axis =
+      to_nhwc ? std::vector<int>{0, 2, 3, 1} : std::vector<int>{0, 3, 1, 2};
+  std::vector<int64_t> out_dims;
+  for (int i : axis) {
+    out_dims.push_back(dims[i]);
+  }
+  DenseTensor out = NewTensor(out_dims);
+  funcs::TransposeCPU<float>(x, &out, axis);
+  return out;
+}
+
+// The pooled x, and the gradient of x of dout, of the layout of x.
+struct PoolResult {
+  DenseTensor out;
+  DenseTensor dx;
+};
+
+PoolResult Pool(const PoolCase& c,
+                bool is_max,
+                const DenseTensor& x,
+                const DenseTensor& dout,
+                const std::string& data_format) {
+  const auto& dev_ctx = GetCPUContext();
+  std::vector<int64_t> out_hw = c.OutputHW();
+  std::vector<int64_t> out_dims =
+      data_format == "NHWC"
+          ? std::vector<int64_t>{c.batch_size, out_hw[0], out_hw[1], c.channels}
+          : std::vector<int64_t>{
+                c.batch_size, c.channels, out_hw[0], out_hw[1]};
+  PoolResult result = {NewTensor(out_dims), NewTensor(vectorize(x.dims()))};
+  float* dx_data = result.dx.data<float>();
+  std::fill(dx_data, dx_data + result.dx.numel(), 0.0f);
+  if (is_max) {
+    funcs::Pool2dFunctor<CPUContext, funcs::MaxPool<float>, float>()(
+        dev_ctx,
+        x,
+        c.ksize,
+        c.strides,
+        c.paddings,
+        data_format,
+        true,
+        false,
+        &result.out,
+        funcs::MaxPool<float>());
+    funcs::MaxPool2dGradFunctor<CPUContext, float>()(dev_ctx,
+                                                     x,
+                                                     result.out,
+                                                     dout,
+                                                     c.ksize,
+                                                     c.strides,
+                                                     c.paddings,
+                                                     data_format,
+                                                     &result.dx);
+  } else {
+    funcs::Pool2dFunctor<CPUContext, funcs::AvgPool<float>, float>()(
+        dev_ctx,
+        x,
+        c.ksize,
+        c.strides,
+        c.paddings,
+        data_format,
+        c.exclusive,
+        c.adaptive,
+        &result.out,
+        funcs::AvgPool<float>());
+    funcs::Pool2dGradFunctor<CPUContext, funcs::AvgPoolGrad<float>, float>()(
+        dev_ctx,
+        x,
+        result.out,
+        dout,
+        c.ksize,
+        c.strides,
+        c.paddings,
+        data_format,
+        c.exclusive,
+        c.adaptive,
+        &result.dx,
+        funcs::AvgPoolGrad<float>());
+  }
+  return result;
+}
+
+TEST(cpu_pooling, benchmark) {
+  struct Layer {
+    std::string name;
+    PoolCase c;
+    bool is_max;
+  };
+  const std::vector<Layer> layers = {
+      {"ResNet stem max 3x3/2",
+       {32, 64, 112, 112, {3, 3}, {2, 2}, {1, 1}, false, true},
+       true},
+      {"VGG max 2x2/2",
+       {32, 128, 112, 112, {2, 2}, {2, 2}, {0, 0}, false, true},
+       true},
+      {"Inception avg 3x3/1",
+       {32, 192, 28, 28, {3, 3}, {1, 1}, {1, 1}, false, true},
+       false},
+      {"ResNet global avg",
+       {32, 2048, 7, 7, {1, 1}, {1, 1}, {0, 0}, true, true},
+       false},
+  };
+  for (const auto& layer : layers) {
+    const PoolCase& c = layer.c;
+    std::vector<int64_t> out_hw = c.OutputHW();
+    DenseTensor x = NewTensor({c.batch_size, c.channels, c.height, c.width});
+    DenseTensor dout =
+        NewTensor({c.batch_size, c.channels, out_hw[0], out_hw[1]});
+    std::fill(x.data<float>(), x.data<float>() + x.numel(), 1.0f);
+    std::fill(dout.data<float>(), dout.data<float>() + dout.numel(), 1.0f);
+    DenseTensor x_nhwc = ToLayout(x, true);
+    DenseTensor dout_nhwc = ToLayout(dout, true);
+    double ms[2];
+    for (int nhwc = 0; nhwc < 2; ++nhwc) {
+      ms[nhwc] = 1e30;
+      for (int i = 0; i < 3; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        Pool(c,
+             layer.is_max,
+             nhwc ? x_nhwc : x,
+             nhwc ? dout_nhwc : dout,
+             nhwc ? "NHWC" : "NCHW");
+        auto end = std::chrono::steady_clock::now();
+        ms[nhwc] = std::min(
+            ms[nhwc],
+            std::chrono::duration<double, std::milli>(end - start).count());
+      }
+    }
+    LOG(INFO) << layer.name << ", " << c.batch_size << "x" << c.channels
+              << "x" << c.height << "x" << c.width
+              << ", forward and backward: NCHW " << ms[0] << " ms, NHWC "
+              << ms[1] << " ms";
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
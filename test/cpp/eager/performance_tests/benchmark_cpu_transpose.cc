@@ -0,0 +1,118 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/common/complex.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+
+namespace phi {
+namespace tests {
+
+// The per element transpose TransposeNormal used to do, as the reference.
+template <typename T>
+void RefTranspose(const T* in,
+                  T* out,
+                  const std::vector<int64_t>& dims,
+                  const std::vector<int>& axis) {
+  const int rank = static_cast<int>(dims.size());
+  std::vector<int64_t> in_stride(rank, 1);
+  std::vector<int64_t> out_stride(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_stride[i] = in_stride[i + 1] * dims[i + 1];
+    out_stride[i] = out_stride[i + 1] * dims[axis[i + 1]];
+  }
+  int64_t numel = 1;
+  for (auto dim : dims) {
+    numel *= dim;
+  }
+  for (int64_t out_idx = 0; out_idx < numel; ++out_idx) {
+    int64_t in_idx = 0;
+    int64_t tmp_idx = out_idx;
+    for (int i = 0; i < rank; ++i) {
+      const int64_t coordinate = tmp_idx / out_stride[i];
+      tmp_idx -= coordinate * out_stride[i];
+      in_idx += coordinate * in_stride[axis[i]];
+    }
+    out[out_idx] = in[in_idx];
+  }
+}
+
+std::string ToString(const std::vector<int64_t>& dims,
+                     const std::vector<int>& axis) {
+  std::string result = "dims [";
+  for (auto dim : dims) {
+    result += " " + std::to_string(dim);
+  }
+  result += " ], axis [";
+  for (auto i : axis) {
+    result += " " + std::to_string(i);
+  }
+  return result + " ]";
+}
+
+template <typename T>
+void BenchmarkTranspose(const std::string& name,
+                        const std::vector<int64_t>& dims,
+                        const std::vector<int>& axis) {
+  int64_t numel = 1;
+  for (auto dim : dims) {
+    numel *= dim;
+  }
+  std::vector<T> in(numel, T(1));
+  std::vector<T> out(numel);
+  const int repeat = 5;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    phi::funcs::TransposeCPU(in.data(), out.data(), sizeof(T), dims, axis);
+  }
+  auto mid = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    RefTranspose(in.data(), out.data(), dims, axis);
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ms =
+      std::chrono::duration<double, std::milli>(mid - start).count() / repeat;
+  double ref_ms =
+      std::chrono::duration<double, std::milli>(end - mid).count() / repeat;
+  LOG(INFO) << name << " of " << sizeof(T) << " bytes elements, "
+            << ToString(dims, axis) << ": " << ms << " ms, "
+            << numel * sizeof(T) * 2 / ms / 1e6 << " GB/s, per element "
+            << ref_ms << " ms, " << ref_ms / ms << "x";
+}
+
+TEST(cpu_transpose, benchmark) {
+  BenchmarkTranspose<float>("2D", {2048, 2048}, {1, 0});
+  BenchmarkTranspose<float>("NCHW to NHWC", {16, 64, 56, 56}, {0, 2, 3, 1});
+  BenchmarkTranspose<float>("NHWC to NCHW", {16, 56, 56, 64}, {0, 3, 1, 2});
+  BenchmarkTranspose<float>("NCHW to NHWC, 3 channels",
+                            {16, 3, 224, 224},
+                            {0, 2, 3, 1});
+  BenchmarkTranspose<float>("Attention heads", {16, 128, 16, 64}, {0, 2, 1, 3});
+  BenchmarkTranspose<float>("Attention keys", {16, 16, 128, 64}, {0, 1, 3, 2});
+  BenchmarkTranspose<phi::dtype::float16>(
+      "NCHW to NHWC", {16, 64, 56, 56}, {0, 2, 3, 1});
+  BenchmarkTranspose<uint8_t>("NCHW to NHWC", {16, 64, 56, 56}, {0, 2, 3, 1});
+  BenchmarkTranspose<double>("2D", {2048, 2048}, {1, 0});
+  BenchmarkTranspose<phi::dtype::complex<double>>(
+      "2D", {1024, 1024}, {1, 0});
+}
+
+}  // namespace tests
+}  // namespace phi
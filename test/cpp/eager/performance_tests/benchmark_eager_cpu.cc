@@ -20,8 +20,11 @@
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/eager/api/all.h"
+#include "paddle/fluid/eager/api/generated/eager_generated/backwards/scale_node.h"
+#include "paddle/fluid/eager/api/generated/eager_generated/forwards/dygraph_functions.h"
 #include "paddle/fluid/eager/autograd_meta.h"
 #include "paddle/fluid/eager/backward.h"
+#include "paddle/fluid/eager/eager_object_pool.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/phi/core/flags.h"
 #include "test/cpp/eager/performance_tests/benchmark_utils.h"
@@ -246,6 +249,81 @@ TEST(Benchmark, EagerIntermediateMLPCPU) {
   }
 }
 
+// The framework overhead of an op: a chain of matmuls on 1 x 1 tensors, whose
+// kernels cost next to nothing, so that the time is that of creating the grad
+// nodes, AutogradMetas and TensorWrappers, running them backward and
+// releasing the graph.
+TEST(Benchmark, EagerOpOverheadCPU) {
+  eager_test::InitEnv(paddle::platform::CPUPlace());
+
+  const int num_ops = 10000;
+  const int repeat = 10;
+  paddle::framework::DDim ddim = phi::make_ddim({1, 1});
+  paddle::Tensor X = CreateTensorWithValue(ddim,
+                                           paddle::platform::CPUPlace(),
+                                           phi::DataType::FLOAT32,
+                                           phi::DataLayout::NCHW,
+                                           1.0,
+                                           true);
+  paddle::Tensor Y = CreateTensorWithValue(ddim,
+                                           paddle::platform::CPUPlace(),
+                                           phi::DataType::FLOAT32,
+                                           phi::DataLayout::NCHW,
+                                           1.0,
+                                           true);
+  RetainGradForTensor(X);
+
+  double forward_ms = 0., backward_ms = 0., release_ms = 0.;
+  for (int r = 0; r < repeat; ++r) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    paddle::Tensor out = X;
+    for (int i = 0; i < num_ops; ++i) {
+      out = matmul_ad_func(out, Y, false, false);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::vector<paddle::Tensor> target_tensors = {out};
+    Backward(target_tensors, {});
+    auto t2 = std::chrono::high_resolution_clock::now();
+    target_tensors.clear();
+    out = paddle::Tensor();
+    auto t3 = std::chrono::high_resolution_clock::now();
+    forward_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+    backward_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+    release_ms += std::chrono::duration<double, std::milli>(t3 - t2).count();
+  }
+  // The gradients of the runs accumulate in X.
+  eager_test::CompareGradTensorWithValue<float>(X, repeat);
+
+  const double to_us_per_op = 1000. / (repeat * num_ops);
+  std::cout << "Per op: forward " << forward_ms * to_us_per_op
+            << " us, backward " << backward_ms * to_us_per_op
+            << " us, graph release " << release_ms * to_us_per_op << " us"
+            << std::endl;
+
+  // The allocation of the grad nodes alone, pooled and with make_shared.
+  std::vector<std::shared_ptr<GradNodeBase>> nodes(num_ops);
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (int r = 0; r < repeat; ++r) {
+    for (auto& node : nodes) {
+      node = std::make_shared<GradNodeScale>(1, 1);
+    }
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+  for (int r = 0; r < repeat; ++r) {
+    for (auto& node : nodes) {
+      node = MakePooled<GradNodeScale>(1, 1);
+    }
+  }
+  auto t2 = std::chrono::high_resolution_clock::now();
+  std::cout << "Per grad node: make_shared "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count() *
+                   to_us_per_op
+            << " us, pooled "
+            << std::chrono::duration<double, std::milli>(t2 - t1).count() *
+                   to_us_per_op
+            << " us" << std::endl;
+}
+
 USE_OP_ITSELF(scale);
 USE_OP_ITSELF(elementwise_add);
 USE_OP_ITSELF(matmul_v2);
@@ -0,0 +1,190 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+#include "paddle/fluid/framework/ir/fusion_group/code_generator.h"
+#include "paddle/fluid/framework/ir/fusion_group/operation.h"
+#include "paddle/fluid/platform/place.h"
+#include "paddle/phi/backends/device_code.h"
+
+namespace fusion_group = paddle::framework::ir::fusion_group;
+
+namespace {
+
+// The buffers of the vars, of n elements each.
+template <typename T>
+using Buffers = std::map<int, std::vector<T>>;
+
+std::unique_ptr<phi::CPUDeviceCode> Compile(
+    const std::string& func_name,
+    const std::vector<fusion_group::OperationExpression>& expressions) {
+  fusion_group::OperationMap::Init();
+  fusion_group::CodeGenerator code_generator(false);
+  std::string code_str = code_generator.Generate(func_name, expressions);
+  VLOG(3) << code_str;
+
+  std::unique_ptr<phi::CPUDeviceCode> device_code(new phi::CPUDeviceCode(
+      paddle::platform::CPUPlace(), func_name, code_str));
+  EXPECT_TRUE(device_code->Compile());
+  return device_code;
+}
+
+// The arguments are the inputs which are not outputs, and the outputs which
+// are not intermediate, in the order of the ids.
+template <typename T>
+void Launch(const phi::CPUDeviceCode& device_code,
+            const std::vector<fusion_group::OperationExpression>& expressions,
+            Buffers<T>* buffers,
+            size_t n) {
+  std::set<int> input_ids, output_ids, intermediate_ids;
+  for (const auto& expression : expressions) {
+    for (auto id : expression.GetInputIds()) {
+      if (id >= 0) {
+        input_ids.insert(id);
+      }
+    }
+    for (auto id : expression.GetOutputIds()) {
+      output_ids.insert(id);
+    }
+    for (auto id : expression.GetIntermediateOutputIds()) {
+      intermediate_ids.insert(id);
+    }
+  }
+  std::vector<void*> ptrs;
+  for (auto id : input_ids) {
+    if (output_ids.count(id) == 0) {
+      ptrs.push_back((*buffers)[id].data());
+    }
+  }
+  for (auto id : output_ids) {
+    if (intermediate_ids.count(id) == 0) {
+      (*buffers)[id].resize(n);
+      ptrs.push_back((*buffers)[id].data());
+    }
+  }
+  std::vector<void*> args;
+  args.push_back(&n);
+  for (auto& ptr : ptrs) {
+    args.push_back(&ptr);
+  }
+  device_code.Launch(n, &args);
+}
+
+template <typename T>
+void SetupRandomBuffers(const std::vector<int>& input_ids,
+                        size_t n,
+                        Buffers<T>* buffers) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<double> uniform_dist(-0.5, 0.5);
+  for (auto id : input_ids) {
+    auto& buffer = (*buffers)[id];
+    buffer.resize(n);
+    for (auto& value : buffer) {
+      value = static_cast<T>(uniform_dist(rng));
+    }
+  }
+}
+
+// The time of a launch in ms, the best of several runs.
+template <typename T>
+double TimeLaunch(const phi::CPUDeviceCode& device_code,
+                  const std::vector<fusion_group::OperationExpression>& exprs,
+                  Buffers<T>* buffers,
+                  size_t n) {
+  double best = 1e30;
+  for (int i = 0; i < 10; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    Launch(device_code, exprs, buffers, n);
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(
+        best, std::chrono::duration<double, std::milli>(end - start).count());
+  }
+  return best;
+}
+
+}  // namespace
+
+// An elementwise-heavy subgraph, like the activations and the residual of a
+// block, run as a fusion group, and as a kernel per op.
+TEST(code_generator_cpu, benchmark) {
+  // t2 = t0 * t1
+  // t4 = t2 + t3
+  // t5 = sigmoid(t4)
+  // t6 = t5 * t4
+  // t7 = tanh(t6)
+  // t8 = t7 - t0
+  // t9 = relu(t8)
+  // t10 = t9 + t3
+  std::string dtype = "float";
+  std::vector<std::vector<int>> inputs = {
+      {0, 1}, {2, 3}, {4}, {5, 4}, {6}, {7, 0}, {8}, {9, 3}};
+  std::vector<std::string> op_types = {"elementwise_mul",
+                                       "elementwise_add",
+                                       "sigmoid",
+                                       "elementwise_mul",
+                                       "tanh",
+                                       "elementwise_sub",
+                                       "relu",
+                                       "elementwise_add"};
+  std::vector<fusion_group::OperationExpression> fused;
+  std::vector<std::vector<fusion_group::OperationExpression>> unfused;
+  for (size_t i = 0; i < op_types.size(); ++i) {
+    int out = i == 0 ? 2 : static_cast<int>(i) + 3;
+    std::vector<int> intermediate;
+    if (i + 1 < op_types.size()) {
+      intermediate.push_back(out);
+    }
+    fused.emplace_back(op_types[i],
+                       inputs[i],
+                       std::vector<int>{out},
+                       dtype,
+                       dtype,
+                       intermediate);
+    unfused.push_back({fusion_group::OperationExpression(
+        op_types[i], inputs[i], {out}, dtype, dtype)});
+  }
+
+  auto fused_code = Compile("cpu_benchmark_fused", fused);
+  std::vector<std::unique_ptr<phi::CPUDeviceCode>> unfused_codes;
+  for (size_t i = 0; i < unfused.size(); ++i) {
+    unfused_codes.push_back(
+        Compile("cpu_benchmark_op_" + std::to_string(i), unfused[i]));
+  }
+
+  size_t n = 4 * 1024 * 1024;
+  Buffers<float> buffers;
+  SetupRandomBuffers<float>({0, 1, 3}, n, &buffers);
+  double fused_ms = TimeLaunch(*fused_code, fused, &buffers, n);
+  std::vector<float> fused_out = buffers[10];
+
+  double unfused_ms = 0;
+  for (size_t i = 0; i < unfused.size(); ++i) {
+    unfused_ms += TimeLaunch(*unfused_codes[i], unfused[i], &buffers, n);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_NEAR(fused_out[i], buffers[10][i], 1e-5);
+  }
+  LOG(INFO) << "fusion_group on CPU, " << op_types.size()
+            << " elementwise ops of " << n << " floats: fused " << fused_ms
+            << " ms, a kernel per op " << unfused_ms << " ms, "
+            << unfused_ms / fused_ms << "x";
+}
@@ -0,0 +1,113 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <sys/time.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/phi/kernels/funcs/selected_rows_functor.h"
+
+std::unique_ptr<phi::SelectedRows> RandomSelectedRows(
+    const phi::CPUContext& ctx,
+    int64_t num_rows,
+    int64_t row_numel,
+    int64_t height,
+    int seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<int64_t> id_dist(0, height - 1);
+  std::uniform_real_distribution<float> value_dist(-1.f, 1.f);
+  std::vector<int64_t> rows(num_rows);
+  for (auto& row : rows) {
+    row = id_dist(rng);
+  }
+  std::unique_ptr<phi::SelectedRows> selected_rows{
+      new phi::SelectedRows(rows, height)};
+  auto* value = selected_rows->mutable_value();
+  value->Resize(phi::make_ddim({num_rows, row_numel}));
+  float* data = ctx.template Alloc<float>(value);
+  for (int64_t i = 0; i < num_rows * row_numel; ++i) {
+    data[i] = value_dist(rng);
+  }
+  return selected_rows;
+}
+
+static double GetCurrentUS() {
+  struct timeval time;
+  gettimeofday(&time, NULL);
+  return 1e+6 * time.tv_sec + time.tv_usec;
+}
+
+// The former MergeAdd: the distinct ids are collected in a std::set and the
+// rows are accumulated on one thread through a hash map of the ids.
+static void SetBasedMergeAdd(const phi::CPUContext& ctx,
+                             const phi::SelectedRows& input,
+                             phi::SelectedRows* output) {
+  const int64_t row_numel = input.value().dims()[1];
+  std::set<int64_t> row_set(input.rows().begin(), input.rows().end());
+  std::vector<int64_t> merge_rows(row_set.begin(), row_set.end());
+  std::unordered_map<int64_t, size_t> rows_to_id;
+  for (size_t i = 0; i < merge_rows.size(); ++i) {
+    rows_to_id[merge_rows[i]] = i;
+  }
+  output->set_rows(merge_rows);
+  auto* out_value = output->mutable_value();
+  out_value->Resize(
+      phi::make_ddim({static_cast<int64_t>(merge_rows.size()), row_numel}));
+  float* out_data = ctx.template Alloc<float>(out_value);
+  std::fill(out_data, out_data + out_value->numel(), 0.f);
+  const float* in_data = input.value().data<float>();
+  for (size_t i = 0; i < input.rows().size(); ++i) {
+    float* dst = out_data + rows_to_id[input.rows()[i]] * row_numel;
+    for (int64_t j = 0; j < row_numel; ++j) {
+      dst[j] += in_data[i * row_numel + j];
+    }
+  }
+}
+
+// Embedding gradients of 1M and 10M ids over a 1M rows vocabulary.
+TEST(selected_rows_functor, cpu_merge_add_benchmark) {
+  paddle::platform::CPUPlace cpu_place;
+  phi::CPUContext ctx(cpu_place);
+  ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                       .GetAllocator(cpu_place)
+                       .get());
+  const int64_t row_numel = 8;
+  const int64_t height = 1000000;
+  for (int64_t num_rows : {int64_t(1000000), int64_t(10000000)}) {
+    auto input = RandomSelectedRows(ctx, num_rows, row_numel, height, 3);
+
+    phi::SelectedRows set_based_output;
+    double start = GetCurrentUS();
+    SetBasedMergeAdd(ctx, *input, &set_based_output);
+    const double set_based_ms = (GetCurrentUS() - start) / 1000;
+
+    phi::SelectedRows output;
+    phi::funcs::scatter::MergeAdd<phi::CPUContext, float> merge_add_functor;
+    start = GetCurrentUS();
+    merge_add_functor(ctx, *input, &output, true);
+    const double merge_add_ms = (GetCurrentUS() - start) / 1000;
+
+    EXPECT_EQ(output.rows(), set_based_output.rows());
+    LOG(INFO) << "MergeAdd of " << num_rows << " rows: set based "
+              << set_based_ms << " ms, sort based " << merge_add_ms << " ms";
+  }
+}
@@ -0,0 +1,110 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/time.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/eager/saved_tensors_compression.h"
+#include "paddle/fluid/eager/tensor_wrapper.h"
+#include "paddle/phi/api/lib/utils/allocator.h"
+
+#ifndef PADDLE_NO_PYTHON
+template <typename T>
+paddle::Tensor MakeCPUTensor(const std::vector<T>& values,
+                             phi::DataType dtype) {
+  phi::DenseTensorMeta meta(
+      dtype, phi::make_ddim({static_cast<int64_t>(values.size())}));
+  auto dt = std::make_shared<phi::DenseTensor>(
+      std::make_unique<paddle::experimental::DefaultAllocator>(
+          paddle::platform::CPUPlace())
+          .get(),
+      meta);
+  std::copy(values.begin(),
+            values.end(),
+            dt->mutable_data<T>(paddle::platform::CPUPlace()));
+  return paddle::Tensor(dt);
+}
+
+static double GetCurrentUS() {
+  struct timeval time;
+  gettimeofday(&time, NULL);
+  return 1e+6 * time.tv_sec + time.tv_usec;
+}
+
+// Saves the activations of a stack of layers, each a float tensor and a
+// dropout mask, and recovers them in backward order. Logs the peak of the
+// saved bytes and the time spent saving and recovering for each mode.
+TEST(TensorWrapper, CompressionBenchmark) {
+  const int num_layers = 16;
+  const int64_t numel = 1 << 20;
+  std::mt19937 rng(0);
+  std::normal_distribution<float> dist;
+  std::vector<float> activation(numel);
+  std::vector<uint8_t> mask(numel);
+  for (int64_t i = 0; i < numel; ++i) {
+    activation[i] = dist(rng);
+    mask[i] = activation[i] > 0;
+  }
+
+  struct Mode {
+    const char* name;
+    bool enable;
+    egr::SavedTensorsCompressionOptions options;
+  };
+  egr::SavedTensorsCompressionOptions lossless, bf16, bf16_async;
+  bf16.float_to_bfloat16 = true;
+  bf16_async.float_to_bfloat16 = true;
+  bf16_async.async = true;
+  std::vector<Mode> modes{{"no hooks", false, {}},
+                          {"lossless", true, lossless},
+                          {"lossless + bf16", true, bf16},
+                          {"lossless + bf16, async", true, bf16_async}};
+
+  for (auto& mode : modes) {
+    std::shared_ptr<egr::SavedTensorsCompressionContext> context;
+    if (mode.enable) {
+      context = egr::EnableSavedTensorsCompression(mode.options);
+    }
+    double start = GetCurrentUS();
+    std::vector<egr::TensorWrapper> wrappers;
+    for (int l = 0; l < num_layers; ++l) {
+      wrappers.emplace_back(
+          MakeCPUTensor(activation, phi::DataType::FLOAT32));
+      wrappers.emplace_back(MakeCPUTensor(mask, phi::DataType::UINT8));
+    }
+    const double forward_ms = (GetCurrentUS() - start) / 1000;
+    start = GetCurrentUS();
+    for (auto it = wrappers.rbegin(); it != wrappers.rend(); ++it) {
+      EXPECT_EQ(it->recover().numel(), numel);
+    }
+    const double backward_ms = (GetCurrentUS() - start) / 1000;
+
+    const int64_t original_mb = num_layers * numel * 5 >> 20;
+    const int64_t peak_mb =
+        context ? context->stats().peak_stored_bytes >> 20 : original_mb;
+    LOG(INFO) << mode.name << ": peak saved " << peak_mb << " MB of "
+              << original_mb << " MB, save " << forward_ms << " ms, recover "
+              << backward_ms << " ms";
+    if (mode.enable) {
+      wrappers.clear();
+      egr::DisableSavedTensorsCompression();
+    }
+  }
+}
+#endif
@@ -0,0 +1,124 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arpa/inet.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/core/distributed/store/tcp_store.h"
+#include "paddle/phi/core/distributed/store/tcp_utils.h"
+
+namespace phi {
+namespace distributed {
+
+uint16_t FreePort() {
+  SocketType socket = tcputils::tcp_listen("", "0", AF_INET);
+  ::sockaddr_in addr{};
+  ::socklen_t len = sizeof(addr);
+  ::getsockname(socket, reinterpret_cast<::sockaddr*>(&addr), &len);
+  tcputils::close_socket(socket);
+  return ntohs(addr.sin_port);
+}
+
+std::vector<uint8_t> ToBytes(const std::string& s) {
+  return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+// The rendezvous of many ranks: each connects, passes a barrier, and gets
+// the addresses of some peers by get and by multi_get.
+TEST(TCPStore, rendezvous_benchmark) {
+  // Two fds for every rank, the client and the server ones.
+  ::rlimit limit;
+  ::getrlimit(RLIMIT_NOFILE, &limit);
+  limit.rlim_cur = limit.rlim_max;
+  ::setrlimit(RLIMIT_NOFILE, &limit);
+  ::getrlimit(RLIMIT_NOFILE, &limit);
+  const int num_ranks = static_cast<int>(
+      std::min<rlim_t>(2000, (limit.rlim_cur - 64) / 2));
+  const int num_peers = 64;
+
+  uint16_t port = FreePort();
+  auto server = detail::TCPServer::create(port, num_ranks, 60);
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed = [&]() {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  // When the ranks are through the barriers after connecting, after the
+  // gets, and after the multi_gets.
+  std::vector<std::array<double, 3>> times(num_ranks);
+  std::vector<std::thread> ranks;
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    ranks.emplace_back([&, rank]() {
+      TCPStore store("127.0.0.1", port, false, num_ranks, 60);
+      auto barrier = [&](const std::string& name) {
+        if (store.add(name, 1) == num_ranks) {
+          store.set(name + "/done", {1});
+        }
+        store.wait(name + "/done");
+      };
+      store.set("addr/" + std::to_string(rank),
+                ToBytes("127.0.0.1:" + std::to_string(10000 + rank)));
+      barrier("connect");
+      times[rank][0] = elapsed();
+
+      std::vector<std::string> keys;
+      for (int i = 1; i <= num_peers; ++i) {
+        keys.push_back("addr/" + std::to_string((rank + i) % num_ranks));
+      }
+      for (const auto& key : keys) {
+        store.get(key);
+      }
+      barrier("get");
+      times[rank][1] = elapsed();
+
+      auto values = store.multi_get(keys);
+      const int last_peer = (rank + num_peers) % num_ranks;
+      EXPECT_EQ(values.back(),
+                ToBytes("127.0.0.1:" + std::to_string(10000 + last_peer)));
+      barrier("multi_get");
+      times[rank][2] = elapsed();
+    });
+  }
+  for (auto& rank : ranks) {
+    rank.join();
+  }
+  double connect_ms = 0, get_ms = 0, multi_get_ms = 0;
+  for (const auto& t : times) {
+    connect_ms = std::max(connect_ms, t[0]);
+    get_ms = std::max(get_ms, t[1]);
+    multi_get_ms = std::max(multi_get_ms, t[2]);
+  }
+  printf(
+      "%d ranks: connect and barrier %.1f ms, %d gets %.1f ms, multi_get of "
+      "%d keys %.1f ms\n",
+      num_ranks,
+      connect_ms,
+      num_peers,
+      get_ms - connect_ms,
+      num_peers,
+      multi_get_ms - get_ms);
+}
+
+}  // namespace distributed
+}  // namespace phi
@@ -0,0 +1,126 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <sys/time.h>
+
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/weight_only_gemm.h"
+
+namespace phi {
+namespace tests {
+
+inline double GetCurrentUS() {
+  struct timeval time;
+  gettimeofday(&time, NULL);
+  return 1e+6 * time.tv_sec + time.tv_usec;
+}
+
+const phi::CPUContext& GetCPUContext() {
+  return *static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+}
+
+std::vector<float> RandomVector(size_t size, int seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> v(size);
+  for (auto& e : v) {
+    e = dist(rng);
+  }
+  return v;
+}
+
+// Compares the weight-only GEMM to the fp32 one on a 4096 x 4096 weight,
+// with one row (decoding) and 32 rows.
+TEST(WeightOnlyGemm, benchmark) {
+  const auto& dev_ctx = GetCPUContext();
+  const int k = 4096;
+  const int n = 4096;
+  const int repeat = 10;
+  auto weight = RandomVector(static_cast<size_t>(k) * n, 2);
+  std::vector<int8_t> qweight8(static_cast<size_t>(n) * k);
+  std::vector<int8_t> qweight4(static_cast<size_t>(n) * k / 2);
+  std::vector<float> scale8(n);
+  std::vector<float> scale4(static_cast<size_t>(k / 128) * n);
+  phi::funcs::WeightOnlyQuantize(
+      weight.data(), k, n, 8, -1, qweight8.data(), scale8.data());
+  phi::funcs::WeightOnlyQuantize(
+      weight.data(), k, n, 4, 128, qweight4.data(), scale4.data());
+  auto blas = phi::funcs::GetBlas<phi::CPUContext, float>(dev_ctx);
+
+  for (int m : {1, 32}) {
+    auto x = RandomVector(static_cast<size_t>(m) * k, 1);
+    std::vector<float> out(static_cast<size_t>(m) * n);
+
+    double start = GetCurrentUS();
+    for (int i = 0; i < repeat; ++i) {
+      blas.GEMM(CblasNoTrans,
+                CblasNoTrans,
+                m,
+                n,
+                k,
+                1.f,
+                x.data(),
+                weight.data(),
+                0.f,
+                out.data());
+    }
+    const double fp32_us = (GetCurrentUS() - start) / repeat;
+
+    start = GetCurrentUS();
+    for (int i = 0; i < repeat; ++i) {
+      phi::funcs::WeightOnlyGemm(dev_ctx,
+                                 x.data(),
+                                 m,
+                                 k,
+                                 n,
+                                 qweight8.data(),
+                                 scale8.data(),
+                                 nullptr,
+                                 8,
+                                 -1,
+                                 out.data());
+    }
+    const double int8_us = (GetCurrentUS() - start) / repeat;
+
+    start = GetCurrentUS();
+    for (int i = 0; i < repeat; ++i) {
+      phi::funcs::WeightOnlyGemm(dev_ctx,
+                                 x.data(),
+                                 m,
+                                 k,
+                                 n,
+                                 qweight4.data(),
+                                 scale4.data(),
+                                 nullptr,
+                                 4,
+                                 128,
+                                 out.data());
+    }
+    const double int4_us = (GetCurrentUS() - start) / repeat;
+
+    LOG(INFO) << "M=" << m << " K=" << k << " N=" << n << ": fp32 " << fp32_us
+              << " us, int8 " << int8_us << " us, int4 (group 128) "
+              << int4_us << " us";
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -253,8 +253,8 @@ TEST(EagerUtils, GetGradAccumulationNode) {
 TEST(EagerUtils, FillZeroForEmptyOptionalGradInput) {
   paddle::small_vector<std::vector<paddle::Tensor>, egr::kSlotSmallVectorSize>
       grads = {std::vector<paddle::Tensor>(1)};
-  paddle::small_vector<std::vector<GradSlotMeta>, egr::kSlotSmallVectorSize>
-      slot_metas = {std::vector<GradSlotMeta>(1)};
+  paddle::small_vector<GradSlotMetaVector, egr::kSlotSmallVectorSize>
+      slot_metas = {GradSlotMetaVector(1)};
 
   phi::DenseTensorMeta tensor_meta;
   tensor_meta.dtype = phi::DataType::FLOAT32;
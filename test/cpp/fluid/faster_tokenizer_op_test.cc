@@ -0,0 +1,268 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/string/faster_tokenizer_op.h"
+
+#include <gtest/gtest.h>
+#include <utf8proc.h>
+
+#include <chrono>
+#include <codecvt>
+#include <locale>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/string_array.h"
+
+namespace {
+
+using paddle::framework::Vocab;
+using paddle::operators::BertTokenizer;
+
+// The wstring based tokenizer the op used to have, as the reference of the
+// token ids.
+bool RefIsControl(wchar_t ch) {
+  if (ch == L'\t' || ch == L'\n' || ch == L'\r') return false;
+  auto cat = utf8proc_category(ch);
+  return cat == UTF8PROC_CATEGORY_CC || cat == UTF8PROC_CATEGORY_CF;
+}
+
+bool RefIsChineseChar(wchar_t ch) {
+  return (ch >= 0x4E00 && ch <= 0x9FFF) || (ch >= 0x3400 && ch <= 0x4DBF) ||
+         (ch >= 0x20000 && ch <= 0x2A6DF) || (ch >= 0x2A700 && ch <= 0x2B73F) ||
+         (ch >= 0x2B740 && ch <= 0x2B81F) || (ch >= 0x2B820 && ch <= 0x2CEAF) ||
+         (ch >= 0xF900 && ch <= 0xFAFF) || (ch >= 0x2F800 && ch <= 0x2FA1F);
+}
+
+bool RefIsWhiteSpace(wchar_t ch) {
+  if (ch == L' ' || ch == L'\t' || ch == L'\n' || ch == L'\r') return true;
+  return utf8proc_category(ch) == UTF8PROC_CATEGORY_ZS;
+}
+
+bool RefIsPunctuation(wchar_t ch) {
+  if ((ch >= 33 && ch <= 47) || (ch >= 58 && ch <= 64) ||
+      (ch >= 91 && ch <= 96) || (ch >= 123 && ch <= 126))
+    return true;
+  auto cat = utf8proc_category(ch);
+  return cat == UTF8PROC_CATEGORY_PD || cat == UTF8PROC_CATEGORY_PS ||
+         cat == UTF8PROC_CATEGORY_PE || cat == UTF8PROC_CATEGORY_PC ||
+         cat == UTF8PROC_CATEGORY_PO || cat == UTF8PROC_CATEGORY_PI ||
+         cat == UTF8PROC_CATEGORY_PF;
+}
+
+void RefWordPiece(const Vocab& vocab,
+                  const std::wstring& text,
+                  std::vector<int64_t>* ids) {
+  int64_t unk_id = vocab.at(L"[UNK]");
+  size_t len = text.size();
+  if (len > 100) {
+    ids->push_back(unk_id);
+    return;
+  }
+  std::vector<int64_t> pieces;
+  size_t start = 0;
+  while (start < len) {
+    size_t end = len;
+    bool found = false;
+    while (start < end) {
+      std::wstring sub = text.substr(start, end - start);
+      if (start > 0) {
+        sub = L"##" + sub;
+      }
+      auto it = vocab.find(sub);
+      if (it != vocab.end()) {
+        pieces.push_back(it->second);
+        found = true;
+        break;
+      }
+      end -= 1;
+    }
+    if (!found) {
+      ids->push_back(unk_id);
+      return;
+    }
+    start = end;
+  }
+  ids->insert(ids->end(), pieces.begin(), pieces.end());
+}
+
+std::vector<int64_t> RefTokenize(const Vocab& vocab,
+                                 const std::string& text,
+                                 bool do_lower_case) {
+  std::vector<int64_t> ids;
+  std::wstring unicode_text;
+  try {
+    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+    unicode_text = converter.from_bytes(text);
+  } catch (std::range_error& e) {
+    return ids;
+  }
+  std::vector<std::wstring> tokens;
+  std::wstring cache_text;
+  auto PushCacheText = [&]() {
+    if (!cache_text.empty()) {
+      tokens.push_back(cache_text);
+      cache_text.clear();
+    }
+  };
+  for (wchar_t ch : unicode_text) {
+    if (ch == 0 || ch == 0xfffd || RefIsControl(ch)) continue;
+    if (do_lower_case) ch = utf8proc_tolower(ch);
+    if (RefIsChineseChar(ch) || RefIsPunctuation(ch)) {
+      PushCacheText();
+      tokens.push_back(std::wstring{ch});
+    } else if (RefIsWhiteSpace(ch)) {
+      PushCacheText();
+    } else {
+      cache_text += ch;
+    }
+  }
+  PushCacheText();
+  for (const auto& token : tokens) {
+    RefWordPiece(vocab, token, &ids);
+  }
+  return ids;
+}
+
+Vocab MakeVocab() {
+  const std::vector<std::wstring> tokens = {
+      L"[PAD]", L"[UNK]", L"[CLS]", L"[SEP]", L"[MASK]", L"the",   L"quick",
+      L"brown", L"fox",   L"jump",  L"##s",   L"##ed",   L"##ing", L"over",
+      L"lazy",  L"dog",   L"un",    L"##aff", L"##able", L"a",     L"##b",
+      L"##c",   L"ab",    L"abc",   L"##bc",  L"caf",    L"##é",   L"café",
+      L"naïve", L"ü",     L"中",    L"国",    L"人",     L",",     L".",
+      L"!",     L"'",     L"##",    L"The",   L"Über",   L"über",  L"x",
+      L"##x",   L"##xx",  L"##xxx", L"、",    L"¿",      L"k"};
+  Vocab vocab;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    vocab.emplace(tokens[i], static_cast<int32_t>(i));
+  }
+  return vocab;
+}
+
+// Random text of the vocab pieces, and characters the tokenizer handles
+// specially: controls, unicode spaces, uppercase, invalid UTF-8...
+std::string RandomText(std::mt19937* rng, int num_pieces) {
+  static const std::vector<std::string> pieces = {
+      "the",      "The",       "QUICK",   "brown",  "fox",
+      "jumps",    "jumped",    "jumping", "over",   "lazy",
+      "dog",      "unaffable", "abc",     "abcbc",  "ab",
+      "café",     "CAFÉ",      "naïve",   "Über",   "über",
+      "中国人",   "中",        "日本",    ",",      ".",
+      "!?",       "'s",        "xxxxxxx", "、",     "¿",
+      " ",        "  ",        "\t",      "\n",     "\r\n",
+      "\u3000",   "\u00a0",    "\x01",    "\x7f",   "\u200b",
+      "\ufffd",   "\x0b",      "\x0c",    "\u212a", "zzz"};
+  std::uniform_int_distribution<size_t> dist(0, pieces.size() - 1);
+  std::string text;
+  for (int i = 0; i < num_pieces; ++i) {
+    text += pieces[dist(*rng)];
+  }
+  return text;
+}
+
+}  // namespace
+
+TEST(FasterTokenizer, SameIdsAsWstringTokenizer) {
+  Vocab vocab = MakeVocab();
+  std::mt19937 rng(2023);
+  for (bool do_lower_case : {false, true}) {
+    BertTokenizer tokenizer(&vocab, do_lower_case);
+    std::vector<std::string> texts = {
+        "",
+        "the quick brown fox",
+        std::string(150, 'x'),
+        std::string(101, 'a'),
+        "abcx##",
+        "\xff the",
+        "the \xe4\xb8",
+        "\xed\xa0\x80",
+        "\xc0\x80",
+        std::string("a\0b", 3)};
+    for (int i = 0; i < 2000; ++i) {
+      texts.push_back(RandomText(&rng, i % 20));
+    }
+    // Bytes which are mostly not valid UTF-8.
+    for (int i = 0; i < 2000; ++i) {
+      std::string text = RandomText(&rng, 2);
+      for (int j = 0; j < i % 6; ++j) {
+        text.push_back(static_cast<char>(0x80 + rng() % 0x80));
+      }
+      texts.push_back(text);
+    }
+    for (const auto& text : texts) {
+      std::vector<int64_t> ids;
+      tokenizer.Tokenize(text, &ids);
+      EXPECT_EQ(ids, RefTokenize(vocab, text, do_lower_case)) << text;
+    }
+  }
+}
+
+TEST(FasterTokenizer, SplitIntoWords) {
+  Vocab vocab = MakeVocab();
+  BertTokenizer tokenizer(&vocab);
+  std::unordered_map<std::string, std::vector<int64_t>> encoded;
+  ASSERT_EQ(tokenizer.Encode(&encoded, "中a人z", "", true), 1);
+  std::vector<int64_t> expected = {vocab.at(L"[CLS]"),
+                                   vocab.at(L"中"),
+                                   vocab.at(L"a"),
+                                   vocab.at(L"人"),
+                                   vocab.at(L"[UNK]"),
+                                   vocab.at(L"[SEP]")};
+  EXPECT_EQ(encoded["input_ids"], expected);
+  encoded.clear();
+  EXPECT_EQ(tokenizer.Encode(&encoded, "a\xff", "", true), 0);
+}
+
+TEST(FasterTokenizer, TriesFollowVocab) {
+  Vocab vocab = MakeVocab();
+  std::vector<int64_t> ids;
+  BertTokenizer(&vocab).Tokenize("zzz", &ids);
+  EXPECT_EQ(ids, std::vector<int64_t>{vocab.at(L"[UNK]")});
+  // The tries cached by the vocab are rebuilt once it is modified.
+  vocab.emplace(L"zzz", 1000);
+  ids.clear();
+  BertTokenizer(&vocab).Tokenize("zzz", &ids);
+  EXPECT_EQ(ids, std::vector<int64_t>{1000});
+}
+
+TEST(FasterTokenizer, Throughput) {
+  Vocab vocab = MakeVocab();
+  std::mt19937 rng(0);
+  paddle::framework::Strings texts;
+  for (int i = 0; i < 4000; ++i) {
+    texts.emplace_back(RandomText(&rng, 64));
+  }
+  BertTokenizer tokenizer(&vocab, true);
+  std::vector<std::unordered_map<std::string, std::vector<int64_t>>> encoded(
+      texts.size());
+
+  auto start = std::chrono::steady_clock::now();
+  tokenizer.BatchEncode(&encoded, texts);
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (const auto& text : texts) {
+    RefTokenize(vocab, text, true);
+  }
+  end = std::chrono::steady_clock::now();
+  double ref_seconds = std::chrono::duration<double>(end - start).count();
+  LOG(INFO) << "faster_tokenizer: " << texts.size() / seconds
+            << " sentences/s in a batch, " << texts.size() / ref_seconds
+            << " sentences/s with the wstring tokenizer in a single thread";
+}
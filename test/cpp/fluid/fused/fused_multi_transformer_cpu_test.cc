@@ -0,0 +1,683 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/fused/paged_kv_cache.h"
+#include "paddle/fluid/platform/place.h"
+#include "paddle/phi/core/kernel_registry.h"
+
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+
+USE_OP_ITSELF(fused_multi_transformer);
+USE_OP_ITSELF(multihead_matmul);
+PD_DECLARE_KERNEL(fused_multi_transformer, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(multihead_matmul, CPU, ALL_LAYOUT);
+
+static std::vector<float> RandomVec(int64_t n, float scale, int seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-scale, scale);
+  std::vector<float> v(n);
+  for (auto &x : v) {
+    x = dist(rng);
+  }
+  return v;
+}
+
+static void SetTensor(framework::Scope *scope,
+                      const std::string &name,
+                      const std::vector<int64_t> &dims,
+                      const std::vector<float> &data) {
+  auto *tensor = scope->Var(name)->GetMutable<phi::DenseTensor>();
+  float *ptr =
+      tensor->mutable_data<float>(phi::make_ddim(dims), platform::CPUPlace());
+  std::copy(data.begin(), data.end(), ptr);
+}
+
+static std::vector<float> GetTensor(const framework::Scope &scope,
+                                    const std::string &name) {
+  const auto &tensor = scope.FindVar(name)->Get<phi::DenseTensor>();
+  const float *ptr = tensor.data<float>();
+  return std::vector<float>(ptr, ptr + tensor.numel());
+}
+
+// Naive references, computed on [rows, cols] row-major matrices.
+static void RefMatMul(const float *a,
+                      const float *b,
+                      float *c,
+                      int m,
+                      int n,
+                      int k,
+                      bool trans_b = false) {
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      double sum = 0;
+      for (int p = 0; p < k; ++p) {
+        sum += a[i * k + p] * (trans_b ? b[j * k + p] : b[p * n + j]);
+      }
+      c[i * n + j] = sum;
+    }
+  }
+}
+
+static void RefLayerNorm(const float *x,
+                         const float *scale,
+                         const float *bias,
+                         float *out,
+                         int rows,
+                         int cols) {
+  for (int i = 0; i < rows; ++i) {
+    double mean = 0, var = 0;
+    for (int j = 0; j < cols; ++j) mean += x[i * cols + j];
+    mean /= cols;
+    for (int j = 0; j < cols; ++j) {
+      var += (x[i * cols + j] - mean) * (x[i * cols + j] - mean);
+    }
+    var /= cols;
+    for (int j = 0; j < cols; ++j) {
+      out[i * cols + j] =
+          (x[i * cols + j] - mean) / std::sqrt(var + 1e-5) * scale[j] +
+          bias[j];
+    }
+  }
+}
+
+// qkv: [bsz * seq_len, 3, num_head, dim_head], mask: [bsz, 1, seq_len,
+// seq_len] or null, out: [bsz * seq_len, num_head * dim_head]
+static void RefAttention(const float *qkv,
+                         const float *mask,
+                         float *out,
+                         int bsz,
+                         int seq_len,
+                         int num_head,
+                         int dim_head,
+                         float scale) {
+  int hidden = num_head * dim_head;
+  std::vector<double> logits(seq_len);
+  for (int b = 0; b < bsz; ++b) {
+    for (int h = 0; h < num_head; ++h) {
+      for (int i = 0; i < seq_len; ++i) {
+        const float *q = qkv + (b * seq_len + i) * 3 * hidden + h * dim_head;
+        double max_logit = -1e30;
+        for (int j = 0; j < seq_len; ++j) {
+          const float *k =
+              qkv + (b * seq_len + j) * 3 * hidden + hidden + h * dim_head;
+          double dot = 0;
+          for (int d = 0; d < dim_head; ++d) dot += q[d] * k[d];
+          logits[j] = dot * scale +
+                      (mask ? mask[(b * seq_len + i) * seq_len + j] : 0.f);
+          max_logit = std::max(max_logit, logits[j]);
+        }
+        double sum = 0;
+        for (int j = 0; j < seq_len; ++j) {
+          logits[j] = std::exp(logits[j] - max_logit);
+          sum += logits[j];
+        }
+        float *o = out + (b * seq_len + i) * hidden + h * dim_head;
+        for (int d = 0; d < dim_head; ++d) {
+          double acc = 0;
+          for (int j = 0; j < seq_len; ++j) {
+            acc += logits[j] / sum *
+                   qkv[(b * seq_len + j) * 3 * hidden + 2 * hidden +
+                       h * dim_head + d];
+          }
+          o[d] = acc;
+        }
+      }
+    }
+  }
+}
+
+static void ExpectNear(const std::vector<float> &actual,
+                       const std::vector<float> &expected,
+                       float eps) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    ASSERT_NEAR(actual[i], expected[i], eps) << "at " << i;
+  }
+}
+
+// Runs multihead_matmul with bias_qk of bias_qk_dims, which broadcasts to
+// mask of [bsz, 1, seq_len, seq_len], and checks it against the reference.
+static void CheckMultiHeadMatMul(int bsz,
+                                 int seq_len,
+                                 const std::vector<int64_t> &bias_qk_dims,
+                                 const std::vector<float> &bias_qk,
+                                 const std::vector<float> &mask) {
+  const int hidden = 32, num_head = 4;
+  const int dim_head = hidden / num_head;
+  const float alpha = 1.f / std::sqrt(dim_head);
+  auto x = RandomVec(bsz * seq_len * hidden, 1.f, 1);
+  auto w = RandomVec(hidden * 3 * hidden, 0.2f, 2);
+  auto bias = RandomVec(3 * hidden, 0.1f, 3);
+
+  framework::Scope scope;
+  SetTensor(&scope, "x", {bsz, seq_len, hidden}, x);
+  SetTensor(&scope, "w", {hidden, 3, hidden}, w);
+  SetTensor(&scope, "bias", {3, hidden}, bias);
+  SetTensor(&scope, "bias_qk", bias_qk_dims, bias_qk);
+  scope.Var("out")->GetMutable<phi::DenseTensor>();
+
+  framework::AttributeMap attrs;
+  attrs["alpha"] = alpha;
+  attrs["head_number"] = num_head;
+  auto op = framework::OpRegistry::CreateOp(
+      "multihead_matmul",
+      {{"Input", {"x"}},
+       {"W", {"w"}},
+       {"Bias", {"bias"}},
+       {"BiasQK", {"bias_qk"}}},
+      {{"Out", {"out"}}},
+      attrs);
+  op->Run(scope, platform::CPUPlace());
+
+  std::vector<float> qkv(bsz * seq_len * 3 * hidden);
+  RefMatMul(x.data(), w.data(), qkv.data(), bsz * seq_len, 3 * hidden, hidden);
+  for (int i = 0; i < bsz * seq_len; ++i) {
+    for (int j = 0; j < 3 * hidden; ++j) qkv[i * 3 * hidden + j] += bias[j];
+  }
+  std::vector<float> expected(bsz * seq_len * hidden);
+  RefAttention(qkv.data(),
+               mask.data(),
+               expected.data(),
+               bsz,
+               seq_len,
+               num_head,
+               dim_head,
+               alpha);
+  ExpectNear(GetTensor(scope, "out"), expected, 1e-4);
+}
+
+TEST(MultiHeadMatMulCPU, BroadcastBiasQK) {
+  const int bsz = 2, seq_len = 7;
+  std::vector<float> bias_qk(bsz * seq_len, 0.f);
+  bias_qk[seq_len - 1] = -10000.f;  // mask the last key of batch 0
+  std::vector<float> mask(bsz * seq_len * seq_len);
+  for (int b = 0; b < bsz; ++b) {
+    for (int i = 0; i < seq_len; ++i) {
+      for (int j = 0; j < seq_len; ++j) {
+        mask[(b * seq_len + i) * seq_len + j] = bias_qk[b * seq_len + j];
+      }
+    }
+  }
+  CheckMultiHeadMatMul(bsz, seq_len, {bsz, 1, 1, seq_len}, bias_qk, mask);
+}
+
+// [1, 1, S, S] has as many elements as [B, 1, 1, S] when B == S, and is
+// still broadcast over the batch.
+TEST(MultiHeadMatMulCPU, BroadcastBiasQKOverBatch) {
+  const int bsz = 5, seq_len = 5;
+  auto bias_qk = RandomVec(seq_len * seq_len, 2.f, 4);
+  std::vector<float> mask;
+  for (int b = 0; b < bsz; ++b) {
+    mask.insert(mask.end(), bias_qk.begin(), bias_qk.end());
+  }
+  CheckMultiHeadMatMul(bsz, seq_len, {1, 1, seq_len, seq_len}, bias_qk, mask);
+}
+
+struct TransformerLayer {
+  int dim_embed;
+  int num_head;
+  int dim_head;
+  int dim_ffn;
+
+  TransformerLayer(int dim_embed, int num_head, int dim_ffn)
+      : dim_embed(dim_embed),
+        num_head(num_head),
+        dim_head(dim_embed / num_head),
+        dim_ffn(dim_ffn) {}
+
+  void InitWeights(framework::Scope *scope) const {
+    int hidden = num_head * dim_head;
+    std::vector<float> ones(dim_embed, 1.f);
+    SetTensor(scope, "ln_scale", {dim_embed}, ones);
+    SetTensor(scope, "ln_bias", {dim_embed}, RandomVec(dim_embed, 0.1f, 10));
+    SetTensor(scope,
+              "qkv_w",
+              {3, num_head, dim_head, dim_embed},
+              RandomVec(3 * hidden * dim_embed, 0.1f, 11));
+    SetTensor(scope,
+              "qkv_bias",
+              {3, num_head, dim_head},
+              RandomVec(3 * hidden, 0.1f, 12));
+    SetTensor(scope,
+              "out_linear_w",
+              {hidden, dim_embed},
+              RandomVec(hidden * dim_embed, 0.1f, 13));
+    SetTensor(
+        scope, "out_linear_bias", {dim_embed}, RandomVec(dim_embed, 0.1f, 14));
+    SetTensor(scope, "ffn_ln_scale", {dim_embed}, ones);
+    SetTensor(
+        scope, "ffn_ln_bias", {dim_embed}, RandomVec(dim_embed, 0.1f, 15));
+    SetTensor(scope,
+              "ffn1_w",
+              {dim_embed, dim_ffn},
+              RandomVec(dim_embed * dim_ffn, 0.1f, 16));
+    SetTensor(scope, "ffn1_bias", {dim_ffn}, RandomVec(dim_ffn, 0.1f, 17));
+    SetTensor(scope,
+              "ffn2_w",
+              {dim_ffn, dim_embed},
+              RandomVec(dim_ffn * dim_embed, 0.1f, 18));
+    SetTensor(scope, "ffn2_bias", {dim_embed}, RandomVec(dim_embed, 0.1f, 19));
+  }
+
+  std::unique_ptr<framework::OperatorBase> CreateOp(
+      const std::string &x,
+      const std::string &out,
+      const std::string &src_mask,
+      const std::string &cache_kv,
+      const std::string &time_step,
+      const std::string &block_tables = "") const {
+    framework::VariableNameMap inputs = {{"X", {x}},
+                                         {"LnScale", {"ln_scale"}},
+                                         {"LnBias", {"ln_bias"}},
+                                         {"QKVW", {"qkv_w"}},
+                                         {"QKVBias", {"qkv_bias"}},
+                                         {"OutLinearW", {"out_linear_w"}},
+                                         {"OutLinearBias", {"out_linear_bias"}},
+                                         {"FFNLnScale", {"ffn_ln_scale"}},
+                                         {"FFNLnBias", {"ffn_ln_bias"}},
+                                         {"FFN1Weight", {"ffn1_w"}},
+                                         {"FFN1Bias", {"ffn1_bias"}},
+                                         {"FFN2Weight", {"ffn2_w"}},
+                                         {"FFN2Bias", {"ffn2_bias"}}};
+    framework::VariableNameMap outputs = {{"Out", {out}}};
+    if (!src_mask.empty()) inputs["SrcMask"] = {src_mask};
+    if (!cache_kv.empty()) {
+      inputs["CacheKV"] = {cache_kv};
+      outputs["CacheKVOut"] = {cache_kv};
+    }
+    if (!time_step.empty()) inputs["TimeStep"] = {time_step};
+    if (!block_tables.empty()) inputs["BlockTables"] = {block_tables};
+
+    framework::AttributeMap attrs;
+    attrs["pre_layer_norm"] = true;
+    attrs["epsilon"] = 1e-5f;
+    attrs["act_method"] = std::string("gelu");
+    attrs["is_test"] = true;
+    return framework::OpRegistry::CreateOp(
+        "fused_multi_transformer", inputs, outputs, attrs);
+  }
+
+  // Naive pre-LayerNorm layer without mask.
+  std::vector<float> Reference(const framework::Scope &scope,
+                               const std::vector<float> &x,
+                               int bsz,
+                               int seq_len) const {
+    int tokens = bsz * seq_len;
+    int hidden = num_head * dim_head;
+    auto w = [&](const std::string &name) { return GetTensor(scope, name); };
+    std::vector<float> ln(tokens * dim_embed), qkv(tokens * 3 * hidden);
+    std::vector<float> attn(tokens * hidden), proj(tokens * dim_embed);
+    std::vector<float> ffn1(tokens * dim_ffn), out(x);
+
+    RefLayerNorm(out.data(),
+                 w("ln_scale").data(),
+                 w("ln_bias").data(),
+                 ln.data(),
+                 tokens,
+                 dim_embed);
+    RefMatMul(ln.data(),
+              w("qkv_w").data(),
+              qkv.data(),
+              tokens,
+              3 * hidden,
+              dim_embed,
+              /*trans_b=*/true);
+    auto qkv_bias = w("qkv_bias");
+    for (int i = 0; i < tokens; ++i) {
+      for (int j = 0; j < 3 * hidden; ++j) {
+        qkv[i * 3 * hidden + j] += qkv_bias[j];
+      }
+    }
+    RefAttention(qkv.data(),
+                 nullptr,
+                 attn.data(),
+                 bsz,
+                 seq_len,
+                 num_head,
+                 dim_head,
+                 1.f / std::sqrt(dim_head));
+    RefMatMul(attn.data(),
+              w("out_linear_w").data(),
+              proj.data(),
+              tokens,
+              dim_embed,
+              hidden);
+    auto out_linear_bias = w("out_linear_bias");
+    for (int i = 0; i < tokens * dim_embed; ++i) {
+      out[i] += proj[i] + out_linear_bias[i % dim_embed];
+    }
+    RefLayerNorm(out.data(),
+                 w("ffn_ln_scale").data(),
+                 w("ffn_ln_bias").data(),
+                 ln.data(),
+                 tokens,
+                 dim_embed);
+    RefMatMul(
+        ln.data(), w("ffn1_w").data(), ffn1.data(), tokens, dim_ffn, dim_embed);
+    auto ffn1_bias = w("ffn1_bias");
+    for (int i = 0; i < tokens * dim_ffn; ++i) {
+      float v = ffn1[i] + ffn1_bias[i % dim_ffn];
+      ffn1[i] = 0.5f * v * (1.f + std::erf(v * 0.70710678f));
+    }
+    RefMatMul(ffn1.data(),
+              w("ffn2_w").data(),
+              proj.data(),
+              tokens,
+              dim_embed,
+              dim_ffn);
+    auto ffn2_bias = w("ffn2_bias");
+    for (int i = 0; i < tokens * dim_embed; ++i) {
+      out[i] += proj[i] + ffn2_bias[i % dim_embed];
+    }
+    return out;
+  }
+};
+
+TEST(FusedMultiTransformerCPU, Encoder) {
+  const int bsz = 2, seq_len = 5;
+  TransformerLayer layer(32, 4, 64);
+  framework::Scope scope;
+  layer.InitWeights(&scope);
+  auto x = RandomVec(bsz * seq_len * layer.dim_embed, 1.f, 1);
+  SetTensor(&scope, "x", {bsz, seq_len, layer.dim_embed}, x);
+  scope.Var("out")->GetMutable<phi::DenseTensor>();
+
+  layer.CreateOp("x", "out", "", "", "")->Run(scope, platform::CPUPlace());
+  ExpectNear(
+      GetTensor(scope, "out"), layer.Reference(scope, x, bsz, seq_len), 1e-4);
+}
+
+// [bsz, 1, len, len]
+static std::vector<float> CausalMask(int bsz, int len) {
+  std::vector<float> mask(bsz * len * len, 0.f);
+  for (int b = 0; b < bsz; ++b) {
+    for (int i = 0; i < len; ++i) {
+      for (int j = i + 1; j < len; ++j) {
+        mask[(b * len + i) * len + j] = -10000.f;
+      }
+    }
+  }
+  return mask;
+}
+
+// Running the context stage on seq_len tokens and then decoding one token
+// must give the same result as the causal encoder over seq_len + 1 tokens.
+TEST(FusedMultiTransformerCPU, DecodeMatchesCausalEncoder) {
+  const int bsz = 2, seq_len = 6, total = seq_len + 1;
+  TransformerLayer layer(32, 4, 64);
+  const int dim_embed = layer.dim_embed;
+  framework::Scope scope;
+  layer.InitWeights(&scope);
+  auto x = RandomVec(bsz * total * dim_embed, 1.f, 1);
+
+  // causal encoder over all tokens
+  SetTensor(&scope, "x_all", {bsz, total, dim_embed}, x);
+  SetTensor(&scope, "mask_all", {bsz, 1, total, total}, CausalMask(bsz, total));
+  scope.Var("out_all")->GetMutable<phi::DenseTensor>();
+  layer.CreateOp("x_all", "out_all", "mask_all", "", "")
+      ->Run(scope, platform::CPUPlace());
+  auto expected = GetTensor(scope, "out_all");
+
+  // context stage on the first seq_len tokens
+  std::vector<float> x_ctx, x_dec;
+  for (int b = 0; b < bsz; ++b) {
+    auto begin = x.begin() + b * total * dim_embed;
+    x_ctx.insert(x_ctx.end(), begin, begin + seq_len * dim_embed);
+    x_dec.insert(x_dec.end(),
+                 begin + seq_len * dim_embed,
+                 begin + total * dim_embed);
+  }
+  SetTensor(&scope, "x_ctx", {bsz, seq_len, dim_embed}, x_ctx);
+  SetTensor(
+      &scope, "mask_ctx", {bsz, 1, seq_len, seq_len}, CausalMask(bsz, seq_len));
+  SetTensor(&scope,
+            "cache_kv",
+            {2, bsz, layer.num_head, total, layer.dim_head},
+            std::vector<float>(2 * bsz * total * dim_embed, 0.f));
+  scope.Var("out_ctx")->GetMutable<phi::DenseTensor>();
+  layer.CreateOp("x_ctx", "out_ctx", "mask_ctx", "cache_kv", "")
+      ->Run(scope, platform::CPUPlace());
+
+  // decode the last token
+  SetTensor(&scope, "x_dec", {bsz, 1, dim_embed}, x_dec);
+  SetTensor(&scope,
+            "mask_dec",
+            {bsz, 1, 1, total},
+            std::vector<float>(bsz * total, 0.f));
+  auto *time_step = scope.Var("time_step")->GetMutable<phi::DenseTensor>();
+  time_step->mutable_data<int>({1}, platform::CPUPlace())[0] = seq_len;
+  scope.Var("out_dec")->GetMutable<phi::DenseTensor>();
+  layer.CreateOp("x_dec", "out_dec", "mask_dec", "cache_kv", "time_step")
+      ->Run(scope, platform::CPUPlace());
+
+  auto ctx_out = GetTensor(scope, "out_ctx");
+  auto dec_out = GetTensor(scope, "out_dec");
+  for (int b = 0; b < bsz; ++b) {
+    for (int i = 0; i < total; ++i) {
+      for (int j = 0; j < dim_embed; ++j) {
+        float actual = i < seq_len
+                           ? ctx_out[(b * seq_len + i) * dim_embed + j]
+                           : dec_out[b * dim_embed + j];
+        ASSERT_NEAR(actual, expected[(b * total + i) * dim_embed + j], 1e-4);
+      }
+    }
+  }
+}
+
+// Runs the context stage on prompt [bsz, seq_len, dim_embed] and then decodes
+// tokens [steps, bsz, dim_embed] one step at a time, returning the outputs of
+// the decoding steps. The cache is contiguous when block_size is 0, otherwise
+// it is paged and managed by PagedKVCacheManager. A non empty parents
+// reorders the sequences after the context stage, as beam search does.
+static std::vector<float> RunGeneration(const TransformerLayer &layer,
+                                        const std::vector<float> &prompt,
+                                        int bsz,
+                                        int seq_len,
+                                        const std::vector<float> &tokens,
+                                        int steps,
+                                        const std::vector<int> &parents,
+                                        int block_size,
+                                        double *decode_ms = nullptr) {
+  const int dim_embed = layer.dim_embed;
+  const int max_seq_len = seq_len + steps;
+  const auto place = platform::CPUPlace();
+  framework::Scope scope;
+  layer.InitWeights(&scope);
+
+  std::unique_ptr<paddle::operators::PagedKVCacheManager> manager;
+  std::vector<int64_t> cache_dims = {
+      2, bsz, layer.num_head, max_seq_len, layer.dim_head};
+  if (block_size > 0) {
+    const int num_blocks =
+        2 * bsz * ((max_seq_len + block_size - 1) / block_size);
+    manager.reset(
+        new paddle::operators::PagedKVCacheManager(num_blocks, block_size));
+    manager->Reset(bsz);
+    cache_dims = {2, num_blocks, layer.num_head, block_size, layer.dim_head};
+  }
+  const int64_t cache_numel = 2 * cache_dims[1] * cache_dims[2] *
+                              cache_dims[3] * cache_dims[4];
+  SetTensor(&scope,
+            "cache_kv",
+            cache_dims,
+            std::vector<float>(cache_numel, 0.f));
+  auto *cache_kv = scope.FindVar("cache_kv")->GetMutable<phi::DenseTensor>();
+  auto *block_tables =
+      scope.Var("block_tables")->GetMutable<phi::DenseTensor>();
+  const std::string tables_name = manager ? "block_tables" : "";
+  scope.Var("out")->GetMutable<phi::DenseTensor>();
+
+  // context stage
+  SetTensor(&scope, "x", {bsz, seq_len, dim_embed}, prompt);
+  SetTensor(
+      &scope, "mask", {bsz, 1, seq_len, seq_len}, CausalMask(bsz, seq_len));
+  if (manager) {
+    manager->Append(seq_len, {cache_kv});
+    manager->GetBlockTables(block_tables);
+  }
+  layer.CreateOp("x", "out", "mask", "cache_kv", "", tables_name)
+      ->Run(scope, place);
+
+  if (!parents.empty()) {
+    if (manager) {
+      phi::DenseTensor parent_idx;
+      int *data = parent_idx.mutable_data<int>({bsz}, place);
+      std::copy(parents.begin(), parents.end(), data);
+      manager->Reorder(parent_idx);
+    } else {
+      auto cache = GetTensor(scope, "cache_kv");
+      float *data = cache_kv->data<float>();
+      const int64_t seq_size = cache_numel / (2 * bsz);
+      for (int kv = 0; kv < 2; ++kv) {
+        for (int b = 0; b < bsz; ++b) {
+          std::copy_n(cache.begin() + (kv * bsz + parents[b]) * seq_size,
+                      seq_size,
+                      data + (kv * bsz + b) * seq_size);
+        }
+      }
+    }
+  }
+
+  std::vector<float> result;
+  auto *time_step = scope.Var("time_step")->GetMutable<phi::DenseTensor>();
+  auto op =
+      layer.CreateOp("x", "out", "", "cache_kv", "time_step", tables_name);
+  for (int t = 0; t < steps; ++t) {
+    auto begin = tokens.begin() + t * bsz * dim_embed;
+    SetTensor(&scope,
+              "x",
+              {bsz, 1, dim_embed},
+              std::vector<float>(begin, begin + bsz * dim_embed));
+    time_step->mutable_data<int>({1}, place)[0] = seq_len + t;
+
+    auto start = std::chrono::steady_clock::now();
+    if (manager) {
+      manager->Append(1, {cache_kv});
+      manager->GetBlockTables(block_tables);
+    }
+    op->Run(scope, place);
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (decode_ms) *decode_ms += elapsed.count();
+
+    auto out = GetTensor(scope, "out");
+    result.insert(result.end(), out.begin(), out.end());
+  }
+  return result;
+}
+
+TEST(FusedMultiTransformerCPU, PagedCacheMatchesContiguous) {
+  const int bsz = 2, seq_len = 6, steps = 5;
+  TransformerLayer layer(32, 4, 64);
+  auto prompt = RandomVec(bsz * seq_len * layer.dim_embed, 1.f, 1);
+  auto tokens = RandomVec(steps * bsz * layer.dim_embed, 1.f, 2);
+  auto expected =
+      RunGeneration(layer, prompt, bsz, seq_len, tokens, steps, {}, 0);
+  // the decoded tokens cross the boundary of blocks of 4
+  ExpectNear(
+      RunGeneration(layer, prompt, bsz, seq_len, tokens, steps, {}, 4),
+      expected,
+      1e-4);
+}
+
+// Beams that share the blocks of their parent must not overwrite each other,
+// the last block of the prompt is half full and is written by every beam.
+TEST(FusedMultiTransformerCPU, PagedCacheBeamReorder) {
+  const int bsz = 3, seq_len = 6, steps = 3;
+  const std::vector<int> parents = {2, 2, 0};
+  TransformerLayer layer(32, 4, 64);
+  auto prompt = RandomVec(bsz * seq_len * layer.dim_embed, 1.f, 1);
+  auto tokens = RandomVec(steps * bsz * layer.dim_embed, 1.f, 2);
+  auto expected =
+      RunGeneration(layer, prompt, bsz, seq_len, tokens, steps, parents, 0);
+  ExpectNear(
+      RunGeneration(layer, prompt, bsz, seq_len, tokens, steps, parents, 4),
+      expected,
+      1e-4);
+}
+
+TEST(PagedKVCacheManager, CopyOnWrite) {
+  paddle::operators::PagedKVCacheManager manager(8, 4);
+  manager.Reset(2);
+  manager.Append(6, {});
+  EXPECT_EQ(manager.NumFreeBlocks(), 4);
+
+  phi::DenseTensor parent_idx;
+  int *parents = parent_idx.mutable_data<int>({2}, platform::CPUPlace());
+  parents[0] = parents[1] = 1;
+  manager.Reorder(parent_idx);
+  EXPECT_EQ(manager.NumFreeBlocks(), 6);
+  EXPECT_EQ(manager.SeqLength(0), 6);
+
+  // the shared full block is kept, the half full one is copied once
+  manager.Append(1, {});
+  EXPECT_EQ(manager.NumFreeBlocks(), 5);
+  phi::DenseTensor block_tables;
+  manager.GetBlockTables(&block_tables);
+  const int *tables = block_tables.data<int>();
+  EXPECT_EQ(tables[0], tables[2]);
+  EXPECT_NE(tables[1], tables[3]);
+}
+
+// Per-layer latency of a BERT-base sized encoder layer.
+TEST(FusedMultiTransformerCPU, LayerLatency) {
+  const int bsz = 1, seq_len = 128, repeat = 10;
+  TransformerLayer layer(768, 12, 3072);
+  framework::Scope scope;
+  layer.InitWeights(&scope);
+  SetTensor(&scope,
+            "x",
+            {bsz, seq_len, layer.dim_embed},
+            RandomVec(bsz * seq_len * layer.dim_embed, 1.f, 1));
+  scope.Var("out")->GetMutable<phi::DenseTensor>();
+  auto op = layer.CreateOp("x", "out", "", "", "");
+  op->Run(scope, platform::CPUPlace());  // warm up
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    op->Run(scope, platform::CPUPlace());
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  LOG(INFO) << "fused_multi_transformer CPU, batch " << bsz << ", seq_len "
+            << seq_len << ": " << elapsed.count() / repeat << " ms/layer";
+}
+
+// Decoding throughput of a BERT-base sized layer on a paged cache.
+TEST(FusedMultiTransformerCPU, DecodeThroughput) {
+  const int bsz = 1, steps = 16;
+  TransformerLayer layer(768, 12, 3072);
+  for (int seq_len : {128, 512, 1024}) {
+    auto prompt = RandomVec(bsz * seq_len * layer.dim_embed, 1.f, 1);
+    auto tokens = RandomVec(steps * bsz * layer.dim_embed, 1.f, 2);
+    double decode_ms = 0;
+    RunGeneration(
+        layer, prompt, bsz, seq_len, tokens, steps, {}, 64, &decode_ms);
+    LOG(INFO) << "fused_multi_transformer CPU decoding, batch " << bsz
+              << ", seq_len " << seq_len << ": "
+              << steps * bsz * 1000. / decode_ms << " tokens/s/layer";
+  }
+}
@@ -14,6 +14,10 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/funcs/selected_rows_functor.h"
 
+#include <algorithm>
+#include <map>
+#include <random>
+
 #include "gtest/gtest.h"
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
@@ -512,3 +516,126 @@ TEST(selected_rows_functor, cpu_sum_to) {
   // row9: 2.0 + 3.0
   EXPECT_EQ(tensor1_data[9 * row_numel + 6], 5.0);
 }
+
+// Random SelectedRows of num_rows rows of width row_numel, with ids drawn
+// from [0, height) so that most of them repeat when num_rows > height.
+std::unique_ptr<phi::SelectedRows> RandomSelectedRows(
+    const phi::CPUContext& ctx,
+    int64_t num_rows,
+    int64_t row_numel,
+    int64_t height,
+    int seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<int64_t> id_dist(0, height - 1);
+  std::uniform_real_distribution<float> value_dist(-1.f, 1.f);
+  std::vector<int64_t> rows(num_rows);
+  for (auto& row : rows) {
+    row = id_dist(rng);
+  }
+  std::unique_ptr<phi::SelectedRows> selected_rows{
+      new phi::SelectedRows(rows, height)};
+  auto* value = selected_rows->mutable_value();
+  value->Resize(phi::make_ddim({num_rows, row_numel}));
+  float* data = ctx.template Alloc<float>(value);
+  for (int64_t i = 0; i < num_rows * row_numel; ++i) {
+    data[i] = value_dist(rng);
+  }
+  return selected_rows;
+}
+
+TEST(selected_rows_functor, cpu_merge_add_many_duplicates) {
+  paddle::platform::CPUPlace cpu_place;
+  phi::CPUContext ctx(cpu_place);
+  ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                       .GetAllocator(cpu_place)
+                       .get());
+  const int64_t row_numel = 5;
+  // Enough rows to be merged by several threads, and ids wider than 32 bits
+  // for a sort of several passes.
+  for (int64_t height : {int64_t(1000), int64_t(1) << 40}) {
+    auto in1 = RandomSelectedRows(ctx, 100000, row_numel, height, 1);
+    auto in2 = RandomSelectedRows(ctx, 30000, row_numel, height, 2);
+    std::vector<const phi::SelectedRows*> inputs{in1.get(), in2.get()};
+
+    std::map<int64_t, std::vector<float>> expected;
+    for (auto* input : inputs) {
+      const float* data = input->value().data<float>();
+      for (size_t i = 0; i < input->rows().size(); ++i) {
+        auto& sum = expected[input->rows()[i]];
+        sum.resize(row_numel, 0.f);
+        for (int64_t j = 0; j < row_numel; ++j) {
+          sum[j] += data[i * row_numel + j];
+        }
+      }
+    }
+
+    phi::SelectedRows output;
+    phi::funcs::scatter::MergeAdd<phi::CPUContext, float> merge_add_functor;
+    merge_add_functor(ctx, inputs, &output, true);
+    ASSERT_EQ(output.rows().size(), expected.size());
+    const float* out_data = output.value().data<float>();
+    size_t i = 0;
+    for (auto& item : expected) {
+      EXPECT_EQ(output.rows()[i], item.first);
+      for (int64_t j = 0; j < row_numel; ++j) {
+        EXPECT_NEAR(out_data[i * row_numel + j], item.second[j], 1e-4);
+      }
+      ++i;
+    }
+
+    phi::SelectedRows average;
+    phi::funcs::scatter::MergeAverage<phi::CPUContext, float>
+        merge_average_functor;
+    merge_average_functor(ctx, inputs, &average);
+    EXPECT_EQ(average.rows(), output.rows());
+    const float* average_data = average.value().data<float>();
+    for (int64_t k = 0; k < output.value().numel(); ++k) {
+      EXPECT_NEAR(average_data[k], out_data[k] / 2, 1e-4);
+    }
+  }
+}
+
+// Rows in ascending order, with and without an id repeated across inputs.
+TEST(selected_rows_functor, cpu_merge_add_sorted) {
+  paddle::platform::CPUPlace cpu_place;
+  phi::CPUContext ctx(cpu_place);
+  ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                       .GetAllocator(cpu_place)
+                       .get());
+  const int64_t row_numel = 3;
+  auto make = [&](const std::vector<int64_t>& rows, float value) {
+    std::unique_ptr<phi::SelectedRows> selected_rows{
+        new phi::SelectedRows(rows, 10)};
+    auto* t = selected_rows->mutable_value();
+    t->Resize(phi::make_ddim({static_cast<int64_t>(rows.size()), row_numel}));
+    float* data = ctx.template Alloc<float>(t);
+    std::fill(data, data + t->numel(), value);
+    return selected_rows;
+  };
+  phi::funcs::scatter::MergeAdd<phi::CPUContext, float> merge_add_functor;
+
+  auto in1 = make({0, 2, 5}, 1.f);
+  auto in2 = make({6, 9}, 2.f);
+  std::vector<const phi::SelectedRows*> inputs{in1.get(), in2.get()};
+  phi::SelectedRows output;
+  merge_add_functor(ctx, inputs, &output, true);
+  EXPECT_EQ(output.rows(), std::vector<int64_t>({0, 2, 5, 6, 9}));
+  std::vector<float> expected = {1.f, 1.f, 1.f, 2.f, 2.f};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(output.value().data<float>()[i * row_numel + j], expected[i]);
+    }
+  }
+
+  auto in3 = make({1, 4}, 1.f);
+  auto in4 = make({4, 7}, 2.f);
+  inputs = {in3.get(), in4.get()};
+  merge_add_functor(ctx, inputs, &output, true);
+  EXPECT_EQ(output.rows(), std::vector<int64_t>({1, 4, 7}));
+  expected = {1.f, 3.f, 2.f};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(output.value().data<float>()[i * row_numel + j], expected[i]);
+    }
+  }
+}
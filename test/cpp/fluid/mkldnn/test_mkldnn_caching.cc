@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <chrono>
 #include <map>
 #include <random>
 #include <string>
@@ -24,8 +25,11 @@
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/flags.h"
 #include "paddle/phi/core/kernel_registry.h"
 
+PHI_DECLARE_int64(onednn_blob_cache_capacity);
+
 USE_OP_ITSELF(elementwise_add);
 PD_DECLARE_KERNEL(add_raw, OneDNN, ONEDNN);
 USE_OP_ITSELF(elementwise_mul);
@@ -161,5 +165,59 @@ TEST(test_conv2d_noreuse_cache, cpu_place) {
                         "Invalid number of cached oneDNN objects"));
 }
 
+TEST(test_conv2d_evict_cache, cpu_place) {
+  framework::DDim dims({1, 16, 32, 64});
+  phi::CPUPlace p;
+  CacheTester ct;
+  auto &pool = platform::DeviceContextPool::Instance();
+  auto *onednn_dev_ctx = dynamic_cast<phi::OneDNNContext *>(pool.Get(p));
+  auto capacity = FLAGS_onednn_blob_cache_capacity;
+  FLAGS_onednn_blob_cache_capacity = 9;
+  auto stats_before = onednn_dev_ctx->GetBlobCacheStats();
+  // The objects of the second conv2d take the place of the first one's.
+  RunOperator<float>(p, "conv2d", dims, "input_signal");
+  RunOperator<float>(p, "conv2d", dims, "input_signal2");
+  auto stats_after = onednn_dev_ctx->GetBlobCacheStats();
+  FLAGS_onednn_blob_cache_capacity = capacity;
+  EXPECT_EQ(stats_after.evictions - stats_before.evictions, 9UL);
+  PADDLE_ENFORCE_EQ(ct.Analyze(9),
+                    true,
+                    platform::errors::InvalidArgument(
+                        "Invalid number of cached oneDNN objects"));
+}
+
+TEST(test_blob_cache_overhead, cpu_place) {
+  // Small shapes, so the time is dominated by creating keys and looking up
+  // the cached primitives.
+  framework::DDim dims({1, 8, 8, 8});
+  phi::CPUPlace p;
+  CacheTester ct;
+  auto &pool = platform::DeviceContextPool::Instance();
+  auto *onednn_dev_ctx = dynamic_cast<phi::OneDNNContext *>(pool.Get(p));
+
+  for (const std::string op_type : {"conv2d", "elementwise_add", "relu"}) {
+    // Warm up so that the primitives are created and cached
+    RunOperator<float>(p, op_type, dims, "input_signal");
+    auto stats_before = onednn_dev_ctx->GetBlobCacheStats();
+
+    const int repeat = 1000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+      RunOperator<float>(p, op_type, dims, "input_signal");
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto stats_after = onednn_dev_ctx->GetBlobCacheStats();
+
+    EXPECT_GT(stats_after.hits, stats_before.hits);
+    LOG(INFO) << op_type << " with oneDNN cache: "
+              << std::chrono::duration<double, std::micro>(end - start)
+                         .count() /
+                     repeat
+              << " us/op, blob hits: " << stats_after.hits - stats_before.hits
+              << ", blob misses: "
+              << stats_after.misses - stats_before.misses;
+  }
+}
+
 }  // namespace operators
 }  // namespace paddle
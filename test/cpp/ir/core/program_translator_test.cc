@@ -12,11 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <gflags/gflags.h>
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/dialect/pd_dialect.h"
 #include "paddle/fluid/framework/framework.pb.h"
@@ -35,6 +39,14 @@ using OpDesc = paddle::framework::OpDesc;
 using VarDesc = paddle::framework::VarDesc;
 using VarType = paddle::framework::proto::VarType;
 
+DEFINE_string(translator_benchmark_programs,
+              "",
+              "Comma separated paths of extra serialized ProgramDesc files "
+              "translated by the TranslatorBenchmark test.");
+DEFINE_int32(translator_benchmark_repeat,
+             10,
+             "Number of translations per program in TranslatorBenchmark.");
+
 ProgramDesc load_from_file(const std::string &file_name) {
   std::ifstream fin(file_name, std::ios::in | std::ios::binary);
   fin.seekg(0, std::ios::end);
@@ -61,3 +73,49 @@ TEST(PaddleDialectTest, Translator) {
 
   program->Print(std::cout);
 }
+
+TEST(PaddleDialectTest, TranslatorBenchmark) {
+  std::vector<std::string> files = {"restnet50_main.prog"};
+  std::stringstream extra_files(FLAGS_translator_benchmark_programs);
+  std::string file;
+  while (std::getline(extra_files, file, ',')) {
+    if (!file.empty()) files.push_back(file);
+  }
+
+  ir::IrContext *ctx = ir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<PaddleDialect>();
+  ctx->GetOrRegisterDialect<ir::BuiltinDialect>();
+
+  for (const auto &file_name : files) {
+    auto p = load_from_file(file_name);
+    size_t legacy_op_num = 0;
+    for (size_t i = 0; i < p.Size(); ++i) {
+      legacy_op_num += p.Block(i).OpSize();
+    }
+
+    // The first translation fills the op info, type and attribute caches.
+    auto start = std::chrono::steady_clock::now();
+    auto program = paddle::TranslateLegacyProgramToProgram(p);
+    auto end = std::chrono::steady_clock::now();
+    double cold_ms =
+        std::chrono::duration<double, std::milli>(end - start).count();
+    size_t op_size = program->block()->size();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FLAGS_translator_benchmark_repeat; ++i) {
+      auto warm_program = paddle::TranslateLegacyProgramToProgram(p);
+      EXPECT_EQ(warm_program->block()->size(), op_size);
+    }
+    end = std::chrono::steady_clock::now();
+    double warm_ms =
+        std::chrono::duration<double, std::milli>(end - start).count() /
+        std::max(FLAGS_translator_benchmark_repeat, 1);
+
+    std::cout << "[translator benchmark] " << file_name
+              << ": legacy ops = " << legacy_op_num
+              << ", new ops = " << op_size << ", cold = " << cold_ms
+              << " ms (" << legacy_op_num / cold_ms * 1000 << " ops/s)"
+              << ", warm = " << warm_ms << " ms ("
+              << legacy_op_num / warm_ms * 1000 << " ops/s)" << std::endl;
+  }
+}
@@ -60,5 +60,44 @@ TEST(API, scale) {
   LOG(INFO) << "The cost of switch_case is " << t3 << "ms.";
 }
 
+TEST(API, op_call_overhead) {
+  // Tiny tensors, so the time is dominated by the dispatch overhead.
+  auto x = experimental::full({1}, 1.0, phi::DataType::FLOAT32, CPUPlace());
+  phi::KernelKey kernel_key(
+      phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT32);
+  phi::KernelSelectCache kernel_select_cache("scale");
+
+  const size_t cycles = 100000;
+  phi::tests::Timer timer;
+
+  timer.tic();
+  for (size_t i = 0; i < cycles; ++i) {
+    auto result = phi::KernelFactory::Instance().SelectKernelOrThrowError(
+        "scale", kernel_key);
+    ASSERT_TRUE(result.kernel.IsValid());
+  }
+  double uncached_select_ns = timer.toc() * 1e6 / cycles;
+
+  timer.tic();
+  for (size_t i = 0; i < cycles; ++i) {
+    auto result = kernel_select_cache.SelectKernelOrThrowError(kernel_key);
+    ASSERT_TRUE(result.kernel.IsValid());
+  }
+  double cached_select_ns = timer.toc() * 1e6 / cycles;
+
+  timer.tic();
+  for (size_t i = 0; i < cycles; ++i) {
+    auto out = experimental::scale(x, 2.0, 1.0, true);
+  }
+  double op_call_ns = timer.toc() * 1e6 / cycles;
+
+  LOG(INFO) << "Kernel selection without cache costs " << uncached_select_ns
+            << " ns/op.";
+  LOG(INFO) << "Kernel selection with cache costs " << cached_select_ns
+            << " ns/op.";
+  LOG(INFO) << "The scale api call on a 1-element tensor costs " << op_call_ns
+            << " ns/op.";
+}
+
 }  // namespace tests
 }  // namespace paddle
@@ -18,10 +18,15 @@ limitations under the License. */
 #include "gtest/gtest.h"
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/flags.h"
 #include "paddle/phi/core/kernel_factory.h"
 #include "paddle/phi/core/kernel_registry.h"
 
 PD_DECLARE_KERNEL(scale, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(transpose, CPU, ALL_LAYOUT);
+PD_DECLARE_KERNEL(transpose_strided, CPU, ALL_LAYOUT);
+
+PHI_DECLARE_bool(use_stride_kernel);
 
 namespace phi {
 namespace tests {
@@ -48,6 +53,50 @@ TEST(KernelFactory, SelectedKernelMap) {
   }
 }
 
+TEST(KernelSelectCache, SameKernelAsFactory) {
+  phi::KernelSelectCache cache("scale");
+  phi::KernelKey fp32_key(
+      phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT32);
+  phi::KernelKey fp64_key(
+      phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT64);
+
+  auto expected = phi::KernelFactory::Instance().SelectKernelOrThrowError(
+      "scale", fp32_key);
+  auto first = cache.SelectKernelOrThrowError(fp32_key);
+  auto second = cache.SelectKernelOrThrowError(fp32_key);
+  EXPECT_EQ(&first.kernel, &expected.kernel);
+  EXPECT_EQ(&second.kernel, &expected.kernel);
+  EXPECT_EQ(second.has_fallback_cpu, expected.has_fallback_cpu);
+
+  // A different key misses the cache and selects the matching kernel.
+  auto fp64 = cache.SelectKernelOrThrowError(fp64_key);
+  EXPECT_EQ(&fp64.kernel,
+            &phi::KernelFactory::Instance()
+                 .SelectKernelOrThrowError("scale", fp64_key)
+                 .kernel);
+  EXPECT_NE(&fp64.kernel, &expected.kernel);
+}
+
+TEST(KernelSelectCache, StridedKernelWithFlag) {
+  phi::KernelSelectCache cache("transpose");
+  phi::KernelKey key(
+      phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT32);
+  auto& factory = phi::KernelFactory::Instance();
+  const phi::Kernel* kernel = &factory.SelectKernel("transpose", key);
+  const phi::Kernel* strided_kernel =
+      &factory.SelectKernel("transpose_strided", key);
+
+  EXPECT_EQ(&cache.SelectKernelOrThrowError(key).kernel, kernel);
+  FLAGS_use_stride_kernel = true;
+  EXPECT_EQ(&cache.SelectKernelOrThrowError(key).kernel, strided_kernel);
+  // The kernels without a strided one are selected as they are.
+  phi::KernelSelectCache scale_cache("scale");
+  EXPECT_EQ(&scale_cache.SelectKernelOrThrowError(key).kernel,
+            &factory.SelectKernel("scale", key));
+  FLAGS_use_stride_kernel = false;
+  EXPECT_EQ(&cache.SelectKernelOrThrowError(key).kernel, kernel);
+}
+
 template <typename T, typename Context>
 void TestKernel(const Context& dev_ctx,
                 const DenseTensor& x,
@@ -0,0 +1,210 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/core/flags.h"
+#include "paddle/phi/kernels/conv_kernel.h"
+#include "paddle/phi/kernels/funcs/cpu_conv.h"
+
+PHI_DECLARE_string(cpu_conv_algo);
+
+namespace phi {
+namespace tests {
+
+struct ConvCase {
+  std::vector<int64_t> input_dims;  // NCHW
+  std::vector<int64_t> filter_dims;
+  std::vector<int> strides;
+  std::vector<int> paddings;
+  std::vector<int> dilations;
+  int groups;
+};
+
+std::string ToString(const ConvCase& c) {
+  std::string result = "input [";
+  for (auto dim : c.input_dims) {
+    result += " " + std::to_string(dim);
+  }
+  result += " ], filter [";
+  for (auto dim : c.filter_dims) {
+    result += " " + std::to_string(dim);
+  }
+  return result + " ], stride " + std::to_string(c.strides[0]) +
+         ", padding " + std::to_string(c.paddings[0]) + ", dilation " +
+         std::to_string(c.dilations[0]) + ", groups " +
+         std::to_string(c.groups);
+}
+
+class ConvRunner {
+ public:
+  explicit ConvRunner(const ConvCase& c) : case_(c) {
+    dev_ctx_ = static_cast<phi::CPUContext*>(
+        phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+    std::mt19937 rng(2023);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    input_.Resize(make_ddim(c.input_dims));
+    filter_.Resize(make_ddim(c.filter_dims));
+    for (auto* t : {&input_, &filter_}) {
+      float* data = dev_ctx_->template Alloc<float>(t);
+      for (int64_t i = 0; i < t->numel(); ++i) {
+        data[i] = dist(rng);
+      }
+    }
+    std::vector<int64_t> out_dims = {c.input_dims[0], c.filter_dims[0]};
+    for (int i = 0; i < 2; ++i) {
+      const int64_t extent = c.dilations[i] * (c.filter_dims[i + 2] - 1) + 1;
+      out_dims.push_back(
+          (c.input_dims[i + 2] + 2 * c.paddings[i] - extent) / c.strides[i] +
+          1);
+    }
+    out_.Resize(make_ddim(out_dims));
+  }
+
+  // Runs conv2d with FLAGS_cpu_conv_algo set to algo.
+  std::vector<float> Run(const std::string& algo) {
+    FLAGS_cpu_conv_algo = algo;
+    ConvKernel<float>(*dev_ctx_,
+                      input_,
+                      filter_,
+                      case_.strides,
+                      case_.paddings,
+                      "EXPLICIT",
+                      case_.dilations,
+                      case_.groups,
+                      "NCHW",
+                      &out_);
+    FLAGS_cpu_conv_algo = "auto";
+    const float* data = out_.data<float>();
+    return std::vector<float>(data, data + out_.numel());
+  }
+
+  funcs::CPUConv2DShape Shape() const {
+    return {input_.dims()[0],
+            input_.dims()[1],
+            input_.dims()[2],
+            input_.dims()[3],
+            out_.dims()[1],
+            out_.dims()[2],
+            out_.dims()[3],
+            static_cast<int>(filter_.dims()[2]),
+            static_cast<int>(filter_.dims()[3]),
+            case_.strides[0],
+            case_.strides[1],
+            case_.paddings[0],
+            case_.paddings[0],
+            case_.paddings[1],
+            case_.paddings[1],
+            case_.dilations[0],
+            case_.dilations[1],
+            case_.groups};
+  }
+
+ private:
+  ConvCase case_;
+  phi::CPUContext* dev_ctx_;
+  DenseTensor input_;
+  DenseTensor filter_;
+  DenseTensor out_;
+};
+
+ConvCase MakeCase(int64_t batch_size,
+                  int64_t channels,
+                  int64_t size,
+                  int64_t out_channels,
+                  int64_t kernel,
+                  int stride,
+                  int padding,
+                  int dilation,
+                  int groups) {
+  return {{batch_size, channels, size, size},
+          {out_channels, channels / groups, kernel, kernel},
+          {stride, stride},
+          {padding, padding},
+          {dilation, dilation},
+          groups};
+}
+
+TEST(cpu_conv, algos_match_im2col) {
+  std::mt19937 rng(2023);
+  const std::vector<std::string> algos = {
+      "direct_1x1", "depthwise", "winograd_f23", "winograd_f43"};
+  int checked = 0;
+  for (int i = 0; i < 200; ++i) {
+    const int kind = static_cast<int>(rng() % 4);
+    const int64_t channels = 1 + static_cast<int64_t>(rng() % 24);
+    const int64_t size = 1 + static_cast<int64_t>(rng() % 20);
+    int64_t kernel = kind == 0 ? 1 : (kind == 1 ? 3 : 1 + rng() % 5);
+    int stride = kind == 1 ? 1 : 1 + static_cast<int>(rng() % 3);
+    int dilation = kind == 1 ? 1 : 1 + static_cast<int>(rng() % 2);
+    int padding = kind == 0 ? 0 : static_cast<int>(rng() % 3);
+    int groups = 1;
+    int64_t out_channels = 1 + static_cast<int64_t>(rng() % 24);
+    if (kind == 3) {
+      groups = static_cast<int>(channels);
+      out_channels = channels * (1 + static_cast<int64_t>(rng() % 2));
+    }
+    if (size + 2 * padding < dilation * (kernel - 1) + 1) {
+      continue;
+    }
+    ConvCase c = MakeCase(1 + rng() % 3,
+                          channels,
+                          size,
+                          out_channels,
+                          kernel,
+                          stride,
+                          padding,
+                          dilation,
+                          groups);
+    ConvRunner runner(c);
+    std::vector<float> expected = runner.Run("im2col");
+    for (const auto& algo : algos) {
+      std::vector<float> out = runner.Run(algo);
+      ASSERT_EQ(out.size(), expected.size());
+      for (size_t j = 0; j < out.size(); ++j) {
+        ASSERT_NEAR(out[j], expected[j], 1e-3) << algo << ", " << ToString(c);
+      }
+    }
+    ++checked;
+  }
+  EXPECT_GT(checked, 100);
+}
+
+TEST(cpu_conv, select_algo) {
+  auto algo = [](const ConvCase& c) {
+    return funcs::SelectCPUConvAlgo(ConvRunner(c).Shape());
+  };
+  EXPECT_EQ(algo(MakeCase(1, 32, 112, 32, 3, 1, 1, 1, 32)),
+            funcs::CPUConvAlgo::kDepthwise);
+  EXPECT_EQ(algo(MakeCase(1, 256, 56, 512, 1, 2, 0, 1, 1)),
+            funcs::CPUConvAlgo::kDirect1x1);
+  EXPECT_EQ(algo(MakeCase(1, 64, 56, 64, 3, 1, 1, 1, 1)),
+            funcs::CPUConvAlgo::kWinogradF43);
+  // Too few channels, or too few pixels, for Winograd.
+  EXPECT_EQ(algo(MakeCase(1, 3, 224, 64, 3, 1, 1, 1, 1)),
+            funcs::CPUConvAlgo::kIm2ColGemm);
+  EXPECT_EQ(algo(MakeCase(1, 512, 7, 512, 3, 1, 1, 1, 1)),
+            funcs::CPUConvAlgo::kIm2ColGemm);
+  EXPECT_EQ(algo(MakeCase(1, 64, 56, 64, 5, 1, 2, 1, 1)),
+            funcs::CPUConvAlgo::kIm2ColGemm);
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,205 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+#include "paddle/phi/kernels/funcs/pooling.h"
+
+namespace phi {
+namespace tests {
+
+struct PoolCase {
+  int64_t batch_size;
+  int64_t channels;
+  int64_t height;
+  int64_t width;
+  std::vector<int> ksize;
+  std::vector<int> strides;
+  std::vector<int> paddings;
+  bool adaptive;
+  bool exclusive;
+
+  std::vector<int64_t> OutputHW() const {
+    if (adaptive) {
+      return {ksize[0], ksize[1]};
+    }
+    return {(height + 2 * paddings[0] - ksize[0]) / strides[0] + 1,
+            (width + 2 * paddings[1] - ksize[1]) / strides[1] + 1};
+  }
+};
+
+const phi::CPUContext& GetCPUContext() {
+  return *static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+}
+
+DenseTensor NewTensor(const std::vector<int64_t>& dims) {
+  DenseTensor t;
+  t.Resize(make_ddim(dims));
+  GetCPUContext().template Alloc<float>(&t);
+  return t;
+}
+
+// The NHWC copy of the NCHW x, or the other way around.
+DenseTensor ToLayout(const DenseTensor& x, bool to_nhwc) {
+  std::vector<int64_t> dims = vectorize(x.dims());
+  std::vector<int> axis =
+      to_nhwc ? std::vector<int>{0, 2, 3, 1} : std::vector<int>{0, 3, 1, 2};
+  std::vector<int64_t> out_dims;
+  for (int i : axis) {
+    out_dims.push_back(dims[i]);
+  }
+  DenseTensor out = NewTensor(out_dims);
+  funcs::TransposeCPU<float>(x, &out, axis);
+  return out;
+}
+
+// The pooled x, and the gradient of x of dout, of the layout of x.
+struct PoolResult {
+  DenseTensor out;
+  DenseTensor dx;
+};
+
+PoolResult Pool(const PoolCase& c,
+                bool is_max,
+                const DenseTensor& x,
+                const DenseTensor& dout,
+                const std::string& data_format) {
+  const auto& dev_ctx = GetCPUContext();
+  std::vector<int64_t> out_hw = c.OutputHW();
+  std::vector<int64_t> out_dims =
+      data_format == "NHWC"
+          ? std::vector<int64_t>{c.batch_size, out_hw[0], out_hw[1], c.channels}
+          : std::vector<int64_t>{
+                c.batch_size, c.channels, out_hw[0], out_hw[1]};
+  PoolResult result = {NewTensor(out_dims), NewTensor(vectorize(x.dims()))};
+  float* dx_data = result.dx.data<float>();
+  std::fill(dx_data, dx_data + result.dx.numel(), 0.0f);
+  if (is_max) {
+    funcs::Pool2dFunctor<CPUContext, funcs::MaxPool<float>, float>()(
+        dev_ctx,
+        x,
+        c.ksize,
+        c.strides,
+        c.paddings,
+        data_format,
+        true,
+        false,
+        &result.out,
+        funcs::MaxPool<float>());
+    funcs::MaxPool2dGradFunctor<CPUContext, float>()(dev_ctx,
+                                                     x,
+                                                     result.out,
+                                                     dout,
+                                                     c.ksize,
+                                                     c.strides,
+                                                     c.paddings,
+                                                     data_format,
+                                                     &result.dx);
+  } else {
+    funcs::Pool2dFunctor<CPUContext, funcs::AvgPool<float>, float>()(
+        dev_ctx,
+        x,
+        c.ksize,
+        c.strides,
+        c.paddings,
+        data_format,
+        c.exclusive,
+        c.adaptive,
+        &result.out,
+        funcs::AvgPool<float>());
+    funcs::Pool2dGradFunctor<CPUContext, funcs::AvgPoolGrad<float>, float>()(
+        dev_ctx,
+        x,
+        result.out,
+        dout,
+        c.ksize,
+        c.strides,
+        c.paddings,
+        data_format,
+        c.exclusive,
+        c.adaptive,
+        &result.dx,
+        funcs::AvgPoolGrad<float>());
+  }
+  return result;
+}
+
+void ExpectEqual(const DenseTensor& actual,
+                 const DenseTensor& expected,
+                 const std::string& name) {
+  ASSERT_EQ(actual.numel(), expected.numel()) << name;
+  const float* a = actual.data<float>();
+  const float* e = expected.data<float>();
+  for (int64_t i = 0; i < actual.numel(); ++i) {
+    ASSERT_FLOAT_EQ(a[i], e[i]) << name << " " << i;
+  }
+}
+
+TEST(cpu_pooling, nhwc_matches_nchw) {
+  std::mt19937 rng(2023);
+  for (int i = 0; i < 300; ++i) {
+    PoolCase c;
+    c.batch_size = 1 + rng() % 3;
+    c.channels = 1 + rng() % 80;
+    c.height = 1 + rng() % 14;
+    c.width = 1 + rng() % 14;
+    c.adaptive = rng() % 4 == 0;
+    c.exclusive = rng() % 2 == 0;
+    if (c.adaptive) {
+      c.ksize = {1 + static_cast<int>(rng() % c.height),
+                 1 + static_cast<int>(rng() % c.width)};
+      c.strides = {1, 1};
+      c.paddings = {0, 0};
+    } else {
+      c.ksize = {1 + static_cast<int>(rng() % 4),
+                 1 + static_cast<int>(rng() % 4)};
+      c.strides = {1 + static_cast<int>(rng() % 3),
+                   1 + static_cast<int>(rng() % 3)};
+      c.paddings = {static_cast<int>(rng() % 2), static_cast<int>(rng() % 2)};
+      if (c.height + 2 * c.paddings[0] < c.ksize[0] ||
+          c.width + 2 * c.paddings[1] < c.ksize[1]) {
+        continue;
+      }
+    }
+    const bool is_max = !c.adaptive && rng() % 2 == 0;
+    std::vector<int64_t> out_hw = c.OutputHW();
+    DenseTensor x = NewTensor({c.batch_size, c.channels, c.height, c.width});
+    DenseTensor dout =
+        NewTensor({c.batch_size, c.channels, out_hw[0], out_hw[1]});
+    // A few distinct values, for the windows to have ties.
+    for (auto* t : {&x, &dout}) {
+      float* data = t->data<float>();
+      for (int64_t j = 0; j < t->numel(); ++j) {
+        data[j] = static_cast<float>(static_cast<int>(rng() % 7) - 3);
+      }
+    }
+    PoolResult nchw = Pool(c, is_max, x, dout, "NCHW");
+    PoolResult nhwc =
+        Pool(c, is_max, ToLayout(x, true), ToLayout(dout, true), "NHWC");
+    const std::string name = std::string(is_max ? "max" : "avg") + " case " +
+                             std::to_string(i);
+    ExpectEqual(ToLayout(nhwc.out, false), nchw.out, name + " out");
+    ExpectEqual(ToLayout(nhwc.dx, false), nchw.dx, name + " dx");
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
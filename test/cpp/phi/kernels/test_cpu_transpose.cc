@@ -0,0 +1,154 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/common/complex.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/kernels/funcs/cpu_transpose.h"
+#include "paddle/phi/kernels/funcs/math_function.h"
+
+namespace phi {
+namespace tests {
+
+// The per element transpose TransposeNormal used to do, as the reference.
+template <typename T>
+void RefTranspose(const T* in,
+                  T* out,
+                  const std::vector<int64_t>& dims,
+                  const std::vector<int>& axis) {
+  const int rank = static_cast<int>(dims.size());
+  std::vector<int64_t> in_stride(rank, 1);
+  std::vector<int64_t> out_stride(rank, 1);
+  for (int i = rank - 2; i >= 0; --i) {
+    in_stride[i] = in_stride[i + 1] * dims[i + 1];
+    out_stride[i] = out_stride[i + 1] * dims[axis[i + 1]];
+  }
+  int64_t numel = 1;
+  for (auto dim : dims) {
+    numel *= dim;
+  }
+  for (int64_t out_idx = 0; out_idx < numel; ++out_idx) {
+    int64_t in_idx = 0;
+    int64_t tmp_idx = out_idx;
+    for (int i = 0; i < rank; ++i) {
+      const int64_t coordinate = tmp_idx / out_stride[i];
+      tmp_idx -= coordinate * out_stride[i];
+      in_idx += coordinate * in_stride[axis[i]];
+    }
+    out[out_idx] = in[in_idx];
+  }
+}
+
+std::string ToString(const std::vector<int64_t>& dims,
+                     const std::vector<int>& axis) {
+  std::string result = "dims [";
+  for (auto dim : dims) {
+    result += " " + std::to_string(dim);
+  }
+  result += " ], axis [";
+  for (auto i : axis) {
+    result += " " + std::to_string(i);
+  }
+  return result + " ]";
+}
+
+template <typename T>
+void CheckTranspose(const std::vector<int64_t>& dims,
+                    const std::vector<int>& axis,
+                    std::mt19937* rng) {
+  int64_t numel = 1;
+  for (auto dim : dims) {
+    numel *= dim;
+  }
+  std::vector<T> in(numel);
+  std::vector<T> out(numel);
+  std::vector<T> expected(numel);
+  auto* bytes = reinterpret_cast<uint8_t*>(in.data());
+  for (size_t i = 0; i < in.size() * sizeof(T); ++i) {
+    bytes[i] = static_cast<uint8_t>((*rng)());
+  }
+  phi::funcs::TransposeCPU(in.data(), out.data(), sizeof(T), dims, axis);
+  RefTranspose(in.data(), expected.data(), dims, axis);
+  ASSERT_EQ(
+      std::memcmp(out.data(), expected.data(), numel * sizeof(T)), 0)
+      << sizeof(T) << " bytes elements, " << ToString(dims, axis);
+}
+
+template <typename T>
+void CheckRandomTransposes() {
+  std::mt19937 rng(2023);
+  for (int i = 0; i < 300; ++i) {
+    int rank = 1 + static_cast<int>(rng() % 7);
+    std::vector<int64_t> dims(rank);
+    for (auto& dim : dims) {
+      // Sizes around the micro kernels, and dims of 1.
+      dim = 1 + static_cast<int64_t>(rng() % (rank <= 2 ? 70 : 9));
+    }
+    std::vector<int> axis(rank);
+    std::iota(axis.begin(), axis.end(), 0);
+    std::shuffle(axis.begin(), axis.end(), rng);
+    CheckTranspose<T>(dims, axis, &rng);
+  }
+  CheckTranspose<T>({}, {}, &rng);
+  CheckTranspose<T>({3, 0, 4}, {2, 1, 0}, &rng);
+  CheckTranspose<T>({9, 2, 5, 2, 1, 3}, {2, 1, 4, 0, 3, 5}, &rng);
+  CheckTranspose<T>({2, 3, 4, 5, 6, 7, 2}, {6, 0, 5, 1, 4, 2, 3}, &rng);
+}
+
+template <int N>
+struct Bytes {
+  uint8_t data[N];
+};
+
+TEST(cpu_transpose, random_permutations) {
+  CheckRandomTransposes<uint8_t>();
+  CheckRandomTransposes<phi::dtype::float16>();
+  CheckRandomTransposes<float>();
+  CheckRandomTransposes<double>();
+  CheckRandomTransposes<phi::dtype::complex<double>>();
+  // The elements of other sizes, like the rows of the dims not moved.
+  CheckRandomTransposes<Bytes<3>>();
+  CheckRandomTransposes<Bytes<24>>();
+}
+
+TEST(cpu_transpose, dense_tensor) {
+  auto* dev_ctx = static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+  phi::DenseTensor in;
+  phi::DenseTensor out;
+  in.Resize({2, 3, 4});
+  out.Resize({4, 2, 3});
+  float* in_data = dev_ctx->template Alloc<float>(&in);
+  float* out_data = dev_ctx->template Alloc<float>(&out);
+  std::iota(in_data, in_data + in.numel(), 0.0f);
+  std::vector<int> axis = {2, 0, 1};
+  phi::funcs::Transpose<phi::CPUContext, float, 3> trans;
+  trans(*dev_ctx, in, &out, axis);
+  std::vector<float> expected(in.numel());
+  RefTranspose(in_data, expected.data(), {2, 3, 4}, axis);
+  for (int64_t i = 0; i < out.numel(); ++i) {
+    EXPECT_EQ(out_data[i], expected[i]) << i;
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,337 @@
+// Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/core/flags.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/argsort_kernel.h"
+#include "paddle/phi/kernels/elementwise_add_kernel.h"
+#include "paddle/phi/kernels/elementwise_multiply_kernel.h"
+#include "paddle/phi/kernels/expand_kernel.h"
+#include "paddle/phi/kernels/funcs/strided_view.h"
+#include "paddle/phi/kernels/matmul_kernel.h"
+#include "paddle/phi/kernels/reduce_mean_kernel.h"
+#include "paddle/phi/kernels/reduce_sum_kernel.h"
+#include "paddle/phi/kernels/slice_kernel.h"
+#include "paddle/phi/kernels/split_kernel.h"
+#include "paddle/phi/kernels/strided_view_kernel.h"
+#include "paddle/phi/kernels/transpose_kernel.h"
+#include "paddle/phi/kernels/triangular_solve_kernel.h"
+#include "paddle/phi/kernels/unsqueeze_kernel.h"
+
+PHI_DECLARE_bool(use_stride_kernel);
+
+namespace phi {
+namespace tests {
+
+const phi::CPUContext& GetCPUContext() {
+  return *static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+}
+
+DenseTensor RandomTensor(const DDim& dims, std::mt19937* rng) {
+  DenseTensor x;
+  x.Resize(dims);
+  float* data = GetCPUContext().template Alloc<float>(&x);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (int64_t i = 0; i < x.numel(); ++i) {
+    data[i] = dist(*rng);
+  }
+  return x;
+}
+
+std::vector<float> ToVector(const DenseTensor& x) {
+  std::vector<float> result(x.numel());
+  StridedCopyToContiguous(x, result.data());
+  return result;
+}
+
+void ExpectNear(const DenseTensor& actual,
+                const DenseTensor& expected,
+                const std::string& name) {
+  ASSERT_EQ(actual.dims(), expected.dims()) << name;
+  std::vector<float> actual_data = ToVector(actual);
+  std::vector<float> expected_data = ToVector(expected);
+  for (size_t i = 0; i < actual_data.size(); ++i) {
+    ASSERT_NEAR(actual_data[i], expected_data[i], 1e-4) << name << " " << i;
+  }
+}
+
+// Runs func with the views on, and off.
+template <typename Func>
+void CheckWithViews(const std::string& name, Func func) {
+  FLAGS_use_stride_kernel = true;
+  DenseTensor with_views = func();
+  FLAGS_use_stride_kernel = false;
+  DenseTensor without_views = func();
+  ExpectNear(with_views, without_views, name);
+}
+
+// The view kernels as the API functions call them, which make views with
+// FLAGS_use_stride_kernel and copies without it.
+DenseTensor TransposeView(const DenseTensor& x, const std::vector<int>& axis) {
+  DenseTensor out;
+  MetaTensor meta_out(&out);
+  TransposeInferMeta(x, axis, &meta_out);
+  TransposeStridedKernel<float>(GetCPUContext(), x, axis, &out);
+  return out;
+}
+
+DenseTensor SliceView(const DenseTensor& x,
+                      const std::vector<int64_t>& axes,
+                      const IntArray& starts,
+                      const IntArray& ends) {
+  DenseTensor out;
+  MetaTensor meta_out(&out);
+  std::vector<int64_t> infer_flags(axes.size(), 1);
+  std::vector<int64_t> decrease_axis;
+  SliceRawInferMeta(
+      x, axes, starts, ends, infer_flags, decrease_axis, &meta_out);
+  SliceStridedKernel<float>(GetCPUContext(),
+                            x,
+                            axes,
+                            starts,
+                            ends,
+                            infer_flags,
+                            decrease_axis,
+                            &out);
+  return out;
+}
+
+std::vector<DenseTensor> SplitView(const DenseTensor& x,
+                                   const IntArray& sections,
+                                   int axis) {
+  std::vector<DenseTensor> result(sections.GetData().size());
+  std::vector<MetaTensor> out_meta;
+  std::vector<MetaTensor*> out_meta_ptr;
+  std::vector<DenseTensor*> outs;
+  out_meta.reserve(result.size());
+  for (auto& out : result) {
+    out_meta.emplace_back(&out);
+    out_meta_ptr.push_back(&out_meta.back());
+    outs.push_back(&out);
+  }
+  SplitInferMeta(x, sections, axis, out_meta_ptr);
+  SplitStridedKernel<float>(GetCPUContext(), x, sections, axis, outs);
+  return result;
+}
+
+DenseTensor UnsqueezeView(const DenseTensor& x, const IntArray& axes) {
+  DenseTensor out;
+  MetaTensor meta_out(&out);
+  UnsqueezeInferMeta(x, axes, &meta_out);
+  UnsqueezeStridedKernel<float>(GetCPUContext(), x, axes, &out, nullptr);
+  return out;
+}
+
+DenseTensor ExpandView(const DenseTensor& x,
+                       const std::vector<int64_t>& shape) {
+  DenseTensor out;
+  out.Resize(phi::make_ddim(shape));
+  ExpandStridedKernel<float>(GetCPUContext(), x, IntArray(shape), &out);
+  return out;
+}
+
+TEST(strided_view, views_share_memory) {
+  std::mt19937 rng(2023);
+  const auto& dev_ctx = GetCPUContext();
+  DenseTensor x = RandomTensor({2, 3, 4, 5}, &rng);
+  FLAGS_use_stride_kernel = true;
+
+  DenseTensor transposed = TransposeView(x, {0, 2, 1, 3});
+  EXPECT_TRUE(transposed.IsSharedWith(x));
+  EXPECT_FALSE(transposed.is_contiguous());
+  std::vector<int64_t> strides = {60, 5, 20, 1};
+  EXPECT_EQ(transposed.strides(), strides);
+
+  DenseTensor sliced = SliceView(x, {2}, {1}, {3});
+  EXPECT_TRUE(sliced.IsSharedWith(x));
+  EXPECT_EQ(sliced.dims(), phi::make_ddim({2, 3, 2, 5}));
+
+  // Slicing the first dim keeps the view contiguous.
+  DenseTensor rows = SliceView(x, {0}, {1}, {2});
+  EXPECT_TRUE(rows.IsSharedWith(x));
+  EXPECT_TRUE(rows.is_contiguous());
+  EXPECT_EQ(rows.data<float>(), x.data<float>() + 60);
+  // The inplace ops on a contiguous view write into x, which autograd sees
+  // through the inplace version they share.
+  const uint32_t version = x.InplaceVersionCounter().CurrentVersion();
+  rows.InplaceVersionCounter().Bump();
+  EXPECT_EQ(x.InplaceVersionCounter().CurrentVersion(), version + 1);
+
+  // Writing into a strided view gives it a memory and an inplace version of
+  // its own.
+  DenseTensor written = SliceView(x, {2}, {1}, {3});
+  dev_ctx.template Alloc<float>(&written);
+  EXPECT_FALSE(written.IsSharedWith(x));
+  written.InplaceVersionCounter().Bump();
+  EXPECT_EQ(x.InplaceVersionCounter().CurrentVersion(), version + 1);
+
+  std::vector<DenseTensor> parts = SplitView(x, {1, 3}, 2);
+  ASSERT_EQ(parts.size(), 2UL);
+  EXPECT_TRUE(parts[1].IsSharedWith(x));
+  EXPECT_EQ(parts[1].dims(), phi::make_ddim({2, 3, 3, 5}));
+
+  DenseTensor bias = RandomTensor({4, 1}, &rng);
+  DenseTensor expanded = ExpandView(bias, {2, 4, 6});
+  EXPECT_TRUE(expanded.IsSharedWith(bias));
+  strides = {0, 1, 0};
+  EXPECT_EQ(expanded.strides(), strides);
+  FLAGS_use_stride_kernel = false;
+
+  // Copy gathers the views into contiguous tensors.
+  DenseTensor copied;
+  phi::Copy(dev_ctx, transposed, phi::CPUPlace(), true, &copied);
+  EXPECT_TRUE(copied.is_contiguous());
+  ExpectNear(copied, Transpose<float>(dev_ctx, x, {0, 2, 1, 3}), "copy");
+}
+
+TEST(strided_view, views_match_copies) {
+  std::mt19937 rng(2023);
+  const auto& dev_ctx = GetCPUContext();
+  DenseTensor x = RandomTensor({3, 4, 5, 6}, &rng);
+  DenseTensor y = RandomTensor({5, 6}, &rng);
+
+  CheckWithViews("transpose of transpose", [&]() {
+    DenseTensor t = TransposeView(x, {3, 1, 0, 2});
+    return TransposeView(t, {1, 3, 2, 0});
+  });
+  CheckWithViews("slice of transpose", [&]() {
+    DenseTensor t = TransposeView(x, {0, 3, 2, 1});
+    return SliceView(t, {1, 3}, {1, -3}, {5, 4});
+  });
+  CheckWithViews("split", [&]() {
+    return SplitView(x, {2, 4}, -1)[1];
+  });
+  CheckWithViews("unsqueeze and expand", [&]() {
+    DenseTensor t = TransposeView(y, {1, 0});
+    return ExpandView(UnsqueezeView(t, {0, 2}), {3, 6, 2, 5});
+  });
+  CheckWithViews("add with broadcast", [&]() {
+    DenseTensor t = TransposeView(x, {0, 1, 3, 2});
+    DenseTensor s = TransposeView(y, {1, 0});
+    return Add<float>(dev_ctx, t, s);
+  });
+  CheckWithViews("multiply by expanded", [&]() {
+    DenseTensor t = SliceView(x, {2}, {1}, {3});
+    DenseTensor e = ExpandView(SliceView(y, {0}, {0}, {2}), {4, 2, 6});
+    return Multiply<float>(dev_ctx, t, e);
+  });
+  CheckWithViews("sum", [&]() {
+    DenseTensor t = TransposeView(x, {2, 0, 3, 1});
+    return Sum<float>(dev_ctx, t, {1, -1}, DataType::UNDEFINED, false);
+  });
+  CheckWithViews("mean", [&]() {
+    DenseTensor t = SliceView(x, {1}, {1}, {3});
+    return Mean<float>(dev_ctx, t, {0, 3}, true);
+  });
+  CheckWithViews("matmul of transposed", [&]() {
+    DenseTensor t = TransposeView(x, {0, 1, 3, 2});
+    return Matmul<float>(dev_ctx, x, t, false, false);
+  });
+  CheckWithViews("matmul of sliced", [&]() {
+    DenseTensor t = SliceView(x, {3}, {1}, {6});
+    return Matmul<float>(dev_ctx, t, y, false, false);
+  });
+}
+
+TEST(strided_view, kernels_return_copies) {
+  std::mt19937 rng(2023);
+  const auto& dev_ctx = GetCPUContext();
+  DenseTensor x = RandomTensor({2, 3, 4}, &rng);
+  FLAGS_use_stride_kernel = true;
+  // The kernels other kernels call copy, only the API functions make views.
+  DenseTensor transposed = Transpose<float>(dev_ctx, x, {1, 0, 2});
+  EXPECT_FALSE(transposed.IsSharedWith(x));
+  EXPECT_TRUE(transposed.is_contiguous());
+  DenseTensor sliced = Slice<float>(dev_ctx, x, {2}, {1}, {3});
+  EXPECT_FALSE(sliced.IsSharedWith(x));
+  EXPECT_TRUE(sliced.is_contiguous());
+  std::vector<DenseTensor> parts = Split<float>(dev_ctx, x, {1, 2}, 1);
+  EXPECT_FALSE(parts[1].IsSharedWith(x));
+  EXPECT_TRUE(parts[1].is_contiguous());
+  FLAGS_use_stride_kernel = false;
+}
+
+TEST(strided_view, argsort_along_first_axis) {
+  std::mt19937 rng(2023);
+  const auto& dev_ctx = GetCPUContext();
+  const int64_t rows = 5, cols = 12;
+  DenseTensor x = RandomTensor({rows, 3, 4}, &rng);
+  DenseTensor out, indices;
+  out.Resize(x.dims());
+  indices.Resize(x.dims());
+  FLAGS_use_stride_kernel = true;
+  ArgsortKernel<float>(dev_ctx, x, 0, false, &out, &indices);
+  FLAGS_use_stride_kernel = false;
+
+  const float* x_data = x.data<float>();
+  const float* out_data = out.data<float>();
+  const int64_t* indices_data = indices.data<int64_t>();
+  for (int64_t j = 0; j < cols; ++j) {
+    std::vector<float> column(rows);
+    for (int64_t i = 0; i < rows; ++i) {
+      column[i] = x_data[i * cols + j];
+    }
+    std::sort(column.begin(), column.end());
+    for (int64_t i = 0; i < rows; ++i) {
+      ASSERT_EQ(out_data[i * cols + j], column[i]) << i << " " << j;
+      ASSERT_EQ(x_data[indices_data[i * cols + j] * cols + j], column[i]);
+    }
+  }
+}
+
+TEST(strided_view, triangular_solve_with_broadcast) {
+  std::mt19937 rng(2023);
+  const auto& dev_ctx = GetCPUContext();
+  const int64_t batch = 3, n = 4, k = 2;
+  DenseTensor x = RandomTensor({1, n, n}, &rng);
+  float* x_data = x.data<float>();
+  for (int64_t i = 0; i < n; ++i) {
+    x_data[i * n + i] += 4.0f;
+  }
+  DenseTensor y = RandomTensor({batch, n, k}, &rng);
+
+  CheckWithViews("triangular_solve", [&]() {
+    return TriangularSolve<float>(dev_ctx, x, y, true, false, false);
+  });
+  // x times the solution of each batch is y.
+  FLAGS_use_stride_kernel = true;
+  DenseTensor out = TriangularSolve<float>(dev_ctx, x, y, true, false, false);
+  FLAGS_use_stride_kernel = false;
+  ASSERT_EQ(out.dims(), y.dims());
+  std::vector<float> out_data = ToVector(out);
+  const float* y_data = y.data<float>();
+  for (int64_t b = 0; b < batch; ++b) {
+    for (int64_t i = 0; i < n; ++i) {
+      for (int64_t c = 0; c < k; ++c) {
+        float sum = 0.0f;
+        for (int64_t j = i; j < n; ++j) {
+          sum += x_data[i * n + j] * out_data[(b * n + j) * k + c];
+        }
+        ASSERT_NEAR(sum, y_data[(b * n + i) * k + c], 1e-4);
+      }
+    }
+  }
+}
+
+}  // namespace tests
+}  // namespace phi
@@ -0,0 +1,165 @@
+/* Copyright (c) 2023 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/weight_only_gemm.h"
+
+namespace phi {
+namespace tests {
+
+const phi::CPUContext& GetCPUContext() {
+  return *static_cast<phi::CPUContext*>(
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace()));
+}
+
+std::vector<float> RandomVector(size_t size, int seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> v(size);
+  for (auto& e : v) {
+    e = dist(rng);
+  }
+  return v;
+}
+
+// Unpacks qweight into a [k, n] fp32 weight, one element at a time.
+std::vector<float> RefDequantize(const std::vector<int8_t>& qweight,
+                                 const std::vector<float>& scale,
+                                 int k,
+                                 int n,
+                                 int bits,
+                                 int group_size) {
+  const int group = group_size > 0 ? group_size : k;
+  std::vector<float> weight(static_cast<size_t>(k) * n);
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < k; ++i) {
+      int q;
+      if (bits == 8) {
+        q = qweight[static_cast<size_t>(j) * k + i];
+      } else {
+        int byte = qweight[static_cast<size_t>(j) * k / 2 + i / 2];
+        int nibble = i % 2 == 0 ? byte & 0xF : (byte >> 4) & 0xF;
+        q = nibble >= 8 ? nibble - 16 : nibble;
+      }
+      weight[static_cast<size_t>(i) * n + j] =
+          q * scale[static_cast<size_t>(i / group) * n + j];
+    }
+  }
+  return weight;
+}
+
+void CheckWeightOnlyGemm(int m, int k, int n, int bits, int group_size) {
+  const auto& dev_ctx = GetCPUContext();
+  auto x = RandomVector(static_cast<size_t>(m) * k, 1);
+  auto weight = RandomVector(static_cast<size_t>(k) * n, 2);
+  auto bias = RandomVector(n, 3);
+
+  const int groups = group_size > 0 ? k / group_size : 1;
+  std::vector<int8_t> qweight(static_cast<size_t>(n) * k * bits / 8);
+  std::vector<float> scale(static_cast<size_t>(groups) * n);
+  phi::funcs::WeightOnlyQuantize(weight.data(),
+                                 k,
+                                 n,
+                                 bits,
+                                 group_size,
+                                 qweight.data(),
+                                 scale.data());
+
+  std::vector<float> out(static_cast<size_t>(m) * n);
+  phi::funcs::WeightOnlyGemm(dev_ctx,
+                             x.data(),
+                             m,
+                             k,
+                             n,
+                             qweight.data(),
+                             scale.data(),
+                             bias.data(),
+                             bits,
+                             group_size,
+                             out.data());
+
+  // The result should be that of the dequantized weight, and close to that
+  // of the original one within the quantization error.
+  auto blas = phi::funcs::GetBlas<phi::CPUContext, float>(dev_ctx);
+  auto dequantized = RefDequantize(qweight, scale, k, n, bits, group_size);
+  std::vector<float> ref(static_cast<size_t>(m) * n);
+  std::vector<float> fp32(static_cast<size_t>(m) * n);
+  for (int i = 0; i < m; ++i) {
+    std::copy(bias.begin(), bias.end(), ref.begin() + i * n);
+    std::copy(bias.begin(), bias.end(), fp32.begin() + i * n);
+  }
+  blas.GEMM(CblasNoTrans,
+            CblasNoTrans,
+            m,
+            n,
+            k,
+            1.f,
+            x.data(),
+            dequantized.data(),
+            1.f,
+            ref.data());
+  blas.GEMM(CblasNoTrans,
+            CblasNoTrans,
+            m,
+            n,
+            k,
+            1.f,
+            x.data(),
+            weight.data(),
+            1.f,
+            fp32.data());
+
+  double err = 0., norm = 0.;
+  for (size_t i = 0; i < out.size(); ++i) {
+    EXPECT_NEAR(out[i], ref[i], 1e-3);
+    err += (out[i] - fp32[i]) * (out[i] - fp32[i]);
+    norm += fp32[i] * fp32[i];
+  }
+  // Relative errors of uniform weights quantized to 127 and 7 levels.
+  const double max_rel_err = bits == 8 ? 0.01 : 0.15;
+  EXPECT_LT(std::sqrt(err / norm), max_rel_err);
+}
+
+TEST(WeightOnlyGemm, int8_per_channel) {
+  CheckWeightOnlyGemm(1, 256, 96, 8, -1);
+  CheckWeightOnlyGemm(7, 256, 96, 8, -1);
+}
+
+TEST(WeightOnlyGemm, int8_group_wise) {
+  CheckWeightOnlyGemm(5, 256, 80, 8, 64);
+}
+
+TEST(WeightOnlyGemm, int4_per_channel) {
+  CheckWeightOnlyGemm(3, 128, 40, 4, -1);
+}
+
+TEST(WeightOnlyGemm, int4_group_wise) {
+  CheckWeightOnlyGemm(1, 512, 64, 4, 128);
+  CheckWeightOnlyGemm(9, 512, 64, 4, 128);
+}
+
+TEST(WeightOnlyGemm, large_tile_count) {
+  // More output channels than fit in one tile.
+  CheckWeightOnlyGemm(2, 1024, 300, 8, -1);
+}
+
+}  // namespace tests
+}  // namespace phi